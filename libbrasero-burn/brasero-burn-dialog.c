@@ -65,6 +65,7 @@
 
 #include "brasero-medium.h"
 #include "brasero-drive.h"
+#include "brasero-medium-monitor.h"
 
 #include "brasero-misc.h"
 #include "brasero-pk.h"
@@ -103,6 +104,9 @@ struct BraseroBurnDialogPrivate {
 
 	guint num_copies;
 
+	/* percentage currently shown in the title (-1 for none) */
+	gint title_percent;
+
 	guint is_writing:1;
 	guint is_creating_image:1;
 };
@@ -235,6 +239,7 @@ brasero_burn_dialog_update_title (BraseroBurnDialog *dialog,
 	BraseroBurnDialogPrivate *priv;
 
 	priv = BRASERO_BURN_DIALOG_PRIVATE (dialog);
+	priv->title_percent = -1;
 
 	if (priv->media == BRASERO_MEDIUM_FILE)
 		title = brasero_burn_dialog_create_dialog_title_for_action (dialog,
@@ -1145,16 +1150,48 @@ brasero_burn_dialog_disable_joliet_cb (BraseroBurn *burn,
 	                                              _("C_ontinue"));
 }
 
+static BraseroBurnResult
+brasero_burn_dialog_damaged_medium_cb (BraseroBurn *burn,
+				       gint blocks,
+				       BraseroBurnDialog *dialog)
+{
+	BraseroBurnResult result;
+	gchar *secondary;
+	gchar *size;
+
+	size = g_format_size ((guint64) blocks * 2048ULL);
+	/* Translators: %s is a size like "12 MB" */
+	secondary = g_strdup_printf (_("%s of the disc could not be read despite several attempts and zeros took their place in the copy. Files stored in these parts of the disc will be damaged."),
+				     size);
+	g_free (size);
+
+	result = brasero_burn_dialog_continue_question (dialog,
+	                                                _("Do you want to go on with an incomplete copy of the disc?"),
+	                                                secondary,
+	                                                _("C_ontinue"));
+	g_free (secondary);
+	return result;
+}
+
 static void
 brasero_burn_dialog_update_title_writing_progress (BraseroBurnDialog *dialog,
 						   BraseroTrackType *input,
 						   BraseroMedia media,
 						   guint percent)
 {
+	BraseroBurnDialogPrivate *priv;
 	gchar *title = NULL;
 	gchar *icon_name;
 	guint remains;
 
+	/* Updating the title and the icon is costly (the window manager and
+	 * the taskbar are involved) so only do it when the value changes */
+	priv = BRASERO_BURN_DIALOG_PRIVATE (dialog);
+	if (priv->title_percent == (gint) percent)
+		return;
+
+	priv->title_percent = percent;
+
 	/* This is used only when actually writing to a disc */
 	if (media == BRASERO_MEDIUM_FILE)
 		title = brasero_burn_dialog_create_dialog_title_for_action (dialog,
@@ -1259,9 +1296,11 @@ brasero_burn_dialog_progress_changed_cb (BraseroBurn *burn,
 {
 	BraseroMedia media = BRASERO_MEDIUM_NONE;
 	BraseroBurnDialogPrivate *priv;
+	guint64 read_rate = 0;
 	goffset isosize = -1;
 	goffset written = -1;
 	guint64 rate = -1;
+	gint fill = -1;
 
 	priv = BRASERO_BURN_DIALOG_PRIVATE (dialog);
 
@@ -1271,6 +1310,11 @@ brasero_burn_dialog_progress_changed_cb (BraseroBurn *burn,
 			     &written,
 			     &rate);
 
+	brasero_burn_get_copy_buffer_status (priv->burn, &fill, &read_rate, NULL);
+	brasero_burn_progress_set_copy_buffer (BRASERO_BURN_PROGRESS (priv->progress),
+					       fill,
+					       read_rate);
+
 	brasero_burn_dialog_progress_changed_real (dialog,
 						   written,
 						   isosize,
@@ -1489,7 +1533,12 @@ brasero_burn_dialog_activity_stop (BraseroBurnDialog *dialog,
 					  -1,
 					  -1,
 					  -1);
+	brasero_burn_progress_set_copy_buffer (BRASERO_BURN_PROGRESS (priv->progress),
+					       -1,
+					       0);
+
 	/* Restore title */
+	priv->title_percent = -1;
 	if (priv->initial_title)
 		gtk_window_set_title (GTK_WINDOW (dialog), priv->initial_title);
 	else
@@ -1614,6 +1663,10 @@ brasero_burn_dialog_setup_session (BraseroBurnDialog *dialog,
 			  "disable-joliet",
 			  G_CALLBACK (brasero_burn_dialog_disable_joliet_cb),
 			  dialog);
+	g_signal_connect (priv->burn,
+			  "warn-damaged-medium",
+			  G_CALLBACK (brasero_burn_dialog_damaged_medium_cb),
+			  dialog);
 	g_signal_connect (priv->burn,
 			  "progress-changed",
 			  G_CALLBACK (brasero_burn_dialog_progress_changed_cb),
@@ -1720,6 +1773,7 @@ brasero_burn_dialog_notify_error (BraseroBurnDialog *dialog,
 	priv = BRASERO_BURN_DIALOG_PRIVATE (dialog);
 
 	/* Restore title */
+	priv->title_percent = -1;
 	if (priv->initial_title)
 		gtk_window_set_title (GTK_WINDOW (dialog), priv->initial_title);
 
@@ -2110,6 +2164,41 @@ brasero_burn_dialog_end_session (BraseroBurnDialog *dialog,
 	return retry;
 }
 
+/**
+ * Returns all the writers, the one chosen for the session first, if there
+ * are more than one. Otherwise returns NULL.
+ */
+
+static GSList *
+brasero_burn_dialog_get_span_drives (BraseroDrive *burner)
+{
+	BraseroMediumMonitor *monitor;
+	GSList *drives, *iter, *next;
+
+	if (!burner)
+		return NULL;
+
+	monitor = brasero_medium_monitor_get_default ();
+	drives = brasero_medium_monitor_get_drives (monitor, BRASERO_DRIVE_TYPE_WRITER);
+	g_object_unref (monitor);
+
+	for (iter = drives; iter; iter = next) {
+		BraseroDrive *drive;
+
+		next = iter->next;
+		drive = iter->data;
+		if (drive == burner || brasero_drive_is_fake (drive)) {
+			drives = g_slist_delete_link (drives, iter);
+			g_object_unref (drive);
+		}
+	}
+
+	if (!drives)
+		return NULL;
+
+	return g_slist_prepend (drives, g_object_ref (burner));
+}
+
 static BraseroBurnResult
 brasero_burn_dialog_record_spanned_session (BraseroBurnDialog *dialog,
 					    GError **error)
@@ -2120,10 +2209,24 @@ brasero_burn_dialog_record_spanned_session (BraseroBurnDialog *dialog,
 	BraseroBurnResult result;
 	BraseroBurnDialogPrivate *priv;
 	gchar *secondary_message = NULL;
+	GSList *drives;
 
 	priv = BRASERO_BURN_DIALOG_PRIVATE (dialog);
 	burner = brasero_burn_session_get_burner (priv->session);
 
+	/* With several writers, each of them records a volume at the same time
+	 * as the others; new discs are asked for through "insert-media" */
+	drives = brasero_burn_dialog_get_span_drives (burner);
+	if (drives) {
+		result = brasero_burn_record_span (priv->burn,
+						   BRASERO_SESSION_SPAN (priv->session),
+						   drives,
+						   error);
+		g_slist_foreach (drives, (GFunc) g_object_unref, NULL);
+		g_slist_free (drives);
+		return result;
+	}
+
 	/* Get the messages now as they can change */
 	type = brasero_track_type_new ();
 	brasero_burn_session_get_input_type (priv->session, type);
@@ -2527,6 +2630,7 @@ brasero_burn_dialog_init (BraseroBurnDialog * obj)
 	BraseroBurnDialogPrivate *priv;
 
 	priv = BRASERO_BURN_DIALOG_PRIVATE (obj);
+	priv->title_percent = -1;
 
 	gtk_window_set_default_size (GTK_WINDOW (obj), 500, 0);
 
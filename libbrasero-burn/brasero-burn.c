@@ -45,6 +45,8 @@
 #include <glib/gi18n-lib.h>
 #include <glib/gstdio.h>
 
+#include <gio/gio.h>
+
 #include "brasero-burn.h"
 
 #include "libbrasero-marshal.h"
@@ -53,6 +55,7 @@
 #include "burn-dbus.h"
 #include "burn-task-ctx.h"
 #include "burn-task.h"
+#include "burn-image-cache.h"
 #include "brasero-caps-burn.h"
 
 #include "brasero-drive-priv.h"
@@ -60,6 +63,11 @@
 #include "brasero-volume.h"
 #include "brasero-drive.h"
 
+#include "scsi-device.h"
+#include "scsi-mmc1.h"
+#include "scsi-spc1.h"
+#include "burn-disc-reader.h"
+
 #include "brasero-tags.h"
 #include "brasero-track.h"
 #include "brasero-session.h"
@@ -67,6 +75,10 @@
 #include "brasero-track-disc.h"
 #include "brasero-session-helper.h"
 
+#include "burn-image-follower.h"
+#include "burn-speed-profile.h"
+#include "burn-ring-buffer.h"
+
 G_DEFINE_TYPE (BraseroBurn, brasero_burn, G_TYPE_OBJECT);
 
 typedef struct _BraseroBurnPrivate BraseroBurnPrivate;
@@ -89,9 +101,41 @@ struct _BraseroBurnPrivate {
 	guint64 session_start;
 	guint64 session_end;
 
+	/* Used when one image is recorded to several drives */
+	GSList *recorders;
+	GMainContext *recorders_context;
+	GMainLoop *recorders_loop;
+	guint recorders_running;
+	guint recorders_failed;
+	guint recorders_done;
+
+	/* time the recorders would have taken one after the other */
+	gdouble recorders_time;
+
+	/* Used when the recorder follows the image being created */
+	BraseroImageFollower *follower;
+	BraseroTask *follow_imager;
+	BraseroTask *follow_recorder;
+	BraseroBurnResult follow_result;
+	GError *follow_error;
+	guint follow_id;
+
+	/* Used to remember how the medium was recorded at that speed */
+	gchar *profile_key;
+	guint64 profile_rate;
+	guint64 profile_throughput;
+	guint profile_samples;
+
 	guint mounted_by_us:1;
+	guint follow_started:1;
+	guint follow_running:1;
+	guint profile_sampling:1;
 };
 
+#define BRASERO_SCHEMA_CONFIG			"org.gnome.brasero.config"
+#define BRASERO_PROPS_COPY_BUFFER_SIZE		"copy-buffer-size"
+#define BRASERO_PROPS_FOLLOW_IMAGE_LEAD		"follow-image-lead"
+
 #define BRASERO_BURN_NOT_SUPPORTED_LOG(burn)					\
 	{									\
 		brasero_burn_log (burn,						\
@@ -138,6 +182,9 @@ typedef enum {
 	EJECT_FAILURE_SIGNAL,
 	BLANK_FAILURE_SIGNAL,
 	INSTALL_MISSING_SIGNAL,
+	DRIVE_PROGRESS_CHANGED_SIGNAL,
+	DRIVE_FINISHED_SIGNAL,
+	WARN_DAMAGED_MEDIUM_SIGNAL,
 	LAST_SIGNAL
 } BraseroBurnSignalType;
 
@@ -150,6 +197,11 @@ static guint brasero_burn_signals [LAST_SIGNAL] = { 0 };
 
 #define MOUNT_TIMEOUT		500
 
+/* How long (in ms) a drive may stay busy writing the lead-out without
+ * reporting any progress after the background format was stopped */
+#define BG_FORMAT_STOP_TIMEOUT	60000
+#define BG_FORMAT_STOP_INTERVAL	500
+
 static GObjectClass *parent_class = NULL;
 
 static void
@@ -260,17 +312,18 @@ brasero_burn_sleep (BraseroBurn *burn, gint msec)
 	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (burn);
 	GMainLoop *loop;
 
-	priv->sleep_loop = g_main_loop_new (NULL, FALSE);
-	priv->timeout_id = g_timeout_add (msec,
-					  (GSourceFunc) brasero_burn_wakeup,
-					  burn);
+	priv->sleep_loop = g_main_loop_new (brasero_burn_context_get_current (), FALSE);
+	priv->timeout_id = brasero_burn_timeout_add (NULL,
+						     msec,
+						     (GSourceFunc) brasero_burn_wakeup,
+						     burn);
 
 	/* Keep a reference to the loop in case we are cancelled to destroy it */
 	loop = priv->sleep_loop;
 	g_main_loop_run (loop);
 
 	if (priv->timeout_id) {
-		g_source_remove (priv->timeout_id);
+		brasero_burn_source_remove (NULL, priv->timeout_id);
 		priv->timeout_id = 0;
 	}
 
@@ -305,6 +358,108 @@ brasero_burn_reprobe (BraseroBurn *burn)
 	return result;
 }
 
+/**
+ * A DVD+RW may still be formatted in the background by the drive after it was
+ * written (see the dvd-rw-format plugin). Until the format is stopped, the
+ * disc has no lead-out and can't be read by other drives. Most writers stop
+ * it themselves but make sure it was done.
+ */
+
+static BraseroBurnResult
+brasero_burn_stop_bg_format (BraseroBurn *burn,
+			     GError **error)
+{
+	BraseroScsiDiscInfoStd *info = NULL;
+	BraseroDeviceHandle *handle;
+	BraseroScsiErrCode code = 0;
+	BraseroBurnPrivate *priv;
+	BraseroScsiResult res;
+	BraseroBurnResult result;
+	BraseroMedium *medium;
+	BraseroMedia media;
+	int last_progress;
+	guint waited;
+	int status;
+	int size;
+
+	priv = BRASERO_BURN_PRIVATE (burn);
+
+	medium = brasero_drive_get_medium (priv->dest);
+	if (!medium)
+		return BRASERO_BURN_OK;
+
+	media = brasero_medium_get_status (medium);
+	if (!BRASERO_MEDIUM_IS (media, BRASERO_MEDIUM_DVDRW_PLUS)
+	&&  !BRASERO_MEDIUM_IS (media, BRASERO_MEDIUM_DVDRW_PLUS_DL))
+		return BRASERO_BURN_OK;
+
+	handle = brasero_device_handle_open (brasero_drive_get_device (priv->dest), FALSE, NULL);
+	if (!handle)
+		return BRASERO_BURN_OK;
+
+	res = brasero_mmc1_read_disc_information_std (handle, &info, &size, NULL);
+	if (res != BRASERO_SCSI_OK) {
+		brasero_device_handle_close (handle);
+		return BRASERO_BURN_OK;
+	}
+
+	status = info->bg_format_status;
+	g_free (info);
+
+	if (status != BRASERO_SCSI_BG_FORMAT_IN_PROGESS) {
+		brasero_device_handle_close (handle);
+		return BRASERO_BURN_OK;
+	}
+
+	BRASERO_BURN_LOG ("Stopping background format");
+	res = brasero_mmc1_close_track_session (handle,
+						BRASERO_SCSI_CLOSE_SESSION,
+						0,
+						TRUE,
+						&code);
+	if (res != BRASERO_SCSI_OK) {
+		BRASERO_BURN_LOG ("Background format could not be stopped (%s)", brasero_scsi_strerror (code));
+		brasero_device_handle_close (handle);
+		return BRASERO_BURN_OK;
+	}
+
+	/* The drive is not ready until it wrote the lead-out. As for formatting
+	 * (see the dvd-rw-format plugin), keep waiting as long as the drive
+	 * reports it is moving forward. */
+	result = BRASERO_BURN_OK;
+	last_progress = -1;
+	waited = 0;
+	while (brasero_spc1_test_unit_ready (handle, NULL) != BRASERO_SCSI_OK) {
+		int progress;
+
+		if (brasero_spc1_request_sense_progress (handle, &progress, NULL) == BRASERO_SCSI_OK
+		&&  progress > last_progress) {
+			last_progress = progress;
+			waited = 0;
+		}
+
+		if (waited >= BG_FORMAT_STOP_TIMEOUT) {
+			BRASERO_BURN_LOG ("Drive still busy after stopping background format");
+			g_set_error (error,
+				     BRASERO_BURN_ERROR,
+				     BRASERO_BURN_ERROR_GENERAL,
+				     "%s", _("The drive did not finish closing the disc"));
+			result = BRASERO_BURN_ERR;
+			break;
+		}
+
+		/* returns BRASERO_BURN_CANCEL if we were cancelled */
+		result = brasero_burn_sleep (burn, BG_FORMAT_STOP_INTERVAL);
+		if (result != BRASERO_BURN_OK)
+			break;
+
+		waited += BG_FORMAT_STOP_INTERVAL;
+	}
+
+	brasero_device_handle_close (handle);
+	return result;
+}
+
 static BraseroBurnResult
 brasero_burn_unmount (BraseroBurn *self,
                       BraseroMedium *medium,
@@ -499,30 +654,46 @@ brasero_burn_ask_for_media (BraseroBurn *burn,
 }
 
 static BraseroBurnResult
-brasero_burn_ask_for_src_media (BraseroBurn *burn,
-				BraseroBurnError error_type,
-				BraseroMedia required_media,
-				GError **error)
+brasero_burn_ask_for_drive_media (BraseroBurn *burn,
+				  BraseroDrive *drive,
+				  BraseroBurnError error_type,
+				  BraseroMedia required_media,
+				  GError **error)
 {
 	BraseroMedium *medium;
-	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (burn);
 
-	medium = brasero_drive_get_medium (priv->src);
+	medium = brasero_drive_get_medium (drive);
 	if (brasero_medium_get_status (medium) != BRASERO_MEDIUM_NONE
-	||  brasero_drive_probing (priv->src)) {
+	||  brasero_drive_probing (drive)) {
 		BraseroBurnResult result;
-		result = brasero_burn_eject (burn, priv->src, error);
+
+		result = brasero_burn_eject (burn, drive, error);
 		if (result != BRASERO_BURN_OK)
 			return result;
 	}
 
 	return brasero_burn_ask_for_media (burn,
-					   priv->src,
+					   drive,
 					   error_type,
 					   required_media,
 					   error);
 }
 
+static BraseroBurnResult
+brasero_burn_ask_for_src_media (BraseroBurn *burn,
+				BraseroBurnError error_type,
+				BraseroMedia required_media,
+				GError **error)
+{
+	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (burn);
+
+	return brasero_burn_ask_for_drive_media (burn,
+						 priv->src,
+						 error_type,
+						 required_media,
+						 error);
+}
+
 static BraseroBurnResult
 brasero_burn_ask_for_dest_media (BraseroBurn *burn,
 				 BraseroBurnError error_type,
@@ -530,7 +701,6 @@ brasero_burn_ask_for_dest_media (BraseroBurn *burn,
 				 GError **error)
 {
 	BraseroDrive *drive;
-	BraseroMedium *medium;
 	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (burn);
 
 	/* Since in some cases (like when we reload
@@ -550,21 +720,11 @@ brasero_burn_ask_for_dest_media (BraseroBurn *burn,
 	else
 		drive = priv->dest;
 
-	medium = brasero_drive_get_medium (drive);
-	if (brasero_medium_get_status (medium) != BRASERO_MEDIUM_NONE
-	||  brasero_drive_probing (drive)) {
-		BraseroBurnResult result;
-
-		result = brasero_burn_eject (burn, drive, error);
-		if (result != BRASERO_BURN_OK)
-			return result;
-	}
-
-	return brasero_burn_ask_for_media (burn,
-					   drive,
-					   error_type,
-					   required_media,
-					   error);
+	return brasero_burn_ask_for_drive_media (burn,
+						 drive,
+						 error_type,
+						 required_media,
+						 error);
 }
 
 static BraseroBurnResult
@@ -1079,6 +1239,17 @@ brasero_burn_progress_changed (BraseroTaskCtx *task,
 		overall_progress =  (gdouble) priv->tasks_done /
 				    (gdouble) priv->task_nb;
 
+	/* sample the throughput actually sustained by the drive */
+	if (priv->profile_sampling
+	&&  brasero_task_ctx_get_action (task) == BRASERO_BURN_ACTION_RECORDING) {
+		guint64 rate = 0;
+
+		if (brasero_task_ctx_get_rate (task, &rate) == BRASERO_BURN_OK && rate) {
+			priv->profile_throughput += rate;
+			priv->profile_samples ++;
+		}
+	}
+
 	g_signal_emit (burn,
 		       brasero_burn_signals [PROGRESS_CHANGED_SIGNAL],
 		       0,
@@ -1219,6 +1390,135 @@ brasero_burn_status (BraseroBurn *burn,
 	return BRASERO_BURN_OK;
 }
 
+/**
+ * brasero_burn_get_buffer_fill:
+ * @burn: a #BraseroBurn
+ * @fifo: a #gint or NULL
+ * @buffer: a #gint or NULL
+ *
+ * Returns how full (in percent) the fifo of the recording backend
+ * (@fifo) and the buffer of the drive (@buffer) are while writing.
+ * Either is set to -1 when it is not known.
+ *
+ * Return value: a #BraseroBurnResult. BRASERO_BURN_OK if at least one
+ * of the values is known; BRASERO_BURN_NOT_READY if there is no ongoing
+ * operation and BRASERO_BURN_NOT_SUPPORTED otherwise.
+ **/
+
+BraseroBurnResult
+brasero_burn_get_buffer_fill (BraseroBurn *burn,
+			      gint *fifo,
+			      gint *buffer)
+{
+	BraseroBurnPrivate *priv;
+
+	g_return_val_if_fail (BRASERO_BURN (burn), BRASERO_BURN_ERR);
+
+	priv = BRASERO_BURN_PRIVATE (burn);
+
+	if (fifo)
+		*fifo = -1;
+	if (buffer)
+		*buffer = -1;
+
+	if (!priv->task || !brasero_task_is_running (priv->task))
+		return BRASERO_BURN_NOT_READY;
+
+	return brasero_task_ctx_get_buffer_fill (BRASERO_TASK_CTX (priv->task),
+						 fifo,
+						 buffer);
+}
+
+/**
+ * brasero_burn_get_copy_buffer_status:
+ * @burn: a #BraseroBurn
+ * @fill: a #gint or NULL
+ * @read_rate: a #guint64 or NULL
+ * @write_rate: a #guint64 or NULL
+ *
+ * When a disc is copied on the fly, returns how full (in percent) the buffer
+ * in memory between the reader and the recorder is (@fill), the rate at which
+ * it is filled by the reader (@read_rate) and the rate at which the recorder
+ * empties it (@write_rate). Rates are in bytes per second.
+ * @fill is set to -1 and the rates to 0 when there is no such buffer.
+ *
+ * Return value: a #BraseroBurnResult. BRASERO_BURN_OK if a buffer is in use;
+ * BRASERO_BURN_NOT_READY if there is no ongoing operation and
+ * BRASERO_BURN_NOT_SUPPORTED otherwise.
+ **/
+
+BraseroBurnResult
+brasero_burn_get_copy_buffer_status (BraseroBurn *burn,
+				     gint *fill,
+				     guint64 *read_rate,
+				     guint64 *write_rate)
+{
+	BraseroBurnPrivate *priv;
+
+	g_return_val_if_fail (BRASERO_BURN (burn), BRASERO_BURN_ERR);
+
+	priv = BRASERO_BURN_PRIVATE (burn);
+
+	if (fill)
+		*fill = -1;
+	if (read_rate)
+		*read_rate = 0;
+	if (write_rate)
+		*write_rate = 0;
+
+	if (!priv->task || !brasero_task_is_running (priv->task))
+		return BRASERO_BURN_NOT_READY;
+
+	return brasero_task_ctx_get_ring_buffer_status (BRASERO_TASK_CTX (priv->task),
+							fill,
+							read_rate,
+							write_rate);
+}
+
+/**
+ * Some imagers go on when they can't read some blocks of the source medium
+ * and zeros take their place in the image. The user must agree to use such
+ * an image; nobody answering means no.
+ */
+
+static BraseroBurnResult
+brasero_burn_ask_for_damaged_medium (BraseroBurn *burn)
+{
+	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (burn);
+	GValue instance_and_params [2];
+	GValue return_value;
+	gint blocks = 0;
+	GSList *iter;
+
+	for (iter = brasero_burn_session_get_tracks (priv->session); iter; iter = iter->next)
+		blocks += brasero_track_tag_lookup_int (iter->data, BRASERO_TRACK_MEDIUM_UNREADABLE_BLOCKS_TAG);
+
+	if (!blocks)
+		return BRASERO_BURN_OK;
+
+	BRASERO_BURN_LOG ("%i blocks of the source medium could not be read", blocks);
+
+	memset (instance_and_params, 0, sizeof (instance_and_params));
+	g_value_init (instance_and_params, G_TYPE_FROM_INSTANCE (burn));
+	g_value_set_instance (instance_and_params, burn);
+	g_value_init (instance_and_params + 1, G_TYPE_INT);
+	g_value_set_int (instance_and_params + 1, blocks);
+
+	return_value.g_type = 0;
+	g_value_init (&return_value, G_TYPE_INT);
+	g_value_set_int (&return_value, BRASERO_BURN_CANCEL);
+
+	g_signal_emitv (instance_and_params,
+			brasero_burn_signals [WARN_DAMAGED_MEDIUM_SIGNAL],
+			0,
+			&return_value);
+
+	g_value_unset (instance_and_params);
+	g_value_unset (instance_and_params + 1);
+
+	return g_value_get_int (&return_value);
+}
+
 static BraseroBurnResult
 brasero_burn_ask_for_joliet (BraseroBurn *burn)
 {
@@ -1350,6 +1650,8 @@ start:
 				       1.0,
 				       1.0,
 				       -1L);
+
+			return brasero_burn_ask_for_damaged_medium (burn);
 		}
 		return BRASERO_BURN_OK;
 	}
@@ -1364,6 +1666,15 @@ start:
 	if (!ret_error)
 		return result;
 
+	/* If a recorder is already following the image, it's too late to
+	 * start over; the recorder was aborted */
+	if (priv->follow_started) {
+		if (error)
+			g_propagate_error (error, ret_error);
+
+		return BRASERO_BURN_ERR;
+	}
+
 	if (brasero_burn_session_is_dest_file (priv->session)) {
 		gchar *image = NULL;
 		gchar *toc = NULL;
@@ -1375,8 +1686,20 @@ start:
 		brasero_burn_session_get_output (priv->session,
 						 &image,
 						 &toc);
-		if (image)
-			g_remove (image);
+
+		/* Unless the imager left a map to resume reading from (see
+		 * BraseroDiscReader): the next attempt needs what was read */
+		if (image) {
+			gchar *map;
+
+			map = g_strconcat (image, BRASERO_DISC_READER_MAP_SUFFIX, NULL);
+			if (!g_file_test (map, G_FILE_TEST_EXISTS))
+				g_remove (image);
+			else
+				BRASERO_BURN_LOG ("Keeping %s to resume reading", image);
+
+			g_free (map);
+		}
 		if (toc)
 			g_remove (toc);
 	}
@@ -1469,6 +1792,127 @@ brasero_burn_can_use_drive_exclusively (BraseroBurn *burn,
 	return BRASERO_BURN_OK;
 }
 
+static void
+brasero_burn_profile_start (BraseroBurn *burn,
+			    BraseroMedium *medium)
+{
+	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (burn);
+
+	g_free (priv->profile_key);
+	priv->profile_key = NULL;
+	priv->profile_sampling = FALSE;
+
+	/* Simulations don't tell anything about how the medium is written */
+	if (brasero_burn_session_get_flags (priv->session) & BRASERO_BURN_FLAG_DUMMY)
+		return;
+
+	priv->profile_key = brasero_speed_profile_get_key (medium);
+	if (!priv->profile_key)
+		return;
+
+	priv->profile_rate = brasero_burn_session_get_rate (priv->session);
+	priv->profile_throughput = 0;
+	priv->profile_samples = 0;
+	priv->profile_sampling = TRUE;
+}
+
+static void
+brasero_burn_profile_stop (BraseroBurn *burn,
+			   BraseroBurnResult result,
+			   const GError *error)
+{
+	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (burn);
+
+	if (!priv->profile_sampling)
+		return;
+
+	priv->profile_sampling = FALSE;
+
+	if (result == BRASERO_BURN_OK) {
+		/* keep the key in case the medium is checked afterwards */
+		brasero_speed_profile_add (priv->profile_key,
+					   priv->profile_rate,
+					   priv->profile_samples ?
+					   priv->profile_throughput / priv->profile_samples : 0,
+					   BRASERO_SPEED_OUTCOME_SUCCESS);
+		return;
+	}
+
+	/* Only the errors that may come from the speed are relevant */
+	if (error
+	&&  error->domain == BRASERO_BURN_ERROR
+	&& (error->code == BRASERO_BURN_ERROR_WRITE_MEDIUM
+	||  error->code == BRASERO_BURN_ERROR_SLOW_DMA))
+		brasero_speed_profile_add (priv->profile_key,
+					   priv->profile_rate,
+					   0,
+					   BRASERO_SPEED_OUTCOME_FAILURE);
+
+	g_free (priv->profile_key);
+	priv->profile_key = NULL;
+}
+
+/**
+ * When a disc is copied on the fly, the reader feeds the recorder through a
+ * large buffer in memory so that its stalls do not starve the recorder.
+ */
+
+static BraseroRingBuffer *
+brasero_burn_ring_buffer_new (BraseroBurn *burn)
+{
+	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (burn);
+	BraseroRingBuffer *ring;
+	BraseroTrackType *type;
+	GSettings *settings;
+	gboolean on_the_fly;
+	gint size;
+
+	type = brasero_track_type_new ();
+	brasero_burn_session_get_input_type (priv->session, type);
+	on_the_fly = brasero_track_type_get_has_medium (type);
+	brasero_track_type_free (type);
+
+	if (!on_the_fly)
+		return NULL;
+
+	settings = g_settings_new (BRASERO_SCHEMA_CONFIG);
+	size = g_settings_get_int (settings, BRASERO_PROPS_COPY_BUFFER_SIZE);
+	g_object_unref (settings);
+
+	if (size <= 0)
+		return NULL;
+
+	/* Let the buffer fill up to three quarters before recording */
+	ring = brasero_ring_buffer_new ((gsize) size * 1024 * 1024,
+					(gsize) size * 1024 * 768);
+	if (!ring)
+		return NULL;
+
+	brasero_task_ctx_set_ring_buffer (BRASERO_TASK_CTX (priv->task), ring);
+	return ring;
+}
+
+static void
+brasero_burn_ring_buffer_free (BraseroBurn *burn,
+			       BraseroRingBuffer *ring)
+{
+	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (burn);
+	guint64 in_rate = 0;
+	guint64 out_rate = 0;
+
+	if (!ring)
+		return;
+
+	brasero_ring_buffer_get_status (ring, NULL, &in_rate, &out_rate);
+	BRASERO_BURN_DEBUG (burn,
+			    "Copy read at %" G_GUINT64_FORMAT " KiB/s and recorded at %" G_GUINT64_FORMAT " KiB/s",
+			    in_rate / 1024,
+			    out_rate / 1024);
+
+	brasero_task_ctx_set_ring_buffer (BRASERO_TASK_CTX (priv->task), NULL);
+	brasero_ring_buffer_free (ring);
+}
+
 static BraseroBurnResult
 brasero_burn_run_recorder (BraseroBurn *burn, GError **error)
 {
@@ -1477,6 +1921,7 @@ brasero_burn_run_recorder (BraseroBurn *burn, GError **error)
 	BraseroDrive *burner;
 	GError *ret_error = NULL;
 	BraseroBurnResult result;
+	BraseroRingBuffer *ring;
 	BraseroMedium *src_medium;
 	BraseroMedium *burnt_medium;
 	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (burn);
@@ -1511,7 +1956,11 @@ start:
 		return result;
 
 	/* actual running of task */
+	ring = brasero_burn_ring_buffer_new (burn);
+	brasero_burn_profile_start (burn, burnt_medium);
 	result = brasero_task_run (priv->task, &ret_error);
+	brasero_burn_profile_stop (burn, result, ret_error);
+	brasero_burn_ring_buffer_free (burn, ring);
 
 	/* let's see the results */
 	if (result == BRASERO_BURN_OK) {
@@ -2037,39 +2486,326 @@ reload:
 	return BRASERO_BURN_RETRY;
 }
 
-/* FIXME: at the moment we don't allow for mixed CD type */
-static BraseroBurnResult
-brasero_burn_run_tasks (BraseroBurn *burn,
-			gboolean erase_allowed,
-                        BraseroTrackType *temp_output,
-                        gboolean *dummy_session,
-			GError **error)
+static void
+brasero_burn_set_session_addresses (BraseroBurn *burn,
+				    goffset len)
 {
-	BraseroBurnResult result;
-	GSList *tasks, *next, *iter;
 	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (burn);
+	BraseroMedium *medium;
+	BraseroDrive *drive;
 
-	/* push the session settings to keep the original session untainted */
-	brasero_burn_session_push_settings (priv->session);
+	drive = brasero_burn_session_get_burner (priv->session);
+	medium = brasero_drive_get_medium (drive);
 
-	/* check flags consistency */
-	result = brasero_burn_check_session_consistency (burn, temp_output, error);
-	if (result != BRASERO_BURN_OK) {
-		brasero_burn_session_pop_settings (priv->session);
-		return result;
-	}
+	if (brasero_burn_session_get_flags (priv->session) & (BRASERO_BURN_FLAG_MERGE|BRASERO_BURN_FLAG_APPEND))
+		priv->session_start = brasero_medium_get_next_writable_address (medium);
+	else
+		priv->session_start = 0;
 
-	/* performed some additional tests that can only be performed at this
-	 * point. They are mere warnings. */
-	result = brasero_burn_check_data_loss (burn, temp_output, error);
-	if (result != BRASERO_BURN_OK) {
-		brasero_burn_session_pop_settings (priv->session);
-		return result;
-	}
+	priv->session_end = priv->session_start + len;
 
-	tasks = brasero_burn_caps_new_task (priv->caps,
-					    priv->session,
-	                                    temp_output,
+	BRASERO_BURN_LOG ("Burning from %lld to %lld",
+			  priv->session_start,
+			  priv->session_end);
+}
+
+/**
+ * The session tag, when set, takes precedence over the user setting
+ */
+
+static gint
+brasero_burn_get_follow_lead (BraseroBurn *burn)
+{
+	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (burn);
+	GSettings *settings;
+	GValue *value = NULL;
+	gint lead;
+
+	brasero_burn_session_tag_lookup (priv->session, BRASERO_SESSION_FOLLOW_LEAD, &value);
+	if (value && G_VALUE_HOLDS_INT (value))
+		return g_value_get_int (value);
+
+	settings = g_settings_new (BRASERO_SCHEMA_CONFIG);
+	lead = g_settings_get_int (settings, BRASERO_PROPS_FOLLOW_IMAGE_LEAD);
+	g_object_unref (settings);
+
+	return lead;
+}
+
+static gboolean
+brasero_burn_can_follow_imager (BraseroBurn *burn,
+				GSList *next)
+{
+	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (burn);
+	BraseroTrackType *output;
+	gboolean result;
+
+	/* Only when the image is created to be burnt right after */
+	if (!next || next->next)
+		return FALSE;
+
+	if (brasero_burn_session_is_dest_file (priv->session))
+		return FALSE;
+
+	if (brasero_burn_get_follow_lead (burn) <= 0)
+		return FALSE;
+
+	/* Images of discs are not always written in order (a damaged disc is
+	 * read in several passes, see BraseroDiscReader) */
+	output = brasero_track_type_new ();
+	brasero_burn_session_get_input_type (priv->session, output);
+	result = brasero_track_type_get_has_medium (output);
+	brasero_track_type_free (output);
+	if (result)
+		return FALSE;
+
+	/* The recorder can only follow a single file */
+	output = brasero_track_type_new ();
+	brasero_task_get_output_type (priv->task, output);
+	result = (brasero_track_type_get_has_image (output)
+	      &&  brasero_track_type_get_image_format (output) == BRASERO_IMAGE_FORMAT_BIN);
+	brasero_track_type_free (output);
+
+	return result;
+}
+
+static void
+brasero_burn_follow_abort_cb (gpointer data)
+{
+	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (data);
+
+	/* The imager failed so the data the recorder burns is incomplete */
+	if (priv->follow_running) {
+		BRASERO_BURN_LOG ("Image creation failed, aborting recording");
+		brasero_task_cancel (priv->follow_recorder, FALSE);
+	}
+}
+
+static void
+brasero_burn_follow_record (BraseroBurn *burn)
+{
+	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (burn);
+	BraseroTrackImage *track;
+	BraseroBurnResult result;
+	goffset blocks = 0;
+
+	priv->follow_started = TRUE;
+
+	/* Put the image being created at the top of the session stack as the
+	 * imager would do once finished; the recorder needs it to start */
+	brasero_task_ctx_get_session_output_size (BRASERO_TASK_CTX (priv->follow_imager),
+						  &blocks,
+						  NULL);
+
+	track = brasero_track_image_new ();
+	brasero_track_image_set_source (track,
+					brasero_image_follower_get_source (priv->follower),
+					NULL,
+					BRASERO_IMAGE_FORMAT_BIN);
+	brasero_track_image_set_block_num (track, blocks);
+
+	brasero_burn_session_push_tracks (priv->session);
+	brasero_burn_session_add_track (priv->session, BRASERO_TRACK (track), NULL);
+	g_object_unref (track);
+
+	/* From now on progress is reported by the recorder */
+	g_signal_handlers_disconnect_by_func (priv->follow_imager,
+					      brasero_burn_progress_changed,
+					      burn);
+	g_signal_handlers_disconnect_by_func (priv->follow_imager,
+					      brasero_burn_action_changed,
+					      burn);
+	priv->tasks_done ++;
+
+	priv->task = priv->follow_recorder;
+	g_signal_connect (priv->task,
+			  "progress-changed",
+			  G_CALLBACK (brasero_burn_progress_changed),
+			  burn);
+	g_signal_connect (priv->task,
+			  "action-changed",
+			  G_CALLBACK (brasero_burn_action_changed),
+			  burn);
+
+	brasero_task_ctx_set_input_follower (BRASERO_TASK_CTX (priv->task), priv->follower);
+
+	BRASERO_BURN_LOG ("Starting recorder while image is being created");
+	result = brasero_burn_run_imager (burn, TRUE, &priv->follow_error);
+	if (result == BRASERO_BURN_OK) {
+		brasero_burn_set_session_addresses (burn, blocks);
+
+		priv->follow_running = TRUE;
+		result = brasero_burn_run_recorder (burn, &priv->follow_error);
+		priv->follow_running = FALSE;
+	}
+
+	brasero_task_ctx_set_input_follower (BRASERO_TASK_CTX (priv->task), NULL);
+	g_signal_handlers_disconnect_by_func (priv->task,
+					      brasero_burn_progress_changed,
+					      burn);
+	g_signal_handlers_disconnect_by_func (priv->task,
+					      brasero_burn_action_changed,
+					      burn);
+
+	priv->task = priv->follow_imager;
+	priv->follow_result = result;
+
+	/* No need to finish the image if it can't be burnt */
+	if (result != BRASERO_BURN_OK && brasero_task_is_running (priv->task))
+		brasero_task_cancel (priv->task, FALSE);
+}
+
+static gboolean
+brasero_burn_follow_cb (gpointer data)
+{
+	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (data);
+
+	if (!brasero_image_follower_is_ready (priv->follower))
+		return TRUE;
+
+	priv->follow_id = 0;
+	brasero_burn_follow_record (BRASERO_BURN (data));
+	return FALSE;
+}
+
+/**
+ * Runs the imager (priv->task) and starts the recorder as soon as enough
+ * of the image was written. Returns BRASERO_BURN_NOT_RUNNING if the image
+ * was completed before the recorder could start.
+ */
+
+static BraseroBurnResult
+brasero_burn_run_imager_following (BraseroBurn *burn,
+				   BraseroTask *recorder,
+				   GError **error)
+{
+	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (burn);
+	BraseroBurnResult result;
+	GError *ret_error = NULL;
+	GSList *tracks = NULL;
+	goffset lead;
+
+	lead = brasero_burn_get_follow_lead (burn);
+	BRASERO_BURN_LOG ("Recorder will follow image with a lead of %" G_GOFFSET_FORMAT " MiB", lead);
+
+	priv->follower = brasero_image_follower_new (lead * 1024 * 1024,
+						     brasero_burn_follow_abort_cb,
+						     burn);
+	priv->follow_imager = priv->task;
+	priv->follow_recorder = recorder;
+	priv->follow_result = BRASERO_BURN_OK;
+	priv->follow_started = FALSE;
+
+	brasero_task_ctx_set_output_follower (BRASERO_TASK_CTX (priv->task), priv->follower);
+	priv->follow_id = brasero_burn_timeout_add (NULL, 250, brasero_burn_follow_cb, burn);
+
+	result = brasero_burn_run_imager (burn, FALSE, &ret_error);
+
+	if (priv->follow_id) {
+		brasero_burn_source_remove (NULL, priv->follow_id);
+		priv->follow_id = 0;
+	}
+
+	brasero_task_ctx_set_output_follower (BRASERO_TASK_CTX (priv->task), NULL);
+	brasero_image_follower_free (priv->follower);
+	priv->follower = NULL;
+
+	priv->follow_imager = NULL;
+	priv->follow_recorder = NULL;
+
+	if (!priv->follow_started) {
+		if (result == BRASERO_BURN_OK)
+			return BRASERO_BURN_NOT_RUNNING;
+
+		if (ret_error)
+			g_propagate_error (error, ret_error);
+
+		return result;
+	}
+
+	priv->follow_started = FALSE;
+
+	/* Restore the session stack as if both tasks had been run in turn.
+	 * If the imager succeeded its tracks are above the one we pushed. */
+	if (result == BRASERO_BURN_OK) {
+		tracks = g_slist_copy (brasero_burn_session_get_tracks (priv->session));
+		g_slist_foreach (tracks, (GFunc) g_object_ref, NULL);
+		brasero_burn_session_pop_tracks (priv->session);
+	}
+	brasero_burn_session_pop_tracks (priv->session);
+
+	if (tracks) {
+		GSList *iter;
+
+		brasero_burn_session_push_tracks (priv->session);
+		for (iter = tracks; iter; iter = iter->next) {
+			brasero_burn_session_add_track (priv->session, iter->data, NULL);
+			g_object_unref (iter->data);
+		}
+		g_slist_free (tracks);
+	}
+
+	/* An imager error explains a recorder failure better */
+	if (result != BRASERO_BURN_OK && result != BRASERO_BURN_CANCEL) {
+		if (priv->follow_error) {
+			g_error_free (priv->follow_error);
+			priv->follow_error = NULL;
+		}
+
+		if (ret_error)
+			g_propagate_error (error, ret_error);
+
+		return result;
+	}
+
+	if (ret_error)
+		g_error_free (ret_error);
+
+	if (priv->follow_error) {
+		g_propagate_error (error, priv->follow_error);
+		priv->follow_error = NULL;
+	}
+
+	/* The imager is cancelled when the recorder fails */
+	if (priv->follow_result != BRASERO_BURN_OK)
+		return priv->follow_result;
+
+	return result;
+}
+
+/* FIXME: at the moment we don't allow for mixed CD type */
+static BraseroBurnResult
+brasero_burn_run_tasks (BraseroBurn *burn,
+			gboolean erase_allowed,
+                        BraseroTrackType *temp_output,
+                        gboolean *dummy_session,
+			GError **error)
+{
+	BraseroBurnResult result;
+	GSList *tasks, *next, *iter;
+	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (burn);
+
+	/* push the session settings to keep the original session untainted */
+	brasero_burn_session_push_settings (priv->session);
+
+	/* check flags consistency */
+	result = brasero_burn_check_session_consistency (burn, temp_output, error);
+	if (result != BRASERO_BURN_OK) {
+		brasero_burn_session_pop_settings (priv->session);
+		return result;
+	}
+
+	/* performed some additional tests that can only be performed at this
+	 * point. They are mere warnings. */
+	result = brasero_burn_check_data_loss (burn, temp_output, error);
+	if (result != BRASERO_BURN_OK) {
+		brasero_burn_session_pop_settings (priv->session);
+		return result;
+	}
+
+	tasks = brasero_burn_caps_new_task (priv->caps,
+					    priv->session,
+	                                    temp_output,
 					    error);
 	if (!tasks) {
 		brasero_burn_session_pop_settings (priv->session);
@@ -2083,8 +2819,6 @@ brasero_burn_run_tasks (BraseroBurn *burn,
 	/* run all imaging tasks first */
 	for (iter = tasks; iter; iter = next) {
 		goffset len = 0;
-		BraseroDrive *drive;
-		BraseroMedium *medium;
 		BraseroTaskAction action;
 
 		next = iter->next;
@@ -2215,19 +2949,7 @@ brasero_burn_run_tasks (BraseroBurn *burn,
 							  &len,
 							  NULL);
 
-		drive = brasero_burn_session_get_burner (priv->session);
-		medium = brasero_drive_get_medium (drive);
-
-		if (brasero_burn_session_get_flags (priv->session) & (BRASERO_BURN_FLAG_MERGE|BRASERO_BURN_FLAG_APPEND))
-			priv->session_start = brasero_medium_get_next_writable_address (medium);
-		else
-			priv->session_start = 0;
-
-		priv->session_end = priv->session_start + len;
-
-		BRASERO_BURN_LOG ("Burning from %lld to %lld",
-				  priv->session_start,
-				  priv->session_end);
+		brasero_burn_set_session_addresses (burn, len);
 
 		/* see if we reached a recording task: it's the last task */
 		if (!next) {
@@ -2244,8 +2966,25 @@ brasero_burn_run_tasks (BraseroBurn *burn,
 			break;
 		}
 
-		/* run the imager */
-		result = brasero_burn_run_imager (burn, FALSE, error);
+		/* run the imager; the recorder may start before it is done */
+		if (brasero_burn_can_follow_imager (burn, next)) {
+			result = brasero_burn_run_imager_following (burn,
+								    next->data,
+								    error);
+			if (result != BRASERO_BURN_NOT_RUNNING) {
+				if (result == BRASERO_BURN_OK) {
+					*dummy_session = (brasero_burn_session_get_flags (priv->session) & BRASERO_BURN_FLAG_DUMMY);
+					priv->tasks_done ++;
+				}
+				break;
+			}
+
+			/* The image was complete before the recorder started */
+			result = BRASERO_BURN_OK;
+		}
+		else
+			result = brasero_burn_run_imager (burn, FALSE, error);
+
 		if (result != BRASERO_BURN_OK)
 			break;
 
@@ -2373,6 +3112,7 @@ brasero_burn_record_session (BraseroBurn *burn,
 	BraseroBurnPrivate *priv;
 	BraseroBurnResult result;
 	GError *ret_error = NULL;
+	gchar *cache_key = NULL;
 	GSList *tracks;
 
 	priv = BRASERO_BURN_PRIVATE (burn);
@@ -2381,6 +3121,33 @@ brasero_burn_record_session (BraseroBurn *burn,
 	 * same even if it is created from the same files */
 	brasero_burn_unset_checksums (burn);
 
+	/* forget about the speed of any previous recording */
+	g_free (priv->profile_key);
+	priv->profile_key = NULL;
+
+	/* See if the image of this data project was already created for a
+	 * previous burn and nothing changed since then. In this case the
+	 * image is put at the top of the session stack like a temporary
+	 * image created by a job would be. */
+	if (!temp_output && !brasero_burn_session_is_dest_file (priv->session))
+		cache_key = brasero_image_cache_get_key (priv->session);
+
+	if (cache_key) {
+		BraseroTrackImage *cached;
+
+		cached = brasero_image_cache_lookup (cache_key);
+		if (cached) {
+			brasero_burn_session_push_tracks (priv->session);
+			brasero_burn_session_add_track (priv->session,
+							BRASERO_TRACK (cached),
+							NULL);
+			g_object_unref (cached);
+
+			g_free (cache_key);
+			cache_key = NULL;
+		}
+	}
+
 	do {
 		if (ret_error) {
 			g_error_free (ret_error);
@@ -2401,9 +3168,23 @@ brasero_burn_record_session (BraseroBurn *burn,
 			ret_error = NULL;
 		}
 
+		g_free (cache_key);
 		return result;
 	}
 
+	if (cache_key) {
+		/* If a temporary image was created, it is at the top of the
+		 * session stack of tracks. */
+		tracks = brasero_burn_session_get_tracks (priv->session);
+		if (!dummy_session
+		&&  g_slist_length (tracks) == 1
+		&&  BRASERO_IS_TRACK_IMAGE (tracks->data))
+			brasero_image_cache_add (cache_key, tracks->data);
+
+		g_free (cache_key);
+		cache_key = NULL;
+	}
+
 	if (brasero_burn_session_is_dest_file (priv->session))
 		return BRASERO_BURN_OK;
 
@@ -2438,6 +3219,10 @@ brasero_burn_record_session (BraseroBurn *burn,
 		return result;
 	}
 
+	result = brasero_burn_stop_bg_format (burn, error);
+	if (result != BRASERO_BURN_OK)
+		return result;
+
 	/* see if we have a checksum generated for the session if so use
 	 * it to check if the recording went well remaining on the top of
 	 * the session should be the last track burnt/imaged */
@@ -2522,9 +3307,21 @@ brasero_burn_record_session (BraseroBurn *burn,
 				       value);
 	}
 
-	result = brasero_burn_check_real (burn, track, error);
+	result = brasero_burn_check_real (burn, track, &ret_error);
 	brasero_burn_session_pop_tracks (priv->session);
 
+	/* the speed may be too high for this kind of medium */
+	if (priv->profile_key
+	&&  result == BRASERO_BURN_ERR
+	&&  g_error_matches (ret_error, BRASERO_BURN_ERROR, BRASERO_BURN_ERROR_BAD_CHECKSUM))
+		brasero_speed_profile_add (priv->profile_key,
+					   priv->profile_rate,
+					   0,
+					   BRASERO_SPEED_OUTCOME_BAD_CHECK);
+
+	if (ret_error)
+		g_propagate_error (error, ret_error);
+
 	if (result == BRASERO_BURN_CANCEL) {
 		/* change the result value so we won't stop here if there are 
 		 * other copies to be made */
@@ -2873,88 +3670,1285 @@ end:
 	return result;
 }
 
-static BraseroBurnResult
-brasero_burn_blank_real (BraseroBurn *burn, GError **error)
-{
-	BraseroBurnResult result;
-	BraseroBurnPrivate *priv;
+/**
+ * Used to record the same image to several drives at the same time.
+ * Each real drive is driven by its own BraseroBurn running on its own thread
+ * and main context, so that no drive has to wait for another one to return.
+ * What these report is passed on through the main context of the parent and
+ * the questions they ask are asked again by the parent.
+ */
 
-	priv = BRASERO_BURN_PRIVATE (burn);
+typedef struct _BraseroBurnRecorder BraseroBurnRecorder;
+struct _BraseroBurnRecorder {
+	BraseroBurn *parent;
+	BraseroDrive *drive;
 
-	priv->task = brasero_burn_caps_new_blanking_task (priv->caps,
-							  priv->session,
-							  error);
-	if (!priv->task)
-		return BRASERO_BURN_NOT_SUPPORTED;
+	/* Used for real drives */
+	BraseroBurn *burn;
+	BraseroBurnSession *session;
+	GMainContext *context;
+	GThread *thread;
 
-	g_signal_connect (priv->task,
-			  "progress-changed",
-			  G_CALLBACK (brasero_burn_progress_changed),
-			  burn);
-	g_signal_connect (priv->task,
-			  "action-changed",
-			  G_CALLBACK (brasero_burn_action_changed),
-			  burn);
+	/* Protect running and requests (the requests made to the thread) */
+	GMutex *mutex;
+	GCond *cond;
+	guint requests;
 
-	result = brasero_burn_run_eraser (burn, error);
-	g_object_unref (priv->task);
-	priv->task = NULL;
+	/* Used for fake drives (image files) */
+	GCancellable *cancel;
+	gchar *output;
 
-	return result;
-}
+	gdouble progress;
+	glong remaining;
 
-/**
- * brasero_burn_blank:
- * @burn: a #BraseroBurn
- * @session: a #BraseroBurnSession
- * @error: a #GError
- *
- * Blanks a medium according to the parameters
- * set in @session. The medium must be inserted in the #BraseroDrive
- * set with brasero_burn_session_set_burner ().
- *
- * Return value: a #BraseroBurnResult. The result of the operation. 
- * BRASERO_BURN_OK if it was successful.
- **/
+	/* Used when spanning; volume is 1 for the first disc */
+	guint volume;
+	GTimer *timer;
+	gdouble recorded;
 
-BraseroBurnResult
-brasero_burn_blank (BraseroBurn *burn,
-		    BraseroBurnSession *session,
-		    GError **error)
-{
-	BraseroBurnPrivate *priv;
 	BraseroBurnResult result;
-	GError *ret_error = NULL;
+	GError *error;
 
-	g_return_val_if_fail (burn != NULL, BRASERO_BURN_ERR);
-	g_return_val_if_fail (session != NULL, BRASERO_BURN_ERR);
+	guint running:1;
+	guint finished:1;
+};
 
-	priv = BRASERO_BURN_PRIVATE (burn);
+typedef enum {
+	BRASERO_BURN_RECORDER_PROGRESS,
+	BRASERO_BURN_RECORDER_ACTION,
+	BRASERO_BURN_RECORDER_FINISHED
+} BraseroBurnRecorderEventType;
+
+typedef struct _BraseroBurnRecorderEvent BraseroBurnRecorderEvent;
+struct _BraseroBurnRecorderEvent {
+	BraseroBurnRecorder *recorder;
+	BraseroBurnRecorderEventType type;
+
+	gdouble progress;
+	glong remaining;
+	BraseroBurnAction action;
+};
 
-	g_object_ref (session);
-	priv->session = session;
+typedef struct _BraseroBurnRecorderQuestion BraseroBurnRecorderQuestion;
+struct _BraseroBurnRecorderQuestion {
+	BraseroBurnRecorder *recorder;
 
-	brasero_burn_powermanagement (burn, TRUE);
+	guint signal_id;
+	GValue *params;
+	GValue *return_value;
 
-	/* we wait for the insertion of a media and lock it */
-	result = brasero_burn_lock_rewritable_media (burn, error);
-	if (result != BRASERO_BURN_OK)
-		goto end;
+	gboolean answered;
+};
 
-	result = brasero_burn_blank_real (burn, &ret_error);
-	while (result == BRASERO_BURN_ERR &&
-	       ret_error &&
-	       ret_error->code == BRASERO_BURN_ERROR_MEDIUM_NOT_REWRITABLE) {
-		g_error_free (ret_error);
-		ret_error = NULL;
+typedef struct _BraseroBurnRecorderCancel BraseroBurnRecorderCancel;
+struct _BraseroBurnRecorderCancel {
+	BraseroBurnRecorder *recorder;
+	gboolean protect;
 
-		result = brasero_burn_ask_for_dest_media (burn,
-							  BRASERO_BURN_ERROR_MEDIUM_NOT_REWRITABLE,
-							  BRASERO_MEDIUM_REWRITABLE|
-							  BRASERO_MEDIUM_HAS_DATA,
-							  error);
-		if (result != BRASERO_BURN_OK)
-			break;
+	BraseroBurnResult result;
+	gboolean done;
+};
+
+/* The questions a recorder can ask and that the parent asks again */
+static const BraseroBurnSignalType forwarded_signals [] = {
+	ASK_DISABLE_JOLIET_SIGNAL,
+	WARN_DATA_LOSS_SIGNAL,
+	WARN_PREVIOUS_SESSION_LOSS_SIGNAL,
+	WARN_AUDIO_TO_APPENDABLE_SIGNAL,
+	WARN_REWRITABLE_SIGNAL,
+	INSERT_MEDIA_REQUEST_SIGNAL,
+	DUMMY_SUCCESS_SIGNAL,
+	EJECT_FAILURE_SIGNAL,
+	BLANK_FAILURE_SIGNAL,
+	INSTALL_MISSING_SIGNAL,
+	WARN_DAMAGED_MEDIUM_SIGNAL
+};
+
+static void
+brasero_burn_recorder_free (BraseroBurnRecorder *recorder)
+{
+	if (recorder->thread)
+		g_thread_join (recorder->thread);
+
+	if (recorder->burn)
+		g_object_unref (recorder->burn);
+
+	if (recorder->session)
+		g_object_unref (recorder->session);
+
+	if (recorder->context)
+		g_main_context_unref (recorder->context);
+
+	if (recorder->mutex)
+		g_mutex_free (recorder->mutex);
+
+	if (recorder->cond)
+		g_cond_free (recorder->cond);
+
+	if (recorder->cancel)
+		g_object_unref (recorder->cancel);
+
+	if (recorder->error)
+		g_error_free (recorder->error);
+
+	if (recorder->timer)
+		g_timer_destroy (recorder->timer);
+
+	g_object_unref (recorder->drive);
+	g_free (recorder->output);
+	g_free (recorder);
+}
+
+static void
+brasero_burn_recorders_report_progress (BraseroBurn *burn)
+{
+	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (burn);
+	gdouble progress = 0.0;
+	glong remaining = -1;
+	guint num = 0;
+	GSList *iter;
+
+	/* The overall progress is the average of the progress of all drives
+	 * while the remaining time is the one of the slowest drive. */
+	for (iter = priv->recorders; iter; iter = iter->next) {
+		BraseroBurnRecorder *recorder;
+
+		recorder = iter->data;
+		if (recorder->progress >= 0.0)
+			progress += recorder->progress;
+
+		remaining = MAX (remaining, recorder->remaining);
+		num ++;
+	}
+
+	if (!num)
+		return;
+
+	g_signal_emit (burn,
+		       brasero_burn_signals [PROGRESS_CHANGED_SIGNAL],
+		       0,
+		       progress / (gdouble) num,
+		       progress / (gdouble) num,
+		       remaining);
+}
+
+static void
+brasero_burn_recorder_finished (BraseroBurnRecorder *recorder)
+{
+	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (recorder->parent);
+
+	recorder->finished = TRUE;
+	if (recorder->result == BRASERO_BURN_OK) {
+		recorder->progress = 1.0;
+		recorder->remaining = 0;
+	}
+
+	BRASERO_BURN_LOG ("Recorder for %s finished (%i)",
+			  brasero_drive_get_device (recorder->drive),
+			  recorder->result);
+
+	if (recorder->timer) {
+		gdouble elapsed;
+
+		elapsed = g_timer_elapsed (recorder->timer, NULL);
+		priv->recorders_time += elapsed;
+
+		if (recorder->volume)
+			BRASERO_BURN_DEBUG (recorder->parent,
+					    "Volume %i on %s took %.1f s (%.1f s recording, %.1f s checking)",
+					    recorder->volume,
+					    brasero_drive_get_device (recorder->drive),
+					    elapsed,
+					    recorder->recorded >= 0.0? recorder->recorded:elapsed,
+					    recorder->recorded >= 0.0? elapsed - recorder->recorded:0.0);
+	}
+
+	g_signal_emit (recorder->parent,
+		       brasero_burn_signals [DRIVE_FINISHED_SIGNAL],
+		       0,
+		       recorder->drive,
+		       recorder->result,
+		       recorder->error);
+
+	brasero_burn_recorders_report_progress (recorder->parent);
+
+	/* Whoever waits wants to know as soon as one drive is available */
+	priv->recorders_running --;
+	if (priv->recorders_loop && g_main_loop_is_running (priv->recorders_loop))
+		g_main_loop_quit (priv->recorders_loop);
+}
+
+static void
+brasero_burn_recorder_set_progress (BraseroBurnRecorder *recorder,
+				    gdouble progress,
+				    glong remaining)
+{
+	recorder->progress = progress;
+	recorder->remaining = remaining;
+
+	g_signal_emit (recorder->parent,
+		       brasero_burn_signals [DRIVE_PROGRESS_CHANGED_SIGNAL],
+		       0,
+		       recorder->drive,
+		       progress,
+		       remaining);
+
+	brasero_burn_recorders_report_progress (recorder->parent);
+}
+
+static gboolean
+brasero_burn_recorder_event_cb (gpointer data)
+{
+	BraseroBurnRecorderEvent *event = data;
+	BraseroBurnRecorder *recorder = event->recorder;
+
+	switch (event->type) {
+	case BRASERO_BURN_RECORDER_PROGRESS:
+		brasero_burn_recorder_set_progress (recorder,
+						    event->progress,
+						    event->remaining);
+		break;
+
+	case BRASERO_BURN_RECORDER_ACTION:
+		/* Recording is over once the disc is being checked */
+		if (event->action == BRASERO_BURN_ACTION_CHECKSUM && recorder->recorded < 0.0)
+			recorder->recorded = g_timer_elapsed (recorder->timer, NULL);
+		break;
+
+	case BRASERO_BURN_RECORDER_FINISHED:
+		g_thread_join (recorder->thread);
+		recorder->thread = NULL;
+
+		brasero_burn_recorder_finished (recorder);
+		break;
+	}
+
+	g_free (event);
+	return FALSE;
+}
+
+static void
+brasero_burn_recorder_post_event (BraseroBurnRecorder *recorder,
+				  BraseroBurnRecorderEvent *event)
+{
+	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (recorder->parent);
+
+	/* All events have the same priority so they keep their order and
+	 * FINISHED is always the last one to be dispatched */
+	event->recorder = recorder;
+	brasero_burn_idle_add (priv->recorders_context,
+			       brasero_burn_recorder_event_cb,
+			       event);
+}
+
+static void
+brasero_burn_recorder_progress_changed (BraseroBurn *burn,
+					gdouble overall_progress,
+					gdouble action_progress,
+					glong time_remaining,
+					BraseroBurnRecorder *recorder)
+{
+	BraseroBurnRecorderEvent *event;
+
+	event = g_new0 (BraseroBurnRecorderEvent, 1);
+	event->type = BRASERO_BURN_RECORDER_PROGRESS;
+	event->progress = overall_progress;
+	event->remaining = time_remaining;
+	brasero_burn_recorder_post_event (recorder, event);
+}
+
+static void
+brasero_burn_recorder_action_changed (BraseroBurn *burn,
+				      BraseroBurnAction action,
+				      BraseroBurnRecorder *recorder)
+{
+	BraseroBurnRecorderEvent *event;
+
+	event = g_new0 (BraseroBurnRecorderEvent, 1);
+	event->type = BRASERO_BURN_RECORDER_ACTION;
+	event->action = action;
+	brasero_burn_recorder_post_event (recorder, event);
+}
+
+static gboolean
+brasero_burn_recorder_ask_cb (gpointer data)
+{
+	BraseroBurnRecorderQuestion *question = data;
+	BraseroBurnRecorder *recorder = question->recorder;
+
+	g_signal_emitv (question->params,
+			question->signal_id,
+			0,
+			question->return_value);
+
+	g_mutex_lock (recorder->mutex);
+	question->answered = TRUE;
+	g_mutex_unlock (recorder->mutex);
+
+	g_main_context_wakeup (recorder->context);
+	return FALSE;
+}
+
+static void
+brasero_burn_recorder_forward_marshal (GClosure *closure,
+				       GValue *return_value,
+				       guint n_param_values,
+				       const GValue *param_values,
+				       gpointer invocation_hint,
+				       gpointer marshal_data)
+{
+	GSignalInvocationHint *hint = invocation_hint;
+	BraseroBurnRecorder *recorder = closure->data;
+	BraseroBurnRecorderQuestion question = { NULL, };
+	BraseroBurnPrivate *priv;
+	guint i;
+
+	priv = BRASERO_BURN_PRIVATE (recorder->parent);
+
+	/* Runs in the recorder thread: the parent asks the same question with
+	 * the same default answer from its own main context */
+	question.recorder = recorder;
+	question.signal_id = hint->signal_id;
+	question.return_value = return_value;
+
+	question.params = g_new0 (GValue, n_param_values);
+	g_value_init (question.params, G_TYPE_FROM_INSTANCE (recorder->parent));
+	g_value_set_instance (question.params, recorder->parent);
+	for (i = 1; i < n_param_values; i ++) {
+		g_value_init (question.params + i, G_VALUE_TYPE (param_values + i));
+		g_value_copy (param_values + i, question.params + i);
+	}
+
+	BRASERO_BURN_LOG ("Forwarding question %s from %s",
+			  g_signal_name (hint->signal_id),
+			  brasero_drive_get_device (recorder->drive));
+
+	brasero_burn_idle_add (priv->recorders_context,
+			       brasero_burn_recorder_ask_cb,
+			       &question);
+
+	/* Keep our own context running meanwhile; we can be cancelled */
+	g_mutex_lock (recorder->mutex);
+	while (!question.answered) {
+		g_mutex_unlock (recorder->mutex);
+		g_main_context_iteration (recorder->context, TRUE);
+		g_mutex_lock (recorder->mutex);
+	}
+	g_mutex_unlock (recorder->mutex);
+
+	for (i = 0; i < n_param_values; i ++)
+		g_value_unset (question.params + i);
+
+	g_free (question.params);
+}
+
+static gboolean
+brasero_burn_recorder_cancel_cb (gpointer data)
+{
+	BraseroBurnRecorderCancel *request = data;
+	BraseroBurnRecorder *recorder = request->recorder;
+	BraseroBurnResult result;
+
+	result = brasero_burn_cancel (recorder->burn, request->protect);
+
+	g_mutex_lock (recorder->mutex);
+	request->result = result;
+	request->done = TRUE;
+	recorder->requests --;
+	g_cond_broadcast (recorder->cond);
+	g_mutex_unlock (recorder->mutex);
+
+	return FALSE;
+}
+
+static BraseroBurnResult
+brasero_burn_recorder_cancel (BraseroBurnRecorder *recorder,
+			      gboolean protect)
+{
+	BraseroBurnRecorderCancel request = { NULL, };
+
+	if (recorder->cancel) {
+		g_cancellable_cancel (recorder->cancel);
+		return BRASERO_BURN_OK;
+	}
+
+	if (!recorder->burn)
+		return BRASERO_BURN_OK;
+
+	request.recorder = recorder;
+	request.protect = protect;
+	request.result = BRASERO_BURN_OK;
+
+	/* The burn must be cancelled from the thread it runs in; the thread
+	 * handles the requests made while running before it returns */
+	g_mutex_lock (recorder->mutex);
+	if (recorder->running) {
+		recorder->requests ++;
+		brasero_burn_idle_add (recorder->context,
+				       brasero_burn_recorder_cancel_cb,
+				       &request);
+
+		while (!request.done)
+			g_cond_wait (recorder->cond, recorder->mutex);
+	}
+	g_mutex_unlock (recorder->mutex);
+
+	return request.result;
+}
+
+static gpointer
+brasero_burn_recorder_thread (gpointer data)
+{
+	BraseroBurnRecorder *recorder = data;
+	BraseroBurnRecorderEvent *event;
+
+	g_main_context_push_thread_default (recorder->context);
+
+	recorder->result = brasero_burn_record (recorder->burn,
+						recorder->session,
+						&recorder->error);
+
+	g_mutex_lock (recorder->mutex);
+	recorder->running = FALSE;
+	while (recorder->requests) {
+		g_mutex_unlock (recorder->mutex);
+		g_main_context_iteration (recorder->context, TRUE);
+		g_mutex_lock (recorder->mutex);
+	}
+	g_mutex_unlock (recorder->mutex);
+
+	g_main_context_pop_thread_default (recorder->context);
+
+	event = g_new0 (BraseroBurnRecorderEvent, 1);
+	event->type = BRASERO_BURN_RECORDER_FINISHED;
+	brasero_burn_recorder_post_event (recorder, event);
+
+	return NULL;
+}
+
+static void
+brasero_burn_recorder_copy_progress (goffset current_num_bytes,
+				     goffset total_num_bytes,
+				     gpointer user_data)
+{
+	BraseroBurnRecorder *recorder = user_data;
+
+	if (total_num_bytes <= 0)
+		return;
+
+	brasero_burn_recorder_set_progress (recorder,
+					    (gdouble) current_num_bytes / (gdouble) total_num_bytes,
+					    -1);
+}
+
+static void
+brasero_burn_recorder_copy_cb (GObject *object,
+			       GAsyncResult *result,
+			       gpointer user_data)
+{
+	BraseroBurnRecorder *recorder = user_data;
+
+	if (g_file_copy_finish (G_FILE (object), result, &recorder->error))
+		recorder->result = BRASERO_BURN_OK;
+	else if (g_error_matches (recorder->error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+		recorder->result = BRASERO_BURN_CANCEL;
+	else
+		recorder->result = BRASERO_BURN_ERR;
+
+	brasero_burn_recorder_finished (recorder);
+}
+
+static BraseroBurnResult
+brasero_burn_recorder_copy_image (BraseroBurnRecorder *recorder,
+				  GError **error)
+{
+	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (recorder->parent);
+	gchar *image = NULL;
+	gchar *toc = NULL;
+	GFile *dest;
+	GFile *src;
+	GSList *tracks;
+
+	if (!recorder->output) {
+		g_set_error (error,
+			     BRASERO_BURN_ERROR,
+			     BRASERO_BURN_ERROR_OUTPUT_NONE,
+			     "%s", _("No path was specified for the image output"));
+		return BRASERO_BURN_ERR;
+	}
+
+	/* A fake drive "records" by copying the image to its output path */
+	tracks = brasero_burn_session_get_tracks (priv->session);
+	if (g_slist_length (tracks) != 1
+	|| !BRASERO_IS_TRACK_IMAGE (tracks->data)) {
+		g_set_error (error,
+			     BRASERO_BURN_ERROR,
+			     BRASERO_BURN_ERROR_GENERAL,
+			     "%s", _("An internal error occurred"));
+		return BRASERO_BURN_NOT_SUPPORTED;
+	}
+
+	toc = brasero_track_image_get_toc_source (tracks->data, FALSE);
+	if (toc) {
+		/* The TOC would reference the original image */
+		BRASERO_BURN_LOG ("Image with a TOC cannot be copied to %s", recorder->output);
+		g_free (toc);
+
+		g_set_error (error,
+			     BRASERO_BURN_ERROR,
+			     BRASERO_BURN_ERROR_GENERAL,
+			     "%s", _("An internal error occurred"));
+		return BRASERO_BURN_NOT_SUPPORTED;
+	}
+
+	image = brasero_track_image_get_source (tracks->data, FALSE);
+	if (!g_strcmp0 (image, recorder->output)) {
+		/* That's the image that was just created */
+		g_free (image);
+		return BRASERO_BURN_NOT_RUNNING;
+	}
+
+	BRASERO_BURN_LOG ("Copying image %s to %s", image, recorder->output);
+
+	src = g_file_new_for_path (image);
+	dest = g_file_new_for_path (recorder->output);
+	g_free (image);
+
+	recorder->cancel = g_cancellable_new ();
+	g_file_copy_async (src,
+			   dest,
+			   G_FILE_COPY_OVERWRITE,
+			   G_PRIORITY_DEFAULT,
+			   recorder->cancel,
+			   brasero_burn_recorder_copy_progress,
+			   recorder,
+			   brasero_burn_recorder_copy_cb,
+			   recorder);
+
+	g_object_unref (src);
+	g_object_unref (dest);
+
+	return BRASERO_BURN_OK;
+}
+
+static BraseroBurnRecorder *
+brasero_burn_recorder_new (BraseroBurn *burn,
+			   BraseroDrive *drive,
+			   guint index)
+{
+	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (burn);
+	BraseroBurnRecorder *recorder;
+	guint i;
+
+	recorder = g_new0 (BraseroBurnRecorder, 1);
+	recorder->parent = burn;
+	recorder->drive = g_object_ref (drive);
+	recorder->progress = -1.0;
+	recorder->remaining = -1;
+	recorder->recorded = -1.0;
+	recorder->result = BRASERO_BURN_NOT_RUNNING;
+
+	if (brasero_drive_is_fake (drive)) {
+		gchar *image = NULL;
+
+		/* Several fake drives write next to each other */
+		brasero_burn_session_get_output (priv->session, &image, NULL);
+		if (image && index)
+			recorder->output = g_strdup_printf ("%s.%i", image, index);
+		else
+			recorder->output = g_strdup (image);
+
+		g_free (image);
+		return recorder;
+	}
+
+	/* Each real drive gets its own session; the tracks are added by the
+	 * caller. */
+	recorder->session = brasero_burn_session_new ();
+	brasero_burn_session_set_burner (recorder->session, drive);
+	brasero_burn_session_set_flags (recorder->session, brasero_burn_session_get_flags (priv->session));
+	brasero_burn_session_set_rate (recorder->session, brasero_burn_session_get_rate (priv->session));
+	brasero_burn_session_set_tmpdir (recorder->session, brasero_burn_session_get_tmpdir (priv->session));
+	brasero_burn_session_set_label (recorder->session, brasero_burn_session_get_label (priv->session));
+
+	recorder->context = g_main_context_new ();
+	recorder->mutex = g_mutex_new ();
+	recorder->cond = g_cond_new ();
+
+	recorder->burn = brasero_burn_new ();
+	g_signal_connect (recorder->burn,
+			  "progress-changed",
+			  G_CALLBACK (brasero_burn_recorder_progress_changed),
+			  recorder);
+	g_signal_connect (recorder->burn,
+			  "action-changed",
+			  G_CALLBACK (brasero_burn_recorder_action_changed),
+			  recorder);
+
+	for (i = 0; i < G_N_ELEMENTS (forwarded_signals); i ++) {
+		GClosure *closure;
+
+		closure = g_closure_new_simple (sizeof (GClosure), recorder);
+		g_closure_set_marshal (closure, brasero_burn_recorder_forward_marshal);
+		g_signal_connect_closure_by_id (recorder->burn,
+						brasero_burn_signals [forwarded_signals [i]],
+						0,
+						closure,
+						FALSE);
+	}
+
+	return recorder;
+}
+
+static void
+brasero_burn_recorder_start (BraseroBurnRecorder *recorder)
+{
+	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (recorder->parent);
+	BraseroBurnResult result;
+
+	priv->recorders_running ++;
+	recorder->timer = g_timer_new ();
+
+	if (!recorder->burn) {
+		result = brasero_burn_recorder_copy_image (recorder, &recorder->error);
+		if (result == BRASERO_BURN_OK)
+			return;
+
+		if (result == BRASERO_BURN_NOT_RUNNING)
+			result = BRASERO_BURN_OK;
+
+		recorder->result = result;
+		brasero_burn_recorder_finished (recorder);
+		return;
+	}
+
+	recorder->running = TRUE;
+	recorder->thread = g_thread_create (brasero_burn_recorder_thread,
+					    recorder,
+					    TRUE,
+					    &recorder->error);
+	if (!recorder->thread) {
+		recorder->running = FALSE;
+		recorder->result = BRASERO_BURN_ERR;
+		brasero_burn_recorder_finished (recorder);
+	}
+}
+
+static void
+brasero_burn_recorders_run (BraseroBurn *burn)
+{
+	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (burn);
+
+	/* Returns as soon as a recorder finished */
+	if (!priv->recorders_running)
+		return;
+
+	priv->recorders_loop = g_main_loop_new (priv->recorders_context, FALSE);
+	g_main_loop_run (priv->recorders_loop);
+	g_main_loop_unref (priv->recorders_loop);
+	priv->recorders_loop = NULL;
+}
+
+static BraseroBurnResult
+brasero_burn_recorders_reap (BraseroBurn *burn,
+			     GSList **available)
+{
+	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (burn);
+	BraseroBurnResult result = BRASERO_BURN_OK;
+	GSList *next;
+	GSList *iter;
+
+	/* Free the recorders that finished and return the worst result; the
+	 * drives that succeeded are available for another recording */
+	for (iter = priv->recorders; iter; iter = next) {
+		BraseroBurnRecorder *recorder;
+
+		next = iter->next;
+		recorder = iter->data;
+		if (!recorder->finished)
+			continue;
+
+		priv->recorders_done ++;
+		if (recorder->result == BRASERO_BURN_OK) {
+			if (available)
+				*available = g_slist_append (*available, recorder->drive);
+		}
+		else {
+			BRASERO_BURN_DEBUG (burn,
+					    "Recording to %s failed: %s",
+					    brasero_drive_get_device (recorder->drive),
+					    recorder->error ? recorder->error->message:"unknown");
+
+			if (recorder->result == BRASERO_BURN_CANCEL) {
+				if (result == BRASERO_BURN_OK)
+					result = BRASERO_BURN_CANCEL;
+			}
+			else {
+				result = BRASERO_BURN_ERR;
+				priv->recorders_failed ++;
+			}
+		}
+
+		priv->recorders = g_slist_delete_link (priv->recorders, iter);
+		brasero_burn_recorder_free (recorder);
+	}
+
+	return result;
+}
+
+static void
+brasero_burn_recorders_set_error (BraseroBurn *burn,
+				  GError **error)
+{
+	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (burn);
+
+	if (!priv->recorders_failed)
+		return;
+
+	g_set_error (error,
+		     BRASERO_BURN_ERROR,
+		     BRASERO_BURN_ERROR_GENERAL,
+		     ngettext ("Recording failed for %i drive out of %i",
+			       "Recording failed for %i drives out of %i",
+			       priv->recorders_failed),
+		     priv->recorders_failed,
+		     priv->recorders_done);
+}
+
+static BraseroBurnResult
+brasero_burn_run_recorders (BraseroBurn *burn,
+			    GSList *drives,
+			    GError **error)
+{
+	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (burn);
+	BraseroBurnResult result;
+	guint index = 0;
+	GSList *iter;
+
+	brasero_burn_action_changed_real (burn, BRASERO_BURN_ACTION_RECORDING);
+
+	for (iter = drives; iter; iter = iter->next) {
+		BraseroBurnRecorder *recorder;
+		GSList *tracks;
+
+		recorder = brasero_burn_recorder_new (burn, iter->data, index);
+		priv->recorders = g_slist_append (priv->recorders, recorder);
+
+		if (brasero_drive_is_fake (recorder->drive)) {
+			index ++;
+			continue;
+		}
+
+		/* Real drives record the tracks at the top of the stack */
+		tracks = brasero_burn_session_get_tracks (priv->session);
+		for (; tracks; tracks = tracks->next)
+			brasero_burn_session_add_track (recorder->session, tracks->data, NULL);
+	}
+
+	/* Start all recorders; one failing doesn't stop the others */
+	for (iter = priv->recorders; iter; iter = iter->next)
+		brasero_burn_recorder_start (iter->data);
+
+	while (priv->recorders_running)
+		brasero_burn_recorders_run (burn);
+
+	result = brasero_burn_recorders_reap (burn, NULL);
+	brasero_burn_recorders_set_error (burn, error);
+	return result;
+}
+
+static BraseroBurnResult
+brasero_burn_multi_image (BraseroBurn *self,
+			  GError **error)
+{
+	BraseroTrackImage *track;
+	BraseroBurnResult result;
+	BraseroBurnPrivate *priv;
+	BraseroTrackType *output;
+	gchar *image = NULL;
+	gchar *toc = NULL;
+
+	priv = BRASERO_BURN_PRIVATE (self);
+
+	output = brasero_track_type_new ();
+	brasero_burn_session_get_input_type (priv->session, output);
+	if (brasero_track_type_get_has_image (output)) {
+		/* Nothing to do; the image is recorded as is */
+		brasero_track_type_free (output);
+		return BRASERO_BURN_OK;
+	}
+
+	if (brasero_track_type_get_has_medium (output)) {
+		result = brasero_burn_lock_src_media (self, error);
+		if (result != BRASERO_BURN_OK) {
+			brasero_track_type_free (output);
+			return result;
+		}
+	}
+
+	if (!brasero_burn_session_is_dest_file (priv->session)) {
+		gchar *cache_key;
+
+		cache_key = brasero_image_cache_get_key (priv->session);
+		if (cache_key) {
+			track = brasero_image_cache_lookup (cache_key);
+			if (track) {
+				brasero_burn_session_push_tracks (priv->session);
+				brasero_burn_session_add_track (priv->session, BRASERO_TRACK (track), NULL);
+				g_object_unref (track);
+
+				brasero_track_type_free (output);
+				g_free (cache_key);
+				return BRASERO_BURN_OK;
+			}
+		}
+
+		/* Build the image once in a temporary file that all the drives
+		 * will then record. It stays at the top of the session stack
+		 * of tracks afterwards. */
+		result = brasero_burn_session_get_tmp_image_type_same_src_dest (priv->session, output);
+		if (result != BRASERO_BURN_OK) {
+			brasero_track_type_free (output);
+			g_free (cache_key);
+			g_set_error (error,
+				     BRASERO_BURN_ERROR,
+				     BRASERO_BURN_ERROR_GENERAL,
+				     "%s", _("No format for the temporary image could be found"));
+			return result;
+		}
+
+		result = brasero_burn_record_session (self, TRUE, output, error);
+		brasero_track_type_free (output);
+		brasero_burn_unlock_src_media (self, NULL);
+
+		if (result == BRASERO_BURN_OK && cache_key) {
+			GSList *tracks;
+
+			tracks = brasero_burn_session_get_tracks (priv->session);
+			if (g_slist_length (tracks) == 1
+			&&  BRASERO_IS_TRACK_IMAGE (tracks->data))
+				brasero_image_cache_add (cache_key, tracks->data);
+		}
+
+		g_free (cache_key);
+		return result;
+	}
+	brasero_track_type_free (output);
+
+	/* The first fake drive gets the image as if it were a normal burn;
+	 * the others are copies of it. */
+	result = brasero_burn_record_session (self, TRUE, NULL, error);
+	brasero_burn_unlock_src_media (self, NULL);
+	if (result != BRASERO_BURN_OK)
+		return result;
+
+	brasero_burn_session_get_output (priv->session, &image, &toc);
+
+	track = brasero_track_image_new ();
+	brasero_track_image_set_source (track,
+					image,
+					toc,
+					brasero_burn_session_get_output_format (priv->session));
+	g_free (image);
+	g_free (toc);
+
+	brasero_burn_session_push_tracks (priv->session);
+	brasero_burn_session_add_track (priv->session, BRASERO_TRACK (track), NULL);
+	g_object_unref (track);
+
+	return BRASERO_BURN_OK;
+}
+
+/**
+ * brasero_burn_record_multi:
+ * @burn: a #BraseroBurn
+ * @session: a #BraseroBurnSession
+ * @drives: (element-type BraseroMedia.Drive): a #GSList of #BraseroDrive
+ * @error: a #GError
+ *
+ * Creates an image once from the contents of @session and records it to
+ * all the drives in @drives in parallel. The burner set in @session is only
+ * used to determine the type of the image. A failure of one drive does not
+ * stop the others; the result of each drive is reported with the
+ * "drive-finished" signal and its progress with "drive-progress-changed".
+ *
+ * If a drive is the fake drive, the image is written to the output path
+ * set in @session. Each other occurrence of the fake drive in @drives gets a
+ * copy of it with a numbered suffix.
+ *
+ * Return value: a #BraseroBurnResult. The result of the operation.
+ * BRASERO_BURN_OK if recording succeeded on all drives.
+ **/
+
+BraseroBurnResult
+brasero_burn_record_multi (BraseroBurn *burn,
+			   BraseroBurnSession *session,
+			   GSList *drives,
+			   GError **error)
+{
+	BraseroBurnResult result;
+	BraseroBurnPrivate *priv;
+	GSList *iter;
+
+	g_return_val_if_fail (BRASERO_IS_BURN (burn), BRASERO_BURN_ERR);
+	g_return_val_if_fail (BRASERO_IS_BURN_SESSION (session), BRASERO_BURN_ERR);
+
+	if (!drives)
+		return brasero_burn_record (burn, session, error);
+
+	priv = BRASERO_BURN_PRIVATE (burn);
+
+	/* make sure we're ready */
+	if (brasero_burn_session_get_status (session, NULL) != BRASERO_BURN_OK)
+		return BRASERO_BURN_ERR;
+
+	for (iter = drives; iter; iter = iter->next) {
+		if (brasero_burn_session_get_src_drive (session) == iter->data) {
+			g_set_error (error,
+				     BRASERO_BURN_ERROR,
+				     BRASERO_BURN_ERROR_GENERAL,
+				     "%s", _("An internal error occurred"));
+			return BRASERO_BURN_ERR;
+		}
+
+		/* Fake drives need a path to write the image to */
+		if (brasero_drive_is_fake (iter->data)
+		&& !brasero_burn_session_is_dest_file (session)) {
+			g_set_error (error,
+				     BRASERO_BURN_ERROR,
+				     BRASERO_BURN_ERROR_OUTPUT_NONE,
+				     "%s", _("No path was specified for the image output"));
+			return BRASERO_BURN_ERR;
+		}
+	}
+
+	g_object_ref (session);
+	priv->session = session;
+	priv->recorders_context = brasero_burn_context_get_current ();
+	priv->recorders_failed = 0;
+	priv->recorders_done = 0;
+
+	brasero_burn_powermanagement (burn, TRUE);
+	brasero_burn_action_changed_real (burn, BRASERO_BURN_ACTION_PREPARING);
+
+	result = brasero_burn_multi_image (burn, error);
+	if (result == BRASERO_BURN_OK)
+		result = brasero_burn_run_recorders (burn, drives, error);
+
+	brasero_burn_unlock_medias (burn, NULL);
+
+	if (result == BRASERO_BURN_OK) {
+		BRASERO_BURN_DEBUG (burn, "Session successfully finished on all drives");
+		brasero_burn_action_changed_real (burn, BRASERO_BURN_ACTION_FINISHED);
+	}
+	else if (result == BRASERO_BURN_CANCEL) {
+		BRASERO_BURN_DEBUG (burn, "Session cancelled by user");
+	}
+	else if (error && (*error)) {
+		BRASERO_BURN_DEBUG (burn, "Session error : %s", (*error)->message);
+	}
+
+	brasero_burn_powermanagement (burn, FALSE);
+
+	/* release session */
+	g_object_unref (priv->session);
+	priv->session = NULL;
+
+	return result;
+}
+
+static BraseroBurnResult
+brasero_burn_span_volume (BraseroBurn *burn,
+			  BraseroBurnRecorder *recorder,
+			  GError **error)
+{
+	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (burn);
+	BraseroBurnResult result;
+
+	/* The tracks of the volume go to the session of the recorder so the
+	 * burner of the spanned session is never changed. This fails when
+	 * there is no medium or not enough space on it. */
+	for (;;) {
+		BraseroBurnError error_type;
+		BraseroMedium *medium;
+
+		while (brasero_drive_probing (recorder->drive)) {
+			result = brasero_burn_sleep (burn, 500);
+			if (result != BRASERO_BURN_OK)
+				return result;
+		}
+
+		result = brasero_session_span_next_to_session (BRASERO_SESSION_SPAN (priv->session),
+							       recorder->session);
+		if (result != BRASERO_BURN_ERR)
+			return result;
+
+		medium = brasero_drive_get_medium (recorder->drive);
+		if (brasero_medium_get_status (medium) == BRASERO_MEDIUM_NONE)
+			error_type = BRASERO_BURN_ERROR_NONE;
+		else
+			error_type = BRASERO_BURN_ERROR_MEDIUM_SPACE;
+
+		result = brasero_burn_ask_for_drive_media (burn,
+							   recorder->drive,
+							   error_type,
+							   BRASERO_MEDIUM_WRITABLE,
+							   error);
+		if (result != BRASERO_BURN_OK)
+			return result;
+	}
+}
+
+/**
+ * brasero_burn_record_span:
+ * @burn: a #BraseroBurn
+ * @session: a #BraseroSessionSpan
+ * @drives: (element-type BraseroMedia.Drive) (allow-none): a #GSList of #BraseroDrive
+ * @error: a #GError
+ *
+ * Records the contents of @session over as many discs as needed.
+ * The next volume is given to the first drive that is available and all of
+ * them record (and check) their volume at the same time. This way a disc can
+ * be checked on one drive while the next one is being created and recorded
+ * on another. If @drives is NULL, the burner set in @session is used and
+ * volumes are recorded one after the other.
+ *
+ * A new medium is requested with the "insert-media" signal whenever a drive
+ * has no medium with enough space. The result of each volume is reported
+ * with the "drive-finished" signal.
+ *
+ * Return value: a #BraseroBurnResult. The result of the operation.
+ * BRASERO_BURN_OK if all volumes were recorded successfully.
+ **/
+
+BraseroBurnResult
+brasero_burn_record_span (BraseroBurn *burn,
+			  BraseroSessionSpan *session,
+			  GSList *drives,
+			  GError **error)
+{
+	BraseroBurnResult recorders_result;
+	BraseroBurnResult span_result;
+	BraseroBurnResult result;
+	BraseroBurnPrivate *priv;
+	GSList *available;
+	guint volume = 0;
+	GTimer *timer;
+	GSList *iter;
+
+	g_return_val_if_fail (BRASERO_IS_BURN (burn), BRASERO_BURN_ERR);
+	g_return_val_if_fail (BRASERO_IS_SESSION_SPAN (session), BRASERO_BURN_ERR);
+
+	priv = BRASERO_BURN_PRIVATE (burn);
+
+	/* make sure we're ready */
+	if (brasero_burn_session_get_status (BRASERO_BURN_SESSION (session), NULL) != BRASERO_BURN_OK)
+		return BRASERO_BURN_ERR;
+
+	if (drives)
+		available = g_slist_copy (drives);
+	else
+		available = g_slist_prepend (NULL, brasero_burn_session_get_burner (BRASERO_BURN_SESSION (session)));
+
+	/* Images are not spanned */
+	for (iter = available; iter; iter = iter->next) {
+		if (!iter->data || brasero_drive_is_fake (iter->data)) {
+			g_slist_free (available);
+			g_set_error (error,
+				     BRASERO_BURN_ERROR,
+				     BRASERO_BURN_ERROR_GENERAL,
+				     "%s", _("An internal error occurred"));
+			return BRASERO_BURN_ERR;
+		}
+	}
+
+	g_object_ref (session);
+	priv->session = BRASERO_BURN_SESSION (session);
+	priv->recorders_context = brasero_burn_context_get_current ();
+	priv->recorders_failed = 0;
+	priv->recorders_done = 0;
+
+	brasero_burn_powermanagement (burn, TRUE);
+	brasero_burn_action_changed_real (burn, BRASERO_BURN_ACTION_PREPARING);
+
+	timer = g_timer_new ();
+	priv->recorders_time = 0.0;
+	brasero_session_span_start (session);
+
+	/* Each time a drive is available it gets the next volume while the
+	 * other drives keep recording (or checking) theirs. */
+	span_result = BRASERO_BURN_RETRY;
+	recorders_result = BRASERO_BURN_OK;
+	for (;;) {
+		BraseroBurnRecorder *recorder;
+		BraseroBurnResult reaped;
+		BraseroDrive *drive;
+
+		reaped = brasero_burn_recorders_reap (burn, &available);
+		if (reaped == BRASERO_BURN_ERR
+		|| (reaped == BRASERO_BURN_CANCEL && recorders_result == BRASERO_BURN_OK))
+			recorders_result = reaped;
+
+		if (span_result != BRASERO_BURN_RETRY
+		||  recorders_result != BRASERO_BURN_OK
+		|| !available) {
+			if (!priv->recorders_running)
+				break;
+
+			brasero_burn_recorders_run (burn);
+			continue;
+		}
+
+		drive = available->data;
+		available = g_slist_delete_link (available, available);
+
+		recorder = brasero_burn_recorder_new (burn, drive, 0);
+		priv->recorders = g_slist_append (priv->recorders, recorder);
+
+		span_result = brasero_burn_span_volume (burn, recorder, error);
+		if (span_result != BRASERO_BURN_RETRY) {
+			/* Nothing was given to that drive */
+			priv->recorders = g_slist_remove (priv->recorders, recorder);
+			brasero_burn_recorder_free (recorder);
+
+			/* Stop the other drives */
+			if (span_result != BRASERO_BURN_OK)
+				brasero_burn_cancel (burn, FALSE);
+
+			continue;
+		}
+
+		recorder->volume = ++ volume;
+		BRASERO_BURN_LOG ("Volume %i will be recorded on %s",
+				  volume,
+				  brasero_drive_get_device (drive));
+
+		brasero_burn_action_changed_real (burn, BRASERO_BURN_ACTION_RECORDING);
+		brasero_burn_recorder_start (recorder);
+
+		span_result = brasero_session_span_again (session);
+	}
+
+	brasero_session_span_stop (session);
+	g_slist_free (available);
+
+	if (span_result != BRASERO_BURN_OK && span_result != BRASERO_BURN_RETRY)
+		result = span_result;
+	else {
+		result = recorders_result;
+		if (error && !(*error))
+			brasero_burn_recorders_set_error (burn, error);
+	}
+
+	BRASERO_BURN_DEBUG (burn,
+			    "%i volume(s) recorded in %.1f s (%.1f s one after the other)",
+			    volume,
+			    g_timer_elapsed (timer, NULL),
+			    priv->recorders_time);
+	g_timer_destroy (timer);
+
+	if (result == BRASERO_BURN_OK) {
+		BRASERO_BURN_DEBUG (burn, "Spanned session successfully finished");
+		brasero_burn_action_changed_real (burn, BRASERO_BURN_ACTION_FINISHED);
+	}
+	else if (result == BRASERO_BURN_CANCEL) {
+		BRASERO_BURN_DEBUG (burn, "Session cancelled by user");
+	}
+	else if (error && (*error)) {
+		BRASERO_BURN_DEBUG (burn, "Session error : %s", (*error)->message);
+	}
+
+	brasero_burn_powermanagement (burn, FALSE);
+
+	/* release session */
+	g_object_unref (priv->session);
+	priv->session = NULL;
+
+	return result;
+}
+
+static BraseroBurnResult
+brasero_burn_blank_real (BraseroBurn *burn, GError **error)
+{
+	BraseroBurnResult result;
+	BraseroBurnPrivate *priv;
+
+	priv = BRASERO_BURN_PRIVATE (burn);
+
+	priv->task = brasero_burn_caps_new_blanking_task (priv->caps,
+							  priv->session,
+							  error);
+	if (!priv->task)
+		return BRASERO_BURN_NOT_SUPPORTED;
+
+	g_signal_connect (priv->task,
+			  "progress-changed",
+			  G_CALLBACK (brasero_burn_progress_changed),
+			  burn);
+	g_signal_connect (priv->task,
+			  "action-changed",
+			  G_CALLBACK (brasero_burn_action_changed),
+			  burn);
+
+	result = brasero_burn_run_eraser (burn, error);
+	g_object_unref (priv->task);
+	priv->task = NULL;
+
+	return result;
+}
+
+/**
+ * brasero_burn_blank:
+ * @burn: a #BraseroBurn
+ * @session: a #BraseroBurnSession
+ * @error: a #GError
+ *
+ * Blanks a medium according to the parameters
+ * set in @session. The medium must be inserted in the #BraseroDrive
+ * set with brasero_burn_session_set_burner ().
+ *
+ * Return value: a #BraseroBurnResult. The result of the operation. 
+ * BRASERO_BURN_OK if it was successful.
+ **/
+
+BraseroBurnResult
+brasero_burn_blank (BraseroBurn *burn,
+		    BraseroBurnSession *session,
+		    GError **error)
+{
+	BraseroBurnPrivate *priv;
+	BraseroBurnResult result;
+	GError *ret_error = NULL;
+
+	g_return_val_if_fail (burn != NULL, BRASERO_BURN_ERR);
+	g_return_val_if_fail (session != NULL, BRASERO_BURN_ERR);
+
+	priv = BRASERO_BURN_PRIVATE (burn);
+
+	g_object_ref (session);
+	priv->session = session;
+
+	brasero_burn_powermanagement (burn, TRUE);
+
+	/* we wait for the insertion of a media and lock it */
+	result = brasero_burn_lock_rewritable_media (burn, error);
+	if (result != BRASERO_BURN_OK)
+		goto end;
+
+	result = brasero_burn_blank_real (burn, &ret_error);
+	while (result == BRASERO_BURN_ERR &&
+	       ret_error &&
+	       ret_error->code == BRASERO_BURN_ERROR_MEDIUM_NOT_REWRITABLE) {
+		g_error_free (ret_error);
+		ret_error = NULL;
+
+		result = brasero_burn_ask_for_dest_media (burn,
+							  BRASERO_BURN_ERROR_MEDIUM_NOT_REWRITABLE,
+							  BRASERO_MEDIUM_REWRITABLE|
+							  BRASERO_MEDIUM_HAS_DATA,
+							  error);
+		if (result != BRASERO_BURN_OK)
+			break;
 
 		result = brasero_burn_lock_rewritable_media (burn, error);
 		if (result != BRASERO_BURN_OK)
@@ -3002,13 +4996,14 @@ brasero_burn_cancel (BraseroBurn *burn, gboolean protect)
 {
 	BraseroBurnResult result = BRASERO_BURN_OK;
 	BraseroBurnPrivate *priv;
+	GSList *iter;
 
 	g_return_val_if_fail (BRASERO_BURN (burn), BRASERO_BURN_ERR);
 
 	priv = BRASERO_BURN_PRIVATE (burn);
 
 	if (priv->timeout_id) {
-		g_source_remove (priv->timeout_id);
+		brasero_burn_source_remove (NULL, priv->timeout_id);
 		priv->timeout_id = 0;
 	}
 
@@ -3026,6 +5021,26 @@ brasero_burn_cancel (BraseroBurn *burn, gboolean protect)
 	if (priv->task && brasero_task_is_running (priv->task))
 		result = brasero_task_cancel (priv->task, protect);
 
+	/* The imager keeps running while a recorder follows its image */
+	if (priv->follow_imager
+	&&  priv->follow_imager != priv->task
+	&&  result != BRASERO_BURN_DANGEROUS
+	&&  brasero_task_is_running (priv->follow_imager))
+		brasero_task_cancel (priv->follow_imager, FALSE);
+
+	for (iter = priv->recorders; iter; iter = iter->next) {
+		BraseroBurnRecorder *recorder;
+		BraseroBurnResult res;
+
+		recorder = iter->data;
+		if (recorder->finished)
+			continue;
+
+		res = brasero_burn_recorder_cancel (recorder, protect);
+		if (res != BRASERO_BURN_OK)
+			result = res;
+	}
+
 	return result;
 }
 
@@ -3035,7 +5050,7 @@ brasero_burn_finalize (GObject *object)
 	BraseroBurnPrivate *priv = BRASERO_BURN_PRIVATE (object);
 
 	if (priv->timeout_id) {
-		g_source_remove (priv->timeout_id);
+		brasero_burn_source_remove (NULL, priv->timeout_id);
 		priv->timeout_id = 0;
 	}
 
@@ -3057,6 +5072,8 @@ brasero_burn_finalize (GObject *object)
 	if (priv->caps)
 		g_object_unref (priv->caps);
 
+	g_free (priv->profile_key);
+
 	G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -3204,6 +5221,40 @@ brasero_burn_class_init (BraseroBurnClass *klass)
 			      G_TYPE_INT, 2,
 		              G_TYPE_INT,
 			      G_TYPE_STRING);
+	brasero_burn_signals [DRIVE_PROGRESS_CHANGED_SIGNAL] =
+		g_signal_new ("drive_progress_changed",
+			      G_TYPE_FROM_CLASS (klass),
+			      G_SIGNAL_RUN_LAST,
+			      0,
+			      NULL, NULL,
+			      brasero_marshal_VOID__OBJECT_DOUBLE_LONG,
+			      G_TYPE_NONE,
+			      3,
+			      BRASERO_TYPE_DRIVE,
+			      G_TYPE_DOUBLE,
+			      G_TYPE_LONG);
+	brasero_burn_signals [DRIVE_FINISHED_SIGNAL] =
+		g_signal_new ("drive_finished",
+			      G_TYPE_FROM_CLASS (klass),
+			      G_SIGNAL_RUN_LAST,
+			      0,
+			      NULL, NULL,
+			      brasero_marshal_VOID__OBJECT_INT_POINTER,
+			      G_TYPE_NONE,
+			      3,
+			      BRASERO_TYPE_DRIVE,
+			      G_TYPE_INT,
+			      G_TYPE_POINTER);
+	brasero_burn_signals [WARN_DAMAGED_MEDIUM_SIGNAL] =
+		g_signal_new ("warn_damaged_medium",
+			      G_TYPE_FROM_CLASS (klass),
+			      G_SIGNAL_RUN_LAST,
+			      0,
+			      NULL, NULL,
+			      brasero_marshal_INT__INT,
+			      G_TYPE_INT,
+			      1,
+			      G_TYPE_INT);
 }
 
 static void
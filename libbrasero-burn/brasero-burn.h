@@ -37,6 +37,7 @@
 #include <brasero-error.h>
 #include <brasero-track.h>
 #include <brasero-session.h>
+#include <brasero-session-span.h>
 
 #include <brasero-medium.h>
 
@@ -100,6 +101,18 @@ brasero_burn_record (BraseroBurn *burn,
 		     BraseroBurnSession *session,
 		     GError **error);
 
+BraseroBurnResult
+brasero_burn_record_multi (BraseroBurn *burn,
+			   BraseroBurnSession *session,
+			   GSList *drives,
+			   GError **error);
+
+BraseroBurnResult
+brasero_burn_record_span (BraseroBurn *burn,
+			  BraseroSessionSpan *session,
+			  GSList *drives,
+			  GError **error);
+
 BraseroBurnResult
 brasero_burn_check (BraseroBurn *burn,
 		    BraseroBurnSession *session,
@@ -121,6 +134,17 @@ brasero_burn_status (BraseroBurn *burn,
 		     goffset *written,
 		     guint64 *rate);
 
+BraseroBurnResult
+brasero_burn_get_buffer_fill (BraseroBurn *burn,
+			      gint *fifo,
+			      gint *buffer);
+
+BraseroBurnResult
+brasero_burn_get_copy_buffer_status (BraseroBurn *burn,
+				     gint *fill,
+				     guint64 *read_rate,
+				     guint64 *write_rate);
+
 void
 brasero_burn_get_action_string (BraseroBurn *burn,
 				BraseroBurnAction action,
@@ -743,6 +743,18 @@ brasero_burn_caps_new_task (BraseroBurnCaps *self,
 	position = BRASERO_PLUGIN_RUN_PREPROCESSING;
 
 	brasero_burn_session_get_input_type (session, &plugin_input);
+
+	/* Tell the preprocessing plugins (namely the file downloader) whether
+	 * the plugin creating the image can read non local files itself */
+	if (list && brasero_track_type_get_has_data (&plugin_input)) {
+		BraseroCapsLinkList *first;
+
+		first = list->data;
+		brasero_burn_session_tag_add_int (session,
+		                                  BRASERO_SESSION_REMOTE_DATA_TAG,
+		                                  brasero_plugin_get_accept_remote_files (first->plugin));
+	}
+
 	for (iter = list; iter; iter = iter->next) {
 		BraseroTrackType plugin_output;
 		BraseroCapsLinkList *node;
@@ -34,7 +34,6 @@
 
 #include <string.h>
 #include <stdio.h>
-#include <libgen.h>
 #include <sys/param.h>
 
 #include <glib.h>
@@ -45,6 +44,8 @@
 #include "brasero-units.h"
 
 #include "brasero-data-project.h"
+#include "brasero-data-snapshot.h"
+#include "brasero-graft-index.h"
 #include "libbrasero-marshal.h"
 
 #include "brasero-misc.h"
@@ -78,14 +79,33 @@ struct _BraseroDataProjectPrivate
 	GHashTable *grafts;
 	GHashTable *reference;
 
+	/* Same grafts but stored per path component to find the closest
+	 * grafted parent of a URI in a single descent. */
+	BraseroGraftIndex *graft_index;
+
 	GHashTable *joliet;
 
+	/* Directory nodes that have joliet incompatible names in their
+	 * subtree, to only go through the keys of a given subtree. */
+	GHashTable *joliet_dirs;
+
 	guint ref_count;
 
 	/* This is a counter for the number of files to be loaded */
 	guint loading;
 
+	/* References of the parents whose children were added in a batch */
+	GSList *batch_parents;
+
+	/* Checks whether the files changed since the snapshot was saved */
+	BraseroDataSnapshotCheck *snapshot_check;
+
+	/* Temporary parents created while loading contents */
+	GSList *load_folders;
+
 	guint is_loading_contents:1;
+	guint is_adding_batch:1;
+	guint batch_size_changed:1;
 };
 
 #define BRASERO_DATA_PROJECT_PRIVATE(o)  (G_TYPE_INSTANCE_GET_PRIVATE ((o), BRASERO_TYPE_DATA_PROJECT, BraseroDataProjectPrivate))
@@ -339,6 +359,15 @@ struct _BraseroJolietKey {
 };
 typedef struct _BraseroJolietKey BraseroJolietKey;
 
+struct _BraseroJolietDir {
+	/* number of keys in the whole subtree of the directory */
+	guint count;
+
+	/* keys whose parent is the directory */
+	GSList *keys;
+};
+typedef struct _BraseroJolietDir BraseroJolietDir;
+
 static guint
 brasero_data_project_joliet_hash (gconstpointer data)
 {
@@ -396,6 +425,104 @@ brasero_data_project_joliet_set_key (BraseroJolietKey *key,
 	key->parent = node->parent;
 }
 
+static void
+brasero_data_project_joliet_dir_update (BraseroDataProjectPrivate *priv,
+					BraseroFileNode *parent,
+					gint delta)
+{
+	/* update the count of all the ancestors (parent included) */
+	for (; parent; parent = parent->parent) {
+		BraseroJolietDir *dir;
+
+		dir = g_hash_table_lookup (priv->joliet_dirs, parent);
+		if (!dir) {
+			if (delta < 0)
+				continue;
+
+			dir = g_new0 (BraseroJolietDir, 1);
+			g_hash_table_insert (priv->joliet_dirs, parent, dir);
+		}
+
+		dir->count += delta;
+		if (!dir->count && !dir->keys) {
+			g_hash_table_remove (priv->joliet_dirs, parent);
+			g_free (dir);
+		}
+	}
+}
+
+static void
+brasero_data_project_joliet_dir_add_key (BraseroDataProjectPrivate *priv,
+					 BraseroJolietKey *key)
+{
+	BraseroJolietDir *dir;
+
+	dir = g_hash_table_lookup (priv->joliet_dirs, key->parent);
+	if (!dir) {
+		dir = g_new0 (BraseroJolietDir, 1);
+		g_hash_table_insert (priv->joliet_dirs, key->parent, dir);
+	}
+
+	dir->keys = g_slist_prepend (dir->keys, key);
+	brasero_data_project_joliet_dir_update (priv, key->parent, 1);
+}
+
+static void
+brasero_data_project_joliet_dir_remove_key (BraseroDataProjectPrivate *priv,
+					    BraseroJolietKey *key)
+{
+	BraseroJolietDir *dir;
+
+	dir = g_hash_table_lookup (priv->joliet_dirs, key->parent);
+	if (!dir)
+		return;
+
+	dir->keys = g_slist_remove (dir->keys, key);
+	brasero_data_project_joliet_dir_update (priv, key->parent, -1);
+}
+
+static guint
+brasero_data_project_joliet_dir_count (BraseroDataProjectPrivate *priv,
+				       BraseroFileNode *node)
+{
+	BraseroJolietDir *dir;
+
+	if (node->is_file)
+		return 0;
+
+	dir = g_hash_table_lookup (priv->joliet_dirs, node);
+	return dir? dir->count:0;
+}
+
+/**
+ * Returns all the keys whose parent is node or one of its descendants.
+ * Only the directories that have such keys in their subtree are explored.
+ */
+
+static GSList *
+brasero_data_project_joliet_subtree_keys (BraseroDataProjectPrivate *priv,
+					  BraseroFileNode *node,
+					  GSList *keys)
+{
+	BraseroJolietDir *dir;
+	BraseroFileNode *iter;
+	GSList *list;
+
+	dir = g_hash_table_lookup (priv->joliet_dirs, node);
+	if (!dir)
+		return keys;
+
+	for (list = dir->keys; list; list = list->next)
+		keys = g_slist_prepend (keys, list->data);
+
+	for (iter = BRASERO_FILE_NODE_CHILDREN (node); iter; iter = iter->next) {
+		if (brasero_data_project_joliet_dir_count (priv, iter))
+			keys = brasero_data_project_joliet_subtree_keys (priv, iter, keys);
+	}
+
+	return keys;
+}
+
 static void
 brasero_data_project_joliet_add_node (BraseroDataProject *self,
 				      BraseroFileNode *node)
@@ -424,6 +551,7 @@ brasero_data_project_joliet_add_node (BraseroDataProject *self,
 		g_hash_table_insert (priv->joliet,
 				     table_key,
 				     g_slist_prepend (NULL, node));
+		brasero_data_project_joliet_dir_add_key (priv, table_key);
 	}
 	else {
 		list = g_slist_prepend (list, node);
@@ -470,6 +598,7 @@ brasero_data_project_joliet_remove_node (BraseroDataProject *self,
 		 * function and in this case a path could probably be
 		 * re-inserted */
 		g_hash_table_remove (priv->joliet, &key);
+		brasero_data_project_joliet_dir_remove_key (priv, hash_key);
 		g_free (hash_key);
 	}
 	else
@@ -480,37 +609,60 @@ brasero_data_project_joliet_remove_node (BraseroDataProject *self,
 	return TRUE;
 }
 
-static gboolean
-brasero_data_project_joliet_remove_children_node_cb (gpointer data_key,
-						     gpointer data,
-						     gpointer callback_data)
-{
-	BraseroFileNode *parent = callback_data;
-	BraseroJolietKey *key = data_key;
-	GSList *nodes = data;
-
-	if (brasero_file_node_is_ancestor (parent, key->parent) || parent == key->parent) {
-		g_slist_free (nodes);
-		return TRUE;
-	}
-
-	return FALSE;
-}
-
 static void
 brasero_data_project_joliet_remove_children_node (BraseroDataProject *self,
 						  BraseroFileNode *parent)
 {
 	BraseroDataProjectPrivate *priv;
+	GSList *keys;
+	GSList *iter;
 
 	priv = BRASERO_DATA_PROJECT_PRIVATE (self);
 
 	if (!parent)
 		parent = priv->root;
 
-	g_hash_table_foreach_remove (priv->joliet,
-				     brasero_data_project_joliet_remove_children_node_cb,
-				     parent);
+	keys = brasero_data_project_joliet_subtree_keys (priv, parent, NULL);
+	for (iter = keys; iter; iter = iter->next) {
+		BraseroJolietKey *key;
+
+		key = iter->data;
+		g_slist_free (g_hash_table_lookup (priv->joliet, key));
+		g_hash_table_remove (priv->joliet, key);
+
+		brasero_data_project_joliet_dir_remove_key (priv, key);
+		g_free (key);
+	}
+	g_slist_free (keys);
+}
+
+static guint
+brasero_data_project_joliet_detach_children (BraseroDataProject *self,
+					     BraseroFileNode *node)
+{
+	BraseroDataProjectPrivate *priv;
+	guint count;
+
+	/* The keys of the children of node keep their parent when node is
+	 * moved but the former ancestors of node must not count them anymore */
+	priv = BRASERO_DATA_PROJECT_PRIVATE (self);
+	count = brasero_data_project_joliet_dir_count (priv, node);
+	if (count)
+		brasero_data_project_joliet_dir_update (priv, node->parent, - (gint) count);
+
+	return count;
+}
+
+static void
+brasero_data_project_joliet_attach_children (BraseroDataProject *self,
+					     BraseroFileNode *node,
+					     guint count)
+{
+	BraseroDataProjectPrivate *priv;
+
+	priv = BRASERO_DATA_PROJECT_PRIVATE (self);
+	if (count)
+		brasero_data_project_joliet_dir_update (priv, node->parent, count);
 }
 
 /**
@@ -626,16 +778,54 @@ brasero_data_project_find_child_node (BraseroFileNode *node,
 	return NULL;
 }
 
+static gboolean
+brasero_data_project_unescape_path (const gchar *escaped,
+				    gchar *buffer,
+				    gsize size)
+{
+	gchar *ptr = buffer;
+
+	/* Same as g_uri_unescape_string () but without any allocation */
+	while (escaped [0] != '\0') {
+		if ((gsize) (ptr - buffer) >= size - 1)
+			return FALSE;
+
+		if (escaped [0] == '%') {
+			gint high, low;
+
+			high = g_ascii_xdigit_value (escaped [1]);
+			if (high < 0)
+				return FALSE;
+
+			low = g_ascii_xdigit_value (escaped [2]);
+			if (low < 0 || (!high && !low))
+				return FALSE;
+
+			ptr [0] = (high << 4) | low;
+			escaped += 3;
+		}
+		else {
+			ptr [0] = escaped [0];
+			escaped ++;
+		}
+
+		ptr ++;
+	}
+
+	ptr [0] = '\0';
+	return TRUE;
+}
+
 static GSList *
 brasero_data_project_uri_to_nodes (BraseroDataProject *self,
 				   const gchar *uri)
 {
 	BraseroDataProjectPrivate *priv;
+	gchar buffer [MAXPATHLEN];
 	BraseroURINode *graft;
 	GSList *nodes = NULL;
-	gchar *parent;
-	GSList *iter;
 	gchar *path;
+	GSList *iter;
 
 	priv = BRASERO_DATA_PROJECT_PRIVATE (self);
 
@@ -644,27 +834,21 @@ brasero_data_project_uri_to_nodes (BraseroDataProject *self,
 	if (graft)
 		return g_slist_copy (graft->nodes);
 
-	/* keep going up until we reach root URI in grafts */
-	parent = g_path_get_dirname (uri);
-	while (strcmp (parent, G_DIR_SEPARATOR_S) && strchr (parent, G_DIR_SEPARATOR)) {
-		graft = g_hash_table_lookup (priv->grafts, parent);
-		if (graft)
-			break;
-
-		parent = dirname (parent);
-	}
-
+	/* find the closest parent URI in grafts */
+	graft = brasero_graft_index_lookup_parent (priv->graft_index, uri, &uri);
 	if (!graft) {
 		/* no graft point was found; there isn't any node */
-		g_free (parent);
 		return NULL;
 	}
 
-	uri += strlen (parent);
-	g_free (parent);
+	/* unescape URI (on the stack unless it is really long) */
+	path = buffer;
+	if (!brasero_data_project_unescape_path (uri, buffer, sizeof (buffer)))
+		path = g_uri_unescape_string (uri, NULL);
+
+	if (!path)
+		return NULL;
 
-	/* unescape URI */
-	path = g_uri_unescape_string (uri, NULL);
 	for (iter = graft->nodes; iter; iter = iter->next) {
 		BraseroFileNode *node;
 
@@ -675,7 +859,9 @@ brasero_data_project_uri_to_nodes (BraseroDataProject *self,
 		if (node)
 			nodes = g_slist_prepend (nodes, node);
 	}
-	g_free (path);
+
+	if (path != buffer)
+		g_free (path);
 
 	return nodes;
 }
@@ -811,24 +997,9 @@ brasero_data_project_uri_has_parent (BraseroDataProject *self,
 				     const gchar *uri)
 {
 	BraseroDataProjectPrivate *priv;
-	gchar *parent;
 
 	priv = BRASERO_DATA_PROJECT_PRIVATE (self);
-
-	parent = g_path_get_dirname (uri);
-
-	/* keep going up until we reach a root URI */
-	while (strcmp (parent, G_DIR_SEPARATOR_S) && strchr (parent, G_DIR_SEPARATOR)) {
-		if (g_hash_table_lookup (priv->grafts, parent)) {
-			g_free (parent);
-			return TRUE;
-		}
-
-		parent = dirname (parent);
-	}
-
-	g_free (parent);
-	return FALSE;
+	return (brasero_graft_index_lookup_parent (priv->graft_index, uri, NULL) != NULL);
 }
 
 static gboolean
@@ -890,18 +1061,16 @@ brasero_data_project_uri_is_graft_needed (BraseroDataProject *self,
 
 		g_free (parent_uri);
 	}
+	g_free (parent);
 	g_free (name);
 
 	/* make sure no node is missing/removed. To do this find the 
 	 * first parent URI in the hash and see if it has the same 
 	 * number of graft point as this one. If not that means one
 	 * node is missing. */
-	graft_parent = g_hash_table_lookup (priv->grafts, parent);
-	while (parent && !graft_parent) {
-		parent = dirname (parent);
-		graft_parent = g_hash_table_lookup (priv->grafts, parent);
-	}
-	g_free (parent);
+	graft_parent = brasero_graft_index_lookup_parent (priv->graft_index, uri, NULL);
+	if (!graft_parent)
+		return TRUE;
 
 	if (g_slist_length (graft_parent->nodes) != g_slist_length (graft->nodes))
 		return TRUE;
@@ -938,6 +1107,7 @@ brasero_data_project_uri_remove_graft (BraseroDataProject *self,
 
 	/* we have to free the key and data ourselves */
 	g_hash_table_remove (priv->grafts, uri);
+	brasero_graft_index_remove (priv->graft_index, uri);
 
 	klass = BRASERO_DATA_PROJECT_GET_CLASS (self);
 	if (klass->uri_removed)
@@ -991,6 +1161,9 @@ brasero_data_project_uri_add_graft (BraseroDataProject *self,
 	g_hash_table_insert (priv->grafts,
 			     graft->uri,
 			     graft);
+	brasero_graft_index_insert (priv->graft_index,
+				    graft->uri,
+				    graft);
 
 	return graft;
 }
@@ -1059,6 +1232,7 @@ brasero_data_project_add_node_and_children (BraseroDataProject *self,
 struct _BraseroRemoveChildrenGraftData {
 	BraseroFileNode *node;
 	BraseroDataProject *project;
+	BraseroDataProjectPrivate *priv;
 };
 typedef struct _BraseroRemoveChildrenGraftData BraseroRemoveChildrenGraftData;
 
@@ -1090,7 +1264,11 @@ brasero_data_project_remove_node_children_graft_cb (const gchar *key,
 
 	/* Check if this graft should be removed. If not, it should 
 	 * have a parent URI in the graft. */
-	return (brasero_data_project_uri_has_parent (data->project, key) == FALSE);
+	if (brasero_data_project_uri_has_parent (data->project, key))
+		return FALSE;
+
+	brasero_graft_index_remove (data->priv->graft_index, key);
+	return TRUE;
 }
 
 static void
@@ -1103,6 +1281,7 @@ brasero_data_project_remove_node_children_graft (BraseroDataProject *self,
 	priv = BRASERO_DATA_PROJECT_PRIVATE (self);
 
 	callback_data.project = self;
+	callback_data.priv = priv;
 	callback_data.node = node;
 	g_hash_table_foreach_remove (priv->grafts,
 				     (GHRFunc) brasero_data_project_remove_node_children_graft_cb,
@@ -1443,6 +1622,7 @@ brasero_data_project_move_node (BraseroDataProject *self,
 	BraseroFileTreeStats *stats;
 	guint former_position;
 	gboolean check_graft;
+	guint joliet_count;
 
 	priv = BRASERO_DATA_PROJECT_PRIVATE (self);
 
@@ -1509,6 +1689,7 @@ brasero_data_project_move_node (BraseroDataProject *self,
 	 * - new location addition */
 
 	/* unparent node now in case its target sibling is a parent */
+	joliet_count = brasero_data_project_joliet_detach_children (self, node);
 	former_parent = node->parent;
 	former_position = brasero_file_node_get_pos_as_child (node);
 	stats = brasero_file_node_get_tree_stats (priv->root, NULL);
@@ -1524,6 +1705,7 @@ brasero_data_project_move_node (BraseroDataProject *self,
 						     node);
 
 	brasero_file_node_move_to (node, parent, priv->sort_func);
+	brasero_data_project_joliet_attach_children (self, node, joliet_count);
 
 	if (klass->node_added)
 		klass->node_added (self, node, NULL);
@@ -2149,7 +2331,7 @@ brasero_data_project_node_reloaded (BraseroDataProject *self,
 	}
 
 	size_changed = (BRASERO_BYTES_TO_SECTORS (size, 2048) == BRASERO_FILE_NODE_SECTORS (node));
-	if (BRASERO_FILE_NODE_MIME (node) && !size_changed)
+	if (BRASERO_FILE_NODE_MIME (node) && !node->is_mime_guessed && !size_changed)
 		return;
 
 	stats = brasero_file_node_get_tree_stats (priv->root, NULL);
@@ -2287,6 +2469,94 @@ brasero_data_project_directory_node_loaded (BraseroDataProject *self,
 	}
 }
 
+/**
+ * Used by brasero-data-vfs.c when all the children of a directory are added
+ * at once. In between the two calls the size is only signalled once and the
+ * parents are updated once at the end instead of once per child.
+ */
+
+static void
+brasero_data_project_add_batch_parent (BraseroDataProject *self,
+				       BraseroFileNode *parent)
+{
+	BraseroDataProjectPrivate *priv;
+	guint reference;
+	GSList *iter;
+
+	priv = BRASERO_DATA_PROJECT_PRIVATE (self);
+
+	if (parent->is_root)
+		return;
+
+	for (iter = priv->batch_parents; iter; iter = iter->next) {
+		reference = GPOINTER_TO_INT (iter->data);
+		if (brasero_data_project_reference_get (self, reference) == parent)
+			return;
+	}
+
+	reference = brasero_data_project_reference_new (self, parent);
+	if (reference)
+		priv->batch_parents = g_slist_prepend (priv->batch_parents, GINT_TO_POINTER (reference));
+}
+
+void
+brasero_data_project_add_batch_begin (BraseroDataProject *self)
+{
+	BraseroDataProjectPrivate *priv;
+
+	g_return_if_fail (BRASERO_IS_DATA_PROJECT (self));
+
+	priv = BRASERO_DATA_PROJECT_PRIVATE (self);
+	priv->is_adding_batch = 1;
+}
+
+void
+brasero_data_project_add_batch_end (BraseroDataProject *self)
+{
+	BraseroDataProjectPrivate *priv;
+	BraseroDataProjectClass *klass;
+	GSList *iter;
+
+	g_return_if_fail (BRASERO_IS_DATA_PROJECT (self));
+
+	priv = BRASERO_DATA_PROJECT_PRIVATE (self);
+	klass = BRASERO_DATA_PROJECT_GET_CLASS (self);
+
+	priv->is_adding_batch = 0;
+
+	for (iter = priv->batch_parents; iter; iter = iter->next) {
+		BraseroFileNode *parent;
+		guint reference;
+
+		reference = GPOINTER_TO_INT (iter->data);
+		parent = brasero_data_project_reference_get (self, reference);
+		brasero_data_project_reference_free (self, reference);
+
+		/* Don't use brasero_data_project_node_changed as the rows
+		 * don't need to be reordered. */
+		if (parent && klass->node_changed)
+			klass->node_changed (self, parent);
+	}
+	g_slist_free (priv->batch_parents);
+	priv->batch_parents = NULL;
+
+	if (priv->batch_size_changed) {
+		priv->batch_size_changed = 0;
+		g_signal_emit (self,
+			       brasero_data_project_signals [SIZE_CHANGED_SIGNAL],
+			       0);
+	}
+}
+
+gboolean
+brasero_data_project_is_adding_batch (BraseroDataProject *self)
+{
+	BraseroDataProjectPrivate *priv;
+
+	priv = BRASERO_DATA_PROJECT_PRIVATE (self);
+	return priv->is_adding_batch;
+}
+
 /**
  * This function is only used by brasero-data-vfs.c to add the contents of a 
  * directory. That's why if a node with the same name is already grafted we 
@@ -2431,7 +2701,14 @@ brasero_data_project_add_node_from_info (BraseroDataProject *self,
 			return NULL;
 	}
 
-	if (type != G_FILE_TYPE_DIRECTORY)
+	if (priv->is_adding_batch) {
+		/* Signalled once in brasero_data_project_add_batch_end () */
+		if (type != G_FILE_TYPE_DIRECTORY)
+			priv->batch_size_changed = 1;
+
+		brasero_data_project_add_batch_parent (self, parent);
+	}
+	else if (type != G_FILE_TYPE_DIRECTORY)
 		g_signal_emit (self,
 			       brasero_data_project_signals [SIZE_CHANGED_SIGNAL],
 			       0);
@@ -2675,6 +2952,89 @@ brasero_data_project_get_contents (BraseroDataProject *self,
 	return TRUE;
 }
 
+static gboolean
+brasero_data_project_foreach_graft_node (BraseroFileNode *parent,
+					 GString *path,
+					 BraseroDataProjectGraftFunc func,
+					 gpointer user_data)
+{
+	BraseroFileNode *node;
+
+	for (node = BRASERO_FILE_NODE_CHILDREN (parent); node; node = node->next) {
+		gsize len;
+
+		len = path->len;
+		g_string_append_c (path, G_DIR_SEPARATOR);
+		g_string_append (path, BRASERO_FILE_NODE_NAME (node));
+
+		if (node->is_grafted) {
+			BraseroURINode *uri_node;
+
+			/* if URI is a created directory set URI to NULL */
+			uri_node = BRASERO_FILE_NODE_GRAFT (node)->node;
+			if (!func (path->str,
+				   uri_node->uri != NEW_FOLDER? uri_node->uri:NULL,
+				   user_data))
+				return FALSE;
+		}
+
+		if (!node->is_file
+		&&  !brasero_data_project_foreach_graft_node (node, path, func, user_data))
+			return FALSE;
+
+		g_string_truncate (path, len);
+	}
+
+	return TRUE;
+}
+
+/**
+ * Same as brasero_data_project_get_contents () with hidden nodes but without
+ * building any list: grafts are given in tree order (parents first) as the
+ * tree is walked and then all the excluded URIs.
+ * NOTE: it doesn't add grafts for joliet incompatible names nor does it
+ * append a slash to directory paths; that's only needed to burn.
+ */
+
+gboolean
+brasero_data_project_foreach_graft (BraseroDataProject *self,
+				    BraseroDataProjectGraftFunc graft_func,
+				    BraseroDataProjectExcludedFunc excluded_func,
+				    gpointer user_data)
+{
+	BraseroDataProjectPrivate *priv;
+	GHashTableIter iter;
+	gpointer key;
+	GString *path;
+	gboolean result;
+
+	g_return_val_if_fail (BRASERO_IS_DATA_PROJECT (self), FALSE);
+
+	priv = BRASERO_DATA_PROJECT_PRIVATE (self);
+
+	path = g_string_new (NULL);
+	result = brasero_data_project_foreach_graft_node (priv->root,
+							  path,
+							  graft_func,
+							  user_data);
+	g_string_free (path, TRUE);
+
+	if (!result)
+		return FALSE;
+
+	/* Each URI in the table must be excluded (see above) */
+	g_hash_table_iter_init (&iter, priv->grafts);
+	while (g_hash_table_iter_next (&iter, &key, NULL)) {
+		if (key == NEW_FOLDER)
+			continue;
+
+		if (!excluded_func (key, user_data))
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
 typedef struct _MakeTrackDataSpan MakeTrackDataSpan;
 struct _MakeTrackDataSpan {
 	GSList *grafts;
@@ -2942,39 +3302,33 @@ brasero_data_project_span (BraseroDataProject *self,
 		total_sectors += child_sectors;
 
 		/* Take care of joliet non compliant nodes */
-		if (callback_data.fs_type & BRASERO_IMAGE_FS_JOLIET) {
-			GHashTableIter iter;
-			gpointer value_data;
-			gpointer key_data;
-
-			/* Problem is we don't know whether there are symlinks */
-			g_hash_table_iter_init (&iter, priv->joliet);
-			while (g_hash_table_iter_next (&iter, &key_data, &value_data)) {
+		if (callback_data.fs_type & BRASERO_IMAGE_FS_JOLIET
+		&&  brasero_data_project_joliet_dir_count (priv, children)) {
+			GSList *keys;
+			GSList *iter;
+
+			/* Problem is we don't know whether there are symlinks.
+			 * Only go through the keys of this top directory. */
+			keys = brasero_data_project_joliet_subtree_keys (priv, children, NULL);
+			for (iter = keys; iter; iter = iter->next) {
 				GSList *nodes;
-				BraseroJolietKey *key;
-
-				/* Is the node a graft a child of a graft */
-				key = key_data;
-				if (key->parent == children || brasero_file_node_is_ancestor (children, key->parent)) {
-					/* Add all the children to the list of
-					 * grafts provided they are not already
-					 * grafted. */
-					for (nodes = value_data; nodes; nodes = nodes->next) {
-						BraseroFileNode *node;
-
-						/* skip grafted nodes (they are
-						 * already or will be processed)
-						 */
-						node = nodes->data;
-						if (node->is_grafted)
-							continue;
-						
-						callback_data.joliet_grafts = g_slist_prepend (callback_data.joliet_grafts, node);
-					}
-
-					break;
+
+				/* Add all the children to the list of grafts
+				 * provided they are not already grafted. */
+				nodes = g_hash_table_lookup (priv->joliet, iter->data);
+				for (; nodes; nodes = nodes->next) {
+					BraseroFileNode *node;
+
+					/* skip grafted nodes (they are already
+					 * or will be processed) */
+					node = nodes->data;
+					if (node->is_grafted)
+						continue;
+
+					callback_data.joliet_grafts = g_slist_prepend (callback_data.joliet_grafts, node);
 				}
 			}
+			g_slist_free (keys);
 		}
 
 		callback_data.grafts = g_slist_prepend (callback_data.grafts, children);
@@ -3424,18 +3778,7 @@ brasero_data_project_add_excluded_uri (BraseroDataProject *self,
 	/* Then get all the nodes from the first grafted parent URI.
 	 * NOTE: here we don't check the graft uri itself since there is a graft
 	 * but there are probably no node. */
-	parent_uri = g_path_get_dirname (uri);
-	while (strcmp (parent_uri, G_DIR_SEPARATOR_S) && strchr (parent_uri, G_DIR_SEPARATOR)) {
-		/* keep going up until we reach root URI in grafts */
-		graft = g_hash_table_lookup (priv->grafts, parent_uri);
-		if (graft)
-			break;
-
-		graft = NULL;
-		parent_uri = dirname (parent_uri);
-	}
-	g_free (parent_uri);
-
+	graft = brasero_graft_index_lookup_parent (priv->graft_index, uri, NULL);
 	if (!graft)
 		return folders;
 
@@ -3569,72 +3912,109 @@ brasero_data_project_load_contents_notify (BraseroDataProject *self)
 	return num;
 }
 
-guint
-brasero_data_project_load_contents (BraseroDataProject *self,
-				    GSList *grafts,
-				    GSList *excluded)
+void
+brasero_data_project_load_contents_begin (BraseroDataProject *self)
 {
-	GSList *iter;
-	GSList *folders = NULL;
 	BraseroDataProjectPrivate *priv;
 
+	g_return_if_fail (BRASERO_IS_DATA_PROJECT (self));
+
 	priv = BRASERO_DATA_PROJECT_PRIVATE (self);
 	priv->is_loading_contents = 1;
+}
 
-	for (iter = grafts; iter; iter = iter->next) {
-		BraseroGraftPt *graft;
+void
+brasero_data_project_load_contents_add_graft (BraseroDataProject *self,
+					      const gchar *path,
+					      const gchar *uri)
+{
+	BraseroDataProjectPrivate *priv;
+	gchar *real_path;
+	gchar *real_uri;
+
+	g_return_if_fail (BRASERO_IS_DATA_PROJECT (self));
+
+	priv = BRASERO_DATA_PROJECT_PRIVATE (self);
+	g_return_if_fail (priv->is_loading_contents);
+
+	if (uri) {
 		GFile *file;
-		gchar *path;
-		gchar *uri;
 
-		graft = iter->data;
+		file = g_file_new_for_uri (uri);
+		real_uri = g_file_get_uri (file);
+		g_object_unref (file);
+	}
+	else
+		real_uri = NULL;
+
+	if (path) {
+		/* This might happen if we are loading brasero projects */
+		if (g_str_has_suffix (path, G_DIR_SEPARATOR_S)) {
+			int len;
 
-		if (graft->uri) {
-			file = g_file_new_for_uri (graft->uri);
-			uri = g_file_get_uri (file);
-			g_object_unref (file);
+			len = strlen (path);
+			real_path = g_strndup (path, len - 1);
 		}
 		else
-			uri = NULL;
+			real_path = g_strdup (path);
+	}
+	else
+		real_path = NULL;
+
+	priv->load_folders = brasero_data_project_add_path (self,
+							    real_path,
+							    real_uri,
+							    priv->load_folders);
+	g_free (real_path);
+	g_free (real_uri);
+}
 
-		if (graft->path) {
-			/* This might happen if we are loading brasero projects */
-			if (g_str_has_suffix (graft->path, G_DIR_SEPARATOR_S)) {
-				int len;
+/**
+ * NOTE: excluded URIs must be added after all the grafts
+ */
 
-				len = strlen (graft->path);
-				path = g_strndup (graft->path, len - 1);
-			}
-			else
-				path = g_strdup (graft->path);
-		}
-		else
-			path = NULL;
+void
+brasero_data_project_load_contents_add_excluded (BraseroDataProject *self,
+						 const gchar *uri)
+{
+	BraseroDataProjectPrivate *priv;
+	gchar *real_uri;
+	GFile *file;
 
-		folders = brasero_data_project_add_path (self,
-							 path,
-							 uri,
-							 folders);
-		g_free (path);
-		g_free (uri);
-	}
+	g_return_if_fail (BRASERO_IS_DATA_PROJECT (self));
+	g_return_if_fail (uri != NULL);
 
-	for (iter = excluded; iter; iter = iter->next) {
-		gchar *uri;
-		GFile *file;
+	priv = BRASERO_DATA_PROJECT_PRIVATE (self);
 
-		file = g_file_new_for_uri (iter->data);
-		uri = g_file_get_uri (file);
-		g_object_unref (file);
+	file = g_file_new_for_uri (uri);
+	real_uri = g_file_get_uri (file);
+	g_object_unref (file);
 
-		folders = brasero_data_project_add_excluded_uri (self,
-								 uri,
-								 folders);
-		g_free (uri);
-	}
+	/* When the tree was restored from a snapshot, all the nodes are already
+	 * there; only the graft signalling the exclusion is missing. */
+	if (priv->is_loading_contents)
+		priv->load_folders = brasero_data_project_add_excluded_uri (self,
+									    real_uri,
+									    priv->load_folders);
+	else
+		brasero_data_project_exclude_uri (self, real_uri);
+
+	g_free (real_uri);
+}
+
+guint
+brasero_data_project_load_contents_end (BraseroDataProject *self)
+{
+	BraseroDataProjectPrivate *priv;
+	GSList *iter;
+
+	g_return_val_if_fail (BRASERO_IS_DATA_PROJECT (self), 0);
+
+	priv = BRASERO_DATA_PROJECT_PRIVATE (self);
+	g_return_val_if_fail (priv->is_loading_contents, 0);
 
 	/* Now load the temporary folders that were created */
-	for (iter = folders; iter; iter = iter->next) {
+	for (iter = priv->load_folders; iter; iter = iter->next) {
 		BraseroURINode *graft;
 		BraseroFileNode *tmp;
 		gchar *uri;
@@ -3671,7 +4051,8 @@ brasero_data_project_load_contents (BraseroDataProject *self,
 		/* Don't signal the node addition yet we'll do it later when 
 		 * all the nodes are created */
 	}
-	g_slist_free (folders);
+	g_slist_free (priv->load_folders);
+	priv->load_folders = NULL;
 
 	priv->loading = brasero_data_project_load_contents_notify (self);
 
@@ -3679,6 +4060,395 @@ brasero_data_project_load_contents (BraseroDataProject *self,
 	return priv->loading;
 }
 
+guint
+brasero_data_project_load_contents (BraseroDataProject *self,
+				    GSList *grafts,
+				    GSList *excluded)
+{
+	GSList *iter;
+
+	brasero_data_project_load_contents_begin (self);
+
+	for (iter = grafts; iter; iter = iter->next) {
+		BraseroGraftPt *graft;
+
+		graft = iter->data;
+		brasero_data_project_load_contents_add_graft (self,
+							      graft->path,
+							      graft->uri);
+	}
+
+	for (iter = excluded; iter; iter = iter->next)
+		brasero_data_project_load_contents_add_excluded (self, iter->data);
+
+	return brasero_data_project_load_contents_end (self);
+}
+
+/**
+ * Snapshots
+ */
+
+static void
+brasero_data_project_load_snapshot_children (BraseroDataProject *self,
+					     BraseroDataSnapshot *snapshot,
+					     guint index,
+					     BraseroFileNode *parent,
+					     const gchar *parent_uri);
+
+static void
+brasero_data_project_load_snapshot_node (BraseroDataProject *self,
+					 BraseroDataSnapshot *snapshot,
+					 guint index,
+					 BraseroFileNode *parent,
+					 const gchar *parent_uri)
+{
+	const BraseroDataSnapshotNode *record;
+	BraseroDataProjectPrivate *priv;
+	BraseroFileTreeStats *stats;
+	BraseroURINode *graft;
+	BraseroFileNode *node;
+	const gchar *name;
+	gchar *uri = NULL;
+
+	priv = BRASERO_DATA_PROJECT_PRIVATE (self);
+
+	record = brasero_data_snapshot_get_node (snapshot, index);
+	name = brasero_data_snapshot_get_string (snapshot, record->name);
+
+	node = brasero_file_node_new (name);
+	stats = brasero_file_node_get_tree_stats (priv->root, NULL);
+
+	if (record->flags & BRASERO_DATA_SNAPSHOT_NODE_FILE) {
+		const gchar *mime;
+
+		node->is_file = TRUE;
+		node->union3.sectors = record->sectors;
+
+		mime = brasero_data_snapshot_get_string (snapshot, record->mime);
+		if (mime [0] != '\0') {
+			node->union2.mime = brasero_utils_register_string (mime);
+			node->is_mime_guessed = (record->flags & BRASERO_DATA_SNAPSHOT_NODE_MIME_GUESSED) != 0;
+		}
+
+		if (record->sectors > BRASERO_FILE_2G_LIMIT) {
+			node->is_2GiB = TRUE;
+			stats->num_2GiB ++;
+		}
+	}
+
+	if (record->flags & BRASERO_DATA_SNAPSHOT_NODE_SYMLINK) {
+		node->is_symlink = TRUE;
+		stats->num_sym ++;
+	}
+
+	/* NOTE: graft the node before adding it so that its size is not
+	 * propagated to its parents */
+	if (record->flags & BRASERO_DATA_SNAPSHOT_NODE_FAKE) {
+		node->is_fake = TRUE;
+		graft = brasero_data_project_uri_ensure_graft (self, NEW_FOLDER);
+		brasero_file_node_graft (node, graft);
+	}
+	else if (record->uri) {
+		uri = g_strdup (brasero_data_snapshot_get_string (snapshot, record->uri));
+		graft = brasero_data_project_uri_ensure_graft (self, uri);
+		brasero_file_node_graft (node, graft);
+	}
+	else if (parent_uri && !node->is_file) {
+		gchar *escaped_name;
+
+		/* Only directories need their URI to be monitored */
+		escaped_name = g_uri_escape_string (name,
+						    G_URI_RESERVED_CHARS_ALLOWED_IN_PATH,
+						    FALSE);
+		uri = g_strconcat (parent_uri, G_DIR_SEPARATOR_S, escaped_name, NULL);
+		g_free (escaped_name);
+	}
+
+	brasero_file_node_add (parent, node, priv->sort_func);
+
+	/* check joliet compatibility; do it after node was created. */
+	if (strlen (BRASERO_FILE_NODE_NAME (node)) > 64)
+		brasero_data_project_joliet_add_node (self, node);
+
+#ifdef BUILD_INOTIFY
+
+	if (uri) {
+		if (node->is_grafted)
+			brasero_file_monitor_single_file (BRASERO_FILE_MONITOR (self),
+							  uri,
+							  node);
+
+		if (!node->is_file)
+			brasero_file_monitor_directory_contents (BRASERO_FILE_MONITOR (self),
+								 uri,
+								 node);
+		node->is_monitored = TRUE;
+	}
+
+#endif
+
+	if (!node->is_file)
+		brasero_data_project_load_snapshot_children (self,
+							     snapshot,
+							     index,
+							     node,
+							     uri);
+	g_free (uri);
+}
+
+static void
+brasero_data_project_load_snapshot_children (BraseroDataProject *self,
+					     BraseroDataSnapshot *snapshot,
+					     guint index,
+					     BraseroFileNode *parent,
+					     const gchar *parent_uri)
+{
+	const BraseroDataSnapshotNode *record;
+	guint children_num = 0;
+	guint *children;
+	guint child;
+	guint end;
+
+	record = brasero_data_snapshot_get_node (snapshot, index);
+	if (!record->descendants)
+		return;
+
+	children = g_new (guint, record->descendants);
+
+	end = index + 1 + record->descendants;
+	for (child = index + 1; child < end; child += 1 + brasero_data_snapshot_get_node (snapshot, child)->descendants)
+		children [children_num ++] = child;
+
+	/* The children were saved sorted so adding them in reverse order
+	 * means each of them is inserted at the head of the list. */
+	while (children_num > 0)
+		brasero_data_project_load_snapshot_node (self,
+							 snapshot,
+							 children [-- children_num],
+							 parent,
+							 parent_uri);
+
+	g_free (children);
+}
+
+static void
+brasero_data_project_snapshot_node_removed (BraseroDataProject *self,
+					    BraseroFileNode *node)
+{
+	BraseroDataProjectPrivate *priv;
+	BraseroURINode *uri_node;
+	gchar *uri;
+
+	priv = BRASERO_DATA_PROJECT_PRIVATE (self);
+
+	uri = brasero_data_project_node_to_uri (self, node);
+	brasero_data_project_remove_node (self, node);
+
+	if (!uri)
+		return;
+
+	/* check if we can remove its graft (no more nodes) */
+	uri_node = g_hash_table_lookup (priv->grafts, uri);
+	g_free (uri);
+
+	if (!uri_node || uri_node->nodes)
+		return;
+
+	g_hash_table_remove (priv->grafts, uri_node->uri);
+	brasero_graft_index_remove (priv->graft_index, uri_node->uri);
+	brasero_utils_unregister_string (uri_node->uri);
+	g_free (uri_node);
+}
+
+static void
+brasero_data_project_snapshot_file_added (BraseroDataProject *self,
+					  BraseroFileNode *parent,
+					  const gchar *name)
+{
+	BraseroDataProjectPrivate *priv;
+	BraseroFileNode *sibling;
+	gchar *escaped_name;
+	gchar *parent_uri;
+	gchar *uri;
+
+	priv = BRASERO_DATA_PROJECT_PRIVATE (self);
+
+	parent_uri = brasero_data_project_node_to_uri (self, parent);
+	if (!parent_uri)
+		return;
+
+	escaped_name = g_uri_escape_string (name,
+					    G_URI_RESERVED_CHARS_ALLOWED_IN_PATH,
+					    FALSE);
+	uri = g_strconcat (parent_uri, G_DIR_SEPARATOR_S, escaped_name, NULL);
+	g_free (escaped_name);
+	g_free (parent_uri);
+
+	/* If there is a graft the file was either excluded or moved somewhere
+	 * else in the tree by the user. */
+	sibling = brasero_file_node_check_name_existence (parent, name);
+	if (!g_hash_table_lookup (priv->grafts, uri)
+	&& (!sibling || BRASERO_FILE_NODE_VIRTUAL (sibling)))
+		brasero_data_project_add_loading_node (self, uri, parent);
+
+	g_free (uri);
+}
+
+static void
+brasero_data_project_snapshot_node_dirty (BraseroDataProject *self,
+					  BraseroFileNode *node)
+{
+	BraseroFileNode *parent;
+	gchar *name;
+	gchar *uri;
+
+	uri = brasero_data_project_node_to_uri (self, node);
+	if (!uri)
+		return;
+
+	/* Replace the whole subtree with a loading node (keeping the name the
+	 * user may have given it) so that it is explored again */
+	parent = node->parent;
+	name = g_strdup (BRASERO_FILE_NODE_NAME (node));
+	brasero_data_project_snapshot_node_removed (self, node);
+	brasero_data_project_add_loading_node_real (self, uri, name, FALSE, parent);
+
+	g_free (name);
+	g_free (uri);
+}
+
+static void
+brasero_data_project_snapshot_changes_cb (GSList *changes,
+					  gpointer user_data)
+{
+	BraseroDataProject *self = BRASERO_DATA_PROJECT (user_data);
+	BraseroDataProjectPrivate *priv;
+	BraseroDataProjectClass *klass;
+	GSList *iter;
+
+	priv = BRASERO_DATA_PROJECT_PRIVATE (self);
+	klass = BRASERO_DATA_PROJECT_GET_CLASS (self);
+
+	/* Apply the changes the way we do for inotify events */
+	for (iter = changes; iter; iter = iter->next) {
+		BraseroDataSnapshotChange *change;
+		BraseroFileNode *node;
+		gchar *uri;
+
+		change = iter->data;
+		node = brasero_file_node_get_from_path (priv->root, change->path);
+		if (!node || node->is_loading)
+			continue;
+
+		switch (change->type) {
+		case BRASERO_DATA_SNAPSHOT_REMOVED:
+			brasero_data_project_snapshot_node_removed (self, node);
+			break;
+
+		case BRASERO_DATA_SNAPSHOT_DIRTY:
+			if (!node->is_file) {
+				brasero_data_project_snapshot_node_dirty (self, node);
+				break;
+			}
+
+			/* A file only needs to be reloaded */
+
+		case BRASERO_DATA_SNAPSHOT_MODIFIED:
+			if (!node->is_file)
+				break;
+
+			node->is_reloading = TRUE;
+			uri = brasero_data_project_node_to_uri (self, node);
+			if (klass->node_added)
+				klass->node_added (self, node, uri);
+			g_free (uri);
+			break;
+
+		case BRASERO_DATA_SNAPSHOT_ADDED:
+			if (!node->is_file)
+				brasero_data_project_snapshot_file_added (self, node, change->name);
+			break;
+		}
+	}
+
+	brasero_data_snapshot_check_free (priv->snapshot_check);
+	priv->snapshot_check = NULL;
+}
+
+gboolean
+brasero_data_project_load_snapshot (BraseroDataProject *self,
+				    const gchar *path,
+				    const gchar *project_path,
+				    GSList *excluded)
+{
+	BraseroDataProjectPrivate *priv;
+	BraseroDataProjectClass *klass;
+	BraseroDataSnapshot *snapshot;
+	BraseroFileNode *node;
+	GSList *iter;
+
+	g_return_val_if_fail (BRASERO_IS_DATA_PROJECT (self), FALSE);
+	g_return_val_if_fail (path != NULL, FALSE);
+	g_return_val_if_fail (project_path != NULL, FALSE);
+
+	priv = BRASERO_DATA_PROJECT_PRIVATE (self);
+
+	/* The snapshot is only valid for the project file it was saved with */
+	snapshot = brasero_data_snapshot_open (path, project_path);
+	if (!snapshot)
+		return FALSE;
+
+	BRASERO_BURN_LOG ("Loading project from snapshot %s", path);
+
+	brasero_data_project_load_snapshot_children (self,
+						     snapshot,
+						     0,
+						     priv->root,
+						     NULL);
+
+	/* Excluded URIs have no node in the tree but they need a graft */
+	for (iter = excluded; iter; iter = iter->next)
+		brasero_data_project_load_contents_add_excluded (self, iter->data);
+
+	/* Only the top nodes need to be signalled; the others are not visible
+	 * and the whole tree is already loaded so there is nothing to explore */
+	klass = BRASERO_DATA_PROJECT_GET_CLASS (self);
+	if (klass->node_added) {
+		BraseroFileNode *next;
+
+		for (node = BRASERO_FILE_NODE_CHILDREN (priv->root); node; node = next) {
+			next = node->next;
+			klass->node_added (self, node, NULL);
+		}
+	}
+
+	g_signal_emit (self,
+		       brasero_data_project_signals [SIZE_CHANGED_SIGNAL],
+		       0);
+
+	/* Now check in the background what changed since it was saved */
+	priv->snapshot_check = brasero_data_snapshot_check_start (snapshot,
+								  brasero_data_project_snapshot_changes_cb,
+								  self);
+	return TRUE;
+}
+
+gboolean
+brasero_data_project_save_snapshot (BraseroDataProject *self,
+				    const gchar *path,
+				    const gchar *project_path,
+				    GError **error)
+{
+	BraseroDataProjectPrivate *priv;
+
+	g_return_val_if_fail (BRASERO_IS_DATA_PROJECT (self), FALSE);
+	g_return_val_if_fail (path != NULL, FALSE);
+	g_return_val_if_fail (project_path != NULL, FALSE);
+
+	priv = BRASERO_DATA_PROJECT_PRIVATE (self);
+	return brasero_data_snapshot_save (priv->root, path, project_path, error);
+}
+
 /**
  * get the size of the whole tree in sectors 
  */
@@ -3775,8 +4545,11 @@ brasero_data_project_init (BraseroDataProject *object)
 	/* create the necessary hash tables */
 	priv->grafts = g_hash_table_new (g_str_hash,
 					 g_str_equal);
+	priv->graft_index = brasero_graft_index_new ();
 	priv->joliet = g_hash_table_new (brasero_data_project_joliet_hash,
 					 brasero_data_project_joliet_equal);
+	priv->joliet_dirs = g_hash_table_new (g_direct_hash,
+					      g_direct_equal);
 	priv->reference = g_hash_table_new (g_direct_hash,
 					    g_direct_equal);
 }
@@ -3865,6 +4638,16 @@ brasero_data_project_clear_joliet_cb (BraseroJolietKey *key,
 	return TRUE;
 }
 
+static gboolean
+brasero_data_project_clear_joliet_dirs_cb (BraseroFileNode *node,
+					   BraseroJolietDir *dir,
+					   gpointer NULL_data)
+{
+	g_slist_free (dir->keys);
+	g_free (dir);
+	return TRUE;
+}
+
 static void
 brasero_data_project_clear (BraseroDataProject *self)
 {
@@ -3877,15 +4660,30 @@ brasero_data_project_clear (BraseroDataProject *self)
 		priv->spanned = NULL;
 	}
 
+	if (priv->snapshot_check) {
+		brasero_data_snapshot_check_free (priv->snapshot_check);
+		priv->snapshot_check = NULL;
+	}
+
+	if (priv->load_folders) {
+		g_slist_free (priv->load_folders);
+		priv->load_folders = NULL;
+	}
+	priv->is_loading_contents = 0;
+
 	/* clear the tables.
 	 * NOTE: reference hash doesn't need to be cleared. */
 	g_hash_table_foreach_remove (priv->grafts,
 				     (GHRFunc) brasero_data_project_clear_grafts_cb,
 				     NULL);
+	brasero_graft_index_clear (priv->graft_index);
 
 	g_hash_table_foreach_remove (priv->joliet,
 				     (GHRFunc) brasero_data_project_clear_joliet_cb,
 				     NULL);
+	g_hash_table_foreach_remove (priv->joliet_dirs,
+				     (GHRFunc) brasero_data_project_clear_joliet_dirs_cb,
+				     NULL);
 
 	g_hash_table_destroy (priv->reference);
 	priv->reference = g_hash_table_new (g_direct_hash, g_direct_equal);
@@ -3935,11 +4733,21 @@ brasero_data_project_finalize (GObject *object)
 		priv->grafts = NULL;
 	}
 
+	if (priv->graft_index) {
+		brasero_graft_index_free (priv->graft_index);
+		priv->graft_index = NULL;
+	}
+
 	if (priv->joliet) {
 		g_hash_table_destroy (priv->joliet);
 		priv->joliet = NULL;
 	}
 
+	if (priv->joliet_dirs) {
+		g_hash_table_destroy (priv->joliet_dirs);
+		priv->joliet_dirs = NULL;
+	}
+
 	if (priv->reference) {
 		g_hash_table_destroy (priv->reference);
 		priv->reference = NULL;
@@ -4229,6 +5037,7 @@ brasero_data_project_file_moved (BraseroFileMonitor *monitor,
 		g_free (parent_uri);
 	}
 	else {
+		guint joliet_count;
 		guint former_position;
 		BraseroFileNode *sibling;
 		BraseroFileTreeStats *stats;
@@ -4270,6 +5079,7 @@ brasero_data_project_file_moved (BraseroFileMonitor *monitor,
 		former_parent = node->parent;
 		former_position = brasero_file_node_get_pos_as_child (node);
 
+		joliet_count = brasero_data_project_joliet_detach_children (BRASERO_DATA_PROJECT (monitor), node);
 		stats = brasero_file_node_get_tree_stats (priv->root, NULL);
 		brasero_file_node_move_from (node, stats);
 		if (klass->node_removed)
@@ -4289,6 +5099,7 @@ brasero_data_project_file_moved (BraseroFileMonitor *monitor,
 			brasero_data_project_joliet_add_node (BRASERO_DATA_PROJECT (monitor), node);
 
 		brasero_file_node_move_to (node, parent, priv->sort_func);
+		brasero_data_project_joliet_attach_children (BRASERO_DATA_PROJECT (monitor), node, joliet_count);
 
 		if (klass->node_added)
 			klass->node_added (BRASERO_DATA_PROJECT (monitor), node, NULL);
@@ -4341,6 +5152,7 @@ brasero_data_project_file_removed (BraseroFileMonitor *monitor,
 		return;
 
 	g_hash_table_remove (priv->grafts, uri_node->uri);
+	brasero_graft_index_remove (priv->graft_index, uri_node->uri);
 	brasero_utils_unregister_string (uri_node->uri);
 	g_free (uri_node);
 }
@@ -141,6 +141,18 @@ brasero_data_project_get_contents (BraseroDataProject *project,
 				   gboolean joliet_compat,
 				   gboolean append_slash);
 
+typedef gboolean	(*BraseroDataProjectGraftFunc)	(const gchar *path,
+							 const gchar *uri,
+							 gpointer user_data);
+typedef gboolean	(*BraseroDataProjectExcludedFunc)	(const gchar *uri,
+								 gpointer user_data);
+
+gboolean
+brasero_data_project_foreach_graft (BraseroDataProject *project,
+				    BraseroDataProjectGraftFunc graft_func,
+				    BraseroDataProjectExcludedFunc excluded_func,
+				    gpointer user_data);
+
 gboolean
 brasero_data_project_is_empty (BraseroDataProject *project);
 
@@ -158,6 +170,29 @@ brasero_data_project_load_contents (BraseroDataProject *project,
 				    GSList *grafts,
 				    GSList *excluded);
 
+void
+brasero_data_project_load_contents_begin (BraseroDataProject *project);
+void
+brasero_data_project_load_contents_add_graft (BraseroDataProject *project,
+					      const gchar *path,
+					      const gchar *uri);
+void
+brasero_data_project_load_contents_add_excluded (BraseroDataProject *project,
+						 const gchar *uri);
+guint
+brasero_data_project_load_contents_end (BraseroDataProject *project);
+
+gboolean
+brasero_data_project_load_snapshot (BraseroDataProject *project,
+				    const gchar *path,
+				    const gchar *project_path,
+				    GSList *excluded);
+gboolean
+brasero_data_project_save_snapshot (BraseroDataProject *project,
+				    const gchar *path,
+				    const gchar *project_path,
+				    GError **error);
+
 BraseroFileNode *
 brasero_data_project_add_hidden_node (BraseroDataProject *project,
 				      const gchar *uri,
@@ -203,6 +238,13 @@ void
 brasero_data_project_directory_node_loaded (BraseroDataProject *project,
 					    BraseroFileNode *parent);
 
+void
+brasero_data_project_add_batch_begin (BraseroDataProject *project);
+void
+brasero_data_project_add_batch_end (BraseroDataProject *project);
+gboolean
+brasero_data_project_is_adding_batch (BraseroDataProject *project);
+
 gboolean
 brasero_data_project_rename_node (BraseroDataProject *project,
 				  BraseroFileNode *node,
@@ -0,0 +1,690 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Libbrasero-burn
+ * Copyright (C) Philippe Rouquier 2005-2009 <bonfire-app@wanadoo.fr>
+ *
+ * Libbrasero-burn is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The Libbrasero-burn authors hereby grant permission for non-GPL compatible
+ * GStreamer plugins to be used and distributed together with GStreamer
+ * and Libbrasero-burn. This permission is above and beyond the permissions granted
+ * by the GPL license by which Libbrasero-burn is covered. If you modify this code
+ * you may extend this exception to your version of the code, but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version.
+ * 
+ * Libbrasero-burn is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string.h>
+#include <errno.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <glib.h>
+#include <glib/gi18n-lib.h>
+#include <glib/gstdio.h>
+
+#include "brasero-data-snapshot.h"
+#include "brasero-file-node.h"
+#include "brasero-error.h"
+#include "burn-basics.h"
+#include "burn-debug.h"
+
+#define BRASERO_DATA_SNAPSHOT_MAGIC		"BRSNAPSH"
+#define BRASERO_DATA_SNAPSHOT_VERSION		2
+#define BRASERO_DATA_SNAPSHOT_BYTE_ORDER	0x01020304
+
+struct _BraseroDataSnapshotHeader {
+	gchar magic [8];
+	guint32 byte_order;
+	guint32 version;
+
+	/* Used to make sure the snapshot was saved along with the project
+	 * file and that the latter wasn't modified since. */
+	guint64 project_size;
+	gint64 project_mtime;
+	guint32 project_mtime_nsec;
+
+	guint32 nodes_num;
+	guint32 strings_size;
+};
+typedef struct _BraseroDataSnapshotHeader BraseroDataSnapshotHeader;
+
+struct _BraseroDataSnapshot {
+	/* NOTE: the file is read rather than mapped since it could be
+	 * truncated while in use which would crash us */
+	gchar *contents;
+
+	const BraseroDataSnapshotHeader *header;
+	const BraseroDataSnapshotNode *nodes;
+	const gchar *strings;
+};
+
+struct _BraseroDataSnapshotCheck {
+	BraseroDataSnapshot *snapshot;
+
+	GThread *thread;
+	gint cancel;
+
+	GSList *changes;
+	guint idle_id;
+
+	BraseroDataSnapshotChangesFunc func;
+	gpointer user_data;
+};
+
+/**
+ * Loading
+ */
+
+static gboolean
+brasero_data_snapshot_check_offset (BraseroDataSnapshot *snapshot,
+				    guint32 offset)
+{
+	return offset < snapshot->header->strings_size;
+}
+
+/**
+ * Make sure all the subtrees fit into their parent's and that all the string
+ * offsets are valid so that nothing has to be checked later.
+ */
+
+static gboolean
+brasero_data_snapshot_check_tree (BraseroDataSnapshot *snapshot,
+				  guint index,
+				  guint limit)
+{
+	const BraseroDataSnapshotNode *node;
+	guint child;
+	guint end;
+
+	node = snapshot->nodes + index;
+	if (node->descendants >= limit - index)
+		return FALSE;
+
+	if (!brasero_data_snapshot_check_offset (snapshot, node->name)
+	||  !brasero_data_snapshot_check_offset (snapshot, node->uri)
+	||  !brasero_data_snapshot_check_offset (snapshot, node->mime))
+		return FALSE;
+
+	end = index + 1 + node->descendants;
+	for (child = index + 1; child < end; child += 1 + snapshot->nodes [child].descendants) {
+		if (!brasero_data_snapshot_check_tree (snapshot, child, end))
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+BraseroDataSnapshot *
+brasero_data_snapshot_open (const gchar *path,
+			    const gchar *project_path)
+{
+	const BraseroDataSnapshotHeader *header;
+	BraseroDataSnapshot *snapshot;
+	struct stat info;
+	gchar *contents;
+	gsize length;
+
+	if (g_stat (project_path, &info))
+		return NULL;
+
+	if (!g_file_get_contents (path, &contents, &length, NULL))
+		return NULL;
+
+	if (length < sizeof (BraseroDataSnapshotHeader))
+		goto invalid;
+
+	header = (const BraseroDataSnapshotHeader *) contents;
+	if (memcmp (header->magic, BRASERO_DATA_SNAPSHOT_MAGIC, sizeof (header->magic))
+	||  header->byte_order != BRASERO_DATA_SNAPSHOT_BYTE_ORDER
+	||  header->version != BRASERO_DATA_SNAPSHOT_VERSION) {
+		BRASERO_BURN_LOG ("Snapshot %s has a wrong format", path);
+		goto invalid;
+	}
+
+	if (header->project_size != (guint64) info.st_size
+	||  header->project_mtime != (gint64) info.st_mtime
+	||  header->project_mtime_nsec != BRASERO_STAT_MTIME_NSEC (&info)) {
+		BRASERO_BURN_LOG ("Snapshot %s is out of date", path);
+		goto invalid;
+	}
+
+	if (!header->nodes_num
+	||  !header->strings_size
+	||  length != sizeof (BraseroDataSnapshotHeader) +
+		      (gsize) header->nodes_num * sizeof (BraseroDataSnapshotNode) +
+		      header->strings_size)
+		goto invalid;
+
+	snapshot = g_new0 (BraseroDataSnapshot, 1);
+	snapshot->contents = contents;
+	snapshot->header = header;
+	snapshot->nodes = (const BraseroDataSnapshotNode *) (contents + sizeof (BraseroDataSnapshotHeader));
+	snapshot->strings = (const gchar *) (snapshot->nodes + header->nodes_num);
+
+	if (snapshot->strings [0] != '\0'
+	||  snapshot->strings [header->strings_size - 1] != '\0'
+	||  snapshot->nodes [0].descendants != header->nodes_num - 1
+	|| !brasero_data_snapshot_check_tree (snapshot, 0, header->nodes_num)) {
+		BRASERO_BURN_LOG ("Snapshot %s is corrupted", path);
+		brasero_data_snapshot_free (snapshot);
+		return NULL;
+	}
+
+	return snapshot;
+
+invalid:
+
+	g_free (contents);
+	return NULL;
+}
+
+void
+brasero_data_snapshot_free (BraseroDataSnapshot *snapshot)
+{
+	g_free (snapshot->contents);
+	g_free (snapshot);
+}
+
+const BraseroDataSnapshotNode *
+brasero_data_snapshot_get_node (BraseroDataSnapshot *snapshot,
+				guint index)
+{
+	return snapshot->nodes + index;
+}
+
+const gchar *
+brasero_data_snapshot_get_string (BraseroDataSnapshot *snapshot,
+				  guint32 offset)
+{
+	return snapshot->strings + offset;
+}
+
+/**
+ * Saving
+ */
+
+struct _BraseroDataSnapshotWriter {
+	GByteArray *nodes;
+	GString *strings;
+
+	/* mime types are shared by a lot of nodes */
+	GHashTable *mimes;
+};
+typedef struct _BraseroDataSnapshotWriter BraseroDataSnapshotWriter;
+
+static guint32
+brasero_data_snapshot_add_string (BraseroDataSnapshotWriter *writer,
+				  const gchar *string)
+{
+	guint32 offset;
+
+	if (!string || string [0] == '\0')
+		return 0;
+
+	offset = writer->strings->len;
+	g_string_append_len (writer->strings, string, strlen (string) + 1);
+	return offset;
+}
+
+static guint32
+brasero_data_snapshot_add_mime (BraseroDataSnapshotWriter *writer,
+				const gchar *mime)
+{
+	gpointer offset;
+
+	if (!mime)
+		return 0;
+
+	offset = g_hash_table_lookup (writer->mimes, mime);
+	if (offset)
+		return GPOINTER_TO_UINT (offset);
+
+	offset = GUINT_TO_POINTER (brasero_data_snapshot_add_string (writer, mime));
+	g_hash_table_insert (writer->mimes, (gpointer) mime, offset);
+	return GPOINTER_TO_UINT (offset);
+}
+
+static gboolean
+brasero_data_snapshot_save_node (BraseroDataSnapshotWriter *writer,
+				 BraseroFileNode *node,
+				 const gchar *path)
+{
+	BraseroDataSnapshotNode record = { 0, };
+	BraseroDataSnapshotNode *records;
+	BraseroFileNode *child;
+	guint index;
+
+	/* Only complete trees can be saved */
+	if (node->is_loading || node->is_exploring)
+		return FALSE;
+
+	if (!node->is_root)
+		record.name = brasero_data_snapshot_add_string (writer, BRASERO_FILE_NODE_NAME (node));
+
+	if (node->is_fake)
+		record.flags |= BRASERO_DATA_SNAPSHOT_NODE_FAKE;
+	else if (node->is_grafted)
+		record.uri = brasero_data_snapshot_add_string (writer, BRASERO_FILE_NODE_GRAFT (node)->node->uri);
+
+	if (node->is_symlink)
+		record.flags |= BRASERO_DATA_SNAPSHOT_NODE_SYMLINK;
+
+	if (node->is_file) {
+		record.flags |= BRASERO_DATA_SNAPSHOT_NODE_FILE;
+		record.sectors = BRASERO_FILE_NODE_SECTORS (node);
+		record.mime = brasero_data_snapshot_add_mime (writer, BRASERO_FILE_NODE_MIME (node));
+		if (node->is_mime_guessed)
+			record.flags |= BRASERO_DATA_SNAPSHOT_NODE_MIME_GUESSED;
+	}
+
+	if (path) {
+		struct stat info;
+		int res;
+
+		if (node->is_symlink)
+			res = g_lstat (path, &info);
+		else
+			res = g_stat (path, &info);
+
+		/* If it fails the node will be checked again when loaded */
+		if (!res) {
+			record.size = info.st_size;
+			record.mtime = info.st_mtime;
+			record.mtime_nsec = BRASERO_STAT_MTIME_NSEC (&info);
+		}
+	}
+
+	index = writer->nodes->len / sizeof (BraseroDataSnapshotNode);
+	g_byte_array_append (writer->nodes, (guint8 *) &record, sizeof (record));
+
+	for (child = BRASERO_FILE_NODE_CHILDREN (node); child; child = child->next) {
+		gboolean result;
+		gchar *child_path;
+
+		/* Imported nodes belong to the medium and hidden ones are
+		 * created again when the project is loaded (autorun.inf) */
+		if (child->is_imported || child->is_hidden)
+			continue;
+
+		if (child->is_fake)
+			child_path = NULL;
+		else if (child->is_grafted)
+			child_path = g_filename_from_uri (BRASERO_FILE_NODE_GRAFT (child)->node->uri, NULL, NULL);
+		else if (path)
+			child_path = g_build_filename (path, BRASERO_FILE_NODE_NAME (child), NULL);
+		else
+			child_path = NULL;
+
+		result = brasero_data_snapshot_save_node (writer, child, child_path);
+		g_free (child_path);
+
+		if (!result)
+			return FALSE;
+	}
+
+	/* the array may have been reallocated in the mean time */
+	records = (BraseroDataSnapshotNode *) writer->nodes->data;
+	records [index].descendants = writer->nodes->len / sizeof (BraseroDataSnapshotNode) - index - 1;
+	return TRUE;
+}
+
+gboolean
+brasero_data_snapshot_save (BraseroFileNode *root,
+			    const gchar *path,
+			    const gchar *project_path,
+			    GError **error)
+{
+	BraseroDataSnapshotHeader header;
+	BraseroDataSnapshotWriter writer;
+	GByteArray *contents;
+	struct stat info;
+	gboolean result;
+
+	if (g_stat (project_path, &info)) {
+		g_set_error (error,
+			     BRASERO_BURN_ERROR,
+			     BRASERO_BURN_ERROR_GENERAL,
+			     "%s",
+			     g_strerror (errno));
+		return FALSE;
+	}
+
+	writer.nodes = g_byte_array_new ();
+	writer.strings = g_string_new_len ("", 1);
+	writer.mimes = g_hash_table_new (g_str_hash, g_str_equal);
+
+	result = brasero_data_snapshot_save_node (&writer, root, NULL);
+	g_hash_table_destroy (writer.mimes);
+
+	if (!result) {
+		g_byte_array_free (writer.nodes, TRUE);
+		g_string_free (writer.strings, TRUE);
+
+		g_set_error (error,
+			     BRASERO_BURN_ERROR,
+			     BRASERO_BURN_ERROR_GENERAL,
+			     _("The project is still being loaded"));
+		return FALSE;
+	}
+
+	memset (&header, 0, sizeof (header));
+	memcpy (header.magic, BRASERO_DATA_SNAPSHOT_MAGIC, sizeof (header.magic));
+	header.byte_order = BRASERO_DATA_SNAPSHOT_BYTE_ORDER;
+	header.version = BRASERO_DATA_SNAPSHOT_VERSION;
+	header.project_size = info.st_size;
+	header.project_mtime = info.st_mtime;
+	header.project_mtime_nsec = BRASERO_STAT_MTIME_NSEC (&info);
+	header.nodes_num = writer.nodes->len / sizeof (BraseroDataSnapshotNode);
+	header.strings_size = writer.strings->len;
+
+	contents = g_byte_array_sized_new (sizeof (header) + writer.nodes->len + writer.strings->len);
+	g_byte_array_append (contents, (guint8 *) &header, sizeof (header));
+	g_byte_array_append (contents, writer.nodes->data, writer.nodes->len);
+	g_byte_array_append (contents, (guint8 *) writer.strings->str, writer.strings->len);
+
+	g_byte_array_free (writer.nodes, TRUE);
+	g_string_free (writer.strings, TRUE);
+
+	result = g_file_set_contents (path,
+				      (gchar *) contents->data,
+				      contents->len,
+				      error);
+	g_byte_array_free (contents, TRUE);
+
+	BRASERO_BURN_LOG ("Saved snapshot with %i nodes", header.nodes_num);
+	return result;
+}
+
+/**
+ * Revalidation
+ */
+
+static void
+brasero_data_snapshot_check_add_change (BraseroDataSnapshotCheck *check,
+					BraseroDataSnapshotChangeType type,
+					const gchar *path,
+					const gchar *name)
+{
+	BraseroDataSnapshotChange *change;
+
+	change = g_new0 (BraseroDataSnapshotChange, 1);
+	change->type = type;
+	change->path = g_strdup (path [0] != '\0'? path:G_DIR_SEPARATOR_S);
+	change->name = g_strdup (name);
+	check->changes = g_slist_prepend (check->changes, change);
+}
+
+static gchar *
+brasero_data_snapshot_get_child_path (BraseroDataSnapshot *snapshot,
+				      const BraseroDataSnapshotNode *node,
+				      const gchar *parent_path)
+{
+	if (node->flags & BRASERO_DATA_SNAPSHOT_NODE_FAKE)
+		return NULL;
+
+	if (node->uri)
+		return g_filename_from_uri (brasero_data_snapshot_get_string (snapshot, node->uri), NULL, NULL);
+
+	if (!parent_path)
+		return NULL;
+
+	return g_build_filename (parent_path,
+				 brasero_data_snapshot_get_string (snapshot, node->name),
+				 NULL);
+}
+
+/**
+ * The modification time of a directory changed: find the files that were not
+ * in it when the snapshot was saved. The ones that were removed will be found
+ * when checking its children.
+ */
+
+static void
+brasero_data_snapshot_check_directory (BraseroDataSnapshotCheck *check,
+				       guint index,
+				       const gchar *path,
+				       const gchar *disc_path)
+{
+	const BraseroDataSnapshotNode *node;
+	BraseroDataSnapshot *snapshot;
+	GHashTable *names;
+	const gchar *name;
+	guint child;
+	guint end;
+	GDir *dir;
+
+	dir = g_dir_open (path, 0, NULL);
+	if (!dir)
+		return;
+
+	snapshot = check->snapshot;
+	names = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	node = snapshot->nodes + index;
+	end = index + 1 + node->descendants;
+	for (child = index + 1; child < end; child += 1 + snapshot->nodes [child].descendants) {
+		gchar *child_path;
+		gchar *parent;
+
+		child_path = brasero_data_snapshot_get_child_path (snapshot,
+								   snapshot->nodes + child,
+								   path);
+		if (!child_path)
+			continue;
+
+		/* grafted children may come from another directory */
+		parent = g_path_get_dirname (child_path);
+		if (!strcmp (parent, path))
+			g_hash_table_insert (names, g_path_get_basename (child_path), GINT_TO_POINTER (1));
+
+		g_free (parent);
+		g_free (child_path);
+	}
+
+	while ((name = g_dir_read_name (dir))) {
+		if (!g_hash_table_lookup (names, name))
+			brasero_data_snapshot_check_add_change (check,
+								BRASERO_DATA_SNAPSHOT_ADDED,
+								disc_path,
+								name);
+	}
+
+	g_hash_table_destroy (names);
+	g_dir_close (dir);
+}
+
+static void
+brasero_data_snapshot_check_node (BraseroDataSnapshotCheck *check,
+				  guint index,
+				  const gchar *path,
+				  GString *disc_path)
+{
+	const BraseroDataSnapshotNode *node;
+	BraseroDataSnapshot *snapshot;
+	guint child;
+	guint end;
+	gsize len;
+
+	if (g_atomic_int_get (&check->cancel))
+		return;
+
+	snapshot = check->snapshot;
+	node = snapshot->nodes + index;
+
+	/* Grafts from remote locations have no local path; checking them would
+	 * mean going through GIO for the whole subtree so they are loaded
+	 * again the usual way instead. */
+	if (!path && node->uri) {
+		brasero_data_snapshot_check_add_change (check,
+							BRASERO_DATA_SNAPSHOT_DIRTY,
+							disc_path->str,
+							NULL);
+		return;
+	}
+
+	if (path) {
+		struct stat info;
+		int res;
+
+		if (node->flags & BRASERO_DATA_SNAPSHOT_NODE_SYMLINK)
+			res = g_lstat (path, &info);
+		else
+			res = g_stat (path, &info);
+
+		if (res) {
+			brasero_data_snapshot_check_add_change (check,
+								BRASERO_DATA_SNAPSHOT_REMOVED,
+								disc_path->str,
+								NULL);
+			return;
+		}
+
+		if (node->flags & BRASERO_DATA_SNAPSHOT_NODE_FILE) {
+			if ((guint64) info.st_size != node->size
+			||  (gint64) info.st_mtime != node->mtime
+			||  BRASERO_STAT_MTIME_NSEC (&info) != node->mtime_nsec)
+				brasero_data_snapshot_check_add_change (check,
+									BRASERO_DATA_SNAPSHOT_MODIFIED,
+									disc_path->str,
+									NULL);
+			return;
+		}
+
+		if ((gint64) info.st_mtime != node->mtime
+		||  BRASERO_STAT_MTIME_NSEC (&info) != node->mtime_nsec)
+			brasero_data_snapshot_check_directory (check,
+							       index,
+							       path,
+							       disc_path->str);
+	}
+
+	len = disc_path->len;
+	end = index + 1 + node->descendants;
+	for (child = index + 1; child < end; child += 1 + snapshot->nodes [child].descendants) {
+		gchar *child_path;
+
+		child_path = brasero_data_snapshot_get_child_path (snapshot,
+								   snapshot->nodes + child,
+								   path);
+
+		g_string_append_c (disc_path, G_DIR_SEPARATOR);
+		g_string_append (disc_path, brasero_data_snapshot_get_string (snapshot, snapshot->nodes [child].name));
+
+		brasero_data_snapshot_check_node (check, child, child_path, disc_path);
+
+		g_string_truncate (disc_path, len);
+		g_free (child_path);
+	}
+}
+
+static gboolean
+brasero_data_snapshot_check_idle (gpointer data)
+{
+	BraseroDataSnapshotCheck *check = data;
+
+	/* The thread is about to return; wait for it so that idle_id is set */
+	g_thread_join (check->thread);
+	check->thread = NULL;
+
+	/* NOTE: check may be freed by the callback */
+	check->idle_id = 0;
+	check->func (check->changes, check->user_data);
+	return FALSE;
+}
+
+static gpointer
+brasero_data_snapshot_check_thread (gpointer data)
+{
+	BraseroDataSnapshotCheck *check = data;
+	GString *disc_path;
+
+	disc_path = g_string_new (NULL);
+	brasero_data_snapshot_check_node (check, 0, NULL, disc_path);
+	g_string_free (disc_path, TRUE);
+
+	if (g_atomic_int_get (&check->cancel))
+		return NULL;
+
+	check->changes = g_slist_reverse (check->changes);
+	BRASERO_BURN_LOG ("Snapshot check found %i changes", g_slist_length (check->changes));
+
+	check->idle_id = g_idle_add (brasero_data_snapshot_check_idle, check);
+	return NULL;
+}
+
+/**
+ * Takes ownership of snapshot
+ */
+
+BraseroDataSnapshotCheck *
+brasero_data_snapshot_check_start (BraseroDataSnapshot *snapshot,
+				   BraseroDataSnapshotChangesFunc func,
+				   gpointer user_data)
+{
+	BraseroDataSnapshotCheck *check;
+
+	check = g_new0 (BraseroDataSnapshotCheck, 1);
+	check->snapshot = snapshot;
+	check->func = func;
+	check->user_data = user_data;
+
+	check->thread = g_thread_create (brasero_data_snapshot_check_thread,
+					 check,
+					 TRUE,
+					 NULL);
+	if (!check->thread) {
+		brasero_data_snapshot_check_free (check);
+		return NULL;
+	}
+
+	return check;
+}
+
+static void
+brasero_data_snapshot_change_free (BraseroDataSnapshotChange *change)
+{
+	g_free (change->path);
+	g_free (change->name);
+	g_free (change);
+}
+
+void
+brasero_data_snapshot_check_free (BraseroDataSnapshotCheck *check)
+{
+	if (check->thread) {
+		g_atomic_int_set (&check->cancel, 1);
+		g_thread_join (check->thread);
+		check->thread = NULL;
+	}
+
+	if (check->idle_id) {
+		g_source_remove (check->idle_id);
+		check->idle_id = 0;
+	}
+
+	g_slist_foreach (check->changes, (GFunc) brasero_data_snapshot_change_free, NULL);
+	g_slist_free (check->changes);
+
+	brasero_data_snapshot_free (check->snapshot);
+	g_free (check);
+}
@@ -0,0 +1,141 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Libbrasero-burn
+ * Copyright (C) Philippe Rouquier 2005-2009 <bonfire-app@wanadoo.fr>
+ *
+ * Libbrasero-burn is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The Libbrasero-burn authors hereby grant permission for non-GPL compatible
+ * GStreamer plugins to be used and distributed together with GStreamer
+ * and Libbrasero-burn. This permission is above and beyond the permissions granted
+ * by the GPL license by which Libbrasero-burn is covered. If you modify this code
+ * you may extend this exception to your version of the code, but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version.
+ * 
+ * Libbrasero-burn is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+#ifndef _BRASERO_DATA_SNAPSHOT_H_
+#define _BRASERO_DATA_SNAPSHOT_H_
+
+#include <glib.h>
+
+#include "brasero-file-node.h"
+
+G_BEGIN_DECLS
+
+/**
+ * A snapshot is a binary copy of a data project tree saved next to the
+ * project file. It can be read in memory and turned back into a tree
+ * without exploring any of the grafted directories. The file is made of a
+ * BraseroDataSnapshotHeader, followed by one BraseroDataSnapshotNode per node
+ * in the tree (in depth first order, starting with the root) and a string
+ * table. It is written in host byte order.
+ */
+
+typedef enum {
+	BRASERO_DATA_SNAPSHOT_NODE_FILE			= 1,
+	BRASERO_DATA_SNAPSHOT_NODE_SYMLINK		= 1 << 1,
+	BRASERO_DATA_SNAPSHOT_NODE_FAKE			= 1 << 2,
+	BRASERO_DATA_SNAPSHOT_NODE_MIME_GUESSED		= 1 << 3
+} BraseroDataSnapshotNodeFlags;
+
+struct _BraseroDataSnapshotNode {
+	/* size and modification time on the file system at save time */
+	guint64 size;
+	gint64 mtime;
+	guint32 mtime_nsec;
+
+	/* offsets in the string table; 0 is the empty string */
+	guint32 name;
+	guint32 uri;		/* only for grafted nodes */
+	guint32 mime;
+
+	guint32 sectors;
+
+	/* number of nodes in its subtree, that is the number of records
+	 * to skip to get to its next sibling */
+	guint32 descendants;
+
+	guint32 flags;
+};
+typedef struct _BraseroDataSnapshotNode BraseroDataSnapshotNode;
+
+typedef struct _BraseroDataSnapshot BraseroDataSnapshot;
+
+BraseroDataSnapshot *
+brasero_data_snapshot_open (const gchar *path,
+			    const gchar *project_path);
+
+void
+brasero_data_snapshot_free (BraseroDataSnapshot *snapshot);
+
+const BraseroDataSnapshotNode *
+brasero_data_snapshot_get_node (BraseroDataSnapshot *snapshot,
+				guint index);
+
+const gchar *
+brasero_data_snapshot_get_string (BraseroDataSnapshot *snapshot,
+				  guint32 offset);
+
+gboolean
+brasero_data_snapshot_save (BraseroFileNode *root,
+			    const gchar *path,
+			    const gchar *project_path,
+			    GError **error);
+
+/**
+ * Used to check in a thread whether the files changed since the snapshot was
+ * saved. The changes are returned in the main loop.
+ */
+
+typedef enum {
+	BRASERO_DATA_SNAPSHOT_REMOVED,
+	BRASERO_DATA_SNAPSHOT_MODIFIED,
+	BRASERO_DATA_SNAPSHOT_ADDED,
+
+	/* The node is not on a local file system so it could not be checked;
+	 * it (and its subtree for a directory) should be loaded again */
+	BRASERO_DATA_SNAPSHOT_DIRTY
+} BraseroDataSnapshotChangeType;
+
+struct _BraseroDataSnapshotChange {
+	BraseroDataSnapshotChangeType type;
+
+	/* path of the node in the project (of its parent for ADDED) */
+	gchar *path;
+
+	/* name of the file on the file system for ADDED */
+	gchar *name;
+};
+typedef struct _BraseroDataSnapshotChange BraseroDataSnapshotChange;
+
+typedef void	(*BraseroDataSnapshotChangesFunc)	(GSList *changes,
+							 gpointer user_data);
+
+typedef struct _BraseroDataSnapshotCheck BraseroDataSnapshotCheck;
+
+BraseroDataSnapshotCheck *
+brasero_data_snapshot_check_start (BraseroDataSnapshot *snapshot,
+				   BraseroDataSnapshotChangesFunc func,
+				   gpointer user_data);
+
+void
+brasero_data_snapshot_check_free (BraseroDataSnapshotCheck *check);
+
+G_END_DECLS
+
+#endif /* _BRASERO_DATA_SNAPSHOT_H_ */
@@ -63,6 +63,12 @@ struct _BraseroDataVFSPrivate
 
 	BraseroIOJobBase *load_uri;
 	BraseroIOJobBase *load_contents;
+	BraseroIOJobBase *load_mime;
+
+	/* References of the shown nodes whose mime type was only guessed
+	 * from their name, most recently shown first. */
+	GQueue *mime_queue;
+	guint mime_jobs;
 
 	GSettings *settings;
 
@@ -71,6 +77,11 @@ struct _BraseroDataVFSPrivate
 	guint filter_broken_sym:1;
 };
 
+/* Getting the real mime type of a file means reading its first bytes. So
+ * only a few are sniffed at a time and only for the last rows shown. */
+#define BRASERO_DATA_VFS_MIME_JOBS_MAX		4
+#define BRASERO_DATA_VFS_MIME_QUEUE_MAX		128
+
 #define BRASERO_DATA_VFS_PRIVATE(o)  (G_TYPE_INSTANCE_GET_PRIVATE ((o), BRASERO_TYPE_DATA_VFS, BraseroDataVFSPrivate))
 
 enum {
@@ -480,6 +491,25 @@ brasero_data_vfs_directory_load_result (GObject *owner,
 	}
 }
 
+static void
+brasero_data_vfs_directory_load_batch (GObject *owner,
+				       const gchar *uri,
+				       BraseroIOResultEntry *entries,
+				       guint entries_num,
+				       gpointer data)
+{
+	guint i;
+
+	brasero_data_project_add_batch_begin (BRASERO_DATA_PROJECT (owner));
+	for (i = 0; i < entries_num; i ++)
+		brasero_data_vfs_directory_load_result (owner,
+							entries [i].error,
+							entries [i].uri,
+							entries [i].info,
+							data);
+	brasero_data_project_add_batch_end (BRASERO_DATA_PROJECT (owner));
+}
+
 static gboolean
 brasero_data_vfs_load_directory (BraseroDataVFS *self,
 				 BraseroFileNode *node,
@@ -509,10 +539,11 @@ brasero_data_vfs_load_directory (BraseroDataVFS *self,
 			     g_slist_prepend (NULL, GINT_TO_POINTER (reference)));
 
 	if (!priv->load_contents)
-		priv->load_contents = brasero_io_register (G_OBJECT (self),
-							   brasero_data_vfs_directory_load_result,
-							   brasero_data_vfs_directory_load_end,
-							   NULL);
+		priv->load_contents = brasero_io_register_batch (G_OBJECT (self),
+								 brasero_data_vfs_directory_load_result,
+								 brasero_data_vfs_directory_load_batch,
+								 brasero_data_vfs_directory_load_end,
+								 NULL);
 
 	/* no need to require mime types here as these rows won't be visible */
 	brasero_io_load_directory (uri,
@@ -533,6 +564,18 @@ brasero_data_vfs_load_directory (BraseroDataVFS *self,
 	return TRUE;
 }
 
+static void
+brasero_data_vfs_load_mime_next (BraseroDataVFS *self);
+
+static void
+brasero_data_vfs_queue_mime (BraseroDataVFS *self,
+			     BraseroFileNode *node);
+
+static void
+brasero_data_vfs_mime_end (GObject *object,
+			   gboolean cancelled,
+			   gpointer data);
+
 /**
  * Update a node already in the tree
  */
@@ -549,6 +592,9 @@ brasero_data_vfs_loading_node_end (GObject *object,
 	brasero_data_vfs_remove_from_hash (self, priv->loading, uri);
 	brasero_utils_unregister_string (uri);
 
+	if (!cancelled)
+		brasero_data_vfs_load_mime_next (self);
+
 	/* Only emit a signal if state changed. Some widgets need to know if 
 	 * either directories loading or uri loading state has changed to signal
 	 * it even if there were some directories loading.
@@ -570,6 +616,7 @@ brasero_data_vfs_loading_node_result (GObject *owner,
 {
 	GSList *iter;
 	GSList *nodes;
+	const gchar *mime;
 	BraseroFileNode *root;
 	BraseroFileTreeStats *stats;
 	gchar *registered = callback_data;
@@ -602,14 +649,16 @@ brasero_data_vfs_loading_node_result (GObject *owner,
 	 * check it is an image. If so, ask him if that's he really want to do. */
 	root = brasero_data_project_get_root (BRASERO_DATA_PROJECT (self));
 	stats = BRASERO_FILE_NODE_STATS (root);
+	mime = g_file_info_get_content_type (info);
 
 	if (stats && !stats->children
 	&&  brasero_file_node_get_n_children (root) <= 1
-	&& (!strcmp (g_file_info_get_content_type (info), "application/x-toc")
-	||  !strcmp (g_file_info_get_content_type (info), "application/x-cdrdao-toc")
-	||  !strcmp (g_file_info_get_content_type (info), "application/x-cue")
-	||  !strcmp (g_file_info_get_content_type (info), "application/vnd.efi.iso")
-	||  !strcmp (g_file_info_get_content_type (info), "application/x-cd-image"))) {
+	&&  mime
+	&& (!strcmp (mime, "application/x-toc")
+	||  !strcmp (mime, "application/x-cdrdao-toc")
+	||  !strcmp (mime, "application/x-cue")
+	||  !strcmp (mime, "application/vnd.efi.iso")
+	||  !strcmp (mime, "application/x-cd-image"))) {
 		BraseroBurnResult result;
 
 		result = brasero_data_vfs_emit_image_signal (self, uri);
@@ -688,8 +737,14 @@ brasero_data_vfs_loading_node_result (GObject *owner,
 
 		/* See what type of file it is. If that's a directory then 
 		 * explore it right away */
-		if (node->is_file)
+		if (node->is_file) {
+			/* Its type was only guessed; get the real one if it
+			 * is displayed once this URI is no longer loading */
+			if (node->is_visible && node->is_mime_guessed)
+				brasero_data_vfs_queue_mime (self, node);
+
 			continue;
+		}
 
 		/* starts exploring its contents */
 		brasero_data_vfs_load_directory (self, node, uri);
@@ -697,10 +752,11 @@ brasero_data_vfs_loading_node_result (GObject *owner,
 }
 
 static gboolean
-brasero_data_vfs_load_node (BraseroDataVFS *self,
-			    BraseroIOFlags flags,
-			    guint reference,
-			    const gchar *uri)
+brasero_data_vfs_load_node_real (BraseroDataVFS *self,
+				 BraseroIOJobBase *base,
+				 BraseroIOFlags flags,
+				 guint reference,
+				 const gchar *uri)
 {
 	BraseroDataVFSPrivate *priv;
 	gchar *registered;
@@ -712,14 +768,8 @@ brasero_data_vfs_load_node (BraseroDataVFS *self,
 			     registered,
 			     g_slist_prepend (NULL, GINT_TO_POINTER (reference)));
 
-	if (!priv->load_uri)
-		priv->load_uri = brasero_io_register (G_OBJECT (self),
-						      brasero_data_vfs_loading_node_result,
-						      brasero_data_vfs_loading_node_end,
-						      NULL);
-
 	brasero_io_get_file_info (uri,
-				  priv->load_uri,
+				  base,
 				  flags|
 				  (priv->replace_sym ? BRASERO_IO_INFO_FOLLOW_SYMLINK:BRASERO_IO_INFO_NONE),
 				  registered);
@@ -736,12 +786,38 @@ brasero_data_vfs_load_node (BraseroDataVFS *self,
 	return TRUE;
 }
 
+static gboolean
+brasero_data_vfs_load_node (BraseroDataVFS *self,
+			    BraseroIOFlags flags,
+			    guint reference,
+			    const gchar *uri)
+{
+	BraseroDataVFSPrivate *priv;
+
+	priv = BRASERO_DATA_VFS_PRIVATE (self);
+
+	if (!priv->load_uri)
+		priv->load_uri = brasero_io_register (G_OBJECT (self),
+						      brasero_data_vfs_loading_node_result,
+						      brasero_data_vfs_loading_node_end,
+						      NULL);
+
+	return brasero_data_vfs_load_node_real (self,
+						priv->load_uri,
+						flags,
+						reference,
+						uri);
+}
+
 static gboolean
 brasero_data_vfs_loading_node (BraseroDataVFS *self,
 			       BraseroFileNode *node,
 			       const gchar *uri)
 {
 	BraseroDataVFSPrivate *priv;
+	BraseroFileTreeStats *stats;
+	BraseroIOFlags flags;
+	BraseroFileNode *root;
 	guint reference;
 	GSList *nodes;
 
@@ -776,11 +852,20 @@ brasero_data_vfs_loading_node (BraseroDataVFS *self,
 		return TRUE;
 	}
 
-	/* loading nodes are almost always visible already so get mime type */
+	/* Only sniff the mime type right away when it is needed to check
+	 * whether the user dropped an image (see above). Otherwise it is
+	 * guessed from the name and the real one is only looked for when
+	 * the row is displayed. */
+	flags = BRASERO_IO_INFO_PERM|BRASERO_IO_INFO_CHECK_PARENT_SYMLINK;
+
+	root = brasero_data_project_get_root (BRASERO_DATA_PROJECT (self));
+	stats = BRASERO_FILE_NODE_STATS (root);
+	if (stats && !stats->children
+	&&  brasero_file_node_get_n_children (root) <= 1)
+		flags |= BRASERO_IO_INFO_MIME;
+
 	return brasero_data_vfs_load_node (self,
-					   BRASERO_IO_INFO_PERM|
-					   BRASERO_IO_INFO_MIME|
-					   BRASERO_IO_INFO_CHECK_PARENT_SYMLINK,
+					   flags,
 					   reference,
 					   uri);
 }
@@ -838,74 +923,119 @@ brasero_data_vfs_require_node_load (BraseroDataVFS *self,
 							 priv->load_uri);
 }
 
-gboolean
-brasero_data_vfs_load_mime (BraseroDataVFS *self,
-			    BraseroFileNode *node)
+static void
+brasero_data_vfs_load_mime_next (BraseroDataVFS *self)
 {
 	BraseroDataVFSPrivate *priv;
-	guint reference;
-	gboolean result;
-	GSList *nodes;
-	gchar *uri;
 
 	priv = BRASERO_DATA_VFS_PRIVATE (self);
 
-	if (node->is_loading || node->is_reloading) {
-		brasero_data_vfs_require_node_load (self, node);
-		return TRUE;
-	}
+	while (priv->mime_jobs < BRASERO_DATA_VFS_MIME_JOBS_MAX
+	&&    !g_queue_is_empty (priv->mime_queue)) {
+		BraseroFileNode *node;
+		guint reference;
+		GSList *nodes;
+		gchar *uri;
 
-	uri = brasero_data_project_node_to_uri (BRASERO_DATA_PROJECT (self), node);
-	node->is_reloading = TRUE;
+		reference = GPOINTER_TO_INT (g_queue_pop_head (priv->mime_queue));
+		node = brasero_data_project_reference_get (BRASERO_DATA_PROJECT (self), reference);
 
-	/* make sure the node is not already in the loading table */
-	nodes = g_hash_table_lookup (priv->loading, uri);
-	if (nodes) {
-		gchar *registered;
-		GSList *iter;
+		/* Only bother with the rows that are still displayed */
+		if (!node
+		||  !node->is_file
+		||  !node->is_visible
+		||  !node->is_mime_guessed
+		||   node->is_loading
+		||   node->is_reloading) {
+			brasero_data_project_reference_free (BRASERO_DATA_PROJECT (self), reference);
+			continue;
+		}
 
-		registered = brasero_utils_register_string (uri);
-		g_free (uri);
+		uri = brasero_data_project_node_to_uri (BRASERO_DATA_PROJECT (self), node);
+		if (!uri) {
+			brasero_data_project_reference_free (BRASERO_DATA_PROJECT (self), reference);
+			continue;
+		}
 
-		for (iter = nodes; iter; iter = iter->next) {
-			guint reference;
-			BraseroFileNode *ref_node;
+		node->is_reloading = TRUE;
 
-			reference = GPOINTER_TO_INT (iter->data);
-			ref_node = brasero_data_project_reference_get (BRASERO_DATA_PROJECT (self), reference);
-			if (ref_node == node) {
-				/* Ask for a higher priority */
-				brasero_io_find_urgent (priv->load_uri,
-							brasero_data_vfs_increase_priority_cb,
-							registered);
-				brasero_utils_unregister_string (registered);
-				return TRUE;
-			}
-		}
+		/* make sure the node is not already in the loading table */
+		nodes = g_hash_table_lookup (priv->loading, uri);
+		if (nodes) {
+			gchar *registered;
 
-		/* It's loading, wait for the results */
-		reference = brasero_data_project_reference_new (BRASERO_DATA_PROJECT (self), node);
-		nodes = g_slist_prepend (nodes, GINT_TO_POINTER (reference));
-		g_hash_table_insert (priv->loading, registered, nodes);
+			/* It's loading, wait for the results */
+			registered = brasero_utils_register_string (uri);
+			nodes = g_slist_prepend (nodes, GINT_TO_POINTER (reference));
+			g_hash_table_insert (priv->loading, registered, nodes);
+			brasero_utils_unregister_string (registered);
+			g_free (uri);
+			continue;
+		}
 
-		/* Yet, ask for a higher priority */
-		brasero_io_find_urgent (priv->load_uri,
-					brasero_data_vfs_increase_priority_cb,
-					registered);
-		brasero_utils_unregister_string (registered);
-		return TRUE;
+		if (!priv->load_mime)
+			priv->load_mime = brasero_io_register (G_OBJECT (self),
+							       brasero_data_vfs_loading_node_result,
+							       brasero_data_vfs_mime_end,
+							       NULL);
+
+		priv->mime_jobs ++;
+		brasero_data_vfs_load_node_real (self,
+						 priv->load_mime,
+						 BRASERO_IO_INFO_MIME|
+						 BRASERO_IO_INFO_URGENT,
+						 reference,
+						 uri);
+		g_free (uri);
 	}
+}
+
+static void
+brasero_data_vfs_mime_end (GObject *object,
+			   gboolean cancelled,
+			   gpointer data)
+{
+	BraseroDataVFSPrivate *priv;
+
+	priv = BRASERO_DATA_VFS_PRIVATE (object);
+	if (priv->mime_jobs)
+		priv->mime_jobs --;
+
+	brasero_data_vfs_loading_node_end (object, cancelled, data);
+}
+
+static void
+brasero_data_vfs_queue_mime (BraseroDataVFS *self,
+			     BraseroFileNode *node)
+{
+	BraseroDataVFSPrivate *priv;
+	guint reference;
 
+	priv = BRASERO_DATA_VFS_PRIVATE (self);
+
+	/* The most recently shown rows go first. If there are too many rows
+	 * waiting, the oldest ones were probably scrolled away already. */
 	reference = brasero_data_project_reference_new (BRASERO_DATA_PROJECT (self), node);
-	result = brasero_data_vfs_load_node (self,
-					     BRASERO_IO_INFO_MIME|
-					     BRASERO_IO_INFO_URGENT|
-					     (priv->replace_sym ? BRASERO_IO_INFO_FOLLOW_SYMLINK:BRASERO_IO_INFO_NONE),
-					     reference,
-					     uri);
-	g_free (uri);
+	g_queue_push_head (priv->mime_queue, GINT_TO_POINTER (reference));
 
-	return result;
+	if (g_queue_get_length (priv->mime_queue) > BRASERO_DATA_VFS_MIME_QUEUE_MAX) {
+		reference = GPOINTER_TO_INT (g_queue_pop_tail (priv->mime_queue));
+		brasero_data_project_reference_free (BRASERO_DATA_PROJECT (self), reference);
+	}
+}
+
+gboolean
+brasero_data_vfs_load_mime (BraseroDataVFS *self,
+			    BraseroFileNode *node)
+{
+	if (node->is_loading || node->is_reloading) {
+		brasero_data_vfs_require_node_load (self, node);
+		return TRUE;
+	}
+
+	brasero_data_vfs_queue_mime (self, node);
+	brasero_data_vfs_load_mime_next (self);
+	return TRUE;
 }
 
 /**
@@ -989,6 +1119,20 @@ brasero_data_vfs_clear (BraseroDataVFS *self)
 		priv->load_contents = NULL;
 	}
 
+	if (priv->load_mime) {
+		brasero_io_cancel_by_base (priv->load_mime);
+		brasero_io_job_base_free (priv->load_mime);
+		priv->load_mime = NULL;
+	}
+	priv->mime_jobs = 0;
+
+	while (!g_queue_is_empty (priv->mime_queue)) {
+		guint reference;
+
+		reference = GPOINTER_TO_INT (g_queue_pop_head (priv->mime_queue));
+		brasero_data_project_reference_free (BRASERO_DATA_PROJECT (self), reference);
+	}
+
 	/* Empty the hash tables */
 	g_hash_table_foreach_remove (priv->loading,
 				     brasero_data_vfs_empty_loading_cb,
@@ -1064,6 +1208,8 @@ brasero_data_vfs_init (BraseroDataVFS *object)
 	/* create the hash tables */
 	priv->loading = g_hash_table_new (g_str_hash, g_str_equal);
 	priv->directories = g_hash_table_new (g_str_hash, g_str_equal);
+
+	priv->mime_queue = g_queue_new ();
 }
 
 static void
@@ -1085,6 +1231,11 @@ brasero_data_vfs_finalize (GObject *object)
 		priv->directories = NULL;
 	}
 
+	if (priv->mime_queue) {
+		g_queue_free (priv->mime_queue);
+		priv->mime_queue = NULL;
+	}
+
 	if (priv->filtered) {
 		g_object_unref (priv->filtered);
 		priv->filtered = NULL;
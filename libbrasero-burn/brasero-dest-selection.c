@@ -155,6 +155,19 @@ brasero_dest_selection_flags_changed (BraseroBurnSession *session,
 	brasero_dest_selection_lock (self, (brasero_burn_session_get_flags (BRASERO_BURN_SESSION (priv->session)) & BRASERO_BURN_FLAG_MERGE) != 0);
 }
 
+static void
+brasero_dest_selection_refreshed_cb (BraseroMedium *medium,
+				     gboolean changed,
+				     gpointer user_data)
+{
+	BraseroDestSelection *self = user_data;
+
+	if (changed && !gtk_widget_in_destruction (GTK_WIDGET (self)))
+		brasero_medium_selection_update_media_string (BRASERO_MEDIUM_SELECTION (self));
+
+	g_object_unref (self);
+}
+
 static void
 brasero_dest_selection_medium_changed (BraseroMediumSelection *selection,
 				       BraseroMedium *medium)
@@ -171,6 +184,13 @@ brasero_dest_selection_medium_changed (BraseroMediumSelection *selection,
 		goto chain;
 	}
 
+	/* The free space shown was retrieved when the medium was probed;
+	 * ask the drive again without blocking and update the string */
+	if (brasero_medium_refresh_async (medium,
+					  brasero_dest_selection_refreshed_cb,
+					  selection))
+		g_object_ref (selection);
+
 	if (brasero_medium_get_drive (medium) == brasero_burn_session_get_burner (priv->session))
 		goto chain;
 
@@ -543,7 +543,7 @@ brasero_drive_properties_format_disc_speed (BraseroMedia media,
 }
 
 static void
-brasero_drive_properties_set_drive (BraseroDriveProperties *self,
+brasero_drive_properties_set_rates (BraseroDriveProperties *self,
 				    BraseroDrive *drive,
 				    gint64 default_rate)
 {
@@ -621,6 +621,57 @@ brasero_drive_properties_set_drive (BraseroDriveProperties *self,
 	}
 }
 
+static void
+brasero_drive_properties_refreshed_cb (BraseroMedium *medium,
+				       gboolean changed,
+				       gpointer user_data)
+{
+	BraseroDriveProperties *self = user_data;
+	BraseroDrivePropertiesPrivate *priv;
+	BraseroDrive *drive;
+
+	priv = BRASERO_DRIVE_PROPERTIES_PRIVATE (self);
+
+	if (!changed
+	||  !priv->session
+	||   gtk_widget_in_destruction (GTK_WIDGET (self)))
+		goto end;
+
+	/* Make sure the burner didn't change in the meantime */
+	drive = brasero_burn_session_get_burner (BRASERO_BURN_SESSION (priv->session));
+	if (!drive || brasero_drive_get_medium (drive) != medium)
+		goto end;
+
+	brasero_drive_properties_set_rates (self,
+					    drive,
+					    brasero_burn_session_get_rate (BRASERO_BURN_SESSION (priv->session)));
+
+end:
+
+	g_object_unref (self);
+}
+
+static void
+brasero_drive_properties_set_drive (BraseroDriveProperties *self,
+				    BraseroDrive *drive,
+				    gint64 default_rate)
+{
+	BraseroMedium *medium;
+
+	/* Show what we got while probing right away and ask the drive
+	 * again in the background since speeds may change over time */
+	brasero_drive_properties_set_rates (self, drive, default_rate);
+
+	medium = brasero_drive_get_medium (drive);
+	if (!medium)
+		return;
+
+	if (brasero_medium_refresh_async (medium,
+					  brasero_drive_properties_refreshed_cb,
+					  self))
+		g_object_ref (self);
+}
+
 static void
 brasero_drive_properties_update (BraseroDriveProperties *self)
 {
@@ -858,6 +858,17 @@ brasero_file_node_set_from_info (BraseroFileNode *node,
 
 			mime = g_file_info_get_content_type (info);
 			node->union2.mime = brasero_utils_register_string (mime);
+			node->is_mime_guessed = FALSE;
+		}
+		else if (!BRASERO_FILE_NODE_MIME (node) && g_file_info_get_name (info)) {
+			gchar *mime;
+
+			/* Sniffing the contents is expensive so use the name
+			 * until the real type is needed (see data-vfs.c). */
+			mime = g_content_type_guess (g_file_info_get_name (info), NULL, 0, NULL);
+			node->union2.mime = brasero_utils_register_string (mime);
+			node->is_mime_guessed = TRUE;
+			g_free (mime);
 		}
 
 		sectors = BRASERO_BYTES_TO_SECTORS (g_file_info_get_size (info), 2048);
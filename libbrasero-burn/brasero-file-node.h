@@ -151,6 +151,9 @@ struct _BraseroFileNode {
 	/* Used to determine if is should be shown */
 	guint is_hidden:1;
 
+	/* The mime type was only guessed from the name */
+	guint is_mime_guessed:1;
+
 	/* Used by the model */
 	/* This is a workaround for a warning in gailtreeview.c line 2946 where
 	 * gail uses the GtkTreePath and not a copy which if the node inserted
@@ -0,0 +1,287 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Libbrasero-burn
+ * Copyright (C) Philippe Rouquier 2005-2009 <bonfire-app@wanadoo.fr>
+ *
+ * Libbrasero-burn is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The Libbrasero-burn authors hereby grant permission for non-GPL compatible
+ * GStreamer plugins to be used and distributed together with GStreamer
+ * and Libbrasero-burn. This permission is above and beyond the permissions granted
+ * by the GPL license by which Libbrasero-burn is covered. If you modify this code
+ * you may extend this exception to your version of the code, but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version.
+ * 
+ * Libbrasero-burn is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "brasero-graft-index.h"
+
+typedef struct _BraseroGraftIndexNode BraseroGraftIndexNode;
+struct _BraseroGraftIndexNode {
+	/* NOTE: name is not NULL terminated when the node is used as a lookup
+	 * key; it then points directly inside the URI that is looked up. */
+	gchar *name;
+	gsize len;
+
+	gpointer data;
+
+	BraseroGraftIndexNode *parent;
+	GHashTable *children;
+};
+
+struct _BraseroGraftIndex {
+	BraseroGraftIndexNode root;
+};
+
+static guint
+brasero_graft_index_node_hash (gconstpointer key)
+{
+	const BraseroGraftIndexNode *node = key;
+	guint hash = 5381;
+	gsize i;
+
+	for (i = 0; i < node->len; i ++)
+		hash = (hash << 5) + hash + (guchar) node->name [i];
+
+	return hash;
+}
+
+static gboolean
+brasero_graft_index_node_equal (gconstpointer a,
+				gconstpointer b)
+{
+	const BraseroGraftIndexNode *node_a = a;
+	const BraseroGraftIndexNode *node_b = b;
+
+	if (node_a->len != node_b->len)
+		return FALSE;
+
+	return (memcmp (node_a->name, node_b->name, node_a->len) == 0);
+}
+
+static BraseroGraftIndexNode *
+brasero_graft_index_node_lookup (BraseroGraftIndexNode *parent,
+				 const gchar *name,
+				 gsize len)
+{
+	BraseroGraftIndexNode key;
+
+	if (!parent->children)
+		return NULL;
+
+	/* the key lives on the stack; nothing is allocated */
+	key.name = (gchar *) name;
+	key.len = len;
+	return g_hash_table_lookup (parent->children, &key);
+}
+
+static BraseroGraftIndexNode *
+brasero_graft_index_node_ensure (BraseroGraftIndexNode *parent,
+				 const gchar *name,
+				 gsize len)
+{
+	BraseroGraftIndexNode *node;
+
+	node = brasero_graft_index_node_lookup (parent, name, len);
+	if (node)
+		return node;
+
+	if (!parent->children)
+		parent->children = g_hash_table_new (brasero_graft_index_node_hash,
+						     brasero_graft_index_node_equal);
+
+	node = g_new0 (BraseroGraftIndexNode, 1);
+	node->name = g_strndup (name, len);
+	node->len = len;
+	node->parent = parent;
+	g_hash_table_insert (parent->children, node, node);
+	return node;
+}
+
+static void
+brasero_graft_index_node_free_children (BraseroGraftIndexNode *node)
+{
+	GHashTableIter iter;
+	gpointer child;
+
+	if (!node->children)
+		return;
+
+	g_hash_table_iter_init (&iter, node->children);
+	while (g_hash_table_iter_next (&iter, &child, NULL)) {
+		BraseroGraftIndexNode *child_node = child;
+
+		brasero_graft_index_node_free_children (child_node);
+		g_free (child_node->name);
+		g_free (child_node);
+	}
+
+	g_hash_table_destroy (node->children);
+	node->children = NULL;
+}
+
+/**
+ * Returns the node matching exactly uri or NULL if there isn't any.
+ */
+
+static BraseroGraftIndexNode *
+brasero_graft_index_find (BraseroGraftIndex *self,
+			  const gchar *uri)
+{
+	BraseroGraftIndexNode *node;
+	const gchar *start;
+
+	node = &self->root;
+	start = uri;
+	while (node) {
+		const gchar *end;
+
+		end = strchr (start, G_DIR_SEPARATOR);
+		if (!end)
+			return brasero_graft_index_node_lookup (node, start, strlen (start));
+
+		node = brasero_graft_index_node_lookup (node, start, end - start);
+		start = end + 1;
+	}
+
+	return NULL;
+}
+
+void
+brasero_graft_index_insert (BraseroGraftIndex *self,
+			    const gchar *uri,
+			    gpointer data)
+{
+	BraseroGraftIndexNode *node;
+	const gchar *start;
+	const gchar *end;
+
+	node = &self->root;
+	start = uri;
+	while ((end = strchr (start, G_DIR_SEPARATOR))) {
+		node = brasero_graft_index_node_ensure (node, start, end - start);
+		start = end + 1;
+	}
+
+	node = brasero_graft_index_node_ensure (node, start, strlen (start));
+	node->data = data;
+}
+
+void
+brasero_graft_index_remove (BraseroGraftIndex *self,
+			    const gchar *uri)
+{
+	BraseroGraftIndexNode *node;
+
+	node = brasero_graft_index_find (self, uri);
+	if (!node)
+		return;
+
+	node->data = NULL;
+
+	/* prune all the branches that lead to nothing anymore */
+	while (node != &self->root
+	&&    !node->data
+	&&    (!node->children || !g_hash_table_size (node->children))) {
+		BraseroGraftIndexNode *parent;
+
+		parent = node->parent;
+		g_hash_table_remove (parent->children, node);
+
+		if (node->children)
+			g_hash_table_destroy (node->children);
+
+		g_free (node->name);
+		g_free (node);
+
+		node = parent;
+	}
+}
+
+/**
+ * Returns the data associated with the closest grafted ancestor of uri.
+ * The ancestors considered are the ones g_path_get_dirname () would return
+ * going up the URI until there is no more separator or until "/" is
+ * reached. relative, if not NULL, is set to point inside uri, on the
+ * separator that follows the ancestor.
+ */
+
+gpointer
+brasero_graft_index_lookup_parent (BraseroGraftIndex *self,
+				   const gchar *uri,
+				   const gchar **relative)
+{
+	BraseroGraftIndexNode *node;
+	const gchar *first_separator;
+	const gchar *start;
+	const gchar *end;
+	gpointer data = NULL;
+
+	first_separator = strchr (uri, G_DIR_SEPARATOR);
+	if (!first_separator)
+		return NULL;
+
+	node = &self->root;
+	start = uri;
+
+	/* NOTE: the last component is the URI itself so it is never looked up */
+	while ((end = strchr (start, G_DIR_SEPARATOR))) {
+		node = brasero_graft_index_node_lookup (node, start, end - start);
+		if (!node)
+			break;
+
+		/* Only prefixes that contain a separator and that don't end
+		 * with one (that is an empty component) can be ancestors. */
+		if (node->data && end > start && end > first_separator) {
+			data = node->data;
+			if (relative)
+				*relative = end;
+		}
+
+		start = end + 1;
+	}
+
+	return data;
+}
+
+void
+brasero_graft_index_clear (BraseroGraftIndex *self)
+{
+	brasero_graft_index_node_free_children (&self->root);
+}
+
+BraseroGraftIndex *
+brasero_graft_index_new (void)
+{
+	return g_new0 (BraseroGraftIndex, 1);
+}
+
+void
+brasero_graft_index_free (BraseroGraftIndex *self)
+{
+	brasero_graft_index_clear (self);
+	g_free (self);
+}
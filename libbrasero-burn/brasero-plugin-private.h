@@ -69,6 +69,9 @@ gboolean
 brasero_plugin_get_process_flags (BraseroPlugin *plugin,
 				  BraseroPluginProcessFlag *flags);
 
+gboolean
+brasero_plugin_get_accept_remote_files (BraseroPlugin *plugin);
+
 gboolean
 brasero_plugin_check_image_flags (BraseroPlugin *plugin,
 				  BraseroMedia media,
@@ -137,6 +137,15 @@ void
 brasero_plugin_set_process_flags (BraseroPlugin *plugin,
 				  BraseroPluginProcessFlag flags);
 
+/**
+ * Plugins creating images from data tracks that can read files not stored
+ * locally (GIO URIs) themselves. Those files won't be downloaded before.
+ */
+
+void
+brasero_plugin_set_accept_remote_files (BraseroPlugin *plugin,
+					gboolean accept);
+
 void
 brasero_plugin_check_caps (BraseroPlugin *plugin,
 			   BraseroChecksumType type,
@@ -65,6 +65,8 @@ struct BraseroBurnProgressPrivate {
 	GtkWidget *speed;
 	GtkWidget *speed_label;
 	GtkWidget *speed_table;
+	GtkWidget *buffer;
+	GtkWidget *buffer_label;
 	GtkWidget *bytes_written;
 
 	BraseroBurnAction current;
@@ -134,9 +136,11 @@ brasero_burn_progress_create_info (BraseroBurnProgress *obj)
 		obj->priv->speed_table = NULL;
 		obj->priv->speed_label = NULL;
 		obj->priv->speed = NULL;
+		obj->priv->buffer_label = NULL;
+		obj->priv->buffer = NULL;
 	}
 
-	table = gtk_table_new (1, 2, FALSE);
+	table = gtk_table_new (2, 2, FALSE);
 	obj->priv->speed_table = table;
 	gtk_container_set_border_width (GTK_CONTAINER (table), 0);
 
@@ -164,6 +168,35 @@ brasero_burn_progress_create_info (BraseroBurnProgress *obj)
 			  GTK_FILL,
 			  0,
 			  0);
+
+	/* Only shown when a disc is copied on the fly through a buffer */
+	label = gtk_label_new (_("Copy buffer:"));
+	obj->priv->buffer_label = label;
+	gtk_misc_set_alignment (GTK_MISC (label), 0.0, 1.0);
+	gtk_widget_set_no_show_all (label, TRUE);
+	gtk_table_attach (GTK_TABLE (table), label,
+			  0,
+			  1,
+			  1,
+			  2,
+			  GTK_EXPAND|GTK_FILL,
+			  GTK_EXPAND|GTK_FILL,
+			  0,
+			  0);
+
+	obj->priv->buffer = gtk_label_new (" ");
+	gtk_misc_set_alignment (GTK_MISC (obj->priv->buffer), 1.0, 0.0);
+	gtk_widget_set_no_show_all (obj->priv->buffer, TRUE);
+	gtk_table_attach (GTK_TABLE (table), obj->priv->buffer,
+			  1,
+			  2,
+			  1,
+			  2,
+			  GTK_FILL,
+			  GTK_FILL,
+			  0,
+			  0);
+
 	gtk_box_pack_start (GTK_BOX (obj), table, FALSE, TRUE, 12);
 	gtk_widget_show_all (table);
 }
@@ -186,6 +219,8 @@ brasero_burn_progress_display_session_info (BraseroBurnProgress *obj,
 		obj->priv->speed_table = NULL;
 		obj->priv->speed_label = NULL;
 		obj->priv->speed = NULL;
+		obj->priv->buffer_label = NULL;
+		obj->priv->buffer = NULL;
 	}
 
 	hrs = time / 3600;
@@ -270,6 +305,8 @@ brasero_burn_progress_set_property (GObject *object,
 				progress->priv->speed_table = NULL;
 				progress->priv->speed_label = NULL;
 				progress->priv->speed = NULL;
+				progress->priv->buffer_label = NULL;
+				progress->priv->buffer = NULL;
 			}
 		}
 		else if (progress->priv->speed_table)
@@ -487,6 +524,35 @@ brasero_burn_progress_set_status (BraseroBurnProgress *self,
 		gtk_label_set_text (GTK_LABEL (self->priv->bytes_written), " ");
 }
 
+void
+brasero_burn_progress_set_copy_buffer (BraseroBurnProgress *self,
+				       gint fill,
+				       guint64 read_rate)
+{
+	gchar *text;
+
+	if (!self->priv->buffer)
+		return;
+
+	if (fill < 0) {
+		gtk_widget_hide (self->priv->buffer_label);
+		gtk_widget_hide (self->priv->buffer);
+		return;
+	}
+
+	/* Translators: the first %i is how full (in percent) the buffer is,
+	 * the second number is the rate (in KiB/s) at which the source disc
+	 * is read. The double % is needed to print a percent sign. */
+	text = g_strdup_printf (_("%i%% full, read at %"G_GUINT64_FORMAT" KiB/s"),
+				fill,
+				read_rate / 1024);
+	gtk_label_set_text (GTK_LABEL (self->priv->buffer), text);
+	g_free (text);
+
+	gtk_widget_show (self->priv->buffer_label);
+	gtk_widget_show (self->priv->buffer);
+}
+
 void
 brasero_burn_progress_set_action (BraseroBurnProgress *self,
 				  BraseroBurnAction action,
@@ -542,6 +608,8 @@ brasero_burn_progress_reset (BraseroBurnProgress *progress)
 	if (progress->priv->speed)
 		gtk_label_set_text (GTK_LABEL (progress->priv->speed), " ");
 
+	brasero_burn_progress_set_copy_buffer (progress, -1, 0);
+
 	gtk_label_set_text (GTK_LABEL (progress->priv->action), NULL);
 	gtk_label_set_text (GTK_LABEL (progress->priv->bytes_written), NULL);
 
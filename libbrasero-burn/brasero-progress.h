@@ -82,6 +82,11 @@ brasero_burn_progress_display_session_info (BraseroBurnProgress *progress,
 					    BraseroMedia media,
 					    gint mb_written);
 
+void
+brasero_burn_progress_set_copy_buffer (BraseroBurnProgress *progress,
+				       gint fill,
+				       guint64 read_rate);
+
 void
 brasero_burn_progress_set_action (BraseroBurnProgress *progress,
 				  BraseroBurnAction action,
@@ -37,6 +37,7 @@
 #include "brasero-drive.h"
 
 #include "brasero-session.h"
+#include "brasero-session-span.h"
 
 G_BEGIN_DECLS
 
@@ -69,6 +70,10 @@ brasero_burn_session_is_dest_file (BraseroBurnSession *session);
 gboolean
 brasero_burn_session_same_src_dest_drive (BraseroBurnSession *session);
 
+BraseroBurnResult
+brasero_session_span_next_to_session (BraseroSessionSpan *session,
+				      BraseroBurnSession *dest);
+
 #define BRASERO_BURN_SESSION_EJECT(session)					\
 (brasero_burn_session_get_flags ((session)) & BRASERO_BURN_FLAG_EJECT)
 
@@ -97,6 +102,10 @@ brasero_burn_session_get_tmp_file (BraseroBurnSession *session,
 				   gchar **path,
 				   GError **error);
 
+void
+brasero_burn_session_add_tmp_file (BraseroBurnSession *session,
+				   const gchar *path);
+
 BraseroBurnResult
 brasero_burn_session_get_tmp_dir (BraseroBurnSession *session,
 				  gchar **path,
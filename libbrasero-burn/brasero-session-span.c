@@ -246,19 +246,9 @@ brasero_session_span_start (BraseroSessionSpan *session)
 	return BRASERO_BURN_OK;
 }
 
-/**
- * brasero_session_span_next:
- * @session: a #BraseroSessionSpan
- *
- * Sets the next batch of data to be burnt onto the medium inserted in the #BraseroDrive
- * set for @session (see brasero_burn_session_set_burner ()). Its free space or it capacity
- * will be used as the maximum amount of data to be burnt.
- *
- * Return value: a #BraseroBurnResult. BRASERO_BURN_OK if successful.
- **/
-
-BraseroBurnResult
-brasero_session_span_next (BraseroSessionSpan *session)
+static BraseroBurnResult
+brasero_session_span_next_real (BraseroSessionSpan *session,
+				BraseroBurnSession *dest)
 {
 	GSList *tracks;
 	gboolean pushed = FALSE;
@@ -266,13 +256,11 @@ brasero_session_span_next (BraseroSessionSpan *session)
 	goffset total_sectors = 0;
 	BraseroSessionSpanPrivate *priv;
 
-	g_return_val_if_fail (BRASERO_IS_SESSION_SPAN (session), BRASERO_BURN_ERR);
-
 	priv = BRASERO_SESSION_SPAN_PRIVATE (session);
 
 	g_return_val_if_fail (priv->track_list != NULL, BRASERO_BURN_ERR);
 
-	max_sectors = brasero_burn_session_get_available_medium_space (BRASERO_BURN_SESSION (session));
+	max_sectors = brasero_burn_session_get_available_medium_space (dest);
 	if (max_sectors <= 0)
 		return BRASERO_BURN_ERR;
 
@@ -315,8 +303,10 @@ brasero_session_span_next (BraseroSessionSpan *session)
 			}
 
 			pushed = TRUE;
-			brasero_burn_session_push_tracks (BRASERO_BURN_SESSION (session));
-			brasero_burn_session_add_track (BRASERO_BURN_SESSION (session),
+			if (dest == BRASERO_BURN_SESSION (session))
+				brasero_burn_session_push_tracks (dest);
+
+			brasero_burn_session_add_track (dest,
 							BRASERO_TRACK (new_track),
 							NULL);
 			break;
@@ -335,14 +325,14 @@ brasero_session_span_next (BraseroSessionSpan *session)
 
 		total_sectors += track_blocks;
 
-		if (!pushed) {
+		if (!pushed && dest == BRASERO_BURN_SESSION (session)) {
 			BRASERO_BURN_LOG ("Pushing tracks for media spanning");
-			brasero_burn_session_push_tracks (BRASERO_BURN_SESSION (session));
-			pushed = TRUE;
+			brasero_burn_session_push_tracks (dest);
 		}
+		pushed = TRUE;
 
 		BRASERO_BURN_LOG ("Adding tracks");
-		brasero_burn_session_add_track (BRASERO_BURN_SESSION (session), track, NULL);
+		brasero_burn_session_add_track (dest, track, NULL);
 
 		if (priv->last_track)
 			g_object_unref (priv->last_track);
@@ -354,6 +344,43 @@ brasero_session_span_next (BraseroSessionSpan *session)
 	return (pushed? BRASERO_BURN_RETRY:BRASERO_BURN_ERR);
 }
 
+/**
+ * Sets the next batch of data in @dest rather than in @session so that
+ * several volumes can be recorded at the same time, each with its own
+ * session and drive. The free space of the medium in the burner of @dest
+ * is used as the maximum amount of data.
+ * (used internally)
+ */
+
+BraseroBurnResult
+brasero_session_span_next_to_session (BraseroSessionSpan *session,
+				      BraseroBurnSession *dest)
+{
+	g_return_val_if_fail (BRASERO_IS_SESSION_SPAN (session), BRASERO_BURN_ERR);
+	g_return_val_if_fail (BRASERO_IS_BURN_SESSION (dest), BRASERO_BURN_ERR);
+
+	return brasero_session_span_next_real (session, dest);
+}
+
+/**
+ * brasero_session_span_next:
+ * @session: a #BraseroSessionSpan
+ *
+ * Sets the next batch of data to be burnt onto the medium inserted in the #BraseroDrive
+ * set for @session (see brasero_burn_session_set_burner ()). Its free space or it capacity
+ * will be used as the maximum amount of data to be burnt.
+ *
+ * Return value: a #BraseroBurnResult. BRASERO_BURN_OK if successful.
+ **/
+
+BraseroBurnResult
+brasero_session_span_next (BraseroSessionSpan *session)
+{
+	g_return_val_if_fail (BRASERO_IS_SESSION_SPAN (session), BRASERO_BURN_ERR);
+
+	return brasero_session_span_next_real (session, BRASERO_BURN_SESSION (session));
+}
+
 /**
  * brasero_session_span_stop:
  * @session: a #BraseroSessionSpan
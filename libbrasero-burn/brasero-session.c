@@ -50,6 +50,7 @@
 #include "burn-debug.h"
 #include "libbrasero-marshal.h"
 #include "burn-image-format.h"
+#include "burn-speed-profile.h"
 #include "brasero-track-type-private.h"
 
 #include "brasero-medium.h"
@@ -841,8 +842,16 @@ brasero_burn_session_get_rate (BraseroBurnSession *self)
 		return 0;
 
 	max_rate = brasero_medium_get_max_write_speed (medium);
-	if (priv->settings->rate <= 0)
+	if (priv->settings->rate <= 0) {
+		guint64 profile_rate;
+
+		/* Use what worked best for this kind of medium if known */
+		profile_rate = brasero_speed_profile_get_rate (medium);
+		if (profile_rate)
+			return MIN (max_rate, profile_rate);
+
 		return max_rate;
+	}
 	else
 		return MIN (max_rate, priv->settings->rate);
 }
@@ -1373,6 +1382,33 @@ brasero_burn_session_get_tmp_file (BraseroBurnSession *self,
 	return BRASERO_BURN_OK;
 }
 
+/**
+ * brasero_burn_session_add_tmp_file:
+ * @session: a #BraseroBurnSession
+ * @path: a #gchar
+ *
+ * Has @path removed along with the other temporary files once @session is
+ * finished. That is for files created next to a temporary file.
+ * This function is used internally and is not public API.
+ **/
+
+void
+brasero_burn_session_add_tmp_file (BraseroBurnSession *self,
+				   const gchar *path)
+{
+	BraseroBurnSessionPrivate *priv;
+
+	g_return_if_fail (BRASERO_IS_BURN_SESSION (self));
+	g_return_if_fail (path != NULL);
+
+	priv = BRASERO_BURN_SESSION_PRIVATE (self);
+
+	if (g_slist_find_custom (priv->tmpfiles, path, (GCompareFunc) strcmp))
+		return;
+
+	priv->tmpfiles = g_slist_prepend (priv->tmpfiles, g_strdup (path));
+}
+
 static gchar *
 brasero_burn_session_get_image_complement (BraseroBurnSession *self,
 					   BraseroImageFormat format,
@@ -48,6 +48,13 @@ G_BEGIN_DECLS
 
 #define BRASERO_TRACK_MEDIUM_WRONG_CHECKSUM_TAG		"track::medium::error::checksum::list"
 
+/**
+ * Number of blocks of the medium that could not be read and were replaced by
+ * zeros in an image (G_TYPE_INT)
+ */
+
+#define BRASERO_TRACK_MEDIUM_UNREADABLE_BLOCKS_TAG	"track::medium::error::unreadable::blocks"
+
 /**
  * Strings
  */
@@ -119,6 +126,13 @@ enum {
 };
 #define BRASERO_VIDEO_OUTPUT_ASPECT		"session::video::aspect"
 
+/**
+ * When an image has to be created before being burnt, start recording once
+ * that many MiB of the image are on disk (0 to wait for the image). When it is
+ * unset, the "follow-image-lead" key of org.gnome.brasero.config is used.
+ */
+#define BRASERO_SESSION_FOLLOW_LEAD		"session::follow::lead"		/* Int */
+
 G_END_DECLS
 
 #endif
@@ -75,6 +75,10 @@ struct _BraseroTrackDataCfgPrivate
 	guint loading_remaining;
 	GSList *load_errors;
 
+	/* snapshot to try before exploring the grafts (see set_source) */
+	gchar *snapshot;
+	gchar *snapshot_project;
+
 	GtkIconTheme *theme;
 
 	GSList *shown;
@@ -83,6 +87,7 @@ struct _BraseroTrackDataCfgPrivate
 	GtkSortType sort_type;
 
 	guint joliet_rename:1;
+	guint snapshot_loaded:1;
 
 	guint deep_directory:1;
 	guint G2_files:1;
@@ -535,10 +540,11 @@ brasero_track_data_cfg_node_shown (GtkTreeModel *model,
 		/* in this case have vfs to increase priority for this node */
 		brasero_data_vfs_require_node_load (BRASERO_DATA_VFS (priv->tree), node);
 	}
-	else if (!BRASERO_FILE_NODE_MIME (node)) {
+	else if (!BRASERO_FILE_NODE_MIME (node) || node->is_mime_guessed) {
 		/* that means that file wasn't completly loaded. To save
 		 * some time we delayed the detection of the mime type
-		 * since that takes a lot of time. */
+		 * since that takes a lot of time. Until then the type
+		 * guessed from the name is displayed. */
 		brasero_data_vfs_load_mime (BRASERO_DATA_VFS (priv->tree), node);
 	}
 
@@ -756,9 +762,14 @@ brasero_track_data_cfg_get_value (GtkTreeModel *model,
 			const gchar *icon_string = "text-x-preview";
 			GIcon *icon;
 
+			/* The theme is looked up the first time it is needed as
+			 * there is none for clients without display */
+			if (!priv->theme && gdk_screen_get_default ())
+				priv->theme = gtk_icon_theme_get_default ();
+
 			/* NOTE: implemented in glib 2.15.6 (not for windows though) */
 			icon = g_content_type_get_icon (BRASERO_FILE_NODE_MIME (node));
-			if (G_IS_THEMED_ICON (icon)) {
+			if (priv->theme && G_IS_THEMED_ICON (icon)) {
 				const gchar * const *names = NULL;
 
 				names = g_themed_icon_get_names (G_THEMED_ICON (icon));
@@ -1500,11 +1511,13 @@ brasero_track_data_cfg_node_added (BraseroDataProject *project,
 	parent = node->parent;
 	if (!parent->is_root) {
 		/* Tell the tree that the parent changed (since the number of children
-		 * changed as well). */
+		 * changed as well). When a whole directory is added at once this
+		 * is done only once at the end of the batch. */
 		iter.user_data = parent;
 		path = brasero_track_data_cfg_node_to_path (self, parent);
 
-		gtk_tree_model_row_changed (GTK_TREE_MODEL (self), path, &iter);
+		if (!brasero_data_project_is_adding_batch (project))
+			gtk_tree_model_row_changed (GTK_TREE_MODEL (self), path, &iter);
 
 		/* Check if the parent of this node is empty if so remove the BOGUS row.
 		 * Do it afterwards to prevent the parent row to be collapsed if it was
@@ -2230,6 +2243,241 @@ brasero_track_data_cfg_get_available_media (BraseroTrackDataCfg *track)
 	return brasero_data_session_get_available_media (BRASERO_DATA_SESSION (priv->tree));
 }
 
+/**
+ * brasero_track_data_cfg_set_snapshot:
+ * @track: a #BraseroTrackDataCfg
+ * @path: a #gchar
+ * @project_path: a #gchar
+ *
+ * Sets the path of a snapshot saved with brasero_track_data_cfg_save_snapshot () for the
+ * project file @project_path. When the contents are set with brasero_track_data_set_source ()
+ * the tree is restored from the snapshot instead of exploring all the files, provided
+ * @project_path was not modified since the snapshot was saved. The files are then checked
+ * for changes in the background.
+ *
+ **/
+
+void
+brasero_track_data_cfg_set_snapshot (BraseroTrackDataCfg *track,
+				     const gchar *path,
+				     const gchar *project_path)
+{
+	BraseroTrackDataCfgPrivate *priv;
+
+	g_return_if_fail (BRASERO_TRACK_DATA_CFG (track));
+	priv = BRASERO_TRACK_DATA_CFG_PRIVATE (track);
+
+	g_free (priv->snapshot);
+	priv->snapshot = g_strdup (path);
+
+	g_free (priv->snapshot_project);
+	priv->snapshot_project = g_strdup (project_path);
+}
+
+/**
+ * brasero_track_data_cfg_save_snapshot:
+ * @track: a #BraseroTrackDataCfg
+ * @path: a #gchar
+ * @project_path: a #gchar
+ * @error: a #GError
+ *
+ * Saves a snapshot of the whole tree to @path. It is bound to the project file @project_path
+ * which must have been saved already.
+ * Errors are stored in @error.
+ *
+ * Return value: a #gboolean. TRUE if the operation was successful, FALSE otherwise
+ **/
+
+gboolean
+brasero_track_data_cfg_save_snapshot (BraseroTrackDataCfg *track,
+				      const gchar *path,
+				      const gchar *project_path,
+				      GError **error)
+{
+	BraseroTrackDataCfgPrivate *priv;
+
+	g_return_val_if_fail (BRASERO_TRACK_DATA_CFG (track), FALSE);
+	priv = BRASERO_TRACK_DATA_CFG_PRIVATE (track);
+
+	if (brasero_data_vfs_is_active (BRASERO_DATA_VFS (priv->tree))) {
+		g_set_error (error,
+			     BRASERO_BURN_ERROR,
+			     BRASERO_BURN_ERROR_GENERAL,
+			     _("The project is still being loaded"));
+		return FALSE;
+	}
+
+	return brasero_data_project_save_snapshot (BRASERO_DATA_PROJECT (priv->tree),
+						   path,
+						   project_path,
+						   error);
+}
+
+static gboolean
+brasero_track_data_cfg_load_snapshot (BraseroTrackDataCfg *track,
+				      GSList *excluded)
+{
+	BraseroTrackDataCfgPrivate *priv;
+	gboolean result = FALSE;
+
+	priv = BRASERO_TRACK_DATA_CFG_PRIVATE (track);
+
+	if (priv->snapshot)
+		result = brasero_data_project_load_snapshot (BRASERO_DATA_PROJECT (priv->tree),
+							     priv->snapshot,
+							     priv->snapshot_project,
+							     excluded);
+
+	/* A snapshot is only used once */
+	g_free (priv->snapshot);
+	priv->snapshot = NULL;
+	g_free (priv->snapshot_project);
+	priv->snapshot_project = NULL;
+
+	return result;
+}
+
+/**
+ * brasero_track_data_cfg_load_begin:
+ * @track: a #BraseroTrackDataCfg
+ *
+ * Starts loading the contents of @track one graft at a time. It is an alternative to
+ * brasero_track_data_set_source () that doesn't require to build the lists of all the grafts
+ * and excluded URIs first. Call brasero_track_data_cfg_load_graft () and then
+ * brasero_track_data_cfg_load_excluded () for each of them and finish with brasero_track_data_cfg_load_end ().
+ *
+ **/
+
+void
+brasero_track_data_cfg_load_begin (BraseroTrackDataCfg *track)
+{
+	BraseroTrackDataCfgPrivate *priv;
+
+	g_return_if_fail (BRASERO_TRACK_DATA_CFG (track));
+	priv = BRASERO_TRACK_DATA_CFG_PRIVATE (track);
+
+	/* When the tree is restored from a snapshot the grafts are useless */
+	priv->snapshot_loaded = brasero_track_data_cfg_load_snapshot (track, NULL);
+	if (!priv->snapshot_loaded)
+		brasero_data_project_load_contents_begin (BRASERO_DATA_PROJECT (priv->tree));
+}
+
+/**
+ * brasero_track_data_cfg_load_graft:
+ * @track: a #BraseroTrackDataCfg
+ * @path: a #gchar
+ * @uri: a #gchar or NULL for a created directory
+ *
+ * Adds the graft point @uri at @path while loading the contents of @track.
+ * See brasero_track_data_cfg_load_begin ().
+ *
+ **/
+
+void
+brasero_track_data_cfg_load_graft (BraseroTrackDataCfg *track,
+				   const gchar *path,
+				   const gchar *uri)
+{
+	BraseroTrackDataCfgPrivate *priv;
+
+	g_return_if_fail (BRASERO_TRACK_DATA_CFG (track));
+	priv = BRASERO_TRACK_DATA_CFG_PRIVATE (track);
+
+	if (priv->snapshot_loaded)
+		return;
+
+	brasero_data_project_load_contents_add_graft (BRASERO_DATA_PROJECT (priv->tree),
+						      path,
+						      uri);
+}
+
+/**
+ * brasero_track_data_cfg_load_excluded:
+ * @track: a #BraseroTrackDataCfg
+ * @uri: a #gchar
+ *
+ * Excludes @uri while loading the contents of @track. It must be called once all the
+ * grafts were added. See brasero_track_data_cfg_load_begin ().
+ *
+ **/
+
+void
+brasero_track_data_cfg_load_excluded (BraseroTrackDataCfg *track,
+				      const gchar *uri)
+{
+	BraseroTrackDataCfgPrivate *priv;
+
+	g_return_if_fail (BRASERO_TRACK_DATA_CFG (track));
+	priv = BRASERO_TRACK_DATA_CFG_PRIVATE (track);
+
+	brasero_data_project_load_contents_add_excluded (BRASERO_DATA_PROJECT (priv->tree), uri);
+}
+
+/**
+ * brasero_track_data_cfg_load_end:
+ * @track: a #BraseroTrackDataCfg
+ *
+ * Finishes loading the contents of @track. See brasero_track_data_cfg_load_begin ().
+ *
+ * Return value: a #BraseroBurnResult. BRASERO_BURN_OK if all the files are loaded,
+ * BRASERO_BURN_NOT_READY if some of them are still being loaded.
+ **/
+
+BraseroBurnResult
+brasero_track_data_cfg_load_end (BraseroTrackDataCfg *track)
+{
+	BraseroTrackDataCfgPrivate *priv;
+
+	g_return_val_if_fail (BRASERO_TRACK_DATA_CFG (track), BRASERO_BURN_ERR);
+	priv = BRASERO_TRACK_DATA_CFG_PRIVATE (track);
+
+	if (priv->snapshot_loaded)
+		priv->loading = 0;
+	else
+		priv->loading = brasero_data_project_load_contents_end (BRASERO_DATA_PROJECT (priv->tree));
+
+	priv->snapshot_loaded = FALSE;
+
+	if (!priv->loading)
+		return BRASERO_BURN_OK;
+
+	return BRASERO_BURN_NOT_READY;
+}
+
+/**
+ * brasero_track_data_cfg_foreach_graft:
+ * @track: a #BraseroTrackDataCfg
+ * @graft_func: a #BraseroTrackDataCfgGraftFunc
+ * @excluded_func: a #BraseroTrackDataCfgExcludedFunc
+ * @user_data: a #gpointer
+ *
+ * Calls @graft_func for each graft point of @track as the tree is walked and then
+ * @excluded_func for each excluded URI. These are what is needed to load @track
+ * again with brasero_track_data_cfg_load_begin (). No list is built so memory use
+ * doesn't depend on the number of grafts. If a function returns FALSE, it stops.
+ *
+ * Return value: a #gboolean. FALSE if it was stopped.
+ **/
+
+gboolean
+brasero_track_data_cfg_foreach_graft (BraseroTrackDataCfg *track,
+				      BraseroTrackDataCfgGraftFunc graft_func,
+				      BraseroTrackDataCfgExcludedFunc excluded_func,
+				      gpointer user_data)
+{
+	BraseroTrackDataCfgPrivate *priv;
+
+	g_return_val_if_fail (BRASERO_TRACK_DATA_CFG (track), FALSE);
+	g_return_val_if_fail (graft_func != NULL, FALSE);
+	g_return_val_if_fail (excluded_func != NULL, FALSE);
+
+	priv = BRASERO_TRACK_DATA_CFG_PRIVATE (track);
+	return brasero_data_project_foreach_graft (BRASERO_DATA_PROJECT (priv->tree),
+						   graft_func,
+						   excluded_func,
+						   user_data);
+}
+
 static BraseroBurnResult
 brasero_track_data_cfg_set_source (BraseroTrackData *track,
 				   GSList *grafts,
@@ -2241,9 +2489,12 @@ brasero_track_data_cfg_set_source (BraseroTrackData *track,
 	if (!grafts)
 		return BRASERO_BURN_ERR;
 
-	priv->loading = brasero_data_project_load_contents (BRASERO_DATA_PROJECT (priv->tree),
-							    grafts,
-							    excluded);
+	if (brasero_track_data_cfg_load_snapshot (BRASERO_TRACK_DATA_CFG (track), excluded))
+		priv->loading = 0;
+	else
+		priv->loading = brasero_data_project_load_contents (BRASERO_DATA_PROJECT (priv->tree),
+								    grafts,
+								    excluded);
 
 	/* Remember that we own the list grafts and excluded
 	 * so we have to free them ourselves. */
@@ -3297,7 +3548,6 @@ brasero_track_data_cfg_init (BraseroTrackDataCfg *object)
 		priv->stamp = g_random_int ();
 	} while (!priv->stamp);
 
-	priv->theme = gtk_icon_theme_get_default ();
 	priv->tree = brasero_data_tree_model_new ();
 
 	g_signal_connect (priv->tree,
@@ -3392,6 +3642,16 @@ brasero_track_data_cfg_finalize (GObject *object)
 		priv->shown = NULL;
 	}
 
+	if (priv->snapshot) {
+		g_free (priv->snapshot);
+		priv->snapshot = NULL;
+	}
+
+	if (priv->snapshot_project) {
+		g_free (priv->snapshot_project);
+		priv->snapshot_project = NULL;
+	}
+
 	if (priv->tree) {
 		/* This object could outlive us just for some time
 		 * so we better remove all signals.
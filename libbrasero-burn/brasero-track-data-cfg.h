@@ -149,6 +149,44 @@ GtkTreeModel *
 brasero_track_data_cfg_get_filtered_model (BraseroTrackDataCfg *track);
 
 
+void
+brasero_track_data_cfg_set_snapshot (BraseroTrackDataCfg *track,
+				     const gchar *path,
+				     const gchar *project_path);
+
+gboolean
+brasero_track_data_cfg_save_snapshot (BraseroTrackDataCfg *track,
+				      const gchar *path,
+				      const gchar *project_path,
+				      GError **error);
+
+void
+brasero_track_data_cfg_load_begin (BraseroTrackDataCfg *track);
+
+void
+brasero_track_data_cfg_load_graft (BraseroTrackDataCfg *track,
+				   const gchar *path,
+				   const gchar *uri);
+
+void
+brasero_track_data_cfg_load_excluded (BraseroTrackDataCfg *track,
+				      const gchar *uri);
+
+BraseroBurnResult
+brasero_track_data_cfg_load_end (BraseroTrackDataCfg *track);
+
+typedef gboolean	(*BraseroTrackDataCfgGraftFunc)		(const gchar *path,
+								 const gchar *uri,
+								 gpointer user_data);
+typedef gboolean	(*BraseroTrackDataCfgExcludedFunc)	(const gchar *uri,
+								 gpointer user_data);
+
+gboolean
+brasero_track_data_cfg_foreach_graft (BraseroTrackDataCfg *track,
+				      BraseroTrackDataCfgGraftFunc graft_func,
+				      BraseroTrackDataCfgExcludedFunc excluded_func,
+				      gpointer user_data);
+
 /**
  * Track Spanning
  */
@@ -537,21 +537,23 @@ brasero_track_data_get_excluded_real (BraseroTrackData *track)
 }
 
 /**
- * brasero_track_data_write_to_paths:
+ * brasero_track_data_write_grafts:
  * @track: a #BraseroTrackData.
  * @grafts_path: a #gchar.
- * @excluded_path: a #gchar.
  * @emptydir: a #gchar.
  * @videodir: (allow-none): a #gchar or %NULL.
  * @error: a #GError.
  *
- * Write to @grafts_path (a path to a file) the graft points,
- * and to @excluded_path (a path to a file) the list of paths to
- * be excluded; @emptydir is (path) is an empty
+ * Write to @grafts_path (a path to a file) the graft points;
+ * @emptydir is (path) is an empty
  * directory to be used for created directories;
  * @videodir (a path) is a directory to be used to build the
  * the video image.
  *
+ * Directories holding excluded files are expanded into their
+ * remaining contents so that the graft points do not need any
+ * exclusion list.
+ *
  * This is mostly for internal use by mkisofs and similar.
  *
  * This function takes care of file name mangling.
@@ -560,12 +562,11 @@ brasero_track_data_get_excluded_real (BraseroTrackData *track)
  **/
 
 BraseroBurnResult
-brasero_track_data_write_to_paths (BraseroTrackData *track,
-                                   const gchar *grafts_path,
-                                   const gchar *excluded_path,
-                                   const gchar *emptydir,
-                                   const gchar *videodir,
-                                   GError **error)
+brasero_track_data_write_grafts (BraseroTrackData *track,
+                                 const gchar *grafts_path,
+                                 const gchar *emptydir,
+                                 const gchar *videodir,
+                                 GError **error)
 {
 	GSList *grafts;
 	GSList *excluded;
@@ -584,11 +585,42 @@ brasero_track_data_write_to_paths (BraseroTrackData *track,
 						      emptydir,
 						      videodir,
 						      grafts_path,
-						      excluded_path,
 						      error);
 	return result;
 }
 
+/**
+ * brasero_track_data_write_to_paths:
+ * @track: a #BraseroTrackData.
+ * @grafts_path: a #gchar.
+ * @excluded_path: (allow-none): a #gchar or %NULL.
+ * @emptydir: a #gchar.
+ * @videodir: (allow-none): a #gchar or %NULL.
+ * @error: a #GError.
+ *
+ * Same as brasero_track_data_write_grafts (); nothing is written to
+ * @excluded_path since the graft points do not need any exclusion list.
+ *
+ * Return value: a #BraseroBurnResult.
+ *
+ * Deprecated: 3.12.4: Use brasero_track_data_write_grafts () instead.
+ **/
+
+BraseroBurnResult
+brasero_track_data_write_to_paths (BraseroTrackData *track,
+                                   const gchar *grafts_path,
+                                   const gchar *excluded_path,
+                                   const gchar *emptydir,
+                                   const gchar *videodir,
+                                   GError **error)
+{
+	return brasero_track_data_write_grafts (track,
+						grafts_path,
+						emptydir,
+						videodir,
+						error);
+}
+
 /**
  * brasero_track_data_get_file_num:
  * @track: a #BraseroTrackData.
@@ -134,6 +134,14 @@ brasero_track_data_get_grafts (BraseroTrackData *track);
 GSList *
 brasero_track_data_get_excluded_list (BraseroTrackData *track);
 
+BraseroBurnResult
+brasero_track_data_write_grafts (BraseroTrackData *track,
+                                 const gchar *grafts_path,
+                                 const gchar *emptydir,
+                                 const gchar *videodir,
+                                 GError **error);
+
+G_GNUC_DEPRECATED_FOR (brasero_track_data_write_grafts)
 BraseroBurnResult
 brasero_track_data_write_to_paths (BraseroTrackData *track,
                                    const gchar *grafts_path,
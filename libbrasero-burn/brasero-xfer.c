@@ -44,14 +44,69 @@
 #include "brasero-xfer.h"
 #include "burn-debug.h"
 
+/* Size of the chunks when files are copied by the scheduler */
+#define BRASERO_XFER_BUFFER_SIZE		65536
+
+/* Number of times an interrupted transfer is resumed before giving up */
+#define BRASERO_XFER_MAX_RETRIES		3
+
+#define BRASERO_XFER_DIR_ATTRIBUTES				\
+	G_FILE_ATTRIBUTE_STANDARD_TYPE ","			\
+	G_FILE_ATTRIBUTE_STANDARD_NAME ","			\
+	G_FILE_ATTRIBUTE_STANDARD_SIZE ","			\
+	BRASERO_XFER_LOOP_ATTRIBUTES
+
+typedef struct _BraseroXferItem BraseroXferItem;
+struct _BraseroXferItem {
+	GFile *src;
+	GFile *dest;
+
+	/* scheme and authority of the URI; used to limit the number of
+	 * concurrent transfers from the same server */
+	gchar *host;
+
+	/* G_FILE_TYPE_UNKNOWN until queried */
+	GFileType type;
+	goffset size;
+
+	/* number of parent directories */
+	guint depth;
+};
+
 /* FIXME! one way to improve this would be to add auto mounting */
 struct _BraseroXferCtx {
+	GMutex *lock;
+
 	goffset total_size;
 
 	goffset bytes_copied;
 	goffset current_bytes_copied;
+
+	/* Used by the scheduler (see brasero_xfer_run ()) */
+	GCond *cond;
+	GQueue *pending;
+	GHashTable *hosts;
+
+	/* ids of the directories explored so far */
+	GHashTable *visited;
+
+	guint active;
+	guint host_streams;
+
+	GCancellable *abort;
+	GError *error;
 };
 
+static void
+brasero_xfer_reset_progress (BraseroXferCtx *ctx)
+{
+	g_mutex_lock (ctx->lock);
+	ctx->total_size = 0;
+	ctx->bytes_copied = 0;
+	ctx->current_bytes_copied = 0;
+	g_mutex_unlock (ctx->lock);
+}
+
 static void
 brasero_xfer_progress_cb (goffset current_num_bytes,
 			  goffset total_num_bytes,
@@ -61,6 +116,52 @@ brasero_xfer_progress_cb (goffset current_num_bytes,
 	ctx->current_bytes_copied = current_num_bytes;
 }
 
+/**
+ * Directories are followed through symlinks like the local files are. Returns
+ * TRUE if the directory described by @info (a child of @parent at @depth) was
+ * already explored (ids are added to @visited, a set of strings owned by the
+ * table), is a symlink to one of its parents for backends without file ids or
+ * is deeper than BRASERO_XFER_MAX_DEPTH. @info must have the attributes in
+ * BRASERO_XFER_LOOP_ATTRIBUTES. @parent is NULL for the top directory.
+ */
+
+gboolean
+brasero_xfer_dir_is_loop (GHashTable *visited,
+			  GFile *parent,
+			  GFileInfo *info,
+			  guint depth)
+{
+	const gchar *target;
+	gboolean loop;
+	const gchar *id;
+	GFile *file;
+
+	if (depth > BRASERO_XFER_MAX_DEPTH)
+		return TRUE;
+
+	id = g_file_info_get_attribute_string (info, G_FILE_ATTRIBUTE_ID_FILE);
+	if (id) {
+		if (g_hash_table_lookup (visited, id))
+			return TRUE;
+
+		g_hash_table_insert (visited, g_strdup (id), GINT_TO_POINTER (1));
+		return FALSE;
+	}
+
+	if (!parent || !g_file_info_get_is_symlink (info))
+		return FALSE;
+
+	target = g_file_info_get_symlink_target (info);
+	if (!target)
+		return FALSE;
+
+	file = g_file_resolve_relative_path (parent, target);
+	loop = (g_file_equal (file, parent) || g_file_has_prefix (parent, file));
+	g_object_unref (file);
+
+	return loop;
+}
+
 static gboolean
 brasero_xfer_file_transfer (BraseroXferCtx *ctx,
 			    GFile *src,
@@ -88,8 +189,10 @@ brasero_xfer_file_transfer (BraseroXferCtx *ctx,
 
 static gboolean
 brasero_xfer_recursive_transfer (BraseroXferCtx *ctx,
+				 GHashTable *visited,
 				 GFile *src,
 				 GFile *dest,
+				 guint depth,
 				 GCancellable *cancel,
 				 GError **error)
 {
@@ -99,9 +202,7 @@ brasero_xfer_recursive_transfer (BraseroXferCtx *ctx,
 
 	BRASERO_BURN_LOG ("Downloading directory contents");
 	enumerator = g_file_enumerate_children (src,
-						G_FILE_ATTRIBUTE_STANDARD_TYPE ","
-						G_FILE_ATTRIBUTE_STANDARD_NAME ","
-						G_FILE_ATTRIBUTE_STANDARD_SIZE,
+						BRASERO_XFER_DIR_ATTRIBUTES,
 						G_FILE_QUERY_INFO_NONE,	/* follow symlinks */
 						cancel,
 						error);
@@ -115,7 +216,11 @@ brasero_xfer_recursive_transfer (BraseroXferCtx *ctx,
 		src_child = g_file_get_child (src, g_file_info_get_name (info));
 		dest_child = g_file_get_child (dest, g_file_info_get_name (info));
 
-		if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY) {
+		if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY
+		&&  brasero_xfer_dir_is_loop (visited, src, info, depth + 1)) {
+			BRASERO_BURN_LOG ("Skipping directory loop %s", g_file_info_get_name (info));
+		}
+		else if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY) {
 			gchar *path;
 
 			path = g_file_get_path (dest_child);
@@ -133,8 +238,10 @@ brasero_xfer_recursive_transfer (BraseroXferCtx *ctx,
 			}
 			else {
 				result = brasero_xfer_recursive_transfer (ctx,
+									  visited,
 									  src_child,
 									  dest_child,
+									  depth + 1,
 									  cancel,
 									  error);
 			}
@@ -169,7 +276,9 @@ brasero_xfer_recursive_transfer (BraseroXferCtx *ctx,
 
 static gboolean
 brasero_xfer_get_download_size (BraseroXferCtx *ctx,
+				GHashTable *visited,
 				GFile *src,
+				guint depth,
 				GCancellable *cancel,
 				GError **error)
 {
@@ -177,9 +286,7 @@ brasero_xfer_get_download_size (BraseroXferCtx *ctx,
 	GFileInfo *info;
 
 	enumerator = g_file_enumerate_children (src,
-						G_FILE_ATTRIBUTE_STANDARD_TYPE ","
-						G_FILE_ATTRIBUTE_STANDARD_NAME ","
-						G_FILE_ATTRIBUTE_STANDARD_SIZE,
+						BRASERO_XFER_DIR_ATTRIBUTES,
 						G_FILE_QUERY_INFO_NONE,	/* follow symlinks */
 						cancel,
 						error);
@@ -189,10 +296,12 @@ brasero_xfer_get_download_size (BraseroXferCtx *ctx,
 	while ((info = g_file_enumerator_next_file (enumerator, cancel, error))) {
 		if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY) {
 			GFile *child;
-	
-			child = g_file_get_child (src, g_file_info_get_name (info));
-			brasero_xfer_get_download_size (ctx, child, cancel, error);
-			g_object_unref (child);
+
+			if (!brasero_xfer_dir_is_loop (visited, src, info, depth + 1)) {
+				child = g_file_get_child (src, g_file_info_get_name (info));
+				brasero_xfer_get_download_size (ctx, visited, child, depth + 1, cancel, error);
+				g_object_unref (child);
+			}
 		}
 		else
 			ctx->total_size += g_file_info_get_size (info);
@@ -216,15 +325,15 @@ brasero_xfer_start (BraseroXferCtx *ctx,
 		    GCancellable *cancel,
 		    GError **error)
 {
+	GHashTable *visited;
 	gboolean result;
 	GFileInfo *info;
 
-	bzero (ctx, sizeof (BraseroXferCtx));
+	brasero_xfer_reset_progress (ctx);
 
 	/* First step: get all the total size of what we have to move */
 	info = g_file_query_info (src,
-				  G_FILE_ATTRIBUTE_STANDARD_TYPE ","
-				  G_FILE_ATTRIBUTE_STANDARD_SIZE,
+				  BRASERO_XFER_DIR_ATTRIBUTES,
 				  G_FILE_QUERY_INFO_NONE, /* follow symlinks */
 				  cancel,
 				  error);
@@ -240,7 +349,11 @@ brasero_xfer_start (BraseroXferCtx *ctx,
 		ctx->total_size = g_file_info_get_size (info);
 	}
 	else {
-		brasero_xfer_get_download_size (ctx, src, cancel, error);
+		visited = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+		brasero_xfer_dir_is_loop (visited, NULL, info, 0);
+		brasero_xfer_get_download_size (ctx, visited, src, 0, cancel, error);
+		g_hash_table_destroy (visited);
+
 		BRASERO_BURN_LOG ("Downloading directory (size = %lli)", ctx->total_size);
 	}
 
@@ -271,7 +384,10 @@ brasero_xfer_start (BraseroXferCtx *ctx,
 		BRASERO_BURN_LOG ("Created directory %s", dest_path);
 		g_free (dest_path);
 
-		result = brasero_xfer_recursive_transfer (ctx, src, dest, cancel, error);
+		visited = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+		brasero_xfer_dir_is_loop (visited, NULL, info, 0);
+		result = brasero_xfer_recursive_transfer (ctx, visited, src, dest, 0, cancel, error);
+		g_hash_table_destroy (visited);
 	}
 	else {
 		g_file_delete (dest, cancel, NULL);
@@ -304,7 +420,7 @@ struct _BraseroXferThreadData
 static gpointer
 brasero_xfer_thread (gpointer callback_data)
 {
-	BraseroXferThreadData *data = data;
+	BraseroXferThreadData *data = callback_data;
 	GError *error = NULL;
 
 	data->result = brasero_xfer_start (data->ctx,
@@ -343,7 +459,7 @@ brasero_xfer_wait (BraseroXferCtx *ctx,
 	gulong cancel_sig;
 	GThread *thread;
 
-	bzero (ctx, sizeof (BraseroXferCtx));
+	brasero_xfer_reset_progress (ctx);
 
 	cancel_sig = g_signal_connect (cancel,
 				       "cancelled",
@@ -412,12 +528,536 @@ brasero_xfer_wait (BraseroXferCtx *ctx,
 	return data.result;
 }
 
+/**
+ * Scheduler: files and directories added with brasero_xfer_add () are
+ * transferred by several threads at the same time. Directories are explored
+ * by the threads as well and their children queued.
+ */
+
+static gchar *
+brasero_xfer_get_host (GFile *file)
+{
+	const gchar *start;
+	const gchar *end;
+	gchar *host;
+	gchar *uri;
+
+	uri = g_file_get_uri (file);
+	start = strstr (uri, "://");
+	if (!start) {
+		g_free (uri);
+		return g_strdup ("");
+	}
+
+	end = strchr (start + 3, '/');
+	if (end)
+		host = g_strndup (uri, end - uri);
+	else
+		host = g_strdup (uri);
+
+	g_free (uri);
+	return host;
+}
+
+static BraseroXferItem *
+brasero_xfer_item_new (GFile *src,
+		       GFile *dest,
+		       const gchar *host)
+{
+	BraseroXferItem *item;
+
+	item = g_new0 (BraseroXferItem, 1);
+	item->src = g_object_ref (src);
+	item->dest = g_object_ref (dest);
+	item->type = G_FILE_TYPE_UNKNOWN;
+
+	if (host)
+		item->host = g_strdup (host);
+	else
+		item->host = brasero_xfer_get_host (src);
+
+	return item;
+}
+
+static void
+brasero_xfer_item_free (BraseroXferItem *item)
+{
+	g_object_unref (item->src);
+	g_object_unref (item->dest);
+	g_free (item->host);
+	g_free (item);
+}
+
+void
+brasero_xfer_add (BraseroXferCtx *ctx,
+		  GFile *src,
+		  GFile *dest)
+{
+	g_mutex_lock (ctx->lock);
+	g_queue_push_tail (ctx->pending, brasero_xfer_item_new (src, dest, NULL));
+	g_mutex_unlock (ctx->lock);
+}
+
+static void
+brasero_xfer_add_written (BraseroXferCtx *ctx,
+			  goffset written)
+{
+	g_mutex_lock (ctx->lock);
+	ctx->bytes_copied += written;
+	g_mutex_unlock (ctx->lock);
+}
+
+/**
+ * Errors after which it is worth trying to resume a transfer
+ */
+
+static gboolean
+brasero_xfer_error_is_transient (GError *error)
+{
+	if (error->domain != G_IO_ERROR)
+		return TRUE;
+
+	return (error->code != G_IO_ERROR_CANCELLED
+	&&      error->code != G_IO_ERROR_NOT_FOUND
+	&&      error->code != G_IO_ERROR_PERMISSION_DENIED
+	&&      error->code != G_IO_ERROR_NO_SPACE
+	&&      error->code != G_IO_ERROR_IS_DIRECTORY);
+}
+
+static gboolean
+brasero_xfer_item_copy_from (BraseroXferCtx *ctx,
+			     BraseroXferItem *item,
+			     goffset *offset,
+			     GError **error)
+{
+	GFileOutputStream *output;
+	GFileInputStream *input;
+	gboolean result = TRUE;
+	gchar *buffer;
+
+	input = g_file_read (item->src, ctx->abort, error);
+	if (!input)
+		return FALSE;
+
+	if (*offset
+	&& (!g_seekable_can_seek (G_SEEKABLE (input))
+	||  !g_seekable_seek (G_SEEKABLE (input), *offset, G_SEEK_SET, ctx->abort, NULL))) {
+		/* We have to start over */
+		BRASERO_BURN_LOG ("Transfer can't be resumed");
+		brasero_xfer_add_written (ctx, - (*offset));
+		*offset = 0;
+	}
+
+	if (*offset)
+		output = g_file_append_to (item->dest,
+					   G_FILE_CREATE_NONE,
+					   ctx->abort,
+					   error);
+	else
+		output = g_file_replace (item->dest,
+					 NULL,
+					 FALSE,
+					 G_FILE_CREATE_NONE,
+					 ctx->abort,
+					 error);
+	if (!output) {
+		g_object_unref (input);
+		return FALSE;
+	}
+
+	buffer = g_new (gchar, BRASERO_XFER_BUFFER_SIZE);
+	while (1) {
+		gsize written = 0;
+		gssize bytes;
+
+		bytes = g_input_stream_read (G_INPUT_STREAM (input),
+					     buffer,
+					     BRASERO_XFER_BUFFER_SIZE,
+					     ctx->abort,
+					     error);
+		if (bytes <= 0) {
+			result = (bytes == 0);
+			break;
+		}
+
+		result = g_output_stream_write_all (G_OUTPUT_STREAM (output),
+						    buffer,
+						    bytes,
+						    &written,
+						    ctx->abort,
+						    error);
+
+		*offset += written;
+		brasero_xfer_add_written (ctx, written);
+
+		if (!result)
+			break;
+	}
+	g_free (buffer);
+
+	g_input_stream_close (G_INPUT_STREAM (input), NULL, NULL);
+	g_object_unref (input);
+
+	if (!g_output_stream_close (G_OUTPUT_STREAM (output), ctx->abort, result? error:NULL))
+		result = FALSE;
+	g_object_unref (output);
+
+	return result;
+}
+
+static gboolean
+brasero_xfer_item_copy (BraseroXferCtx *ctx,
+			BraseroXferItem *item,
+			GError **error)
+{
+	goffset offset = 0;
+	guint retries = 0;
+
+	while (1) {
+		GError *copy_error = NULL;
+
+		if (brasero_xfer_item_copy_from (ctx, item, &offset, &copy_error))
+			break;
+
+		if (g_cancellable_is_cancelled (ctx->abort)
+		||  retries >= BRASERO_XFER_MAX_RETRIES
+		|| !brasero_xfer_error_is_transient (copy_error)) {
+			g_propagate_error (error, copy_error);
+			return FALSE;
+		}
+
+		retries ++;
+		BRASERO_BURN_LOG ("Transfer interrupted at %lli (%s); resuming",
+				  offset,
+				  copy_error->message);
+		g_error_free (copy_error);
+	}
+
+	/* Like g_file_copy () with G_FILE_COPY_ALL_METADATA */
+	g_file_copy_attributes (item->src,
+				item->dest,
+				G_FILE_COPY_ALL_METADATA,
+				ctx->abort,
+				NULL);
+	return TRUE;
+}
+
+static gboolean
+brasero_xfer_item_explore (BraseroXferCtx *ctx,
+			   BraseroXferItem *item,
+			   GError **error)
+{
+	GFileEnumerator *enumerator;
+	GFileInfo *info;
+	gchar *path;
+
+	path = g_file_get_path (item->dest);
+	BRASERO_BURN_LOG ("Creating directory %s", path);
+
+	/* remove the temporary file that may have been created */
+	g_remove (path);
+	if (g_mkdir_with_parents (path, S_IRWXU)) {
+		int errsv = errno;
+
+		g_free (path);
+		g_set_error (error,
+			     BRASERO_BURN_ERROR,
+			     BRASERO_BURN_ERROR_GENERAL,
+			     _("Directory could not be created (%s)"),
+			     g_strerror (errsv));
+		return FALSE;
+	}
+	g_free (path);
+
+	enumerator = g_file_enumerate_children (item->src,
+						BRASERO_XFER_DIR_ATTRIBUTES,
+						G_FILE_QUERY_INFO_NONE,	/* follow symlinks */
+						ctx->abort,
+						error);
+	if (!enumerator)
+		return FALSE;
+
+	while ((info = g_file_enumerator_next_file (enumerator, ctx->abort, error))) {
+		BraseroXferItem *child;
+		GFile *dest_child;
+		GFile *src_child;
+
+		g_mutex_lock (ctx->lock);
+		if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY
+		&&  brasero_xfer_dir_is_loop (ctx->visited, item->src, info, item->depth + 1)) {
+			g_mutex_unlock (ctx->lock);
+
+			BRASERO_BURN_LOG ("Skipping directory loop %s", g_file_info_get_name (info));
+			g_object_unref (info);
+			continue;
+		}
+		g_mutex_unlock (ctx->lock);
+
+		src_child = g_file_get_child (item->src, g_file_info_get_name (info));
+		dest_child = g_file_get_child (item->dest, g_file_info_get_name (info));
+
+		child = brasero_xfer_item_new (src_child, dest_child, item->host);
+		child->type = g_file_info_get_file_type (info);
+		child->depth = item->depth + 1;
+
+		g_object_unref (src_child);
+		g_object_unref (dest_child);
+
+		g_mutex_lock (ctx->lock);
+
+		/* Explore directories first so that the total size is known
+		 * as soon as possible */
+		if (child->type == G_FILE_TYPE_DIRECTORY)
+			g_queue_push_head (ctx->pending, child);
+		else {
+			child->size = g_file_info_get_size (info);
+			ctx->total_size += child->size;
+			g_queue_push_tail (ctx->pending, child);
+		}
+
+		g_cond_signal (ctx->cond);
+		g_mutex_unlock (ctx->lock);
+
+		g_object_unref (info);
+	}
+
+	g_file_enumerator_close (enumerator, NULL, NULL);
+	g_object_unref (enumerator);
+
+	return (error == NULL || *error == NULL);
+}
+
+static gboolean
+brasero_xfer_item_process (BraseroXferCtx *ctx,
+			   BraseroXferItem *item,
+			   GError **error)
+{
+	if (item->type == G_FILE_TYPE_UNKNOWN) {
+		GFileInfo *info;
+
+		info = g_file_query_info (item->src,
+					  BRASERO_XFER_DIR_ATTRIBUTES,
+					  G_FILE_QUERY_INFO_NONE, /* follow symlinks */
+					  ctx->abort,
+					  error);
+		if (!info)
+			return FALSE;
+
+		item->type = g_file_info_get_file_type (info);
+		if (item->type == G_FILE_TYPE_DIRECTORY) {
+			/* This one was added with brasero_xfer_add () */
+			g_mutex_lock (ctx->lock);
+			brasero_xfer_dir_is_loop (ctx->visited, NULL, info, 0);
+			g_mutex_unlock (ctx->lock);
+		}
+		else {
+			item->size = g_file_info_get_size (info);
+
+			g_mutex_lock (ctx->lock);
+			ctx->total_size += item->size;
+			g_mutex_unlock (ctx->lock);
+		}
+
+		g_object_unref (info);
+	}
+
+	if (item->type == G_FILE_TYPE_DIRECTORY)
+		return brasero_xfer_item_explore (ctx, item, error);
+
+	return brasero_xfer_item_copy (ctx, item, error);
+}
+
+/**
+ * Must be called with the lock held
+ */
+
+static BraseroXferItem *
+brasero_xfer_next_item (BraseroXferCtx *ctx)
+{
+	GList *iter;
+
+	for (iter = ctx->pending->head; iter; iter = iter->next) {
+		BraseroXferItem *item;
+		guint streams;
+
+		item = iter->data;
+		streams = GPOINTER_TO_UINT (g_hash_table_lookup (ctx->hosts, item->host));
+		if (streams >= ctx->host_streams)
+			continue;
+
+		g_hash_table_insert (ctx->hosts, g_strdup (item->host), GUINT_TO_POINTER (streams + 1));
+		g_queue_delete_link (ctx->pending, iter);
+		return item;
+	}
+
+	return NULL;
+}
+
+static gpointer
+brasero_xfer_worker (gpointer data)
+{
+	BraseroXferCtx *ctx = data;
+
+	g_mutex_lock (ctx->lock);
+	while (!ctx->error && !g_cancellable_is_cancelled (ctx->abort)) {
+		BraseroXferItem *item;
+		GError *error = NULL;
+		gboolean result;
+		guint streams;
+
+		item = brasero_xfer_next_item (ctx);
+		if (!item) {
+			/* Nothing else can be queued */
+			if (!ctx->active)
+				break;
+
+			g_cond_wait (ctx->cond, ctx->lock);
+			continue;
+		}
+
+		ctx->active ++;
+		g_mutex_unlock (ctx->lock);
+
+		result = brasero_xfer_item_process (ctx, item, &error);
+
+		g_mutex_lock (ctx->lock);
+		ctx->active --;
+
+		streams = GPOINTER_TO_UINT (g_hash_table_lookup (ctx->hosts, item->host));
+		g_hash_table_insert (ctx->hosts, g_strdup (item->host), GUINT_TO_POINTER (streams - 1));
+
+		if (!result) {
+			if (!ctx->error && !g_cancellable_is_cancelled (ctx->abort)) {
+				/* Stop all the other transfers */
+				ctx->error = error;
+				g_cancellable_cancel (ctx->abort);
+			}
+			else if (error)
+				g_error_free (error);
+		}
+
+		brasero_xfer_item_free (item);
+		g_cond_broadcast (ctx->cond);
+	}
+
+	/* wake up the others so they can stop as well */
+	g_cond_broadcast (ctx->cond);
+	g_mutex_unlock (ctx->lock);
+
+	return NULL;
+}
+
+static void
+brasero_xfer_cancelled_cb (GCancellable *cancel,
+			   BraseroXferCtx *ctx)
+{
+	g_cancellable_cancel (ctx->abort);
+
+	g_mutex_lock (ctx->lock);
+	g_cond_broadcast (ctx->cond);
+	g_mutex_unlock (ctx->lock);
+}
+
+/**
+ * Transfers everything added with brasero_xfer_add () using at most streams
+ * threads and no more than host_streams of them for the same server. It blocks
+ * until everything is transferred or an error occurs.
+ */
+
+gboolean
+brasero_xfer_run (BraseroXferCtx *ctx,
+		  guint streams,
+		  guint host_streams,
+		  GCancellable *cancel,
+		  GError **error)
+{
+	GThread **threads;
+	gulong cancel_sig = 0;
+	gboolean result;
+	guint started = 0;
+	guint i;
+
+	brasero_xfer_reset_progress (ctx);
+
+	streams = MAX (streams, 1);
+	ctx->host_streams = MAX (host_streams, 1);
+	ctx->abort = g_cancellable_new ();
+
+	if (cancel)
+		cancel_sig = g_cancellable_connect (cancel,
+						    G_CALLBACK (brasero_xfer_cancelled_cb),
+						    ctx,
+						    NULL);
+
+	BRASERO_BURN_LOG ("Downloading %i items with %i streams (%i per host)",
+			  g_queue_get_length (ctx->pending),
+			  streams,
+			  ctx->host_streams);
+
+	threads = g_new0 (GThread *, streams);
+	for (i = 0; i < streams; i ++) {
+		threads [i] = g_thread_create (brasero_xfer_worker,
+					       ctx,
+					       TRUE,
+					       started? NULL:error);
+
+		/* Go on with the threads that could be started */
+		if (!threads [i])
+			break;
+
+		started ++;
+	}
+
+	for (i = 0; i < started; i ++)
+		g_thread_join (threads [i]);
+
+	g_free (threads);
+
+	if (cancel)
+		g_cancellable_disconnect (cancel, cancel_sig);
+
+	g_object_unref (ctx->abort);
+	ctx->abort = NULL;
+
+	/* Remove what could not be transferred */
+	g_queue_foreach (ctx->pending, (GFunc) brasero_xfer_item_free, NULL);
+	g_queue_clear (ctx->pending);
+	g_hash_table_remove_all (ctx->hosts);
+	g_hash_table_remove_all (ctx->visited);
+
+	if (!started)
+		return FALSE;
+
+	result = TRUE;
+	if (ctx->error) {
+		BRASERO_BURN_LOG ("Error %s", ctx->error->message);
+		g_propagate_error (error, ctx->error);
+		ctx->error = NULL;
+		result = FALSE;
+	}
+	else if (cancel && g_cancellable_is_cancelled (cancel))
+		result = FALSE;
+
+	return result;
+}
+
 BraseroXferCtx *
 brasero_xfer_new (void)
 {
 	BraseroXferCtx *ctx;
 
 	ctx = g_new0 (BraseroXferCtx, 1);
+	ctx->lock = g_mutex_new ();
+	ctx->cond = g_cond_new ();
+	ctx->pending = g_queue_new ();
+	ctx->hosts = g_hash_table_new_full (g_str_hash,
+					    g_str_equal,
+					    g_free,
+					    NULL);
+	ctx->visited = g_hash_table_new_full (g_str_hash,
+					      g_str_equal,
+					      g_free,
+					      NULL);
 
 	return ctx;
 }
@@ -425,6 +1065,16 @@ brasero_xfer_new (void)
 void
 brasero_xfer_free (BraseroXferCtx *ctx)
 {
+	g_queue_foreach (ctx->pending, (GFunc) brasero_xfer_item_free, NULL);
+	g_queue_free (ctx->pending);
+	g_hash_table_destroy (ctx->hosts);
+	g_hash_table_destroy (ctx->visited);
+
+	if (ctx->error)
+		g_error_free (ctx->error);
+
+	g_mutex_free (ctx->lock);
+	g_cond_free (ctx->cond);
 	g_free (ctx);
 }
 
@@ -433,11 +1083,14 @@ brasero_xfer_get_progress (BraseroXferCtx *ctx,
 			   goffset *written,
 			   goffset *total)
 {
+	g_mutex_lock (ctx->lock);
+
 	if (written)
 		*written = ctx->current_bytes_copied + ctx->bytes_copied;
 
 	if (total)
 		*total = ctx->total_size;
 
+	g_mutex_unlock (ctx->lock);
 	return TRUE;
 }
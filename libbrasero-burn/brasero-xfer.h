@@ -38,6 +38,22 @@ G_BEGIN_DECLS
 
 typedef struct _BraseroXferCtx BraseroXferCtx;
 
+/* Directories deeper than that are not walked; this stops symlink loops
+ * that could not be detected otherwise (see brasero_xfer_dir_is_loop ()) */
+#define BRASERO_XFER_MAX_DEPTH			256
+
+/* What brasero_xfer_dir_is_loop () needs to know about a directory */
+#define BRASERO_XFER_LOOP_ATTRIBUTES				\
+	G_FILE_ATTRIBUTE_STANDARD_IS_SYMLINK ","		\
+	G_FILE_ATTRIBUTE_STANDARD_SYMLINK_TARGET ","		\
+	G_FILE_ATTRIBUTE_ID_FILE
+
+gboolean
+brasero_xfer_dir_is_loop (GHashTable *visited,
+			  GFile *parent,
+			  GFileInfo *info,
+			  guint depth);
+
 BraseroXferCtx *
 brasero_xfer_new (void);
 
@@ -58,6 +74,18 @@ brasero_xfer_wait (BraseroXferCtx *ctx,
 		   GCancellable *cancel,
 		   GError **error);
 
+void
+brasero_xfer_add (BraseroXferCtx *ctx,
+		  GFile *src,
+		  GFile *dest);
+
+gboolean
+brasero_xfer_run (BraseroXferCtx *ctx,
+		  guint streams,
+		  guint host_streams,
+		  GCancellable *cancel,
+		  GError **error);
+
 gboolean
 brasero_xfer_get_progress (BraseroXferCtx *ctx,
 			   goffset *written,
@@ -196,6 +196,80 @@ brasero_string_get_uri (const gchar *uri)
 	return uri_return;
 }
 
+/**
+ * Operations run in the main context that is the default for their thread.
+ * That's the global default one except for the burns run on their own
+ * thread when recording to several drives at once. Jobs and tasks must not
+ * use g_idle_add () and friends which always attach to the global one.
+ */
+
+GMainContext *
+brasero_burn_context_get_current (void)
+{
+	GMainContext *context;
+
+	context = g_main_context_get_thread_default ();
+	if (!context)
+		context = g_main_context_default ();
+
+	return context;
+}
+
+guint
+brasero_burn_source_attach (GMainContext *context,
+			    GSource *source,
+			    GSourceFunc function,
+			    gpointer data)
+{
+	guint id;
+
+	if (!context)
+		context = brasero_burn_context_get_current ();
+
+	g_source_set_callback (source, function, data, NULL);
+	id = g_source_attach (source, context);
+	g_source_unref (source);
+
+	return id;
+}
+
+guint
+brasero_burn_idle_add (GMainContext *context,
+		       GSourceFunc function,
+		       gpointer data)
+{
+	return brasero_burn_source_attach (context,
+					   g_idle_source_new (),
+					   function,
+					   data);
+}
+
+guint
+brasero_burn_timeout_add (GMainContext *context,
+			  guint interval,
+			  GSourceFunc function,
+			  gpointer data)
+{
+	return brasero_burn_source_attach (context,
+					   g_timeout_source_new (interval),
+					   function,
+					   data);
+}
+
+void
+brasero_burn_source_remove (GMainContext *context,
+			    guint id)
+{
+	GSource *source;
+
+	if (!context)
+		context = brasero_burn_context_get_current ();
+
+	source = g_main_context_find_source_by_id (context, id);
+	if (source)
+		g_source_destroy (source);
+}
+
 static void
 brasero_caps_list_dump (void)
 {
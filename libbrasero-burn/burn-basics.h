@@ -47,6 +47,13 @@ G_BEGIN_DECLS
 
 #define BRASERO_BURN_FLAG_ALL 0xFFFF
 
+/* Nanoseconds of the modification time of a struct stat when available */
+#ifdef HAVE_STRUCT_STAT_ST_MTIM_TV_NSEC
+#define BRASERO_STAT_MTIME_NSEC(info)		((gint64) (info)->st_mtim.tv_nsec)
+#else
+#define BRASERO_STAT_MTIME_NSEC(info)		((gint64) 0)
+#endif
+
 const gchar *
 brasero_burn_action_to_string (BraseroBurnAction action);
 
@@ -60,6 +67,30 @@ gboolean
 brasero_check_flags_for_drive (BraseroDrive *drive,
 			       BraseroBurnFlag flags);
 
+GMainContext *
+brasero_burn_context_get_current (void);
+
+guint
+brasero_burn_source_attach (GMainContext *context,
+			    GSource *source,
+			    GSourceFunc function,
+			    gpointer data);
+
+guint
+brasero_burn_idle_add (GMainContext *context,
+		       GSourceFunc function,
+		       gpointer data);
+
+guint
+brasero_burn_timeout_add (GMainContext *context,
+			  guint interval,
+			  GSourceFunc function,
+			  gpointer data);
+
+void
+brasero_burn_source_remove (GMainContext *context,
+			    guint id);
+
 G_END_DECLS
 
 #endif /* _BURN_BASICS_H */
@@ -0,0 +1,694 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Libbrasero-burn
+ * Copyright (C) Philippe Rouquier 2005-2009 <bonfire-app@wanadoo.fr>
+ *
+ * Libbrasero-burn is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The Libbrasero-burn authors hereby grant permission for non-GPL compatible
+ * GStreamer plugins to be used and distributed together with GStreamer
+ * and Libbrasero-burn. This permission is above and beyond the permissions granted
+ * by the GPL license by which Libbrasero-burn is covered. If you modify this code
+ * you may extend this exception to your version of the code, but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version.
+ * 
+ * Libbrasero-burn is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <gio/gio.h>
+
+#include "burn-basics.h"
+#include "burn-debug.h"
+#include "burn-image-cache.h"
+
+#include "brasero-io.h"
+
+#include "brasero-session-helper.h"
+#include "brasero-track-data.h"
+#include "brasero-track-image.h"
+
+/**
+ * The image cache keeps the images created for data projects so that a later
+ * burn of the same unchanged project doesn't need to create it again. Each
+ * image is stored in the user cache directory under a key that is computed
+ * from the contents of the project and the properties of the image (label,
+ * filesystems). A small key file stored alongside holds its size, the last
+ * time it was used (for LRU eviction) and its checksum if any.
+ */
+
+#define BRASERO_SCHEMA_CONFIG			"org.gnome.brasero.config"
+#define BRASERO_PROPS_IMAGE_CACHE_SIZE		"image-cache-size"
+
+#define BRASERO_IMAGE_CACHE_GROUP		"Image"
+#define BRASERO_IMAGE_CACHE_SIZE_KEY		"Size"
+#define BRASERO_IMAGE_CACHE_LAST_USED_KEY	"LastUsed"
+#define BRASERO_IMAGE_CACHE_CHECKSUM_TYPE_KEY	"ChecksumType"
+#define BRASERO_IMAGE_CACHE_CHECKSUM_KEY	"Checksum"
+
+typedef struct _BraseroImageCacheEntry BraseroImageCacheEntry;
+struct _BraseroImageCacheEntry {
+	gchar *key;
+	goffset size;
+	gint64 last_used;
+};
+
+static gchar *
+brasero_image_cache_get_dir (void)
+{
+	return g_build_filename (g_get_user_cache_dir (),
+				 "brasero",
+				 "images",
+				 NULL);
+}
+
+static gchar *
+brasero_image_cache_get_path (const gchar *key,
+			      const gchar *suffix)
+{
+	gchar *directory;
+	gchar *filename;
+	gchar *path;
+
+	directory = brasero_image_cache_get_dir ();
+	filename = g_strconcat (key, suffix, NULL);
+	path = g_build_filename (directory, filename, NULL);
+	g_free (directory);
+	g_free (filename);
+
+	return path;
+}
+
+static goffset
+brasero_image_cache_get_max_size (void)
+{
+	GSettings *settings;
+	gint size;
+
+	/* The value is in MiB; 0 disables the cache */
+	settings = g_settings_new (BRASERO_SCHEMA_CONFIG);
+	size = g_settings_get_int (settings, BRASERO_PROPS_IMAGE_CACHE_SIZE);
+	g_object_unref (settings);
+
+	return (goffset) MAX (size, 0) * 1024 * 1024;
+}
+
+static void
+brasero_image_cache_remove (const gchar *key)
+{
+	gchar *path;
+
+	BRASERO_BURN_LOG ("Removing cached image %s", key);
+
+	path = brasero_image_cache_get_path (key, ".iso");
+	g_remove (path);
+	g_free (path);
+
+	path = brasero_image_cache_get_path (key, ".info");
+	g_remove (path);
+	g_free (path);
+}
+
+static void
+brasero_image_cache_save_info (GKeyFile *file,
+			       const gchar *path)
+{
+	gchar *data;
+	gsize size;
+
+	data = g_key_file_to_data (file, &size, NULL);
+	if (!g_file_set_contents (path, data, size, NULL))
+		BRASERO_BURN_LOG ("Impossible to save %s", path);
+
+	g_free (data);
+}
+
+/**
+ * Computation of the key. All the files of the project are stat'ed which can
+ * take a while so it is done in the thread of BraseroIO (the one used by data
+ * projects to explore their files) while the caller keeps its main context
+ * running.
+ */
+
+typedef struct _BraseroImageCacheKeyData BraseroImageCacheKeyData;
+struct _BraseroImageCacheKeyData {
+	BraseroIOJob job;
+
+	GChecksum *checksum;
+	GSList *grafts;
+	GHashTable *excluded;
+
+	/* Directories being walked to detect symlink loops */
+	GHashTable *ancestors;
+
+	GMainContext *context;
+	gboolean success;
+	gboolean done;
+};
+
+static void
+brasero_image_cache_hash_stat (GChecksum *checksum,
+			       const gchar *path,
+			       struct stat *info)
+{
+	gchar *line;
+
+	line = g_strdup_printf ("%s\t%o\t%"G_GINT64_FORMAT"\t%"G_GINT64_FORMAT".%09"G_GINT64_FORMAT"\t%"G_GINT64_FORMAT"\n",
+				path,
+				info->st_mode,
+				(gint64) info->st_size,
+				(gint64) info->st_mtime,
+				BRASERO_STAT_MTIME_NSEC (info),
+				(gint64) info->st_ctime);
+	g_checksum_update (checksum, (guchar *) line, strlen (line));
+	g_free (line);
+}
+
+static gboolean
+brasero_image_cache_hash_path (BraseroImageCacheKeyData *data,
+			       GCancellable *cancel,
+			       const gchar *path)
+{
+	struct stat info;
+	GSList *children = NULL;
+	GSList *iter;
+	const gchar *name;
+	gboolean success;
+	gchar *inode;
+	GDir *dir;
+
+	if (g_cancellable_is_cancelled (cancel))
+		return FALSE;
+
+	if (g_hash_table_lookup (data->excluded, path))
+		return TRUE;
+
+	if (g_lstat (path, &info))
+		return FALSE;
+
+	/* Symlinks are followed like the image does with the files of the
+	 * graft; what they point to is hashed, not the links themselves. */
+	if (S_ISLNK (info.st_mode) && g_stat (path, &info))
+		return FALSE;
+
+	brasero_image_cache_hash_stat (data->checksum, path, &info);
+
+	if (!S_ISDIR (info.st_mode))
+		return TRUE;
+
+	/* A link to one of the directories being walked is a loop which the
+	 * image skips as well */
+	inode = g_strdup_printf ("%"G_GUINT64_FORMAT":%"G_GUINT64_FORMAT,
+				 (guint64) info.st_dev,
+				 (guint64) info.st_ino);
+	if (g_hash_table_lookup (data->ancestors, inode)) {
+		g_free (inode);
+		return TRUE;
+	}
+
+	dir = g_dir_open (path, 0, NULL);
+	if (!dir) {
+		g_free (inode);
+		return FALSE;
+	}
+
+	/* Sort the entries so the order doesn't depend on the filesystem */
+	while ((name = g_dir_read_name (dir)))
+		children = g_slist_prepend (children, g_build_filename (path, name, NULL));
+	g_dir_close (dir);
+
+	children = g_slist_sort (children, (GCompareFunc) strcmp);
+
+	g_hash_table_insert (data->ancestors, inode, GINT_TO_POINTER (1));
+
+	success = TRUE;
+	for (iter = children; iter && success; iter = iter->next)
+		success = brasero_image_cache_hash_path (data, cancel, iter->data);
+
+	g_hash_table_remove (data->ancestors, inode);
+
+	g_slist_foreach (children, (GFunc) g_free, NULL);
+	g_slist_free (children);
+
+	return success;
+}
+
+static BraseroAsyncTaskResult
+brasero_image_cache_key_thread (BraseroAsyncTaskManager *manager,
+				GCancellable *cancel,
+				gpointer callback_data)
+{
+	BraseroImageCacheKeyData *data = callback_data;
+	GSList *iter;
+
+	data->success = TRUE;
+	for (iter = data->grafts; iter && data->success; iter = iter->next) {
+		BraseroGraftPt *graft;
+		gchar *path;
+
+		graft = iter->data;
+		g_checksum_update (data->checksum, (guchar *) graft->path, strlen (graft->path));
+
+		/* Empty directories */
+		if (!graft->uri)
+			continue;
+
+		g_checksum_update (data->checksum, (guchar *) graft->uri, strlen (graft->uri));
+
+		/* Remote files would be too costly to check */
+		path = g_filename_from_uri (graft->uri, NULL, NULL);
+		if (!path) {
+			BRASERO_BURN_LOG ("Non local graft %s; image cannot be cached", graft->uri);
+			data->success = FALSE;
+			break;
+		}
+
+		data->success = brasero_image_cache_hash_path (data, cancel, path);
+		g_free (path);
+	}
+
+	return BRASERO_ASYNC_TASK_FINISHED;
+}
+
+static gboolean
+brasero_image_cache_key_done_cb (gpointer callback_data)
+{
+	BraseroImageCacheKeyData *data = callback_data;
+
+	data->done = TRUE;
+	return FALSE;
+}
+
+static void
+brasero_image_cache_key_destroy (BraseroAsyncTaskManager *manager,
+				 gboolean cancelled,
+				 gpointer callback_data)
+{
+	BraseroImageCacheKeyData *data = callback_data;
+
+	/* The data belong to the caller which waits in its own context */
+	if (cancelled)
+		data->success = FALSE;
+
+	brasero_burn_idle_add (data->context,
+			       brasero_image_cache_key_done_cb,
+			       data);
+}
+
+static const BraseroAsyncTaskType key_type = {
+	brasero_image_cache_key_thread,
+	brasero_image_cache_key_destroy
+};
+
+/**
+ * brasero_image_cache_get_key:
+ * @session: a #BraseroBurnSession
+ *
+ * Returns the key under which the image created for @session is cached or
+ * NULL if its image cannot be cached. Only single data tracks made of local
+ * files can be; the key changes whenever a file is added, removed, or
+ * modified (size, modification and change times) or if the image properties
+ * change.
+ * The main context of the calling thread keeps running while the files are
+ * checked.
+ **/
+
+gchar *
+brasero_image_cache_get_key (BraseroBurnSession *session)
+{
+	BraseroImageCacheKeyData *data;
+	BraseroTrackData *track;
+	const gchar *label;
+	GSList *tracks;
+	GSList *iter;
+	gchar *line;
+	gchar *key;
+
+	tracks = brasero_burn_session_get_tracks (session);
+	if (g_slist_length (tracks) != 1
+	|| !BRASERO_IS_TRACK_DATA (tracks->data))
+		return NULL;
+
+	/* Images for appended sessions depend on the medium contents */
+	if (BRASERO_BURN_SESSION_APPEND (session))
+		return NULL;
+
+	if (!brasero_image_cache_get_max_size ())
+		return NULL;
+
+	track = tracks->data;
+
+	data = g_new0 (BraseroImageCacheKeyData, 1);
+	data->checksum = g_checksum_new (G_CHECKSUM_SHA256);
+	data->context = brasero_burn_context_get_current ();
+
+	label = brasero_burn_session_get_label (session);
+	line = g_strdup_printf ("%s\t%i\n",
+				label ? label:"",
+				brasero_track_data_get_fs (track));
+	g_checksum_update (data->checksum, (guchar *) line, strlen (line));
+	g_free (line);
+
+	data->excluded = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	for (iter = brasero_track_data_get_excluded_list (track); iter; iter = iter->next) {
+		gchar *path;
+
+		g_checksum_update (data->checksum, (guchar *) iter->data, strlen (iter->data));
+		path = g_filename_from_uri (iter->data, NULL, NULL);
+		if (path)
+			g_hash_table_insert (data->excluded, path, GINT_TO_POINTER (1));
+	}
+
+	/* The thread works on its own copy of the grafts */
+	for (iter = brasero_track_data_get_grafts (track); iter; iter = iter->next)
+		data->grafts = g_slist_prepend (data->grafts, brasero_graft_point_copy (iter->data));
+	data->grafts = g_slist_reverse (data->grafts);
+
+	data->ancestors = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	brasero_io_push_job (BRASERO_IO_JOB (data), &key_type);
+	while (!data->done)
+		g_main_context_iteration (data->context, TRUE);
+
+	if (data->success) {
+		key = g_strdup (g_checksum_get_string (data->checksum));
+		BRASERO_BURN_LOG ("Image cache key %s", key);
+	}
+	else
+		key = NULL;
+
+	g_slist_foreach (data->grafts, (GFunc) brasero_graft_point_free, NULL);
+	g_slist_free (data->grafts);
+	g_hash_table_destroy (data->ancestors);
+	g_hash_table_destroy (data->excluded);
+	g_checksum_free (data->checksum);
+	g_free (data);
+
+	return key;
+}
+
+/**
+ * brasero_image_cache_lookup:
+ * @key: a key returned by brasero_image_cache_get_key ()
+ *
+ * Returns a new #BraseroTrackImage for the image cached under @key or NULL
+ * if there is none.
+ **/
+
+BraseroTrackImage *
+brasero_image_cache_lookup (const gchar *key)
+{
+	BraseroChecksumType checksum_type;
+	BraseroTrackImage *track;
+	gchar *checksum;
+	struct stat info;
+	GKeyFile *file;
+	gchar *image;
+	gchar *path;
+	goffset size;
+
+	g_return_val_if_fail (key != NULL, NULL);
+
+	path = brasero_image_cache_get_path (key, ".info");
+	file = g_key_file_new ();
+	if (!g_key_file_load_from_file (file, path, G_KEY_FILE_NONE, NULL)) {
+		BRASERO_BURN_LOG ("No cached image for %s", key);
+		g_key_file_free (file);
+		g_free (path);
+		return NULL;
+	}
+
+	image = brasero_image_cache_get_path (key, ".iso");
+	size = g_key_file_get_int64 (file, BRASERO_IMAGE_CACHE_GROUP, BRASERO_IMAGE_CACHE_SIZE_KEY, NULL);
+	if (g_stat (image, &info) || info.st_size != size) {
+		BRASERO_BURN_LOG ("Cached image %s is invalid", key);
+		g_key_file_free (file);
+		g_free (image);
+		g_free (path);
+
+		brasero_image_cache_remove (key);
+		return NULL;
+	}
+
+	/* Update its last use for LRU eviction */
+	g_key_file_set_int64 (file,
+			      BRASERO_IMAGE_CACHE_GROUP,
+			      BRASERO_IMAGE_CACHE_LAST_USED_KEY,
+			      g_get_real_time ());
+	brasero_image_cache_save_info (file, path);
+	g_free (path);
+
+	BRASERO_BURN_LOG ("Reusing cached image %s", image);
+
+	track = brasero_track_image_new ();
+	brasero_track_image_set_source (track,
+					image,
+					NULL,
+					BRASERO_IMAGE_FORMAT_BIN);
+	brasero_track_image_set_block_num (track, BRASERO_BYTES_TO_SECTORS (size, 2048));
+	g_free (image);
+
+	checksum_type = g_key_file_get_integer (file,
+						BRASERO_IMAGE_CACHE_GROUP,
+						BRASERO_IMAGE_CACHE_CHECKSUM_TYPE_KEY,
+						NULL);
+	checksum = g_key_file_get_string (file,
+					  BRASERO_IMAGE_CACHE_GROUP,
+					  BRASERO_IMAGE_CACHE_CHECKSUM_KEY,
+					  NULL);
+	if (checksum_type != BRASERO_CHECKSUM_NONE)
+		brasero_track_set_checksum (BRASERO_TRACK (track),
+					    checksum_type,
+					    checksum);
+	g_free (checksum);
+
+	g_key_file_free (file);
+	return track;
+}
+
+/**
+ * Insertion and eviction
+ */
+
+static gint
+brasero_image_cache_entry_compare (gconstpointer a,
+				   gconstpointer b)
+{
+	const BraseroImageCacheEntry *entry_a = a;
+	const BraseroImageCacheEntry *entry_b = b;
+
+	if (entry_a->last_used < entry_b->last_used)
+		return -1;
+
+	return entry_a->last_used > entry_b->last_used;
+}
+
+static void
+brasero_image_cache_entry_free (BraseroImageCacheEntry *entry)
+{
+	g_free (entry->key);
+	g_free (entry);
+}
+
+static void
+brasero_image_cache_evict (goffset max)
+{
+	GSList *entries = NULL;
+	const gchar *name;
+	gchar *directory;
+	goffset total = 0;
+	GSList *iter;
+	GDir *dir;
+
+	directory = brasero_image_cache_get_dir ();
+	dir = g_dir_open (directory, 0, NULL);
+	if (!dir) {
+		g_free (directory);
+		return;
+	}
+
+	while ((name = g_dir_read_name (dir))) {
+		BraseroImageCacheEntry *entry;
+		GKeyFile *file;
+		gchar *path;
+
+		if (!g_str_has_suffix (name, ".info"))
+			continue;
+
+		path = g_build_filename (directory, name, NULL);
+		file = g_key_file_new ();
+		if (!g_key_file_load_from_file (file, path, G_KEY_FILE_NONE, NULL)) {
+			g_key_file_free (file);
+			g_free (path);
+			continue;
+		}
+		g_free (path);
+
+		entry = g_new0 (BraseroImageCacheEntry, 1);
+		entry->key = g_strndup (name, strlen (name) - strlen (".info"));
+		entry->size = g_key_file_get_int64 (file, BRASERO_IMAGE_CACHE_GROUP, BRASERO_IMAGE_CACHE_SIZE_KEY, NULL);
+		entry->last_used = g_key_file_get_int64 (file, BRASERO_IMAGE_CACHE_GROUP, BRASERO_IMAGE_CACHE_LAST_USED_KEY, NULL);
+		g_key_file_free (file);
+
+		total += entry->size;
+		entries = g_slist_prepend (entries, entry);
+	}
+	g_dir_close (dir);
+	g_free (directory);
+
+	/* Remove the least recently used first */
+	entries = g_slist_sort (entries, brasero_image_cache_entry_compare);
+	for (iter = entries; iter && total > max; iter = iter->next) {
+		BraseroImageCacheEntry *entry;
+
+		entry = iter->data;
+		brasero_image_cache_remove (entry->key);
+		total -= entry->size;
+	}
+
+	g_slist_foreach (entries, (GFunc) brasero_image_cache_entry_free, NULL);
+	g_slist_free (entries);
+}
+
+/**
+ * brasero_image_cache_add:
+ * @key: a key returned by brasero_image_cache_get_key ()
+ * @track: a #BraseroTrackImage
+ *
+ * Stores the image of @track under @key. The least recently used images are
+ * removed if need be to keep the cache under the size set by the user.
+ **/
+
+void
+brasero_image_cache_add (const gchar *key,
+			 BraseroTrackImage *track)
+{
+	GError *error = NULL;
+	gchar *directory;
+	struct stat info;
+	GKeyFile *file;
+	gchar *image;
+	gchar *cached;
+	gchar *path;
+	gchar *toc;
+	goffset max;
+
+	g_return_if_fail (key != NULL);
+	g_return_if_fail (BRASERO_IS_TRACK_IMAGE (track));
+
+	max = brasero_image_cache_get_max_size ();
+	if (!max)
+		return;
+
+	if (brasero_track_image_get_format (track) != BRASERO_IMAGE_FORMAT_BIN)
+		return;
+
+	toc = brasero_track_image_get_toc_source (track, FALSE);
+	if (toc) {
+		g_free (toc);
+		return;
+	}
+
+	image = brasero_track_image_get_source (track, FALSE);
+	if (!image)
+		return;
+
+	if (g_stat (image, &info) || info.st_size > max) {
+		g_free (image);
+		return;
+	}
+
+	directory = brasero_image_cache_get_dir ();
+	if (g_mkdir_with_parents (directory, S_IRWXU)) {
+		BRASERO_BURN_LOG ("Impossible to create image cache directory %s", directory);
+		g_free (directory);
+		g_free (image);
+		return;
+	}
+	g_free (directory);
+
+	brasero_image_cache_evict (max - info.st_size);
+
+	/* Temporary images are removed with the session so keep our own link
+	 * to the file or make a copy of it if it is on another filesystem. */
+	cached = brasero_image_cache_get_path (key, ".iso");
+	if (link (image, cached)) {
+		GFile *src;
+		GFile *dest;
+
+		src = g_file_new_for_path (image);
+		dest = g_file_new_for_path (cached);
+		g_file_copy (src,
+			     dest,
+			     G_FILE_COPY_OVERWRITE,
+			     NULL,
+			     NULL,
+			     NULL,
+			     &error);
+		g_object_unref (src);
+		g_object_unref (dest);
+
+		if (error) {
+			BRASERO_BURN_LOG ("Image could not be cached: %s", error->message);
+			g_error_free (error);
+			g_free (cached);
+			g_free (image);
+
+			brasero_image_cache_remove (key);
+			return;
+		}
+	}
+
+	BRASERO_BURN_LOG ("Image %s cached as %s", image, cached);
+	g_free (cached);
+	g_free (image);
+
+	file = g_key_file_new ();
+	g_key_file_set_int64 (file,
+			      BRASERO_IMAGE_CACHE_GROUP,
+			      BRASERO_IMAGE_CACHE_SIZE_KEY,
+			      info.st_size);
+	g_key_file_set_int64 (file,
+			      BRASERO_IMAGE_CACHE_GROUP,
+			      BRASERO_IMAGE_CACHE_LAST_USED_KEY,
+			      g_get_real_time ());
+	g_key_file_set_integer (file,
+				BRASERO_IMAGE_CACHE_GROUP,
+				BRASERO_IMAGE_CACHE_CHECKSUM_TYPE_KEY,
+				brasero_track_get_checksum_type (BRASERO_TRACK (track)));
+	if (brasero_track_get_checksum (BRASERO_TRACK (track)))
+		g_key_file_set_string (file,
+				       BRASERO_IMAGE_CACHE_GROUP,
+				       BRASERO_IMAGE_CACHE_CHECKSUM_KEY,
+				       brasero_track_get_checksum (BRASERO_TRACK (track)));
+
+	path = brasero_image_cache_get_path (key, ".info");
+	brasero_image_cache_save_info (file, path);
+	g_key_file_free (file);
+	g_free (path);
+}
@@ -0,0 +1,340 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Libbrasero-burn
+ * Copyright (C) Philippe Rouquier 2005-2009 <bonfire-app@wanadoo.fr>
+ *
+ * Libbrasero-burn is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The Libbrasero-burn authors hereby grant permission for non-GPL compatible
+ * GStreamer plugins to be used and distributed together with GStreamer
+ * and Libbrasero-burn. This permission is above and beyond the permissions granted
+ * by the GPL license by which Libbrasero-burn is covered. If you modify this code
+ * you may extend this exception to your version of the code, but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version.
+ * 
+ * Libbrasero-burn is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <glib.h>
+#include <glib/gi18n-lib.h>
+#include <glib/gstdio.h>
+
+#include "brasero-error.h"
+#include "burn-basics.h"
+#include "burn-debug.h"
+#include "burn-image-follower.h"
+
+#define BRASERO_FOLLOWER_BUFFER_SIZE		(64 * 1024)
+
+struct _BraseroImageFollower {
+	gchar *image;
+	goffset lead;
+
+	BraseroImageFollowerAbortFunc abort_func;
+	gpointer user_data;
+
+	GThread *thread;
+
+	/* write end of the pipe; the read end is owned by the recorder */
+	int out;
+
+	/* We keep a copy of the read end opened so that writing never raises
+	 * SIGPIPE if the recorder goes away; the thread is cancelled then. */
+	int spare;
+
+	gint done;
+	gint failed;
+	gint cancel;
+};
+
+static gboolean
+brasero_image_follower_write (BraseroImageFollower *follower,
+			      const gchar *buffer,
+			      gssize size)
+{
+	while (size > 0) {
+		struct pollfd pfd;
+		gssize written;
+
+		if (g_atomic_int_get (&follower->cancel))
+			return FALSE;
+
+		/* wait for the recorder to make some room in the pipe */
+		pfd.fd = follower->out;
+		pfd.events = POLLOUT;
+		pfd.revents = 0;
+		if (poll (&pfd, 1, 250) <= 0)
+			continue;
+
+		written = write (follower->out, buffer, size);
+		if (written < 0) {
+			if (errno == EAGAIN || errno == EINTR)
+				continue;
+
+			BRASERO_BURN_LOG ("Image follower could not write (%s)", g_strerror (errno));
+			return FALSE;
+		}
+
+		buffer += written;
+		size -= written;
+	}
+
+	return TRUE;
+}
+
+static gpointer
+brasero_image_follower_thread (gpointer data)
+{
+	BraseroImageFollower *follower = data;
+	goffset total = 0;
+	gchar *buffer;
+	int in;
+
+	in = open (follower->image, O_RDONLY);
+	if (in < 0) {
+		BRASERO_BURN_LOG ("Image follower could not open %s (%s)",
+				  follower->image,
+				  g_strerror (errno));
+		goto end;
+	}
+
+	buffer = g_malloc (BRASERO_FOLLOWER_BUFFER_SIZE);
+	while (!g_atomic_int_get (&follower->cancel)) {
+		gboolean done;
+		gssize bytes;
+
+		if (g_atomic_int_get (&follower->failed))
+			break;
+
+		/* NOTE: check whether the imager is done before reading so
+		 * that the end of file really is the end of the image */
+		done = g_atomic_int_get (&follower->done);
+
+		bytes = read (in, buffer, BRASERO_FOLLOWER_BUFFER_SIZE);
+		if (bytes < 0) {
+			if (errno == EINTR)
+				continue;
+
+			BRASERO_BURN_LOG ("Image follower could not read (%s)", g_strerror (errno));
+			break;
+		}
+
+		if (!bytes) {
+			if (done)
+				break;
+
+			/* The recorder caught up with the imager; wait */
+			g_usleep (G_USEC_PER_SEC / 10);
+			continue;
+		}
+
+		if (!brasero_image_follower_write (follower, buffer, bytes))
+			break;
+
+		total += bytes;
+	}
+
+	g_free (buffer);
+	close (in);
+
+end:
+
+	BRASERO_BURN_LOG ("Image follower stopped after %" G_GOFFSET_FORMAT " bytes", total);
+
+	/* Closing our end lets the recorder know there is no more data */
+	close (follower->out);
+	follower->out = -1;
+	return NULL;
+}
+
+static void
+brasero_image_follower_stop (BraseroImageFollower *follower)
+{
+	if (follower->thread) {
+		g_atomic_int_set (&follower->cancel, 1);
+		g_thread_join (follower->thread);
+		follower->thread = NULL;
+		g_atomic_int_set (&follower->cancel, 0);
+	}
+
+	if (follower->out >= 0) {
+		close (follower->out);
+		follower->out = -1;
+	}
+
+	if (follower->spare >= 0) {
+		close (follower->spare);
+		follower->spare = -1;
+	}
+}
+
+/**
+ * Returns the read end of a pipe from which the whole image can be read
+ * from the start. It is owned by the caller.
+ */
+
+int
+brasero_image_follower_open (BraseroImageFollower *follower,
+			     GError **error)
+{
+	int fd [2];
+
+	/* The recorder may be restarted; in this case start from scratch */
+	brasero_image_follower_stop (follower);
+
+	if (!follower->image) {
+		g_set_error (error,
+			     BRASERO_BURN_ERROR,
+			     BRASERO_BURN_ERROR_GENERAL,
+			     "%s", _("An internal error occurred"));
+		return -1;
+	}
+
+	if (pipe (fd)) {
+		int errsv = errno;
+
+		BRASERO_BURN_LOG ("A pipe couldn't be created");
+		g_set_error (error,
+			     BRASERO_BURN_ERROR,
+			     BRASERO_BURN_ERROR_GENERAL,
+			     _("An internal error occurred (%s)"),
+			     g_strerror (errsv));
+		return -1;
+	}
+
+	/* The recorder process must not inherit our end otherwise it would
+	 * never see the end of the data */
+	fcntl (fd [1], F_SETFD, FD_CLOEXEC);
+	fcntl (fd [1], F_SETFL, fcntl (fd [1], F_GETFL) | O_NONBLOCK);
+
+	follower->out = fd [1];
+	follower->spare = dup (fd [0]);
+	if (follower->spare >= 0)
+		fcntl (follower->spare, F_SETFD, FD_CLOEXEC);
+
+	follower->thread = g_thread_create (brasero_image_follower_thread,
+					    follower,
+					    TRUE,
+					    error);
+	if (!follower->thread) {
+		brasero_image_follower_stop (follower);
+		close (fd [0]);
+		return -1;
+	}
+
+	BRASERO_BURN_LOG ("Following image %s", follower->image);
+	return fd [0];
+}
+
+/**
+ * Called when the imager is finished. If it failed the recorder is aborted.
+ */
+
+void
+brasero_image_follower_source_finished (BraseroImageFollower *follower,
+					gboolean success)
+{
+	BRASERO_BURN_LOG ("Followed image finished (%s)", success? "success":"failure");
+
+	if (success) {
+		g_atomic_int_set (&follower->done, 1);
+		return;
+	}
+
+	g_atomic_int_set (&follower->failed, 1);
+	if (follower->thread && follower->abort_func)
+		follower->abort_func (follower->user_data);
+}
+
+/**
+ * Returns TRUE when the recorder can be started, that is when the image has
+ * at least the required lead or when it is complete.
+ */
+
+gboolean
+brasero_image_follower_is_ready (BraseroImageFollower *follower)
+{
+	struct stat buffer;
+
+	if (!follower->image)
+		return FALSE;
+
+	if (g_atomic_int_get (&follower->failed))
+		return FALSE;
+
+	if (g_atomic_int_get (&follower->done))
+		return TRUE;
+
+	if (g_stat (follower->image, &buffer))
+		return FALSE;
+
+	return (buffer.st_size >= follower->lead);
+}
+
+void
+brasero_image_follower_set_source (BraseroImageFollower *follower,
+				   const gchar *image)
+{
+	/* the imager may have been restarted */
+	g_free (follower->image);
+	follower->image = g_strdup (image);
+
+	g_atomic_int_set (&follower->done, 0);
+	g_atomic_int_set (&follower->failed, 0);
+}
+
+const gchar *
+brasero_image_follower_get_source (BraseroImageFollower *follower)
+{
+	return follower->image;
+}
+
+BraseroImageFollower *
+brasero_image_follower_new (goffset lead,
+			    BraseroImageFollowerAbortFunc abort_func,
+			    gpointer user_data)
+{
+	BraseroImageFollower *follower;
+
+	follower = g_new0 (BraseroImageFollower, 1);
+	follower->lead = lead;
+	follower->abort_func = abort_func;
+	follower->user_data = user_data;
+	follower->out = -1;
+	follower->spare = -1;
+	return follower;
+}
+
+void
+brasero_image_follower_free (BraseroImageFollower *follower)
+{
+	brasero_image_follower_stop (follower);
+	g_free (follower->image);
+	g_free (follower);
+}
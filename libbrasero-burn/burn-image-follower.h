@@ -0,0 +1,77 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Libbrasero-burn
+ * Copyright (C) Philippe Rouquier 2005-2009 <bonfire-app@wanadoo.fr>
+ *
+ * Libbrasero-burn is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The Libbrasero-burn authors hereby grant permission for non-GPL compatible
+ * GStreamer plugins to be used and distributed together with GStreamer
+ * and Libbrasero-burn. This permission is above and beyond the permissions granted
+ * by the GPL license by which Libbrasero-burn is covered. If you modify this code
+ * you may extend this exception to your version of the code, but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version.
+ * 
+ * Libbrasero-burn is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef _BURN_IMAGE_FOLLOWER_H_
+#define _BURN_IMAGE_FOLLOWER_H_
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/**
+ * Feeds a recorder through a pipe with the contents of an image file while
+ * that file is still being written by an imager. The recorder never reads
+ * more than what is already on disk.
+ */
+
+typedef struct _BraseroImageFollower BraseroImageFollower;
+
+typedef void	(*BraseroImageFollowerAbortFunc)	(gpointer user_data);
+
+BraseroImageFollower *
+brasero_image_follower_new (goffset lead,
+			    BraseroImageFollowerAbortFunc abort_func,
+			    gpointer user_data);
+
+void
+brasero_image_follower_free (BraseroImageFollower *follower);
+
+void
+brasero_image_follower_set_source (BraseroImageFollower *follower,
+				   const gchar *image);
+
+const gchar *
+brasero_image_follower_get_source (BraseroImageFollower *follower);
+
+gboolean
+brasero_image_follower_is_ready (BraseroImageFollower *follower);
+
+void
+brasero_image_follower_source_finished (BraseroImageFollower *follower,
+					gboolean success);
+
+int
+brasero_image_follower_open (BraseroImageFollower *follower,
+			     GError **error);
+
+G_END_DECLS
+
+#endif /* _BURN_IMAGE_FOLLOWER_H_ */
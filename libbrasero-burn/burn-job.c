@@ -63,6 +63,8 @@
 typedef struct _BraseroJobOutput {
 	gchar *image;
 	gchar *toc;
+
+	guint is_tmp:1;
 } BraseroJobOutput;
 
 typedef struct _BraseroJobInput {
@@ -82,6 +84,9 @@ struct BraseroJobPrivate {
 
 	BraseroTaskCtx *ctx;
 
+	/* the main context of the thread the job was created in */
+	GMainContext *context;
+
 	/* used if job reads data from a pipe */
 	BraseroJobInput *input;
 
@@ -652,6 +657,15 @@ brasero_job_set_output_file (BraseroJob *self,
 								     error);
 			if (result != BRASERO_BURN_OK)
 				return result;
+
+			/* Let the recorder follow the image as it grows */
+			if (priv->type.subtype.img_format == BRASERO_IMAGE_FORMAT_BIN) {
+				BraseroImageFollower *follower;
+
+				follower = brasero_task_ctx_get_output_follower (priv->ctx);
+				if (follower)
+					brasero_image_follower_set_source (follower, image);
+			}
 		}
 
 		BRASERO_JOB_LOG (self, "output set (IMAGE) image = %s toc = %s",
@@ -675,6 +689,7 @@ brasero_job_set_output_file (BraseroJob *self,
 	priv->output = g_new0 (BraseroJobOutput, 1);
 	priv->output->image = image;
 	priv->output->toc = toc;
+	priv->output->is_tmp = !is_last || priv->type.type == BRASERO_TRACK_TYPE_STREAM;
 
 	if (brasero_burn_session_get_flags (session) & BRASERO_BURN_FLAG_CHECK_SIZE)
 		return brasero_job_check_output_volume_space (self, error);
@@ -752,7 +767,24 @@ brasero_job_item_start (BraseroTaskItem *item,
 	else
 		BRASERO_JOB_LOG (self, "linked to %s", G_OBJECT_TYPE_NAME (priv->linked));
 
-	if (!brasero_job_is_first_active (self)) {
+	if (!brasero_job_is_first_active (self)
+	&&  action == BRASERO_JOB_ACTION_RECORD
+	&&  brasero_task_ctx_get_ring_buffer (priv->ctx)) {
+		BraseroRingBuffer *ring;
+		int in, out;
+
+		/* The data the previous job reads goes through a large
+		 * buffer before being recorded */
+		BRASERO_JOB_LOG (self, "creating buffered input");
+		ring = brasero_task_ctx_get_ring_buffer (priv->ctx);
+		if (!brasero_ring_buffer_open (ring, &in, &out, error))
+			return BRASERO_BURN_ERR;
+
+		priv->input = g_new0 (BraseroJobInput, 1);
+		priv->input->in = in;
+		priv->input->out = out;
+	}
+	else if (!brasero_job_is_first_active (self)) {
 		int fd [2];
 
 		BRASERO_JOB_LOG (self, "creating input");
@@ -777,6 +809,22 @@ brasero_job_item_start (BraseroTaskItem *item,
 		priv->input->in = fd [0];
 		priv->input->out = fd [1];
 	}
+	else if (action == BRASERO_JOB_ACTION_RECORD
+	     &&  brasero_task_ctx_get_input_follower (priv->ctx)) {
+		BraseroImageFollower *follower;
+		int fd;
+
+		/* The image is still being written; read it through a pipe
+		 * that the follower fills as the image grows */
+		follower = brasero_task_ctx_get_input_follower (priv->ctx);
+		fd = brasero_image_follower_open (follower, error);
+		if (fd < 0)
+			return BRASERO_BURN_ERR;
+
+		BRASERO_JOB_LOG (self, "following image %s", brasero_image_follower_get_source (follower));
+		priv->input = g_new0 (BraseroJobInput, 1);
+		priv->input->in = fd;
+	}
 
 	klass = BRASERO_JOB_GET_CLASS (self);
 	if (!klass->start) {
@@ -1347,6 +1395,33 @@ brasero_job_get_image_output (BraseroJob *self,
 	return BRASERO_BURN_OK;
 }
 
+BraseroBurnResult
+brasero_job_get_image_output_companion (BraseroJob *self,
+					const gchar *suffix,
+					gchar **path)
+{
+	BraseroJobPrivate *priv;
+
+	BRASERO_JOB_DEBUG (self);
+
+	priv = BRASERO_JOB_PRIVATE (self);
+
+	if (!priv->output || !priv->output->image)
+		return BRASERO_BURN_ERR;
+
+	*path = g_strconcat (priv->output->image, suffix, NULL);
+
+	/* A temporary image goes with all that was created for it */
+	if (priv->output->is_tmp) {
+		BraseroBurnSession *session;
+
+		session = brasero_task_ctx_get_session (priv->ctx);
+		brasero_burn_session_add_tmp_file (session, *path);
+	}
+
+	return BRASERO_BURN_OK;
+}
+
 BraseroBurnResult
 brasero_job_get_audio_output (BraseroJob *self,
 			      gchar **path)
@@ -1777,6 +1852,42 @@ brasero_job_get_data_label (BraseroJob *self, gchar **label)
 	return BRASERO_BURN_OK;
 }
 
+/**
+ * Jobs' sources (in particular those added from their threads to report
+ * they are done) must be attached to this context; it is not always the
+ * default one.
+ */
+
+GMainContext *
+brasero_job_get_context (BraseroJob *self)
+{
+	BraseroJobPrivate *priv;
+
+	priv = BRASERO_JOB_PRIVATE (self);
+	return priv->context;
+}
+
+guint
+brasero_job_idle_add (BraseroJob *self,
+		      GSourceFunc function,
+		      gpointer data)
+{
+	BraseroJobPrivate *priv;
+
+	priv = BRASERO_JOB_PRIVATE (self);
+	return brasero_burn_idle_add (priv->context, function, data);
+}
+
+void
+brasero_job_source_remove (BraseroJob *self,
+			   guint id)
+{
+	BraseroJobPrivate *priv;
+
+	priv = BRASERO_JOB_PRIVATE (self);
+	brasero_burn_source_remove (priv->context, id);
+}
+
 BraseroBurnResult
 brasero_job_get_session_output_size (BraseroJob *self,
 				     goffset *blocks,
@@ -1905,6 +2016,43 @@ brasero_job_set_rate (BraseroJob *self,
 	return brasero_task_ctx_set_rate (priv->ctx, rate);
 }
 
+/**
+ * Used by recorders to report how full (in %) their own fifo and the drive
+ * buffer are; -1 means unknown.
+ */
+
+BraseroBurnResult
+brasero_job_set_buffer_fill (BraseroJob *self,
+			     gint fifo,
+			     gint buffer)
+{
+	BraseroJobPrivate *priv;
+
+	priv = BRASERO_JOB_PRIVATE (self);
+	if (priv->next)
+		return BRASERO_BURN_NOT_RUNNING;
+
+	return brasero_task_ctx_set_buffer_fill (priv->ctx, fifo, buffer);
+}
+
+/**
+ * Used by processes when they are reaped to report their peak RSS (in KiB).
+ * Unlike the above, all jobs of the chain report it.
+ */
+
+BraseroBurnResult
+brasero_job_set_child_usage (BraseroJob *self,
+			     glong maxrss)
+{
+	BraseroJobPrivate *priv;
+
+	priv = BRASERO_JOB_PRIVATE (self);
+	if (!priv->ctx)
+		return BRASERO_BURN_NOT_RUNNING;
+
+	return brasero_task_ctx_set_child_usage (priv->ctx, maxrss);
+}
+
 BraseroBurnResult
 brasero_job_set_output_size_for_current_track (BraseroJob *self,
 					       goffset sectors,
@@ -2083,6 +2231,11 @@ brasero_job_finalize (GObject *object)
 		priv->ctx = NULL;
 	}
 
+	if (priv->context) {
+		g_main_context_unref (priv->context);
+		priv->context = NULL;
+	}
+
 	if (priv->previous) {
 		g_object_unref (priv->previous);
 		priv->previous = NULL;
@@ -2135,4 +2288,9 @@ brasero_job_class_init (BraseroJobClass *klass)
 
 static void
 brasero_job_init (BraseroJob *obj)
-{ }
+{
+	BraseroJobPrivate *priv;
+
+	priv = BRASERO_JOB_PRIVATE (obj);
+	priv->context = g_main_context_ref (brasero_burn_context_get_current ());
+}
@@ -144,6 +144,18 @@ brasero_job_get_audio_title (BraseroJob *job, gchar **album);
 BraseroBurnResult
 brasero_job_get_data_label (BraseroJob *job, gchar **label);
 
+GMainContext *
+brasero_job_get_context (BraseroJob *job);
+
+guint
+brasero_job_idle_add (BraseroJob *job,
+		      GSourceFunc function,
+		      gpointer data);
+
+void
+brasero_job_source_remove (BraseroJob *job,
+			   guint id);
+
 BraseroBurnResult
 brasero_job_get_session_output_size (BraseroJob *job,
 				     goffset *blocks,
@@ -197,6 +209,17 @@ BraseroBurnResult
 brasero_job_get_image_output (BraseroJob *job,
 			      gchar **image,
 			      gchar **toc);
+
+/**
+ * get the path of a file kept next to the image output (its path followed by
+ * suffix). If the image is temporary, the file is deleted along with it.
+ */
+
+BraseroBurnResult
+brasero_job_get_image_output_companion (BraseroJob *job,
+					const gchar *suffix,
+					gchar **path);
+
 BraseroBurnResult
 brasero_job_get_audio_output (BraseroJob *job,
 			      gchar **output);
@@ -220,6 +243,10 @@ brasero_job_get_tmp_dir (BraseroJob *job,
  * Each tag can be retrieved by any job
  */
 
+/* Int: set when the plugin creating an image from data can read non local
+ * files itself so there is no need to download them beforehand */
+#define BRASERO_SESSION_REMOTE_DATA_TAG		"session::data::remote"
+
 BraseroBurnResult
 brasero_job_tag_lookup (BraseroJob *job,
 			const gchar *tag,
@@ -265,6 +292,13 @@ BraseroBurnResult
 brasero_job_set_rate (BraseroJob *job,
 		      gint64 rate);
 BraseroBurnResult
+brasero_job_set_buffer_fill (BraseroJob *job,
+			     gint fifo,
+			     gint buffer);
+BraseroBurnResult
+brasero_job_set_child_usage (BraseroJob *job,
+			     glong maxrss);
+BraseroBurnResult
 brasero_job_set_written_track (BraseroJob *job,
 			       goffset written);
 BraseroBurnResult
@@ -56,10 +56,15 @@ struct _BraseroMkisofsBase {
 	const gchar *videodir;
 
 	gint grafts_fd;
-	gint excluded_fd;
+	GString *buffer;
+	guint lines;
 
 	GHashTable *grafts;
 
+	/* Excluded paths and all their parent directories */
+	GHashTable *excluded;
+	GHashTable *excluded_parents;
+
 	guint found_video_ts:1;
 	guint use_joliet:1;
 };
@@ -71,81 +76,127 @@ struct _BraseroWriteGraftData {
 };
 typedef struct _BraseroWriteGraftData BraseroWriteGraftData;
 
+#define BRASERO_MKISOFS_BUFFER_SIZE	65536
+
 static void
 brasero_mkisofs_base_clean (BraseroMkisofsBase *base)
 {
 	/* now we clean base we have the most important :
-	 * graft and excluded list, flags and that's what
-	 * we're going to use when we'll start the image 
-	 * creation */
-	if (base->grafts_fd)
+	 * graft list, flags and that's what we're going
+	 * to use when we'll start the image creation */
+	if (base->grafts_fd > 0)
 		close (base->grafts_fd);
-	if (base->excluded_fd)
-		close (base->excluded_fd);
+	if (base->buffer) {
+		g_string_free (base->buffer, TRUE);
+		base->buffer = NULL;
+	}
 	if (base->grafts) {
 		g_hash_table_destroy (base->grafts);
 		base->grafts = NULL;
 	}
+	if (base->excluded) {
+		g_hash_table_destroy (base->excluded);
+		base->excluded = NULL;
+	}
+	if (base->excluded_parents) {
+		g_hash_table_destroy (base->excluded_parents);
+		base->excluded_parents = NULL;
+	}
 }
 
 static BraseroBurnResult
-_write_line (int fd, const gchar *filepath, GError **error)
+brasero_mkisofs_base_flush (BraseroMkisofsBase *base,
+			    GError **error)
 {
-	gint len;
-	gint w_len;
+	gsize written = 0;
+
+	while (written < base->buffer->len) {
+		gssize w_len;
+
+		w_len = write (base->grafts_fd,
+			       base->buffer->str + written,
+			       base->buffer->len - written);
+		if (w_len < 0) {
+			if (errno == EINTR)
+				continue;
+
+			g_set_error (error,
+				     BRASERO_BURN_ERROR,
+				     BRASERO_BURN_ERROR_GENERAL,
+				     "%s",
+				     g_strerror (errno));
+			return BRASERO_BURN_ERR;
+		}
 
-	if (lseek (fd, 0, SEEK_CUR)
-	&&  write (fd, "\n", 1) != 1) {
-		g_set_error (error,
-			     BRASERO_BURN_ERROR,
-			     BRASERO_BURN_ERROR_GENERAL,
-			     "%s",
-			     g_strerror (errno));
-		return BRASERO_BURN_ERR;
-	}
-
-	len = strlen (filepath);
-	w_len = write (fd, filepath, len);
-
-	if (w_len != len) {
-		g_set_error (error,
-			     BRASERO_BURN_ERROR,
-			     BRASERO_BURN_ERROR_GENERAL,
-			     "%s",
-			     g_strerror (errno));
-		return BRASERO_BURN_ERR;
+		written += w_len;
 	}
 
+	g_string_truncate (base->buffer, 0);
 	return BRASERO_BURN_OK;
 }
 
+/**
+ * Lines are buffered and written in big chunks rather than one by one
+ */
+
 static BraseroBurnResult
-brasero_mkisofs_base_write_excluded (BraseroMkisofsBase *base,
-				     const gchar *uri,
-				     GError **error)
+_write_line (BraseroMkisofsBase *base,
+	     const gchar *filepath,
+	     GError **error)
+{
+	if (base->lines)
+		g_string_append_c (base->buffer, '\n');
+
+	g_string_append (base->buffer, filepath);
+	base->lines ++;
+
+	if (base->buffer->len < BRASERO_MKISOFS_BUFFER_SIZE)
+		return BRASERO_BURN_OK;
+
+	return brasero_mkisofs_base_flush (base, error);
+}
+
+static gchar *
+brasero_mkisofs_base_get_local_path (const gchar *uri)
 {
-	gint num;
-	gint forbidden;
-	gchar *character;
 	gchar *localpath;
-	BraseroBurnResult result = BRASERO_BURN_OK;
 
-	/* make sure uri is local: otherwise error out */
 	/* FIXME: uri can be path or URI? problem with graft->uri */
-	if (uri && uri [0] == '/') {
-		localpath = g_strdup (uri);
-	}
-	else if (uri && g_str_has_prefix (uri, "file://")) {
+	if (uri && uri [0] == '/')
+		return g_strdup (uri);
+
+	if (!uri || !g_str_has_prefix (uri, "file://"))
+		return NULL;
+
+	localpath = g_filename_from_uri (uri, NULL, NULL);
+	if (!localpath) {
 		gchar *unescaped_uri;
 
 		unescaped_uri = g_uri_unescape_string (uri, NULL);
 		localpath = g_filename_from_uri (unescaped_uri, NULL, NULL);
 		g_free (unescaped_uri);
-
-		if (!localpath)
-			localpath = g_filename_from_uri (uri, NULL, NULL);					  
 	}
-	else {
+
+	return localpath;
+}
+
+/**
+ * Instead of passing the excluded paths to mkisofs which would then match
+ * every file it finds against every one of them, the directories containing
+ * excluded files are expanded into their remaining children. The graft list
+ * then describes the exact contents of the image.
+ */
+
+static BraseroBurnResult
+brasero_mkisofs_base_add_excluded (BraseroMkisofsBase *base,
+				   const gchar *uri,
+				   GError **error)
+{
+	gchar *localpath;
+	gchar *parent;
+
+	localpath = brasero_mkisofs_base_get_local_path (uri);
+	if (!localpath) {
 		BRASERO_BURN_LOG ("File not stored locally %s", uri);
 		g_set_error (error,
 			     BRASERO_BURN_ERROR,
@@ -154,58 +205,27 @@ brasero_mkisofs_base_write_excluded (BraseroMkisofsBase *base,
 		return BRASERO_BURN_ERR;
 	}
 
-	if (!localpath) {
-		BRASERO_BURN_LOG ("Localpath is NULL");
-		return BRASERO_BURN_ERR;
-	}
+	/* Remove any trailing separator so that paths compare */
+	while (strlen (localpath) > 1 && g_str_has_suffix (localpath, G_DIR_SEPARATOR_S))
+		localpath [strlen (localpath) - 1] = '\0';
 
-	/* we need to escape some characters like []\? since in this file we
-	 * can use glob like expressions. */
-	character = localpath;
-	forbidden = 0;
-	num = 0;
-
-	while (character [0]) {
-		if (character [0] == '['
-		||  character [0] == ']'
-		||  character [0] == '?'
-		||  character [0] == '\\')
-			forbidden++;
-
-		num++;
-		character++;
-	}
+	parent = g_path_get_dirname (localpath);
+	g_hash_table_insert (base->excluded, localpath, GINT_TO_POINTER (1));
 
-	if (forbidden) {
+	/* Mark all parents; stop as soon as one is already known */
+	while (!g_hash_table_lookup (base->excluded_parents, parent)) {
 		gchar *tmp;
-		gint i;
-
-		tmp = g_new0 (gchar, num + forbidden + 1);
-		character = tmp;
-
-		for (i = 0; i < num; i++) {
-			if (localpath [i] == '['
-			||  localpath [i] == ']'
-			||  localpath [i] == '?'
-			||  localpath [i] == '\\') {
-				character [i] = '\\';
-				character++;
-			}
-			character [i] = localpath [i];
-		}
 
-		BRASERO_BURN_LOG ("Escaped path %s into %s", localpath, tmp);
-		g_free (localpath);
-		localpath = tmp;
-	}
+		g_hash_table_insert (base->excluded_parents, parent, GINT_TO_POINTER (1));
+		if (!strcmp (parent, G_DIR_SEPARATOR_S) || !strcmp (parent, "."))
+			return BRASERO_BURN_OK;
 
-	/* we just ignore if localpath is NULL:
-	 * - it could be a non local whose graft point couldn't be downloaded */
-	if (localpath)
-		result = _write_line (base->excluded_fd, localpath, error);
+		tmp = g_path_get_dirname (parent);
+		parent = tmp;
+	}
 
-	g_free (localpath);
-	return result;
+	g_free (parent);
+	return BRASERO_BURN_OK;
 }
 
 static gchar *
@@ -281,16 +301,16 @@ _build_graft_point (const gchar *uri, const gchar *discpath)
 }
 
 static BraseroBurnResult
-brasero_mkisofs_base_write_graft (BraseroMkisofsBase *base,
-				  const gchar *uri,
-				  const gchar *disc_path,
-				  GError **error)
+brasero_mkisofs_base_write_graft_point (BraseroMkisofsBase *base,
+					const gchar *path,
+					const gchar *disc_path,
+					GError **error)
 {
 	gchar *graft_point;
 	BraseroBurnResult result;
 
 	/* build up graft and write it */
-	graft_point = _build_graft_point (uri, disc_path);
+	graft_point = _build_graft_point (path, disc_path);
 	if (!graft_point) {
 		g_set_error (error,
 			     BRASERO_BURN_ERROR,
@@ -303,12 +323,82 @@ brasero_mkisofs_base_write_graft (BraseroMkisofsBase *base,
 		return BRASERO_BURN_ERR;
 	}
 
-	result = _write_line (base->grafts_fd, graft_point, error);
+	result = _write_line (base, graft_point, error);
 	g_free (graft_point);
-	if (result != BRASERO_BURN_OK)
-		return result;
+	return result;
+}
 
-	return BRASERO_BURN_OK;
+static BraseroBurnResult
+brasero_mkisofs_base_write_expanded (BraseroMkisofsBase *base,
+				     const gchar *path,
+				     const gchar *disc_path,
+				     GError **error)
+{
+	BraseroBurnResult result;
+	const gchar *name;
+	GError *dir_error = NULL;
+	GDir *dir;
+
+	/* Only directories with excluded descendants need to be expanded */
+	if (!g_hash_table_lookup (base->excluded_parents, path)
+	||  !g_file_test (path, G_FILE_TEST_IS_DIR)
+	||   g_file_test (path, G_FILE_TEST_IS_SYMLINK))
+		return brasero_mkisofs_base_write_graft_point (base, path, disc_path, error);
+
+	dir = g_dir_open (path, 0, &dir_error);
+	if (!dir) {
+		BRASERO_BURN_LOG ("Directory could not be opened %s", dir_error->message);
+		g_propagate_error (error, dir_error);
+		return BRASERO_BURN_ERR;
+	}
+
+	/* The directory itself */
+	result = brasero_mkisofs_base_write_graft_point (base, base->emptydir, disc_path, error);
+	while (result == BRASERO_BURN_OK && (name = g_dir_read_name (dir))) {
+		gchar *child_disc_path;
+		gchar *child_path;
+
+		child_path = g_build_filename (path, name, NULL);
+		if (g_hash_table_lookup (base->excluded, child_path)) {
+			g_free (child_path);
+			continue;
+		}
+
+		child_disc_path = g_build_filename (disc_path, name, NULL);
+		result = brasero_mkisofs_base_write_expanded (base,
+							      child_path,
+							      child_disc_path,
+							      error);
+		g_free (child_disc_path);
+		g_free (child_path);
+	}
+	g_dir_close (dir);
+
+	return result;
+}
+
+static BraseroBurnResult
+brasero_mkisofs_base_write_graft (BraseroMkisofsBase *base,
+				  const gchar *uri,
+				  const gchar *disc_path,
+				  GError **error)
+{
+	BraseroBurnResult result;
+	gchar *path;
+
+	if (!disc_path)
+		return brasero_mkisofs_base_write_graft_point (base, uri, disc_path, error);
+
+	path = brasero_mkisofs_base_get_local_path (uri);
+	if (!path)
+		return brasero_mkisofs_base_write_graft_point (base, uri, disc_path, error);
+
+	while (strlen (path) > 1 && g_str_has_suffix (path, G_DIR_SEPARATOR_S))
+		path [strlen (path) - 1] = '\0';
+
+	result = brasero_mkisofs_base_write_expanded (base, path, disc_path, error);
+	g_free (path);
+	return result;
 }
 
 static gboolean
@@ -415,7 +505,7 @@ brasero_mkisofs_base_empty_directory (BraseroMkisofsBase *base,
 
 	/* Special case for uri = NULL; that is treated as if it were a directory */
 	graft_point = _build_graft_point (base->emptydir, disc_path);
-	result = _write_line (base->grafts_fd, graft_point, error);
+	result = _write_line (base, graft_point, error);
 	g_free (graft_point);
 
 	return result;
@@ -560,10 +650,8 @@ brasero_mkisofs_base_write_to_files (GSList *grafts,
 				     const gchar *emptydir,
 				     const gchar *videodir,
 				     const gchar *grafts_path,
-				     const gchar *excluded_path,
 				     GError **error)
 {
-	gchar *uri;
 	BraseroMkisofsBase base;
 	BraseroBurnResult result;
 
@@ -585,16 +673,9 @@ brasero_mkisofs_base_write_to_files (GSList *grafts,
 		return BRASERO_BURN_ERR;
 	}
 
-	base.excluded_fd = open (excluded_path, O_WRONLY|O_TRUNC|O_EXCL);
-	if (base.excluded_fd == -1) {
-		close (base.excluded_fd);
-		g_set_error (error,
-			     BRASERO_BURN_ERROR,
-			     BRASERO_BURN_ERROR_GENERAL,
-			     "%s",
-			     g_strerror (errno));
-		return BRASERO_BURN_ERR;
-	}
+	/* NOTE: no exclusion list is written; the graft list does not need
+	 * any exclusion. */
+	base.buffer = g_string_sized_new (BRASERO_MKISOFS_BUFFER_SIZE);
 
 	base.use_joliet = use_joliet;
 	base.emptydir = emptydir;
@@ -604,14 +685,33 @@ brasero_mkisofs_base_write_to_files (GSList *grafts,
 					     g_str_equal,
 					     NULL,
 					    (GDestroyNotify) g_slist_free);
+	base.excluded = g_hash_table_new_full (g_str_hash,
+					       g_str_equal,
+					       g_free,
+					       NULL);
+	base.excluded_parents = g_hash_table_new_full (g_str_hash,
+						       g_str_equal,
+						       g_free,
+						       NULL);
+
+	/* the excluded paths are needed to expand the grafts */
+	for (; excluded; excluded = excluded->next) {
+		const gchar *uri;
 
-	/* we analyse the graft points:
-	 * first add graft points and excluded. At the same time create a hash 
-	 * table in which key = uri and value = graft points, a list of all
-	 * the uris that have been excluded.
-	 * Once finished, for each excluded use the hash to see if there are not
-	 * other paths at which the excluded uri must appear. If so, create an
-	 * explicit graft point. */
+		uri = excluded->data;
+		if (!uri) {
+			BRASERO_BURN_LOG ("NULL URI");
+			continue;
+		}
+
+		result = brasero_mkisofs_base_add_excluded (&base, uri, error);
+		if (result != BRASERO_BURN_OK)
+			goto cleanup;
+	}
+
+	/* we analyse the graft points: create a hash table in which key = uri
+	 * and value = graft points. Directories holding excluded files are
+	 * expanded when the graft points are written. */
 	for (; grafts; grafts = grafts->next) {
 		BraseroGraftPt *graft;
 
@@ -642,7 +742,8 @@ brasero_mkisofs_base_write_to_files (GSList *grafts,
 			     BRASERO_BURN_ERROR,
 			     BRASERO_BURN_ERROR_GENERAL,
 			     _("VIDEO_TS directory is missing or invalid"));
-		return BRASERO_BURN_ERR;
+		result = BRASERO_BURN_ERR;
+		goto cleanup;
 	}
 
 	/* write the grafts list */
@@ -650,20 +751,9 @@ brasero_mkisofs_base_write_to_files (GSList *grafts,
 	if (result != BRASERO_BURN_OK)
 		goto cleanup;
 
-	/* write the global excluded files list */
-	for (; excluded; excluded = excluded->next) {
-		uri = excluded->data;
-		if (!uri) {
-			BRASERO_BURN_LOG ("NULL URI");
-			continue;
-		}
-
-		result = brasero_mkisofs_base_write_excluded (&base,
-							      uri,
-							      error);
-		if (result != BRASERO_BURN_OK)
-			goto cleanup;
-	}
+	result = brasero_mkisofs_base_flush (&base, error);
+	if (result != BRASERO_BURN_OK)
+		goto cleanup;
 
 	brasero_mkisofs_base_clean (&base);
 	return BRASERO_BURN_OK;
@@ -46,7 +46,6 @@ brasero_mkisofs_base_write_to_files (GSList *grafts,
 				     const gchar *emptydir,
 				     const gchar *videodir,
 				     const gchar *grafts_path,
-				     const gchar *excluded_path,
 				     GError **error);
 
 G_END_DECLS
@@ -359,11 +359,17 @@ brasero_plugin_manager_init (BraseroPluginManager *self)
 {
 	GDir *directory;
 	const gchar *name;
+	const gchar *plugin_dir;
 	GError *error = NULL;
 	BraseroPluginManagerPrivate *priv;
 
 	priv = BRASERO_PLUGIN_MANAGER_PRIVATE (self);
 
+	/* Allows to run uninstalled (the tests do) */
+	plugin_dir = g_getenv ("BRASERO_PLUGIN_DIR");
+	if (!plugin_dir)
+		plugin_dir = BRASERO_PLUGIN_DIRECTORY;
+
 	priv->settings = g_settings_new (BRASERO_SCHEMA_CONFIG);
 	g_signal_connect (priv->settings,
 	                  "changed",
@@ -371,8 +377,8 @@ brasero_plugin_manager_init (BraseroPluginManager *self)
 	                  self);
 
 	/* open the plugin directory */
-	BRASERO_BURN_LOG ("opening plugin directory %s", BRASERO_PLUGIN_DIRECTORY);
-	directory = g_dir_open (BRASERO_PLUGIN_DIRECTORY, 0, &error);
+	BRASERO_BURN_LOG ("opening plugin directory %s", plugin_dir);
+	directory = g_dir_open (plugin_dir, 0, &error);
 	if (!directory) {
 		if (error) {
 			BRASERO_BURN_LOG ("Error opening plugin directory %s", error->message);
@@ -392,7 +398,7 @@ brasero_plugin_manager_init (BraseroPluginManager *self)
 		if (!g_str_has_suffix (name, G_MODULE_SUFFIX))
 			continue;
 
-		path = g_module_build_path (BRASERO_PLUGIN_DIRECTORY, name);
+		path = g_module_build_path (plugin_dir, name);
 		BRASERO_BURN_LOG ("loading %s", path);
 
 		handle = g_module_open (path, 0);
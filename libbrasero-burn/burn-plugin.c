@@ -122,6 +122,7 @@ struct _BraseroPluginPrivate
 	BraseroPluginProcessFlag process_flags;
 
 	guint compulsory:1;
+	guint accept_remote_files:1;
 };
 
 static const gchar *default_icon = "gtk-cdrom";
@@ -1027,6 +1028,25 @@ brasero_plugin_set_process_flags (BraseroPlugin *plugin,
 	priv->process_flags = flags;
 }
 
+void
+brasero_plugin_set_accept_remote_files (BraseroPlugin *plugin,
+					gboolean accept)
+{
+	BraseroPluginPrivate *priv;
+
+	priv = BRASERO_PLUGIN_PRIVATE (plugin);
+	priv->accept_remote_files = accept;
+}
+
+gboolean
+brasero_plugin_get_accept_remote_files (BraseroPlugin *plugin)
+{
+	BraseroPluginPrivate *priv;
+
+	priv = BRASERO_PLUGIN_PRIVATE (plugin);
+	return priv->accept_remote_files;
+}
+
 gboolean
 brasero_plugin_get_process_flags (BraseroPlugin *plugin,
 				  BraseroPluginProcessFlag *flags)
@@ -33,6 +33,8 @@
 #endif
 
 #include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
 #include <sys/wait.h>
 #include <signal.h>
 #include <unistd.h>
@@ -284,12 +286,17 @@ static gboolean
 brasero_process_watch_child (gpointer data)
 {
 	int status;
+	struct rusage usage;
 	BraseroBurnResult result;
 	BraseroProcessPrivate *priv = BRASERO_PROCESS_PRIVATE (data);
 
-	if (waitpid (priv->pid, &status, WNOHANG) <= 0)
+	/* wait4 () rather than waitpid () to know how much memory that very
+	 * process used; RUSAGE_CHILDREN only gives the highest ever */
+	if (wait4 (priv->pid, &status, WNOHANG, &usage) <= 0)
 		return TRUE;
 
+	brasero_job_set_child_usage (BRASERO_JOB (data), usage.ru_maxrss);
+
 	/* store the return value it will be checked only if no 
 	 * brasero_job_finished/_error is called before the pipes are closed so
 	 * as to let plugins read stderr / stdout till the end and set a better
@@ -494,7 +501,10 @@ brasero_process_read_stderr (GIOChannel *source,
 		 * need to reap our children by ourselves g_child_watch_add
 		 * doesn't work well with multiple processes. regularly poll
 		 * with waitpid ()*/
-		priv->watch = g_timeout_add (500, brasero_process_watch_child, process);
+		priv->watch = brasero_burn_timeout_add (brasero_job_get_context (BRASERO_JOB (process)),
+						       500,
+						       brasero_process_watch_child,
+						       process);
 	}
 	return FALSE;
 }
@@ -539,7 +549,10 @@ brasero_process_read_stdout (GIOChannel *source,
 		 * need to reap our children by ourselves g_child_watch_add
 		 * doesn't work well with multiple processes. regularly poll
 		 * with waitpid ()*/
-		priv->watch = g_timeout_add (500, brasero_process_watch_child, process);
+		priv->watch = brasero_burn_timeout_add (brasero_job_get_context (BRASERO_JOB (process)),
+						       500,
+						       brasero_process_watch_child,
+						       process);
 	}
 
 	return FALSE;
@@ -564,10 +577,10 @@ brasero_process_setup_channel (BraseroProcess *process,
 				g_io_channel_get_flags (channel) | G_IO_FLAG_NONBLOCK,
 				NULL);
 	g_io_channel_set_encoding (channel, NULL, NULL);
-	*watch = g_io_add_watch (channel,
-				(G_IO_IN | G_IO_HUP | G_IO_ERR | G_IO_NVAL),
-				 function,
-				 process);
+	*watch = brasero_burn_source_attach (brasero_job_get_context (BRASERO_JOB (process)),
+					     g_io_create_watch (channel, (G_IO_IN | G_IO_HUP | G_IO_ERR | G_IO_NVAL)),
+					     (GSourceFunc) function,
+					     process);
 
 	g_io_channel_set_close_on_unref (channel, TRUE);
 	return channel;
@@ -679,7 +692,7 @@ brasero_process_stop (BraseroJob *job,
 		 * that means that we were cancelled or
 		 * that we decided to stop ourselves so
 		 * don't check the returned value */
-		g_source_remove (priv->watch);
+		brasero_job_source_remove (BRASERO_JOB (process), priv->watch);
 		priv->watch = 0;
 	}
 
@@ -711,7 +724,7 @@ brasero_process_stop (BraseroJob *job,
 
 	/* read every pending data and close the pipes */
 	if (priv->io_out) {
-		g_source_remove (priv->io_out);
+		brasero_job_source_remove (BRASERO_JOB (process), priv->io_out);
 		priv->io_out = 0;
 	}
 
@@ -749,7 +762,7 @@ brasero_process_stop (BraseroJob *job,
 	}
 
 	if (priv->io_err) {
-		g_source_remove (priv->io_err);
+		brasero_job_source_remove (BRASERO_JOB (process), priv->io_err);
 		priv->io_err = 0;
 	}
 
@@ -824,12 +837,12 @@ brasero_process_finalize (GObject *object)
 	BraseroProcessPrivate *priv = BRASERO_PROCESS_PRIVATE (object);
 
 	if (priv->watch) {
-		g_source_remove (priv->watch);
+		brasero_job_source_remove (BRASERO_JOB (object), priv->watch);
 		priv->watch = 0;
 	}
 
 	if (priv->io_out) {
-		g_source_remove (priv->io_out);
+		brasero_job_source_remove (BRASERO_JOB (object), priv->io_out);
 		priv->io_out = 0;
 	}
 
@@ -844,7 +857,7 @@ brasero_process_finalize (GObject *object)
 	}
 
 	if (priv->io_err) {
-		g_source_remove (priv->io_err);
+		brasero_job_source_remove (BRASERO_JOB (object), priv->io_err);
 		priv->io_err = 0;
 	}
 
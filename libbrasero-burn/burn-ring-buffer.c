@@ -0,0 +1,419 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Libbrasero-burn
+ * Copyright (C) Philippe Rouquier 2005-2009 <bonfire-app@wanadoo.fr>
+ *
+ * Libbrasero-burn is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The Libbrasero-burn authors hereby grant permission for non-GPL compatible
+ * GStreamer plugins to be used and distributed together with GStreamer
+ * and Libbrasero-burn. This permission is above and beyond the permissions granted
+ * by the GPL license by which Libbrasero-burn is covered. If you modify this code
+ * you may extend this exception to your version of the code, but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version.
+ * 
+ * Libbrasero-burn is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <glib.h>
+#include <glib/gi18n-lib.h>
+
+#include "brasero-error.h"
+#include "burn-basics.h"
+#include "burn-debug.h"
+#include "burn-ring-buffer.h"
+
+struct _BraseroRingBuffer {
+	gchar *buffer;
+	gsize size;
+	gsize prefill;
+
+	GThread *thread;
+
+	/* read end of the pipe the reader writes to */
+	int in;
+
+	/* write end of the pipe the recorder reads from */
+	int out;
+
+	/* We keep a copy of the read end of the recorder pipe opened so that
+	 * writing never raises SIGPIPE if the recorder goes away */
+	int spare;
+
+	gint cancel;
+
+	/* protects everything below; updated by the thread */
+	GMutex *lock;
+	gsize fill;
+	guint64 bytes_in;
+	guint64 bytes_out;
+	gint64 first_in;
+	gint64 last_in;
+	gint64 first_out;
+	gint64 last_out;
+	guint underruns;
+};
+
+static void
+brasero_ring_buffer_account (BraseroRingBuffer *ring,
+			     gsize fill,
+			     gssize read_bytes,
+			     gssize written_bytes)
+{
+	gint64 now;
+
+	now = g_get_monotonic_time ();
+
+	g_mutex_lock (ring->lock);
+	ring->fill = fill;
+
+	if (read_bytes > 0) {
+		if (!ring->bytes_in)
+			ring->first_in = now;
+
+		ring->bytes_in += read_bytes;
+		ring->last_in = now;
+	}
+
+	if (written_bytes > 0) {
+		if (!ring->bytes_out)
+			ring->first_out = now;
+
+		ring->bytes_out += written_bytes;
+		ring->last_out = now;
+	}
+	g_mutex_unlock (ring->lock);
+}
+
+static gpointer
+brasero_ring_buffer_thread (gpointer data)
+{
+	BraseroRingBuffer *ring = data;
+	gboolean primed = FALSE;
+	gboolean empty = FALSE;
+	gboolean eof = FALSE;
+	gsize start = 0;
+	gsize fill = 0;
+
+	while (!g_atomic_int_get (&ring->cancel)) {
+		struct pollfd pfd [2];
+		gssize written = 0;
+		gssize bytes = 0;
+		int in_index = -1;
+		int out_index = -1;
+		int nfds = 0;
+		int res;
+
+		if (eof && !fill)
+			break;
+
+		if (!eof && fill < ring->size) {
+			pfd [nfds].fd = ring->in;
+			pfd [nfds].events = POLLIN;
+			pfd [nfds].revents = 0;
+			in_index = nfds ++;
+		}
+
+		if (primed && fill) {
+			pfd [nfds].fd = ring->out;
+			pfd [nfds].events = POLLOUT;
+			pfd [nfds].revents = 0;
+			out_index = nfds ++;
+		}
+
+		res = poll (pfd, nfds, 250);
+		if (res < 0) {
+			if (errno == EINTR)
+				continue;
+
+			BRASERO_BURN_LOG ("Ring buffer could not poll (%s)", g_strerror (errno));
+			break;
+		}
+
+		if (!res)
+			continue;
+
+		if (in_index >= 0 && pfd [in_index].revents) {
+			gsize end;
+
+			/* only fill the contiguous free space after the data */
+			end = (start + fill) % ring->size;
+			bytes = read (ring->in,
+				      ring->buffer + end,
+				      MIN (ring->size - fill, ring->size - end));
+			if (bytes < 0) {
+				if (errno != EAGAIN && errno != EINTR) {
+					BRASERO_BURN_LOG ("Ring buffer could not read (%s)", g_strerror (errno));
+					break;
+				}
+				bytes = 0;
+			}
+			else if (!bytes) {
+				BRASERO_BURN_LOG ("Ring buffer reached the end of the source");
+				eof = TRUE;
+			}
+			else
+				fill += bytes;
+		}
+
+		if (out_index >= 0 && pfd [out_index].revents) {
+			written = write (ring->out,
+					 ring->buffer + start,
+					 MIN (fill, ring->size - start));
+			if (written < 0) {
+				if (errno != EAGAIN && errno != EINTR) {
+					BRASERO_BURN_LOG ("Ring buffer could not write (%s)", g_strerror (errno));
+					break;
+				}
+				written = 0;
+			}
+			else {
+				start = (start + written) % ring->size;
+				fill -= written;
+			}
+		}
+
+		if (!primed && (eof || fill >= ring->prefill)) {
+			BRASERO_BURN_LOG ("Ring buffer primed with %" G_GSIZE_FORMAT " bytes", fill);
+			primed = TRUE;
+		}
+
+		/* The reader could not keep up with the recorder */
+		if (primed && !eof && !fill) {
+			if (!empty) {
+				empty = TRUE;
+				g_mutex_lock (ring->lock);
+				ring->underruns ++;
+				g_mutex_unlock (ring->lock);
+			}
+		}
+		else
+			empty = FALSE;
+
+		brasero_ring_buffer_account (ring, fill, bytes, written);
+	}
+
+	/* Closing our end lets the recorder know there is no more data */
+	close (ring->out);
+	ring->out = -1;
+	return NULL;
+}
+
+static void
+brasero_ring_buffer_stop (BraseroRingBuffer *ring)
+{
+	if (ring->thread) {
+		g_atomic_int_set (&ring->cancel, 1);
+		g_thread_join (ring->thread);
+		ring->thread = NULL;
+		g_atomic_int_set (&ring->cancel, 0);
+	}
+
+	if (ring->in >= 0) {
+		close (ring->in);
+		ring->in = -1;
+	}
+
+	if (ring->out >= 0) {
+		close (ring->out);
+		ring->out = -1;
+	}
+
+	if (ring->spare >= 0) {
+		close (ring->spare);
+		ring->spare = -1;
+	}
+}
+
+static void
+brasero_ring_buffer_log (BraseroRingBuffer *ring)
+{
+	guint64 in_rate = 0;
+	guint64 out_rate = 0;
+
+	if (!ring->bytes_in && !ring->bytes_out)
+		return;
+
+	brasero_ring_buffer_get_status (ring, NULL, &in_rate, &out_rate);
+	BRASERO_BURN_LOG ("Ring buffer read %" G_GUINT64_FORMAT " bytes at %" G_GUINT64_FORMAT " KiB/s and wrote %" G_GUINT64_FORMAT " bytes at %" G_GUINT64_FORMAT " KiB/s (%i underruns)",
+			  ring->bytes_in,
+			  in_rate / 1024,
+			  ring->bytes_out,
+			  out_rate / 1024,
+			  ring->underruns);
+}
+
+/**
+ * Sets up the two pipes going through the ring buffer and starts feeding
+ * the recorder. @in is the read end for the recorder and @out the write end
+ * for the reader. Both are owned by the caller.
+ */
+
+gboolean
+brasero_ring_buffer_open (BraseroRingBuffer *ring,
+			  int *in,
+			  int *out,
+			  GError **error)
+{
+	int reader [2];
+	int recorder [2];
+
+	/* The jobs may be restarted; in this case start from scratch */
+	brasero_ring_buffer_stop (ring);
+	brasero_ring_buffer_log (ring);
+
+	ring->fill = 0;
+	ring->bytes_in = 0;
+	ring->bytes_out = 0;
+	ring->underruns = 0;
+
+	if (pipe (reader)) {
+		int errsv = errno;
+
+		BRASERO_BURN_LOG ("A pipe couldn't be created");
+		g_set_error (error,
+			     BRASERO_BURN_ERROR,
+			     BRASERO_BURN_ERROR_GENERAL,
+			     _("An internal error occurred (%s)"),
+			     g_strerror (errsv));
+		return FALSE;
+	}
+
+	if (pipe (recorder)) {
+		int errsv = errno;
+
+		close (reader [0]);
+		close (reader [1]);
+
+		BRASERO_BURN_LOG ("A pipe couldn't be created");
+		g_set_error (error,
+			     BRASERO_BURN_ERROR,
+			     BRASERO_BURN_ERROR_GENERAL,
+			     _("An internal error occurred (%s)"),
+			     g_strerror (errsv));
+		return FALSE;
+	}
+
+	/* Neither process must inherit our ends otherwise the recorder would
+	 * never see the end of the data */
+	fcntl (reader [0], F_SETFD, FD_CLOEXEC);
+	fcntl (reader [0], F_SETFL, fcntl (reader [0], F_GETFL) | O_NONBLOCK);
+	fcntl (recorder [1], F_SETFD, FD_CLOEXEC);
+	fcntl (recorder [1], F_SETFL, fcntl (recorder [1], F_GETFL) | O_NONBLOCK);
+
+	ring->in = reader [0];
+	ring->out = recorder [1];
+	ring->spare = dup (recorder [0]);
+	if (ring->spare >= 0)
+		fcntl (ring->spare, F_SETFD, FD_CLOEXEC);
+
+	ring->thread = g_thread_create (brasero_ring_buffer_thread,
+					ring,
+					TRUE,
+					error);
+	if (!ring->thread) {
+		brasero_ring_buffer_stop (ring);
+		close (reader [1]);
+		close (recorder [0]);
+		return FALSE;
+	}
+
+	BRASERO_BURN_LOG ("Ring buffer of %" G_GSIZE_FORMAT " bytes started (prefill %" G_GSIZE_FORMAT ")",
+			  ring->size,
+			  ring->prefill);
+
+	*in = recorder [0];
+	*out = reader [1];
+	return TRUE;
+}
+
+/**
+ * Gives how full the buffer is (in %) and the average rates (in B/s) at
+ * which the reader fed it and the recorder drained it.
+ */
+
+void
+brasero_ring_buffer_get_status (BraseroRingBuffer *ring,
+				gint *fill,
+				guint64 *in_rate,
+				guint64 *out_rate)
+{
+	g_mutex_lock (ring->lock);
+
+	if (fill)
+		*fill = (gint) ((guint64) ring->fill * 100 / ring->size);
+
+	if (in_rate) {
+		if (ring->last_in > ring->first_in)
+			*in_rate = ring->bytes_in * G_USEC_PER_SEC / (ring->last_in - ring->first_in);
+		else
+			*in_rate = 0;
+	}
+
+	if (out_rate) {
+		if (ring->last_out > ring->first_out)
+			*out_rate = ring->bytes_out * G_USEC_PER_SEC / (ring->last_out - ring->first_out);
+		else
+			*out_rate = 0;
+	}
+
+	g_mutex_unlock (ring->lock);
+}
+
+BraseroRingBuffer *
+brasero_ring_buffer_new (gsize size,
+			 gsize prefill)
+{
+	BraseroRingBuffer *ring;
+
+	ring = g_new0 (BraseroRingBuffer, 1);
+	ring->buffer = g_try_malloc (size);
+	if (!ring->buffer) {
+		BRASERO_BURN_LOG ("Ring buffer of %" G_GSIZE_FORMAT " bytes could not be allocated", size);
+		g_free (ring);
+		return NULL;
+	}
+
+	ring->size = size;
+	ring->prefill = MIN (prefill, size);
+	ring->lock = g_mutex_new ();
+	ring->in = -1;
+	ring->out = -1;
+	ring->spare = -1;
+	return ring;
+}
+
+void
+brasero_ring_buffer_free (BraseroRingBuffer *ring)
+{
+	brasero_ring_buffer_stop (ring);
+	brasero_ring_buffer_log (ring);
+
+	g_mutex_free (ring->lock);
+	g_free (ring->buffer);
+	g_free (ring);
+}
@@ -0,0 +1,69 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Libbrasero-burn
+ * Copyright (C) Philippe Rouquier 2005-2009 <bonfire-app@wanadoo.fr>
+ *
+ * Libbrasero-burn is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The Libbrasero-burn authors hereby grant permission for non-GPL compatible
+ * GStreamer plugins to be used and distributed together with GStreamer
+ * and Libbrasero-burn. This permission is above and beyond the permissions granted
+ * by the GPL license by which Libbrasero-burn is covered. If you modify this code
+ * you may extend this exception to your version of the code, but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version.
+ * 
+ * Libbrasero-burn is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef _BURN_RING_BUFFER_H_
+#define _BURN_RING_BUFFER_H_
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/**
+ * Sits between a reader and a recorder when a disc is copied on the fly. All
+ * the data goes through a large buffer in memory which is filled before the
+ * recorder gets anything so that the bursts and stalls of an optical reader
+ * (retries, spin-up) do not starve the recorder.
+ */
+
+typedef struct _BraseroRingBuffer BraseroRingBuffer;
+
+BraseroRingBuffer *
+brasero_ring_buffer_new (gsize size,
+			 gsize prefill);
+
+void
+brasero_ring_buffer_free (BraseroRingBuffer *ring);
+
+gboolean
+brasero_ring_buffer_open (BraseroRingBuffer *ring,
+			  int *in,
+			  int *out,
+			  GError **error);
+
+void
+brasero_ring_buffer_get_status (BraseroRingBuffer *ring,
+				gint *fill,
+				guint64 *in_rate,
+				guint64 *out_rate);
+
+G_END_DECLS
+
+#endif /* _BURN_RING_BUFFER_H_ */
@@ -0,0 +1,381 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Libbrasero-burn
+ * Copyright (C) Philippe Rouquier 2005-2009 <bonfire-app@wanadoo.fr>
+ *
+ * Libbrasero-burn is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The Libbrasero-burn authors hereby grant permission for non-GPL compatible
+ * GStreamer plugins to be used and distributed together with GStreamer
+ * and Libbrasero-burn. This permission is above and beyond the permissions granted
+ * by the GPL license by which Libbrasero-burn is covered. If you modify this code
+ * you may extend this exception to your version of the code, but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version.
+ * 
+ * Libbrasero-burn is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+#include <gio/gio.h>
+
+#include "burn-debug.h"
+#include "burn-speed-profile.h"
+
+#include "brasero-drive.h"
+#include "brasero-medium.h"
+
+/**
+ * The speed profile remembers how burns went for each combination of drive,
+ * type of medium and manufacturer of the medium (as pre-recorded on blank
+ * discs) and for each write speed: how many burns, how many failed while
+ * writing, how many could not be verified and the throughput that was
+ * actually sustained. It is then used to choose a default speed the next time
+ * the same kind of disc is inserted in the same drive.
+ */
+
+#define BRASERO_SCHEMA_CONFIG			"org.gnome.brasero.config"
+#define BRASERO_PROPS_ADAPTIVE_SPEED		"adaptive-speed"
+
+#define BRASERO_SPEED_PROFILE_BURNS		0
+#define BRASERO_SPEED_PROFILE_FAILURES		1
+#define BRASERO_SPEED_PROFILE_BAD_CHECKS	2
+#define BRASERO_SPEED_PROFILE_SUSTAINED		3
+#define BRASERO_SPEED_PROFILE_FIELDS		4
+
+/* Two measured throughputs closer than that (in percents) are considered the
+ * same; the lower speed is then preferred as it is less demanding. */
+#define BRASERO_SPEED_PROFILE_MARGIN		5
+
+/* Recorders ask for the profile from their own threads so the cached
+ * settings and the cached contents of the file are protected by a lock.
+ * The file is only read again after we wrote to it. */
+G_LOCK_DEFINE_STATIC (profile);
+static GSettings *profile_settings = NULL;
+static GKeyFile *profile_file = NULL;
+
+static gchar *
+brasero_speed_profile_get_path (void)
+{
+	return g_build_filename (g_get_user_data_dir (),
+				 "brasero",
+				 "speed-profile",
+				 NULL);
+}
+
+static gboolean
+brasero_speed_profile_enabled (void)
+{
+	gboolean enabled;
+
+	G_LOCK (profile);
+	if (!profile_settings)
+		profile_settings = g_settings_new (BRASERO_SCHEMA_CONFIG);
+
+	enabled = g_settings_get_boolean (profile_settings, BRASERO_PROPS_ADAPTIVE_SPEED);
+	G_UNLOCK (profile);
+
+	return enabled;
+}
+
+static GKeyFile *
+brasero_speed_profile_load (void)
+{
+	GKeyFile *file;
+	gchar *path;
+
+	path = brasero_speed_profile_get_path ();
+	file = g_key_file_new ();
+	g_key_file_load_from_file (file, path, G_KEY_FILE_NONE, NULL);
+	g_free (path);
+
+	return file;
+}
+
+static void
+brasero_speed_profile_save (GKeyFile *file)
+{
+	gchar *directory;
+	gchar *data;
+	gchar *path;
+	gsize size;
+
+	path = brasero_speed_profile_get_path ();
+	directory = g_path_get_dirname (path);
+	g_mkdir_with_parents (directory, 0700);
+	g_free (directory);
+
+	data = g_key_file_to_data (file, &size, NULL);
+	if (!g_file_set_contents (path, data, size, NULL))
+		BRASERO_BURN_LOG ("Impossible to save %s", path);
+
+	g_free (data);
+	g_free (path);
+}
+
+static gchar *
+brasero_speed_profile_get_rate_key (guint64 rate)
+{
+	return g_strdup_printf ("Rate%"G_GUINT64_FORMAT, rate);
+}
+
+static gint *
+brasero_speed_profile_lookup (GKeyFile *file,
+			      const gchar *key,
+			      guint64 rate)
+{
+	gchar *rate_key;
+	gint *values;
+	gsize length = 0;
+
+	rate_key = brasero_speed_profile_get_rate_key (rate);
+	values = g_key_file_get_integer_list (file, key, rate_key, &length, NULL);
+	g_free (rate_key);
+
+	if (values && length != BRASERO_SPEED_PROFILE_FIELDS) {
+		g_free (values);
+		return NULL;
+	}
+
+	return values;
+}
+
+/**
+ * brasero_speed_profile_get_key:
+ * @medium: a #BraseroMedium
+ *
+ * Returns the group under which the burns of media of the same type and the
+ * same manufacturer as @medium in its drive are recorded or NULL if the
+ * manufacturer of @medium is unknown.
+ **/
+
+gchar *
+brasero_speed_profile_get_key (BraseroMedium *medium)
+{
+	const gchar *manufacturer;
+	BraseroDrive *drive;
+	gchar *drive_name;
+	gchar *key;
+
+	g_return_val_if_fail (BRASERO_IS_MEDIUM (medium), NULL);
+
+	manufacturer = brasero_medium_get_manufacturer_id (medium);
+	if (!manufacturer)
+		return NULL;
+
+	drive = brasero_medium_get_drive (medium);
+	if (!drive)
+		return NULL;
+
+	drive_name = brasero_drive_get_display_name (drive);
+	key = g_strdup_printf ("%s|%s|%s",
+			       drive_name,
+			       brasero_medium_get_type_string (medium),
+			       manufacturer);
+	g_free (drive_name);
+
+	/* These are not allowed in group names */
+	g_strdelimit (key, "[]\n", '_');
+	return key;
+}
+
+/**
+ * brasero_speed_profile_get_rate:
+ * @medium: a #BraseroMedium
+ *
+ * Returns the write speed that worked best in the past for media of the same
+ * kind as @medium in the same drive or 0 if nothing is known about them.
+ * The best speed is the one that sustained the highest throughput among
+ * those that never failed; if all failed, it is the highest speed below all
+ * of them.
+ **/
+
+guint64
+brasero_speed_profile_get_rate (BraseroMedium *medium)
+{
+	guint64 lowest_failed = G_MAXUINT64;
+	guint64 best_throughput = 0;
+	guint64 best = 0;
+	guint64 *speeds;
+	GKeyFile *file;
+	gboolean known;
+	gchar *key;
+	guint i;
+
+	if (!brasero_speed_profile_enabled ())
+		return 0;
+
+	key = brasero_speed_profile_get_key (medium);
+	if (!key)
+		return 0;
+
+	speeds = brasero_medium_get_write_speeds (medium);
+	if (!speeds) {
+		g_free (key);
+		return 0;
+	}
+
+	G_LOCK (profile);
+
+	if (!profile_file)
+		profile_file = brasero_speed_profile_load ();
+
+	file = profile_file;
+
+	known = FALSE;
+	for (i = 0; speeds [i] != 0; i ++) {
+		guint64 throughput;
+		gint *values;
+
+		values = brasero_speed_profile_lookup (file, key, speeds [i]);
+		if (!values)
+			continue;
+
+		known = TRUE;
+		if (values [BRASERO_SPEED_PROFILE_FAILURES]
+		||  values [BRASERO_SPEED_PROFILE_BAD_CHECKS]) {
+			lowest_failed = MIN (lowest_failed, speeds [i]);
+			g_free (values);
+			continue;
+		}
+
+		/* The throughput is stored in KiB/s */
+		throughput = (guint64) values [BRASERO_SPEED_PROFILE_SUSTAINED] * 1024;
+		if (!throughput)
+			throughput = speeds [i];
+
+		g_free (values);
+
+		if (throughput * 100 > best_throughput * (100 + BRASERO_SPEED_PROFILE_MARGIN)
+		|| (throughput * (100 + BRASERO_SPEED_PROFILE_MARGIN) >= best_throughput * 100
+		&&  speeds [i] < best)) {
+			best_throughput = throughput;
+			best = speeds [i];
+		}
+	}
+
+	G_UNLOCK (profile);
+
+	/* A speed that failed once is not tried again as long as another one
+	 * is known to work. */
+	if (!best && known) {
+		for (i = 0; speeds [i] != 0; i ++) {
+			if (speeds [i] < lowest_failed && speeds [i] > best)
+				best = speeds [i];
+		}
+
+		/* Even the lowest failed; stick to it nevertheless */
+		if (!best)
+			best = lowest_failed;
+	}
+
+	if (best)
+		BRASERO_BURN_LOG ("Speed profile for %s: %"G_GUINT64_FORMAT" B/s", key, best);
+
+	g_free (speeds);
+	g_free (key);
+	return best;
+}
+
+/**
+ * brasero_speed_profile_add:
+ * @key: a key returned by brasero_speed_profile_get_key ()
+ * @rate: the write speed that was used
+ * @sustained: the average throughput measured while writing or 0
+ * @outcome: a #BraseroSpeedOutcome
+ *
+ * Records the outcome of a burn at @rate.
+ **/
+
+void
+brasero_speed_profile_add (const gchar *key,
+			   guint64 rate,
+			   guint64 sustained,
+			   BraseroSpeedOutcome outcome)
+{
+	gint empty [BRASERO_SPEED_PROFILE_FIELDS] = { 0, };
+	GKeyFile *file;
+	gchar *rate_key;
+	gint *values;
+
+	g_return_if_fail (key != NULL);
+
+	if (!rate || !brasero_speed_profile_enabled ())
+		return;
+
+	G_LOCK (profile);
+
+	/* Start from what is on disc in case another instance wrote to it */
+	file = brasero_speed_profile_load ();
+	values = brasero_speed_profile_lookup (file, key, rate);
+	if (!values)
+		values = g_memdup (empty, sizeof (empty));
+
+	switch (outcome) {
+	case BRASERO_SPEED_OUTCOME_SUCCESS:
+		/* Keep a running average of the throughput of successful burns */
+		if (sustained) {
+			gint burns;
+
+			burns = values [BRASERO_SPEED_PROFILE_BURNS] -
+				values [BRASERO_SPEED_PROFILE_FAILURES];
+			burns = MAX (burns, 0);
+			values [BRASERO_SPEED_PROFILE_SUSTAINED] =
+				(values [BRASERO_SPEED_PROFILE_SUSTAINED] * burns + sustained / 1024) /
+				(burns + 1);
+		}
+		values [BRASERO_SPEED_PROFILE_BURNS] ++;
+		break;
+
+	case BRASERO_SPEED_OUTCOME_FAILURE:
+		values [BRASERO_SPEED_PROFILE_BURNS] ++;
+		values [BRASERO_SPEED_PROFILE_FAILURES] ++;
+		break;
+
+	case BRASERO_SPEED_OUTCOME_BAD_CHECK:
+		/* The burn itself was already counted as a success */
+		values [BRASERO_SPEED_PROFILE_BAD_CHECKS] ++;
+		break;
+	}
+
+	BRASERO_BURN_LOG ("Speed profile for %s at %"G_GUINT64_FORMAT" B/s: %i burns, %i failures, %i bad checks, %i KiB/s",
+			  key,
+			  rate,
+			  values [BRASERO_SPEED_PROFILE_BURNS],
+			  values [BRASERO_SPEED_PROFILE_FAILURES],
+			  values [BRASERO_SPEED_PROFILE_BAD_CHECKS],
+			  values [BRASERO_SPEED_PROFILE_SUSTAINED]);
+
+	rate_key = brasero_speed_profile_get_rate_key (rate);
+	g_key_file_set_integer_list (file, key, rate_key, values, BRASERO_SPEED_PROFILE_FIELDS);
+	g_free (rate_key);
+	g_free (values);
+
+	brasero_speed_profile_save (file);
+
+	/* This is now the up to date version */
+	if (profile_file)
+		g_key_file_free (profile_file);
+
+	profile_file = file;
+
+	G_UNLOCK (profile);
+}
@@ -32,8 +32,6 @@
 #  include <config.h>
 #endif
 
-#include <math.h>
-
 #include <glib.h>
 #include <glib-object.h>
 #include <glib/gi18n-lib.h>
@@ -56,11 +54,21 @@ struct _BraseroTaskCtxPrivate
 	BraseroTrack *current_track;
 	GSList *tracks;
 
-	/* used to poll for progress (every 0.5 sec) */
+	/* used to poll for progress (every 0.5 sec); these are only accessed
+	 * from the main loop and hold a snapshot of what jobs reported */
 	gdouble progress;
 	goffset track_bytes;
 	goffset session_bytes;
 
+	/* What jobs report, possibly from a thread and for each line of output
+	 * of a process. Writers make @seq odd while they update the values.
+	 * They are only sampled once per clock tick. */
+	volatile gint seq;
+	gint sampled_seq;
+	gdouble reported_progress;
+	goffset reported_written;
+	guint reported;
+
 	goffset size;
 	goffset blocks;
 
@@ -77,18 +85,32 @@ struct _BraseroTaskCtxPrivate
 	gdouble last_progress;
 
 	/* used for remaining time */
-	GSList *times;
+	volatile gint time_samples;
 	gdouble total_time;
 
 	/* used for rates that certain jobs are able to report */
 	guint64 rate;
 
+	/* buffer fill ratios (in %) that certain jobs are able to report */
+	gint fifo;
+	gint buffer;
+
+	/* peak RSS (in KiB) of the processes that jobs spawned and reaped */
+	glong children_maxrss;
+
 	/* the current action */
 	BraseroBurnAction current_action;
 	gchar *action_string;
 
 	guint dangerous;
 
+	/* set when the recorder follows the image being created */
+	BraseroImageFollower *output_follower;
+	BraseroImageFollower *input_follower;
+
+	/* set when a disc is copied on the fly */
+	BraseroRingBuffer *ring_buffer;
+
 	guint fake:1;
 	guint action_changed:1;
 	guint update_action_string:1;
@@ -104,6 +126,10 @@ G_DEFINE_TYPE (BraseroTaskCtx, brasero_task_ctx, G_TYPE_OBJECT);
 
 #define MAX_VALUE_AVERAGE	16
 
+#define BRASERO_TASK_CTX_REPORTED_PROGRESS	1
+#define BRASERO_TASK_CTX_REPORTED_WRITTEN	2
+#define BRASERO_TASK_CTX_REPORTED_SESSION	4
+
 enum _BraseroTaskCtxSignalType {
 	ACTION_CHANGED_SIGNAL,
 	PROGRESS_CHANGED_SIGNAL,
@@ -120,6 +146,40 @@ enum
 
 static GObjectClass* parent_class = NULL;
 
+static void
+brasero_task_ctx_report_begin (BraseroTaskCtxPrivate *priv)
+{
+	gint seq;
+
+	/* Wait for any other writer; that's only a few instructions */
+	do {
+		seq = g_atomic_int_get (&priv->seq);
+	} while ((seq & 1) || !g_atomic_int_compare_and_exchange (&priv->seq, seq, seq + 1));
+}
+
+static void
+brasero_task_ctx_report_end (BraseroTaskCtxPrivate *priv)
+{
+	g_atomic_int_inc (&priv->seq);
+}
+
+/**
+ * Forget what was reported so far (for example for a new track). Must be
+ * called from the main loop.
+ */
+
+static void
+brasero_task_ctx_clear_reported (BraseroTaskCtxPrivate *priv)
+{
+	brasero_task_ctx_report_begin (priv);
+	priv->reported_progress = -1.0;
+	priv->reported_written = -1;
+	priv->reported = 0;
+	brasero_task_ctx_report_end (priv);
+
+	priv->sampled_seq = g_atomic_int_get (&priv->seq);
+}
+
 void
 brasero_task_ctx_set_dangerous (BraseroTaskCtx *self, gboolean value)
 {
@@ -141,6 +201,67 @@ brasero_task_ctx_get_dangerous (BraseroTaskCtx *self)
 	return priv->dangerous;
 }
 
+void
+brasero_task_ctx_set_output_follower (BraseroTaskCtx *self,
+				      BraseroImageFollower *follower)
+{
+	BraseroTaskCtxPrivate *priv;
+
+	priv = BRASERO_TASK_CTX_PRIVATE (self);
+	priv->output_follower = follower;
+}
+
+BraseroImageFollower *
+brasero_task_ctx_get_output_follower (BraseroTaskCtx *self)
+{
+	BraseroTaskCtxPrivate *priv;
+
+	priv = BRASERO_TASK_CTX_PRIVATE (self);
+	return priv->output_follower;
+}
+
+void
+brasero_task_ctx_set_input_follower (BraseroTaskCtx *self,
+				     BraseroImageFollower *follower)
+{
+	BraseroTaskCtxPrivate *priv;
+
+	priv = BRASERO_TASK_CTX_PRIVATE (self);
+	priv->input_follower = follower;
+}
+
+BraseroImageFollower *
+brasero_task_ctx_get_input_follower (BraseroTaskCtx *self)
+{
+	BraseroTaskCtxPrivate *priv;
+
+	priv = BRASERO_TASK_CTX_PRIVATE (self);
+	return priv->input_follower;
+}
+
+void
+brasero_task_ctx_set_ring_buffer (BraseroTaskCtx *self,
+				  BraseroRingBuffer *ring)
+{
+	BraseroTaskCtxPrivate *priv;
+
+	priv = BRASERO_TASK_CTX_PRIVATE (self);
+
+	/* The status of the buffer is read from the main loop */
+	g_mutex_lock (priv->lock);
+	priv->ring_buffer = ring;
+	g_mutex_unlock (priv->lock);
+}
+
+BraseroRingBuffer *
+brasero_task_ctx_get_ring_buffer (BraseroTaskCtx *self)
+{
+	BraseroTaskCtxPrivate *priv;
+
+	priv = BRASERO_TASK_CTX_PRIVATE (self);
+	return priv->ring_buffer;
+}
+
 void
 brasero_task_ctx_reset (BraseroTaskCtx *self)
 {
@@ -177,16 +298,17 @@ brasero_task_ctx_reset (BraseroTaskCtx *self)
 	priv->track_bytes = -1;
 	priv->session_bytes = -1;
 	priv->written_changed = 0;
+	priv->fifo = -1;
+	priv->buffer = -1;
+	priv->children_maxrss = 0;
 
 	priv->current_elapsed = 0;
 	priv->last_written = 0;
 	priv->last_elapsed = 0;
 	priv->last_progress = 0;
 
-	if (priv->times) {
-		g_slist_free (priv->times);
-		priv->times = NULL;
-	}
+	brasero_task_ctx_clear_reported (priv);
+	g_atomic_int_set (&priv->time_samples, 0);
 
 	g_signal_emit (self,
 		       brasero_task_ctx_signals [PROGRESS_CHANGED_SIGNAL],
@@ -317,6 +439,7 @@ brasero_task_ctx_set_next_track (BraseroTaskCtx *self)
 	priv->track_bytes = 0;
 	priv->last_written = 0;
 	priv->progress = 0;
+	brasero_task_ctx_clear_reported (priv);
 
 	if (priv->current_track)
 		g_object_unref (priv->current_track);
@@ -437,51 +560,127 @@ brasero_task_ctx_start_progress (BraseroTaskCtx *self,
 	return BRASERO_BURN_OK;
 }
 
-static gdouble
-brasero_task_ctx_get_average (GSList **values, gdouble value)
+/**
+ * Takes one consistent snapshot of what jobs reported since the last clock
+ * tick and updates the values used to compute rates.
+ */
+
+static void
+brasero_task_ctx_sample (BraseroTaskCtx *self)
 {
-	const unsigned int scale = 10000;
-	unsigned int num = 0;
-	gdouble average;
-	gint32 int_value;
-	GSList *l;
-
-	if (value * scale < G_MAXINT)
-		int_value = (gint32) ceil (scale * value);
-	else if (value / scale < G_MAXINT)
-		int_value = (gint32) ceil (-1.0 * value / scale);
-	else
-		return value;
-		
-	*values = g_slist_prepend (*values, GINT_TO_POINTER (int_value));
+	BraseroTaskCtxPrivate *priv;
+	gdouble elapsed = 0.0;
+	gdouble progress;
+	goffset written;
+	guint reported;
+	gint seq;
 
-	average = 0;
-	for (l = *values; l; l = l->next) {
-		gdouble r = (gdouble) GPOINTER_TO_INT (l->data);
+	priv = BRASERO_TASK_CTX_PRIVATE (self);
 
-		if (r < 0)
-			r *= scale * -1.0;
-		else
-			r /= scale;
+	do {
+		seq = g_atomic_int_get (&priv->seq);
+		progress = priv->reported_progress;
+		written = priv->reported_written;
+		reported = priv->reported;
+	} while ((seq & 1) || g_atomic_int_get (&priv->seq) != seq);
+
+	if (seq == priv->sampled_seq)
+		return;
+
+	priv->sampled_seq = seq;
+
+	/* A session report must only reset session_bytes once. Clear it unless
+	 * a job reported something since the snapshot was taken; then it is
+	 * left for the next tick. */
+	if ((reported & BRASERO_TASK_CTX_REPORTED_SESSION)
+	&&  g_atomic_int_compare_and_exchange (&priv->seq, seq, seq + 1)) {
+		priv->reported &= ~BRASERO_TASK_CTX_REPORTED_SESSION;
+		brasero_task_ctx_report_end (priv);
+		priv->sampled_seq = seq + 2;
+	}
+
+	if (priv->timer)
+		elapsed = g_timer_elapsed (priv->timer, NULL);
 
-		average += r;
-		num++;
-		if (num == MAX_VALUE_AVERAGE && l->next)
-			l = g_slist_delete_link (l, l->next);
+	if (reported & BRASERO_TASK_CTX_REPORTED_WRITTEN) {
+		priv->written_changed = 1;
+
+		if (reported & BRASERO_TASK_CTX_REPORTED_SESSION)
+			priv->session_bytes = 0;
+
+		if (!priv->use_average_rate && elapsed > priv->current_elapsed) {
+			priv->last_written = priv->track_bytes;
+			priv->last_elapsed = priv->current_elapsed;
+			priv->current_elapsed = elapsed;
+		}
+
+		priv->track_bytes = written;
 	}
 
-	average /= num;
-	return average;
+	if (reported & BRASERO_TASK_CTX_REPORTED_PROGRESS) {
+		priv->progress_changed = 1;
+
+		/* here we prefer to use track written bytes instead of
+		 * progress. NOTE: usually plugins will return only one
+		 * information. */
+		if (!priv->use_average_rate
+		&&  !priv->last_written
+		&&   elapsed > priv->current_elapsed) {
+			priv->last_progress = priv->progress;
+			priv->last_elapsed = priv->current_elapsed;
+			priv->current_elapsed = elapsed;
+		}
+
+		if (priv->progress < progress)
+			priv->progress = progress;
+	}
+}
+
+/**
+ * The remaining time is smoothed here with a moving average of the estimated
+ * total time so that UIs can display it as is.
+ */
+
+static void
+brasero_task_ctx_update_total_time (BraseroTaskCtx *self)
+{
+	BraseroTaskCtxPrivate *priv;
+	gdouble total_time;
+	gdouble progress;
+	gdouble elapsed;
+	gint samples;
+
+	priv = BRASERO_TASK_CTX_PRIVATE (self);
+
+	if (!priv->timer)
+		return;
+
+	if (brasero_task_ctx_get_progress (self, &progress) != BRASERO_BURN_OK
+	||  progress <= 0.0)
+		return;
+
+	elapsed = g_timer_elapsed (priv->timer, NULL);
+	total_time = elapsed / progress;
+
+	samples = g_atomic_int_get (&priv->time_samples);
+	if (!samples)
+		priv->total_time = total_time;
+	else
+		priv->total_time += (total_time - priv->total_time) /
+				    (gdouble) MIN (samples + 1, MAX_VALUE_AVERAGE);
+
+	g_atomic_int_compare_and_exchange (&priv->time_samples, samples, samples + 1);
 }
 
 void
 brasero_task_ctx_report_progress (BraseroTaskCtx *self)
 {
 	BraseroTaskCtxPrivate *priv;
-	gdouble progress, elapsed;
 
 	priv = BRASERO_TASK_CTX_PRIVATE (self);
 
+	brasero_task_ctx_sample (self);
+
 	if (priv->action_changed) {
 		/* Give a last progress-changed signal
 		 * setting previous action as completely
@@ -511,11 +710,9 @@ brasero_task_ctx_report_progress (BraseroTaskCtx *self)
 			       0,
 			       priv->current_action);
 
+		/* this sets progress_changed so the new action
+		 * progress is reported just below */
 		brasero_task_ctx_reset_progress (self);
-		g_signal_emit (self,
-			       brasero_task_ctx_signals [PROGRESS_CHANGED_SIGNAL],
-			       0);
-
 		priv->action_changed = 0;
 	}
 	else if (priv->update_action_string) {
@@ -527,27 +724,12 @@ brasero_task_ctx_report_progress (BraseroTaskCtx *self)
 		priv->update_action_string = 0;
 	}
 
-	if (priv->timer) {
-		elapsed = g_timer_elapsed (priv->timer, NULL);
-		if (brasero_task_ctx_get_progress (self, &progress) == BRASERO_BURN_OK) {
-			gdouble total_time;
-
-			total_time = (gdouble) elapsed / (gdouble) progress;
-
-			g_mutex_lock (priv->lock);
-			priv->total_time = brasero_task_ctx_get_average (&priv->times,
-									 total_time);
-			g_mutex_unlock (priv->lock);
-		}
-	}
+	brasero_task_ctx_update_total_time (self);
 
-	if (priv->progress_changed) {
+	/* only one signal per clock tick whatever the number of values
+	 * the jobs reported in between */
+	if (priv->progress_changed || priv->written_changed) {
 		priv->progress_changed = 0;
-		g_signal_emit (self,
-			       brasero_task_ctx_signals [PROGRESS_CHANGED_SIGNAL],
-			       0);
-	}
-	else if (priv->written_changed) {
 		priv->written_changed = 0;
 		g_signal_emit (self,
 			       brasero_task_ctx_signals [PROGRESS_CHANGED_SIGNAL],
@@ -568,6 +750,39 @@ brasero_task_ctx_set_rate (BraseroTaskCtx *self,
 	return BRASERO_BURN_OK;
 }
 
+BraseroBurnResult
+brasero_task_ctx_set_buffer_fill (BraseroTaskCtx *self,
+				  gint fifo,
+				  gint buffer)
+{
+	BraseroTaskCtxPrivate *priv;
+
+	g_return_val_if_fail (BRASERO_IS_TASK_CTX (self), BRASERO_BURN_ERR);
+
+	priv = BRASERO_TASK_CTX_PRIVATE (self);
+	priv->fifo = fifo;
+	priv->buffer = buffer;
+	return BRASERO_BURN_OK;
+}
+
+/**
+ * Used by jobs whenever one of their processes is reaped; the task logs the
+ * highest peak RSS of all of them.
+ */
+
+BraseroBurnResult
+brasero_task_ctx_set_child_usage (BraseroTaskCtx *self,
+				  glong maxrss)
+{
+	BraseroTaskCtxPrivate *priv;
+
+	g_return_val_if_fail (BRASERO_IS_TASK_CTX (self), BRASERO_BURN_ERR);
+
+	priv = BRASERO_TASK_CTX_PRIVATE (self);
+	priv->children_maxrss = MAX (priv->children_maxrss, maxrss);
+	return BRASERO_BURN_OK;
+}
+
 /**
  * This is used by jobs that are imaging to tell what's going to be the output 
  * size for a particular track
@@ -604,34 +819,27 @@ brasero_task_ctx_set_output_size_for_current_track (BraseroTaskCtx *self,
 	return BRASERO_BURN_OK;
 }
 
+/**
+ * The following three can be called at any pace and from any thread; the
+ * values are only taken into account at the next clock tick.
+ */
+
 BraseroBurnResult
 brasero_task_ctx_set_written_track (BraseroTaskCtx *self,
 				    gint64 written)
 {
 	BraseroTaskCtxPrivate *priv;
-	gdouble elapsed = 0.0;
 
 	g_return_val_if_fail (BRASERO_IS_TASK_CTX (self), BRASERO_BURN_ERR);
 
 	priv = BRASERO_TASK_CTX_PRIVATE (self);
 
-	priv->written_changed = 1;
-
-	if (priv->use_average_rate) {
-		priv->track_bytes = written;
-		return BRASERO_BURN_OK;
-	}
-
-	if (priv->timer)
-		elapsed = g_timer_elapsed (priv->timer, NULL);
-
-	if ((elapsed - priv->last_elapsed) > 0.5) {
-		priv->last_written = priv->track_bytes;
-		priv->last_elapsed = priv->current_elapsed;
-		priv->current_elapsed = elapsed;
-	}
+	brasero_task_ctx_report_begin (priv);
+	priv->reported_written = written;
+	priv->reported |= BRASERO_TASK_CTX_REPORTED_WRITTEN;
+	priv->reported &= ~BRASERO_TASK_CTX_REPORTED_SESSION;
+	brasero_task_ctx_report_end (priv);
 
-	priv->track_bytes = written;
 	return BRASERO_BURN_OK;
 }
 
@@ -645,8 +853,13 @@ brasero_task_ctx_set_written_session (BraseroTaskCtx *self,
 
 	priv = BRASERO_TASK_CTX_PRIVATE (self);
 
-	priv->session_bytes = 0;
-	return brasero_task_ctx_set_written_track (self, written);
+	brasero_task_ctx_report_begin (priv);
+	priv->reported_written = written;
+	priv->reported |= BRASERO_TASK_CTX_REPORTED_WRITTEN|
+			  BRASERO_TASK_CTX_REPORTED_SESSION;
+	brasero_task_ctx_report_end (priv);
+
+	return BRASERO_BURN_OK;
 }
 
 BraseroBurnResult
@@ -654,41 +867,16 @@ brasero_task_ctx_set_progress (BraseroTaskCtx *self,
 			       gdouble progress)
 {
 	BraseroTaskCtxPrivate *priv;
-	gdouble elapsed;
 
 	g_return_val_if_fail (BRASERO_IS_TASK_CTX (self), BRASERO_BURN_ERR);
 
 	priv = BRASERO_TASK_CTX_PRIVATE (self);
 
-	priv->progress_changed = 1;
-
-	if (priv->use_average_rate) {
-		if (priv->progress < progress)
-			priv->progress = progress;
-
-		return BRASERO_BURN_OK;
-	}
-
-	/* here we prefer to use track written bytes instead of progress.
-	 * NOTE: usually plugins will return only one information. */
-	if (priv->last_written) {
-		if (priv->progress < progress)
-			priv->progress = progress;
-		return BRASERO_BURN_OK;
-	}
-
-	if (priv->timer) {
-		elapsed = g_timer_elapsed (priv->timer, NULL);
-
-		if ((elapsed - priv->last_elapsed) > 0.5) {
-			priv->last_progress = priv->progress;
-			priv->last_elapsed = priv->current_elapsed;
-			priv->current_elapsed = elapsed;
-		}
-	}
-
-	if (priv->progress < progress)
-		priv->progress = progress;
+	brasero_task_ctx_report_begin (priv);
+	if (priv->reported_progress < progress)
+		priv->reported_progress = progress;
+	priv->reported |= BRASERO_TASK_CTX_REPORTED_PROGRESS;
+	brasero_task_ctx_report_end (priv);
 
 	return BRASERO_BURN_OK;
 }
@@ -719,10 +907,8 @@ brasero_task_ctx_reset_progress (BraseroTaskCtx *self)
 	priv->last_elapsed = 0;
 	priv->last_progress = 0;
 
-	if (priv->times) {
-		g_slist_free (priv->times);
-		priv->times = NULL;
-	}
+	brasero_task_ctx_clear_reported (priv);
+	g_atomic_int_set (&priv->time_samples, 0);
 
 	return BRASERO_BURN_OK;
 }
@@ -759,10 +945,8 @@ brasero_task_ctx_set_current_action (BraseroTaskCtx *self,
 
 	priv->action_string = string ? g_strdup (string): NULL;
 
-	if (!force) {
-		g_slist_free (priv->times);
-		priv->times = NULL;
-	}
+	if (!force)
+		g_atomic_int_set (&priv->time_samples, 0);
 
 	g_mutex_unlock (priv->lock);
 
@@ -786,6 +970,64 @@ brasero_task_ctx_set_use_average (BraseroTaskCtx *self,
  * Used to retrieve the values for a given task
  */
 
+BraseroBurnResult
+brasero_task_ctx_get_buffer_fill (BraseroTaskCtx *self,
+				  gint *fifo,
+				  gint *buffer)
+{
+	BraseroTaskCtxPrivate *priv;
+
+	g_return_val_if_fail (BRASERO_IS_TASK_CTX (self), BRASERO_BURN_ERR);
+
+	priv = BRASERO_TASK_CTX_PRIVATE (self);
+
+	if (fifo)
+		*fifo = priv->fifo;
+	if (buffer)
+		*buffer = priv->buffer;
+
+	if (priv->fifo < 0 && priv->buffer < 0)
+		return BRASERO_BURN_NOT_SUPPORTED;
+
+	return BRASERO_BURN_OK;
+}
+
+BraseroBurnResult
+brasero_task_ctx_get_ring_buffer_status (BraseroTaskCtx *self,
+					 gint *fill,
+					 guint64 *in_rate,
+					 guint64 *out_rate)
+{
+	BraseroTaskCtxPrivate *priv;
+
+	g_return_val_if_fail (BRASERO_IS_TASK_CTX (self), BRASERO_BURN_ERR);
+
+	priv = BRASERO_TASK_CTX_PRIVATE (self);
+
+	g_mutex_lock (priv->lock);
+
+	if (!priv->ring_buffer) {
+		g_mutex_unlock (priv->lock);
+
+		if (fill)
+			*fill = -1;
+		if (in_rate)
+			*in_rate = 0;
+		if (out_rate)
+			*out_rate = 0;
+
+		return BRASERO_BURN_NOT_SUPPORTED;
+	}
+
+	brasero_ring_buffer_get_status (priv->ring_buffer,
+					fill,
+					in_rate,
+					out_rate);
+	g_mutex_unlock (priv->lock);
+
+	return BRASERO_BURN_OK;
+}
+
 BraseroBurnResult
 brasero_task_ctx_get_rate (BraseroTaskCtx *self,
 			   guint64 *rate)
@@ -846,22 +1088,18 @@ brasero_task_ctx_get_remaining_time (BraseroTaskCtx *self,
 {
 	BraseroTaskCtxPrivate *priv;
 	gdouble elapsed;
-	gint len;
 
 	g_return_val_if_fail (BRASERO_IS_TASK_CTX (self), BRASERO_BURN_ERR);
 	g_return_val_if_fail (remaining != NULL, BRASERO_BURN_ERR);
 
 	priv = BRASERO_TASK_CTX_PRIVATE (self);
 
-	g_mutex_lock (priv->lock);
-	len = g_slist_length (priv->times);
-	g_mutex_unlock (priv->lock);
-
-	if (len < MAX_VALUE_AVERAGE)
+	if (!priv->timer
+	||  g_atomic_int_get (&priv->time_samples) < MAX_VALUE_AVERAGE)
 		return BRASERO_BURN_NOT_READY;
 
 	elapsed = g_timer_elapsed (priv->timer, NULL);
-	*remaining = priv->total_time - elapsed;
+	*remaining = MAX (priv->total_time - elapsed, 0);
 
 	return BRASERO_BURN_OK;
 }
@@ -911,6 +1149,17 @@ brasero_task_ctx_get_written (BraseroTaskCtx *self,
 	return BRASERO_BURN_OK;
 }
 
+glong
+brasero_task_ctx_get_children_maxrss (BraseroTaskCtx *self)
+{
+	BraseroTaskCtxPrivate *priv;
+
+	g_return_val_if_fail (BRASERO_IS_TASK_CTX (self), 0);
+
+	priv = BRASERO_TASK_CTX_PRIVATE (self);
+	return priv->children_maxrss;
+}
+
 BraseroBurnResult
 brasero_task_ctx_get_current_action_string (BraseroTaskCtx *self,
 					    BraseroBurnAction action,
@@ -1013,7 +1262,8 @@ brasero_task_ctx_stop_progress (BraseroTaskCtx *self)
 
 	priv = BRASERO_TASK_CTX_PRIVATE (self);
 
-	/* one last report */
+	/* one last report with what was reported since the last tick */
+	brasero_task_ctx_sample (self);
 	g_signal_emit (self,
 		       brasero_task_ctx_signals [PROGRESS_CHANGED_SIGNAL],
 		       0);
@@ -1036,12 +1286,9 @@ brasero_task_ctx_stop_progress (BraseroTaskCtx *self)
 		priv->action_string = NULL;
 	}
 
-	if (priv->times) {
-		g_slist_free (priv->times);
-		priv->times = NULL;
-	}
-
 	g_mutex_unlock (priv->lock);
+
+	g_atomic_int_set (&priv->time_samples, 0);
 }
 
 static void
@@ -1051,6 +1298,10 @@ brasero_task_ctx_init (BraseroTaskCtx *object)
 
 	priv = BRASERO_TASK_CTX_PRIVATE (object);
 	priv->lock = g_mutex_new ();
+	priv->fifo = -1;
+	priv->buffer = -1;
+	priv->reported_progress = -1.0;
+	priv->reported_written = -1;
 }
 
 static void
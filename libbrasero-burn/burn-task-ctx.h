@@ -35,6 +35,8 @@
 
 #include "burn-basics.h"
 #include "brasero-session.h"
+#include "burn-image-follower.h"
+#include "burn-ring-buffer.h"
 
 G_BEGIN_DECLS
 
@@ -110,6 +112,37 @@ BraseroBurnResult
 brasero_task_ctx_get_current_track (BraseroTaskCtx *ctx,
 				    BraseroTrack **track);
 
+/**
+ * Used when a recorder follows the image an imager is still writing.
+ * The follower is not owned by the context.
+ */
+
+void
+brasero_task_ctx_set_output_follower (BraseroTaskCtx *ctx,
+				      BraseroImageFollower *follower);
+
+BraseroImageFollower *
+brasero_task_ctx_get_output_follower (BraseroTaskCtx *ctx);
+
+void
+brasero_task_ctx_set_input_follower (BraseroTaskCtx *ctx,
+				     BraseroImageFollower *follower);
+
+BraseroImageFollower *
+brasero_task_ctx_get_input_follower (BraseroTaskCtx *ctx);
+
+/**
+ * Used when a disc is copied on the fly to buffer the data between the
+ * reader and the recorder. The ring buffer is not owned by the context.
+ */
+
+void
+brasero_task_ctx_set_ring_buffer (BraseroTaskCtx *ctx,
+				  BraseroRingBuffer *ring);
+
+BraseroRingBuffer *
+brasero_task_ctx_get_ring_buffer (BraseroTaskCtx *ctx);
+
 /**
  * Used to give job results and tell when a job has finished
  */
@@ -151,6 +184,13 @@ brasero_task_ctx_stop_progress (BraseroTaskCtx *ctx);
 BraseroBurnResult
 brasero_task_ctx_set_rate (BraseroTaskCtx *ctx,
 			   gint64 rate);
+BraseroBurnResult
+brasero_task_ctx_set_buffer_fill (BraseroTaskCtx *ctx,
+				  gint fifo,
+				  gint buffer);
+BraseroBurnResult
+brasero_task_ctx_set_child_usage (BraseroTaskCtx *ctx,
+				  glong maxrss);
 
 BraseroBurnResult
 brasero_task_ctx_set_written_session (BraseroTaskCtx *ctx,
@@ -184,6 +224,15 @@ BraseroBurnResult
 brasero_task_ctx_get_rate (BraseroTaskCtx *ctx,
 			   guint64 *rate);
 BraseroBurnResult
+brasero_task_ctx_get_buffer_fill (BraseroTaskCtx *ctx,
+				  gint *fifo,
+				  gint *buffer);
+BraseroBurnResult
+brasero_task_ctx_get_ring_buffer_status (BraseroTaskCtx *ctx,
+					 gint *fill,
+					 guint64 *in_rate,
+					 guint64 *out_rate);
+BraseroBurnResult
 brasero_task_ctx_get_remaining_time (BraseroTaskCtx *ctx,
 				     long *remaining);
 BraseroBurnResult
@@ -193,6 +242,8 @@ brasero_task_ctx_get_session_output_size (BraseroTaskCtx *ctx,
 BraseroBurnResult
 brasero_task_ctx_get_written (BraseroTaskCtx *ctx,
 			      goffset *written);
+glong
+brasero_task_ctx_get_children_maxrss (BraseroTaskCtx *ctx);
 BraseroBurnResult
 brasero_task_ctx_get_current_action_string (BraseroTaskCtx *ctx,
 					    BraseroBurnAction action,
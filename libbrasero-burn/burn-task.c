@@ -32,6 +32,11 @@
 #  include <config.h>
 #endif
 
+#include <string.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
 #include <glib.h>
 #include <glib-object.h>
 #include <glib/gi18n-lib.h>
@@ -256,10 +261,11 @@ brasero_task_sleep (BraseroTask *self, guint sec)
 
 	BRASERO_BURN_LOG ("wait loop");
 
-	priv->loop = g_main_loop_new (NULL, FALSE);
-	priv->clock_id = g_timeout_add_seconds (sec,
-	                                        brasero_task_wakeup,
-	                                        self);
+	priv->loop = g_main_loop_new (brasero_burn_context_get_current (), FALSE);
+	priv->clock_id = brasero_burn_source_attach (NULL,
+						     g_timeout_source_new_seconds (sec),
+						     brasero_task_wakeup,
+						     self);
 
 	GDK_THREADS_LEAVE ();  
 	g_main_loop_run (priv->loop);
@@ -269,7 +275,7 @@ brasero_task_sleep (BraseroTask *self, guint sec)
 	priv->loop = NULL;
 
 	if (priv->clock_id) {
-		g_source_remove (priv->clock_id);
+		brasero_burn_source_remove (NULL, priv->clock_id);
 		priv->clock_id = 0;
 	}
 
@@ -344,6 +350,7 @@ brasero_task_stop (BraseroTask *task,
 		   BraseroBurnResult retval,
 		   GError *error)
 {
+	BraseroImageFollower *follower;
 	BraseroBurnResult result;
 	BraseroTaskPrivate *priv;
 
@@ -354,6 +361,11 @@ brasero_task_stop (BraseroTask *task,
 	 * Instead a job should return errors directly */
 	result = brasero_task_send_stop_signal (task, retval, &error);
 
+	/* A recorder may be following the image we were writing */
+	follower = brasero_task_ctx_get_output_follower (BRASERO_TASK_CTX (task));
+	if (follower)
+		brasero_image_follower_source_finished (follower, retval == BRASERO_BURN_OK);
+
 	priv->retval = retval;
 	priv->error = error;
 
@@ -430,11 +442,12 @@ brasero_task_run_loop (BraseroTask *self,
 
 	brasero_task_ctx_report_progress (BRASERO_TASK_CTX (self));
 
-	priv->clock_id = g_timeout_add (500,
-					brasero_task_clock_tick,
-					self);
+	priv->clock_id = brasero_burn_timeout_add (NULL,
+						   500,
+						   brasero_task_clock_tick,
+						   self);
 
-	priv->loop = g_main_loop_new (NULL, FALSE);
+	priv->loop = g_main_loop_new (brasero_burn_context_get_current (), FALSE);
 
 	BRASERO_BURN_LOG ("entering loop");
 
@@ -453,10 +466,14 @@ brasero_task_run_loop (BraseroTask *self,
 
 	/* stop all progress reporting thing */
 	if (priv->clock_id) {
-		g_source_remove (priv->clock_id);
+		brasero_burn_source_remove (NULL, priv->clock_id);
 		priv->clock_id = 0;
 	}
 
+	/* Progress is only sampled on clock ticks; a task shorter than a
+	 * tick would otherwise look like it never reported anything */
+	brasero_task_ctx_report_progress (BRASERO_TASK_CTX (self));
+
 	if (priv->retval == BRASERO_BURN_OK
 	&&  brasero_task_ctx_get_progress (BRASERO_TASK_CTX (self), NULL) == BRASERO_BURN_OK) {
 		brasero_task_ctx_set_progress (BRASERO_TASK_CTX (self), 1.0);
@@ -641,10 +658,115 @@ brasero_task_start (BraseroTask *self,
 	return result;
 }
 
+/**
+ * Throughput, CPU time and memory used by each task (imaging, recording,
+ * checksumming, ...) are logged so that regressions can be spotted in the
+ * debug output of real sessions and by "make bench". CPU time includes the
+ * children since most of the work is done by the backends.
+ * The peak RSS of brasero is the one since the process started (or since
+ * whoever runs it reset it, as "make bench" does for each task) while the
+ * backends report their own as they are reaped (see burn-process.c).
+ * NOTE: CPU time and the peak of brasero are those of the whole process;
+ * they include other tasks running at the same time.
+ */
+
+typedef struct _BraseroTaskStatistics BraseroTaskStatistics;
+struct _BraseroTaskStatistics {
+	GTimer *timer;
+	gdouble user;
+	gdouble sys;
+};
+
+static gdouble
+brasero_task_timeval_to_seconds (struct timeval *tv)
+{
+	return (gdouble) tv->tv_sec + (gdouble) tv->tv_usec / 1000000.0;
+}
+
+static void
+brasero_task_get_cpu_time (gdouble *user,
+			   gdouble *sys)
+{
+	struct rusage self_usage;
+	struct rusage children_usage;
+
+	getrusage (RUSAGE_SELF, &self_usage);
+	getrusage (RUSAGE_CHILDREN, &children_usage);
+
+	*user = brasero_task_timeval_to_seconds (&self_usage.ru_utime) +
+		brasero_task_timeval_to_seconds (&children_usage.ru_utime);
+	*sys = brasero_task_timeval_to_seconds (&self_usage.ru_stime) +
+	       brasero_task_timeval_to_seconds (&children_usage.ru_stime);
+}
+
+static glong
+brasero_task_get_peak_rss (void)
+{
+	struct rusage usage;
+	gchar *contents;
+	glong maxrss = -1;
+
+	if (g_file_get_contents ("/proc/self/status", &contents, NULL, NULL)) {
+		gchar *line;
+
+		line = strstr (contents, "VmHWM:");
+		if (line)
+			maxrss = strtol (line + strlen ("VmHWM:"), NULL, 10);
+
+		g_free (contents);
+	}
+
+	if (maxrss >= 0)
+		return maxrss;
+
+	getrusage (RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+static void
+brasero_task_statistics_start (BraseroTaskStatistics *stats)
+{
+	brasero_task_get_cpu_time (&stats->user, &stats->sys);
+	stats->timer = g_timer_new ();
+}
+
+static void
+brasero_task_statistics_stop (BraseroTask *self,
+			      BraseroTaskStatistics *stats,
+			      const gchar *stage,
+			      BraseroBurnResult result)
+{
+	gdouble elapsed, user, sys;
+	goffset bytes = 0;
+
+	elapsed = g_timer_elapsed (stats->timer, NULL);
+	g_timer_destroy (stats->timer);
+	stats->timer = NULL;
+
+	brasero_task_get_cpu_time (&user, &sys);
+
+	if (brasero_task_ctx_get_session_output_size (BRASERO_TASK_CTX (self), NULL, &bytes) != BRASERO_BURN_OK
+	||  bytes <= 0)
+		brasero_task_ctx_get_written (BRASERO_TASK_CTX (self), &bytes);
+
+	BRASERO_BURN_LOG ("Task statistics [%s] result %i: %" G_GOFFSET_FORMAT " bytes in %.2f s (%.2f MiB/s), CPU user %.2f s system %.2f s, peak RSS %li KiB, backends peak RSS %li KiB",
+			  stage,
+			  result,
+			  bytes,
+			  elapsed,
+			  elapsed > 0.0 ? (gdouble) bytes / 1048576.0 / elapsed:0.0,
+			  user - stats->user,
+			  sys - stats->sys,
+			  brasero_task_get_peak_rss (),
+			  brasero_task_ctx_get_children_maxrss (BRASERO_TASK_CTX (self)));
+}
+
 BraseroBurnResult
 brasero_task_check (BraseroTask *self,
 		    GError **error)
 {
+	BraseroTaskStatistics stats;
+	BraseroBurnResult result;
 	BraseroTaskAction action;
 
 	g_return_val_if_fail (BRASERO_IS_TASK (self), BRASERO_BURN_ERR);
@@ -670,16 +792,35 @@ brasero_task_check (BraseroTask *self,
 	 * size. Only the last running job is allowed to set the final size (see
 	 * burn-jobs.c), all values from other jobs will be ignored. */
 
-	return brasero_task_start (self, TRUE, error);
+	brasero_task_statistics_start (&stats);
+	result = brasero_task_start (self, TRUE, error);
+	brasero_task_statistics_stop (self, &stats, "size check", result);
+
+	return result;
 }
 
 BraseroBurnResult
 brasero_task_run (BraseroTask *self,
 		  GError **error)
 {
+	BraseroTaskStatistics stats;
+	BraseroBurnAction action;
+	BraseroBurnResult result;
+
 	g_return_val_if_fail (BRASERO_IS_TASK (self), BRASERO_BURN_ERR);
 
-	return brasero_task_start (self, FALSE, error);
+	brasero_task_statistics_start (&stats);
+
+	result = brasero_task_start (self, FALSE, error);
+
+	action = BRASERO_BURN_ACTION_NONE;
+	brasero_task_ctx_get_current_action (BRASERO_TASK_CTX (self), &action);
+	brasero_task_statistics_stop (self,
+				      &stats,
+				      brasero_burn_action_to_string (action),
+				      result);
+
+	return result;
 }
 
 static void
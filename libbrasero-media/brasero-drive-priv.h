@@ -41,6 +41,9 @@ brasero_drive_probing (BraseroDrive *drive);
 gboolean
 brasero_medium_probing (BraseroMedium *medium);
 
+void
+brasero_medium_wakeup (BraseroMedium *medium);
+
 G_END_DECLS
 
 #endif
@@ -64,6 +64,7 @@
 #include "scsi-status-page.h"
 #include "scsi-mode-pages.h"
 #include "scsi-sbc.h"
+#include "scsi-wait-ready.h"
 
 typedef struct _BraseroDrivePrivate BraseroDrivePrivate;
 struct _BraseroDrivePrivate
@@ -117,8 +118,6 @@ enum {
 
 G_DEFINE_TYPE (BraseroDrive, brasero_drive, G_TYPE_OBJECT);
 
-#define BRASERO_DRIVE_OPEN_ATTEMPTS			5
-
 static void
 brasero_drive_probe_inside (BraseroDrive *drive);
 
@@ -933,11 +932,18 @@ brasero_drive_probed_inside (gpointer data)
 	return FALSE;
 }
 
+static gboolean
+brasero_drive_probe_inside_cancelled (gpointer data)
+{
+	BraseroDrivePrivate *priv;
+
+	priv = BRASERO_DRIVE_PRIVATE (data);
+	return priv->probe_cancelled;
+}
+
 static gpointer
 brasero_drive_probe_inside_thread (gpointer data)
 {
-	gint counter = 0;
-	GTimeVal wait_time;
 	const gchar *device;
 	BraseroScsiErrCode code;
 	BraseroDrivePrivate *priv;
@@ -946,24 +952,23 @@ brasero_drive_probe_inside_thread (gpointer data)
 
 	priv = BRASERO_DRIVE_PRIVATE (drive);
 
-	/* the drive might be busy (a burning is going on) so we don't block
-	 * but we re-try to open it every second */
 	device = brasero_drive_get_device (drive);
 	BRASERO_MEDIA_LOG ("Trying to open device %s", device);
 
 	priv->has_medium = FALSE;
 
-	handle = brasero_device_handle_open (device, FALSE, &code);
-	while (!handle && counter <= BRASERO_DRIVE_OPEN_ATTEMPTS) {
-		sleep (1);
-
-		if (priv->probe_cancelled) {
-			BRASERO_MEDIA_LOG ("Open () cancelled");
-			goto end;
-		}
+	handle = brasero_device_handle_open_wait (device,
+						  priv->mutex,
+						  priv->cond_probe,
+						  brasero_drive_probe_inside_cancelled,
+						  drive,
+						  &code);
+	if (priv->probe_cancelled) {
+		BRASERO_MEDIA_LOG ("Open () cancelled");
 
-		counter ++;
-		handle = brasero_device_handle_open (device, FALSE, &code);
+		if (handle)
+			brasero_device_handle_close (handle);
+		goto end;
 	}
 
 	if (!handle) {
@@ -971,43 +976,21 @@ brasero_drive_probe_inside_thread (gpointer data)
 		goto end;
 	}
 
-	if (priv->probe_cancelled) {
-		BRASERO_MEDIA_LOG ("Open () cancelled");
-
-		brasero_device_handle_close (handle);
-		goto end;
-	}
-
-	while (brasero_spc1_test_unit_ready (handle, &code) != BRASERO_SCSI_OK) {
-		if (code == BRASERO_SCSI_NO_MEDIUM) {
+	if (brasero_device_handle_wait_ready (handle,
+					      priv->mutex,
+					      priv->cond_probe,
+					      brasero_drive_probe_inside_cancelled,
+					      drive,
+					      &code) != BRASERO_SCSI_OK) {
+		if (priv->probe_cancelled)
+			BRASERO_MEDIA_LOG ("Device probing cancelled");
+		else if (code == BRASERO_SCSI_NO_MEDIUM)
 			BRASERO_MEDIA_LOG ("No medium inserted");
-
-			brasero_device_handle_close (handle);
-			goto end;
-		}
-
-		if (code != BRASERO_SCSI_NOT_READY) {
+		else
 			BRASERO_MEDIA_LOG ("Device does not respond");
 
-			brasero_device_handle_close (handle);
-			goto end;
-		}
-
-		g_get_current_time (&wait_time);
-		g_time_val_add (&wait_time, 2000000);
-
-		g_mutex_lock (priv->mutex);
-		g_cond_timed_wait (priv->cond_probe,
-		                   priv->mutex,
-		                   &wait_time);
-		g_mutex_unlock (priv->mutex);
-
-		if (priv->probe_cancelled) {
-			BRASERO_MEDIA_LOG ("Device probing cancelled");
-
-			brasero_device_handle_close (handle);
-			goto end;
-		}
+		brasero_device_handle_close (handle);
+		goto end;
 	}
 
 	BRASERO_MEDIA_LOG ("Medium inserted");
@@ -1086,6 +1069,12 @@ brasero_drive_medium_gdrive_changed_cb (BraseroDrive *gdrive,
 	}
 
 	BRASERO_MEDIA_LOG ("GDrive changed");
+
+	/* A medium being probed may be waiting for the drive to be ready
+	 * so tell it to check again now rather than at its next poll */
+	if (priv->medium)
+		brasero_medium_wakeup (priv->medium);
+
 	brasero_drive_probe_inside (drive);
 }
 
@@ -1306,11 +1295,18 @@ brasero_drive_get_caps_2A (BraseroDrive *self,
 	g_free (data);
 }
 
+static gboolean
+brasero_drive_probe_cancelled (gpointer data)
+{
+	BraseroDrivePrivate *priv;
+
+	priv = BRASERO_DRIVE_PRIVATE (data);
+	return priv->initial_probe_cancelled;
+}
+
 static gpointer
 brasero_drive_probe_thread (gpointer data)
 {
-	gint counter = 0;
-	GTimeVal wait_time;
 	const gchar *device;
 	BraseroScsiResult res;
 	BraseroScsiInquiry hdr;
@@ -1321,26 +1317,20 @@ brasero_drive_probe_thread (gpointer data)
 
 	priv = BRASERO_DRIVE_PRIVATE (drive);
 
-	/* the drive might be busy (a burning is going on) so we don't block
-	 * but we re-try to open it every second */
 	device = brasero_drive_get_device (drive);
 	BRASERO_MEDIA_LOG ("Trying to open device %s", device);
 
-	handle = brasero_device_handle_open (device, FALSE, &code);
-	while (!handle && counter <= BRASERO_DRIVE_OPEN_ATTEMPTS) {
-		sleep (1);
-
-		if (priv->initial_probe_cancelled) {
-			BRASERO_MEDIA_LOG ("Open () cancelled");
-			goto end;
-		}
-
-		counter ++;
-		handle = brasero_device_handle_open (device, FALSE, &code);
-	}
-
+	handle = brasero_device_handle_open_wait (device,
+						  priv->mutex,
+						  priv->cond_probe,
+						  brasero_drive_probe_cancelled,
+						  drive,
+						  &code);
 	if (priv->initial_probe_cancelled) {
 		BRASERO_MEDIA_LOG ("Open () cancelled");
+
+		if (handle)
+			brasero_device_handle_close (handle);
 		goto end;
 	}
 
@@ -1349,32 +1339,23 @@ brasero_drive_probe_thread (gpointer data)
 		goto end;
 	}
 
-	while (brasero_spc1_test_unit_ready (handle, &code) != BRASERO_SCSI_OK) {
-		if (code == BRASERO_SCSI_NO_MEDIUM) {
+	if (brasero_device_handle_wait_ready (handle,
+					      priv->mutex,
+					      priv->cond_probe,
+					      brasero_drive_probe_cancelled,
+					      drive,
+					      &code) != BRASERO_SCSI_OK) {
+		if (!priv->initial_probe_cancelled && code == BRASERO_SCSI_NO_MEDIUM) {
 			BRASERO_MEDIA_LOG ("No medium inserted");
 			goto capabilities;
 		}
 
-		if (code != BRASERO_SCSI_NOT_READY) {
-			brasero_device_handle_close (handle);
-			BRASERO_MEDIA_LOG ("Device does not respond");
-			goto end;
-		}
-
-		g_get_current_time (&wait_time);
-		g_time_val_add (&wait_time, 2000000);
-
-		g_mutex_lock (priv->mutex);
-		g_cond_timed_wait (priv->cond_probe,
-		                   priv->mutex,
-		                   &wait_time);
-		g_mutex_unlock (priv->mutex);
-
-		if (priv->initial_probe_cancelled) {
-			brasero_device_handle_close (handle);
+		brasero_device_handle_close (handle);
+		if (priv->initial_probe_cancelled)
 			BRASERO_MEDIA_LOG ("Device probing cancelled");
-			goto end;
-		}
+		else
+			BRASERO_MEDIA_LOG ("Device does not respond");
+		goto end;
 	}
 
 	BRASERO_MEDIA_LOG ("Device ready");
@@ -108,6 +108,9 @@ static gboolean
 brasero_gio_operation_wait_for_operation_end (BraseroGioOperation *operation,
 					      GError **error)
 {
+	GMainContext *context;
+	GSource *source;
+
 	BRASERO_MEDIA_LOG ("Waiting for end of async operation");
 
 	g_object_ref (operation->cancel);
@@ -117,12 +120,22 @@ brasero_gio_operation_wait_for_operation_end (BraseroGioOperation *operation,
 			  G_CALLBACK (brasero_gio_operation_cancelled),
 			  operation);
 
+	/* Burns may run on their own thread and main context. That's also the
+	 * one async operations report to. */
+	context = g_main_context_get_thread_default ();
+	if (!context)
+		context = g_main_context_default ();
+
 	/* put a timeout (30 sec) */
-	operation->timeout_id = g_timeout_add_seconds (20,
-						       brasero_gio_operation_timeout,
-						       operation);
-
-	operation->loop = g_main_loop_new (NULL, FALSE);
+	source = g_timeout_source_new_seconds (20);
+	g_source_set_callback (source,
+			       brasero_gio_operation_timeout,
+			       operation,
+			       NULL);
+	operation->timeout_id = g_source_attach (source, context);
+	g_source_unref (source);
+
+	operation->loop = g_main_loop_new (context, FALSE);
 
 	GDK_THREADS_LEAVE ();
 	g_main_loop_run (operation->loop);
@@ -132,7 +145,10 @@ brasero_gio_operation_wait_for_operation_end (BraseroGioOperation *operation,
 	operation->loop = NULL;
 
 	if (operation->timeout_id) {
-		g_source_remove (operation->timeout_id);
+		source = g_main_context_find_source_by_id (context, operation->timeout_id);
+		if (source)
+			g_source_destroy (source);
+
 		operation->timeout_id = 0;
 	}
 
@@ -550,9 +550,10 @@ brasero_media_library_start (void)
 	bindtextdomain (GETTEXT_PACKAGE, PACKAGE_LOCALE_DIR);
 	bind_textdomain_codeset (GETTEXT_PACKAGE, "UTF-8");
 
-	/* Initialize icon-theme */
-	gtk_icon_theme_append_search_path (gtk_icon_theme_get_default (),
-					   BRASERO_DATADIR "/icons");
+	/* Initialize icon-theme (there is none for clients without display) */
+	if (gdk_screen_get_default ())
+		gtk_icon_theme_append_search_path (gtk_icon_theme_get_default (),
+						   BRASERO_DATADIR "/icons");
 
 	/* Take a reference for the monitoring library */
 	default_monitor = brasero_medium_monitor_get_default ();
@@ -59,6 +59,7 @@
 #include "scsi-write-page.h"
 #include "scsi-q-subchannel.h"
 #include "scsi-dvd-structures.h"
+#include "scsi-wait-ready.h"
 #include "burn-volume.h"
 
 
@@ -97,6 +98,7 @@ struct _BraseroMediumPrivate
 	const gchar *type;
 
 	gchar *id;
+	gchar *manufacturer;
 
 	guint max_rd;
 	guint max_wrt;
@@ -171,7 +173,6 @@ enum {
 };
 static gulong medium_signals [LAST_SIGNAL] = {0, };
 
-#define BRASERO_MEDIUM_OPEN_ATTEMPTS			5
 
 static GObjectClass* parent_class = NULL;
 
@@ -638,6 +639,29 @@ brasero_medium_get_write_speeds (BraseroMedium *medium)
 	return speeds;
 }
 
+/**
+ * brasero_medium_get_manufacturer_id:
+ * @medium: #BraseroMedium
+ *
+ * Gets the identifier of the manufacturer of a recordable @medium as it
+ * is pre-recorded on the disc (ATIP lead-in start for CDs, media ID for
+ * DVDs and BDs). Discs of the same brand and type share the same one.
+ *
+ * Return value: a #gchar * or NULL if it could not be read.
+ *
+ **/
+const gchar *
+brasero_medium_get_manufacturer_id (BraseroMedium *medium)
+{
+	BraseroMediumPrivate *priv;
+
+	g_return_val_if_fail (medium != NULL, NULL);
+	g_return_val_if_fail (BRASERO_IS_MEDIUM (medium), NULL);
+
+	priv = BRASERO_MEDIUM_PRIVATE (medium);
+	return priv->manufacturer;
+}
+
 /**
  * NOTEs about the following functions:
  * for all closed media (including ROM types) capacity == size of data and 
@@ -1313,34 +1337,17 @@ brasero_medium_get_capacity_by_type (BraseroMedium *self,
  */
 
 static gboolean
-brasero_medium_get_speed_mmc3 (BraseroMedium *self,
-			       BraseroDeviceHandle *handle,
-			       BraseroScsiErrCode *code)
+brasero_medium_set_speeds_mmc3 (BraseroMedium *self,
+				BraseroScsiGetPerfData *wrt_perf,
+				int size)
 {
-	int size = 0;
 	int num_desc, i;
 	gint max_rd, max_wrt;
-	BraseroScsiResult result;
+	guint *rd_speeds, *wr_speeds;
 	BraseroMediumPrivate *priv;
 	BraseroScsiWrtSpdDesc *desc;
-	BraseroScsiGetPerfData *wrt_perf = NULL;
-
-	BRASERO_MEDIA_LOG ("Retrieving speed (Get Performance)");
 
-	/* NOTE: this only work if there is RT streaming feature with
-	 * wspd bit set to 1. At least an MMC3 drive. */
 	priv = BRASERO_MEDIUM_PRIVATE (self);
-	result = brasero_mmc3_get_performance_wrt_spd_desc (handle,
-							    &wrt_perf,
-							    &size,
-							    code);
-
-	if (result != BRASERO_SCSI_OK) {
-		BRASERO_MEDIA_LOG ("GET PERFORMANCE failed");
-		return FALSE;
-	}
-
-	BRASERO_MEDIA_LOG ("Successfully retrieved a header: size %d, address %p", size, wrt_perf);
 
 	/* Choose the smallest value for size */
 	size = MIN (size, BRASERO_GET_32 (wrt_perf->hdr.len) + sizeof (wrt_perf->hdr.len));
@@ -1352,7 +1359,7 @@ brasero_medium_get_speed_mmc3 (BraseroMedium *self,
 	 * descriptors instead of a negative one. So be anal when checking. */
 	if (size <= (sizeof (BraseroScsiGetPerfHdr) + sizeof (BraseroScsiWrtSpdDesc))) {
 		BRASERO_MEDIA_LOG ("No descriptors");
-		goto end;
+		return FALSE;
 	}
 
 	/* Calculate the number of descriptors */
@@ -1360,10 +1367,10 @@ brasero_medium_get_speed_mmc3 (BraseroMedium *self,
 	BRASERO_MEDIA_LOG ("Got %d descriptor(s)", num_desc);
 
 	if (num_desc <= 0)
-		goto end; 
+		return FALSE;
 
-	priv->rd_speeds = g_new0 (guint, num_desc + 1);
-	priv->wr_speeds = g_new0 (guint, num_desc + 1);
+	rd_speeds = g_new0 (guint, num_desc + 1);
+	wr_speeds = g_new0 (guint, num_desc + 1);
 
 	max_rd = 0;
 	max_wrt = 0;
@@ -1373,33 +1380,70 @@ brasero_medium_get_speed_mmc3 (BraseroMedium *self,
 	for (i = 0; i < num_desc; i ++) {
 		BRASERO_MEDIA_LOG ("Descriptor n° %d, address = %p", i, (desc + i));
 
-		priv->rd_speeds [i] = BRASERO_GET_32 (desc [i].rd_speed);
-		priv->wr_speeds [i] = BRASERO_GET_32 (desc [i].wr_speed);
+		rd_speeds [i] = BRASERO_GET_32 (desc [i].rd_speed);
+		wr_speeds [i] = BRASERO_GET_32 (desc [i].wr_speed);
 
 		BRASERO_MEDIA_LOG ("RD = %u / WRT = %u",
-				   priv->rd_speeds [i],
-				   priv->wr_speeds [i]);
+				   rd_speeds [i],
+				   wr_speeds [i]);
 
-		max_rd = MAX (max_rd, priv->rd_speeds [i]);
-		max_wrt = MAX (max_wrt, priv->wr_speeds [i]);
+		max_rd = MAX (max_rd, rd_speeds [i]);
+		max_wrt = MAX (max_wrt, wr_speeds [i]);
+	}
+
+	BRASERO_MEDIA_LOG ("Maximum Speed (mmc3) %i", max_wrt);
+
+	/* strangely there are so drives (I know one case) which support this
+	 * function but don't report any speed. So if our top speed is 0 then
+	 * keep what we have (the other way to get the speed). It was a Teac */
+	if (!max_wrt) {
+		g_free (rd_speeds);
+		g_free (wr_speeds);
+		return FALSE;
 	}
 
+	g_free (priv->rd_speeds);
+	priv->rd_speeds = rd_speeds;
+
+	g_free (priv->wr_speeds);
+	priv->wr_speeds = wr_speeds;
+
 	priv->max_rd = max_rd;
 	priv->max_wrt = max_wrt;
 
-	BRASERO_MEDIA_LOG ("Maximum Speed (mmc3) %i", max_wrt);
+	return TRUE;
+}
 
-end:
+static gboolean
+brasero_medium_get_speed_mmc3 (BraseroMedium *self,
+			       BraseroDeviceHandle *handle,
+			       BraseroScsiErrCode *code)
+{
+	int size = 0;
+	gboolean res;
+	BraseroScsiResult result;
+	BraseroScsiGetPerfData *wrt_perf = NULL;
 
-	g_free (wrt_perf);
+	BRASERO_MEDIA_LOG ("Retrieving speed (Get Performance)");
 
-	/* strangely there are so drives (I know one case) which support this
-	 * function but don't report any speed. So if our top speed is 0 then
-	 * use the other way to get the speed. It was a Teac */
-	if (!priv->max_wrt)
+	/* NOTE: this only work if there is RT streaming feature with
+	 * wspd bit set to 1. At least an MMC3 drive. */
+	result = brasero_mmc3_get_performance_wrt_spd_desc (handle,
+							    &wrt_perf,
+							    &size,
+							    code);
+
+	if (result != BRASERO_SCSI_OK) {
+		BRASERO_MEDIA_LOG ("GET PERFORMANCE failed");
 		return FALSE;
+	}
 
-	return TRUE;
+	BRASERO_MEDIA_LOG ("Successfully retrieved a header: size %d, address %p", size, wrt_perf);
+
+	res = brasero_medium_set_speeds_mmc3 (self, wrt_perf, size);
+	g_free (wrt_perf);
+
+	return res;
 }
 
 static gboolean
@@ -1848,6 +1892,50 @@ brasero_medium_track_set_leadout_CDR_blank (BraseroMedium *self,
 	return TRUE;
 }
 
+static gint
+brasero_medium_get_leadout_track_num (BraseroMedium *self)
+{
+	BraseroMediumPrivate *priv;
+
+	priv = BRASERO_MEDIUM_PRIVATE (self);
+
+	if (BRASERO_MEDIUM_IS (priv->info, BRASERO_MEDIUM_CDR)
+	||  BRASERO_MEDIUM_IS (priv->info, BRASERO_MEDIUM_CDRW)
+	/* The following includes DL */
+	||  BRASERO_MEDIUM_IS (priv->info, BRASERO_MEDIUM_DVDR_PLUS)) 
+		return 0xFF;
+
+	if (priv->first_open_track >= 0)
+		return priv->first_open_track;
+
+	return -1;
+}
+
+static void
+brasero_medium_track_update_leadout (BraseroMedium *self,
+				     BraseroMediumTrack *leadout,
+				     BraseroScsiTrackInfo *track_info)
+{
+	BraseroMediumPrivate *priv;
+
+	priv = BRASERO_MEDIUM_PRIVATE (self);
+
+	BRASERO_MEDIA_LOG ("Next Writable Address is %d", BRASERO_GET_32 (track_info->next_wrt_address));
+	if (track_info->next_wrt_address_valid)
+		priv->next_wr_add = BRASERO_GET_32 (track_info->next_wrt_address);
+	else
+		BRASERO_MEDIA_LOG ("Next Writable Address is not valid");
+
+	/* Set free space */
+	BRASERO_MEDIA_LOG ("Free blocks %d", BRASERO_GET_32 (track_info->free_blocks));
+	leadout->blocks_num = BRASERO_GET_32 (track_info->free_blocks);
+
+	if (!leadout->blocks_num) {
+		leadout->blocks_num = BRASERO_GET_32 (track_info->track_size);
+		BRASERO_MEDIA_LOG ("Using track size %d", leadout->blocks_num);
+	}
+}
+
 static gboolean
 brasero_medium_track_set_leadout (BraseroMedium *self,
 				  BraseroDeviceHandle *handle,
@@ -1894,14 +1982,8 @@ brasero_medium_track_set_leadout (BraseroMedium *self,
 	else
 		size = 36;
 
-	if (BRASERO_MEDIUM_IS (priv->info, BRASERO_MEDIUM_CDR)
-	||  BRASERO_MEDIUM_IS (priv->info, BRASERO_MEDIUM_CDRW)
-	/* The following includes DL */
-	||  BRASERO_MEDIUM_IS (priv->info, BRASERO_MEDIUM_DVDR_PLUS)) 
-		track_num = 0xFF;
-	else if (priv->first_open_track >= 0)
-		track_num = priv->first_open_track;
-	else {
+	track_num = brasero_medium_get_leadout_track_num (self);
+	if (track_num < 0) {
 		BRASERO_MEDIA_LOG ("There aren't any open session set");
 		return FALSE;
 	}
@@ -1929,20 +2011,7 @@ brasero_medium_track_set_leadout (BraseroMedium *self,
 		return FALSE;
 	}
 
-	BRASERO_MEDIA_LOG ("Next Writable Address is %d", BRASERO_GET_32 (track_info.next_wrt_address));
-	if (track_info.next_wrt_address_valid)
-		priv->next_wr_add = BRASERO_GET_32 (track_info.next_wrt_address);
-	else
-		BRASERO_MEDIA_LOG ("Next Writable Address is not valid");
-
-	/* Set free space */
-	BRASERO_MEDIA_LOG ("Free blocks %d", BRASERO_GET_32 (track_info.free_blocks));
-	leadout->blocks_num = BRASERO_GET_32 (track_info.free_blocks);
-
-	if (!leadout->blocks_num) {
-		leadout->blocks_num = BRASERO_GET_32 (track_info.track_size);
-		BRASERO_MEDIA_LOG ("Using track size %d", leadout->blocks_num);
-	}
+	brasero_medium_track_update_leadout (self, leadout, &track_info);
 
 	if (!leadout->blocks_num
 	&&   BRASERO_MEDIUM_IS (priv->info, BRASERO_MEDIUM_BLANK))
@@ -2205,6 +2274,116 @@ brasero_medium_get_DVD_id (BraseroMedium *self,
 	g_free (hdr);
 }
 
+static void
+brasero_medium_append_id (GString *string,
+			  const uchar *data,
+			  gint len)
+{
+	gsize start;
+	gint i;
+
+	/* Some manufacturers pad with spaces, others with NULs */
+	start = string->len;
+	for (i = 0; i < len && data [i]; i ++) {
+		if (g_ascii_isprint (data [i]))
+			g_string_append_c (string, data [i]);
+	}
+
+	while (string->len > start && string->str [string->len - 1] == ' ')
+		g_string_truncate (string, string->len - 1);
+}
+
+static void
+brasero_medium_read_manufacturer (BraseroMedium *self,
+				  BraseroDeviceHandle *handle,
+				  BraseroScsiErrCode *code)
+{
+	gint size = 0;
+	GString *string;
+	BraseroScsiResult result;
+	BraseroMediumPrivate *priv;
+	BraseroScsiReadDiscStructureHdr *hdr = NULL;
+
+	priv = BRASERO_MEDIUM_PRIVATE (self);
+
+	if (!(priv->info & (BRASERO_MEDIUM_WRITABLE|BRASERO_MEDIUM_REWRITABLE)))
+		return;
+
+	if (priv->info & BRASERO_MEDIUM_CD) {
+		BraseroScsiAtipData *atip = NULL;
+
+		/* The start of the lead-in identifies the manufacturer */
+		result = brasero_mmc1_read_atip (handle, &atip, &size, code);
+		if (result != BRASERO_SCSI_OK)
+			return;
+
+		if (size >= 12)
+			priv->manufacturer = g_strdup_printf ("%02i:%02i:%02i",
+							      atip->desc->leadin_start_time_mn,
+							      atip->desc->leadin_start_time_sec,
+							      atip->desc->leadin_start_time_frame);
+		g_free (atip);
+	}
+	else if (BRASERO_MEDIUM_IS (priv->info, BRASERO_MEDIUM_DVD|BRASERO_MEDIUM_PLUS)) {
+		result = brasero_mmc2_read_generic_structure (handle,
+							      BRASERO_SCSI_FORMAT_PLUS_ADIP,
+							      &hdr,
+							      &size,
+							      code);
+		if (result != BRASERO_SCSI_OK)
+			return;
+
+		/* Manufacturer ID (8 bytes) and media type ID (3 bytes) */
+		if (size >= 4 + 30) {
+			string = g_string_new (NULL);
+			brasero_medium_append_id (string, hdr->data + 19, 8);
+			g_string_append_c (string, '/');
+			brasero_medium_append_id (string, hdr->data + 27, 3);
+			priv->manufacturer = g_string_free (string, FALSE);
+		}
+		g_free (hdr);
+	}
+	else if (priv->info & BRASERO_MEDIUM_DVD) {
+		result = brasero_mmc2_read_generic_structure (handle,
+							      BRASERO_SCSI_FORMAT_LESS_PRE_PIT_INFO,
+							      &hdr,
+							      &size,
+							      code);
+		if (result != BRASERO_SCSI_OK)
+			return;
+
+		/* The manufacturer ID is split in pre-pit fields 3 and 4 */
+		if (size >= 4 + 31 && hdr->data [16] == 3 && hdr->data [24] == 4) {
+			string = g_string_new (NULL);
+			brasero_medium_append_id (string, hdr->data + 17, 6);
+			brasero_medium_append_id (string, hdr->data + 25, 6);
+			priv->manufacturer = g_string_free (string, FALSE);
+		}
+		g_free (hdr);
+	}
+	else if (priv->info & BRASERO_MEDIUM_BD) {
+		result = brasero_mmc5_read_bd_structure (handle,
+							 BRASERO_SCSI_FORMAT_BD_DISC_INFO,
+							 &hdr,
+							 &size,
+							 code);
+		if (result != BRASERO_SCSI_OK)
+			return;
+
+		/* Disc manufacturer ID (6 bytes) and media type ID (3 bytes) */
+		if (size >= 4 + 109) {
+			string = g_string_new (NULL);
+			brasero_medium_append_id (string, hdr->data + 100, 6);
+			g_string_append_c (string, '/');
+			brasero_medium_append_id (string, hdr->data + 106, 3);
+			priv->manufacturer = g_string_free (string, FALSE);
+		}
+		g_free (hdr);
+	}
+
+	BRASERO_MEDIA_LOG ("Manufacturer ID %s", priv->manufacturer? priv->manufacturer:"unknown");
+}
+
 static gboolean
 brasero_medium_set_blank (BraseroMedium *self,
 			  BraseroDeviceHandle *handle,
@@ -2880,10 +3059,36 @@ brasero_medium_read_CD_TEXT (BraseroMedium *self,
 }
 
 static void
+brasero_medium_sort_write_speeds (BraseroMedium *self)
+{
+	BraseroMediumPrivate *priv;
+	guint i;
+
+	priv = BRASERO_MEDIUM_PRIVATE (self);
+
+	if (!priv->wr_speeds)
+		return;
+
+	/* sort write speeds */
+	for (i = 0; priv->wr_speeds [i] != 0; i ++) {
+		guint j;
+
+		for (j = 0; priv->wr_speeds [j] != 0; j ++) {
+			if (priv->wr_speeds [i] > priv->wr_speeds [j]) {
+				gint64 tmp;
+
+				tmp = priv->wr_speeds [i];
+				priv->wr_speeds [i] = priv->wr_speeds [j];
+				priv->wr_speeds [j] = tmp;
+			}
+		}
+	}
+}
+
+static gboolean
 brasero_medium_init_real (BraseroMedium *object,
 			  BraseroDeviceHandle *handle)
 {
-	guint i;
 	gchar *name;
 	gboolean result;
 	BraseroMediumPrivate *priv;
@@ -2897,35 +3102,39 @@ brasero_medium_init_real (BraseroMedium *object,
 	g_free (name);
 
 	if (priv->probe_cancelled)
-		return;
+		return FALSE;
 
 	result = brasero_medium_get_medium_type (object, handle, &code);
 	if (result != TRUE)
-		return;
+		return FALSE;
 
 	if (priv->probe_cancelled)
-		return;
+		return FALSE;
 
 	result = brasero_medium_get_speed (object, handle, &code);
 	if (result != TRUE)
-		return;
+		return FALSE;
 
 	if (priv->probe_cancelled)
-		return;
+		return FALSE;
 
 	brasero_medium_get_capacity_by_type (object, handle, &code);
 	if (priv->probe_cancelled)
-		return;
+		return FALSE;
 
 	brasero_medium_init_caps (object, handle, &code);
 	if (priv->probe_cancelled)
-		return;
+		return FALSE;
+
+	brasero_medium_read_manufacturer (object, handle, &code);
+	if (priv->probe_cancelled)
+		return FALSE;
 
 	if (!brasero_medium_get_contents (object, handle, &code))
-		return;
+		return FALSE;
 
 	if (priv->probe_cancelled)
-		return;
+		return FALSE;
 
 	/* assume that css feature is only for DVD-ROM which might be wrong but
 	 * some drives wrongly reports that css is enabled for blank DVD+R/W */
@@ -2933,35 +3142,21 @@ brasero_medium_init_real (BraseroMedium *object,
 		brasero_medium_get_css_feature (object, handle, &code);
 
 	if (priv->probe_cancelled)
-		return;
+		return FALSE;
 
 	/* read CD-TEXT title */
 	if (priv->info & BRASERO_MEDIUM_HAS_AUDIO)
 		brasero_medium_read_CD_TEXT (object, handle, &code);
 
 	if (priv->probe_cancelled)
-		return;
+		return FALSE;
 
 	brasero_media_to_string (priv->info, buffer);
 	BRASERO_MEDIA_LOG ("media is %s", buffer);
 
-	if (!priv->wr_speeds)
-		return;
-
-	/* sort write speeds */
-	for (i = 0; priv->wr_speeds [i] != 0; i ++) {
-		guint j;
-
-		for (j = 0; priv->wr_speeds [j] != 0; j ++) {
-			if (priv->wr_speeds [i] > priv->wr_speeds [j]) {
-				gint64 tmp;
+	brasero_medium_sort_write_speeds (object);
 
-				tmp = priv->wr_speeds [i];
-				priv->wr_speeds [i] = priv->wr_speeds [j];
-				priv->wr_speeds [j] = tmp;
-			}
-		}
-	}
+	return TRUE;
 }
 
 gboolean
@@ -2975,32 +3170,578 @@ brasero_medium_probing (BraseroMedium *medium)
 	return priv->probe != NULL;
 }
 
-static gboolean
-brasero_medium_probed (gpointer data)
-{
-	BraseroMediumPrivate *priv;
+/* Big enough for all the write speed descriptors a drive can report */
+#define BRASERO_MEDIUM_REFRESH_PERF_SIZE	2048
 
-	g_return_val_if_fail (BRASERO_IS_MEDIUM (data), FALSE);
+typedef struct _BraseroMediumRefresh BraseroMediumRefresh;
+struct _BraseroMediumRefresh {
+	BraseroMedium *medium;
+	BraseroDrive *drive;
+	BraseroDeviceHandle *handle;
 
-	priv = BRASERO_MEDIUM_PRIVATE (data);
+	BraseroScsiGetPerfData *wrt_perf;
+	BraseroScsiTrackInfo track_info;
 
-	priv->probe_id = 0;
+	guint pending;
+	guint changed:1;
 
-	/* This signal must be emitted in the main thread */
-	GDK_THREADS_ENTER ();
-	g_signal_emit (data,
-		       medium_signals [PROBED],
-		       0);
-	GDK_THREADS_LEAVE ();
+	BraseroMediumRefreshCallback callback;
+	gpointer user_data;
+};
 
-	return FALSE;
+/**
+ * The medium may have been ejected or its drive removed (in which case the
+ * drive dropped it) while the commands were pending. The results are then
+ * about another medium or none at all and must be ignored.
+ */
+
+static gboolean
+brasero_medium_refresh_is_stale (BraseroMediumRefresh *refresh)
+{
+	return brasero_drive_get_medium (refresh->drive) != refresh->medium;
+}
+
+static void
+brasero_medium_refresh_done (BraseroMediumRefresh *refresh)
+{
+	refresh->pending --;
+	if (refresh->pending)
+		return;
+
+	/* No command is pending for this handle any more so this won't block */
+	brasero_device_handle_close (refresh->handle);
+
+	if (brasero_medium_refresh_is_stale (refresh)) {
+		BRASERO_MEDIA_LOG ("Medium gone while refreshing");
+		refresh->changed = FALSE;
+	}
+
+	if (refresh->callback)
+		refresh->callback (refresh->medium,
+				   refresh->changed,
+				   refresh->user_data);
+
+	g_object_unref (refresh->drive);
+	g_object_unref (refresh->medium);
+	g_free (refresh->wrt_perf);
+	g_free (refresh);
+}
+
+static void
+brasero_medium_refresh_speeds_cb (gpointer command,
+				  BraseroScsiResult result,
+				  BraseroScsiErrCode code,
+				  gpointer user_data)
+{
+	BraseroMediumRefresh *refresh = user_data;
+
+	brasero_scsi_command_free (command);
+
+	if (result != BRASERO_SCSI_OK)
+		BRASERO_MEDIA_LOG ("GET PERFORMANCE failed (%s)", brasero_scsi_strerror (code));
+	else if (brasero_medium_refresh_is_stale (refresh))
+		BRASERO_MEDIA_LOG ("GET PERFORMANCE result ignored");
+	else if (brasero_medium_set_speeds_mmc3 (refresh->medium,
+						 refresh->wrt_perf,
+						 BRASERO_MEDIUM_REFRESH_PERF_SIZE)) {
+		brasero_medium_sort_write_speeds (refresh->medium);
+		refresh->changed = TRUE;
+	}
+
+	brasero_medium_refresh_done (refresh);
+}
+
+static void
+brasero_medium_refresh_free_space_cb (gpointer command,
+				      BraseroScsiResult result,
+				      BraseroScsiErrCode code,
+				      gpointer user_data)
+{
+	BraseroMediumRefresh *refresh = user_data;
+	BraseroMediumTrack leadout = { 0, };
+	BraseroMediumPrivate *priv;
+	GSList *iter;
+
+	brasero_scsi_command_free (command);
+
+	priv = BRASERO_MEDIUM_PRIVATE (refresh->medium);
+
+	if (result != BRASERO_SCSI_OK) {
+		BRASERO_MEDIA_LOG ("READ TRACK INFO failed (%s)", brasero_scsi_strerror (code));
+		brasero_medium_refresh_done (refresh);
+		return;
+	}
+
+	if (brasero_medium_refresh_is_stale (refresh)) {
+		BRASERO_MEDIA_LOG ("READ TRACK INFO result ignored");
+		brasero_medium_refresh_done (refresh);
+		return;
+	}
+
+	brasero_medium_track_update_leadout (refresh->medium,
+					     &leadout,
+					     &refresh->track_info);
+
+	/* Keep the value we got while probing if the drive doesn't report
+	 * anything; the fallback methods are too slow for the main loop */
+	for (iter = priv->tracks; iter && leadout.blocks_num; iter = iter->next) {
+		BraseroMediumTrack *track;
+
+		track = iter->data;
+		if (track->type != BRASERO_MEDIUM_TRACK_LEADOUT)
+			continue;
+
+		if (track->blocks_num != leadout.blocks_num) {
+			track->blocks_num = leadout.blocks_num;
+			refresh->changed = TRUE;
+		}
+		break;
+	}
+
+	brasero_medium_refresh_done (refresh);
+}
+
+/**
+ * brasero_medium_refresh_async:
+ * @medium: #BraseroMedium
+ * @callback: a #BraseroMediumRefreshCallback or NULL
+ * @user_data: a #gpointer
+ *
+ * Queries the drive again for the write speeds and the free space of @medium
+ * without blocking. @callback is called from the thread-default main context
+ * of the calling thread once the values returned by
+ * brasero_medium_get_write_speeds (), brasero_medium_get_max_write_speed () and
+ * brasero_medium_get_free_space () have been updated. If @medium was ejected
+ * or its drive removed in the mean time, nothing is updated and @callback is
+ * called with changed set to FALSE.
+ *
+ * Return value: a #gboolean. FALSE if the drive could not be queried (in this
+ * case @callback is not called).
+ **/
+gboolean
+brasero_medium_refresh_async (BraseroMedium *medium,
+			      BraseroMediumRefreshCallback callback,
+			      gpointer user_data)
+{
+	BraseroMediumRefresh *refresh;
+	BraseroMediumPrivate *priv;
+	BraseroDeviceHandle *handle;
+	BraseroScsiErrCode code;
+	const gchar *device;
+	gint track_num;
+
+	g_return_val_if_fail (BRASERO_IS_MEDIUM (medium), FALSE);
+
+	priv = BRASERO_MEDIUM_PRIVATE (medium);
+
+	/* The probing thread is still filling the structure */
+	if (priv->probe || !priv->drive)
+		return FALSE;
+
+	if (!(priv->info & BRASERO_MEDIUM_WRITABLE)
+	&&  !(priv->info & BRASERO_MEDIUM_REWRITABLE))
+		return FALSE;
+
+	device = brasero_drive_get_device (priv->drive);
+	if (!device)
+		return FALSE;
+
+	handle = brasero_device_handle_open (device, FALSE, &code);
+	if (!handle) {
+		BRASERO_MEDIA_LOG ("Open () failed: %s", brasero_scsi_strerror (code));
+		return FALSE;
+	}
+
+	refresh = g_new0 (BraseroMediumRefresh, 1);
+	refresh->medium = g_object_ref (medium);
+	refresh->drive = g_object_ref (priv->drive);
+	refresh->handle = handle;
+	refresh->callback = callback;
+	refresh->user_data = user_data;
+
+	/* This is to make sure the handle is not closed before all the
+	 * commands have been issued */
+	refresh->pending = 1;
+
+	refresh->wrt_perf = g_malloc0 (BRASERO_MEDIUM_REFRESH_PERF_SIZE);
+	if (brasero_mmc3_get_performance_wrt_spd_desc_async (handle,
+							     refresh->wrt_perf,
+							     BRASERO_MEDIUM_REFRESH_PERF_SIZE,
+							     brasero_medium_refresh_speeds_cb,
+							     refresh) == BRASERO_SCSI_OK)
+		refresh->pending ++;
+
+	/* Overwritable media have a fixed free space */
+	track_num = brasero_medium_get_leadout_track_num (medium);
+	if (!BRASERO_MEDIUM_RANDOM_WRITABLE (priv->info)
+	&&  !(priv->info & BRASERO_MEDIUM_CLOSED)
+	&&   track_num >= 0
+	&&   brasero_mmc1_read_track_info_async (handle,
+						 track_num,
+						 &refresh->track_info,
+						 sizeof (refresh->track_info),
+						 brasero_medium_refresh_free_space_cb,
+						 refresh) == BRASERO_SCSI_OK)
+		refresh->pending ++;
+
+	if (refresh->pending == 1) {
+		brasero_device_handle_close (handle);
+		g_object_unref (refresh->drive);
+		g_object_unref (refresh->medium);
+		g_free (refresh->wrt_perf);
+		g_free (refresh);
+		return FALSE;
+	}
+
+	brasero_medium_refresh_done (refresh);
+	return TRUE;
+}
+
+/**
+ * This is not public API. Defined in brasero-drive-priv.h.
+ * Called when the system notified a media change so that a probing thread
+ * waiting for the drive to become ready checks it right away.
+ */
+void
+brasero_medium_wakeup (BraseroMedium *medium)
+{
+	BraseroMediumPrivate *priv;
+
+	g_return_if_fail (BRASERO_IS_MEDIUM (medium));
+
+	priv = BRASERO_MEDIUM_PRIVATE (medium);
+
+	g_mutex_lock (priv->mutex);
+	if (priv->probe)
+		g_cond_signal (priv->cond_probe);
+	g_mutex_unlock (priv->mutex);
+}
+
+static gboolean
+brasero_medium_probed (gpointer data)
+{
+	BraseroMediumPrivate *priv;
+
+	g_return_val_if_fail (BRASERO_IS_MEDIUM (data), FALSE);
+
+	priv = BRASERO_MEDIUM_PRIVATE (data);
+
+	priv->probe_id = 0;
+
+	/* This signal must be emitted in the main thread */
+	GDK_THREADS_ENTER ();
+	g_signal_emit (data,
+		       medium_signals [PROBED],
+		       0);
+	GDK_THREADS_LEAVE ();
+
+	return FALSE;
+}
+
+/**
+ * Cache of probe results. The same discs tend to be inserted again and again
+ * (verification, appending, ...) and a full probe takes dozens of commands.
+ * The key is made of what READ DISC INFORMATION (disc ID, ATIP lead-in, bar
+ * code, status) and READ TOC (session layout) return, which is enough to tell
+ * whether a disc changed since any write to a sequential medium changes one
+ * of them. Two blank discs of the same type and size have the same disc
+ * information though, so the current profile and the structure holding the
+ * manufacturer ID (ATIP, ADIP, pre-pit, BD disc information) are part of it
+ * too; blank media whose manufacturer can't be read are not cached.
+ * Random writable media don't have that property: overwriting a DVD+RW
+ * leaves both untouched, so they are never cached. Neither are discs with a
+ * CD-TEXT title which is content and not layout.
+ */
+
+#define BRASERO_MEDIUM_CACHE_SIZE		16
+
+typedef struct _BraseroMediumCacheEntry BraseroMediumCacheEntry;
+struct _BraseroMediumCacheEntry {
+	gchar *key;
+	BraseroMediumPrivate result;
+};
+
+G_LOCK_DEFINE_STATIC (probe_cache);
+static GSList *probe_cache = NULL;
+
+static guint *
+brasero_medium_copy_speeds (const guint *speeds)
+{
+	guint num;
+
+	if (!speeds)
+		return NULL;
+
+	for (num = 0; speeds [num] != 0; num ++);
+	return g_memdup (speeds, sizeof (guint) * (num + 1));
+}
+
+static void
+brasero_medium_copy_result (BraseroMediumPrivate *dest,
+			    BraseroMediumPrivate *src)
+{
+	GSList *iter;
+
+	dest->type = src->type;
+	dest->id = g_strdup (src->id);
+	dest->manufacturer = g_strdup (src->manufacturer);
+
+	dest->max_rd = src->max_rd;
+	dest->max_wrt = src->max_wrt;
+	dest->rd_speeds = brasero_medium_copy_speeds (src->rd_speeds);
+	dest->wr_speeds = brasero_medium_copy_speeds (src->wr_speeds);
+
+	dest->block_num = src->block_num;
+	dest->block_size = src->block_size;
+
+	dest->first_open_track = src->first_open_track;
+	dest->next_wr_add = src->next_wr_add;
+
+	dest->info = src->info;
+
+	dest->tracks = NULL;
+	for (iter = src->tracks; iter; iter = iter->next)
+		dest->tracks = g_slist_prepend (dest->tracks,
+						g_memdup (iter->data, sizeof (BraseroMediumTrack)));
+	dest->tracks = g_slist_reverse (dest->tracks);
+
+	dest->dummy_sao = src->dummy_sao;
+	dest->dummy_tao = src->dummy_tao;
+	dest->burnfree = src->burnfree;
+	dest->sao = src->sao;
+	dest->tao = src->tao;
+
+	dest->blank_command = src->blank_command;
+	dest->write_command = src->write_command;
+}
+
+static void
+brasero_medium_cache_entry_free (BraseroMediumCacheEntry *entry)
+{
+	g_free (entry->key);
+	g_free (entry->result.id);
+	g_free (entry->result.manufacturer);
+	g_free (entry->result.rd_speeds);
+	g_free (entry->result.wr_speeds);
+
+	g_slist_foreach (entry->result.tracks, (GFunc) g_free, NULL);
+	g_slist_free (entry->result.tracks);
+
+	g_free (entry);
+}
+
+static gboolean
+brasero_medium_checksum_manufacturer (GChecksum *checksum,
+				      BraseroDeviceHandle *handle,
+				      BraseroScsiProfile profile)
+{
+	int size = 0;
+	BraseroScsiResult res;
+	BraseroScsiReadDiscStructureHdr *hdr = NULL;
+
+	/* Read the raw structures brasero_medium_read_manufacturer () gets
+	 * the manufacturer ID from; there is no need to parse them here */
+	switch (profile) {
+	case BRASERO_SCSI_PROF_CDR:
+	case BRASERO_SCSI_PROF_CDRW: {
+		BraseroScsiAtipData *atip = NULL;
+
+		res = brasero_mmc1_read_atip (handle, &atip, &size, NULL);
+		if (res != BRASERO_SCSI_OK)
+			return FALSE;
+
+		g_checksum_update (checksum, (guchar *) atip, size);
+		g_free (atip);
+		return TRUE;
+	}
+
+	case BRASERO_SCSI_PROF_DVD_R_PLUS:
+	case BRASERO_SCSI_PROF_DVD_RW_PLUS:
+	case BRASERO_SCSI_PROF_DVD_R_PLUS_DL:
+	case BRASERO_SCSI_PROF_DVD_RW_PLUS_DL:
+		res = brasero_mmc2_read_generic_structure (handle,
+							   BRASERO_SCSI_FORMAT_PLUS_ADIP,
+							   &hdr,
+							   &size,
+							   NULL);
+		break;
+
+	case BRASERO_SCSI_PROF_DVD_R:
+	case BRASERO_SCSI_PROF_DVD_RW_RESTRICTED:
+	case BRASERO_SCSI_PROF_DVD_RW_SEQUENTIAL:
+	case BRASERO_SCSI_PROF_DVD_R_DL_SEQUENTIAL:
+	case BRASERO_SCSI_PROF_DVD_R_DL_JUMP:
+		res = brasero_mmc2_read_generic_structure (handle,
+							   BRASERO_SCSI_FORMAT_LESS_PRE_PIT_INFO,
+							   &hdr,
+							   &size,
+							   NULL);
+		break;
+
+	case BRASERO_SCSI_PROF_BR_R_SEQUENTIAL:
+	case BRASERO_SCSI_PROF_BR_R_RANDOM:
+	case BRASERO_SCSI_PROF_BD_RW:
+		res = brasero_mmc5_read_bd_structure (handle,
+						      BRASERO_SCSI_FORMAT_BD_DISC_INFO,
+						      &hdr,
+						      &size,
+						      NULL);
+		break;
+
+	default:
+		/* Pressed discs have no manufacturer ID */
+		return TRUE;
+	}
+
+	if (res != BRASERO_SCSI_OK)
+		return FALSE;
+
+	g_checksum_update (checksum, (guchar *) hdr, size);
+	g_free (hdr);
+	return TRUE;
+}
+
+static gchar *
+brasero_medium_get_cache_key (BraseroMedium *self,
+			      BraseroDeviceHandle *handle)
+{
+	guchar profile_data [2];
+	BraseroScsiProfile profile;
+	int size;
+	gchar *key;
+	GChecksum *checksum;
+	BraseroScsiResult res;
+	BraseroMediumPrivate *priv;
+	BraseroScsiDiscInfoStd *info = NULL;
+	BraseroScsiFormattedTocData *toc = NULL;
+
+	priv = BRASERO_MEDIUM_PRIVATE (self);
+
+	/* Without a profile there is no telling a blank disc from another */
+	res = brasero_mmc2_get_profile (handle, &profile, NULL);
+	if (res != BRASERO_SCSI_OK)
+		return NULL;
+
+	res = brasero_mmc1_read_disc_information_std (handle,
+						      &info,
+						      &size,
+						      NULL);
+	if (res != BRASERO_SCSI_OK)
+		return NULL;
+
+	checksum = g_checksum_new (G_CHECKSUM_SHA1);
+
+	/* Speeds depend on the drive as well */
+	g_checksum_update (checksum,
+			   (guchar *) brasero_drive_get_device (priv->drive),
+			   -1);
+
+	BRASERO_SET_16 (profile_data, profile);
+	g_checksum_update (checksum, profile_data, sizeof (profile_data));
+
+	g_checksum_update (checksum, (guchar *) info, size);
+
+	/* Blank discs of the same type only differ by their manufacturer */
+	if (!brasero_medium_checksum_manufacturer (checksum, handle, profile)
+	&&   info->status == BRASERO_SCSI_DISC_EMPTY) {
+		BRASERO_MEDIA_LOG ("Blank medium without manufacturer ID, not cached");
+		g_checksum_free (checksum);
+		g_free (info);
+		return NULL;
+	}
+	g_free (info);
+
+	/* Blank discs have no TOC */
+	res = brasero_mmc1_read_toc_formatted (handle,
+					       0,
+					       &toc,
+					       &size,
+					       NULL);
+	if (res == BRASERO_SCSI_OK) {
+		g_checksum_update (checksum, (guchar *) toc, size);
+		g_free (toc);
+	}
+
+	key = g_strdup (g_checksum_get_string (checksum));
+	g_checksum_free (checksum);
+
+	return key;
+}
+
+static gboolean
+brasero_medium_cache_lookup (BraseroMedium *self,
+			     const gchar *key)
+{
+	GSList *iter;
+	BraseroMediumPrivate *priv;
+	BraseroMediumCacheEntry *entry = NULL;
+
+	priv = BRASERO_MEDIUM_PRIVATE (self);
+
+	G_LOCK (probe_cache);
+	for (iter = probe_cache; iter; iter = iter->next) {
+		entry = iter->data;
+		if (!strcmp (entry->key, key))
+			break;
+	}
+
+	if (!iter) {
+		G_UNLOCK (probe_cache);
+		return FALSE;
+	}
+
+	/* Most recently used entries first */
+	probe_cache = g_slist_delete_link (probe_cache, iter);
+	probe_cache = g_slist_prepend (probe_cache, entry);
+
+	brasero_medium_copy_result (priv, &entry->result);
+	G_UNLOCK (probe_cache);
+
+	return TRUE;
+}
+
+static void
+brasero_medium_cache_add (BraseroMedium *self,
+			  const gchar *key)
+{
+	BraseroMediumPrivate *priv;
+	BraseroMediumCacheEntry *entry;
+
+	priv = BRASERO_MEDIUM_PRIVATE (self);
+
+	if (BRASERO_MEDIUM_RANDOM_WRITABLE (priv->info)
+	||  priv->CD_TEXT_title)
+		return;
+
+	entry = g_new0 (BraseroMediumCacheEntry, 1);
+	entry->key = g_strdup (key);
+	brasero_medium_copy_result (&entry->result, priv);
+
+	G_LOCK (probe_cache);
+	probe_cache = g_slist_prepend (probe_cache, entry);
+	if (g_slist_length (probe_cache) > BRASERO_MEDIUM_CACHE_SIZE) {
+		GSList *last;
+
+		last = g_slist_last (probe_cache);
+		brasero_medium_cache_entry_free (last->data);
+		probe_cache = g_slist_delete_link (probe_cache, last);
+	}
+	G_UNLOCK (probe_cache);
+}
+
+static gboolean
+brasero_medium_probe_cancelled (gpointer data)
+{
+	BraseroMediumPrivate *priv;
+
+	priv = BRASERO_MEDIUM_PRIVATE (data);
+	return priv->probe_cancelled;
 }
 
 static gpointer
 brasero_medium_probe_thread (gpointer self)
 {
-	gint counter = 0;
-	GTimeVal wait_time;
+	gchar *key;
 	const gchar *device;
 	BraseroScsiErrCode code;
 	BraseroMediumPrivate *priv;
@@ -3010,20 +3751,19 @@ brasero_medium_probe_thread (gpointer self)
 
 	priv->info = BRASERO_MEDIUM_BUSY;
 
-	/* the drive might be busy (a burning is going on) so we don't block
-	 * but we re-try to open it every second */
 	device = brasero_drive_get_device (priv->drive);
 	BRASERO_MEDIA_LOG ("Trying to open device %s", device);
 
-	handle = brasero_device_handle_open (device, FALSE, &code);
-	while (!handle && counter <= BRASERO_MEDIUM_OPEN_ATTEMPTS) {
-		sleep (1);
-
-		if (priv->probe_cancelled)
-			goto end;
-
-		counter ++;
-		handle = brasero_device_handle_open (device, FALSE, &code);
+	handle = brasero_device_handle_open_wait (device,
+						  priv->mutex,
+						  priv->cond_probe,
+						  brasero_medium_probe_cancelled,
+						  self,
+						  &code);
+	if (priv->probe_cancelled) {
+		if (handle)
+			brasero_device_handle_close (handle);
+		goto end;
 	}
 
 	if (!handle) {
@@ -3031,50 +3771,38 @@ brasero_medium_probe_thread (gpointer self)
 		goto end;
 	}
 
-	if (priv->probe_cancelled) {
-		brasero_device_handle_close (handle);
-		goto end;
-	}
-
 	BRASERO_MEDIA_LOG ("Open () succeeded");
 
-	/* NOTE: if we wanted to know the status we'd need to read the 
-	 * error code variable which is currently NULL */
-	while (brasero_spc1_test_unit_ready (handle, &code) != BRASERO_SCSI_OK) {
-		if (code == BRASERO_SCSI_NO_MEDIUM) {
+	/* This returns as soon as the drive reports the medium is loaded or
+	 * when brasero_medium_wakeup () is called after a media change */
+	if (brasero_device_handle_wait_ready (handle,
+					      priv->mutex,
+					      priv->cond_probe,
+					      brasero_medium_probe_cancelled,
+					      self,
+					      &code) != BRASERO_SCSI_OK) {
+		if (priv->probe_cancelled)
+			BRASERO_MEDIA_LOG ("Device probing cancelled");
+		else if (code == BRASERO_SCSI_NO_MEDIUM) {
 			BRASERO_MEDIA_LOG ("No medium inserted");
 			priv->info = BRASERO_MEDIUM_NONE;
-
-			brasero_device_handle_close (handle);
-			goto end;
 		}
-		else if (code != BRASERO_SCSI_NOT_READY) {
+		else
 			BRASERO_MEDIA_LOG ("Device does not respond");
 
-			brasero_device_handle_close (handle);
-			goto end;
-		}
-
-		g_get_current_time (&wait_time);
-		g_time_val_add (&wait_time, 2000000);
-
-		g_mutex_lock (priv->mutex);
-		g_cond_timed_wait (priv->cond_probe,
-		                   priv->mutex,
-		                   &wait_time);
-		g_mutex_unlock (priv->mutex);
-
-		if (priv->probe_cancelled) {
-			BRASERO_MEDIA_LOG ("Device probing cancelled");
-
-			brasero_device_handle_close (handle);
-			goto end;
-		}
+		brasero_device_handle_close (handle);
+		goto end;
 	}
 
 	BRASERO_MEDIA_LOG ("Device ready");
 
-	brasero_medium_init_real (BRASERO_MEDIUM (self), handle);
+	key = brasero_medium_get_cache_key (BRASERO_MEDIUM (self), handle);
+	if (key && brasero_medium_cache_lookup (BRASERO_MEDIUM (self), key))
+		BRASERO_MEDIA_LOG ("Using cached probe result");
+	else if (brasero_medium_init_real (BRASERO_MEDIUM (self), handle) && key)
+		brasero_medium_cache_add (BRASERO_MEDIUM (self), key);
+
+	g_free (key);
 	brasero_device_handle_close (handle);
 
 end:
@@ -3188,6 +3916,11 @@ brasero_medium_finalize (GObject *object)
 		priv->id = NULL;
 	}
 
+	if (priv->manufacturer) {
+		g_free (priv->manufacturer);
+		priv->manufacturer = NULL;
+	}
+
 	if (priv->CD_TEXT_title) {
 		g_free (priv->CD_TEXT_title);
 		priv->CD_TEXT_title = NULL;
@@ -82,6 +82,9 @@ brasero_medium_get_max_write_speed (BraseroMedium *medium);
 guint64 *
 brasero_medium_get_write_speeds (BraseroMedium *medium);
 
+const gchar *
+brasero_medium_get_manufacturer_id (BraseroMedium *medium);
+
 void
 brasero_medium_get_free_space (BraseroMedium *medium,
 			       goffset *bytes,
@@ -158,6 +161,23 @@ brasero_medium_can_use_sao (BraseroMedium *medium);
 gboolean
 brasero_medium_can_use_tao (BraseroMedium *medium);
 
+/**
+ * BraseroMediumRefreshCallback:
+ * @medium: the #BraseroMedium that was refreshed
+ * @changed: whether its speeds or free space changed
+ * @user_data: the data passed to brasero_medium_refresh_async ()
+ *
+ * Called once brasero_medium_refresh_async () completed.
+ **/
+typedef void	(*BraseroMediumRefreshCallback)	(BraseroMedium *medium,
+						 gboolean changed,
+						 gpointer user_data);
+
+gboolean
+brasero_medium_refresh_async (BraseroMedium *medium,
+			      BraseroMediumRefreshCallback callback,
+			      gpointer user_data);
+
 G_END_DECLS
 
 #endif /* _BURN_MEDIUM_H_ */
@@ -0,0 +1,782 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Libbrasero-media
+ * Copyright (C) Philippe Rouquier 2005-2009 <bonfire-app@wanadoo.fr>
+ *
+ * Libbrasero-media is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The Libbrasero-media authors hereby grant permission for non-GPL compatible
+ * GStreamer plugins to be used and distributed together with GStreamer
+ * and Libbrasero-media. This permission is above and beyond the permissions granted
+ * by the GPL license by which Libbrasero-media is covered. If you modify this code
+ * you may extend this exception to your version of the code, but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version.
+ * 
+ * Libbrasero-media is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "burn-disc-reader.h"
+#include "burn-iso9660.h"
+#include "brasero-media.h"
+#include "brasero-media-private.h"
+
+#include "scsi-mmc1.h"
+#include "scsi-mmc2.h"
+#include "scsi-sbc.h"
+
+/* Number of blocks read at once when the disc reads fine */
+#define BRASERO_DISC_READER_CHUNK		32
+
+/* How far we jump at most (in blocks) after consecutive read errors during
+ * the first pass: 32 MiB */
+#define BRASERO_DISC_READER_MAX_SKIP		16384
+
+/* Speed (in kB/s) set for retries; drives use their lowest speed when asked
+ * for a speed they do not support */
+#define BRASERO_DISC_READER_SLOW_SPEED		1
+
+/* Time (in seconds) between two saves of the map */
+#define BRASERO_DISC_READER_SAVE_DELAY		5
+
+#define BRASERO_DISC_READER_MAP_HEADER		"# Brasero disc reader map"
+
+/* Block of the primary volume descriptor of ISO9660 volumes */
+#define BRASERO_DISC_READER_PVD_BLOCK		16
+
+typedef enum {
+	BRASERO_DISC_RANGE_UNTRIED	= '?',
+	BRASERO_DISC_RANGE_GOOD		= '+',
+	BRASERO_DISC_RANGE_BAD		= '-'
+} BraseroDiscRangeState;
+
+struct _BraseroDiscRange {
+	goffset start;
+	goffset end;
+	BraseroDiscRangeState state;
+	guint tries;
+};
+typedef struct _BraseroDiscRange BraseroDiscRange;
+
+struct _BraseroDiscReader {
+	BraseroDeviceHandle *handle;
+
+	goffset start;
+	goffset blocks;
+
+	int output;
+	gchar *map;
+
+	/* Tells whether the map was written for the disc being read */
+	gchar *disc_id;
+
+	/* sorted and contiguous list of BraseroDiscRange covering the blocks
+	 * from start to start + blocks */
+	GList *ranges;
+
+	/* pass 0 is the fast one */
+	guint pass;
+	guint retries;
+	goffset position;
+	goffset skip;
+
+	gint64 saved;
+
+	guint use_readcd:1;
+	guint slowed_down:1;
+};
+
+static void
+brasero_disc_reader_merge (BraseroDiscReader *reader)
+{
+	GList *iter;
+
+	iter = reader->ranges;
+	while (iter && iter->next) {
+		BraseroDiscRange *range;
+		BraseroDiscRange *next;
+
+		range = iter->data;
+		next = iter->next->data;
+		if (range->state != next->state
+		||  range->tries != next->tries
+		||  range->end != next->start) {
+			iter = iter->next;
+			continue;
+		}
+
+		range->end = next->end;
+		g_free (next);
+		reader->ranges = g_list_delete_link (reader->ranges, iter->next);
+	}
+}
+
+static void
+brasero_disc_reader_mark (BraseroDiscReader *reader,
+			  goffset from,
+			  goffset to,
+			  BraseroDiscRangeState state,
+			  guint tries)
+{
+	GList *next;
+	GList *iter;
+
+	for (iter = reader->ranges; iter; iter = next) {
+		BraseroDiscRange *range;
+
+		next = iter->next;
+		range = iter->data;
+
+		if (range->end <= from)
+			continue;
+
+		if (range->start >= to)
+			break;
+
+		/* keep what is before and after as it was */
+		if (range->start < from) {
+			BraseroDiscRange *head;
+
+			head = g_memdup (range, sizeof (BraseroDiscRange));
+			head->end = from;
+			range->start = from;
+			reader->ranges = g_list_insert_before (reader->ranges, iter, head);
+		}
+
+		if (range->end > to) {
+			BraseroDiscRange *tail;
+
+			tail = g_memdup (range, sizeof (BraseroDiscRange));
+			tail->start = to;
+			range->end = to;
+			reader->ranges = g_list_insert_before (reader->ranges, next, tail);
+		}
+
+		range->state = state;
+		range->tries = tries;
+	}
+
+	brasero_disc_reader_merge (reader);
+}
+
+/**
+ * Returns the first range at or after the current position which still has
+ * to be read during this pass.
+ */
+
+static BraseroDiscRange *
+brasero_disc_reader_next_range (BraseroDiscReader *reader)
+{
+	GList *iter;
+
+	for (iter = reader->ranges; iter; iter = iter->next) {
+		BraseroDiscRange *range;
+
+		range = iter->data;
+		if (range->end <= reader->position)
+			continue;
+
+		if (range->state == BRASERO_DISC_RANGE_UNTRIED)
+			return range;
+
+		/* bad regions are only retried after the first pass */
+		if (range->state == BRASERO_DISC_RANGE_BAD && reader->pass)
+			return range;
+	}
+
+	return NULL;
+}
+
+static gboolean
+brasero_disc_reader_has_missing (BraseroDiscReader *reader)
+{
+	GList *iter;
+
+	for (iter = reader->ranges; iter; iter = iter->next) {
+		BraseroDiscRange *range;
+
+		range = iter->data;
+		if (range->state != BRASERO_DISC_RANGE_GOOD)
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+static void
+brasero_disc_reader_set_speed (BraseroDiscReader *reader,
+			       int speed)
+{
+	BraseroScsiResult result;
+	BraseroScsiErrCode code;
+
+	result = brasero_mmc1_set_cd_speed (reader->handle,
+					    speed,
+					    BRASERO_SCSI_SPEED_MAX,
+					    &code);
+	if (result != BRASERO_SCSI_OK)
+		BRASERO_MEDIA_LOG ("Read speed could not be set (%s)", brasero_scsi_strerror (code));
+
+	reader->slowed_down = (speed != BRASERO_SCSI_SPEED_MAX);
+}
+
+static BraseroScsiResult
+brasero_disc_reader_read (BraseroDiscReader *reader,
+			  goffset block,
+			  guint num,
+			  guchar *buffer,
+			  BraseroScsiErrCode *code)
+{
+	if (reader->use_readcd)
+		return brasero_mmc1_read_block (reader->handle,
+						TRUE,
+						BRASERO_SCSI_BLOCK_TYPE_ANY,
+						BRASERO_SCSI_BLOCK_HEADER_NONE,
+						BRASERO_SCSI_BLOCK_NO_SUBCHANNEL,
+						block,
+						num,
+						buffer,
+						num * ISO9660_BLOCK_SIZE,
+						code);
+
+	return brasero_sbc_read10_block (reader->handle,
+					 block,
+					 num,
+					 buffer,
+					 num * ISO9660_BLOCK_SIZE,
+					 code);
+}
+
+static gboolean
+brasero_disc_reader_write (BraseroDiscReader *reader,
+			   goffset block,
+			   guint num,
+			   const guchar *buffer,
+			   GError **error)
+{
+	gsize remaining;
+	off_t offset;
+
+	offset = (off_t) (block - reader->start) * ISO9660_BLOCK_SIZE;
+	remaining = num * ISO9660_BLOCK_SIZE;
+	while (remaining) {
+		ssize_t written;
+
+		written = pwrite (reader->output, buffer, remaining, offset);
+		if (written < 0) {
+			int errsv = errno;
+
+			if (errsv == EINTR)
+				continue;
+
+			BRASERO_MEDIA_LOG ("pwrite () failed (%s)", g_strerror (errsv));
+			g_set_error (error,
+				     BRASERO_MEDIA_ERROR,
+				     BRASERO_MEDIA_ERROR_GENERAL,
+				     "%s",
+				     g_strerror (errsv));
+			return FALSE;
+		}
+
+		buffer += written;
+		offset += written;
+		remaining -= written;
+	}
+
+	return TRUE;
+}
+
+/**
+ * Reads the next chunk of blocks that needs to be read. @finished is set to
+ * TRUE once the last pass is over. FALSE is returned if reading can't go on
+ * (no more medium, write error, ...); unreadable blocks are not an error.
+ */
+
+gboolean
+brasero_disc_reader_step (BraseroDiscReader *reader,
+			  gboolean *finished,
+			  GError **error)
+{
+	guchar buffer [BRASERO_DISC_READER_CHUNK * ISO9660_BLOCK_SIZE];
+	BraseroDiscRangeState state;
+	BraseroScsiResult result;
+	BraseroDiscRange *range;
+	BraseroScsiErrCode code;
+	goffset from;
+	guint tries;
+	guint num;
+
+	*finished = FALSE;
+
+	range = brasero_disc_reader_next_range (reader);
+	if (!range) {
+		/* That's the end of a pass */
+		if (reader->pass >= reader->retries
+		|| !brasero_disc_reader_has_missing (reader)) {
+			*finished = TRUE;
+			return brasero_disc_reader_save_map (reader, error);
+		}
+
+		reader->pass ++;
+		reader->position = reader->start;
+		reader->skip = 0;
+
+		BRASERO_MEDIA_LOG ("Retrying unread blocks (pass %i)", reader->pass);
+		if (!reader->slowed_down)
+			brasero_disc_reader_set_speed (reader, BRASERO_DISC_READER_SLOW_SPEED);
+
+		return brasero_disc_reader_save_map (reader, error);
+	}
+
+	from = MAX (range->start, reader->position);
+	state = range->state;
+	tries = range->tries;
+
+	/* Blocks that already failed are read one by one so that as many as
+	 * possible are recovered */
+	if (state == BRASERO_DISC_RANGE_BAD)
+		num = 1;
+	else
+		num = MIN (BRASERO_DISC_READER_CHUNK, range->end - from);
+
+	code = BRASERO_SCSI_ERROR_NONE;
+	result = brasero_disc_reader_read (reader, from, num, buffer, &code);
+	if (result == BRASERO_SCSI_OK) {
+		if (!brasero_disc_reader_write (reader, from, num, buffer, error))
+			return FALSE;
+
+		brasero_disc_reader_mark (reader, from, from + num, BRASERO_DISC_RANGE_GOOD, 0);
+		reader->position = from + num;
+		reader->skip = 0;
+	}
+	else if (code == BRASERO_SCSI_NO_MEDIUM
+	     ||  code == BRASERO_SCSI_ERRNO
+	     ||  code == BRASERO_SCSI_BAD_ARGUMENT
+	     ||  code == BRASERO_SCSI_INVALID_COMMAND) {
+		BRASERO_MEDIA_LOG ("Reading failed at block %" G_GOFFSET_FORMAT " (%s)",
+				   from,
+				   brasero_scsi_strerror (code));
+		brasero_scsi_set_error (error, code);
+		brasero_disc_reader_save_map (reader, NULL);
+		return FALSE;
+	}
+	else {
+		BRASERO_MEDIA_LOG ("Blocks %" G_GOFFSET_FORMAT " to %" G_GOFFSET_FORMAT " could not be read (%s)",
+				   from,
+				   from + num,
+				   brasero_scsi_strerror (code));
+
+		brasero_disc_reader_mark (reader,
+					  from,
+					  from + num,
+					  BRASERO_DISC_RANGE_BAD,
+					  tries + 1);
+		reader->position = from + num;
+
+		/* During the first pass, don't linger on damaged regions;
+		 * jump further after each new error. What is jumped over is
+		 * left for the next passes. */
+		if (!reader->pass) {
+			reader->skip = reader->skip? MIN (reader->skip * 2, BRASERO_DISC_READER_MAX_SKIP):BRASERO_DISC_READER_CHUNK;
+			reader->position += reader->skip;
+		}
+	}
+
+	if (g_get_monotonic_time () - reader->saved >= BRASERO_DISC_READER_SAVE_DELAY * G_USEC_PER_SEC)
+		return brasero_disc_reader_save_map (reader, error);
+
+	return TRUE;
+}
+
+/**
+ * @position is the block the current pass reached; @good and @bad are the
+ * number of blocks read and of blocks that could not be read so far.
+ */
+
+void
+brasero_disc_reader_get_progress (BraseroDiscReader *reader,
+				  guint *pass,
+				  goffset *position,
+				  goffset *good,
+				  goffset *bad)
+{
+	goffset good_blocks = 0;
+	goffset bad_blocks = 0;
+	GList *iter;
+
+	for (iter = reader->ranges; iter; iter = iter->next) {
+		BraseroDiscRange *range;
+
+		range = iter->data;
+		if (range->state == BRASERO_DISC_RANGE_GOOD)
+			good_blocks += range->end - range->start;
+		else if (range->state == BRASERO_DISC_RANGE_BAD)
+			bad_blocks += range->end - range->start;
+	}
+
+	if (pass)
+		*pass = reader->pass;
+
+	if (position)
+		*position = MIN (reader->position, reader->start + reader->blocks) - reader->start;
+
+	if (good)
+		*good = good_blocks;
+
+	if (bad)
+		*bad = bad_blocks;
+}
+
+void
+brasero_disc_reader_set_retries (BraseroDiscReader *reader,
+				 guint retries)
+{
+	reader->retries = retries;
+}
+
+/**
+ * The map is a text file. The first line after the header identifies the disc
+ * and the second one gives the range of blocks read, the pass and the position
+ * within it. Each following line is a region: first block, block after the
+ * last one, state (+ read, - unreadable, ? not tried yet) and number of failed
+ * attempts.
+ */
+
+gboolean
+brasero_disc_reader_save_map (BraseroDiscReader *reader,
+			      GError **error)
+{
+	GString *contents;
+	gboolean result;
+	GList *iter;
+
+	reader->saved = g_get_monotonic_time ();
+	if (!reader->map)
+		return TRUE;
+
+	contents = g_string_new (BRASERO_DISC_READER_MAP_HEADER "\n");
+	g_string_append_printf (contents, "%s\n", reader->disc_id);
+	g_string_append_printf (contents,
+				"%" G_GOFFSET_FORMAT " %" G_GOFFSET_FORMAT " %u %" G_GOFFSET_FORMAT "\n",
+				reader->start,
+				reader->blocks,
+				reader->pass,
+				reader->position);
+
+	for (iter = reader->ranges; iter; iter = iter->next) {
+		BraseroDiscRange *range;
+
+		range = iter->data;
+		g_string_append_printf (contents,
+					"%" G_GOFFSET_FORMAT " %" G_GOFFSET_FORMAT " %c %u\n",
+					range->start,
+					range->end,
+					range->state,
+					range->tries);
+	}
+
+	result = g_file_set_contents (reader->map,
+				      contents->str,
+				      contents->len,
+				      error);
+	if (!result)
+		BRASERO_MEDIA_LOG ("Map %s could not be saved", reader->map);
+
+	g_string_free (contents, TRUE);
+	return result;
+}
+
+static gboolean
+brasero_disc_reader_load_map (BraseroDiscReader *reader)
+{
+	gchar *contents = NULL;
+	goffset position;
+	goffset blocks;
+	goffset start;
+	gchar **lines;
+	guint pass;
+	guint i;
+
+	if (!g_file_get_contents (reader->map, &contents, NULL, NULL))
+		return FALSE;
+
+	lines = g_strsplit (contents, "\n", -1);
+	g_free (contents);
+
+	if (!lines [0] || strcmp (lines [0], BRASERO_DISC_READER_MAP_HEADER))
+		goto error;
+
+	/* The map must be for the same disc and the same blocks; a map of
+	 * another disc with the same layout would mix the two of them */
+	if (!lines [1] || strcmp (lines [1], reader->disc_id))
+		goto error;
+
+	if (!lines [2]
+	||  sscanf (lines [2], "%" G_GINT64_FORMAT " %" G_GINT64_FORMAT " %u %" G_GINT64_FORMAT, &start, &blocks, &pass, &position) != 4
+	||  start != reader->start
+	||  blocks != reader->blocks)
+		goto error;
+
+	for (i = 3; lines [i] && lines [i][0]; i ++) {
+		BraseroDiscRange *range;
+		goffset range_start;
+		goffset range_end;
+		guint tries;
+		gchar state;
+
+		if (sscanf (lines [i], "%" G_GINT64_FORMAT " %" G_GINT64_FORMAT " %c %u", &range_start, &range_end, &state, &tries) != 4)
+			goto error;
+
+		if (state != BRASERO_DISC_RANGE_UNTRIED
+		&&  state != BRASERO_DISC_RANGE_GOOD
+		&&  state != BRASERO_DISC_RANGE_BAD)
+			goto error;
+
+		if (range_end < range_start
+		||  range_start < reader->start
+		||  range_end > reader->start + reader->blocks)
+			goto error;
+
+		brasero_disc_reader_mark (reader, range_start, range_end, state, tries);
+	}
+
+	g_strfreev (lines);
+
+	reader->pass = pass;
+	reader->position = position;
+
+	BRASERO_MEDIA_LOG ("Resuming read from map %s (pass %i, block %" G_GOFFSET_FORMAT ")",
+			   reader->map,
+			   pass,
+			   position);
+	return TRUE;
+
+error:
+
+	BRASERO_MEDIA_LOG ("Map %s is not valid and is ignored", reader->map);
+	g_strfreev (lines);
+
+	/* start from scratch */
+	brasero_disc_reader_mark (reader,
+				  reader->start,
+				  reader->start + reader->blocks,
+				  BRASERO_DISC_RANGE_UNTRIED,
+				  0);
+	return FALSE;
+}
+
+static gboolean
+brasero_disc_reader_use_readcd (BraseroDeviceHandle *handle)
+{
+	BraseroScsiGetConfigHdr *hdr = NULL;
+	BraseroScsiResult result;
+	gboolean readcd;
+	int size;
+
+	/* Same choice as for the volume source */
+	result = brasero_mmc2_get_configuration_feature (handle,
+							 BRASERO_SCSI_FEAT_RD_CD,
+							 &hdr,
+							 &size,
+							 NULL);
+	readcd = (result == BRASERO_SCSI_OK && hdr->desc->current);
+	g_free (hdr);
+
+	if (readcd)
+		return TRUE;
+
+	hdr = NULL;
+	result = brasero_mmc2_get_configuration_feature (handle,
+							 BRASERO_SCSI_FEAT_RD_RANDOM,
+							 &hdr,
+							 &size,
+							 NULL);
+	readcd = !(result == BRASERO_SCSI_OK && hdr->desc->current);
+	g_free (hdr);
+
+	return readcd;
+}
+
+/**
+ * What READ DISC INFORMATION and READ TOC return changes with the layout of
+ * the disc. Pressed discs of the same size have the same layout though, so
+ * the primary volume descriptor (with the label and the creation date) is
+ * added when it can be read. If it can't be read only once out of two
+ * attempts, reading starts from scratch which is safe.
+ */
+
+static gchar *
+brasero_disc_reader_get_disc_id (BraseroDiscReader *reader)
+{
+	guchar buffer [ISO9660_BLOCK_SIZE];
+	BraseroScsiFormattedTocData *toc = NULL;
+	BraseroScsiDiscInfoStd *info = NULL;
+	BraseroScsiResult result;
+	GChecksum *checksum;
+	gchar *disc_id;
+	int size;
+
+	checksum = g_checksum_new (G_CHECKSUM_SHA1);
+
+	result = brasero_mmc1_read_disc_information_std (reader->handle,
+							 &info,
+							 &size,
+							 NULL);
+	if (result == BRASERO_SCSI_OK) {
+		g_checksum_update (checksum, (guchar *) info, size);
+		g_free (info);
+	}
+
+	result = brasero_mmc1_read_toc_formatted (reader->handle,
+						  0,
+						  &toc,
+						  &size,
+						  NULL);
+	if (result == BRASERO_SCSI_OK) {
+		g_checksum_update (checksum, (guchar *) toc, size);
+		g_free (toc);
+	}
+
+	result = brasero_disc_reader_read (reader,
+					   reader->start + BRASERO_DISC_READER_PVD_BLOCK,
+					   1,
+					   buffer,
+					   NULL);
+	if (result == BRASERO_SCSI_OK)
+		g_checksum_update (checksum, buffer, sizeof (buffer));
+
+	disc_id = g_strdup (g_checksum_get_string (checksum));
+	g_checksum_free (checksum);
+
+	return disc_id;
+}
+
+/**
+ * @output is the image file to create (block @start is written at its
+ * beginning) and @map the file to keep track of what was read. If @map
+ * exists and was written for the same disc, reading resumes where it stopped.
+ */
+
+BraseroDiscReader *
+brasero_disc_reader_new (BraseroDeviceHandle *handle,
+			 goffset start,
+			 goffset blocks,
+			 const gchar *output,
+			 const gchar *map,
+			 GError **error)
+{
+	BraseroDiscReader *reader;
+	BraseroDiscRange *range;
+	gboolean resume = FALSE;
+	struct stat info;
+	int flags;
+
+	g_return_val_if_fail (handle != NULL, NULL);
+	g_return_val_if_fail (output != NULL, NULL);
+
+	reader = g_new0 (BraseroDiscReader, 1);
+	reader->handle = handle;
+	reader->start = start;
+	reader->blocks = blocks;
+	reader->position = start;
+	reader->map = g_strdup (map);
+	reader->use_readcd = brasero_disc_reader_use_readcd (handle);
+	reader->disc_id = brasero_disc_reader_get_disc_id (reader);
+
+	range = g_new0 (BraseroDiscRange, 1);
+	range->start = start;
+	range->end = start + blocks;
+	range->state = BRASERO_DISC_RANGE_UNTRIED;
+	reader->ranges = g_list_prepend (NULL, range);
+
+	/* Only keep what was read before if the image is still there */
+	if (map && g_file_test (output, G_FILE_TEST_EXISTS))
+		resume = brasero_disc_reader_load_map (reader);
+
+	flags = O_WRONLY|O_CREAT;
+	if (!resume)
+		flags |= O_TRUNC;
+
+	reader->output = g_open (output, flags, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
+	if (reader->output < 0) {
+		int errsv = errno;
+
+		BRASERO_MEDIA_LOG ("open () failed (%s)", g_strerror (errsv));
+		g_set_error (error,
+			     BRASERO_MEDIA_ERROR,
+			     BRASERO_MEDIA_ERROR_GENERAL,
+			     "%s",
+			     g_strerror (errsv));
+		brasero_disc_reader_free (reader);
+		return NULL;
+	}
+
+	/* Blocks that can't be read are left as zeros in the image */
+	if (!fstat (reader->output, &info)
+	&&  info.st_size < blocks * ISO9660_BLOCK_SIZE
+	&&  ftruncate (reader->output, blocks * ISO9660_BLOCK_SIZE))
+		BRASERO_MEDIA_LOG ("ftruncate () failed (%s)", g_strerror (errno));
+
+	BRASERO_MEDIA_LOG ("Reading %" G_GOFFSET_FORMAT " blocks from %" G_GOFFSET_FORMAT " (%s)",
+			   blocks,
+			   start,
+			   reader->use_readcd? "READ CD":"READ10");
+	return reader;
+}
+
+/**
+ * Once all blocks were read the map is removed; otherwise it is left so that
+ * reading can be resumed.
+ */
+
+void
+brasero_disc_reader_free (BraseroDiscReader *reader)
+{
+	if (reader->slowed_down)
+		brasero_disc_reader_set_speed (reader, BRASERO_SCSI_SPEED_MAX);
+
+	if (reader->output >= 0) {
+		if (reader->map) {
+			if (brasero_disc_reader_has_missing (reader))
+				brasero_disc_reader_save_map (reader, NULL);
+			else
+				g_remove (reader->map);
+		}
+
+		close (reader->output);
+	}
+
+	g_list_foreach (reader->ranges, (GFunc) g_free, NULL);
+	g_list_free (reader->ranges);
+
+	g_free (reader->disc_id);
+	g_free (reader->map);
+	g_free (reader);
+}
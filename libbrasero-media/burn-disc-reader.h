@@ -0,0 +1,87 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Libbrasero-media
+ * Copyright (C) Philippe Rouquier 2005-2009 <bonfire-app@wanadoo.fr>
+ *
+ * Libbrasero-media is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The Libbrasero-media authors hereby grant permission for non-GPL compatible
+ * GStreamer plugins to be used and distributed together with GStreamer
+ * and Libbrasero-media. This permission is above and beyond the permissions granted
+ * by the GPL license by which Libbrasero-media is covered. If you modify this code
+ * you may extend this exception to your version of the code, but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version.
+ * 
+ * Libbrasero-media is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+#ifndef _BURN_DISC_READER_H
+#define _BURN_DISC_READER_H
+
+#include <glib.h>
+
+#include "scsi-device.h"
+
+G_BEGIN_DECLS
+
+/**
+ * Reads a range of blocks of a data disc into a file and does its best with
+ * damaged discs. The first pass reads at full speed and skips over the
+ * regions that can't be read. Later passes read the remaining regions at a
+ * reduced speed one block at a time. What was read is kept in a map file so
+ * that an interrupted read can be resumed where it stopped.
+ */
+
+typedef struct _BraseroDiscReader BraseroDiscReader;
+
+/* The map is usually stored next to the output with this suffix. While it
+ * exists, a partial output must be kept so that reading can resume. */
+#define BRASERO_DISC_READER_MAP_SUFFIX		".map"
+
+BraseroDiscReader *
+brasero_disc_reader_new (BraseroDeviceHandle *handle,
+			 goffset start,
+			 goffset blocks,
+			 const gchar *output,
+			 const gchar *map,
+			 GError **error);
+
+void
+brasero_disc_reader_set_retries (BraseroDiscReader *reader,
+				 guint retries);
+
+gboolean
+brasero_disc_reader_step (BraseroDiscReader *reader,
+			  gboolean *finished,
+			  GError **error);
+
+void
+brasero_disc_reader_get_progress (BraseroDiscReader *reader,
+				  guint *pass,
+				  goffset *position,
+				  goffset *good,
+				  goffset *bad);
+
+gboolean
+brasero_disc_reader_save_map (BraseroDiscReader *reader,
+			      GError **error);
+
+void
+brasero_disc_reader_free (BraseroDiscReader *reader);
+
+G_END_DECLS
+
+#endif /* _BURN_DISC_READER_H */
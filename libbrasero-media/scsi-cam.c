@@ -51,6 +51,7 @@
 
 #include "brasero-media-private.h"
 #include "scsi-command.h"
+#include "scsi-queue.h"
 #include "scsi-utils.h"
 #include "scsi-error.h"
 #include "scsi-sense-data.h"
@@ -65,21 +66,13 @@ struct _BraseroDeviceHandle {
 	int fd;
 };
 
-struct _BraseroScsiCmd {
-	uchar cmd [BRASERO_SCSI_CMD_MAX_LEN];
-	BraseroDeviceHandle *handle;
-
-	const BraseroScsiCmdInfo *info;
-};
-typedef struct _BraseroScsiCmd BraseroScsiCmd;
-
 #define BRASERO_SCSI_CMD_OPCODE_OFF			0
 #define BRASERO_SCSI_CMD_SET_OPCODE(command)		(command->cmd [BRASERO_SCSI_CMD_OPCODE_OFF] = command->info->opcode)
 
 #define OPEN_FLAGS			O_RDONLY /*|O_EXCL */|O_NONBLOCK
 
 BraseroScsiResult
-brasero_scsi_command_issue_sync (gpointer command,
+brasero_scsi_command_issue_real (gpointer command,
 				 gpointer buffer,
 				 int size,
 				 BraseroScsiErrCode *error)
@@ -182,6 +175,8 @@ brasero_device_handle_open (const gchar *path,
 		handle = g_new0 (BraseroDeviceHandle, 1);
 		handle->cam = cam;
 		handle->fd = fd;
+
+		brasero_scsi_queue_attach (handle, path);
 	}
 	else {
 		int serrno;
@@ -215,6 +210,8 @@ brasero_device_handle_close (BraseroDeviceHandle *handle)
 {
 	g_assert (handle != NULL);
 
+	brasero_scsi_queue_detach (handle);
+
 	if (handle->cam)
 		cam_close_device (handle->cam);
 
@@ -0,0 +1,48 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Libbrasero-media
+ * Copyright (C) Philippe Rouquier 2005-2009 <bonfire-app@wanadoo.fr>
+ *
+ * Libbrasero-media is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The Libbrasero-media authors hereby grant permission for non-GPL compatible
+ * GStreamer plugins to be used and distributed together with GStreamer
+ * and Libbrasero-media. This permission is above and beyond the permissions granted
+ * by the GPL license by which Libbrasero-media is covered. If you modify this code
+ * you may extend this exception to your version of the code, but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version.
+ * 
+ * Libbrasero-media is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+
+#include <glib.h>
+
+#ifndef _SCSI_CLOSE_TRACK_SESSION_H
+#define _SCSI_CLOSE_TRACK_SESSION_H
+
+G_BEGIN_DECLS
+
+typedef enum {
+BRASERO_SCSI_CLOSE_TRACK			= 0x01,
+BRASERO_SCSI_CLOSE_SESSION			= 0x02,	/* stops background formatting of DVD+RW */
+BRASERO_SCSI_CLOSE_FINALIZE			= 0x05,
+BRASERO_SCSI_CLOSE_FINALIZE_DVD_PLUS_R_DL	= 0x06
+} BraseroScsiCloseFunction;
+
+G_END_DECLS
+
+#endif /* _SCSI_CLOSE_TRACK_SESSION_H */
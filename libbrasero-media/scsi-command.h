@@ -55,6 +55,21 @@ struct _BraseroScsiCmdInfo {
 };
 typedef struct _BraseroScsiCmdInfo BraseroScsiCmdInfo;
 
+/* The CDB is the first member so that the command structures defined by
+ * each scsi-*.c file can be laid over it */
+struct _BraseroScsiCmd {
+	uchar cmd [BRASERO_SCSI_CMD_MAX_LEN];
+	BraseroDeviceHandle *handle;
+
+	const BraseroScsiCmdInfo *info;
+};
+typedef struct _BraseroScsiCmd BraseroScsiCmd;
+
+typedef void	(*BraseroScsiCallback)	(gpointer command,
+					 BraseroScsiResult result,
+					 BraseroScsiErrCode code,
+					 gpointer user_data);
+
 #define BRASERO_SCSI_COMMAND_DEFINE(cdb, name, direction)			\
 static const BraseroScsiCmdInfo info =						\
 {	/* SCSI commands always end by 1 byte of ctl */				\
@@ -75,6 +90,25 @@ brasero_scsi_command_issue_sync (gpointer command,
 				 gpointer buffer,
 				 int size,
 				 BraseroScsiErrCode *error);
+
+BraseroScsiResult
+brasero_scsi_command_issue_async (gpointer command,
+				  gpointer buffer,
+				  int size,
+				  BraseroScsiCallback callback,
+				  gpointer user_data);
+
+/**
+ * Implemented by each platform backend (scsi-sg.c, scsi-cam.c, ...). It sends
+ * the command to the device right away and should only be called by the
+ * per-drive queue (scsi-queue.c).
+ */
+
+BraseroScsiResult
+brasero_scsi_command_issue_real (gpointer command,
+				 gpointer buffer,
+				 int size,
+				 BraseroScsiErrCode *error);
 G_END_DECLS
 
 #endif /* _BURN_SCSI_COMMAND_H */
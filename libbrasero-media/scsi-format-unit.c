@@ -0,0 +1,166 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Libbrasero-media
+ * Copyright (C) Philippe Rouquier 2005-2009 <bonfire-app@wanadoo.fr>
+ *
+ * Libbrasero-media is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The Libbrasero-media authors hereby grant permission for non-GPL compatible
+ * GStreamer plugins to be used and distributed together with GStreamer
+ * and Libbrasero-media. This permission is above and beyond the permissions granted
+ * by the GPL license by which Libbrasero-media is covered. If you modify this code
+ * you may extend this exception to your version of the code, but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version.
+ * 
+ * Libbrasero-media is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "scsi-mmc2.h"
+
+#include "scsi-error.h"
+#include "scsi-utils.h"
+#include "scsi-base.h"
+#include "scsi-command.h"
+#include "scsi-opcodes.h"
+#include "scsi-read-format-capacities.h"
+
+/**
+ * FORMAT UNIT command description (defined in MMC2)
+ */
+
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+
+struct _BraseroFormatUnitCDB {
+	uchar opcode;
+
+	uchar format_code	:3;
+	uchar cmp_list		:1;
+	uchar fmt_data		:1;
+	uchar reserved0		:3;
+
+	uchar vendor_specific;
+	uchar interleave	[2];
+
+	uchar ctl;
+};
+
+struct _BraseroFormatListHdr {
+	uchar reserved0;
+
+	uchar vs		:1;
+	uchar immed		:1;
+	uchar dsp		:1;
+	uchar ip		:1;
+	uchar stpf		:1;
+	uchar dcrt		:1;
+	uchar dpry		:1;
+	uchar fov		:1;
+
+	uchar len		[2];
+};
+
+#else
+
+struct _BraseroFormatUnitCDB {
+	uchar opcode;
+
+	uchar reserved0		:3;
+	uchar fmt_data		:1;
+	uchar cmp_list		:1;
+	uchar format_code	:3;
+
+	uchar vendor_specific;
+	uchar interleave	[2];
+
+	uchar ctl;
+};
+
+struct _BraseroFormatListHdr {
+	uchar reserved0;
+
+	uchar fov		:1;
+	uchar dpry		:1;
+	uchar dcrt		:1;
+	uchar stpf		:1;
+	uchar ip		:1;
+	uchar dsp		:1;
+	uchar immed		:1;
+	uchar vs		:1;
+
+	uchar len		[2];
+};
+
+#endif
+
+typedef struct _BraseroFormatUnitCDB BraseroFormatUnitCDB;
+typedef struct _BraseroFormatListHdr BraseroFormatListHdr;
+
+struct _BraseroFormatList {
+	BraseroFormatListHdr hdr;
+	BraseroScsiFormattableCapacityDesc desc;
+};
+typedef struct _BraseroFormatList BraseroFormatList;
+
+BRASERO_SCSI_COMMAND_DEFINE (BraseroFormatUnitCDB,
+			     FORMAT_UNIT,
+			     BRASERO_SCSI_WRITE);
+
+/**
+ * @desc is usually one of the descriptors returned by READ FORMAT CAPACITIES.
+ * When @immediate is TRUE the drive returns as soon as it checked the
+ * parameters; for DVD+RW it then goes on formatting in the background while
+ * the host can already write to the disc.
+ */
+
+BraseroScsiResult
+brasero_mmc2_format_unit (BraseroDeviceHandle *handle,
+			  const BraseroScsiFormattableCapacityDesc *desc,
+			  gboolean immediate,
+			  BraseroScsiErrCode *error)
+{
+	BraseroFormatUnitCDB *cdb;
+	BraseroFormatList list;
+	BraseroScsiResult res;
+
+	g_return_val_if_fail (handle != NULL, BRASERO_SCSI_FAILURE);
+	g_return_val_if_fail (desc != NULL, BRASERO_SCSI_FAILURE);
+
+	memset (&list, 0, sizeof (list));
+
+	/* FOV has to be set for IMMED to be taken into account */
+	list.hdr.fov = 1;
+	list.hdr.immed = (immediate != FALSE);
+	BRASERO_SET_16 (list.hdr.len, sizeof (list.desc));
+	memcpy (&list.desc, desc, sizeof (list.desc));
+
+	cdb = brasero_scsi_command_new (&info, handle);
+	cdb->fmt_data = 1;
+	cdb->format_code = 1;
+
+	res = brasero_scsi_command_issue_sync (cdb, &list, sizeof (list), error);
+	brasero_scsi_command_free (cdb);
+
+	return res;
+}
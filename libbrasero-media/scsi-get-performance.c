@@ -252,3 +252,36 @@ brasero_mmc3_get_performance_wrt_spd_desc (BraseroDeviceHandle *handle,
 	return res;
 }
 
+
+/**
+ * Asynchronous version: since there is no way to ask the drive for the size
+ * first, @data should be big enough for all the descriptors (2048 is what
+ * the synchronous version uses at most). @callback is responsible for
+ * freeing the command with brasero_scsi_command_free ().
+ */
+
+BraseroScsiResult
+brasero_mmc3_get_performance_wrt_spd_desc_async (BraseroDeviceHandle *handle,
+						 BraseroScsiGetPerfData *data,
+						 int size,
+						 BraseroScsiCallback callback,
+						 gpointer user_data)
+{
+	BraseroGetPerformanceCDB *cdb;
+	BraseroScsiResult res;
+
+	g_return_val_if_fail (handle != NULL, BRASERO_SCSI_FAILURE);
+	g_return_val_if_fail (data != NULL, BRASERO_SCSI_FAILURE);
+	g_return_val_if_fail (size > sizeof (BraseroScsiGetPerfHdr), BRASERO_SCSI_FAILURE);
+
+	cdb = brasero_scsi_command_new (&info, handle);
+	cdb->type = BRASERO_GET_PERFORMANCE_WR_SPEED_TYPE;
+	BRASERO_SET_16 (cdb->max_desc, (size - sizeof (BraseroScsiGetPerfHdr)) / sizeof (BraseroScsiWrtSpdDesc));
+
+	memset (data, 0, size);
+	res = brasero_scsi_command_issue_async (cdb, data, size, callback, user_data);
+	if (res != BRASERO_SCSI_OK)
+		brasero_scsi_command_free (cdb);
+
+	return res;
+}
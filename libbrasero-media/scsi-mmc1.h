@@ -33,17 +33,21 @@
 #include "scsi-base.h"
 #include "scsi-device.h"
 #include "scsi-error.h"
+#include "scsi-command.h"
 #include "scsi-read-cd.h"
 #include "scsi-read-disc-info.h"
 #include "scsi-read-toc-pma-atip.h"
 #include "scsi-read-track-information.h"
 #include "scsi-mech-status.h"
+#include "scsi-close-track-session.h"
 
 #ifndef _BURN_MMC1_H
 #define _BURN_MMC1_H
 
 G_BEGIN_DECLS
 
+#define BRASERO_SCSI_SPEED_MAX		0xFFFF
+
 BraseroScsiResult
 brasero_mmc1_read_disc_information_std (BraseroDeviceHandle *handle,
 					BraseroScsiDiscInfoStd **info_return,
@@ -75,6 +79,14 @@ brasero_mmc1_read_track_info (BraseroDeviceHandle *handle,
 			      int *size,
 			      BraseroScsiErrCode *error);
 
+BraseroScsiResult
+brasero_mmc1_read_track_info_async (BraseroDeviceHandle *handle,
+				    int track_num,
+				    BraseroScsiTrackInfo *track_info,
+				    int size,
+				    BraseroScsiCallback callback,
+				    gpointer user_data);
+
 BraseroScsiResult
 brasero_mmc1_read_block (BraseroDeviceHandle *handle,
 			 gboolean user_data,
@@ -91,6 +103,19 @@ brasero_mmc1_mech_status (BraseroDeviceHandle *handle,
 			  BraseroScsiMechStatusHdr *hdr,
 			  BraseroScsiErrCode *error);
 
+BraseroScsiResult
+brasero_mmc1_close_track_session (BraseroDeviceHandle *handle,
+				  BraseroScsiCloseFunction function,
+				  int track_num,
+				  gboolean immediate,
+				  BraseroScsiErrCode *error);
+
+BraseroScsiResult
+brasero_mmc1_set_cd_speed (BraseroDeviceHandle *handle,
+			   int read_speed,
+			   int write_speed,
+			   BraseroScsiErrCode *error);
+
 G_END_DECLS
 
 #endif /* _BURN_MMC1_H */
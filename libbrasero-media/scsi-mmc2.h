@@ -68,11 +68,24 @@ brasero_mmc2_read_generic_structure (BraseroDeviceHandle *handle,
 				     int *size,
 				     BraseroScsiErrCode *error);
 
+BraseroScsiResult
+brasero_mmc5_read_bd_structure (BraseroDeviceHandle *handle,
+				BraseroScsiBDFormatType type,
+				BraseroScsiReadDiscStructureHdr **data,
+				int *size,
+				BraseroScsiErrCode *error);
+
 BraseroScsiResult
 brasero_mmc2_read_format_capacities (BraseroDeviceHandle *handle,
 				     BraseroScsiFormatCapacitiesHdr **data,
 				     int *size,
 				     BraseroScsiErrCode *error);
+
+BraseroScsiResult
+brasero_mmc2_format_unit (BraseroDeviceHandle *handle,
+			  const BraseroScsiFormattableCapacityDesc *desc,
+			  gboolean immediate,
+			  BraseroScsiErrCode *error);
 G_END_DECLS
 
 #endif /* _SCSI_MMC2_H */
@@ -33,6 +33,7 @@
 #include "scsi-base.h"
 #include "scsi-error.h"
 #include "scsi-device.h"
+#include "scsi-command.h"
 
 #include "scsi-get-performance.h"
 #include "scsi-read-toc-pma-atip.h"
@@ -54,6 +55,13 @@ brasero_mmc3_get_performance_wrt_spd_desc (BraseroDeviceHandle *handle,
 					   int *data_size,
 					   BraseroScsiErrCode *error);
 
+BraseroScsiResult
+brasero_mmc3_get_performance_wrt_spd_desc_async (BraseroDeviceHandle *handle,
+						 BraseroScsiGetPerfData *data,
+						 int size,
+						 BraseroScsiCallback callback,
+						 gpointer user_data);
+
 G_END_DECLS
 
 #endif /* _BURN_MMC3_H */
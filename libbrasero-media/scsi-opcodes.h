@@ -46,6 +46,7 @@ G_BEGIN_DECLS
  */
 
 #define BRASERO_TEST_UNIT_READY_OPCODE			0x00
+#define BRASERO_REQUEST_SENSE_OPCODE			0x03
 #define BRASERO_INQUIRY_OPCODE				0x12
 #define BRASERO_MODE_SENSE_OPCODE			0x5a
 #define BRASERO_MODE_SELECT_OPCODE			0x55
@@ -66,6 +67,8 @@ G_BEGIN_DECLS
 #define BRASERO_LOAD_CD_OPCODE				0xA6
 #define BRASERO_MECH_STATUS_OPCODE			0xBD
 #define BRASERO_READ_CD_OPCODE				0xBE
+#define BRASERO_CLOSE_TRACK_SESSION_OPCODE		0x5B
+#define BRASERO_SET_CD_SPEED_OPCODE			0xBB
 
 /**
  *	MMC2
@@ -76,6 +79,7 @@ G_BEGIN_DECLS
 #define BRASERO_READ_CAPACITY_OPCODE			0x25
 #define BRASERO_READ_FORMAT_CAPACITIES_OPCODE		0x23
 #define BRASERO_READ10_OPCODE				0x28
+#define BRASERO_FORMAT_UNIT_OPCODE			0x04
 
 /**
  *	MMC3
@@ -0,0 +1,561 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Libbrasero-media
+ * Copyright (C) Philippe Rouquier 2005-2009 <bonfire-app@wanadoo.fr>
+ *
+ * Libbrasero-media is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The Libbrasero-media authors hereby grant permission for non-GPL compatible
+ * GStreamer plugins to be used and distributed together with GStreamer
+ * and Libbrasero-media. This permission is above and beyond the permissions granted
+ * by the GPL license by which Libbrasero-media is covered. If you modify this code
+ * you may extend this exception to your version of the code, but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version.
+ * 
+ * Libbrasero-media is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <errno.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "brasero-media-private.h"
+
+#include "scsi-command.h"
+#include "scsi-utils.h"
+#include "scsi-error.h"
+#include "scsi-queue.h"
+
+typedef struct _BraseroScsiCmdStats BraseroScsiCmdStats;
+struct _BraseroScsiCmdStats {
+	guint count;
+	guint coalesced;
+
+	/* In microseconds */
+	gint64 total;
+	gint64 max;
+};
+
+typedef struct _BraseroScsiRequest BraseroScsiRequest;
+struct _BraseroScsiRequest {
+	BraseroScsiCmd *cmd;
+	gpointer buffer;
+	int size;
+
+	BraseroScsiResult result;
+	BraseroScsiErrCode code;
+	int errsv;
+
+	BraseroScsiCallback callback;
+	gpointer user_data;
+
+	/* Thread-default context of the thread that issued the command */
+	GMainContext *context;
+
+	/* Identical read requests that were submitted while this one was
+	 * pending; they get a copy of its result */
+	GSList *followers;
+
+	guint done:1;
+	guint quit:1;
+};
+
+typedef struct _BraseroScsiQueue BraseroScsiQueue;
+struct _BraseroScsiQueue {
+	gchar *path;
+	gint ref;
+
+	GThread *thread;
+	GAsyncQueue *requests;
+
+	/* Protects everything below as well as the
+	 * state of the requests in the queue */
+	GMutex *mutex;
+	GCond *cond;
+
+	GSList *pending;
+	GHashTable *stats;
+};
+
+G_LOCK_DEFINE_STATIC (queues);
+
+/* path -> BraseroScsiQueue */
+static GHashTable *queues = NULL;
+
+/* BraseroDeviceHandle -> BraseroScsiQueue */
+static GHashTable *handles = NULL;
+
+static BraseroScsiCmdStats *
+brasero_scsi_queue_get_cmd_stats (BraseroScsiQueue *queue,
+				  uchar opcode)
+{
+	BraseroScsiCmdStats *stats;
+
+	stats = g_hash_table_lookup (queue->stats, GINT_TO_POINTER (opcode));
+	if (!stats) {
+		stats = g_new0 (BraseroScsiCmdStats, 1);
+		g_hash_table_insert (queue->stats, GINT_TO_POINTER (opcode), stats);
+	}
+
+	return stats;
+}
+
+static gboolean
+brasero_scsi_request_complete (gpointer data)
+{
+	BraseroScsiRequest *request = data;
+
+	if (request->code == BRASERO_SCSI_ERRNO)
+		errno = request->errsv;
+
+	request->callback (request->cmd,
+			   request->result,
+			   request->code,
+			   request->user_data);
+
+	if (request->context)
+		g_main_context_unref (request->context);
+
+	g_free (request);
+	return FALSE;
+}
+
+/**
+ * Must be called with the queue mutex held.
+ * Asynchronous requests are completed in the main loop of the thread that
+ * issued them; synchronous ones are woken up by the broadcast on the queue
+ * condition and free their request.
+ */
+
+static void
+brasero_scsi_request_done (BraseroScsiRequest *request,
+			   BraseroScsiResult result,
+			   BraseroScsiErrCode code,
+			   int errsv)
+{
+	request->result = result;
+	request->code = code;
+	request->errsv = errsv;
+	request->done = TRUE;
+
+	if (request->callback) {
+		GSource *source;
+
+		source = g_idle_source_new ();
+		g_source_set_callback (source,
+				       brasero_scsi_request_complete,
+				       request,
+				       NULL);
+		g_source_attach (source, request->context);
+		g_source_unref (source);
+	}
+}
+
+static gpointer
+brasero_scsi_queue_thread (gpointer data)
+{
+	BraseroScsiQueue *queue = data;
+
+	while (1) {
+		int errsv;
+		GSList *iter;
+		gint64 elapsed;
+		BraseroScsiResult result;
+		BraseroScsiCmdStats *stats;
+		BraseroScsiRequest *request;
+		BraseroScsiErrCode code = BRASERO_SCSI_ERROR_NONE;
+
+		request = g_async_queue_pop (queue->requests);
+		if (request->quit) {
+			g_free (request);
+			break;
+		}
+
+		elapsed = g_get_monotonic_time ();
+		result = brasero_scsi_command_issue_real (request->cmd,
+							  request->buffer,
+							  request->size,
+							  &code);
+		errsv = errno;
+		elapsed = g_get_monotonic_time () - elapsed;
+
+		g_mutex_lock (queue->mutex);
+
+		queue->pending = g_slist_remove (queue->pending, request);
+
+		stats = brasero_scsi_queue_get_cmd_stats (queue, request->cmd->info->opcode);
+		stats->count ++;
+		stats->total += elapsed;
+		stats->max = MAX (stats->max, elapsed);
+
+		for (iter = request->followers; iter; iter = iter->next) {
+			BraseroScsiRequest *follower = iter->data;
+
+			if (follower->buffer && request->buffer)
+				memcpy (follower->buffer, request->buffer, request->size);
+
+			brasero_scsi_request_done (follower, result, code, errsv);
+		}
+		g_slist_free (request->followers);
+		request->followers = NULL;
+
+		brasero_scsi_request_done (request, result, code, errsv);
+
+		g_cond_broadcast (queue->cond);
+		g_mutex_unlock (queue->mutex);
+	}
+
+	return NULL;
+}
+
+static BraseroScsiQueue *
+brasero_scsi_queue_new (const gchar *path)
+{
+	BraseroScsiQueue *queue;
+
+	queue = g_new0 (BraseroScsiQueue, 1);
+	queue->path = g_strdup (path);
+	queue->mutex = g_mutex_new ();
+	queue->cond = g_cond_new ();
+	queue->requests = g_async_queue_new ();
+	queue->stats = g_hash_table_new_full (g_direct_hash,
+					      g_direct_equal,
+					      NULL,
+					      g_free);
+
+	queue->thread = g_thread_create (brasero_scsi_queue_thread,
+					 queue,
+					 TRUE,
+					 NULL);
+	return queue;
+}
+
+static void
+brasero_scsi_queue_free (BraseroScsiQueue *queue)
+{
+	GHashTableIter iter;
+	gpointer key, value;
+	BraseroScsiRequest *quit;
+
+	quit = g_new0 (BraseroScsiRequest, 1);
+	quit->quit = TRUE;
+	g_async_queue_push (queue->requests, quit);
+	g_thread_join (queue->thread);
+
+	g_hash_table_iter_init (&iter, queue->stats);
+	while (g_hash_table_iter_next (&iter, &key, &value)) {
+		BraseroScsiCmdStats *stats = value;
+
+		BRASERO_MEDIA_LOG ("%s: command 0x%02X issued %i times (%i coalesced), average %lli us, max %lli us",
+				   queue->path,
+				   GPOINTER_TO_INT (key),
+				   stats->count,
+				   stats->coalesced,
+				   stats->count ? (long long) (stats->total / stats->count) : 0LL,
+				   (long long) stats->max);
+	}
+
+	g_hash_table_destroy (queue->stats);
+	g_async_queue_unref (queue->requests);
+	g_cond_free (queue->cond);
+	g_mutex_free (queue->mutex);
+	g_free (queue->path);
+	g_free (queue);
+}
+
+void
+brasero_scsi_queue_attach (BraseroDeviceHandle *handle,
+			   const gchar *path)
+{
+	BraseroScsiQueue *queue;
+
+	G_LOCK (queues);
+
+	if (!queues) {
+		queues = g_hash_table_new (g_str_hash, g_str_equal);
+		handles = g_hash_table_new (g_direct_hash, g_direct_equal);
+	}
+
+	queue = g_hash_table_lookup (queues, path);
+	if (!queue) {
+		queue = brasero_scsi_queue_new (path);
+		g_hash_table_insert (queues, queue->path, queue);
+	}
+
+	queue->ref ++;
+	g_hash_table_insert (handles, handle, queue);
+
+	G_UNLOCK (queues);
+}
+
+static gboolean
+brasero_scsi_queue_handle_busy (BraseroScsiQueue *queue,
+				BraseroDeviceHandle *handle)
+{
+	GSList *iter;
+
+	for (iter = queue->pending; iter; iter = iter->next) {
+		BraseroScsiRequest *request = iter->data;
+		GSList *followers;
+
+		if (request->cmd->handle == handle)
+			return TRUE;
+
+		for (followers = request->followers; followers; followers = followers->next) {
+			BraseroScsiRequest *follower = followers->data;
+
+			if (follower->cmd->handle == handle)
+				return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+void
+brasero_scsi_queue_detach (BraseroDeviceHandle *handle)
+{
+	BraseroScsiQueue *queue;
+
+	G_LOCK (queues);
+
+	queue = handles ? g_hash_table_lookup (handles, handle) : NULL;
+	if (!queue) {
+		G_UNLOCK (queues);
+		return;
+	}
+
+	g_hash_table_remove (handles, handle);
+	G_UNLOCK (queues);
+
+	/* Don't let the handle go while some of its asynchronous
+	 * commands are pending. The queue can't be freed meanwhile
+	 * since we still hold the reference of the handle.
+	 * The global lock is not held while waiting so that other
+	 * drives and handles can still be opened and closed. */
+	g_mutex_lock (queue->mutex);
+	while (brasero_scsi_queue_handle_busy (queue, handle))
+		g_cond_wait (queue->cond, queue->mutex);
+	g_mutex_unlock (queue->mutex);
+
+	G_LOCK (queues);
+
+	queue->ref --;
+	if (queue->ref <= 0) {
+		g_hash_table_remove (queues, queue->path);
+		brasero_scsi_queue_free (queue);
+	}
+
+	G_UNLOCK (queues);
+}
+
+static gboolean
+brasero_scsi_request_equal (BraseroScsiRequest *request1,
+			    BraseroScsiRequest *request2)
+{
+	if (request1->cmd->info != request2->cmd->info)
+		return FALSE;
+
+	if (request1->size != request2->size)
+		return FALSE;
+
+	if ((request1->buffer == NULL) != (request2->buffer == NULL))
+		return FALSE;
+
+	return !memcmp (request1->cmd->cmd,
+			request2->cmd->cmd,
+			request1->cmd->info->size);
+}
+
+static void
+brasero_scsi_queue_push (BraseroScsiQueue *queue,
+			 BraseroScsiRequest *request)
+{
+	g_mutex_lock (queue->mutex);
+
+	/* Reads that are identical to a pending one (same CDB, same size)
+	 * are not sent again to the drive; they share its result. This
+	 * happens a lot when several probes run at the same time. */
+	if (request->cmd->info->direction & BRASERO_SCSI_READ) {
+		GSList *iter;
+
+		for (iter = queue->pending; iter; iter = iter->next) {
+			BraseroScsiRequest *leader = iter->data;
+			BraseroScsiCmdStats *stats;
+
+			if (!brasero_scsi_request_equal (leader, request))
+				continue;
+
+			leader->followers = g_slist_prepend (leader->followers, request);
+
+			stats = brasero_scsi_queue_get_cmd_stats (queue, request->cmd->info->opcode);
+			stats->coalesced ++;
+
+			g_mutex_unlock (queue->mutex);
+			return;
+		}
+	}
+
+	queue->pending = g_slist_append (queue->pending, request);
+	g_mutex_unlock (queue->mutex);
+
+	g_async_queue_push (queue->requests, request);
+}
+
+static BraseroScsiQueue *
+brasero_scsi_queue_lookup (BraseroDeviceHandle *handle)
+{
+	BraseroScsiQueue *queue = NULL;
+
+	G_LOCK (queues);
+	if (handles)
+		queue = g_hash_table_lookup (handles, handle);
+	G_UNLOCK (queues);
+
+	return queue;
+}
+
+BraseroScsiResult
+brasero_scsi_command_issue_sync (gpointer command,
+				 gpointer buffer,
+				 int size,
+				 BraseroScsiErrCode *error)
+{
+	BraseroScsiRequest *request;
+	BraseroScsiQueue *queue;
+	BraseroScsiResult result;
+	BraseroScsiCmd *cmd;
+
+	g_return_val_if_fail (command != NULL, BRASERO_SCSI_FAILURE);
+
+	cmd = command;
+
+	/* The queue can't go away as long as the handle is attached */
+	queue = brasero_scsi_queue_lookup (cmd->handle);
+	if (!queue)
+		return brasero_scsi_command_issue_real (cmd, buffer, size, error);
+
+	request = g_new0 (BraseroScsiRequest, 1);
+	request->cmd = cmd;
+	request->buffer = buffer;
+	request->size = size;
+
+	brasero_scsi_queue_push (queue, request);
+
+	g_mutex_lock (queue->mutex);
+	while (!request->done)
+		g_cond_wait (queue->cond, queue->mutex);
+	g_mutex_unlock (queue->mutex);
+
+	result = request->result;
+	if (result != BRASERO_SCSI_OK && error) {
+		*error = request->code;
+		if (request->code == BRASERO_SCSI_ERRNO)
+			errno = request->errsv;
+	}
+
+	g_free (request);
+	return result;
+}
+
+/**
+ * The command is sent once all previous commands for the drive have been
+ * executed and @callback is called from the thread-default main context of
+ * the calling thread (the global default one for the main thread). Neither the command
+ * nor @buffer must be freed before that; the handle may be closed at any
+ * time since closing it waits for its pending commands.
+ */
+
+BraseroScsiResult
+brasero_scsi_command_issue_async (gpointer command,
+				  gpointer buffer,
+				  int size,
+				  BraseroScsiCallback callback,
+				  gpointer user_data)
+{
+	BraseroScsiRequest *request;
+	BraseroScsiQueue *queue;
+	BraseroScsiCmd *cmd;
+
+	g_return_val_if_fail (command != NULL, BRASERO_SCSI_FAILURE);
+	g_return_val_if_fail (callback != NULL, BRASERO_SCSI_FAILURE);
+
+	cmd = command;
+	queue = brasero_scsi_queue_lookup (cmd->handle);
+	if (!queue)
+		return BRASERO_SCSI_FAILURE;
+
+	request = g_new0 (BraseroScsiRequest, 1);
+	request->cmd = cmd;
+	request->buffer = buffer;
+	request->size = size;
+	request->callback = callback;
+	request->user_data = user_data;
+
+	request->context = g_main_context_get_thread_default ();
+	if (request->context)
+		g_main_context_ref (request->context);
+
+	brasero_scsi_queue_push (queue, request);
+	return BRASERO_SCSI_OK;
+}
+
+/**
+ * Returns statistics about a command for a drive currently opened.
+ * @average and @max are in microseconds.
+ */
+
+gboolean
+brasero_scsi_queue_get_stats (const gchar *path,
+			      uchar opcode,
+			      guint *count,
+			      guint *coalesced,
+			      gint64 *average,
+			      gint64 *max)
+{
+	BraseroScsiCmdStats *stats;
+	BraseroScsiQueue *queue;
+
+	G_LOCK (queues);
+
+	queue = queues ? g_hash_table_lookup (queues, path) : NULL;
+	if (!queue) {
+		G_UNLOCK (queues);
+		return FALSE;
+	}
+
+	g_mutex_lock (queue->mutex);
+	stats = g_hash_table_lookup (queue->stats, GINT_TO_POINTER (opcode));
+	if (stats) {
+		if (count)
+			*count = stats->count;
+		if (coalesced)
+			*coalesced = stats->coalesced;
+		if (average)
+			*average = stats->count ? stats->total / stats->count : 0;
+		if (max)
+			*max = stats->max;
+	}
+	g_mutex_unlock (queue->mutex);
+
+	G_UNLOCK (queues);
+	return stats != NULL;
+}
@@ -0,0 +1,64 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Libbrasero-media
+ * Copyright (C) Philippe Rouquier 2005-2009 <bonfire-app@wanadoo.fr>
+ *
+ * Libbrasero-media is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The Libbrasero-media authors hereby grant permission for non-GPL compatible
+ * GStreamer plugins to be used and distributed together with GStreamer
+ * and Libbrasero-media. This permission is above and beyond the permissions granted
+ * by the GPL license by which Libbrasero-media is covered. If you modify this code
+ * you may extend this exception to your version of the code, but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version.
+ * 
+ * Libbrasero-media is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+#include <glib.h>
+
+#include "scsi-base.h"
+#include "scsi-device.h"
+
+#ifndef _SCSI_QUEUE_H
+#define _SCSI_QUEUE_H
+
+G_BEGIN_DECLS
+
+/**
+ * Every device handle is attached to the command queue of the drive it was
+ * opened for. All commands sent to a drive, whatever the handle and the
+ * thread they come from, are then executed in order by a single thread.
+ */
+
+void
+brasero_scsi_queue_attach (BraseroDeviceHandle *handle,
+			   const gchar *path);
+
+void
+brasero_scsi_queue_detach (BraseroDeviceHandle *handle);
+
+gboolean
+brasero_scsi_queue_get_stats (const gchar *path,
+			      uchar opcode,
+			      guint *count,
+			      guint *coalesced,
+			      gint64 *average,
+			      gint64 *max);
+
+G_END_DECLS
+
+#endif /* _SCSI_QUEUE_H */
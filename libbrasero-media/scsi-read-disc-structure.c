@@ -168,6 +168,25 @@ brasero_mmc2_read_generic_structure (BraseroDeviceHandle *handle,
 	return res;
 }
 
+BraseroScsiResult
+brasero_mmc5_read_bd_structure (BraseroDeviceHandle *handle,
+				BraseroScsiBDFormatType type,
+				BraseroScsiReadDiscStructureHdr **data,
+				int *size,
+				BraseroScsiErrCode *error)
+{
+	BraseroReadDiscStructureCDB *cdb;
+	BraseroScsiResult res;
+
+	cdb = brasero_scsi_command_new (&info, handle);
+	cdb->format = type;
+	cdb->media_type = BRASERO_MEDIA_BD;
+
+	res = brasero_read_disc_structure (cdb, data, size, error);
+	brasero_scsi_command_free (cdb);
+	return res;
+}
+
 #if 0
 
 /* So far this function only creates a warning at
@@ -195,23 +214,4 @@ brasero_mmc2_read_dvd_structure (BraseroDeviceHandle *handle,
 	return res;
 }
 
-BraseroScsiResult
-brasero_mmc5_read_bd_structure (BraseroDeviceHandle *handle,
-				BraseroScsiBDFormatType type,
-				BraseroScsiReadDiscStructureHdr **data,
-				int *size,
-				BraseroScsiErrCode *error)
-{
-	BraseroReadDiscStructureCDB *cdb;
-	BraseroScsiResult res;
-
-	cdb = brasero_scsi_command_new (&info, handle);
-	cdb->format = type;
-	cdb->media_type = BRASERO_MEDIA_BD;
-
-	res = brasero_read_disc_structure (cdb, data, size, error);
-	brasero_scsi_command_free (cdb);
-	return res;
-}
-
 #endif
@@ -81,7 +81,7 @@ struct _BraseroScsiMaxCapacityDesc{
 struct _BraseroScsiFormattableCapacityDesc{
 	uchar blocks_num			[4];
 
-	uchar reserved				:2;
+	uchar subtype				:2;	/* BD only */
 	uchar format_type			:6;
 
 	uchar type_param			[3];
@@ -102,7 +102,7 @@ struct _BraseroScsiFormattableCapacityDesc {
 	uchar blocks_num			[4];
 
 	uchar format_type			:6;
-	uchar reserved				:2;
+	uchar subtype				:2;	/* BD only */
 
 	uchar type_param			[3];
 };
@@ -186,3 +186,38 @@ brasero_mmc1_read_track_info (BraseroDeviceHandle *handle,
 
 	return res;
 }
+
+/**
+ * Asynchronous version: @track_info is filled with at most @size bytes.
+ * @callback is responsible for freeing the command with
+ * brasero_scsi_command_free ().
+ */
+
+BraseroScsiResult
+brasero_mmc1_read_track_info_async (BraseroDeviceHandle *handle,
+				    int track_num,
+				    BraseroScsiTrackInfo *track_info,
+				    int size,
+				    BraseroScsiCallback callback,
+				    gpointer user_data)
+{
+	BraseroRdTrackInfoCDB *cdb;
+	BraseroScsiResult res;
+
+	g_return_val_if_fail (handle != NULL, BRASERO_SCSI_FAILURE);
+	g_return_val_if_fail (track_info != NULL, BRASERO_SCSI_FAILURE);
+
+	size = MIN (size, sizeof (BraseroScsiTrackInfo));
+
+	cdb = brasero_scsi_command_new (&info, handle);
+	cdb->addr_num_type = BRASERO_FIELD_TRACK_NUM;
+	BRASERO_SET_32 (cdb->blk_addr_trk_ses_num, track_num);
+	BRASERO_SET_16 (cdb->alloc_len, size);
+
+	memset (track_info, 0, sizeof (BraseroScsiTrackInfo));
+	res = brasero_scsi_command_issue_async (cdb, track_info, size, callback, user_data);
+	if (res != BRASERO_SCSI_OK)
+		brasero_scsi_command_free (cdb);
+
+	return res;
+}
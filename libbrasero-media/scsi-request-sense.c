@@ -0,0 +1,116 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Libbrasero-media
+ * Copyright (C) Philippe Rouquier 2005-2009 <bonfire-app@wanadoo.fr>
+ *
+ * Libbrasero-media is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The Libbrasero-media authors hereby grant permission for non-GPL compatible
+ * GStreamer plugins to be used and distributed together with GStreamer
+ * and Libbrasero-media. This permission is above and beyond the permissions granted
+ * by the GPL license by which Libbrasero-media is covered. If you modify this code
+ * you may extend this exception to your version of the code, but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version.
+ * 
+ * Libbrasero-media is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "scsi-spc1.h"
+
+#include "scsi-error.h"
+#include "scsi-utils.h"
+#include "scsi-base.h"
+#include "scsi-command.h"
+#include "scsi-opcodes.h"
+#include "scsi-sense-data.h"
+
+struct _BraseroRequestSenseCDB {
+	uchar opcode;
+	uchar reserved		[3];
+	uchar alloc_len;
+	uchar ctl;
+};
+
+typedef struct _BraseroRequestSenseCDB BraseroRequestSenseCDB;
+
+BRASERO_SCSI_COMMAND_DEFINE (BraseroRequestSenseCDB,
+			     REQUEST_SENSE,
+			     BRASERO_SCSI_READ);
+
+/* Fixed format sense data: sense key (byte 2), ASC/ASCQ (bytes 12 and 13)
+ * and the sense key specific bytes (15 to 17). When SKSV is set and the
+ * sense key is NOT READY or NO SENSE, bytes 16 and 17 hold the progress of
+ * the operation as a fraction of 65536. */
+#define SENSE_KEY_NO_SENSE		0x00
+#define SENSE_KEY_NOT_READY		0x02
+#define SENSE_SKSV			0x80
+
+/**
+ * REQUEST SENSE command (defined in SPC, Scsi Primary Commands).
+ * Returns in progress how far the operation the drive is busy with (like a
+ * FORMAT UNIT with IMMED set) has gone, from 0 to 65535, or -1 if the drive
+ * does not report any progress.
+ */
+
+BraseroScsiResult
+brasero_spc1_request_sense_progress (BraseroDeviceHandle *handle,
+				     int *progress,
+				     BraseroScsiErrCode *error)
+{
+	uchar sense [BRASERO_SENSE_DATA_SIZE];
+	BraseroRequestSenseCDB *cdb;
+	BraseroScsiResult res;
+	uchar key;
+
+	g_return_val_if_fail (handle != NULL, BRASERO_SCSI_FAILURE);
+	g_return_val_if_fail (progress != NULL, BRASERO_SCSI_FAILURE);
+
+	*progress = -1;
+	memset (sense, 0, sizeof (sense));
+
+	cdb = brasero_scsi_command_new (&info, handle);
+	cdb->alloc_len = sizeof (sense);
+	res = brasero_scsi_command_issue_sync (cdb,
+					       sense,
+					       sizeof (sense),
+					       error);
+	brasero_scsi_command_free (cdb);
+	if (res != BRASERO_SCSI_OK)
+		return res;
+
+	/* Only fixed format (current or deferred errors) is handled */
+	if ((sense [0] & 0x7E) != 0x70)
+		return BRASERO_SCSI_OK;
+
+	key = sense [2] & 0x0F;
+	if (key != SENSE_KEY_NO_SENSE && key != SENSE_KEY_NOT_READY)
+		return BRASERO_SCSI_OK;
+
+	if (sense [15] & SENSE_SKSV)
+		*progress = (sense [16] << 8) | sense [17];
+
+	return BRASERO_SCSI_OK;
+}
+
+ 
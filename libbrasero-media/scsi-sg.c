@@ -47,6 +47,7 @@
 #include "brasero-media-private.h"
 
 #include "scsi-command.h"
+#include "scsi-queue.h"
 #include "scsi-utils.h"
 #include "scsi-error.h"
 #include "scsi-sense-data.h"
@@ -55,14 +56,6 @@ struct _BraseroDeviceHandle {
 	int fd;
 };
 
-struct _BraseroScsiCmd {
-	uchar cmd [BRASERO_SCSI_CMD_MAX_LEN];
-	BraseroDeviceHandle *handle;
-
-	const BraseroScsiCmdInfo *info;
-};
-typedef struct _BraseroScsiCmd BraseroScsiCmd;
-
 #define BRASERO_SCSI_CMD_OPCODE_OFF			0
 #define BRASERO_SCSI_CMD_SET_OPCODE(command)		(command->cmd [BRASERO_SCSI_CMD_OPCODE_OFF] = command->info->opcode)
 
@@ -100,7 +93,7 @@ brasero_sg_command_setup (struct sg_io_hdr *transport,
 }
 
 BraseroScsiResult
-brasero_scsi_command_issue_sync (gpointer command,
+brasero_scsi_command_issue_real (gpointer command,
 				 gpointer buffer,
 				 int size,
 				 BraseroScsiErrCode *error)
@@ -197,6 +190,8 @@ brasero_device_handle_open (const gchar *path,
 	handle = g_new (BraseroDeviceHandle, 1);
 	handle->fd = fd;
 
+	brasero_scsi_queue_attach (handle, path);
+
 	BRASERO_MEDIA_LOG ("Handle ready");
 	return handle;
 }
@@ -204,6 +199,7 @@ brasero_device_handle_open (const gchar *path,
 void
 brasero_device_handle_close (BraseroDeviceHandle *handle)
 {
+	brasero_scsi_queue_detach (handle);
 	close (handle->fd);
 	g_free (handle);
 }
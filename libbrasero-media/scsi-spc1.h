@@ -46,6 +46,11 @@ BraseroScsiResult
 brasero_spc1_test_unit_ready (BraseroDeviceHandle *handle,
 			      BraseroScsiErrCode *error);
 
+BraseroScsiResult
+brasero_spc1_request_sense_progress (BraseroDeviceHandle *handle,
+				     int *progress,
+				     BraseroScsiErrCode *error);
+
 BraseroScsiResult
 brasero_spc1_mode_sense_get_page (BraseroDeviceHandle *handle,
 				  BraseroSPCPageType num,
@@ -45,6 +45,7 @@
 
 #include "brasero-media-private.h"
 #include "scsi-command.h"
+#include "scsi-queue.h"
 #include "scsi-utils.h"
 #include "scsi-error.h"
 #include "scsi-sense-data.h"
@@ -55,14 +56,6 @@ struct _BraseroDeviceHandle {
 	int fd;
 };
 
-struct _BraseroScsiCmd {
-	uchar cmd [BRASERO_SCSI_CMD_MAX_LEN];
-	BraseroDeviceHandle *handle;
-
-	const BraseroScsiCmdInfo *info;
-};
-typedef struct _BraseroScsiCmd BraseroScsiCmd;
-
 #define BRASERO_SCSI_CMD_OPCODE_OFF			0
 #define BRASERO_SCSI_CMD_SET_OPCODE(command)		(command->cmd [BRASERO_SCSI_CMD_OPCODE_OFF] = command->info->opcode)
 
@@ -91,7 +84,7 @@ dump_cdb(guchar *cdb, gint cdblen)
  * This is to send a command
  */
 BraseroScsiResult
-brasero_scsi_command_issue_sync (gpointer command,
+brasero_scsi_command_issue_real (gpointer command,
 				 gpointer buffer,
 				 int size,
 				 BraseroScsiErrCode *error)
@@ -233,12 +226,15 @@ brasero_device_handle_open (const gchar *path,
 	handle = g_new (BraseroDeviceHandle, 1);
 	handle->fd = fd;
 
+	brasero_scsi_queue_attach (handle, path);
+
 	return handle;
 }
 
 void
 brasero_device_handle_close (BraseroDeviceHandle *handle)
 {
+	brasero_scsi_queue_detach (handle);
 	close (handle->fd);
 	g_free (handle);
 }
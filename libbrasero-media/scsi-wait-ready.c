@@ -0,0 +1,143 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Libbrasero-media
+ * Copyright (C) Philippe Rouquier 2005-2009 <bonfire-app@wanadoo.fr>
+ *
+ * Libbrasero-media is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The Libbrasero-media authors hereby grant permission for non-GPL compatible
+ * GStreamer plugins to be used and distributed together with GStreamer
+ * and Libbrasero-media. This permission is above and beyond the permissions granted
+ * by the GPL license by which Libbrasero-media is covered. If you modify this code
+ * you may extend this exception to your version of the code, but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version.
+ * 
+ * Libbrasero-media is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <glib.h>
+
+#include "brasero-media-private.h"
+
+#include "scsi-error.h"
+#include "scsi-utils.h"
+#include "scsi-device.h"
+#include "scsi-spc1.h"
+#include "scsi-wait-ready.h"
+
+/**
+ * Delays (in ms) between two attempts. We start low since most of the time a
+ * drive becomes ready within a few hundred milliseconds after the tray was
+ * closed and back off exponentially so that a slow drive is not hammered.
+ * The open timeout matches the former 5 attempts at 1 second intervals.
+ */
+
+#define BRASERO_WAIT_MIN_DELAY		50
+#define BRASERO_WAIT_MAX_DELAY		1000
+#define BRASERO_WAIT_OPEN_TIMEOUT	6000
+
+/**
+ * Sleeps for *delay ms unless someone signals @wakeup (cancellation or a
+ * media change event). Returns TRUE if it was woken up in which case the
+ * delay is reset; otherwise the delay is doubled for the next time.
+ */
+
+static gboolean
+brasero_device_wait (GMutex *mutex,
+		     GCond *wakeup,
+		     guint *delay)
+{
+	GTimeVal wait_time;
+	gboolean woken;
+
+	g_get_current_time (&wait_time);
+	g_time_val_add (&wait_time, *delay * 1000);
+
+	g_mutex_lock (mutex);
+	woken = g_cond_timed_wait (wakeup, mutex, &wait_time);
+	g_mutex_unlock (mutex);
+
+	if (woken)
+		*delay = BRASERO_WAIT_MIN_DELAY;
+	else
+		*delay = MIN (*delay * 2, BRASERO_WAIT_MAX_DELAY);
+
+	return woken;
+}
+
+BraseroDeviceHandle *
+brasero_device_handle_open_wait (const gchar *path,
+				 GMutex *mutex,
+				 GCond *wakeup,
+				 BraseroDeviceCancelledFunc cancelled,
+				 gpointer data,
+				 BraseroScsiErrCode *error)
+{
+	BraseroDeviceHandle *handle;
+	guint delay = BRASERO_WAIT_MIN_DELAY;
+	guint waited = 0;
+
+	/* the drive might be busy (a burning is going on) so we don't block
+	 * but we re-try to open it with increasing intervals */
+	handle = brasero_device_handle_open (path, FALSE, error);
+	while (!handle && waited < BRASERO_WAIT_OPEN_TIMEOUT) {
+		waited += delay;
+		brasero_device_wait (mutex, wakeup, &delay);
+
+		if (cancelled (data))
+			return NULL;
+
+		handle = brasero_device_handle_open (path, FALSE, error);
+	}
+
+	return handle;
+}
+
+BraseroScsiResult
+brasero_device_handle_wait_ready (BraseroDeviceHandle *handle,
+				  GMutex *mutex,
+				  GCond *wakeup,
+				  BraseroDeviceCancelledFunc cancelled,
+				  gpointer data,
+				  BraseroScsiErrCode *error)
+{
+	guint delay = BRASERO_WAIT_MIN_DELAY;
+	BraseroScsiErrCode code;
+
+	/* Only TEST UNIT READY is used here. Polling the drive for media
+	 * events (GET EVENT STATUS NOTIFICATION) would consume them before
+	 * the kernel and udisks see them. Media changes reach us through
+	 * @wakeup instead. */
+	while (brasero_spc1_test_unit_ready (handle, &code) != BRASERO_SCSI_OK) {
+		if (code != BRASERO_SCSI_NOT_READY) {
+			BRASERO_SCSI_SET_ERRCODE (error, code);
+			return BRASERO_SCSI_FAILURE;
+		}
+
+		brasero_device_wait (mutex, wakeup, &delay);
+
+		if (cancelled (data)) {
+			BRASERO_SCSI_SET_ERRCODE (error, BRASERO_SCSI_NOT_READY);
+			return BRASERO_SCSI_FAILURE;
+		}
+	}
+
+	return BRASERO_SCSI_OK;
+}
@@ -0,0 +1,390 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Libbrasero-misc
+ * Copyright (C) Philippe Rouquier 2005-2009 <bonfire-app@wanadoo.fr>
+ *
+ * Libbrasero-misc is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The Libbrasero-misc authors hereby grant permission for non-GPL compatible
+ * GStreamer plugins to be used and distributed together with GStreamer
+ * and Libbrasero-misc. This permission is above and beyond the permissions granted
+ * by the GPL license by which Libbrasero-burn is covered. If you modify this code
+ * you may extend this exception to your version of the code, but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version.
+ * 
+ * Libbrasero-misc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <glib.h>
+
+#include <gio/gio.h>
+
+#include "brasero-dir-scan.h"
+
+/* Number of directories read at the same time when counting */
+#define BRASERO_DIR_SCAN_THREADS	4
+
+static gboolean
+brasero_dir_scan_is_dot (const gchar *name)
+{
+	return (name [0] == '.'
+	    && (name [1] == '\0'
+	    || (name [1] == '.' && name [2] == '\0')));
+}
+
+static GFileType
+brasero_dir_scan_file_type (mode_t mode)
+{
+	if (S_ISREG (mode))
+		return G_FILE_TYPE_REGULAR;
+	if (S_ISDIR (mode))
+		return G_FILE_TYPE_DIRECTORY;
+	if (S_ISLNK (mode))
+		return G_FILE_TYPE_SYMBOLIC_LINK;
+
+	return G_FILE_TYPE_SPECIAL;
+}
+
+/**
+ * Same semantics as GIO: without FOLLOW_SYMLINKS a symlink is reported as
+ * such with its own size; with it, the target is reported (unless it is
+ * dangling) but the entry is still flagged as a symlink.
+ */
+
+static gboolean
+brasero_dir_scan_stat (int dir_fd,
+		       const gchar *name,
+		       BraseroDirScanFlags flags,
+		       struct stat *info,
+		       gboolean *is_symlink)
+{
+	if (fstatat (dir_fd, name, info, AT_SYMLINK_NOFOLLOW))
+		return FALSE;
+
+	*is_symlink = S_ISLNK (info->st_mode);
+	if (*is_symlink && (flags & BRASERO_DIR_SCAN_FOLLOW_SYMLINKS)) {
+		struct stat target;
+
+		if (!fstatat (dir_fd, name, &target, 0))
+			*info = target;
+	}
+
+	return TRUE;
+}
+
+BraseroDirListing *
+brasero_dir_scan_list (const gchar *path,
+		       BraseroDirScanFlags flags,
+		       GCancellable *cancel,
+		       GError **error)
+{
+	BraseroDirListing *listing;
+	struct dirent *dirent;
+	DIR *dir;
+	int fd;
+
+	dir = opendir (path);
+	if (!dir) {
+		int errsv = errno;
+
+		g_set_error (error,
+			     G_IO_ERROR,
+			     g_io_error_from_errno (errsv),
+			     "%s",
+			     g_strerror (errsv));
+		return NULL;
+	}
+
+	fd = dirfd (dir);
+
+	listing = g_new0 (BraseroDirListing, 1);
+	listing->array = g_array_new (FALSE, FALSE, sizeof (BraseroDirEntry));
+	listing->strings = g_string_chunk_new (4096);
+
+	while ((dirent = readdir (dir))) {
+		BraseroDirEntry entry = { NULL, };
+		gboolean is_symlink;
+		struct stat info;
+
+		if (g_cancellable_is_cancelled (cancel))
+			break;
+
+		if (brasero_dir_scan_is_dot (dirent->d_name))
+			continue;
+
+		entry.name = g_string_chunk_insert (listing->strings, dirent->d_name);
+		if (!brasero_dir_scan_stat (fd, dirent->d_name, flags, &info, &is_symlink)) {
+			/* Like GIO, files removed in the meantime are ignored */
+			if (errno == ENOENT)
+				continue;
+
+			entry.error = errno;
+			entry.type = G_FILE_TYPE_UNKNOWN;
+			g_array_append_val (listing->array, entry);
+			continue;
+		}
+
+		entry.size = info.st_size;
+		entry.type = brasero_dir_scan_file_type (info.st_mode);
+		entry.is_symlink = is_symlink;
+
+		if (is_symlink) {
+			gchar *link_path;
+			gchar *target;
+
+			link_path = g_build_filename (path, dirent->d_name, NULL);
+			target = g_file_read_link (link_path, NULL);
+			g_free (link_path);
+
+			if (target) {
+				entry.symlink_target = g_string_chunk_insert (listing->strings, target);
+				g_free (target);
+			}
+		}
+
+		if (flags & BRASERO_DIR_SCAN_CHECK_READ)
+			entry.can_read = (faccessat (fd, dirent->d_name, R_OK, 0) == 0);
+
+		g_array_append_val (listing->array, entry);
+	}
+
+	closedir (dir);
+
+	listing->entries = (BraseroDirEntry *) listing->array->data;
+	listing->entries_num = listing->array->len;
+	return listing;
+}
+
+void
+brasero_dir_listing_free (BraseroDirListing *listing)
+{
+	g_array_free (listing->array, TRUE);
+	g_string_chunk_free (listing->strings);
+	g_free (listing);
+}
+
+/**
+ * Recursive counting. Directories are handed over to a thread pool so that
+ * several of them are read at the same time, which matters for network
+ * mounts and for disks with a deep queue.
+ */
+
+typedef struct _BraseroDirCountId BraseroDirCountId;
+struct _BraseroDirCountId {
+	dev_t dev;
+	ino_t ino;
+};
+
+static guint
+brasero_dir_count_id_hash (gconstpointer data)
+{
+	const BraseroDirCountId *id = data;
+
+	return (guint) id->ino ^ (guint) ((guint64) id->ino >> 32) ^ (guint) id->dev;
+}
+
+static gboolean
+brasero_dir_count_id_equal (gconstpointer data1,
+			    gconstpointer data2)
+{
+	const BraseroDirCountId *id1 = data1;
+	const BraseroDirCountId *id2 = data2;
+
+	return id1->ino == id2->ino && id1->dev == id2->dev;
+}
+
+typedef struct _BraseroDirCountCtx BraseroDirCountCtx;
+struct _BraseroDirCountCtx {
+	GThreadPool *pool;
+
+	/* Protects everything below as well as the counters */
+	GMutex *mutex;
+	GCond *cond;
+
+	gint pending;
+
+	/* Directories already read when following symlinks so
+	 * that a link to one of its ancestors doesn't loop */
+	GHashTable *visited;
+
+	BraseroDirScanFlags flags;
+	GCancellable *cancel;
+	BraseroDirCount *count;
+};
+
+static gboolean
+brasero_dir_scan_count_visit (BraseroDirCountCtx *ctx,
+			      DIR *dir)
+{
+	BraseroDirCountId *id;
+	struct stat info;
+	gboolean res;
+
+	if (!ctx->visited)
+		return TRUE;
+
+	if (fstat (dirfd (dir), &info))
+		return TRUE;
+
+	id = g_new0 (BraseroDirCountId, 1);
+	id->dev = info.st_dev;
+	id->ino = info.st_ino;
+
+	g_mutex_lock (ctx->mutex);
+	res = (g_hash_table_lookup (ctx->visited, id) == NULL);
+	if (res)
+		g_hash_table_insert (ctx->visited, id, id);
+	else
+		g_free (id);
+	g_mutex_unlock (ctx->mutex);
+
+	return res;
+}
+
+static void
+brasero_dir_scan_count_directory (gpointer data,
+				  gpointer user_data)
+{
+	BraseroDirCountCtx *ctx = user_data;
+	BraseroDirCount local = { 0, };
+	struct dirent *dirent;
+	gchar *path = data;
+	DIR *dir = NULL;
+
+	if (!g_cancellable_is_cancelled (ctx->cancel))
+		dir = opendir (path);
+
+	if (dir && !brasero_dir_scan_count_visit (ctx, dir)) {
+		closedir (dir);
+		dir = NULL;
+	}
+
+	while (dir && (dirent = readdir (dir))) {
+		gboolean is_symlink;
+		struct stat info;
+		GFileType type;
+
+		if (g_cancellable_is_cancelled (ctx->cancel))
+			break;
+
+		if (brasero_dir_scan_is_dot (dirent->d_name))
+			continue;
+
+		local.files_num ++;
+
+		/* d_type saves a stat () for directories */
+		if (dirent->d_type == DT_DIR)
+			type = G_FILE_TYPE_DIRECTORY;
+		else if (!brasero_dir_scan_stat (dirfd (dir), dirent->d_name, ctx->flags, &info, &is_symlink)) {
+			local.files_invalid ++;
+			continue;
+		}
+		else if (is_symlink && !S_ISDIR (info.st_mode))
+			type = G_FILE_TYPE_SYMBOLIC_LINK;
+		else
+			type = brasero_dir_scan_file_type (info.st_mode);
+
+		if (type == G_FILE_TYPE_REGULAR
+		||  type == G_FILE_TYPE_SYMBOLIC_LINK)
+			local.total_b += info.st_size;
+		else if (type == G_FILE_TYPE_DIRECTORY) {
+			g_mutex_lock (ctx->mutex);
+			ctx->pending ++;
+			g_mutex_unlock (ctx->mutex);
+
+			g_thread_pool_push (ctx->pool,
+					    g_build_filename (path, dirent->d_name, NULL),
+					    NULL);
+		}
+	}
+
+	if (dir)
+		closedir (dir);
+
+	g_free (path);
+
+	g_mutex_lock (ctx->mutex);
+	ctx->count->files_num += local.files_num;
+	ctx->count->files_invalid += local.files_invalid;
+	ctx->count->total_b += local.total_b;
+
+	ctx->pending --;
+	if (!ctx->pending)
+		g_cond_signal (ctx->cond);
+	g_mutex_unlock (ctx->mutex);
+}
+
+/**
+ * Counts the files below @path (not @path itself) and adds their number and
+ * size to @count which is updated while the scan goes on, with count->mutex
+ * held if it is set. With BRASERO_DIR_SCAN_FOLLOW_SYMLINKS a directory
+ * reachable through several links is only counted once.
+ */
+
+void
+brasero_dir_scan_count (const gchar *path,
+			BraseroDirScanFlags flags,
+			GCancellable *cancel,
+			BraseroDirCount *count)
+{
+	BraseroDirCountCtx ctx = { NULL, };
+
+	ctx.flags = flags;
+	ctx.cancel = cancel;
+	ctx.count = count;
+	ctx.mutex = count->mutex? count->mutex:g_mutex_new ();
+	ctx.cond = g_cond_new ();
+	ctx.pending = 1;
+
+	if (flags & BRASERO_DIR_SCAN_FOLLOW_SYMLINKS)
+		ctx.visited = g_hash_table_new_full (brasero_dir_count_id_hash,
+						     brasero_dir_count_id_equal,
+						     g_free,
+						     NULL);
+
+	ctx.pool = g_thread_pool_new (brasero_dir_scan_count_directory,
+				      &ctx,
+				      BRASERO_DIR_SCAN_THREADS,
+				      FALSE,
+				      NULL);
+	g_thread_pool_push (ctx.pool, g_strdup (path), NULL);
+
+	g_mutex_lock (ctx.mutex);
+	while (ctx.pending)
+		g_cond_wait (ctx.cond, ctx.mutex);
+	g_mutex_unlock (ctx.mutex);
+
+	g_thread_pool_free (ctx.pool, FALSE, TRUE);
+
+	if (ctx.visited)
+		g_hash_table_destroy (ctx.visited);
+
+	g_cond_free (ctx.cond);
+	if (ctx.mutex != count->mutex)
+		g_mutex_free (ctx.mutex);
+}
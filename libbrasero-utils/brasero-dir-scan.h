@@ -0,0 +1,108 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Libbrasero-misc
+ * Copyright (C) Philippe Rouquier 2005-2009 <bonfire-app@wanadoo.fr>
+ *
+ * Libbrasero-misc is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The Libbrasero-misc authors hereby grant permission for non-GPL compatible
+ * GStreamer plugins to be used and distributed together with GStreamer
+ * and Libbrasero-misc. This permission is above and beyond the permissions granted
+ * by the GPL license by which Libbrasero-burn is covered. If you modify this code
+ * you may extend this exception to your version of the code, but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version.
+ * 
+ * Libbrasero-misc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+#ifndef _BRASERO_DIR_SCAN_H_
+#define _BRASERO_DIR_SCAN_H_
+
+#include <glib.h>
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/**
+ * Native directory scanning for local files. GIO allocates a GFile, a URI and
+ * a GFileInfo with a hash table of attributes for each entry which is a lot
+ * when a tree holds millions of files. These functions read directories with
+ * readdir () and fstatat () relative to the directory descriptor and return
+ * compact records instead.
+ */
+
+typedef enum {
+	BRASERO_DIR_SCAN_NONE			= 0,
+	BRASERO_DIR_SCAN_FOLLOW_SYMLINKS	= 1,
+	BRASERO_DIR_SCAN_CHECK_READ		= 1 << 1
+} BraseroDirScanFlags;
+
+typedef struct _BraseroDirEntry BraseroDirEntry;
+struct _BraseroDirEntry {
+	const gchar *name;
+
+	/* Only set for symlinks */
+	const gchar *symlink_target;
+
+	goffset size;
+
+	guint type:4;		/* GFileType */
+	guint is_symlink:1;
+	guint can_read:1;
+
+	/* errno when the entry could not be stat'ed; only name is set then */
+	gint error;
+};
+
+typedef struct _BraseroDirListing BraseroDirListing;
+struct _BraseroDirListing {
+	BraseroDirEntry *entries;
+	guint entries_num;
+
+	/* Private */
+	GArray *array;
+	GStringChunk *strings;
+};
+
+BraseroDirListing *
+brasero_dir_scan_list (const gchar *path,
+		       BraseroDirScanFlags flags,
+		       GCancellable *cancel,
+		       GError **error);
+
+void
+brasero_dir_listing_free (BraseroDirListing *listing);
+
+typedef struct _BraseroDirCount BraseroDirCount;
+struct _BraseroDirCount {
+	guint files_num;
+	guint files_invalid;
+	guint64 total_b;
+
+	/* Optional; held while the counters are updated so
+	 * that they can be read while the scan goes on */
+	GMutex *mutex;
+};
+
+void
+brasero_dir_scan_count (const gchar *path,
+			BraseroDirScanFlags flags,
+			GCancellable *cancel,
+			BraseroDirCount *count);
+
+G_END_DECLS
+
+#endif /* _BRASERO_DIR_SCAN_H_ */
@@ -54,6 +54,7 @@
 #include "brasero-io.h"
 #include "brasero-metadata.h"
 #include "brasero-async-task-manager.h"
+#include "brasero-dir-scan.h"
 
 #define BRASERO_TYPE_IO             (brasero_io_get_type ())
 #define BRASERO_IO(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), BRASERO_TYPE_IO, BraseroIO))
@@ -120,6 +121,9 @@ struct _BraseroIOJobResult {
 	GFileInfo *info;
 	GError *error;
 	gchar *uri;
+
+	/* Array of BraseroIOResultEntry for batches */
+	GArray *entries;
 };
 typedef struct _BraseroIOJobResult BraseroIOJobResult;
 
@@ -297,9 +301,33 @@ brasero_io_unref_result_callback_data (BraseroIOResultCallbackData *data,
 	g_free (data);
 }
 
+static void
+brasero_io_result_entries_free (GArray *entries)
+{
+	guint i;
+
+	for (i = 0; i < entries->len; i ++) {
+		BraseroIOResultEntry *entry;
+
+		entry = &g_array_index (entries, BraseroIOResultEntry, i);
+		if (entry->info)
+			g_object_unref (entry->info);
+
+		if (entry->error)
+			g_error_free (entry->error);
+
+		g_free (entry->uri);
+	}
+
+	g_array_free (entries, TRUE);
+}
+
 static void
 brasero_io_job_result_free (BraseroIOJobResult *result)
 {
+	if (result->entries)
+		brasero_io_result_entries_free (result->entries);
+
 	if (result->info)
 		g_object_unref (result->info);
 
@@ -376,7 +404,18 @@ brasero_io_return_result_idle (gpointer callback_data)
 
 		data = result->callback_data;
 
-		if (result->uri || result->info || result->error)
+		if (result->entries) {
+			base->methods->batch (base->object,
+			                      result->uri,
+			                      (BraseroIOResultEntry *) result->entries->data,
+			                      result->entries->len,
+			                      data? data->callback_data:NULL);
+
+			/* A batch can hold a lot of entries so it is as
+			 * much work as a whole run of single results. */
+			i = NUMBER_OF_RESULTS - 1;
+		}
+		else if (result->uri || result->info || result->error)
 			base->methods->callback (base->object,
 			                          result->error,
 			                          result->uri,
@@ -455,6 +494,29 @@ brasero_io_return_result (const BraseroIOJobBase *base,
 	g_object_unref (self);
 }
 
+static void
+brasero_io_return_batch (const BraseroIOJobBase *base,
+			 const gchar *uri,
+			 GArray *entries,
+			 BraseroIOResultCallbackData *callback_data)
+{
+	BraseroIO *self = brasero_io_get_default ();
+	BraseroIOJobResult *result;
+
+	result = g_new0 (BraseroIOJobResult, 1);
+	result->base = base;
+	result->entries = entries;
+	result->uri = g_strdup (uri);
+
+	if (callback_data) {
+		g_atomic_int_inc (&callback_data->ref);
+		result->callback_data = callback_data;
+	}
+
+	brasero_io_queue_result (self, result);
+	g_object_unref (self);
+}
+
 /**
  * Used to push a job
  */
@@ -1545,10 +1607,7 @@ struct _BraseroIOCountData {
 	GSList *uris;
 	GSList *children;
 
-	guint files_num;
-	guint files_invalid;
-
-	guint64 total_b;
+	BraseroDirCount count;
 	gboolean progress_started;
 };
 typedef struct _BraseroIOCountData BraseroIOCountData;
@@ -1568,6 +1627,8 @@ brasero_io_get_file_count_destroy (BraseroAsyncTaskManager *manager,
 
 	brasero_io_job_progress_report_stop (BRASERO_IO (manager), callback_data);
 
+	g_mutex_free (data->count.mutex);
+
 	brasero_io_job_free (cancelled, callback_data);
 }
 
@@ -1592,7 +1653,7 @@ brasero_io_get_file_count_process_playlist (BraseroIO *self,
 		BraseroMetadataInfo metadata = { NULL, };
 
 		child_uri = iter->data;
-		data->files_num ++;
+		data->count.files_num ++;
 
 		info = g_file_info_new ();
 		result = brasero_io_get_metadata_info (self,
@@ -1604,9 +1665,9 @@ brasero_io_get_file_count_process_playlist (BraseroIO *self,
 						       &metadata);
 
 		if (result)
-			data->total_b += metadata.len;
+			data->count.total_b += metadata.len;
 		else
-			data->files_invalid ++;
+			data->count.files_invalid ++;
 
 		brasero_metadata_info_clear (&metadata);
 		g_object_unref (info);
@@ -1639,7 +1700,7 @@ brasero_io_get_file_count_process_file (BraseroIO *self,
 						       ((data->job.options & BRASERO_IO_INFO_METADATA_THUMBNAIL) ? BRASERO_METADATA_FLAG_THUMBNAIL : 0),
 						       &metadata);
 		if (result)
-			data->total_b += metadata.len;
+			data->count.total_b += metadata.len;
 
 #ifdef BUILD_PLAYLIST
 
@@ -1654,23 +1715,23 @@ brasero_io_get_file_count_process_file (BraseroIO *self,
 			||  !strcmp (mime, "audio/x-mp3-playlist")
 			||  !strcmp (mime, "audio/x-mpegurl"))) {
 				if (!brasero_io_get_file_count_process_playlist (self, cancel, data, child_uri))
-					data->files_invalid ++;
+					data->count.files_invalid ++;
 			}
 			else
-				data->files_invalid ++;
+				data->count.files_invalid ++;
 		}
 
 #endif
 
 		else
-			data->files_invalid ++;
+			data->count.files_invalid ++;
 
 		brasero_metadata_info_clear (&metadata);
 		g_free (child_uri);
 		return;
 	}
 
-	data->total_b += g_file_info_get_size (info);
+	data->count.total_b += g_file_info_get_size (info);
 }
 
 static void
@@ -1693,6 +1754,23 @@ brasero_io_get_file_count_process_directory (BraseroIO *self,
 	file = data->children->data;
 	data->children = g_slist_remove (data->children, file);
 
+	/* Local directories are scanned natively and all at once unless we
+	 * need metadata (which requires a URI and a GFileInfo per file) */
+	if (!(data->job.options & BRASERO_IO_INFO_METADATA)) {
+		gchar *path;
+
+		path = g_file_get_path (file);
+		if (path) {
+			brasero_dir_scan_count (path,
+						(data->job.options & BRASERO_IO_INFO_FOLLOW_SYMLINK)? BRASERO_DIR_SCAN_FOLLOW_SYMLINKS:BRASERO_DIR_SCAN_NONE,
+						cancel,
+						&data->count);
+			g_free (path);
+			g_object_unref (file);
+			return;
+		}
+	}
+
 	enumerator = g_file_enumerate_children (file,
 						attributes,
 						(data->job.options & BRASERO_IO_INFO_FOLLOW_SYMLINK)?G_FILE_QUERY_INFO_NONE:G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,	/* follow symlinks by default*/
@@ -1711,13 +1789,13 @@ brasero_io_get_file_count_process_directory (BraseroIO *self,
 			break;
 		}
 
-		data->files_num ++;
+		data->count.files_num ++;
 
 		if (error) {
 			g_error_free (error);
 			error = NULL;
 
-			data->files_invalid ++;
+			data->count.files_invalid ++;
 			continue;
 		}
 
@@ -1763,11 +1841,11 @@ brasero_io_get_file_count_start (BraseroIO *self,
 				  (data->job.options & BRASERO_IO_INFO_FOLLOW_SYMLINK)?G_FILE_QUERY_INFO_NONE:G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,	/* follow symlinks by default*/
 				  cancel,
 				  NULL);
-	data->files_num ++;
+	data->count.files_num ++;
 
 	if (!info) {
 		g_object_unref (file);
-		data->files_invalid ++;
+		data->count.files_invalid ++;
 		return FALSE;
 	}
 
@@ -1795,10 +1873,13 @@ brasero_io_get_file_count_progress_cb (BraseroIOJob *job,
 {
 	BraseroIOCountData *data = (BraseroIOCountData *) job;
 
-	progress->read_b = data->total_b;
-	progress->total_b = data->total_b;
-	progress->files_num = data->files_num;
-	progress->files_invalid = data->files_invalid;
+	/* Native scans update the counters from several threads */
+	g_mutex_lock (data->count.mutex);
+	progress->read_b = data->count.total_b;
+	progress->total_b = data->count.total_b;
+	progress->files_num = data->count.files_num;
+	progress->files_invalid = data->count.files_invalid;
+	g_mutex_unlock (data->count.mutex);
 }
 
 static BraseroAsyncTaskResult
@@ -1819,9 +1900,9 @@ brasero_io_get_file_count_thread (BraseroAsyncTaskManager *manager,
 		info = g_file_info_new ();
 
 		/* set GFileInfo information */
-		g_file_info_set_attribute_uint32 (info, BRASERO_IO_COUNT_INVALID, data->files_invalid);
-		g_file_info_set_attribute_uint64 (info, BRASERO_IO_COUNT_SIZE, data->total_b);
-		g_file_info_set_attribute_uint32 (info, BRASERO_IO_COUNT_NUM, data->files_num);
+		g_file_info_set_attribute_uint32 (info, BRASERO_IO_COUNT_INVALID, data->count.files_invalid);
+		g_file_info_set_attribute_uint64 (info, BRASERO_IO_COUNT_SIZE, data->count.total_b);
+		g_file_info_set_attribute_uint32 (info, BRASERO_IO_COUNT_NUM, data->count.files_num);
 
 		brasero_io_return_result (data->job.base,
 					  NULL,
@@ -1869,6 +1950,7 @@ brasero_io_get_file_count (GSList *uris,
 	}
 
 	data = g_new0 (BraseroIOCountData, 1);
+	data->count.mutex = g_mutex_new ();
 
 	for (; uris; uris = uris->next)
 		data->uris = g_slist_prepend (data->uris, g_strdup (uris->data));
@@ -1887,12 +1969,77 @@ brasero_io_get_file_count (GSList *uris,
  * Used to explore directories
  */
 
+/* Maximum number of children returned in one batch so that a huge
+ * directory doesn't block the main loop for too long */
+#define BRASERO_IO_BATCH_SIZE	512
+
 struct _BraseroIOContentsData {
 	BraseroIOJob job;
 	GSList *children;
+
+	/* Results for the directory being explored when batches are used */
+	GArray *batch;
 };
 typedef struct _BraseroIOContentsData BraseroIOContentsData;
 
+static void
+brasero_io_load_directory_flush (BraseroIOContentsData *data,
+				 GFile *parent)
+{
+	gchar *uri;
+
+	if (!data->batch)
+		return;
+
+	if (!data->batch->len) {
+		g_array_free (data->batch, TRUE);
+		data->batch = NULL;
+		return;
+	}
+
+	uri = g_file_get_uri (parent);
+	brasero_io_return_batch (data->job.base,
+				 uri,
+				 data->batch,
+				 data->job.callback_data);
+	data->batch = NULL;
+	g_free (uri);
+}
+
+/**
+ * Takes ownership of info and error like brasero_io_return_result ()
+ */
+
+static void
+brasero_io_load_directory_return (BraseroIOContentsData *data,
+				  GFile *parent,
+				  const gchar *uri,
+				  GFileInfo *info,
+				  GError *error)
+{
+	BraseroIOResultEntry entry;
+
+	if (!data->job.base->methods->batch) {
+		brasero_io_return_result (data->job.base,
+					  uri,
+					  info,
+					  error,
+					  data->job.callback_data);
+		return;
+	}
+
+	if (!data->batch)
+		data->batch = g_array_new (FALSE, FALSE, sizeof (BraseroIOResultEntry));
+
+	entry.uri = g_strdup (uri);
+	entry.info = info;
+	entry.error = error;
+	g_array_append_val (data->batch, entry);
+
+	if (data->batch->len >= BRASERO_IO_BATCH_SIZE)
+		brasero_io_load_directory_flush (data, parent);
+}
+
 static void
 brasero_io_load_directory_destroy (BraseroAsyncTaskManager *manager,
 				   gboolean cancelled,
@@ -1903,6 +2050,9 @@ brasero_io_load_directory_destroy (BraseroAsyncTaskManager *manager,
 	g_slist_foreach (data->children, (GFunc) g_object_unref, NULL);
 	g_slist_free (data->children);
 
+	if (data->batch)
+		brasero_io_result_entries_free (data->batch);
+
 	brasero_io_job_free (cancelled, BRASERO_IO_JOB (data));
 }
 
@@ -1912,6 +2062,7 @@ static gboolean
 brasero_io_load_directory_playlist (BraseroIO *self,
 				    GCancellable *cancel,
 				    BraseroIOContentsData *data,
+				    GFile *parent,
 				    const gchar *uri,
 				    const gchar *attributes)
 {
@@ -1951,11 +2102,11 @@ brasero_io_load_directory_playlist (BraseroIO *self,
 
 		if (result) {
 			brasero_io_set_metadata_attributes (info, &metadata);
-			brasero_io_return_result (data->job.base,
-						  child_uri,
-						  info,
-						  NULL,
-						  data->job.callback_data);
+			brasero_io_load_directory_return (data,
+							  parent,
+							  child_uri,
+							  info,
+							  NULL);
 		}
 		else
 			g_object_unref (info);
@@ -1971,6 +2122,187 @@ brasero_io_load_directory_playlist (BraseroIO *self,
 
 #endif
 
+static void
+brasero_io_load_directory_child (BraseroIO *self,
+				 GCancellable *cancel,
+				 BraseroIOContentsData *data,
+				 GFile *parent,
+				 const gchar *child_uri,
+				 GFileInfo *info,
+				 const gchar *attributes)
+{
+	/* special case for symlinks */
+	if (g_file_info_get_is_symlink (info)) {
+		if (!brasero_io_check_symlink_target (parent, info)) {
+			GError *error;
+
+			error = g_error_new (BRASERO_UTILS_ERROR,
+					     BRASERO_UTILS_ERROR_SYMLINK_LOOP,
+					     _("Recursive symbolic link"));
+
+			/* since we checked for the existence of the file
+			 * an error means a looping symbolic link */
+			brasero_io_load_directory_return (data,
+							  parent,
+							  child_uri,
+							  NULL,
+							  error);
+
+			g_object_unref (info);
+			return;
+		}
+	}
+
+	if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY) {
+		brasero_io_load_directory_return (data,
+						  parent,
+						  child_uri,
+						  info,
+						  NULL);
+
+		if (data->job.options & BRASERO_IO_INFO_RECURSIVE)
+			data->children = g_slist_prepend (data->children, g_file_new_for_uri (child_uri));
+
+		return;
+	}
+
+	if (data->job.options & BRASERO_IO_INFO_METADATA) {
+		BraseroMetadataInfo metadata = {NULL, };
+		gboolean result;
+
+		/* add metadata information to this file */
+		result = brasero_io_get_metadata_info (self,
+						       cancel,
+						       child_uri,
+						       info,
+						       ((data->job.options & BRASERO_IO_INFO_METADATA_MISSING_CODEC) ? BRASERO_METADATA_FLAG_MISSING : 0) |
+						       ((data->job.options & BRASERO_IO_INFO_METADATA_THUMBNAIL) ? BRASERO_METADATA_FLAG_THUMBNAIL : 0),
+						       &metadata);
+
+		if (result)
+			brasero_io_set_metadata_attributes (info, &metadata);
+
+#ifdef BUILD_PLAYLIST
+
+		else if (data->job.options & BRASERO_IO_INFO_RECURSIVE) {
+			const gchar *mime;
+
+			mime = g_file_info_get_content_type (info);
+			if (mime
+			&& (!strcmp (mime, "audio/x-scpls")
+			||  !strcmp (mime, "audio/x-ms-asx")
+			||  !strcmp (mime, "audio/x-mp3-playlist")
+			||  !strcmp (mime, "audio/x-mpegurl")))
+				brasero_io_load_directory_playlist (self,
+								    cancel,
+								    data,
+								    parent,
+								    child_uri,
+								    attributes);
+		}
+
+#endif
+
+		brasero_metadata_info_clear (&metadata);
+	}
+
+	brasero_io_load_directory_return (data,
+					  parent,
+					  child_uri,
+					  info,
+					  NULL);
+}
+
+/**
+ * Fast path for local directories: no GFileEnumerator and no GFile per
+ * child. Only used when no attribute that requires GIO (content type, icon)
+ * was asked for. Returns FALSE if the directory could not be read so that
+ * the GIO path reports the error.
+ */
+
+static gboolean
+brasero_io_load_directory_native (BraseroIO *self,
+				  GCancellable *cancel,
+				  BraseroIOContentsData *data,
+				  GFile *file,
+				  const gchar *path,
+				  const gchar *attributes)
+{
+	BraseroDirScanFlags flags = BRASERO_DIR_SCAN_NONE;
+	BraseroDirListing *listing;
+	guint i;
+
+	if (data->job.options & BRASERO_IO_INFO_FOLLOW_SYMLINK)
+		flags |= BRASERO_DIR_SCAN_FOLLOW_SYMLINKS;
+	if (data->job.options & BRASERO_IO_INFO_PERM)
+		flags |= BRASERO_DIR_SCAN_CHECK_READ;
+
+	listing = brasero_dir_scan_list (path, flags, cancel, NULL);
+	if (!listing)
+		return FALSE;
+
+	for (i = 0; i < listing->entries_num; i ++) {
+		BraseroDirEntry *entry;
+		gchar *child_path;
+		gchar *child_uri;
+		GFileInfo *info;
+
+		if (g_cancellable_is_cancelled (cancel))
+			break;
+
+		entry = listing->entries + i;
+
+		/* Same function GIO uses for local URIs */
+		child_path = g_build_filename (path, entry->name, NULL);
+		child_uri = g_filename_to_uri (child_path, NULL, NULL);
+		g_free (child_path);
+
+		if (!child_uri)
+			continue;
+
+		/* Report what can't be read as the GIO path does */
+		if (entry->error) {
+			GError *error;
+
+			error = g_error_new_literal (G_IO_ERROR,
+						     g_io_error_from_errno (entry->error),
+						     g_strerror (entry->error));
+			brasero_io_return_result (data->job.base,
+						  child_uri,
+						  NULL,
+						  error,
+						  data->job.callback_data);
+			g_free (child_uri);
+			continue;
+		}
+
+		info = g_file_info_new ();
+		g_file_info_set_name (info, entry->name);
+		g_file_info_set_size (info, entry->size);
+		g_file_info_set_file_type (info, entry->type);
+		g_file_info_set_is_symlink (info, entry->is_symlink);
+		if (entry->symlink_target)
+			g_file_info_set_symlink_target (info, entry->symlink_target);
+		if (flags & BRASERO_DIR_SCAN_CHECK_READ)
+			g_file_info_set_attribute_boolean (info,
+							   G_FILE_ATTRIBUTE_ACCESS_CAN_READ,
+							   entry->can_read);
+
+		brasero_io_load_directory_child (self,
+						 cancel,
+						 data,
+						 file,
+						 child_uri,
+						 info,
+						 attributes);
+		g_free (child_uri);
+	}
+
+	brasero_io_load_directory_flush (data, file);
+	brasero_dir_listing_free (listing);
+	return TRUE;
+}
+
 static BraseroAsyncTaskResult
 brasero_io_load_directory_thread (BraseroAsyncTaskManager *manager,
 				  GCancellable *cancel,
@@ -1983,21 +2315,29 @@ brasero_io_load_directory_thread (BraseroAsyncTaskManager *manager,
 				  G_FILE_ATTRIBUTE_STANDARD_TYPE };
 	BraseroIOContentsData *data = callback_data;
 	GFileEnumerator *enumerator;
+	gboolean needs_gio = FALSE;
 	GError *error = NULL;
 	GFileInfo *info;
 	GFile *file;
+	gchar *path;
 
 	if (data->job.options & BRASERO_IO_INFO_PERM)
 		strcat (attributes, "," G_FILE_ATTRIBUTE_ACCESS_CAN_READ);
 
-	if (data->job.options & BRASERO_IO_INFO_MIME)
+	if (data->job.options & BRASERO_IO_INFO_MIME) {
 		strcat (attributes, "," G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE);
+		needs_gio = TRUE;
+	}
 	else if ((data->job.options & BRASERO_IO_INFO_METADATA)
-	     &&  (data->job.options & BRASERO_IO_INFO_RECURSIVE))
+	     &&  (data->job.options & BRASERO_IO_INFO_RECURSIVE)) {
 		strcat (attributes, "," G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE);
+		needs_gio = TRUE;
+	}
 
-	if (data->job.options & BRASERO_IO_INFO_ICON)
+	if (data->job.options & BRASERO_IO_INFO_ICON) {
 		strcat (attributes, "," G_FILE_ATTRIBUTE_STANDARD_ICON);
+		needs_gio = TRUE;
+	}
 
 	if (data->children) {
 		file = data->children->data;
@@ -2006,6 +2346,28 @@ brasero_io_load_directory_thread (BraseroAsyncTaskManager *manager,
 	else
 		file = g_file_new_for_uri (data->job.uri);
 
+	path = needs_gio? NULL:g_file_get_path (file);
+	if (path) {
+		gboolean result;
+
+		result = brasero_io_load_directory_native (BRASERO_IO (manager),
+							   cancel,
+							   data,
+							   file,
+							   path,
+							   attributes);
+		g_free (path);
+
+		if (result) {
+			g_object_unref (file);
+
+			if (data->children)
+				return BRASERO_ASYNC_TASK_RESCHEDULE;
+
+			return BRASERO_ASYNC_TASK_FINISHED;
+		}
+	}
+
 	enumerator = g_file_enumerate_children (file,
 						attributes,
 						(data->job.options & BRASERO_IO_INFO_FOLLOW_SYMLINK)?G_FILE_QUERY_INFO_NONE:G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,	/* follow symlinks by default*/
@@ -2053,93 +2415,20 @@ brasero_io_load_directory_thread (BraseroAsyncTaskManager *manager,
 			continue;
 
 		child_uri = g_file_get_uri (child);
+		g_object_unref (child);
 
-		/* special case for symlinks */
-		if (g_file_info_get_is_symlink (info)) {
-			if (!brasero_io_check_symlink_target (file, info)) {
-				error = g_error_new (BRASERO_UTILS_ERROR,
-						     BRASERO_UTILS_ERROR_SYMLINK_LOOP,
-						     _("Recursive symbolic link"));
-
-				/* since we checked for the existence of the file
-				 * an error means a looping symbolic link */
-				brasero_io_return_result (data->job.base,
-							  child_uri,
-							  NULL,
-							  error,
-							  data->job.callback_data);
-
-				g_free (child_uri);
-				g_object_unref (info);
-				g_object_unref (child);
-				continue;
-			}
-		}
-
-		if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY) {
-			brasero_io_return_result (data->job.base,
-						  child_uri,
-						  info,
-						  NULL,
-						  data->job.callback_data);
-
-			if (data->job.options & BRASERO_IO_INFO_RECURSIVE)
-				data->children = g_slist_prepend (data->children, child);
-			else
-				g_object_unref (child);
-
-			g_free (child_uri);
-			continue;
-		}
-
-		if (data->job.options & BRASERO_IO_INFO_METADATA) {
-			BraseroMetadataInfo metadata = {NULL, };
-			gboolean result;
-
-			/* add metadata information to this file */
-			result = brasero_io_get_metadata_info (BRASERO_IO (manager),
-							       cancel,
-							       child_uri,
-							       info,
-							       ((data->job.options & BRASERO_IO_INFO_METADATA_MISSING_CODEC) ? BRASERO_METADATA_FLAG_MISSING : 0) |
-							       ((data->job.options & BRASERO_IO_INFO_METADATA_THUMBNAIL) ? BRASERO_METADATA_FLAG_THUMBNAIL : 0),
-							       &metadata);
-
-			if (result)
-				brasero_io_set_metadata_attributes (info, &metadata);
-
-#ifdef BUILD_PLAYLIST
-
-			else if (data->job.options & BRASERO_IO_INFO_RECURSIVE) {
-				const gchar *mime;
-
-				mime = g_file_info_get_content_type (info);
-				if (mime
-				&& (!strcmp (mime, "audio/x-scpls")
-				||  !strcmp (mime, "audio/x-ms-asx")
-				||  !strcmp (mime, "audio/x-mp3-playlist")
-				||  !strcmp (mime, "audio/x-mpegurl")))
-					brasero_io_load_directory_playlist (BRASERO_IO (manager),
-									    cancel,
-									    data,
-									    child_uri,
-									    attributes);
-			}
-
-#endif
-
-			brasero_metadata_info_clear (&metadata);
-		}
-
-		brasero_io_return_result (data->job.base,
-					  child_uri,
-					  info,
-					  NULL,
-					  data->job.callback_data);
+		brasero_io_load_directory_child (BRASERO_IO (manager),
+						 cancel,
+						 data,
+						 file,
+						 child_uri,
+						 info,
+						 attributes);
 		g_free (child_uri);
-		g_object_unref (child);
 	}
 
+	brasero_io_load_directory_flush (data, file);
+
 	g_file_enumerator_close (enumerator, NULL, NULL);
 	g_object_unref (enumerator);
 	g_object_unref (file);
@@ -2322,6 +2611,25 @@ brasero_io_register_with_methods (GObject *object,
 	return base;
 }
 
+/**
+ * Like brasero_io_register () but the children of a directory loaded with
+ * brasero_io_load_directory () are returned all at once through batch.
+ */
+
+BraseroIOJobBase *
+brasero_io_register_batch (GObject *object,
+			   BraseroIOResultCallback callback,
+			   BraseroIOBatchCallback batch,
+			   BraseroIODestroyCallback destroy,
+			   BraseroIOProgressCallback progress)
+{
+	BraseroIOJobCallbacks *methods;
+
+	methods = brasero_io_register_job_methods (callback, destroy, progress);
+	methods->batch = batch;
+	return brasero_io_register_with_methods (object, methods);
+}
+
 BraseroIOJobBase *
 brasero_io_register (GObject *object,
 		     BraseroIOResultCallback callback,
@@ -100,6 +100,21 @@ typedef void		(*BraseroIOResultCallback)	(GObject *object,
 							 GFileInfo *info,
 							 gpointer callback_data);
 
+struct _BraseroIOResultEntry {
+	gchar *uri;
+	GFileInfo *info;
+	GError *error;
+};
+typedef struct _BraseroIOResultEntry BraseroIOResultEntry;
+
+/* Used to return all the children of a directory at once. uri is the one
+ * of the directory. */
+typedef void		(*BraseroIOBatchCallback)	(GObject *object,
+							 const gchar *uri,
+							 BraseroIOResultEntry *entries,
+							 guint entries_num,
+							 gpointer callback_data);
+
 typedef void		(*BraseroIOProgressCallback)	(GObject *object,
 							 BraseroIOJobProgress *info,
 							 gpointer callback_data);
@@ -116,6 +131,7 @@ struct _BraseroIOJobCallbacks {
 	BraseroIOResultCallback callback;
 	BraseroIODestroyCallback destroy;
 	BraseroIOProgressCallback progress;
+	BraseroIOBatchCallback batch;
 
 	guint ref;
 
@@ -191,6 +207,13 @@ brasero_io_register (GObject *object,
 		     BraseroIODestroyCallback destroy,
 		     BraseroIOProgressCallback progress);
 
+BraseroIOJobBase *
+brasero_io_register_batch (GObject *object,
+			   BraseroIOResultCallback callback,
+			   BraseroIOBatchCallback batch,
+			   BraseroIODestroyCallback destroy,
+			   BraseroIOProgressCallback progress);
+
 BraseroIOJobBase *
 brasero_io_register_with_methods (GObject *object,
                                   BraseroIOJobCallbacks *methods);
@@ -94,7 +94,7 @@ brasero_audio2cue_stop_real (BraseroAudio2Cue *self)
 	g_mutex_unlock (priv->mutex);
 
 	if (priv->thread_id) {
-		g_source_remove (priv->thread_id);
+		brasero_job_source_remove (BRASERO_JOB (self), priv->thread_id);
 		priv->thread_id = 0;
 	}
 
@@ -622,7 +622,7 @@ end:
 
 	/* Get out of the thread */
 	if (!priv->cancel)
-		priv->thread_id = g_idle_add (brasero_audio2cue_create_finished, data);
+		priv->thread_id = brasero_job_idle_add (BRASERO_JOB (data), brasero_audio2cue_create_finished, data);
 
 	g_mutex_lock (priv->mutex);
 	priv->thread = NULL;
@@ -240,7 +240,6 @@ brasero_genisoimage_set_argv_image (BraseroGenisoimage *genisoimage,
 	BraseroBurnResult result;
 	BraseroJobAction action;
 	gchar *grafts_path = NULL;
-	gchar *excluded_path = NULL;
 
 	/* set argv */
 	g_ptr_array_add (argv, g_strdup ("-r"));
@@ -290,47 +289,31 @@ brasero_genisoimage_set_argv_image (BraseroGenisoimage *genisoimage,
 		return result;
 	}
 
-	result = brasero_job_get_tmp_file (BRASERO_JOB (genisoimage),
-					   NULL,
-					   &excluded_path,
-					   error);
-	if (result != BRASERO_BURN_OK) {
-		g_free (videodir);
-		g_free (grafts_path);
-		return result;
-	}
-
 	result = brasero_job_get_tmp_dir (BRASERO_JOB (genisoimage),
 					  &emptydir,
 					  error);
 	if (result != BRASERO_BURN_OK) {
 		g_free (videodir);
 		g_free (grafts_path);
-		g_free (excluded_path);
 		return result;
 	}
 
-	result = brasero_track_data_write_to_paths (BRASERO_TRACK_DATA (track),
-	                                            grafts_path,
-	                                            excluded_path,
-	                                            emptydir,
-	                                            videodir,
-	                                            error);
+	result = brasero_track_data_write_grafts (BRASERO_TRACK_DATA (track),
+	                                          grafts_path,
+	                                          emptydir,
+	                                          videodir,
+	                                          error);
 	g_free (emptydir);
 
 	if (result != BRASERO_BURN_OK) {
 		g_free (videodir);
 		g_free (grafts_path);
-		g_free (excluded_path);
 		return result;
 	}
 
 	g_ptr_array_add (argv, g_strdup ("-path-list"));
 	g_ptr_array_add (argv, grafts_path);
 
-	g_ptr_array_add (argv, g_strdup ("-exclude-list"));
-	g_ptr_array_add (argv, excluded_path);
-
 	brasero_job_get_data_label (BRASERO_JOB (genisoimage), &label);
 	if (label) {
 		g_ptr_array_add (argv, g_strdup ("-V"));
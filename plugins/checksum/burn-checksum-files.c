@@ -1255,14 +1255,21 @@ brasero_checksum_files_thread (gpointer data)
 	}
 
 	if (result != BRASERO_BURN_CANCEL) {
+		GSource *source;
+
 		ctx = g_new0 (BraseroChecksumFilesThreadCtx, 1);
 		ctx->sum = self;
 		ctx->error = error;
 		ctx->result = result;
-		priv->end_id = g_idle_add_full (G_PRIORITY_HIGH_IDLE,
-						brasero_checksum_files_end,
-						ctx,
-						brasero_checksum_files_destroy);
+
+		source = g_idle_source_new ();
+		g_source_set_priority (source, G_PRIORITY_HIGH_IDLE);
+		g_source_set_callback (source,
+				       brasero_checksum_files_end,
+				       ctx,
+				       brasero_checksum_files_destroy);
+		priv->end_id = g_source_attach (source, brasero_job_get_context (BRASERO_JOB (self)));
+		g_source_unref (source);
 	}
 
 	/* End thread */
@@ -1368,7 +1375,7 @@ brasero_checksum_files_stop (BraseroJob *job,
 	g_mutex_unlock (priv->mutex);
 
 	if (priv->end_id) {
-		g_source_remove (priv->end_id);
+		brasero_job_source_remove (job, priv->end_id);
 		priv->end_id = 0;
 	}
 
@@ -1413,7 +1420,7 @@ brasero_checksum_files_finalize (GObject *object)
 	g_mutex_unlock (priv->mutex);
 
 	if (priv->end_id) {
-		g_source_remove (priv->end_id);
+		brasero_job_source_remove (BRASERO_JOB (object), priv->end_id);
 		priv->end_id = 0;
 	}
 
@@ -607,14 +607,21 @@ brasero_checksum_image_thread (gpointer data)
 	}
 
 	if (result != BRASERO_BURN_CANCEL) {
+		GSource *source;
+
 		ctx = g_new0 (BraseroChecksumImageThreadCtx, 1);
 		ctx->sum = self;
 		ctx->error = error;
 		ctx->result = result;
-		priv->end_id = g_idle_add_full (G_PRIORITY_HIGH_IDLE,
-						brasero_checksum_image_end,
-						ctx,
-						brasero_checksum_image_destroy);
+
+		source = g_idle_source_new ();
+		g_source_set_priority (source, G_PRIORITY_HIGH_IDLE);
+		g_source_set_callback (source,
+				       brasero_checksum_image_end,
+				       ctx,
+				       brasero_checksum_image_destroy);
+		priv->end_id = g_source_attach (source, brasero_job_get_context (BRASERO_JOB (self)));
+		g_source_unref (source);
 	}
 
 	/* End thread */
@@ -738,7 +745,7 @@ brasero_checksum_image_stop (BraseroJob *job,
 	g_mutex_unlock (priv->mutex);
 
 	if (priv->end_id) {
-		g_source_remove (priv->end_id);
+		brasero_job_source_remove (job, priv->end_id);
 		priv->end_id = 0;
 	}
 
@@ -778,7 +785,7 @@ brasero_checksum_image_finalize (GObject *object)
 	g_mutex_unlock (priv->mutex);
 
 	if (priv->end_id) {
-		g_source_remove (priv->end_id);
+		brasero_job_source_remove (BRASERO_JOB (object), priv->end_id);
 		priv->end_id = 0;
 	}
 
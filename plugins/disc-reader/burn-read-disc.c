@@ -0,0 +1,554 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Libbrasero-burn
+ * Copyright (C) Philippe Rouquier 2005-2009 <bonfire-app@wanadoo.fr>
+ *
+ * Libbrasero-burn is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The Libbrasero-burn authors hereby grant permission for non-GPL compatible
+ * GStreamer plugins to be used and distributed together with GStreamer
+ * and Libbrasero-burn. This permission is above and beyond the permissions granted
+ * by the GPL license by which Libbrasero-burn is covered. If you modify this code
+ * you may extend this exception to your version of the code, but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version.
+ * 
+ * Libbrasero-burn is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <glib.h>
+#include <glib-object.h>
+#include <glib/gstdio.h>
+#include <glib/gi18n-lib.h>
+#include <gmodule.h>
+
+#include <gio/gio.h>
+
+#include "burn-job.h"
+#include "brasero-plugin-registration.h"
+#include "brasero-tags.h"
+#include "brasero-drive.h"
+#include "brasero-medium.h"
+#include "brasero-track-image.h"
+#include "brasero-track-disc.h"
+
+#include "scsi-device.h"
+#include "burn-disc-reader.h"
+
+
+#define BRASERO_TYPE_READ_DISC         (brasero_read_disc_get_type ())
+#define BRASERO_READ_DISC(o)           (G_TYPE_CHECK_INSTANCE_CAST ((o), BRASERO_TYPE_READ_DISC, BraseroReadDisc))
+#define BRASERO_READ_DISC_CLASS(k)     (G_TYPE_CHECK_CLASS_CAST((k), BRASERO_TYPE_READ_DISC, BraseroReadDiscClass))
+#define BRASERO_IS_READ_DISC(o)        (G_TYPE_CHECK_INSTANCE_TYPE ((o), BRASERO_TYPE_READ_DISC))
+#define BRASERO_IS_READ_DISC_CLASS(k)  (G_TYPE_CHECK_CLASS_TYPE ((k), BRASERO_TYPE_READ_DISC))
+#define BRASERO_READ_DISC_GET_CLASS(o) (G_TYPE_INSTANCE_GET_CLASS ((o), BRASERO_TYPE_READ_DISC, BraseroReadDiscClass))
+
+BRASERO_PLUGIN_BOILERPLATE (BraseroReadDisc, brasero_read_disc, BRASERO_TYPE_JOB, BraseroJob);
+
+struct _BraseroReadDiscPrivate {
+	GError *error;
+	GThread *thread;
+	GMutex *mutex;
+	GCond *cond;
+	guint thread_id;
+	guint pass_id;
+
+	guint retries;
+	guint pass;
+	goffset bad;
+
+	guint cancel:1;
+};
+typedef struct _BraseroReadDiscPrivate BraseroReadDiscPrivate;
+
+#define BRASERO_READ_DISC_PRIVATE(o)  (G_TYPE_INSTANCE_GET_PRIVATE ((o), BRASERO_TYPE_READ_DISC, BraseroReadDiscPrivate))
+
+#define BRASERO_SCHEMA_CONFIG			"org.gnome.brasero.config"
+#define BRASERO_KEY_READ_RETRIES		"read-retries"
+
+static GObjectClass *parent_class = NULL;
+
+/**
+ * Gives the first block and the number of blocks to read; that's the same
+ * range readom and readcd would be asked to read.
+ */
+
+static void
+brasero_read_disc_get_boundaries (BraseroReadDisc *self,
+				  goffset *start,
+				  goffset *blocks)
+{
+	BraseroMedium *medium;
+	BraseroDrive *drive;
+	BraseroTrack *track;
+	GValue *value = NULL;
+
+	brasero_job_get_current_track (BRASERO_JOB (self), &track);
+	drive = brasero_track_disc_get_drive (BRASERO_TRACK_DISC (track));
+	medium = brasero_drive_get_medium (drive);
+
+	brasero_track_tag_lookup (track,
+				  BRASERO_TRACK_MEDIUM_ADDRESS_START_TAG,
+				  &value);
+	if (value) {
+		/* we were given an address to start */
+		*start = g_value_get_uint64 (value);
+
+		/* get the length now */
+		value = NULL;
+		brasero_track_tag_lookup (track,
+					  BRASERO_TRACK_MEDIUM_ADDRESS_END_TAG,
+					  &value);
+
+		*blocks = g_value_get_uint64 (value) - *start;
+	}
+	/* 0 means all disc, -1 problem */
+	else if (brasero_track_disc_get_track_num (BRASERO_TRACK_DISC (track)) > 0) {
+		brasero_medium_get_track_space (medium,
+						brasero_track_disc_get_track_num (BRASERO_TRACK_DISC (track)),
+						NULL,
+						blocks);
+		brasero_medium_get_track_address (medium,
+						  brasero_track_disc_get_track_num (BRASERO_TRACK_DISC (track)),
+						  NULL,
+						  start);
+	}
+	else {
+		/* it's BIN output so just read the last track */
+		brasero_medium_get_last_data_track_space (medium,
+							  NULL,
+							  blocks);
+		brasero_medium_get_last_data_track_address (medium,
+							    NULL,
+							    start);
+	}
+}
+
+static gboolean
+brasero_read_disc_thread_finished (gpointer data)
+{
+	goffset blocks = 0;
+	gchar *image = NULL;
+	BraseroReadDisc *self = data;
+	BraseroReadDiscPrivate *priv;
+	BraseroTrackImage *track = NULL;
+
+	priv = BRASERO_READ_DISC_PRIVATE (self);
+	priv->thread_id = 0;
+
+	if (priv->error) {
+		GError *error;
+
+		error = priv->error;
+		priv->error = NULL;
+		brasero_job_error (BRASERO_JOB (self), error);
+		return FALSE;
+	}
+
+	track = brasero_track_image_new ();
+	brasero_job_get_image_output (BRASERO_JOB (self),
+				      &image,
+				      NULL);
+	brasero_track_image_set_source (track,
+					image,
+					NULL,
+					BRASERO_IMAGE_FORMAT_BIN);
+	g_free (image);
+
+	brasero_job_get_session_output_size (BRASERO_JOB (self), &blocks, NULL);
+	brasero_track_image_set_block_num (track, blocks);
+
+	/* BraseroBurn asks whether such an image is good enough */
+	if (priv->bad)
+		brasero_track_tag_add_int (BRASERO_TRACK (track),
+					   BRASERO_TRACK_MEDIUM_UNREADABLE_BLOCKS_TAG,
+					   priv->bad);
+
+	brasero_job_add_track (BRASERO_JOB (self), BRASERO_TRACK (track));
+	g_object_unref (track);
+
+	brasero_job_finished_track (BRASERO_JOB (self));
+
+	return FALSE;
+}
+
+/**
+ * Progress is reset for each new pass. That must be done in the main loop
+ * since the clock of the task samples it there.
+ */
+
+static gboolean
+brasero_read_disc_new_pass (gpointer data)
+{
+	BraseroReadDisc *self = data;
+	BraseroReadDiscPrivate *priv;
+	gchar *string;
+	guint pass;
+
+	priv = BRASERO_READ_DISC_PRIVATE (self);
+
+	g_mutex_lock (priv->mutex);
+	priv->pass_id = 0;
+	pass = priv->pass;
+	g_mutex_unlock (priv->mutex);
+
+	/* Translators: the first %i is the number of the current
+	 * attempt at reading the parts of the disc that could not be
+	 * read and the second one the total number of attempts */
+	string = g_strdup_printf (_("Retrying damaged areas of the disc (attempt %i of %i)"),
+				  pass,
+				  priv->retries);
+	brasero_job_set_current_action (BRASERO_JOB (self),
+					BRASERO_BURN_ACTION_DRIVE_COPY,
+					string,
+					TRUE);
+	g_free (string);
+
+	brasero_job_reset_progress (BRASERO_JOB (self));
+	brasero_job_start_progress (BRASERO_JOB (self), TRUE);
+	return FALSE;
+}
+
+static void
+brasero_read_disc_report (BraseroReadDisc *self,
+			  BraseroDiscReader *reader,
+			  goffset blocks,
+			  guint *last_pass)
+{
+	BraseroReadDiscPrivate *priv;
+	goffset position = 0;
+	guint pass = 0;
+
+	priv = BRASERO_READ_DISC_PRIVATE (self);
+
+	brasero_disc_reader_get_progress (reader, &pass, &position, NULL, NULL);
+	if (pass != *last_pass) {
+		g_mutex_lock (priv->mutex);
+		priv->pass = pass;
+		if (!priv->pass_id)
+			priv->pass_id = brasero_job_idle_add (BRASERO_JOB (self), brasero_read_disc_new_pass, self);
+		g_mutex_unlock (priv->mutex);
+
+		*last_pass = pass;
+		return;
+	}
+
+	/* The first pass goes through the whole disc at full speed so the
+	 * rate means something; retries only go through the damaged areas */
+	if (!pass)
+		brasero_job_set_written_track (BRASERO_JOB (self), position * 2048ULL);
+	else if (blocks)
+		brasero_job_set_progress (BRASERO_JOB (self), (gdouble) position / (gdouble) blocks);
+}
+
+static gpointer
+brasero_read_disc_thread (gpointer data)
+{
+	BraseroDiscReader *reader = NULL;
+	BraseroDeviceHandle *handle = NULL;
+	BraseroReadDisc *self = data;
+	BraseroReadDiscPrivate *priv;
+	BraseroScsiErrCode code;
+	BraseroTrack *track;
+	BraseroDrive *drive;
+	gchar *image = NULL;
+	gchar *map = NULL;
+	goffset blocks = 0;
+	goffset start = 0;
+	guint last_pass;
+
+	priv = BRASERO_READ_DISC_PRIVATE (self);
+
+	brasero_job_get_current_track (BRASERO_JOB (self), &track);
+	drive = brasero_track_disc_get_drive (BRASERO_TRACK_DISC (track));
+
+	handle = brasero_device_handle_open (brasero_drive_get_device (drive), FALSE, &code);
+	if (!handle) {
+		priv->error = g_error_new (BRASERO_BURN_ERROR,
+					   BRASERO_BURN_ERROR_GENERAL,
+					   _("The drive could not be opened (%s)"),
+					   brasero_scsi_strerror (code));
+		goto end;
+	}
+
+	brasero_read_disc_get_boundaries (self, &start, &blocks);
+
+	/* The map sits next to the image so that trying again to copy to the
+	 * same image resumes reading where it stopped. It goes away with the
+	 * image when that one is temporary. */
+	brasero_job_get_image_output (BRASERO_JOB (self), &image, NULL);
+	brasero_job_get_image_output_companion (BRASERO_JOB (self),
+						BRASERO_DISC_READER_MAP_SUFFIX,
+						&map);
+
+	reader = brasero_disc_reader_new (handle, start, blocks, image, map, &priv->error);
+	if (!reader)
+		goto end;
+
+	brasero_disc_reader_set_retries (reader, priv->retries);
+	BRASERO_JOB_LOG (self,
+			 "Reading %" G_GOFFSET_FORMAT " blocks from %" G_GOFFSET_FORMAT " with %i retries",
+			 blocks,
+			 start,
+			 priv->retries);
+
+	brasero_job_set_use_average_rate (BRASERO_JOB (self), TRUE);
+	brasero_job_set_current_action (BRASERO_JOB (self),
+					BRASERO_BURN_ACTION_DRIVE_COPY,
+					NULL,
+					FALSE);
+	brasero_job_start_progress (BRASERO_JOB (self), TRUE);
+
+	last_pass = 0;
+	while (!priv->cancel) {
+		gboolean finished = FALSE;
+
+		if (!brasero_disc_reader_step (reader, &finished, &priv->error))
+			break;
+
+		if (finished)
+			break;
+
+		brasero_read_disc_report (self, reader, blocks, &last_pass);
+	}
+
+	brasero_disc_reader_get_progress (reader, NULL, NULL, NULL, &priv->bad);
+	if (priv->bad)
+		BRASERO_JOB_LOG (self,
+				 "%" G_GOFFSET_FORMAT " blocks could not be read and were replaced by zeros",
+				 priv->bad);
+
+end:
+
+	if (reader)
+		brasero_disc_reader_free (reader);
+
+	if (handle)
+		brasero_device_handle_close (handle);
+
+	g_free (image);
+	g_free (map);
+
+	if (!priv->cancel)
+		priv->thread_id = brasero_job_idle_add (BRASERO_JOB (self), brasero_read_disc_thread_finished, self);
+
+	/* End thread */
+	g_mutex_lock (priv->mutex);
+	priv->thread = NULL;
+	g_cond_signal (priv->cond);
+	g_mutex_unlock (priv->mutex);
+
+	g_thread_exit (NULL);
+
+	return NULL;
+}
+
+static BraseroBurnResult
+brasero_read_disc_start (BraseroJob *job,
+			 GError **error)
+{
+	BraseroReadDisc *self;
+	BraseroJobAction action;
+	BraseroReadDiscPrivate *priv;
+	GError *thread_error = NULL;
+
+	self = BRASERO_READ_DISC (job);
+	priv = BRASERO_READ_DISC_PRIVATE (self);
+
+	brasero_job_get_action (job, &action);
+	if (action == BRASERO_JOB_ACTION_SIZE) {
+		goffset blocks = 0;
+		goffset start = 0;
+
+		brasero_read_disc_get_boundaries (self, &start, &blocks);
+		brasero_job_set_output_size_for_current_track (job,
+							       blocks,
+							       blocks * 2048ULL);
+		return BRASERO_BURN_NOT_RUNNING;
+	}
+
+	if (action != BRASERO_JOB_ACTION_IMAGE)
+		return BRASERO_BURN_NOT_SUPPORTED;
+
+	if (priv->thread)
+		return BRASERO_BURN_RUNNING;
+
+	priv->bad = 0;
+
+	g_mutex_lock (priv->mutex);
+	priv->thread = g_thread_create (brasero_read_disc_thread,
+					self,
+					FALSE,
+					&thread_error);
+	g_mutex_unlock (priv->mutex);
+
+	if (thread_error) {
+		g_propagate_error (error, thread_error);
+		return BRASERO_BURN_ERR;
+	}
+
+	return BRASERO_BURN_OK;
+}
+
+static void
+brasero_read_disc_stop_real (BraseroReadDisc *self)
+{
+	BraseroReadDiscPrivate *priv;
+
+	priv = BRASERO_READ_DISC_PRIVATE (self);
+
+	g_mutex_lock (priv->mutex);
+	if (priv->thread) {
+		priv->cancel = 1;
+		g_cond_wait (priv->cond, priv->mutex);
+		priv->cancel = 0;
+	}
+	g_mutex_unlock (priv->mutex);
+
+	if (priv->thread_id) {
+		brasero_job_source_remove (BRASERO_JOB (self), priv->thread_id);
+		priv->thread_id = 0;
+	}
+
+	if (priv->pass_id) {
+		brasero_job_source_remove (BRASERO_JOB (self), priv->pass_id);
+		priv->pass_id = 0;
+	}
+
+	priv->pass = 0;
+	priv->bad = 0;
+
+	if (priv->error) {
+		g_error_free (priv->error);
+		priv->error = NULL;
+	}
+}
+
+static BraseroBurnResult
+brasero_read_disc_stop (BraseroJob *job,
+			GError **error)
+{
+	brasero_read_disc_stop_real (BRASERO_READ_DISC (job));
+	return BRASERO_BURN_OK;
+}
+
+static void
+brasero_read_disc_class_init (BraseroReadDiscClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	BraseroJobClass *job_class = BRASERO_JOB_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (BraseroReadDiscPrivate));
+
+	parent_class = g_type_class_peek_parent (klass);
+	object_class->finalize = brasero_read_disc_finalize;
+
+	job_class->start = brasero_read_disc_start;
+	job_class->stop = brasero_read_disc_stop;
+}
+
+static void
+brasero_read_disc_init (BraseroReadDisc *obj)
+{
+	BraseroReadDiscPrivate *priv;
+	GSettings *settings;
+	gint retries;
+
+	priv = BRASERO_READ_DISC_PRIVATE (obj);
+
+	priv->mutex = g_mutex_new ();
+	priv->cond = g_cond_new ();
+
+	settings = g_settings_new (BRASERO_SCHEMA_CONFIG);
+	retries = g_settings_get_int (settings, BRASERO_KEY_READ_RETRIES);
+	g_object_unref (settings);
+
+	priv->retries = CLAMP (retries, 0, 10);
+}
+
+static void
+brasero_read_disc_finalize (GObject *object)
+{
+	BraseroReadDiscPrivate *priv;
+
+	priv = BRASERO_READ_DISC_PRIVATE (object);
+
+	brasero_read_disc_stop_real (BRASERO_READ_DISC (object));
+
+	if (priv->mutex) {
+		g_mutex_free (priv->mutex);
+		priv->mutex = NULL;
+	}
+
+	if (priv->cond) {
+		g_cond_free (priv->cond);
+		priv->cond = NULL;
+	}
+
+	G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+brasero_read_disc_export_caps (BraseroPlugin *plugin)
+{
+	BraseroPluginConfOption *retries;
+	GSList *output;
+	GSList *input;
+
+	brasero_plugin_define (plugin,
+			       "read-disc",
+	                       NULL,
+			       _("Copies damaged data discs to a disc image as well as possible"),
+			       "Philippe Rouquier",
+			       2);
+
+	/* The image is written out of order so it can't be piped */
+	output = brasero_caps_image_new (BRASERO_PLUGIN_IO_ACCEPT_FILE,
+					 BRASERO_IMAGE_FORMAT_BIN);
+
+	input = brasero_caps_disc_new (BRASERO_MEDIUM_CD|
+				       BRASERO_MEDIUM_DVD|
+				       BRASERO_MEDIUM_BD|
+				       BRASERO_MEDIUM_DUAL_L|
+				       BRASERO_MEDIUM_PLUS|
+				       BRASERO_MEDIUM_SEQUENTIAL|
+				       BRASERO_MEDIUM_RESTRICTED|
+				       BRASERO_MEDIUM_ROM|
+				       BRASERO_MEDIUM_WRITABLE|
+				       BRASERO_MEDIUM_REWRITABLE|
+				       BRASERO_MEDIUM_CLOSED|
+				       BRASERO_MEDIUM_APPENDABLE|
+				       BRASERO_MEDIUM_HAS_DATA);
+
+	brasero_plugin_link_caps (plugin, output, input);
+	g_slist_free (output);
+	g_slist_free (input);
+
+	retries = brasero_plugin_conf_option_new (BRASERO_KEY_READ_RETRIES,
+						  _("Number of times damaged areas of a disc are read again"),
+						  BRASERO_PLUGIN_OPTION_INT);
+	brasero_plugin_conf_option_int_set_range (retries, 0, 10);
+	brasero_plugin_add_conf_option (plugin, retries);
+}
@@ -529,7 +529,7 @@ end:
 	}
 
 	if (!priv->cancel)
-		priv->thread_id = g_idle_add (brasero_dvdcss_thread_finished, self);
+		priv->thread_id = brasero_job_idle_add (BRASERO_JOB (self), brasero_dvdcss_thread_finished, self);
 
 	/* End thread */
 	g_mutex_lock (priv->mutex);
@@ -610,7 +610,7 @@ brasero_dvdcss_stop_real (BraseroDvdcss *self)
 	g_mutex_unlock (priv->mutex);
 
 	if (priv->thread_id) {
-		g_source_remove (priv->thread_id);
+		brasero_job_source_remove (BRASERO_JOB (self), priv->thread_id);
 		priv->thread_id = 0;
 	}
 
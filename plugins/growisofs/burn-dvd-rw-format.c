@@ -47,8 +47,14 @@
 #include "burn-job.h"
 #include "burn-process.h"
 #include "brasero-medium.h"
+#include "brasero-drive.h"
 #include "burn-growisofs-common.h"
 
+#include "scsi-device.h"
+#include "scsi-mmc1.h"
+#include "scsi-mmc2.h"
+#include "scsi-spc1.h"
+
 
 #define BRASERO_TYPE_DVD_RW_FORMAT         (brasero_dvd_rw_format_get_type ())
 #define BRASERO_DVD_RW_FORMAT(o)           (G_TYPE_CHECK_INSTANCE_CAST ((o), BRASERO_TYPE_DVD_RW_FORMAT, BraseroDvdRwFormat))
@@ -59,6 +65,27 @@
 
 BRASERO_PLUGIN_BOILERPLATE (BraseroDvdRwFormat, brasero_dvd_rw_format, BRASERO_TYPE_PROCESS, BraseroProcess);
 
+typedef struct _BraseroDvdRwFormatPrivate BraseroDvdRwFormatPrivate;
+struct _BraseroDvdRwFormatPrivate {
+	/* Used when the drive formats the medium by itself */
+	BraseroDeviceHandle *handle;
+	BraseroMedia media;
+	guint ticks;
+	int progress;
+
+	guint background:1;
+};
+
+#define BRASERO_DVD_RW_FORMAT_PRIVATE(o)  (G_TYPE_INSTANCE_GET_PRIVATE ((o), BRASERO_TYPE_DVD_RW_FORMAT, BraseroDvdRwFormatPrivate))
+
+#define BRASERO_SCHEMA_CONFIG			"org.gnome.brasero.config"
+#define BRASERO_KEY_BACKGROUND_FORMAT		"background-format"
+
+/* Number of clock ticks (they happen every 500 ms) we wait for the drive to
+ * report it started formatting, or for the progress it reports to advance,
+ * before giving up. */
+#define BRASERO_DVD_RW_FORMAT_MAX_TICKS		120
+
 static GObjectClass *parent_class = NULL;
 
 static BraseroBurnResult
@@ -146,15 +173,240 @@ brasero_dvd_rw_format_set_argv (BraseroProcess *process,
 	return BRASERO_BURN_OK;
 }
 
+/**
+ * DVD+RW and BD-RE can be formatted by the drive itself: the FORMAT UNIT
+ * command returns immediately and, for DVD+RW, the drive goes on formatting
+ * in the background while data are already written. So there is no need to
+ * wait for dvd+rw-format to complete; as soon as the drive reports that the
+ * format is in progress the job is finished.
+ */
+
+static void
+brasero_dvd_rw_format_close (BraseroDvdRwFormat *self)
+{
+	BraseroDvdRwFormatPrivate *priv;
+
+	priv = BRASERO_DVD_RW_FORMAT_PRIVATE (self);
+	if (priv->handle) {
+		brasero_device_handle_close (priv->handle);
+		priv->handle = NULL;
+	}
+}
+
+static gboolean
+brasero_dvd_rw_format_find_desc (BraseroDvdRwFormat *self,
+				 BraseroScsiFormattableCapacityDesc *found)
+{
+	BraseroScsiFormattableCapacityDesc *desc;
+	BraseroScsiFormatCapacitiesHdr *hdr = NULL;
+	BraseroDvdRwFormatPrivate *priv;
+	BraseroScsiResult result;
+	gboolean success;
+	int size, max, i;
+
+	priv = BRASERO_DVD_RW_FORMAT_PRIVATE (self);
+
+	result = brasero_mmc2_read_format_capacities (priv->handle,
+						      &hdr,
+						      &size,
+						      NULL);
+	if (result != BRASERO_SCSI_OK)
+		return FALSE;
+
+	max = (hdr->len - sizeof (BraseroScsiMaxCapacityDesc)) /
+	       sizeof (BraseroScsiFormattableCapacityDesc);
+
+	success = FALSE;
+	desc = hdr->desc;
+	for (i = 0; i < max; i ++, desc ++) {
+		if (BRASERO_MEDIUM_IS (priv->media, BRASERO_MEDIUM_BDRE)) {
+			/* The first one is the vendor preferred spare area
+			 * size; skip the certification to be quick. */
+			if (desc->format_type == BRASERO_SCSI_BDRE_FORMAT) {
+				memcpy (found, desc, sizeof (BraseroScsiFormattableCapacityDesc));
+				found->subtype = 1;
+				success = TRUE;
+				break;
+			}
+		}
+		else if (desc->format_type == BRASERO_SCSI_DVDRW_PLUS) {
+			memcpy (found, desc, sizeof (BraseroScsiFormattableCapacityDesc));
+			success = TRUE;
+			break;
+		}
+	}
+
+	g_free (hdr);
+	return success;
+}
+
+static BraseroBurnResult
+brasero_dvd_rw_format_start_background (BraseroDvdRwFormat *self)
+{
+	BraseroScsiFormattableCapacityDesc desc;
+	BraseroDvdRwFormatPrivate *priv;
+	BraseroScsiErrCode code = 0;
+	BraseroScsiResult result;
+	BraseroBurnFlag flags;
+	gchar *device;
+
+	priv = BRASERO_DVD_RW_FORMAT_PRIVATE (self);
+
+	if (!priv->background)
+		return BRASERO_BURN_NOT_SUPPORTED;
+
+	brasero_job_get_media (BRASERO_JOB (self), &priv->media);
+	if (!BRASERO_MEDIUM_IS (priv->media, BRASERO_MEDIUM_DVDRW_PLUS)
+	&&  !BRASERO_MEDIUM_IS (priv->media, BRASERO_MEDIUM_DVDRW_PLUS_DL)
+	&&  !BRASERO_MEDIUM_IS (priv->media, BRASERO_MEDIUM_BDRE))
+		return BRASERO_BURN_NOT_SUPPORTED;
+
+	/* A simulation must not touch the medium */
+	brasero_job_get_flags (BRASERO_JOB (self), &flags);
+	if (flags & BRASERO_BURN_FLAG_DUMMY)
+		return BRASERO_BURN_NOT_SUPPORTED;
+
+	brasero_job_get_device (BRASERO_JOB (self), &device);
+	priv->handle = brasero_device_handle_open (device, FALSE, NULL);
+	g_free (device);
+
+	if (!priv->handle)
+		return BRASERO_BURN_NOT_SUPPORTED;
+
+	if (!brasero_dvd_rw_format_find_desc (self, &desc)) {
+		BRASERO_JOB_LOG (self, "No suitable format descriptor");
+		brasero_dvd_rw_format_close (self);
+		return BRASERO_BURN_NOT_SUPPORTED;
+	}
+
+	brasero_job_set_current_action (BRASERO_JOB (self),
+					BRASERO_BURN_ACTION_BLANKING,
+					NULL,
+					FALSE);
+
+	result = brasero_mmc2_format_unit (priv->handle, &desc, TRUE, &code);
+	if (result != BRASERO_SCSI_OK) {
+		BRASERO_JOB_LOG (self, "FORMAT UNIT failed (%s)", brasero_scsi_strerror (code));
+		brasero_dvd_rw_format_close (self);
+		return BRASERO_BURN_NOT_SUPPORTED;
+	}
+
+	BRASERO_JOB_LOG (self, "Drive formatting the medium by itself");
+	brasero_job_set_dangerous (BRASERO_JOB (self), TRUE);
+	priv->ticks = 0;
+	priv->progress = -1;
+	return BRASERO_BURN_OK;
+}
+
+static BraseroBurnResult
+brasero_dvd_rw_format_start (BraseroJob *job,
+			     GError **error)
+{
+	BraseroBurnResult result;
+
+	result = brasero_dvd_rw_format_start_background (BRASERO_DVD_RW_FORMAT (job));
+	if (result != BRASERO_BURN_NOT_SUPPORTED)
+		return result;
+
+	/* fall back to dvd+rw-format */
+	return BRASERO_JOB_CLASS (parent_class)->start (job, error);
+}
+
+static BraseroBurnResult
+brasero_dvd_rw_format_clock_tick (BraseroJob *job)
+{
+	BraseroScsiDiscInfoStd *info = NULL;
+	BraseroDvdRwFormatPrivate *priv;
+	BraseroScsiResult result;
+	gboolean started;
+	int size;
+
+	priv = BRASERO_DVD_RW_FORMAT_PRIVATE (job);
+	if (!priv->handle)
+		return BRASERO_BURN_OK;
+
+	started = FALSE;
+	if (BRASERO_MEDIUM_IS (priv->media, BRASERO_MEDIUM_BDRE)) {
+		int progress;
+
+		/* The drive is not ready as long as it is formatting */
+		result = brasero_spc1_test_unit_ready (priv->handle, NULL);
+		started = (result == BRASERO_SCSI_OK);
+
+		/* A full BD-RE format can take far longer than our limit so
+		 * as long as the drive reports it is moving forward, wait. */
+		if (!started
+		&&  brasero_spc1_request_sense_progress (priv->handle, &progress, NULL) == BRASERO_SCSI_OK
+		&&  progress > priv->progress) {
+			BRASERO_JOB_LOG (job, "Format progress %i/65536", progress);
+			priv->progress = progress;
+			priv->ticks = 0;
+
+			brasero_job_start_progress (job, FALSE);
+			brasero_job_set_progress (job, (gdouble) progress / 65536.0);
+		}
+	}
+	else {
+		result = brasero_mmc1_read_disc_information_std (priv->handle,
+								 &info,
+								 &size,
+								 NULL);
+		if (result == BRASERO_SCSI_OK) {
+			started = (info->bg_format_status == BRASERO_SCSI_BG_FORMAT_IN_PROGESS
+				|| info->bg_format_status == BRASERO_SCSI_BG_FORMAT_COMPLETED);
+			g_free (info);
+		}
+	}
+
+	if (started) {
+		BRASERO_JOB_LOG (job, "Format in progress; writing can start");
+		brasero_dvd_rw_format_close (BRASERO_DVD_RW_FORMAT (job));
+		brasero_job_finished_session (job);
+		return BRASERO_BURN_OK;
+	}
+
+	if (++ priv->ticks > BRASERO_DVD_RW_FORMAT_MAX_TICKS) {
+		brasero_dvd_rw_format_close (BRASERO_DVD_RW_FORMAT (job));
+		brasero_job_error (job,
+				   g_error_new (BRASERO_BURN_ERROR,
+						BRASERO_BURN_ERROR_GENERAL,
+						_("The disc could not be formatted")));
+	}
+
+	return BRASERO_BURN_OK;
+}
+
+static BraseroBurnResult
+brasero_dvd_rw_format_stop (BraseroJob *job,
+			    GError **error)
+{
+	BraseroDvdRwFormatPrivate *priv;
+
+	priv = BRASERO_DVD_RW_FORMAT_PRIVATE (job);
+	if (priv->handle) {
+		brasero_dvd_rw_format_close (BRASERO_DVD_RW_FORMAT (job));
+		return BRASERO_BURN_OK;
+	}
+
+	return BRASERO_JOB_CLASS (parent_class)->stop (job, error);
+}
+
 static void
 brasero_dvd_rw_format_class_init (BraseroDvdRwFormatClass *klass)
 {
 	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	BraseroJobClass *job_class = BRASERO_JOB_CLASS (klass);
 	BraseroProcessClass *process_class = BRASERO_PROCESS_CLASS (klass);
 
+	g_type_class_add_private (klass, sizeof (BraseroDvdRwFormatPrivate));
+
 	parent_class = g_type_class_peek_parent(klass);
 	object_class->finalize = brasero_dvd_rw_format_finalize;
 
+	job_class->start = brasero_dvd_rw_format_start;
+	job_class->clock_tick = brasero_dvd_rw_format_clock_tick;
+	job_class->stop = brasero_dvd_rw_format_stop;
+
 	process_class->set_argv = brasero_dvd_rw_format_set_argv;
 	process_class->stderr_func = brasero_dvd_rw_format_read_stderr;
 	process_class->post = brasero_job_finished_session;
@@ -162,11 +414,21 @@ brasero_dvd_rw_format_class_init (BraseroDvdRwFormatClass *klass)
 
 static void
 brasero_dvd_rw_format_init (BraseroDvdRwFormat *obj)
-{ }
+{
+	BraseroDvdRwFormatPrivate *priv;
+	GSettings *settings;
+
+	priv = BRASERO_DVD_RW_FORMAT_PRIVATE (obj);
+
+	settings = g_settings_new (BRASERO_SCHEMA_CONFIG);
+	priv->background = g_settings_get_boolean (settings, BRASERO_KEY_BACKGROUND_FORMAT);
+	g_object_unref (settings);
+}
 
 static void
 brasero_dvd_rw_format_finalize (GObject *object)
 {
+	brasero_dvd_rw_format_close (BRASERO_DVD_RW_FORMAT (object));
 	G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -182,6 +444,7 @@ brasero_dvd_rw_format_export_caps (BraseroPlugin *plugin)
 				   BRASERO_MEDIUM_HAS_DATA|
 				   BRASERO_MEDIUM_UNFORMATTED|
 				   BRASERO_MEDIUM_BLANK;
+	BraseroPluginConfOption *background;
 	GSList *output;
 
 	brasero_plugin_define (plugin,
@@ -213,6 +476,11 @@ brasero_dvd_rw_format_export_caps (BraseroPlugin *plugin)
 					BRASERO_BURN_FLAG_FAST_BLANK,
 					BRASERO_BURN_FLAG_NONE);
 
+	background = brasero_plugin_conf_option_new (BRASERO_KEY_BACKGROUND_FORMAT,
+						     _("Let the drive format DVD+RW and BD-RE discs in the background"),
+						     BRASERO_PLUGIN_OPTION_BOOL);
+	brasero_plugin_add_conf_option (plugin, background);
+
 	brasero_plugin_register_group (plugin, _(GROWISOFS_DESCRIPTION));
 }
 
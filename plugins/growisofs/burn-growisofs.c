@@ -84,6 +84,7 @@ brasero_growisofs_read_stdout (BraseroProcess *process, const gchar *line)
 	int perc_1, perc_2;
 	int speed_1, speed_2;
 	long long b_written, b_total;
+	const gchar *buffers;
 
 	/* Newer growisofs version have a different line pattern that shows
 	 * drive buffer filling. */
@@ -103,6 +104,15 @@ brasero_growisofs_read_stdout (BraseroProcess *process, const gchar *line)
 		brasero_job_set_written_session (BRASERO_JOB (process), b_written);
 		brasero_job_set_rate (BRASERO_JOB (process), (gdouble) (speed_1 * 10 + speed_2) / 10.0 * (gdouble) DVD_RATE);
 
+		/* RBU is the ring buffer of growisofs, UBU the drive buffer */
+		buffers = strstr (line, "RBU");
+		if (buffers) {
+			int rbu = -1, ubu = -1;
+
+			sscanf (buffers, "RBU %d.%*d%% UBU %d.%*d%%", &rbu, &ubu);
+			brasero_job_set_buffer_fill (BRASERO_JOB (process), rbu, ubu);
+		}
+
 		if (action == BRASERO_JOB_ACTION_ERASE) {
 			brasero_job_set_current_action (BRASERO_JOB (process),
 							BRASERO_BURN_ACTION_BLANKING,
@@ -250,7 +260,6 @@ brasero_growisofs_set_mkisofs_argv (BraseroGrowisofs *growisofs,
 {
 	BraseroGrowisofsPrivate *priv;
 	BraseroTrack *track = NULL;
-	gchar *excluded_path = NULL;
 	gchar *grafts_path = NULL;
 	BraseroJobAction action;
 	BraseroBurnResult result;
@@ -321,47 +330,31 @@ brasero_growisofs_set_mkisofs_argv (BraseroGrowisofs *growisofs,
 		return result;
 	}
 
-	result = brasero_job_get_tmp_file (BRASERO_JOB (growisofs),
-					   NULL,
-					   &excluded_path,
-					   error);
-	if (result != BRASERO_BURN_OK) {
-		g_free (grafts_path);
-		g_free (videodir);
-		return result;
-	}
-
 	result = brasero_job_get_tmp_dir (BRASERO_JOB (growisofs),
 					  &emptydir,
 					  error);
 	if (result != BRASERO_BURN_OK) {
 		g_free (videodir);
 		g_free (grafts_path);
-		g_free (excluded_path);
 		return result;
 	}
 
-	result = brasero_track_data_write_to_paths (BRASERO_TRACK_DATA (track),
-	                                            grafts_path,
-	                                            excluded_path,
-	                                            emptydir,
-	                                            videodir,
-	                                            error);
+	result = brasero_track_data_write_grafts (BRASERO_TRACK_DATA (track),
+	                                          grafts_path,
+	                                          emptydir,
+	                                          videodir,
+	                                          error);
 	g_free (emptydir);
 
 	if (result != BRASERO_BURN_OK) {
 		g_free (videodir);
 		g_free (grafts_path);
-		g_free (excluded_path);
 		return result;
 	}
 
 	g_ptr_array_add (argv, g_strdup ("-path-list"));
 	g_ptr_array_add (argv, grafts_path);
 
-	g_ptr_array_add (argv, g_strdup ("-exclude-list"));
-	g_ptr_array_add (argv, excluded_path);
-
 	brasero_job_get_action (BRASERO_JOB (growisofs), &action);
 	if (action != BRASERO_JOB_ACTION_SIZE) {
 		gchar *label = NULL;
@@ -413,6 +413,10 @@ brasero_libburn_common_status (BraseroJob *self,
 				gchar *string;
 
 				brasero_job_set_written_session (self, (gint64) ((gint64) cur_sector * 2048ULL));
+				if (progress.buffer_capacity)
+					brasero_job_set_buffer_fill (self,
+								     -1,
+								     (progress.buffer_capacity - progress.buffer_available) * 100 / progress.buffer_capacity);
 				brasero_job_start_progress (self, FALSE);
 
 				string = g_strdup_printf (_("Writing track %02i"), progress.track + 1);
@@ -0,0 +1,337 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Libbrasero-burn
+ * Copyright (C) Philippe Rouquier 2005-2009 <bonfire-app@wanadoo.fr>
+ *
+ * Libbrasero-burn is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The Libbrasero-burn authors hereby grant permission for non-GPL compatible
+ * GStreamer plugins to be used and distributed together with GStreamer
+ * and Libbrasero-burn. This permission is above and beyond the permissions granted
+ * by the GPL license by which Libbrasero-burn is covered. If you modify this code
+ * you may extend this exception to your version of the code, but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version.
+ * 
+ * Libbrasero-burn is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string.h>
+#include <stdlib.h>
+
+#include <glib.h>
+#include <gio/gio.h>
+
+#include <libisofs/libisofs.h>
+
+#include "burn-debug.h"
+#include "burn-libisofs-gio.h"
+
+/**
+ * An IsoStream reading the contents of a file through GIO so that files not
+ * stored locally can be written into the image without being downloaded
+ * first. While libisofs consumes a chunk, a thread reads the next ones.
+ */
+
+/* Arbitrary; makes sure it won't clash with the ids used by libisofs */
+#define BRASERO_GIO_STREAM_FS_ID		0x42524153
+
+#define BRASERO_GIO_STREAM_CHUNK_SIZE		65536
+#define BRASERO_GIO_STREAM_CHUNK_NUM		8
+
+typedef struct _BraseroGioChunk BraseroGioChunk;
+struct _BraseroGioChunk {
+	gchar *buffer;
+
+	/* 0 at the end of the file and -1 on error */
+	gssize size;
+	gssize offset;
+};
+
+typedef struct _BraseroGioStream BraseroGioStream;
+struct _BraseroGioStream {
+	GFile *file;
+	goffset size;
+	ino_t ino;
+
+	GThread *thread;
+	GCancellable *cancel;
+
+	/* chunks go from empty to full in the read ahead thread and back
+	 * to empty once libisofs has read them */
+	GAsyncQueue *empty;
+	GAsyncQueue *full;
+
+	BraseroGioChunk *current;
+	guint end:1;
+};
+
+static ino_t serial = 0;
+G_LOCK_DEFINE_STATIC (serial);
+
+static gpointer
+brasero_gio_stream_read_ahead (gpointer data)
+{
+	BraseroGioStream *stream = data;
+	GFileInputStream *input;
+	GError *error = NULL;
+
+	input = g_file_read (stream->file, stream->cancel, &error);
+	while (1) {
+		BraseroGioChunk *chunk;
+
+		chunk = g_async_queue_pop (stream->empty);
+		chunk->offset = 0;
+
+		if (!input)
+			chunk->size = -1;
+		else
+			chunk->size = g_input_stream_read (G_INPUT_STREAM (input),
+							   chunk->buffer,
+							   BRASERO_GIO_STREAM_CHUNK_SIZE,
+							   stream->cancel,
+							   &error);
+
+		g_async_queue_push (stream->full, chunk);
+
+		/* That was the last one */
+		if (chunk->size <= 0)
+			break;
+	}
+
+	if (error) {
+		if (!g_cancellable_is_cancelled (stream->cancel))
+			BRASERO_BURN_LOG ("Error while reading remote file (%s)", error->message);
+
+		g_error_free (error);
+	}
+
+	if (input) {
+		g_input_stream_close (G_INPUT_STREAM (input), NULL, NULL);
+		g_object_unref (input);
+	}
+
+	return NULL;
+}
+
+static int
+brasero_gio_stream_open (IsoStream *iso_stream)
+{
+	BraseroGioStream *stream = iso_stream->data;
+	guint i;
+
+	if (stream->thread)
+		return ISO_FILE_ALREADY_OPENED;
+
+	stream->cancel = g_cancellable_new ();
+	stream->empty = g_async_queue_new ();
+	stream->full = g_async_queue_new ();
+	stream->current = NULL;
+	stream->end = FALSE;
+
+	for (i = 0; i < BRASERO_GIO_STREAM_CHUNK_NUM; i ++) {
+		BraseroGioChunk *chunk;
+
+		chunk = g_new0 (BraseroGioChunk, 1);
+		chunk->buffer = g_new (gchar, BRASERO_GIO_STREAM_CHUNK_SIZE);
+		g_async_queue_push (stream->empty, chunk);
+	}
+
+	stream->thread = g_thread_create (brasero_gio_stream_read_ahead,
+					  stream,
+					  TRUE,
+					  NULL);
+	if (!stream->thread)
+		return ISO_FILE_ERROR;
+
+	return ISO_SUCCESS;
+}
+
+static int
+brasero_gio_stream_close (IsoStream *iso_stream)
+{
+	BraseroGioStream *stream = iso_stream->data;
+	BraseroGioChunk *chunk;
+
+	if (!stream->thread)
+		return ISO_FILE_NOT_OPENED;
+
+	g_cancellable_cancel (stream->cancel);
+
+	/* Give back the chunks until the thread stops */
+	if (stream->current) {
+		g_async_queue_push (stream->empty, stream->current);
+		stream->current = NULL;
+	}
+
+	while (!stream->end) {
+		chunk = g_async_queue_pop (stream->full);
+		if (chunk->size <= 0)
+			stream->end = TRUE;
+
+		g_async_queue_push (stream->empty, chunk);
+	}
+
+	g_thread_join (stream->thread);
+	stream->thread = NULL;
+
+	while ((chunk = g_async_queue_try_pop (stream->empty))) {
+		g_free (chunk->buffer);
+		g_free (chunk);
+	}
+
+	g_async_queue_unref (stream->empty);
+	stream->empty = NULL;
+
+	g_async_queue_unref (stream->full);
+	stream->full = NULL;
+
+	g_object_unref (stream->cancel);
+	stream->cancel = NULL;
+
+	return ISO_SUCCESS;
+}
+
+static off_t
+brasero_gio_stream_get_size (IsoStream *iso_stream)
+{
+	BraseroGioStream *stream = iso_stream->data;
+	return stream->size;
+}
+
+static int
+brasero_gio_stream_read (IsoStream *iso_stream,
+			 void *buffer,
+			 size_t count)
+{
+	BraseroGioStream *stream = iso_stream->data;
+	size_t read = 0;
+
+	if (!stream->thread)
+		return ISO_FILE_NOT_OPENED;
+
+	while (read < count) {
+		gssize bytes;
+
+		if (!stream->current) {
+			if (stream->end)
+				break;
+
+			stream->current = g_async_queue_pop (stream->full);
+			if (stream->current->size <= 0) {
+				gboolean error;
+
+				error = (stream->current->size < 0);
+				g_async_queue_push (stream->empty, stream->current);
+				stream->current = NULL;
+				stream->end = TRUE;
+
+				if (error)
+					return ISO_FILE_READ_ERROR;
+
+				break;
+			}
+		}
+
+		bytes = MIN (stream->current->size - stream->current->offset, (gssize) (count - read));
+		memcpy ((gchar *) buffer + read,
+			stream->current->buffer + stream->current->offset,
+			bytes);
+
+		read += bytes;
+		stream->current->offset += bytes;
+
+		if (stream->current->offset >= stream->current->size) {
+			g_async_queue_push (stream->empty, stream->current);
+			stream->current = NULL;
+		}
+	}
+
+	return read;
+}
+
+static int
+brasero_gio_stream_is_repeatable (IsoStream *iso_stream)
+{
+	/* The file can be opened again */
+	return 1;
+}
+
+static void
+brasero_gio_stream_get_id (IsoStream *iso_stream,
+			   unsigned int *fs_id,
+			   dev_t *dev_id,
+			   ino_t *ino_id)
+{
+	BraseroGioStream *stream = iso_stream->data;
+
+	*fs_id = BRASERO_GIO_STREAM_FS_ID;
+	*dev_id = 0;
+	*ino_id = stream->ino;
+}
+
+static void
+brasero_gio_stream_free (IsoStream *iso_stream)
+{
+	BraseroGioStream *stream = iso_stream->data;
+
+	if (stream->thread)
+		brasero_gio_stream_close (iso_stream);
+
+	g_object_unref (stream->file);
+	g_free (stream);
+}
+
+static IsoStreamIface brasero_gio_stream_class = {
+	0,
+	"gio ",
+	brasero_gio_stream_open,
+	brasero_gio_stream_close,
+	brasero_gio_stream_get_size,
+	brasero_gio_stream_read,
+	brasero_gio_stream_is_repeatable,
+	brasero_gio_stream_get_id,
+	brasero_gio_stream_free
+};
+
+IsoStream *
+brasero_libisofs_gio_stream_new (GFile *file,
+				 goffset size)
+{
+	BraseroGioStream *stream;
+	IsoStream *iso_stream;
+
+	stream = g_new0 (BraseroGioStream, 1);
+	stream->file = g_object_ref (file);
+	stream->size = size;
+
+	/* Every stream needs a different id or libisofs would think they are
+	 * hard links to the same file */
+	G_LOCK (serial);
+	stream->ino = ++ serial;
+	G_UNLOCK (serial);
+
+	/* libisofs frees it with free () when the last reference is dropped */
+	iso_stream = calloc (1, sizeof (IsoStream));
+	iso_stream->class = &brasero_gio_stream_class;
+	iso_stream->refcount = 1;
+	iso_stream->data = stream;
+
+	return iso_stream;
+}
@@ -42,6 +42,7 @@
 #include <glib-object.h>
 #include <glib/gstdio.h>
 #include <glib/gi18n-lib.h>
+#include <gio/gio.h>
 #include <gmodule.h>
 
 #include <libisofs/libisofs.h>
@@ -54,6 +55,8 @@
 #include "burn-libburn-common.h"
 #include "brasero-track-data.h"
 #include "brasero-track-image.h"
+#include "burn-libisofs-gio.h"
+#include "brasero-xfer.h"
 
 
 #define BRASERO_TYPE_LIBISOFS         (brasero_libisofs_get_type ())
@@ -315,7 +318,7 @@ brasero_libisofs_thread_started (gpointer data)
 	g_mutex_lock (priv->mutex);
 
 	if (!priv->cancel)
-		priv->thread_id = g_idle_add (brasero_libisofs_thread_finished, self);
+		priv->thread_id = brasero_job_idle_add (BRASERO_JOB (self), brasero_libisofs_thread_finished, self);
 
 	priv->thread = NULL;
 	g_cond_signal (priv->cond);
@@ -539,6 +542,208 @@ brasero_libisofs_import_last_session (BraseroLibisofs *self,
 	return BRASERO_BURN_OK;
 }
 
+static gboolean
+brasero_libisofs_add_remote_node (BraseroLibisofs *self,
+				  IsoDir *parent,
+				  const gchar *name,
+				  GFile *file,
+				  GFileInfo *info,
+				  GHashTable *excluded,
+				  GHashTable *visited,
+				  guint depth,
+				  GError **error);
+
+static gboolean
+brasero_libisofs_add_remote_contents (BraseroLibisofs *self,
+				      IsoDir *directory,
+				      GFile *file,
+				      GHashTable *excluded,
+				      GHashTable *visited,
+				      guint depth,
+				      GError **error)
+{
+	BraseroLibisofsPrivate *priv;
+	GFileEnumerator *enumerator;
+	gboolean result = TRUE;
+	GFileInfo *info;
+
+	priv = BRASERO_LIBISOFS_PRIVATE (self);
+
+	enumerator = g_file_enumerate_children (file,
+						G_FILE_ATTRIBUTE_STANDARD_NAME ","
+						G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+						G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+						G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+						BRASERO_XFER_LOOP_ATTRIBUTES,
+						G_FILE_QUERY_INFO_NONE,	/* follow symlinks */
+						NULL,
+						error);
+	if (!enumerator)
+		return FALSE;
+
+	while (result && !priv->cancel) {
+		GFile *child;
+		gchar *uri;
+
+		info = g_file_enumerator_next_file (enumerator, NULL, error);
+		if (!info) {
+			result = (error == NULL || *error == NULL);
+			break;
+		}
+
+		child = g_file_get_child (file, g_file_info_get_name (info));
+
+		/* Just like iso_tree_add_exclude () for local directories,
+		 * exclusions only apply to the children found while walking a
+		 * directory. Grafts are in that list too so that they are not
+		 * added twice, once on their own and once with their parent. */
+		uri = g_file_get_uri (child);
+		if (g_hash_table_lookup (excluded, uri))
+			BRASERO_JOB_LOG (self, "Excluded %s", uri);
+		else if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY
+		     &&  brasero_xfer_dir_is_loop (visited, file, info, depth + 1))
+			BRASERO_JOB_LOG (self, "Skipping directory loop %s", uri);
+		else
+			result = brasero_libisofs_add_remote_node (self,
+								   directory,
+								   g_file_info_get_name (info),
+								   child,
+								   info,
+								   excluded,
+								   visited,
+								   depth + 1,
+								   error);
+		g_free (uri);
+		g_object_unref (child);
+		g_object_unref (info);
+	}
+
+	g_file_enumerator_close (enumerator, NULL, NULL);
+	g_object_unref (enumerator);
+
+	return result;
+}
+
+/**
+ * Files not stored locally are read through GIO while the image is written
+ * instead of being downloaded beforehand.
+ */
+
+static gboolean
+brasero_libisofs_add_remote_node (BraseroLibisofs *self,
+				  IsoDir *parent,
+				  const gchar *name,
+				  GFile *file,
+				  GFileInfo *info,
+				  GHashTable *excluded,
+				  GHashTable *visited,
+				  guint depth,
+				  GError **error)
+{
+	IsoNode *node = NULL;
+	gchar *uri;
+	int err;
+
+	uri = g_file_get_uri (file);
+
+	if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY) {
+		IsoDir *directory = NULL;
+
+		err = iso_tree_add_new_dir (parent, name, &directory);
+		node = ISO_NODE (directory);
+	}
+	else {
+		IsoStream *stream;
+		IsoFile *iso_file = NULL;
+
+		stream = brasero_libisofs_gio_stream_new (file, g_file_info_get_size (info));
+		err = iso_tree_add_new_file (parent, name, stream, &iso_file);
+		if (err < 0)
+			iso_stream_unref (stream);
+
+		node = ISO_NODE (iso_file);
+	}
+
+	if (err < 0) {
+		BRASERO_JOB_LOG (self, "ERROR %s %x", uri, err);
+		g_set_error (error,
+			     BRASERO_BURN_ERROR,
+			     BRASERO_BURN_ERROR_GENERAL,
+			     _("libisofs reported an error while adding file at path \"%s\""),
+			     uri);
+		g_free (uri);
+		return FALSE;
+	}
+
+	g_free (uri);
+
+	if (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_TIME_MODIFIED)) {
+		time_t mtime;
+
+		mtime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+		iso_node_set_mtime (node, mtime);
+	}
+
+	if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
+		return brasero_libisofs_add_remote_contents (self,
+							     ISO_DIR (node),
+							     file,
+							     excluded,
+							     visited,
+							     depth,
+							     error);
+
+	return TRUE;
+}
+
+static gboolean
+brasero_libisofs_add_remote_uri (BraseroLibisofs *self,
+				 IsoDir *parent,
+				 const gchar *name,
+				 const gchar *uri,
+				 GHashTable *excluded,
+				 GHashTable *visited,
+				 GError **error)
+{
+	GFileInfo *info;
+	gboolean result;
+	GFile *file;
+
+	BRASERO_JOB_LOG (self, "Streaming remote URI %s", uri);
+
+	file = g_file_new_for_uri (uri);
+	info = g_file_query_info (file,
+				  G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+				  G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+				  G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+				  BRASERO_XFER_LOOP_ATTRIBUTES,
+				  G_FILE_QUERY_INFO_NONE,	/* follow symlinks */
+				  NULL,
+				  error);
+	if (!info) {
+		g_object_unref (file);
+		return FALSE;
+	}
+
+	/* Remember the graft so that no symlink inside brings it back */
+	if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
+		brasero_xfer_dir_is_loop (visited, NULL, info, 0);
+
+	result = brasero_libisofs_add_remote_node (self,
+						   parent,
+						   name,
+						   file,
+						   info,
+						   excluded,
+						   visited,
+						   0,
+						   error);
+	g_object_unref (info);
+	g_object_unref (file);
+
+	return result;
+}
+
 static gpointer
 brasero_libisofs_create_volume_thread (gpointer data)
 {
@@ -550,6 +755,8 @@ brasero_libisofs_create_volume_thread (gpointer data)
 	BraseroBurnFlag flags;
 	GSList *grafts = NULL;
 	gchar *label = NULL;
+	GHashTable *remote_excluded = NULL;
+	GHashTable *remote_visited = NULL;
 	gchar *publisher;
 	GSList *excluded;
 	GSList *iter;
@@ -621,12 +828,21 @@ brasero_libisofs_create_volume_thread (gpointer data)
 	grafts = g_slist_sort (grafts, brasero_libisofs_sort_graft_points);
 
 	/* add global exclusions */
+	remote_excluded = g_hash_table_new (g_str_hash, g_str_equal);
+	remote_visited = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 	for (excluded = brasero_track_data_get_excluded_list (BRASERO_TRACK_DATA (track));
 	     excluded; excluded = excluded->next) {
 		gchar *uri, *local;
 
 		uri = excluded->data;
 		local = g_filename_from_uri (uri, NULL, NULL);
+
+		/* Non local ones are handled while adding remote files */
+		if (!local) {
+			g_hash_table_insert (remote_excluded, uri, uri);
+			continue;
+		}
+
 		iso_tree_add_exclude (image, local);
 		g_free (local);
 	}
@@ -701,14 +917,6 @@ brasero_libisofs_create_volume_thread (gpointer data)
 			else
 				local_path = NULL;
 
-			if (!local_path){
-				priv->error = g_error_new (BRASERO_BURN_ERROR,
-							   BRASERO_BURN_ERROR_FILE_NOT_LOCAL,
-							   _("The file is not stored locally"));
-				g_free (path_name);
-				goto end;
-			}
-
 			/* see if the node exists with the same name among the 
 			 * children of the parent directory. If there is a
 			 * sibling destroy it. */
@@ -728,7 +936,19 @@ brasero_libisofs_create_volume_thread (gpointer data)
 							 iso_dir_iter_remove (sibling));
 			}
 
-			if  (is_directory) {
+			if (!local_path) {
+				if (!brasero_libisofs_add_remote_uri (self,
+								      ISO_DIR (parent),
+								      path_name,
+								      graft->uri,
+								      remote_excluded,
+								      remote_visited,
+								      &priv->error)) {
+					g_free (path_name);
+					goto end;
+				}
+			}
+			else if  (is_directory) {
 				int result;
 				IsoDir *directory;
 
@@ -824,6 +1044,12 @@ end:
 	if (grafts)
 		g_slist_free (grafts);
 
+	if (remote_excluded)
+		g_hash_table_destroy (remote_excluded);
+
+	if (remote_visited)
+		g_hash_table_destroy (remote_visited);
+
 	if (!priv->error && !priv->cancel) {
 		gint64 size;
 		BraseroImageFS image_fs;
@@ -865,7 +1091,7 @@ end:
 	 * means that we were cancelled) in some cases it would mean that we
 	 * would cancel the libburn_src object and create crippled images. */
 	if (!priv->cancel)
-		priv->thread_id = g_idle_add (brasero_libisofs_create_volume_thread_finished, self);
+		priv->thread_id = brasero_job_idle_add (BRASERO_JOB (self), brasero_libisofs_create_volume_thread_finished, self);
 
 	priv->thread = NULL;
 	g_cond_signal (priv->cond);
@@ -997,7 +1223,7 @@ brasero_libisofs_stop_real (BraseroLibisofs *self)
 	g_mutex_unlock (priv->mutex);
 
 	if (priv->thread_id) {
-		g_source_remove (priv->thread_id);
+		brasero_job_source_remove (BRASERO_JOB (self), priv->thread_id);
 		priv->thread_id = 0;
 	}
 }
@@ -1123,5 +1349,8 @@ brasero_libisofs_export_caps (BraseroPlugin *plugin)
 
 	g_slist_free (output);
 
+	/* Files not stored locally are streamed into the image */
+	brasero_plugin_set_accept_remote_files (plugin, TRUE);
+
 	brasero_plugin_register_group (plugin, _(LIBBURNIA_DESCRIPTION));
 }
@@ -55,6 +55,9 @@
 #include "brasero-xfer.h"
 #include "brasero-track-image.h"
 
+#define BRASERO_SCHEMA_CONFIG			"org.gnome.brasero.config"
+#define BRASERO_KEY_DOWNLOAD_STREAMS		"download-streams"
+#define BRASERO_KEY_DOWNLOAD_HOST_STREAMS	"download-host-streams"
 
 #define BRASERO_TYPE_LOCAL_TRACK         (brasero_local_track_get_type ())
 #define BRASERO_LOCAL_TRACK(o)           (G_TYPE_CHECK_INSTANCE_CAST ((o), BRASERO_TYPE_LOCAL_TRACK, BraseroLocalTrack))
@@ -86,6 +89,10 @@ struct _BraseroLocalTrackPrivate {
 
 	GError *error;
 
+	/* Number of files downloaded at the same time (overall and per server) */
+	guint streams;
+	guint host_streams;
+
 	guint download_checksum:1;
 };
 typedef struct _BraseroLocalTrackPrivate BraseroLocalTrackPrivate;
@@ -111,7 +118,12 @@ brasero_local_track_clock_tick (BraseroJob *job)
 	brasero_xfer_get_progress (priv->xfer_ctx,
 				   &written,
 				   &total);
-	brasero_job_set_progress (job, (gdouble) written / (gdouble) total);
+
+	/* The total grows while directories are explored */
+	if (total > 0)
+		brasero_job_set_progress (job, (gdouble) written / (gdouble) total);
+
+	brasero_job_set_written_track (job, written);
 
 	return BRASERO_BURN_OK;
 }
@@ -531,29 +543,24 @@ brasero_local_track_thread (gpointer data)
 	     src && dest;
 	     src = src->next, dest = dest->next) {
 		gchar *name;
-		GFile *src_file;
-		GFile *dest_file;
-		BraseroBurnResult result;
-
-		src_file = src->data;
-		dest_file = dest->data;
 
-		name = g_file_get_basename (src_file);
+		name = g_file_get_basename (src->data);
 		BRASERO_JOB_LOG (self, "Downloading %s", name);
 		g_free (name);
 
-		result = brasero_xfer_start (priv->xfer_ctx,
-					     src_file,
-					     dest_file,
-					     priv->cancel,
-					     &priv->error);
+		brasero_xfer_add (priv->xfer_ctx, src->data, dest->data);
+	}
 
-		if (g_cancellable_is_cancelled (priv->cancel))
-			goto end;
+	/* Files are downloaded in parallel, several from a same server if
+	 * allowed */
+	brasero_xfer_run (priv->xfer_ctx,
+			  priv->streams,
+			  priv->host_streams,
+			  priv->cancel,
+			  &priv->error);
 
-		if (result != BRASERO_BURN_OK)
-			goto end;
-	}
+	if (g_cancellable_is_cancelled (priv->cancel) || priv->error)
+		goto end;
 
 	/* successfully downloaded files, get a checksum if we can. */
 	if (priv->download_checksum
@@ -564,7 +571,7 @@ brasero_local_track_thread (gpointer data)
 end:
 
 	if (!g_cancellable_is_cancelled (priv->cancel))
-		priv->thread_id = g_idle_add ((GSourceFunc) brasero_local_track_thread_finished, self);
+		priv->thread_id = brasero_job_idle_add (BRASERO_JOB (self), (GSourceFunc) brasero_local_track_thread_finished, self);
 
 	/* End thread */
 	g_mutex_lock (priv->mutex);
@@ -733,6 +740,16 @@ brasero_local_track_start (BraseroJob *job,
 	/* make a list of all non local uris to be downloaded and put them in a
 	 * list to avoid to download the same file twice. */
 	if (BRASERO_IS_TRACK_DATA (track)) {
+		GValue *value = NULL;
+
+		/* The plugin creating the image may stream the non local files
+		 * itself; no need to stage them in temporary files then. */
+		brasero_job_tag_lookup (job, BRASERO_SESSION_REMOTE_DATA_TAG, &value);
+		if (value && G_VALUE_HOLDS_INT (value) && g_value_get_int (value)) {
+			BRASERO_JOB_LOG (self, "remote URIs are read by image creator");
+			return BRASERO_BURN_NOT_RUNNING;
+		}
+
 		/* we put all the non local graft point uris in the hash */
 		grafts = brasero_track_data_get_grafts (BRASERO_TRACK_DATA (track));
 		for (; grafts; grafts = grafts->next) {
@@ -814,7 +831,7 @@ brasero_local_track_stop (BraseroJob *job,
 	}
 
 	if (priv->thread_id) {
-		g_source_remove (priv->thread_id);
+		brasero_job_source_remove (job, priv->thread_id);
 		priv->thread_id = 0;
 	}
 
@@ -892,13 +909,28 @@ brasero_local_track_init (BraseroLocalTrack *obj)
 {
 	BraseroLocalTrackPrivate *priv = BRASERO_LOCAL_TRACK_PRIVATE (obj);
 
+	GSettings *settings;
+
 	priv->mutex = g_mutex_new ();
 	priv->cond = g_cond_new ();
+
+	settings = g_settings_new (BRASERO_SCHEMA_CONFIG);
+	priv->streams = g_settings_get_int (settings, BRASERO_KEY_DOWNLOAD_STREAMS);
+	if (priv->streams < 1 || priv->streams > 16)
+		priv->streams = 4;
+
+	priv->host_streams = g_settings_get_int (settings, BRASERO_KEY_DOWNLOAD_HOST_STREAMS);
+	if (priv->host_streams < 1 || priv->host_streams > 16)
+		priv->host_streams = 2;
+
+	g_object_unref (settings);
 }
 
 static void
 brasero_local_track_export_caps (BraseroPlugin *plugin)
 {
+	BraseroPluginConfOption *streams;
+	BraseroPluginConfOption *host_streams;
 	GSList *caps;
 
 	brasero_plugin_define (plugin,
@@ -949,4 +981,17 @@ brasero_local_track_export_caps (BraseroPlugin *plugin)
 	brasero_plugin_set_process_flags (plugin, BRASERO_PLUGIN_RUN_PREPROCESSING);
 
 	brasero_plugin_set_compulsory (plugin, FALSE);
+
+	/* add some configure options */
+	streams = brasero_plugin_conf_option_new (BRASERO_KEY_DOWNLOAD_STREAMS,
+						  _("Number of files downloaded at the same time:"),
+						  BRASERO_PLUGIN_OPTION_INT);
+	brasero_plugin_conf_option_int_set_range (streams, 1, 16);
+	brasero_plugin_add_conf_option (plugin, streams);
+
+	host_streams = brasero_plugin_conf_option_new (BRASERO_KEY_DOWNLOAD_HOST_STREAMS,
+						       _("Number of files downloaded at the same time from a server:"),
+						       BRASERO_PLUGIN_OPTION_INT);
+	brasero_plugin_conf_option_int_set_range (host_streams, 1, 16);
+	brasero_plugin_add_conf_option (plugin, host_streams);
 }
@@ -529,7 +529,7 @@ brasero_burn_uri_thread (gpointer data)
 end:
 
 	if (!g_cancellable_is_cancelled (priv->cancel))
-		priv->thread_id = g_idle_add ((GSourceFunc) brasero_burn_uri_thread_finished, self);
+		priv->thread_id = brasero_job_idle_add (BRASERO_JOB (self), (GSourceFunc) brasero_burn_uri_thread_finished, self);
 
 	/* End thread */
 	g_mutex_lock (priv->mutex);
@@ -680,7 +680,7 @@ brasero_burn_uri_stop (BraseroJob *job,
 	}
 
 	if (priv->thread_id) {
-		g_source_remove (priv->thread_id);
+		brasero_job_source_remove (job, priv->thread_id);
 		priv->thread_id = 0;
 	}
 
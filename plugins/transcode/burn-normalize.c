@@ -42,6 +42,7 @@
 
 #include "brasero-tags.h"
 
+#include "burn-basics.h"
 #include "burn-job.h"
 #include "burn-normalize.h"
 #include "brasero-plugin-registration.h"
@@ -262,9 +263,10 @@ brasero_normalize_build_pipeline (BraseroNormalize *normalize,
 
 	/* connect to the bus */	
 	bus = gst_pipeline_get_bus (GST_PIPELINE (priv->pipeline));
-	gst_bus_add_watch (bus,
-			   (GstBusFunc) brasero_normalize_bus_messages,
-			   normalize);
+	brasero_burn_source_attach (brasero_job_get_context (BRASERO_JOB (normalize)),
+				    gst_bus_create_watch (bus),
+				    (GSourceFunc) brasero_normalize_bus_messages,
+				    normalize);
 	gst_object_unref (bus);
 
 	gst_element_set_state (priv->pipeline, GST_STATE_PLAYING);
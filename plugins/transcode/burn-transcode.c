@@ -405,9 +405,10 @@ brasero_transcode_create_pipeline (BraseroTranscode *transcode,
 	pipeline = gst_pipeline_new (NULL);
 
 	bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
-	gst_bus_add_watch (bus,
-			   (GstBusFunc) brasero_transcode_bus_messages,
-			   transcode);
+	brasero_burn_source_attach (brasero_job_get_context (BRASERO_JOB (transcode)),
+				    gst_bus_create_watch (bus),
+				    (GSourceFunc) brasero_transcode_bus_messages,
+				    transcode);
 	gst_object_unref (bus);
 
 	/* source */
@@ -998,7 +999,7 @@ brasero_transcode_stop (BraseroJob *job,
 	priv->mp3_size_pipeline = 0;
 
 	if (priv->pad_id) {
-		g_source_remove (priv->pad_id);
+		brasero_job_source_remove (job, priv->pad_id);
 		priv->pad_id = 0;
 	}
 
@@ -1191,9 +1192,10 @@ brasero_transcode_pad (BraseroTranscode *transcode, int fd, GError **error)
 		 * available again */
 		priv->pad_fd = fd;
 		priv->pad_size = bytes2write;
-		priv->pad_id = g_timeout_add (50,
-					     (GSourceFunc) brasero_transcode_pad_idle,
-					      transcode);
+		priv->pad_id = brasero_burn_timeout_add (brasero_job_get_context (BRASERO_JOB (transcode)),
+							 50,
+							 (GSourceFunc) brasero_transcode_pad_idle,
+							 transcode);
 		return FALSE;		
 	}
 
@@ -1715,7 +1717,7 @@ brasero_transcode_finalize (GObject *object)
 	priv = BRASERO_TRANSCODE_PRIVATE (object);
 
 	if (priv->pad_id) {
-		g_source_remove (priv->pad_id);
+		brasero_job_source_remove (BRASERO_JOB (object), priv->pad_id);
 		priv->pad_id = 0;
 	}
 
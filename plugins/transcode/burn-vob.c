@@ -41,6 +41,7 @@
 #include <gst/gst.h>
 
 #include "brasero-tags.h"
+#include "burn-basics.h"
 #include "burn-job.h"
 #include "brasero-plugin-registration.h"
 
@@ -1185,9 +1186,10 @@ brasero_vob_build_pipeline (BraseroVob *vob,
 
 	/* connect to the bus */	
 	bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
-	gst_bus_add_watch (bus,
-			   (GstBusFunc) brasero_vob_bus_messages,
-			   vob);
+	brasero_burn_source_attach (brasero_job_get_context (BRASERO_JOB (vob)),
+				    gst_bus_create_watch (bus),
+				    (GSourceFunc) brasero_vob_bus_messages,
+				    vob);
 	gst_object_unref (bus);
 
 	return TRUE;
@@ -1309,25 +1309,37 @@ brasero_app_open_project (BraseroApp *app,
                           gboolean burn)
 {
 	BraseroSessionCfg *session;
+	GError *error = NULL;
+	gboolean result;
 
 	session = brasero_session_cfg_new ();
 
 #ifdef BUILD_PLAYLIST
 
-	if (is_playlist) {
-		if (!brasero_project_open_audio_playlist_project (uri,
-								  BRASERO_BURN_SESSION (session),
-								  warn_user))
-			return FALSE;
-	}
+	if (is_playlist)
+		result = brasero_project_open_audio_playlist_project (uri,
+								      BRASERO_BURN_SESSION (session),
+								      &error);
 	else
 
 #endif
-	
-	if (!brasero_project_open_project_xml (uri,
-					       BRASERO_BURN_SESSION (session),
-					       warn_user))
+
+	result = brasero_project_open_project_xml (uri,
+						   BRASERO_BURN_SESSION (session),
+						   &error);
+	if (!result) {
+		if (warn_user)
+			brasero_app_alert (app,
+					   _("Error while loading the project."),
+					   error? error->message:NULL,
+					   GTK_MESSAGE_ERROR);
+
+		if (error)
+			g_error_free (error);
+
+		g_object_unref (session);
 		return FALSE;
+	}
 
 	brasero_app_process_session (app, session, burn);
 	g_object_unref (session);
@@ -0,0 +1,1193 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Brasero
+ * Copyright (C) Philippe Rouquier 2005-2010 <bonfire-app@wanadoo.fr>
+ * 
+ *  Brasero is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ * 
+ * brasero is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with brasero.  If not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <gio/gio.h>
+
+#include "brasero-batch-job.h"
+#include "brasero-project-parse.h"
+
+#include "brasero-medium-monitor.h"
+#include "brasero-medium.h"
+#include "brasero-drive.h"
+
+#include "brasero-burn.h"
+#include "brasero-error.h"
+#include "brasero-session.h"
+#include "brasero-session-cfg.h"
+#include "brasero-session-helper.h"
+#include "brasero-track-disc.h"
+#include "brasero-track-image-cfg.h"
+
+typedef struct _BraseroBatchJobPrivate BraseroBatchJobPrivate;
+struct _BraseroBatchJobPrivate
+{
+	BraseroBatchJobType type;
+	BraseroBatchJobState state;
+
+	gchar *source;
+	gchar *output;
+	gchar *checksum;
+	BraseroDrive *drive;
+	BraseroBurnFlag flags;
+	guint64 rate;
+
+	BraseroBurnSession *session;
+	BraseroBurn *burn;
+
+	/* The burn runs in its own thread and main context so that several
+	 * jobs can run at the same time (see brasero_burn_record_multi ()) */
+	GThread *thread;
+	GMainContext *context;
+	BraseroBurnResult result;
+	GError *thread_error;
+
+	gulong valid_sig;
+	guint run_id;
+	guint progress_id;
+
+	/* Protects what follows: it is set by the thread of the burn and read
+	 * from the main thread */
+	GMutex *mutex;
+
+	BraseroBurnAction action;
+	gchar *action_string;
+	gdouble progress;
+	glong remaining;
+
+	guint64 current_rate;
+	goffset written;
+	goffset total;
+	gint fifo;
+	gint buffer;
+	gint copy_fill;
+	guint64 read_rate;
+	guint64 write_rate;
+
+	GError *error;
+
+	guint force:1;
+	guint cancelled:1;
+	guint running:1;
+};
+
+#define BRASERO_BATCH_JOB_PRIVATE(o)  (G_TYPE_INSTANCE_GET_PRIVATE ((o), BRASERO_TYPE_BATCH_JOB, BraseroBatchJobPrivate))
+
+enum {
+	PROGRESS_CHANGED_SIGNAL,
+	FINISHED_SIGNAL,
+	LAST_SIGNAL
+};
+static guint batch_job_signals [LAST_SIGNAL] = { 0 };
+
+G_DEFINE_TYPE (BraseroBatchJob, brasero_batch_job, G_TYPE_OBJECT);
+
+const gchar *
+brasero_batch_job_state_to_string (BraseroBatchJobState state)
+{
+	switch (state) {
+	case BRASERO_BATCH_JOB_QUEUED:
+		return "queued";
+	case BRASERO_BATCH_JOB_PREPARING:
+		return "preparing";
+	case BRASERO_BATCH_JOB_RUNNING:
+		return "running";
+	case BRASERO_BATCH_JOB_SUCCEEDED:
+		return "succeeded";
+	case BRASERO_BATCH_JOB_FAILED:
+		return "failed";
+	case BRASERO_BATCH_JOB_CANCELLED:
+		return "cancelled";
+	}
+
+	return NULL;
+}
+
+const gchar *
+brasero_batch_job_type_to_string (BraseroBatchJobType type)
+{
+	switch (type) {
+	case BRASERO_BATCH_JOB_BURN:
+		return "burn";
+	case BRASERO_BATCH_JOB_IMAGE:
+		return "image";
+	case BRASERO_BATCH_JOB_CHECKSUM:
+		return "checksum";
+	case BRASERO_BATCH_JOB_BLANK:
+		return "blank";
+	}
+
+	return NULL;
+}
+
+static void
+brasero_batch_job_finished (BraseroBatchJob *self,
+			    BraseroBatchJobState state,
+			    GError *error)
+{
+	BraseroBatchJobPrivate *priv;
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+
+	if (priv->session && priv->valid_sig) {
+		g_signal_handler_disconnect (priv->session, priv->valid_sig);
+		priv->valid_sig = 0;
+	}
+
+	if (priv->error)
+		g_error_free (priv->error);
+
+	priv->error = error;
+	priv->state = state;
+
+	g_signal_emit (self,
+		       batch_job_signals [FINISHED_SIGNAL],
+		       0);
+}
+
+static gboolean
+brasero_batch_job_progress_changed (gpointer data)
+{
+	BraseroBatchJob *self = BRASERO_BATCH_JOB (data);
+	BraseroBatchJobPrivate *priv;
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+
+	g_mutex_lock (priv->mutex);
+	priv->progress_id = 0;
+	g_mutex_unlock (priv->mutex);
+
+	g_signal_emit (self,
+		       batch_job_signals [PROGRESS_CHANGED_SIGNAL],
+		       0);
+	return FALSE;
+}
+
+/**
+ * Called from the thread of the burn with the mutex held; the status is
+ * copied so that the main thread never has to query the burn.
+ */
+
+static void
+brasero_batch_job_update_status (BraseroBatchJob *self,
+				 BraseroBurn *burn)
+{
+	BraseroBatchJobPrivate *priv;
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+
+	priv->current_rate = 0;
+	priv->written = -1;
+	priv->total = -1;
+	brasero_burn_status (burn, NULL, &priv->total, &priv->written, &priv->current_rate);
+
+	priv->fifo = -1;
+	priv->buffer = -1;
+	brasero_burn_get_buffer_fill (burn, &priv->fifo, &priv->buffer);
+
+	priv->copy_fill = -1;
+	priv->read_rate = 0;
+	priv->write_rate = 0;
+	brasero_burn_get_copy_buffer_status (burn,
+					     &priv->copy_fill,
+					     &priv->read_rate,
+					     &priv->write_rate);
+
+	/* Signals are emitted from the main thread; only one is pending */
+	if (!priv->progress_id)
+		priv->progress_id = g_idle_add (brasero_batch_job_progress_changed, self);
+}
+
+static void
+brasero_batch_job_progress_changed_cb (BraseroBurn *burn,
+				       gdouble overall_progress,
+				       gdouble action_progress,
+				       glong time_remaining,
+				       BraseroBatchJob *self)
+{
+	BraseroBatchJobPrivate *priv;
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+
+	g_mutex_lock (priv->mutex);
+	priv->progress = overall_progress;
+	priv->remaining = time_remaining;
+	brasero_batch_job_update_status (self, burn);
+	g_mutex_unlock (priv->mutex);
+}
+
+static void
+brasero_batch_job_action_changed_cb (BraseroBurn *burn,
+				     BraseroBurnAction action,
+				     BraseroBatchJob *self)
+{
+	BraseroBatchJobPrivate *priv;
+	gchar *string = NULL;
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+
+	brasero_burn_get_action_string (burn, action, &string);
+
+	g_mutex_lock (priv->mutex);
+	priv->action = action;
+	g_free (priv->action_string);
+	priv->action_string = string;
+	brasero_batch_job_update_status (self, burn);
+	g_mutex_unlock (priv->mutex);
+}
+
+/**
+ * Nobody can answer questions. Those warning that data are about to be lost
+ * (erased disc, lost sessions, damaged medium) are answered with a cancel
+ * unless the job was forced. The others only tell about a change in what is
+ * written (no Joliet names, audio on an appendable disc, ...) and the job goes
+ * on as brasero would with its default answers.
+ */
+
+static BraseroBurnResult
+brasero_batch_job_data_loss_cb (BraseroBurn *burn,
+				BraseroBatchJob *self)
+{
+	BraseroBatchJobPrivate *priv;
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+	return priv->force? BRASERO_BURN_OK:BRASERO_BURN_CANCEL;
+}
+
+static BraseroBurnResult
+brasero_batch_job_damaged_medium_cb (BraseroBurn *burn,
+				     gint blocks,
+				     BraseroBatchJob *self)
+{
+	return brasero_batch_job_data_loss_cb (burn, self);
+}
+
+static BraseroBurnResult
+brasero_batch_job_continue_cb (BraseroBurn *burn,
+			       BraseroBatchJob *self)
+{
+	return BRASERO_BURN_OK;
+}
+
+static const gchar *
+brasero_batch_job_session_error_string (BraseroSessionError error)
+{
+	switch (error) {
+	case BRASERO_SESSION_EMPTY:
+		return _("There is nothing to burn");
+	case BRASERO_SESSION_NO_INPUT_IMAGE:
+	case BRASERO_SESSION_UNKNOWN_IMAGE:
+		return _("The image file is invalid");
+	case BRASERO_SESSION_NO_INPUT_MEDIUM:
+	case BRASERO_SESSION_NO_OUTPUT:
+		return _("No disc available");
+	case BRASERO_SESSION_INSUFFICIENT_SPACE:
+	case BRASERO_SESSION_OVERBURN_NECESSARY:
+		return _("Not enough space available on the disc");
+	case BRASERO_SESSION_DISC_PROTECTED:
+		return _("The disc is write-protected");
+	default:
+		break;
+	}
+
+	return _("An internal error occurred");
+}
+
+static void
+brasero_batch_job_set_image_output (BraseroBatchJob *self)
+{
+	BraseroBatchJobPrivate *priv;
+	BraseroImageFormat format;
+	gchar *toc = NULL;
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+
+	if (!priv->output)
+		return;
+
+	format = brasero_burn_session_get_default_output_format (priv->session);
+	if (format == BRASERO_IMAGE_FORMAT_CUE)
+		toc = g_strdup_printf ("%s.cue", priv->output);
+	else if (format == BRASERO_IMAGE_FORMAT_CDRDAO)
+		toc = g_strdup_printf ("%s.toc", priv->output);
+
+	brasero_burn_session_set_image_output_full (priv->session,
+						    format,
+						    priv->output,
+						    toc);
+	g_free (toc);
+}
+
+static void
+brasero_batch_job_thread_finished (BraseroBatchJob *self)
+{
+	BraseroBatchJobPrivate *priv;
+	BraseroBurnResult result;
+	GError *error;
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+
+	if (priv->thread) {
+		g_thread_join (priv->thread);
+		priv->thread = NULL;
+	}
+
+	g_main_context_unref (priv->context);
+	priv->context = NULL;
+
+	brasero_burn_session_stop (priv->session);
+
+	g_signal_handlers_disconnect_matched (priv->burn,
+					      G_SIGNAL_MATCH_DATA,
+					      0,
+					      0,
+					      NULL,
+					      NULL,
+					      self);
+	g_object_unref (priv->burn);
+	priv->burn = NULL;
+
+	result = priv->result;
+	error = priv->thread_error;
+	priv->thread_error = NULL;
+
+	if (result == BRASERO_BURN_OK)
+		brasero_batch_job_finished (self, BRASERO_BATCH_JOB_SUCCEEDED, NULL);
+	else if (result == BRASERO_BURN_CANCEL || priv->cancelled)
+		brasero_batch_job_finished (self, BRASERO_BATCH_JOB_CANCELLED, error);
+	else {
+		if (!error)
+			error = g_error_new (BRASERO_BURN_ERROR,
+					     BRASERO_BURN_ERROR_GENERAL,
+					     "%s",
+					     _("An unknown error occurred"));
+
+		brasero_batch_job_finished (self, BRASERO_BATCH_JOB_FAILED, error);
+	}
+
+	g_object_unref (self);
+}
+
+static gboolean
+brasero_batch_job_thread_finished_cb (gpointer data)
+{
+	brasero_batch_job_thread_finished (BRASERO_BATCH_JOB (data));
+	return FALSE;
+}
+
+static gpointer
+brasero_batch_job_thread (gpointer data)
+{
+	BraseroBatchJob *self = BRASERO_BATCH_JOB (data);
+	BraseroBatchJobPrivate *priv;
+	BraseroBurnResult result;
+	GError *error = NULL;
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+
+	g_main_context_push_thread_default (priv->context);
+
+	/* NOTE: this runs a main loop until the operation is over */
+	switch (priv->type) {
+	case BRASERO_BATCH_JOB_BURN:
+	case BRASERO_BATCH_JOB_IMAGE:
+		result = brasero_burn_record (priv->burn, priv->session, &error);
+		break;
+	case BRASERO_BATCH_JOB_CHECKSUM:
+		result = brasero_burn_check (priv->burn, priv->session, &error);
+		break;
+	case BRASERO_BATCH_JOB_BLANK:
+		result = brasero_burn_blank (priv->burn, priv->session, &error);
+		break;
+	default:
+		result = BRASERO_BURN_NOT_SUPPORTED;
+		break;
+	}
+
+	/* No cancel request can be made once running is FALSE; handle those
+	 * that were made meanwhile */
+	g_mutex_lock (priv->mutex);
+	priv->running = FALSE;
+	g_mutex_unlock (priv->mutex);
+
+	while (g_main_context_pending (priv->context))
+		g_main_context_iteration (priv->context, FALSE);
+
+	g_main_context_pop_thread_default (priv->context);
+
+	priv->result = result;
+	priv->thread_error = error;
+	g_idle_add (brasero_batch_job_thread_finished_cb, self);
+
+	return NULL;
+}
+
+static gboolean
+brasero_batch_job_run (gpointer data)
+{
+	BraseroBatchJob *self = BRASERO_BATCH_JOB (data);
+	BraseroBatchJobPrivate *priv;
+	GError *error = NULL;
+	BraseroBurn *burn;
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+	priv->run_id = 0;
+
+	if (priv->cancelled) {
+		brasero_batch_job_finished (self, BRASERO_BATCH_JOB_CANCELLED, NULL);
+		return FALSE;
+	}
+
+	if (BRASERO_IS_SESSION_CFG (priv->session)) {
+		BraseroSessionError valid;
+
+		valid = brasero_session_cfg_get_error (BRASERO_SESSION_CFG (priv->session));
+		if (!BRASERO_SESSION_IS_VALID (valid)) {
+			brasero_batch_job_finished (self,
+						    BRASERO_BATCH_JOB_FAILED,
+						    g_error_new (BRASERO_BURN_ERROR,
+								 BRASERO_BURN_ERROR_GENERAL,
+								 "%s",
+								 brasero_batch_job_session_error_string (valid)));
+			return FALSE;
+		}
+
+		/* The session doesn't need to follow changes anymore */
+		brasero_session_cfg_disable (BRASERO_SESSION_CFG (priv->session));
+	}
+
+	if (priv->type == BRASERO_BATCH_JOB_IMAGE)
+		brasero_batch_job_set_image_output (self);
+
+	burn = brasero_burn_new ();
+	g_signal_connect (burn,
+			  "progress-changed",
+			  G_CALLBACK (brasero_batch_job_progress_changed_cb),
+			  self);
+	g_signal_connect (burn,
+			  "action-changed",
+			  G_CALLBACK (brasero_batch_job_action_changed_cb),
+			  self);
+	g_signal_connect (burn,
+			  "warn-data-loss",
+			  G_CALLBACK (brasero_batch_job_data_loss_cb),
+			  self);
+	g_signal_connect (burn,
+			  "warn-previous-session-loss",
+			  G_CALLBACK (brasero_batch_job_data_loss_cb),
+			  self);
+	g_signal_connect (burn,
+			  "warn-audio-to-appendable",
+			  G_CALLBACK (brasero_batch_job_continue_cb),
+			  self);
+	g_signal_connect (burn,
+			  "warn-rewritable",
+			  G_CALLBACK (brasero_batch_job_continue_cb),
+			  self);
+	g_signal_connect (burn,
+			  "disable-joliet",
+			  G_CALLBACK (brasero_batch_job_continue_cb),
+			  self);
+	g_signal_connect (burn,
+			  "warn-damaged-medium",
+			  G_CALLBACK (brasero_batch_job_damaged_medium_cb),
+			  self);
+
+	priv->burn = burn;
+	priv->context = g_main_context_new ();
+	priv->running = TRUE;
+	priv->state = BRASERO_BATCH_JOB_RUNNING;
+	g_signal_emit (self,
+		       batch_job_signals [PROGRESS_CHANGED_SIGNAL],
+		       0);
+
+	/* The thread keeps the job alive until brasero_batch_job_thread_finished () */
+	g_object_ref (self);
+	brasero_burn_session_start (priv->session);
+	priv->thread = g_thread_create (brasero_batch_job_thread,
+					self,
+					TRUE,
+					&error);
+	if (!priv->thread) {
+		g_mutex_lock (priv->mutex);
+		priv->running = FALSE;
+		g_mutex_unlock (priv->mutex);
+
+		priv->result = BRASERO_BURN_ERR;
+		priv->thread_error = error;
+		brasero_batch_job_thread_finished (self);
+	}
+
+	return FALSE;
+}
+
+static void
+brasero_batch_job_is_valid_cb (BraseroSessionCfg *session,
+			       BraseroBatchJob *self)
+{
+	BraseroBatchJobPrivate *priv;
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+
+	/* Wait for the contents (data projects, image format) to be known */
+	if (brasero_session_cfg_get_error (session) == BRASERO_SESSION_NOT_READY)
+		return;
+
+	g_signal_handler_disconnect (session, priv->valid_sig);
+	priv->valid_sig = 0;
+
+	if (!priv->run_id)
+		priv->run_id = g_idle_add (brasero_batch_job_run, self);
+}
+
+static gboolean
+brasero_batch_job_add_source (BraseroBatchJob *self,
+			      GError **error)
+{
+	BraseroBatchJobPrivate *priv;
+	BraseroTrackImageCfg *track;
+	const gchar *mime = NULL;
+	GFileInfo *info;
+	GFile *file;
+	gchar *uri;
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+
+	file = g_file_new_for_commandline_arg (priv->source);
+	info = g_file_query_info (file,
+				  G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE,
+				  G_FILE_QUERY_INFO_NONE,
+				  NULL,
+				  error);
+	if (!info) {
+		g_object_unref (file);
+		return FALSE;
+	}
+
+	mime = g_file_info_get_content_type (info);
+
+	/* Brasero projects first (see brasero_app_open_by_mime ()) */
+	if (mime
+	&& (!strcmp (mime, "application/x-brasero")
+	||  !strcmp (mime, "application/xml"))) {
+		g_object_unref (info);
+		g_object_unref (file);
+		return brasero_project_open_project_xml (priv->source,
+							 priv->session,
+							 error);
+	}
+
+#ifdef BUILD_PLAYLIST
+
+	if (mime
+	&& (!strcmp (mime, "audio/x-scpls")
+	||  !strcmp (mime, "audio/x-ms-asx")
+	||  !strcmp (mime, "audio/x-mp3-playlist")
+	||  !strcmp (mime, "audio/x-mpegurl"))) {
+		g_object_unref (info);
+		g_object_unref (file);
+		return brasero_project_open_audio_playlist_project (priv->source,
+								    priv->session,
+								    error);
+	}
+
+#endif
+
+	g_object_unref (info);
+
+	/* Anything else is supposed to be an image; its format is detected */
+	track = brasero_track_image_cfg_new ();
+	brasero_burn_session_add_track (priv->session,
+					BRASERO_TRACK (track),
+					NULL);
+	g_object_unref (track);
+
+	uri = g_file_get_uri (file);
+	brasero_track_image_cfg_set_source (track, uri);
+	g_free (uri);
+
+	g_object_unref (file);
+	return TRUE;
+}
+
+static gboolean
+brasero_batch_job_create_session (BraseroBatchJob *self,
+				  GError **error)
+{
+	BraseroBatchJobPrivate *priv;
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+
+	if (!priv->drive) {
+		g_set_error (error,
+			     BRASERO_BURN_ERROR,
+			     BRASERO_BURN_ERROR_GENERAL,
+			     "%s",
+			     _("No disc available"));
+		return FALSE;
+	}
+
+	switch (priv->type) {
+	case BRASERO_BATCH_JOB_BURN:
+	case BRASERO_BATCH_JOB_IMAGE:
+		priv->session = BRASERO_BURN_SESSION (brasero_session_cfg_new ());
+		if (!brasero_batch_job_add_source (self, error))
+			return FALSE;
+
+		brasero_burn_session_set_burner (priv->session, priv->drive);
+		brasero_session_cfg_add_flags (BRASERO_SESSION_CFG (priv->session), priv->flags);
+		break;
+
+	case BRASERO_BATCH_JOB_CHECKSUM: {
+		BraseroTrackDisc *track;
+
+		priv->session = brasero_burn_session_new ();
+
+		track = brasero_track_disc_new ();
+		brasero_track_disc_set_drive (track, priv->drive);
+		if (priv->checksum)
+			brasero_track_set_checksum (BRASERO_TRACK (track),
+						    BRASERO_CHECKSUM_MD5,
+						    priv->checksum);
+		else
+			brasero_track_set_checksum (BRASERO_TRACK (track),
+						    BRASERO_CHECKSUM_DETECT,
+						    NULL);
+
+		brasero_burn_session_add_track (priv->session, BRASERO_TRACK (track), NULL);
+		g_object_unref (track);
+
+		brasero_burn_session_remove_flag (priv->session, BRASERO_BURN_FLAG_EJECT);
+		break;
+	}
+
+	case BRASERO_BATCH_JOB_BLANK:
+		priv->session = brasero_burn_session_new ();
+		brasero_burn_session_set_burner (priv->session, priv->drive);
+		brasero_burn_session_set_flags (priv->session, priv->flags);
+		break;
+	}
+
+	if (priv->rate)
+		brasero_burn_session_set_rate (priv->session, priv->rate);
+
+	return TRUE;
+}
+
+void
+brasero_batch_job_start (BraseroBatchJob *self)
+{
+	BraseroBatchJobPrivate *priv;
+	GError *error = NULL;
+
+	g_return_if_fail (BRASERO_IS_BATCH_JOB (self));
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+	if (priv->state != BRASERO_BATCH_JOB_QUEUED)
+		return;
+
+	priv->state = BRASERO_BATCH_JOB_PREPARING;
+	g_signal_emit (self,
+		       batch_job_signals [PROGRESS_CHANGED_SIGNAL],
+		       0);
+
+	if (!brasero_batch_job_create_session (self, &error)) {
+		brasero_batch_job_finished (self, BRASERO_BATCH_JOB_FAILED, error);
+		return;
+	}
+
+	if (BRASERO_IS_SESSION_CFG (priv->session)
+	&&  brasero_session_cfg_get_error (BRASERO_SESSION_CFG (priv->session)) == BRASERO_SESSION_NOT_READY) {
+		priv->valid_sig = g_signal_connect (priv->session,
+						    "is-valid",
+						    G_CALLBACK (brasero_batch_job_is_valid_cb),
+						    self);
+		return;
+	}
+
+	priv->run_id = g_idle_add (brasero_batch_job_run, self);
+}
+
+static gboolean
+brasero_batch_job_cancel_cb (gpointer data)
+{
+	BraseroBatchJobPrivate *priv;
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (data);
+	brasero_burn_cancel (priv->burn, TRUE);
+	return FALSE;
+}
+
+void
+brasero_batch_job_cancel (BraseroBatchJob *self)
+{
+	BraseroBatchJobPrivate *priv;
+
+	g_return_if_fail (BRASERO_IS_BATCH_JOB (self));
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+	priv->cancelled = TRUE;
+
+	if (priv->burn) {
+		GSource *source;
+
+		/* The burn must be cancelled from its own thread */
+		g_mutex_lock (priv->mutex);
+		if (priv->running) {
+			source = g_idle_source_new ();
+			g_source_set_callback (source,
+					       brasero_batch_job_cancel_cb,
+					       self,
+					       NULL);
+			g_source_attach (source, priv->context);
+			g_source_unref (source);
+		}
+		g_mutex_unlock (priv->mutex);
+		return;
+	}
+
+	if (priv->state == BRASERO_BATCH_JOB_QUEUED)
+		brasero_batch_job_finished (self, BRASERO_BATCH_JOB_CANCELLED, NULL);
+	else if (priv->state == BRASERO_BATCH_JOB_PREPARING) {
+		if (priv->run_id) {
+			g_source_remove (priv->run_id);
+			priv->run_id = 0;
+		}
+
+		brasero_batch_job_finished (self, BRASERO_BATCH_JOB_CANCELLED, NULL);
+	}
+}
+
+/**
+ * Tells whether the job can run on a drive given the medium it has
+ */
+
+gboolean
+brasero_batch_job_can_use_drive (BraseroBatchJob *self,
+				 BraseroDrive *drive)
+{
+	BraseroBatchJobPrivate *priv;
+	BraseroMedium *medium;
+
+	g_return_val_if_fail (BRASERO_IS_BATCH_JOB (self), FALSE);
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+
+	if (priv->type == BRASERO_BATCH_JOB_IMAGE)
+		return brasero_drive_is_fake (drive);
+
+	if (brasero_drive_is_fake (drive))
+		return FALSE;
+
+	if (brasero_drive_is_locked (drive, NULL))
+		return FALSE;
+
+	medium = brasero_drive_get_medium (drive);
+	if (!medium)
+		return FALSE;
+
+	switch (priv->type) {
+	case BRASERO_BATCH_JOB_BURN:
+		return brasero_drive_can_write (drive) && brasero_medium_can_be_written (medium);
+	case BRASERO_BATCH_JOB_BLANK:
+		return brasero_medium_can_be_rewritten (medium);
+	case BRASERO_BATCH_JOB_CHECKSUM:
+		return (brasero_medium_get_status (medium) & BRASERO_MEDIUM_HAS_DATA) != 0;
+	default:
+		break;
+	}
+
+	return FALSE;
+}
+
+void
+brasero_batch_job_set_drive (BraseroBatchJob *self,
+			     BraseroDrive *drive)
+{
+	BraseroBatchJobPrivate *priv;
+
+	g_return_if_fail (BRASERO_IS_BATCH_JOB (self));
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+
+	if (priv->drive)
+		g_object_unref (priv->drive);
+
+	priv->drive = drive? g_object_ref (drive):NULL;
+}
+
+BraseroDrive *
+brasero_batch_job_get_drive (BraseroBatchJob *self)
+{
+	g_return_val_if_fail (BRASERO_IS_BATCH_JOB (self), NULL);
+	return BRASERO_BATCH_JOB_PRIVATE (self)->drive;
+}
+
+void
+brasero_batch_job_set_output (BraseroBatchJob *self,
+			      const gchar *path)
+{
+	BraseroBatchJobPrivate *priv;
+
+	g_return_if_fail (BRASERO_IS_BATCH_JOB (self));
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+	g_free (priv->output);
+	priv->output = g_strdup (path);
+}
+
+void
+brasero_batch_job_set_checksum (BraseroBatchJob *self,
+				const gchar *checksum)
+{
+	BraseroBatchJobPrivate *priv;
+
+	g_return_if_fail (BRASERO_IS_BATCH_JOB (self));
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+	g_free (priv->checksum);
+	priv->checksum = (checksum && checksum [0] != '\0')? g_strdup (checksum):NULL;
+}
+
+void
+brasero_batch_job_add_flags (BraseroBatchJob *self,
+			     BraseroBurnFlag flags)
+{
+	g_return_if_fail (BRASERO_IS_BATCH_JOB (self));
+	BRASERO_BATCH_JOB_PRIVATE (self)->flags |= flags;
+}
+
+void
+brasero_batch_job_set_rate (BraseroBatchJob *self,
+			    guint64 rate)
+{
+	g_return_if_fail (BRASERO_IS_BATCH_JOB (self));
+	BRASERO_BATCH_JOB_PRIVATE (self)->rate = rate;
+}
+
+void
+brasero_batch_job_set_force (BraseroBatchJob *self,
+			     gboolean force)
+{
+	g_return_if_fail (BRASERO_IS_BATCH_JOB (self));
+	BRASERO_BATCH_JOB_PRIVATE (self)->force = (force != FALSE);
+}
+
+BraseroBatchJobType
+brasero_batch_job_get_job_type (BraseroBatchJob *self)
+{
+	g_return_val_if_fail (BRASERO_IS_BATCH_JOB (self), BRASERO_BATCH_JOB_BURN);
+	return BRASERO_BATCH_JOB_PRIVATE (self)->type;
+}
+
+const gchar *
+brasero_batch_job_get_source (BraseroBatchJob *self)
+{
+	g_return_val_if_fail (BRASERO_IS_BATCH_JOB (self), NULL);
+	return BRASERO_BATCH_JOB_PRIVATE (self)->source;
+}
+
+BraseroBatchJobState
+brasero_batch_job_get_state (BraseroBatchJob *self)
+{
+	g_return_val_if_fail (BRASERO_IS_BATCH_JOB (self), BRASERO_BATCH_JOB_FAILED);
+	return BRASERO_BATCH_JOB_PRIVATE (self)->state;
+}
+
+const GError *
+brasero_batch_job_get_error (BraseroBatchJob *self)
+{
+	g_return_val_if_fail (BRASERO_IS_BATCH_JOB (self), NULL);
+	return BRASERO_BATCH_JOB_PRIVATE (self)->error;
+}
+
+BraseroBurnAction
+brasero_batch_job_get_action (BraseroBatchJob *self)
+{
+	g_return_val_if_fail (BRASERO_IS_BATCH_JOB (self), BRASERO_BURN_ACTION_NONE);
+	return BRASERO_BATCH_JOB_PRIVATE (self)->action;
+}
+
+gchar *
+brasero_batch_job_get_action_string (BraseroBatchJob *self)
+{
+	BraseroBatchJobPrivate *priv;
+	gchar *string;
+
+	g_return_val_if_fail (BRASERO_IS_BATCH_JOB (self), NULL);
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+
+	g_mutex_lock (priv->mutex);
+	if (priv->action_string)
+		string = g_strdup (priv->action_string);
+	else
+		string = g_strdup (brasero_burn_action_to_string (priv->action));
+	g_mutex_unlock (priv->mutex);
+
+	return string;
+}
+
+gdouble
+brasero_batch_job_get_progress (BraseroBatchJob *self)
+{
+	BraseroBatchJobPrivate *priv;
+	gdouble progress;
+
+	g_return_val_if_fail (BRASERO_IS_BATCH_JOB (self), -1.0);
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+
+	g_mutex_lock (priv->mutex);
+	progress = priv->progress;
+	g_mutex_unlock (priv->mutex);
+
+	return progress;
+}
+
+glong
+brasero_batch_job_get_remaining (BraseroBatchJob *self)
+{
+	BraseroBatchJobPrivate *priv;
+	glong remaining;
+
+	g_return_val_if_fail (BRASERO_IS_BATCH_JOB (self), -1);
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+
+	g_mutex_lock (priv->mutex);
+	remaining = priv->remaining;
+	g_mutex_unlock (priv->mutex);
+
+	return remaining;
+}
+
+guint64
+brasero_batch_job_get_rate (BraseroBatchJob *self)
+{
+	BraseroBatchJobPrivate *priv;
+	guint64 rate = 0;
+
+	g_return_val_if_fail (BRASERO_IS_BATCH_JOB (self), 0);
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+
+	g_mutex_lock (priv->mutex);
+	if (priv->burn)
+		rate = priv->current_rate;
+	g_mutex_unlock (priv->mutex);
+
+	return rate;
+}
+
+void
+brasero_batch_job_get_written (BraseroBatchJob *self,
+			       goffset *written,
+			       goffset *total)
+{
+	BraseroBatchJobPrivate *priv;
+
+	g_return_if_fail (BRASERO_IS_BATCH_JOB (self));
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+
+	if (written)
+		*written = -1;
+	if (total)
+		*total = -1;
+
+	g_mutex_lock (priv->mutex);
+	if (priv->burn) {
+		if (written)
+			*written = priv->written;
+		if (total)
+			*total = priv->total;
+	}
+	g_mutex_unlock (priv->mutex);
+}
+
+void
+brasero_batch_job_get_buffer_fill (BraseroBatchJob *self,
+				   gint *fifo,
+				   gint *buffer)
+{
+	BraseroBatchJobPrivate *priv;
+
+	g_return_if_fail (BRASERO_IS_BATCH_JOB (self));
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+
+	if (fifo)
+		*fifo = -1;
+	if (buffer)
+		*buffer = -1;
+
+	g_mutex_lock (priv->mutex);
+	if (priv->burn) {
+		if (fifo)
+			*fifo = priv->fifo;
+		if (buffer)
+			*buffer = priv->buffer;
+	}
+	g_mutex_unlock (priv->mutex);
+}
+
+void
+brasero_batch_job_get_copy_buffer (BraseroBatchJob *self,
+				   gint *fill,
+				   guint64 *read_rate,
+				   guint64 *write_rate)
+{
+	BraseroBatchJobPrivate *priv;
+
+	g_return_if_fail (BRASERO_IS_BATCH_JOB (self));
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (self);
+
+	if (fill)
+		*fill = -1;
+	if (read_rate)
+		*read_rate = 0;
+	if (write_rate)
+		*write_rate = 0;
+
+	g_mutex_lock (priv->mutex);
+	if (priv->burn) {
+		if (fill)
+			*fill = priv->copy_fill;
+		if (read_rate)
+			*read_rate = priv->read_rate;
+		if (write_rate)
+			*write_rate = priv->write_rate;
+	}
+	g_mutex_unlock (priv->mutex);
+}
+
+static void
+brasero_batch_job_init (BraseroBatchJob *object)
+{
+	BraseroBatchJobPrivate *priv;
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (object);
+	priv->mutex = g_mutex_new ();
+	priv->state = BRASERO_BATCH_JOB_QUEUED;
+	priv->progress = -1.0;
+	priv->remaining = -1;
+}
+
+static void
+brasero_batch_job_finalize (GObject *object)
+{
+	BraseroBatchJobPrivate *priv;
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (object);
+
+	if (priv->run_id) {
+		g_source_remove (priv->run_id);
+		priv->run_id = 0;
+	}
+
+	if (priv->progress_id) {
+		g_source_remove (priv->progress_id);
+		priv->progress_id = 0;
+	}
+
+	if (priv->session) {
+		if (priv->valid_sig)
+			g_signal_handler_disconnect (priv->session, priv->valid_sig);
+
+		g_object_unref (priv->session);
+		priv->session = NULL;
+	}
+
+	if (priv->drive) {
+		g_object_unref (priv->drive);
+		priv->drive = NULL;
+	}
+
+	if (priv->error) {
+		g_error_free (priv->error);
+		priv->error = NULL;
+	}
+
+	g_free (priv->source);
+	g_free (priv->output);
+	g_free (priv->checksum);
+	g_free (priv->action_string);
+
+	g_mutex_free (priv->mutex);
+
+	G_OBJECT_CLASS (brasero_batch_job_parent_class)->finalize (object);
+}
+
+static void
+brasero_batch_job_class_init (BraseroBatchJobClass *klass)
+{
+	GObjectClass* object_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (BraseroBatchJobPrivate));
+
+	object_class->finalize = brasero_batch_job_finalize;
+
+	batch_job_signals [PROGRESS_CHANGED_SIGNAL] =
+		g_signal_new ("progress_changed",
+			      G_OBJECT_CLASS_TYPE (klass),
+			      G_SIGNAL_RUN_LAST,
+			      0,
+			      NULL, NULL,
+			      g_cclosure_marshal_VOID__VOID,
+			      G_TYPE_NONE,
+			      0);
+	batch_job_signals [FINISHED_SIGNAL] =
+		g_signal_new ("finished",
+			      G_OBJECT_CLASS_TYPE (klass),
+			      G_SIGNAL_RUN_LAST,
+			      0,
+			      NULL, NULL,
+			      g_cclosure_marshal_VOID__VOID,
+			      G_TYPE_NONE,
+			      0);
+}
+
+BraseroBatchJob *
+brasero_batch_job_new (BraseroBatchJobType type,
+		       const gchar *source)
+{
+	BraseroBatchJobPrivate *priv;
+	BraseroBatchJob *job;
+
+	job = g_object_new (BRASERO_TYPE_BATCH_JOB, NULL);
+
+	priv = BRASERO_BATCH_JOB_PRIVATE (job);
+	priv->type = type;
+	priv->source = g_strdup (source);
+
+	return job;
+}
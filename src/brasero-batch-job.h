@@ -0,0 +1,170 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Brasero
+ * Copyright (C) Philippe Rouquier 2005-2010 <bonfire-app@wanadoo.fr>
+ * 
+ *  Brasero is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ * 
+ * brasero is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with brasero.  If not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef _BRASERO_BATCH_JOB_H_
+#define _BRASERO_BATCH_JOB_H_
+
+#include <glib-object.h>
+
+#include "brasero-drive.h"
+#include "brasero-enums.h"
+#include "brasero-session.h"
+
+G_BEGIN_DECLS
+
+/**
+ * A burning operation run without any user interaction. Used by the burning
+ * daemon and by the command line when no GUI is wanted.
+ */
+
+typedef enum {
+	BRASERO_BATCH_JOB_BURN,
+	BRASERO_BATCH_JOB_IMAGE,
+	BRASERO_BATCH_JOB_CHECKSUM,
+	BRASERO_BATCH_JOB_BLANK
+} BraseroBatchJobType;
+
+typedef enum {
+	BRASERO_BATCH_JOB_QUEUED,
+	BRASERO_BATCH_JOB_PREPARING,
+	BRASERO_BATCH_JOB_RUNNING,
+	BRASERO_BATCH_JOB_SUCCEEDED,
+	BRASERO_BATCH_JOB_FAILED,
+	BRASERO_BATCH_JOB_CANCELLED
+} BraseroBatchJobState;
+
+#define BRASERO_TYPE_BATCH_JOB             (brasero_batch_job_get_type ())
+#define BRASERO_BATCH_JOB(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), BRASERO_TYPE_BATCH_JOB, BraseroBatchJob))
+#define BRASERO_BATCH_JOB_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), BRASERO_TYPE_BATCH_JOB, BraseroBatchJobClass))
+#define BRASERO_IS_BATCH_JOB(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), BRASERO_TYPE_BATCH_JOB))
+#define BRASERO_IS_BATCH_JOB_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), BRASERO_TYPE_BATCH_JOB))
+#define BRASERO_BATCH_JOB_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), BRASERO_TYPE_BATCH_JOB, BraseroBatchJobClass))
+
+typedef struct _BraseroBatchJobClass BraseroBatchJobClass;
+typedef struct _BraseroBatchJob BraseroBatchJob;
+
+struct _BraseroBatchJobClass
+{
+	GObjectClass parent_class;
+};
+
+struct _BraseroBatchJob
+{
+	GObject parent_instance;
+};
+
+GType brasero_batch_job_get_type (void) G_GNUC_CONST;
+
+BraseroBatchJob *
+brasero_batch_job_new (BraseroBatchJobType type,
+		       const gchar *source);
+
+void
+brasero_batch_job_set_drive (BraseroBatchJob *job,
+			     BraseroDrive *drive);
+
+BraseroDrive *
+brasero_batch_job_get_drive (BraseroBatchJob *job);
+
+void
+brasero_batch_job_set_output (BraseroBatchJob *job,
+			      const gchar *path);
+
+void
+brasero_batch_job_set_checksum (BraseroBatchJob *job,
+				const gchar *checksum);
+
+void
+brasero_batch_job_add_flags (BraseroBatchJob *job,
+			     BraseroBurnFlag flags);
+
+void
+brasero_batch_job_set_rate (BraseroBatchJob *job,
+			    guint64 rate);
+
+void
+brasero_batch_job_set_force (BraseroBatchJob *job,
+			     gboolean force);
+
+BraseroBatchJobType
+brasero_batch_job_get_job_type (BraseroBatchJob *job);
+
+const gchar *
+brasero_batch_job_get_source (BraseroBatchJob *job);
+
+gboolean
+brasero_batch_job_can_use_drive (BraseroBatchJob *job,
+				 BraseroDrive *drive);
+
+void
+brasero_batch_job_start (BraseroBatchJob *job);
+
+void
+brasero_batch_job_cancel (BraseroBatchJob *job);
+
+BraseroBatchJobState
+brasero_batch_job_get_state (BraseroBatchJob *job);
+
+const GError *
+brasero_batch_job_get_error (BraseroBatchJob *job);
+
+BraseroBurnAction
+brasero_batch_job_get_action (BraseroBatchJob *job);
+
+gchar *
+brasero_batch_job_get_action_string (BraseroBatchJob *job);
+
+gdouble
+brasero_batch_job_get_progress (BraseroBatchJob *job);
+
+glong
+brasero_batch_job_get_remaining (BraseroBatchJob *job);
+
+guint64
+brasero_batch_job_get_rate (BraseroBatchJob *job);
+
+void
+brasero_batch_job_get_written (BraseroBatchJob *job,
+			       goffset *written,
+			       goffset *total);
+
+void
+brasero_batch_job_get_buffer_fill (BraseroBatchJob *job,
+				   gint *fifo,
+				   gint *buffer);
+
+void
+brasero_batch_job_get_copy_buffer (BraseroBatchJob *job,
+				   gint *fill,
+				   guint64 *read_rate,
+				   guint64 *write_rate);
+
+const gchar *
+brasero_batch_job_state_to_string (BraseroBatchJobState state);
+
+const gchar *
+brasero_batch_job_type_to_string (BraseroBatchJobType type);
+
+G_END_DECLS
+
+#endif /* _BRASERO_BATCH_JOB_H_ */
@@ -0,0 +1,581 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Brasero
+ * Copyright (C) Philippe Rouquier 2005-2010 <bonfire-app@wanadoo.fr>
+ * 
+ *  Brasero is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ * 
+ * brasero is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with brasero.  If not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string.h>
+#include <stdio.h>
+#include <locale.h>
+
+#include <glib.h>
+#include <glib/gi18n-lib.h>
+
+#include "brasero-burn-lib.h"
+#include "brasero-media.h"
+#include "brasero-medium-monitor.h"
+#include "brasero-medium.h"
+#include "brasero-drive.h"
+#include "brasero-units.h"
+#include "brasero-misc.h"
+
+#include "brasero-batch-job.h"
+
+/**
+ * Non interactive front end: runs a job on each of the given drives one after
+ * the other and reports progress on stdout as one JSON object per line.
+ */
+
+typedef struct _BraseroBatch BraseroBatch;
+struct _BraseroBatch {
+	GMainLoop *loop;
+	GTimer *timer;
+
+	GSList *jobs;
+	GSList *current;
+
+	gint failed;
+	guint bad_option:1;
+};
+
+static gchar **devices = NULL;
+static gchar **sources = NULL;
+static gchar *image_output = NULL;
+static gchar *checksum = NULL;
+static gint speed = 0;
+static gboolean blank = FALSE;
+static gboolean fast_blank = FALSE;
+static gboolean check = FALSE;
+static gboolean dummy = FALSE;
+static gboolean no_eject = FALSE;
+static gboolean force = FALSE;
+
+static const GOptionEntry batch_options [] = {
+	{ "device", 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &devices,
+	  N_("Add a drive to be used (can be given several times)"),
+	  N_("DEVICE PATH") },
+
+	{ "image-file", 0, 0, G_OPTION_ARG_FILENAME, &image_output,
+	  N_("Create an image file instead of burning"),
+	  N_("PATH") },
+
+	{ "blank", 'b', 0, G_OPTION_ARG_NONE, &blank,
+	  N_("Blank the disc"),
+	  NULL },
+
+	{ "fast", 0, 0, G_OPTION_ARG_NONE, &fast_blank,
+	  N_("Blank the disc quickly"),
+	  NULL },
+
+	{ "check", 'k', 0, G_OPTION_ARG_NONE, &check,
+	  N_("Check the integrity of the disc"),
+	  NULL },
+
+	{ "md5", 0, 0, G_OPTION_ARG_STRING, &checksum,
+	  N_("MD5 sum the disc should have"),
+	  N_("SUM") },
+
+	{ "speed", 0, 0, G_OPTION_ARG_INT, &speed,
+	  N_("Burning speed (as a multiple of the medium base speed)"),
+	  N_("SPEED") },
+
+	{ "dummy", 0, 0, G_OPTION_ARG_NONE, &dummy,
+	  N_("Simulate before burning"),
+	  NULL },
+
+	{ "no-eject", 0, 0, G_OPTION_ARG_NONE, &no_eject,
+	  N_("Do not eject the disc after burning"),
+	  NULL },
+
+	{ "force", 0, 0, G_OPTION_ARG_NONE, &force,
+	  N_("Go on even if data on the disc would be lost"),
+	  NULL },
+
+	{ G_OPTION_REMAINING, '\0', 0, G_OPTION_ARG_FILENAME_ARRAY, &sources,
+	  NULL, NULL },
+
+	{ NULL }
+};
+
+static const gchar *
+brasero_batch_action_to_stage (BraseroBurnAction action)
+{
+	const gchar *stages [BRASERO_BURN_ACTION_LAST] = { "none",
+							   "getting-size",
+							   "creating-image",
+							   "recording",
+							   "blanking",
+							   "checksum",
+							   "drive-copy",
+							   "file-copy",
+							   "analysing",
+							   "transcoding",
+							   "preparing",
+							   "leadin",
+							   "cd-text",
+							   "fixating",
+							   "leadout",
+							   "start-recording",
+							   "finished",
+							   "ejecting" };
+
+	if (action >= BRASERO_BURN_ACTION_LAST)
+		return "none";
+
+	return stages [action];
+}
+
+static void
+brasero_batch_json_string (GString *line,
+			   const gchar *key,
+			   const gchar *value)
+{
+	const gchar *iter;
+
+	g_string_append_printf (line, "%s\"%s\":", line->len > 1? ",":"", key);
+	if (!value) {
+		g_string_append (line, "null");
+		return;
+	}
+
+	g_string_append_c (line, '"');
+	for (iter = value; *iter; iter ++) {
+		guchar c = *iter;
+
+		if (c == '"' || c == '\\')
+			g_string_append_printf (line, "\\%c", c);
+		else if (c == '\n')
+			g_string_append (line, "\\n");
+		else if (c < 0x20)
+			g_string_append_printf (line, "\\u%04x", c);
+		else
+			g_string_append_c (line, c);
+	}
+	g_string_append_c (line, '"');
+}
+
+/* Negative values mean unknown */
+static void
+brasero_batch_json_int (GString *line,
+			const gchar *key,
+			gint64 value)
+{
+	if (value < 0)
+		g_string_append_printf (line, ",\"%s\":null", key);
+	else
+		g_string_append_printf (line, ",\"%s\":%" G_GINT64_FORMAT, key, value);
+}
+
+static void
+brasero_batch_json_double (GString *line,
+			   const gchar *key,
+			   gdouble value)
+{
+	gchar buffer [G_ASCII_DTOSTR_BUF_SIZE];
+
+	if (value < 0.0) {
+		g_string_append_printf (line, ",\"%s\":null", key);
+		return;
+	}
+
+	g_ascii_formatd (buffer, sizeof (buffer), "%.4f", value);
+	g_string_append_printf (line, ",\"%s\":%s", key, buffer);
+}
+
+static GString *
+brasero_batch_json_begin (BraseroBatch *batch,
+			  BraseroBatchJob *job,
+			  const gchar *event)
+{
+	BraseroDrive *drive;
+	GString *line;
+
+	line = g_string_new ("{");
+	brasero_batch_json_string (line, "event", event);
+	brasero_batch_json_double (line, "time", g_timer_elapsed (batch->timer, NULL));
+	brasero_batch_json_string (line, "job", brasero_batch_job_type_to_string (brasero_batch_job_get_job_type (job)));
+
+	drive = brasero_batch_job_get_drive (job);
+	brasero_batch_json_string (line, "device", drive? brasero_drive_get_device (drive):NULL);
+	brasero_batch_json_string (line, "state", brasero_batch_job_state_to_string (brasero_batch_job_get_state (job)));
+	return line;
+}
+
+static void
+brasero_batch_json_end (GString *line)
+{
+	g_string_append (line, "}\n");
+	fputs (line->str, stdout);
+	fflush (stdout);
+	g_string_free (line, TRUE);
+}
+
+static void
+brasero_batch_progress_changed_cb (BraseroBatchJob *job,
+				   BraseroBatch *batch)
+{
+	guint64 read_rate, write_rate;
+	goffset written, total;
+	gint fifo, buffer, fill;
+	gchar *action;
+	GString *line;
+
+	line = brasero_batch_json_begin (batch, job, "progress");
+
+	brasero_batch_json_string (line, "stage", brasero_batch_action_to_stage (brasero_batch_job_get_action (job)));
+
+	action = brasero_batch_job_get_action_string (job);
+	brasero_batch_json_string (line, "action", action);
+	g_free (action);
+
+	brasero_batch_json_double (line, "progress", brasero_batch_job_get_progress (job));
+
+	brasero_batch_job_get_written (job, &written, &total);
+	brasero_batch_json_int (line, "written", written);
+	brasero_batch_json_int (line, "total", total);
+
+	brasero_batch_json_int (line, "rate", brasero_batch_job_get_rate (job));
+	brasero_batch_json_int (line, "eta", brasero_batch_job_get_remaining (job));
+
+	brasero_batch_job_get_buffer_fill (job, &fifo, &buffer);
+	brasero_batch_json_int (line, "fifo", fifo);
+	brasero_batch_json_int (line, "buffer", buffer);
+
+	brasero_batch_job_get_copy_buffer (job, &fill, &read_rate, &write_rate);
+	brasero_batch_json_int (line, "copy_buffer", fill);
+	brasero_batch_json_int (line, "copy_read_rate", read_rate);
+	brasero_batch_json_int (line, "copy_write_rate", write_rate);
+
+	brasero_batch_json_end (line);
+}
+
+static void
+brasero_batch_next (BraseroBatch *batch);
+
+static void
+brasero_batch_finished_cb (BraseroBatchJob *job,
+			   BraseroBatch *batch)
+{
+	const GError *error;
+	GString *line;
+
+	error = brasero_batch_job_get_error (job);
+
+	line = brasero_batch_json_begin (batch, job, "finished");
+	brasero_batch_json_string (line, "error", error? error->message:NULL);
+	brasero_batch_json_end (line);
+
+	if (brasero_batch_job_get_state (job) != BRASERO_BATCH_JOB_SUCCEEDED)
+		batch->failed ++;
+
+	batch->current = batch->current->next;
+	brasero_batch_next (batch);
+}
+
+static gboolean
+brasero_batch_find_drive (BraseroBatchJob *job)
+{
+	BraseroMediumMonitor *monitor;
+	GSList *drives, *iter;
+	gboolean found = FALSE;
+
+	monitor = brasero_medium_monitor_get_default ();
+	drives = brasero_medium_monitor_get_drives (monitor, BRASERO_DRIVE_TYPE_ALL);
+	g_object_unref (monitor);
+
+	for (iter = drives; iter; iter = iter->next) {
+		if (brasero_batch_job_can_use_drive (job, iter->data)) {
+			brasero_batch_job_set_drive (job, iter->data);
+			found = TRUE;
+			break;
+		}
+	}
+	g_slist_foreach (drives, (GFunc) g_object_unref, NULL);
+	g_slist_free (drives);
+
+	return found;
+}
+
+/* Speed is converted to a rate once the medium is known */
+static void
+brasero_batch_set_speed (BraseroBatchJob *job)
+{
+	BraseroMedium *medium = NULL;
+	BraseroDrive *drive;
+
+	if (speed <= 0)
+		return;
+
+	drive = brasero_batch_job_get_drive (job);
+	if (drive)
+		medium = brasero_drive_get_medium (drive);
+
+	if (medium && (brasero_medium_get_status (medium) & BRASERO_MEDIUM_DVD))
+		brasero_batch_job_set_rate (job, BRASERO_SPEED_TO_RATE_DVD ((gdouble) speed));
+	else if (medium && (brasero_medium_get_status (medium) & BRASERO_MEDIUM_BD))
+		brasero_batch_job_set_rate (job, BRASERO_SPEED_TO_RATE_BD ((gdouble) speed));
+	else
+		brasero_batch_job_set_rate (job, BRASERO_SPEED_TO_RATE_CD ((gdouble) speed));
+}
+
+static void
+brasero_batch_next (BraseroBatch *batch)
+{
+	BraseroBatchJob *job;
+	GString *line;
+
+	if (!batch->current) {
+		g_main_loop_quit (batch->loop);
+		return;
+	}
+
+	job = batch->current->data;
+	if (!brasero_batch_job_get_drive (job))
+		brasero_batch_find_drive (job);
+
+	brasero_batch_set_speed (job);
+
+	line = brasero_batch_json_begin (batch, job, "start");
+	brasero_batch_json_string (line, "source", brasero_batch_job_get_source (job));
+	brasero_batch_json_end (line);
+
+	/* NOTE: this can call brasero_batch_finished_cb () right away */
+	brasero_batch_job_start (job);
+}
+
+static BraseroBatchJob *
+brasero_batch_new_job (BraseroBatch *batch,
+		       BraseroBatchJobType type,
+		       const gchar *source)
+{
+	BraseroBatchJob *job;
+
+	job = brasero_batch_job_new (type, source);
+	brasero_batch_job_set_force (job, force);
+	brasero_batch_job_set_checksum (job, checksum);
+	if (image_output)
+		brasero_batch_job_set_output (job, image_output);
+
+	if (type == BRASERO_BATCH_JOB_BLANK && fast_blank)
+		brasero_batch_job_add_flags (job, BRASERO_BURN_FLAG_FAST_BLANK);
+
+	if (type == BRASERO_BATCH_JOB_BURN) {
+		if (dummy)
+			brasero_batch_job_add_flags (job, BRASERO_BURN_FLAG_DUMMY);
+		if (!no_eject)
+			brasero_batch_job_add_flags (job, BRASERO_BURN_FLAG_EJECT);
+	}
+
+	g_signal_connect (job,
+			  "progress-changed",
+			  G_CALLBACK (brasero_batch_progress_changed_cb),
+			  batch);
+	g_signal_connect (job,
+			  "finished",
+			  G_CALLBACK (brasero_batch_finished_cb),
+			  batch);
+
+	batch->jobs = g_slist_append (batch->jobs, job);
+	return job;
+}
+
+static BraseroBatchJobType
+brasero_batch_get_job_type (void)
+{
+	if (blank)
+		return BRASERO_BATCH_JOB_BLANK;
+	if (check)
+		return BRASERO_BATCH_JOB_CHECKSUM;
+	if (image_output)
+		return BRASERO_BATCH_JOB_IMAGE;
+
+	return BRASERO_BATCH_JOB_BURN;
+}
+
+static gboolean
+brasero_batch_check_sources (GError **error)
+{
+	BraseroBatchJobType type;
+
+	type = brasero_batch_get_job_type ();
+	if ((type == BRASERO_BATCH_JOB_BURN || type == BRASERO_BATCH_JOB_IMAGE)
+	&&  (!sources || !sources [0])) {
+		g_set_error (error,
+			     G_OPTION_ERROR,
+			     G_OPTION_ERROR_FAILED,
+			     "%s",
+			     _("A project or an image is required"));
+		return FALSE;
+	}
+
+	/* All jobs run the same source */
+	if (sources && sources [0] && sources [1]) {
+		g_set_error (error,
+			     G_OPTION_ERROR,
+			     G_OPTION_ERROR_FAILED,
+			     "%s",
+			     _("Only one project or image can be given"));
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/* This must be called once libbrasero-media has finished probing the drives */
+static gboolean
+brasero_batch_add_jobs (BraseroBatch *batch,
+			GError **error)
+{
+	BraseroMediumMonitor *monitor;
+	BraseroBatchJobType type;
+	const gchar *source;
+	guint i;
+
+	type = brasero_batch_get_job_type ();
+	source = sources? sources [0]:NULL;
+
+	if (type == BRASERO_BATCH_JOB_IMAGE || !devices) {
+		brasero_batch_new_job (batch, type, source);
+		return TRUE;
+	}
+
+	monitor = brasero_medium_monitor_get_default ();
+	for (i = 0; devices [i]; i ++) {
+		BraseroBatchJob *job;
+		BraseroDrive *drive;
+
+		drive = brasero_medium_monitor_get_drive (monitor, devices [i]);
+		if (!drive) {
+			g_set_error (error,
+				     G_OPTION_ERROR,
+				     G_OPTION_ERROR_BAD_VALUE,
+				     /* Translators: %s is the path of a drive */
+				     _("\"%s\" cannot be found."),
+				     devices [i]);
+			g_object_unref (monitor);
+			return FALSE;
+		}
+
+		job = brasero_batch_new_job (batch, type, source);
+		brasero_batch_job_set_drive (job, drive);
+		g_object_unref (drive);
+	}
+
+	g_object_unref (monitor);
+	return TRUE;
+}
+
+static gboolean
+brasero_batch_start (gpointer data)
+{
+	BraseroBatch *batch = data;
+	BraseroMediumMonitor *monitor;
+	GError *error = NULL;
+
+	/* Drives are needed to pick one; probing goes on as long as the main
+	 * loop runs so check again later. */
+	monitor = brasero_medium_monitor_get_default ();
+	if (brasero_medium_monitor_is_probing (monitor)) {
+		g_object_unref (monitor);
+		return TRUE;
+	}
+	g_object_unref (monitor);
+
+	if (!brasero_batch_add_jobs (batch, &error)) {
+		g_printerr ("%s\n", error->message);
+		g_error_free (error);
+
+		batch->bad_option = TRUE;
+		g_main_loop_quit (batch->loop);
+		return FALSE;
+	}
+
+	batch->current = batch->jobs;
+	brasero_batch_next (batch);
+	return FALSE;
+}
+
+int
+main (int argc, char **argv)
+{
+	GOptionContext *context;
+	GError *error = NULL;
+	BraseroBatch batch;
+
+#ifdef ENABLE_NLS
+	bindtextdomain (GETTEXT_PACKAGE, PACKAGE_LOCALE_DIR);
+	bind_textdomain_codeset (GETTEXT_PACKAGE, "UTF-8");
+	textdomain (GETTEXT_PACKAGE);
+#endif
+
+	g_thread_init (NULL);
+	g_type_init ();
+
+	context = g_option_context_new (_("[PROJECT|IMAGE]"));
+	g_option_context_add_main_entries (context,
+					   batch_options,
+					   GETTEXT_PACKAGE);
+	g_option_context_set_translation_domain (context, GETTEXT_PACKAGE);
+
+	g_option_context_add_group (context, brasero_media_get_option_group ());
+	g_option_context_add_group (context, brasero_burn_library_get_option_group ());
+	g_option_context_add_group (context, brasero_utils_get_option_group ());
+	if (!g_option_context_parse (context, &argc, &argv, &error)) {
+		g_printerr ("%s\n", error->message);
+		g_printerr (_("Please type \"%s --help\" to see all available options\n"), argv [0]);
+		g_error_free (error);
+		g_option_context_free (context);
+		return 2;
+	}
+	g_option_context_free (context);
+
+	if (!brasero_batch_check_sources (&error)) {
+		g_printerr ("%s\n", error->message);
+		g_error_free (error);
+		return 2;
+	}
+
+	brasero_burn_library_start (&argc, &argv);
+
+	memset (&batch, 0, sizeof (BraseroBatch));
+
+	batch.timer = g_timer_new ();
+	batch.loop = g_main_loop_new (NULL, FALSE);
+
+	g_timeout_add (250, brasero_batch_start, &batch);
+	g_main_loop_run (batch.loop);
+
+	g_main_loop_unref (batch.loop);
+	g_timer_destroy (batch.timer);
+
+	g_slist_foreach (batch.jobs, (GFunc) g_object_unref, NULL);
+	g_slist_free (batch.jobs);
+
+	brasero_burn_library_stop ();
+
+	if (batch.bad_option)
+		return 2;
+
+	return batch.failed? 1:0;
+}
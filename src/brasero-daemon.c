@@ -0,0 +1,658 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Brasero
+ * Copyright (C) Philippe Rouquier 2005-2010 <bonfire-app@wanadoo.fr>
+ * 
+ *  Brasero is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ * 
+ * brasero is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with brasero.  If not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string.h>
+#include <locale.h>
+
+#include <glib.h>
+#include <glib/gi18n-lib.h>
+#include <gio/gio.h>
+
+#include <gtk/gtk.h>
+
+#include "brasero-burn-lib.h"
+#include "brasero-medium-monitor.h"
+#include "brasero-drive.h"
+
+#include "brasero-batch-job.h"
+
+#define BRASERO_DAEMON_SERVICE		"org.gnome.Brasero.Daemon"
+#define BRASERO_DAEMON_PATH		"/org/gnome/Brasero/Daemon"
+#define BRASERO_DAEMON_INTERFACE	"org.gnome.Brasero.Daemon"
+
+/* Number of finished jobs kept around for ListJobs */
+#define BRASERO_DAEMON_MAX_FINISHED	32
+
+static const gchar introspection_xml [] =
+	"<node>"
+	"  <interface name='" BRASERO_DAEMON_INTERFACE "'>"
+	"    <method name='Burn'>"
+	"      <arg type='s' name='source' direction='in'/>"
+	"      <arg type='s' name='device' direction='in'/>"
+	"      <arg type='a{sv}' name='options' direction='in'/>"
+	"      <arg type='u' name='id' direction='out'/>"
+	"    </method>"
+	"    <method name='Image'>"
+	"      <arg type='s' name='source' direction='in'/>"
+	"      <arg type='s' name='output' direction='in'/>"
+	"      <arg type='u' name='id' direction='out'/>"
+	"    </method>"
+	"    <method name='Checksum'>"
+	"      <arg type='s' name='device' direction='in'/>"
+	"      <arg type='s' name='md5' direction='in'/>"
+	"      <arg type='u' name='id' direction='out'/>"
+	"    </method>"
+	"    <method name='Blank'>"
+	"      <arg type='s' name='device' direction='in'/>"
+	"      <arg type='a{sv}' name='options' direction='in'/>"
+	"      <arg type='u' name='id' direction='out'/>"
+	"    </method>"
+	"    <method name='Cancel'>"
+	"      <arg type='u' name='id' direction='in'/>"
+	"    </method>"
+	"    <method name='ListJobs'>"
+	"      <arg type='a(usssssd)' name='jobs' direction='out'/>"
+	"    </method>"
+	"    <signal name='JobChanged'>"
+	"      <arg type='u' name='id'/>"
+	"      <arg type='s' name='state'/>"
+	"      <arg type='s' name='action'/>"
+	"      <arg type='d' name='progress'/>"
+	"      <arg type='x' name='remaining'/>"
+	"      <arg type='t' name='rate'/>"
+	"    </signal>"
+	"    <signal name='JobFinished'>"
+	"      <arg type='u' name='id'/>"
+	"      <arg type='s' name='state'/>"
+	"      <arg type='s' name='error'/>"
+	"    </signal>"
+	"  </interface>"
+	"</node>";
+
+typedef struct _BraseroDaemon BraseroDaemon;
+struct _BraseroDaemon {
+	GMainLoop *loop;
+	GDBusConnection *connection;
+	GDBusNodeInfo *introspection;
+
+	BraseroMediumMonitor *monitor;
+
+	/* Each job runs its burn in its own thread so one job can run per
+	 * drive; the jobs targeting a busy drive wait in the queue. */
+	GQueue queue;
+	GQueue running;
+	GQueue finished;
+
+	guint next_id;
+	guint schedule_id;
+};
+
+#define BRASERO_DAEMON_JOB_ID(job)	GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (job), "daemon-job-id"))
+
+static void
+brasero_daemon_schedule (BraseroDaemon *daemon);
+
+static void
+brasero_daemon_emit (BraseroDaemon *daemon,
+		     const gchar *name,
+		     GVariant *parameters)
+{
+	GError *error = NULL;
+
+	if (!daemon->connection) {
+		g_variant_unref (g_variant_ref_sink (parameters));
+		return;
+	}
+
+	if (!g_dbus_connection_emit_signal (daemon->connection,
+					    NULL,
+					    BRASERO_DAEMON_PATH,
+					    BRASERO_DAEMON_INTERFACE,
+					    name,
+					    parameters,
+					    &error)) {
+		g_warning ("Could not emit %s: %s", name, error->message);
+		g_error_free (error);
+	}
+}
+
+static void
+brasero_daemon_job_changed_cb (BraseroBatchJob *job,
+			       BraseroDaemon *daemon)
+{
+	gchar *action;
+
+	action = brasero_batch_job_get_action_string (job);
+	brasero_daemon_emit (daemon,
+			     "JobChanged",
+			     g_variant_new ("(ussdxt)",
+					    BRASERO_DAEMON_JOB_ID (job),
+					    brasero_batch_job_state_to_string (brasero_batch_job_get_state (job)),
+					    action? action:"",
+					    brasero_batch_job_get_progress (job),
+					    (gint64) brasero_batch_job_get_remaining (job),
+					    brasero_batch_job_get_rate (job)));
+	g_free (action);
+}
+
+static void
+brasero_daemon_job_finished_cb (BraseroBatchJob *job,
+				BraseroDaemon *daemon)
+{
+	const GError *error;
+
+	error = brasero_batch_job_get_error (job);
+	brasero_daemon_emit (daemon,
+			     "JobFinished",
+			     g_variant_new ("(uss)",
+					    BRASERO_DAEMON_JOB_ID (job),
+					    brasero_batch_job_state_to_string (brasero_batch_job_get_state (job)),
+					    error? error->message:""));
+
+	/* It may be finished while still waiting (cancelled) */
+	if (g_queue_find (&daemon->running, job))
+		g_queue_remove (&daemon->running, job);
+	else
+		g_queue_remove (&daemon->queue, job);
+
+	g_queue_push_head (&daemon->finished, job);
+	while (g_queue_get_length (&daemon->finished) > BRASERO_DAEMON_MAX_FINISHED)
+		g_object_unref (g_queue_pop_tail (&daemon->finished));
+
+	brasero_daemon_schedule (daemon);
+}
+
+static gboolean
+brasero_daemon_drive_is_busy (BraseroDaemon *daemon,
+			      BraseroDrive *drive)
+{
+	GList *iter;
+
+	/* Images are written to files; there can be as many as wanted */
+	if (brasero_drive_is_fake (drive))
+		return FALSE;
+
+	for (iter = daemon->running.head; iter; iter = iter->next) {
+		if (brasero_batch_job_get_drive (iter->data) == drive)
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+/**
+ * Jobs given a device run on it once it is free; the others are given the
+ * first free drive whose medium suits them. If a job cannot run yet, the
+ * following ones get a chance so that a job waiting for a blank disc or a busy
+ * drive does not hold back a checksum on another drive.
+ */
+
+static gboolean
+brasero_daemon_find_drive (BraseroDaemon *daemon,
+			   BraseroBatchJob *job)
+{
+	GSList *drives, *iter;
+	gboolean found = FALSE;
+
+	if (brasero_batch_job_get_drive (job))
+		return !brasero_daemon_drive_is_busy (daemon, brasero_batch_job_get_drive (job));
+
+	drives = brasero_medium_monitor_get_drives (daemon->monitor, BRASERO_DRIVE_TYPE_ALL);
+	for (iter = drives; iter; iter = iter->next) {
+		BraseroDrive *drive;
+
+		drive = iter->data;
+		if (!brasero_daemon_drive_is_busy (daemon, drive)
+		&&   brasero_batch_job_can_use_drive (job, drive)) {
+			brasero_batch_job_set_drive (job, drive);
+			found = TRUE;
+			break;
+		}
+	}
+	g_slist_foreach (drives, (GFunc) g_object_unref, NULL);
+	g_slist_free (drives);
+
+	return found;
+}
+
+static gboolean
+brasero_daemon_next_job (gpointer data)
+{
+	BraseroDaemon *daemon = data;
+	GList *iter, *next;
+
+	daemon->schedule_id = 0;
+
+	/* Wait for the drives to be known */
+	if (brasero_medium_monitor_is_probing (daemon->monitor)) {
+		daemon->schedule_id = g_timeout_add_seconds (1, brasero_daemon_next_job, daemon);
+		return FALSE;
+	}
+
+	for (iter = daemon->queue.head; iter; iter = next) {
+		BraseroBatchJob *job;
+
+		next = iter->next;
+		job = iter->data;
+		if (!brasero_daemon_find_drive (daemon, job))
+			continue;
+
+		/* NOTE: the job can be finished right away */
+		g_queue_delete_link (&daemon->queue, iter);
+		g_queue_push_tail (&daemon->running, job);
+		brasero_batch_job_start (job);
+	}
+
+	return FALSE;
+}
+
+static void
+brasero_daemon_schedule (BraseroDaemon *daemon)
+{
+	if (daemon->schedule_id)
+		return;
+
+	if (g_queue_is_empty (&daemon->queue))
+		return;
+
+	daemon->schedule_id = g_idle_add (brasero_daemon_next_job, daemon);
+}
+
+static void
+brasero_daemon_medium_changed_cb (BraseroMediumMonitor *monitor,
+				  BraseroMedium *medium,
+				  BraseroDaemon *daemon)
+{
+	brasero_daemon_schedule (daemon);
+}
+
+static BraseroBatchJob *
+brasero_daemon_find_job (BraseroDaemon *daemon,
+			 guint id)
+{
+	GList *iter;
+
+	for (iter = daemon->running.head; iter; iter = iter->next) {
+		if (BRASERO_DAEMON_JOB_ID (iter->data) == id)
+			return iter->data;
+	}
+
+	for (iter = daemon->queue.head; iter; iter = iter->next) {
+		if (BRASERO_DAEMON_JOB_ID (iter->data) == id)
+			return iter->data;
+	}
+
+	return NULL;
+}
+
+static guint
+brasero_daemon_add_job (BraseroDaemon *daemon,
+			BraseroBatchJob *job)
+{
+	guint id;
+
+	id = ++ daemon->next_id;
+	g_object_set_data (G_OBJECT (job), "daemon-job-id", GUINT_TO_POINTER (id));
+
+	g_signal_connect (job,
+			  "progress-changed",
+			  G_CALLBACK (brasero_daemon_job_changed_cb),
+			  daemon);
+	g_signal_connect (job,
+			  "finished",
+			  G_CALLBACK (brasero_daemon_job_finished_cb),
+			  daemon);
+
+	g_queue_push_tail (&daemon->queue, job);
+	brasero_daemon_schedule (daemon);
+	return id;
+}
+
+static gboolean
+brasero_daemon_set_device (BraseroDaemon *daemon,
+			   BraseroBatchJob *job,
+			   const gchar *device,
+			   GError **error)
+{
+	BraseroDrive *drive;
+
+	if (!device || device [0] == '\0')
+		return TRUE;
+
+	drive = brasero_medium_monitor_get_drive (daemon->monitor, device);
+	if (!drive) {
+		g_set_error (error,
+			     G_DBUS_ERROR,
+			     G_DBUS_ERROR_INVALID_ARGS,
+			     _("\"%s\" cannot be found"),
+			     device);
+		return FALSE;
+	}
+
+	brasero_batch_job_set_drive (job, drive);
+	g_object_unref (drive);
+	return TRUE;
+}
+
+static void
+brasero_daemon_set_options (BraseroBatchJob *job,
+			    GVariant *options)
+{
+	gboolean value;
+	guint64 rate;
+
+	if (g_variant_lookup (options, "rate", "t", &rate))
+		brasero_batch_job_set_rate (job, rate);
+
+	if (g_variant_lookup (options, "force", "b", &value))
+		brasero_batch_job_set_force (job, value);
+
+	if (g_variant_lookup (options, "dummy", "b", &value) && value)
+		brasero_batch_job_add_flags (job, BRASERO_BURN_FLAG_DUMMY);
+
+	if (g_variant_lookup (options, "eject", "b", &value) && value)
+		brasero_batch_job_add_flags (job, BRASERO_BURN_FLAG_EJECT);
+
+	if (g_variant_lookup (options, "multi", "b", &value) && value)
+		brasero_batch_job_add_flags (job, BRASERO_BURN_FLAG_MULTI);
+
+	if (g_variant_lookup (options, "fast", "b", &value) && value)
+		brasero_batch_job_add_flags (job, BRASERO_BURN_FLAG_FAST_BLANK);
+}
+
+static void
+brasero_daemon_list_jobs_add (GVariantBuilder *builder,
+			      BraseroBatchJob *job)
+{
+	BraseroDrive *drive;
+	const gchar *source;
+	gchar *action;
+
+	drive = brasero_batch_job_get_drive (job);
+	source = brasero_batch_job_get_source (job);
+	action = brasero_batch_job_get_action_string (job);
+	g_variant_builder_add (builder,
+			       "(usssssd)",
+			       BRASERO_DAEMON_JOB_ID (job),
+			       brasero_batch_job_type_to_string (brasero_batch_job_get_job_type (job)),
+			       brasero_batch_job_state_to_string (brasero_batch_job_get_state (job)),
+			       action? action:"",
+			       drive? brasero_drive_get_device (drive):"",
+			       source? source:"",
+			       brasero_batch_job_get_progress (job));
+	g_free (action);
+}
+
+static void
+brasero_daemon_method_call (GDBusConnection *connection,
+			    const gchar *sender,
+			    const gchar *object_path,
+			    const gchar *interface_name,
+			    const gchar *method_name,
+			    GVariant *parameters,
+			    GDBusMethodInvocation *invocation,
+			    gpointer user_data)
+{
+	BraseroDaemon *daemon = user_data;
+	BraseroBatchJob *job = NULL;
+	GError *error = NULL;
+
+	if (!g_strcmp0 (method_name, "Burn")) {
+		const gchar *source, *device;
+		GVariant *options;
+
+		g_variant_get (parameters, "(&s&s@a{sv})", &source, &device, &options);
+		job = brasero_batch_job_new (BRASERO_BATCH_JOB_BURN, source);
+		brasero_batch_job_add_flags (job, BRASERO_BURN_FLAG_EJECT);
+		brasero_daemon_set_options (job, options);
+		g_variant_unref (options);
+
+		if (!brasero_daemon_set_device (daemon, job, device, &error))
+			goto error;
+	}
+	else if (!g_strcmp0 (method_name, "Image")) {
+		const gchar *source, *output;
+
+		g_variant_get (parameters, "(&s&s)", &source, &output);
+		if (!g_path_is_absolute (output)) {
+			g_set_error (&error,
+				     G_DBUS_ERROR,
+				     G_DBUS_ERROR_INVALID_ARGS,
+				     "%s",
+				     _("An image can only be created on a local file"));
+			goto error;
+		}
+
+		job = brasero_batch_job_new (BRASERO_BATCH_JOB_IMAGE, source);
+		brasero_batch_job_set_output (job, output);
+	}
+	else if (!g_strcmp0 (method_name, "Checksum")) {
+		const gchar *device, *md5;
+
+		g_variant_get (parameters, "(&s&s)", &device, &md5);
+		job = brasero_batch_job_new (BRASERO_BATCH_JOB_CHECKSUM, NULL);
+		brasero_batch_job_set_checksum (job, md5);
+
+		if (!brasero_daemon_set_device (daemon, job, device, &error))
+			goto error;
+	}
+	else if (!g_strcmp0 (method_name, "Blank")) {
+		const gchar *device;
+		GVariant *options;
+
+		g_variant_get (parameters, "(&s@a{sv})", &device, &options);
+		job = brasero_batch_job_new (BRASERO_BATCH_JOB_BLANK, NULL);
+		brasero_daemon_set_options (job, options);
+		g_variant_unref (options);
+
+		if (!brasero_daemon_set_device (daemon, job, device, &error))
+			goto error;
+	}
+	else if (!g_strcmp0 (method_name, "Cancel")) {
+		BraseroBatchJob *cancelled;
+		guint id;
+
+		g_variant_get (parameters, "(u)", &id);
+		cancelled = brasero_daemon_find_job (daemon, id);
+		if (!cancelled) {
+			g_dbus_method_invocation_return_error (invocation,
+							       G_DBUS_ERROR,
+							       G_DBUS_ERROR_INVALID_ARGS,
+							       "No job with id %u",
+							       id);
+			return;
+		}
+
+		brasero_batch_job_cancel (cancelled);
+		g_dbus_method_invocation_return_value (invocation, NULL);
+		return;
+	}
+	else if (!g_strcmp0 (method_name, "ListJobs")) {
+		GVariantBuilder builder;
+		GList *iter;
+
+		g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(usssssd)"));
+		for (iter = daemon->running.head; iter; iter = iter->next)
+			brasero_daemon_list_jobs_add (&builder, iter->data);
+		for (iter = daemon->queue.head; iter; iter = iter->next)
+			brasero_daemon_list_jobs_add (&builder, iter->data);
+		for (iter = daemon->finished.head; iter; iter = iter->next)
+			brasero_daemon_list_jobs_add (&builder, iter->data);
+
+		g_dbus_method_invocation_return_value (invocation,
+						       g_variant_new ("(a(usssssd))", &builder));
+		return;
+	}
+
+	if (!job) {
+		g_dbus_method_invocation_return_error (invocation,
+						       G_DBUS_ERROR,
+						       G_DBUS_ERROR_UNKNOWN_METHOD,
+						       "Unknown method %s",
+						       method_name);
+		return;
+	}
+
+	g_dbus_method_invocation_return_value (invocation,
+					       g_variant_new ("(u)", brasero_daemon_add_job (daemon, job)));
+	return;
+
+error:
+
+	if (job)
+		g_object_unref (job);
+
+	g_dbus_method_invocation_return_gerror (invocation, error);
+	g_error_free (error);
+}
+
+static const GDBusInterfaceVTable interface_vtable = {
+	brasero_daemon_method_call,
+	NULL,
+	NULL
+};
+
+static void
+brasero_daemon_bus_acquired_cb (GDBusConnection *connection,
+				const gchar *name,
+				gpointer user_data)
+{
+	BraseroDaemon *daemon = user_data;
+	GError *error = NULL;
+
+	daemon->connection = g_object_ref (connection);
+	if (!g_dbus_connection_register_object (connection,
+						BRASERO_DAEMON_PATH,
+						daemon->introspection->interfaces [0],
+						&interface_vtable,
+						daemon,
+						NULL,
+						&error)) {
+		g_warning ("Could not register %s: %s", BRASERO_DAEMON_PATH, error->message);
+		g_error_free (error);
+		g_main_loop_quit (daemon->loop);
+	}
+}
+
+static void
+brasero_daemon_name_lost_cb (GDBusConnection *connection,
+			     const gchar *name,
+			     gpointer user_data)
+{
+	BraseroDaemon *daemon = user_data;
+
+	/* Another instance is already running or the bus went away */
+	g_warning ("Could not own %s", name);
+	g_main_loop_quit (daemon->loop);
+}
+
+int
+main (int argc, char **argv)
+{
+	BraseroDaemon daemon;
+	guint owner_id;
+
+#ifdef ENABLE_NLS
+	bindtextdomain (GETTEXT_PACKAGE, PACKAGE_LOCALE_DIR);
+	bind_textdomain_codeset (GETTEXT_PACKAGE, "UTF-8");
+	textdomain (GETTEXT_PACKAGE);
+#endif
+
+	g_thread_init (NULL);
+	g_type_init ();
+
+	/* The daemon can run without display */
+	gtk_init_check (&argc, &argv);
+
+	brasero_burn_library_start (&argc, &argv);
+
+	memset (&daemon, 0, sizeof (BraseroDaemon));
+	g_queue_init (&daemon.queue);
+	g_queue_init (&daemon.running);
+	g_queue_init (&daemon.finished);
+
+	daemon.introspection = g_dbus_node_info_new_for_xml (introspection_xml, NULL);
+	daemon.loop = g_main_loop_new (NULL, FALSE);
+
+	daemon.monitor = brasero_medium_monitor_get_default ();
+	g_signal_connect (daemon.monitor,
+			  "medium-added",
+			  G_CALLBACK (brasero_daemon_medium_changed_cb),
+			  &daemon);
+	g_signal_connect (daemon.monitor,
+			  "medium-removed",
+			  G_CALLBACK (brasero_daemon_medium_changed_cb),
+			  &daemon);
+
+	owner_id = g_bus_own_name (G_BUS_TYPE_SESSION,
+				   BRASERO_DAEMON_SERVICE,
+				   G_BUS_NAME_OWNER_FLAGS_NONE,
+				   brasero_daemon_bus_acquired_cb,
+				   NULL,
+				   brasero_daemon_name_lost_cb,
+				   &daemon,
+				   NULL);
+
+	g_main_loop_run (daemon.loop);
+
+	g_bus_unown_name (owner_id);
+
+	g_signal_handlers_disconnect_by_func (daemon.monitor,
+					      brasero_daemon_medium_changed_cb,
+					      &daemon);
+
+	/* Nothing must start while the running jobs are stopped */
+	if (daemon.schedule_id) {
+		g_source_remove (daemon.schedule_id);
+		daemon.schedule_id = 0;
+	}
+
+	g_queue_foreach (&daemon.queue, (GFunc) g_object_unref, NULL);
+	g_queue_clear (&daemon.queue);
+
+	/* Wait for the threads of the running jobs to return */
+	g_queue_foreach (&daemon.running, (GFunc) brasero_batch_job_cancel, NULL);
+	while (!g_queue_is_empty (&daemon.running))
+		g_main_context_iteration (NULL, TRUE);
+
+	if (daemon.schedule_id)
+		g_source_remove (daemon.schedule_id);
+
+	g_object_unref (daemon.monitor);
+	g_queue_foreach (&daemon.finished, (GFunc) g_object_unref, NULL);
+	g_queue_clear (&daemon.finished);
+
+	if (daemon.connection)
+		g_object_unref (daemon.connection);
+
+	g_dbus_node_info_unref (daemon.introspection);
+	g_main_loop_unref (daemon.loop);
+
+	brasero_burn_library_stop ();
+
+	return 0;
+}
@@ -37,6 +37,7 @@
 #include <libxml/xmlerror.h>
 #include <libxml/xmlwriter.h>
 #include <libxml/parser.h>
+#include <libxml/xmlreader.h>
 #include <libxml/xmlstring.h>
 #include <libxml/uri.h>
 
@@ -45,7 +46,7 @@
 #endif
 
 #include "brasero-project-parse.h"
-#include "brasero-app.h"
+#include "brasero-error.h"
 
 #include "brasero-units.h"
 #include "brasero-track-stream-cfg.h"
@@ -55,137 +56,185 @@
 
 #define BRASERO_PROJECT_VERSION "0.2"
 
+/* Suffix of the data project snapshot saved next to the project file */
+#define BRASERO_PROJECT_SNAPSHOT_SUFFIX	".snapshot"
+
 static void
-brasero_project_invalid_project_dialog (const char *reason)
+brasero_project_invalid_project_error (GError **error,
+				       const char *reason)
 {
-	brasero_app_alert (brasero_app_get_default (),
-			   _("Error while loading the project."),
-			   reason,
-			   GTK_MESSAGE_ERROR);
+	g_set_error (error,
+		     BRASERO_BURN_ERROR,
+		     BRASERO_BURN_ERROR_GENERAL,
+		     "%s",
+		     reason);
 }
 
-static GSList *
-_read_graft_point (xmlDocPtr project,
-		   xmlNodePtr graft,
-		   GSList *grafts)
+/**
+ * Projects are read with an xmlTextReader so that only the current element is
+ * in memory. That way data projects with a lot of grafts can be loaded without
+ * building a whole document tree and then lists of grafts.
+ */
+
+/* Moves to the next child element of the element at depth. Returns 1 if there
+ * is one, 0 if there isn't and -1 on error. */
+static gint
+_read_next_element (xmlTextReaderPtr reader,
+		    gint depth)
 {
-	BraseroGraftPt *retval;
+	gint result;
 
-	retval = g_new0 (BraseroGraftPt, 1);
-        grafts = g_slist_prepend (grafts, retval);
-	while (graft) {
-		if (!xmlStrcmp (graft->name, (const xmlChar *) "uri")) {
-			xmlChar *uri;
+	while ((result = xmlTextReaderRead (reader)) == 1) {
+		gint node_depth;
+
+		node_depth = xmlTextReaderDepth (reader);
+		if (node_depth <= depth)
+			return 0;
+
+		if (node_depth == depth + 1
+		&&  xmlTextReaderNodeType (reader) == XML_READER_TYPE_ELEMENT)
+			return 1;
+	}
+
+	return result;
+}
+
+static gboolean
+_read_element_is (xmlTextReaderPtr reader,
+		  const gchar *name)
+{
+	return !xmlStrcmp (xmlTextReaderConstName (reader), (const xmlChar *) name);
+}
+
+static gboolean
+_read_graft_point (xmlTextReaderPtr reader,
+		   BraseroTrackDataCfg *track)
+{
+	gchar *path = NULL;
+	gchar *uri = NULL;
+	gint result;
+	gint depth;
+
+	if (xmlTextReaderIsEmptyElement (reader))
+		return FALSE;
+
+	depth = xmlTextReaderDepth (reader);
+	while ((result = _read_next_element (reader, depth)) == 1) {
+		if (_read_element_is (reader, "uri")) {
+			xmlChar *escaped;
 
-			if (retval->uri)
+			if (uri)
 				goto error;
 
-			uri = xmlNodeListGetString (project,
-						    graft->xmlChildrenNode,
-						    1);
-			retval->uri = g_uri_unescape_string ((char *)uri, NULL);
-			g_free (uri);
-			if (!retval->uri)
+			escaped = xmlTextReaderReadString (reader);
+			uri = g_uri_unescape_string ((char *) escaped, NULL);
+			g_free (escaped);
+			if (!uri)
 				goto error;
 		}
-		else if (!xmlStrcmp (graft->name, (const xmlChar *) "path")) {
-			if (retval->path)
+		else if (_read_element_is (reader, "path")) {
+			if (path)
 				goto error;
 
-			retval->path = (char *) xmlNodeListGetString (project,
-								      graft->xmlChildrenNode,
-								      1);
-			if (!retval->path)
+			path = (gchar *) xmlTextReaderReadString (reader);
+			if (!path)
 				goto error;
 		}
-		else if (graft->type == XML_ELEMENT_NODE)
+		else
 			goto error;
-
-		graft = graft->next;
 	}
 
-	return grafts;
+	if (result < 0)
+		goto error;
 
-error:
+	brasero_track_data_cfg_load_graft (track, path, uri);
+	g_free (path);
+	g_free (uri);
+	return TRUE;
 
-        g_slist_foreach (grafts, (GFunc) brasero_graft_point_free, NULL);
-        g_slist_free (grafts);
+error:
 
-	return NULL;
+	g_free (path);
+	g_free (uri);
+	return FALSE;
 }
 
 static BraseroTrack *
-_read_data_track (xmlDocPtr project,
-		  xmlNodePtr item)
+_read_data_track (xmlTextReaderPtr reader,
+		  const gchar *project_path)
 {
 	BraseroTrackDataCfg *track;
-        GSList *grafts= NULL;
-        GSList *excluded = NULL;
+	gint result = 0;
+	gint depth;
 
 	track = brasero_track_data_cfg_new ();
 
-	while (item) {
-		if (!xmlStrcmp (item->name, (const xmlChar *) "graft")) {
-			if (!(grafts = _read_graft_point (project, item->xmlChildrenNode, grafts)))
-				goto error;
-		}
-		else if (!xmlStrcmp (item->name, (const xmlChar *) "icon")) {
-			xmlChar *icon_path;
+	if (project_path) {
+		gchar *snapshot;
 
-			icon_path = xmlNodeListGetString (project,
-							  item->xmlChildrenNode,
-							  1);
-			if (!icon_path)
-				goto error;
+		/* The tree is restored from it if it is still valid */
+		snapshot = g_strconcat (project_path, BRASERO_PROJECT_SNAPSHOT_SUFFIX, NULL);
+		brasero_track_data_cfg_set_snapshot (track, snapshot, project_path);
+		g_free (snapshot);
+	}
 
-			brasero_track_data_cfg_set_icon (track, (gchar *) icon_path, NULL);
-                        g_free (icon_path);
-		}
-		else if (!xmlStrcmp (item->name, (const xmlChar *) "restored")) {
-			xmlChar *restored;
+	/* Grafts are added to the tree as they are read */
+	brasero_track_data_cfg_load_begin (track);
 
-			restored = xmlNodeListGetString (project,
-							 item->xmlChildrenNode,
-							 1);
-			if (!restored)
-				goto error;
+	depth = xmlTextReaderDepth (reader);
+	if (!xmlTextReaderIsEmptyElement (reader)) {
+		while ((result = _read_next_element (reader, depth)) == 1) {
+			if (_read_element_is (reader, "graft")) {
+				if (!_read_graft_point (reader, track))
+					goto error;
+			}
+			else if (_read_element_is (reader, "icon")) {
+				xmlChar *icon_path;
 
-                        brasero_track_data_cfg_dont_filter_uri (track, (gchar *) restored);
-                        g_free (restored);
-		}
-		else if (!xmlStrcmp (item->name, (const xmlChar *) "excluded")) {
-			xmlChar *excluded_uri;
+				icon_path = xmlTextReaderReadString (reader);
+				if (!icon_path)
+					goto error;
 
-			excluded_uri = xmlNodeListGetString (project,
-							     item->xmlChildrenNode,
-							     1);
-			if (!excluded_uri)
-				goto error;
+				brasero_track_data_cfg_set_icon (track, (gchar *) icon_path, NULL);
+				g_free (icon_path);
+			}
+			else if (_read_element_is (reader, "restored")) {
+				xmlChar *restored;
 
-			excluded = g_slist_prepend (excluded, xmlURIUnescapeString ((char*) excluded_uri, 0, NULL));
-			g_free (excluded_uri);
-		}
-		else if (item->type == XML_ELEMENT_NODE)
-			goto error;
+				restored = xmlTextReaderReadString (reader);
+				if (!restored)
+					goto error;
 
-		item = item->next;
+				brasero_track_data_cfg_dont_filter_uri (track, (gchar *) restored);
+				g_free (restored);
+			}
+			else if (_read_element_is (reader, "excluded")) {
+				xmlChar *excluded_uri;
+				gchar *unescaped;
+
+				excluded_uri = xmlTextReaderReadString (reader);
+				if (!excluded_uri)
+					goto error;
+
+				unescaped = (gchar *) xmlURIUnescapeString ((char*) excluded_uri, 0, NULL);
+				g_free (excluded_uri);
+
+				brasero_track_data_cfg_load_excluded (track, unescaped);
+				g_free (unescaped);
+			}
+			else
+				goto error;
+		}
 	}
 
-        grafts = g_slist_reverse (grafts);
-        excluded = g_slist_reverse (excluded);
-        brasero_track_data_set_source (BRASERO_TRACK_DATA (track),
-                                                           grafts,
-                                                           excluded);
+	if (result < 0)
+		goto error;
+
+	brasero_track_data_cfg_load_end (track);
 	return BRASERO_TRACK (track);
 
 error:
 
-        g_slist_foreach (grafts, (GFunc) brasero_graft_point_free, NULL);
-        g_slist_free (grafts);
-
-        g_slist_foreach (excluded, (GFunc) g_free, NULL);
-        g_slist_free (excluded);
-
 	g_object_unref (track);
 
 	return NULL;
@@ -363,48 +412,52 @@ error:
 }
 
 static gboolean
-_get_tracks (xmlDocPtr project,
-	     xmlNodePtr track_node,
+_get_tracks (xmlTextReaderPtr reader,
+	     const gchar *project_path,
 	     BraseroBurnSession *session)
 {
 	GSList *tracks = NULL;
 	GSList *iter;
+	gint result;
+	gint depth;
 
-	track_node = track_node->xmlChildrenNode;
+	if (xmlTextReaderIsEmptyElement (reader))
+		return FALSE;
 
-	while (track_node) {
+	depth = xmlTextReaderDepth (reader);
+	while ((result = _read_next_element (reader, depth)) == 1) {
 		BraseroTrack *newtrack;
 
-		if (!xmlStrcmp (track_node->name, (const xmlChar *) "audio")) {
-			newtrack = _read_audio_track (project, track_node->xmlChildrenNode, FALSE);
-			if (!newtrack)
-				goto error;
+		if (_read_element_is (reader, "audio")
+		||  _read_element_is (reader, "video")) {
+			xmlNodePtr track_node;
 
-			tracks = g_slist_append (tracks, newtrack);
-		}
-		else if (!xmlStrcmp (track_node->name, (const xmlChar *) "data")) {
-			newtrack = _read_data_track (project, track_node->xmlChildrenNode);
+			/* These are small enough to be expanded */
+			track_node = xmlTextReaderExpand (reader);
+			if (!track_node)
+				goto error;
 
+			newtrack = _read_audio_track (xmlTextReaderCurrentDoc (reader),
+						      track_node->xmlChildrenNode,
+						      _read_element_is (reader, "video"));
 			if (!newtrack)
 				goto error;
 
 			tracks = g_slist_append (tracks, newtrack);
 		}
-		else if (!xmlStrcmp (track_node->name, (const xmlChar *) "video")) {
-			newtrack = _read_audio_track (project, track_node->xmlChildrenNode, TRUE);
+		else if (_read_element_is (reader, "data")) {
+			newtrack = _read_data_track (reader, project_path);
 
 			if (!newtrack)
 				goto error;
 
 			tracks = g_slist_append (tracks, newtrack);
 		}
-		else if (track_node->type == XML_ELEMENT_NODE)
+		else
 			goto error;
-
-		track_node = track_node->next;
 	}
 
-	if (!tracks)
+	if (result < 0 || !tracks)
 		goto error;
 
 	for (iter = tracks; iter; iter = iter->next) {
@@ -432,16 +485,16 @@ error :
 gboolean
 brasero_project_open_project_xml (const gchar *uri,
 				  BraseroBurnSession *session,
-				  gboolean warn_user)
+				  GError **error)
 {
-	xmlNodePtr track_node = NULL;
+	xmlTextReaderPtr reader;
+	gboolean has_tracks = FALSE;
 	gchar *label = NULL;
 	gchar *cover = NULL;
-	xmlDocPtr project;
-	xmlNodePtr item;
 	gboolean retval;
 	GFile *file;
 	gchar *path;
+	gint result;
 
 	file = g_file_new_for_commandline_arg (uri);
 	path = g_file_get_path (file);
@@ -450,71 +503,75 @@ brasero_project_open_project_xml (const gchar *uri,
 		return FALSE;
 
 	/* start parsing xml doc */
-	project = xmlParseFile (path);
-    	g_free (path);
-
-	if (!project) {
-	    	if (warn_user)
-			brasero_project_invalid_project_dialog (_("The project could not be opened"));
+	reader = xmlReaderForFile (path, NULL, 0);
+	if (!reader) {
+		g_free (path);
+		brasero_project_invalid_project_error (error, _("The project could not be opened"));
 
 		return FALSE;
 	}
 
 	/* parses the "header" */
-	item = xmlDocGetRootElement (project);
-	if (!item) {
-	    	if (warn_user)
-			brasero_project_invalid_project_dialog (_("The file is empty"));
+	result = _read_next_element (reader, -1);
+	if (result <= 0) {
+		g_free (path);
+		xmlFreeTextReader (reader);
+
+		if (!result)
+			brasero_project_invalid_project_error (error, _("The file is empty"));
+		else
+			brasero_project_invalid_project_error (error, _("The project could not be opened"));
 
-		xmlFreeDoc (project);
 		return FALSE;
 	}
 
-	if (xmlStrcmp (item->name, (const xmlChar *) "braseroproject")
-	||  item->next)
+	if (!_read_element_is (reader, "braseroproject")
+	||   xmlTextReaderIsEmptyElement (reader))
 		goto error;
 
-	item = item->children;
-	while (item) {
-		if (!xmlStrcmp (item->name, (const xmlChar *) "version")) {
+	while ((result = _read_next_element (reader, 0)) == 1) {
+		if (_read_element_is (reader, "version")) {
 			/* simply ignore it */
 		}
-		else if (!xmlStrcmp (item->name, (const xmlChar *) "label")) {
-			label = (gchar *) xmlNodeListGetString (project,
-								item->xmlChildrenNode,
-								1);
+		else if (_read_element_is (reader, "label")) {
+			if (label)
+				goto error;
+
+			label = (gchar *) xmlTextReaderReadString (reader);
 			if (!(label))
 				goto error;
 		}
-		else if (!xmlStrcmp (item->name, (const xmlChar *) "cover")) {
+		else if (_read_element_is (reader, "cover")) {
 			xmlChar *escaped;
 
-			escaped = xmlNodeListGetString (project,
-							item->xmlChildrenNode,
-							1);
+			if (cover)
+				goto error;
+
+			escaped = xmlTextReaderReadString (reader);
 			if (!escaped)
 				goto error;
 
 			cover = g_uri_unescape_string ((char *) escaped, NULL);
 			g_free (escaped);
 		}
-		else if (!xmlStrcmp (item->name, (const xmlChar *) "track")) {
-			if (track_node)
+		else if (_read_element_is (reader, "track")) {
+			if (has_tracks)
 				goto error;
 
-			track_node = item;
+			has_tracks = TRUE;
+			retval = _get_tracks (reader, path, session);
+			if (!retval)
+				goto error;
 		}
-		else if (item->type == XML_ELEMENT_NODE)
+		else
 			goto error;
-
-		item = item->next;
 	}
 
-	retval = _get_tracks (project, track_node, session);
-	if (!retval)
+	if (result < 0 || !has_tracks)
 		goto error;
 
-	xmlFreeDoc (project);
+	xmlFreeTextReader (reader);
+	g_free (path);
 
         brasero_burn_session_set_label (session, label);
         g_free (label);
@@ -532,7 +589,7 @@ brasero_project_open_project_xml (const gchar *uri,
                 g_free (cover);
         }
 
-        return retval;
+        return TRUE;
 
 error:
 
@@ -541,9 +598,9 @@ error:
 	if (label)
 		g_free (label);
 
-	xmlFreeDoc (project);
-    	if (warn_user)
-		brasero_project_invalid_project_dialog (_("It does not seem to be a valid Brasero project"));
+	g_free (path);
+	xmlFreeTextReader (reader);
+	brasero_project_invalid_project_error (error, _("It does not seem to be a valid Brasero project"));
 
 	return FALSE;
 }
@@ -578,7 +635,7 @@ brasero_project_playlist_entry_parsed (TotemPlParser *parser,
 gboolean
 brasero_project_open_audio_playlist_project (const gchar *uri,
 					     BraseroBurnSession *session,
-					     gboolean warn_user)
+					     GError **error)
 {
 	TotemPlParser *parser;
 	TotemPlParserResult result;
@@ -606,10 +663,8 @@ brasero_project_open_audio_playlist_project (const gchar *uri,
 			  session);
 
 	result = totem_pl_parser_parse (parser, _uri, FALSE);
-	if (result != TOTEM_PL_PARSER_RESULT_SUCCESS) {
-		if (warn_user)
-			brasero_project_invalid_project_dialog (_("It does not seem to be a valid Brasero project"));
-	}
+	if (result != TOTEM_PL_PARSER_RESULT_SUCCESS)
+		brasero_project_invalid_project_error (error, _("It does not seem to be a valid Brasero project"));
 
 	g_free (_uri);
 	g_object_unref (parser);
@@ -726,6 +781,54 @@ _save_audio_track_xml (xmlTextWriter *project,
 	return TRUE;
 }
 
+static gboolean
+_save_data_graft_xml (const gchar *path,
+		      const gchar *uri,
+		      gpointer user_data)
+{
+	xmlTextWriter *project = user_data;
+	gint success;
+
+	success = xmlTextWriterStartElement (project, (xmlChar *) "graft");
+	if (success < 0)
+		return FALSE;
+
+	success = xmlTextWriterWriteElement (project, (xmlChar *) "path", (xmlChar *) path);
+	if (success < 0)
+		return FALSE;
+
+	if (uri) {
+		xmlChar *escaped;
+
+		escaped = (unsigned char *) g_uri_escape_string (uri, NULL, FALSE);
+		success = xmlTextWriterWriteElement (project, (xmlChar *) "uri", escaped);
+		g_free (escaped);
+		if (success < 0)
+			return FALSE;
+	}
+
+	success = xmlTextWriterEndElement (project); /* graft */
+	if (success < 0)
+		return FALSE;
+
+	return TRUE;
+}
+
+static gboolean
+_save_data_excluded_xml (const gchar *uri,
+			 gpointer user_data)
+{
+	xmlTextWriter *project = user_data;
+	xmlChar *escaped;
+	gint success;
+
+	escaped = xmlURIEscapeStr ((xmlChar *) uri, NULL);
+	success = xmlTextWriterWriteElement (project, (xmlChar *) "excluded", (xmlChar *) escaped);
+	g_free (escaped);
+
+	return (success >= 0);
+}
+
 static gboolean
 _save_data_track_xml (xmlTextWriter *project,
 		      BraseroBurnSession *session)
@@ -734,7 +837,6 @@ _save_data_track_xml (xmlTextWriter *project,
 	gint success;
 	GSList *iter;
 	GSList *tracks;
-	GSList *grafts;
 	gchar *filename;
 	BraseroTrackDataCfg *track;
 
@@ -750,46 +852,12 @@ _save_data_track_xml (xmlTextWriter *project,
 			return FALSE;
 	}
 
-	grafts = brasero_track_data_get_grafts (BRASERO_TRACK_DATA (track));
-	for (; grafts; grafts = grafts->next) {
-		BraseroGraftPt *graft;
-
-		graft = grafts->data;
-
-		success = xmlTextWriterStartElement (project, (xmlChar *) "graft");
-		if (success < 0)
-			return FALSE;
-
-		success = xmlTextWriterWriteElement (project, (xmlChar *) "path", (xmlChar *) graft->path);
-		if (success < 0)
-			return FALSE;
-
-		if (graft->uri) {
-			xmlChar *escaped;
-
-			escaped = (unsigned char *) g_uri_escape_string (graft->uri, NULL, FALSE);
-			success = xmlTextWriterWriteElement (project, (xmlChar *) "uri", escaped);
-			g_free (escaped);
-			if (success < 0)
-				return FALSE;
-		}
-
-		success = xmlTextWriterEndElement (project); /* graft */
-		if (success < 0)
-			return FALSE;
-	}
-
-	/* save excluded uris */
-	iter = brasero_track_data_get_excluded_list (BRASERO_TRACK_DATA (track));
-	for (; iter; iter = iter->next) {
-		xmlChar *escaped;
-
-		escaped = xmlURIEscapeStr ((xmlChar *) iter->data, NULL);
-		success = xmlTextWriterWriteElement (project, (xmlChar *) "excluded", (xmlChar *) escaped);
-		g_free (escaped);
-		if (success < 0)
-			return FALSE;
-	}
+	/* The tree is walked directly; no list of grafts is built */
+	if (!brasero_track_data_cfg_foreach_graft (track,
+						   _save_data_graft_xml,
+						   _save_data_excluded_xml,
+						   project))
+		return FALSE;
 
 	/* save restored uris */
 	iter = brasero_track_data_cfg_get_restored_list (track);
@@ -804,6 +872,35 @@ _save_data_track_xml (xmlTextWriter *project,
 	return TRUE;
 }
 
+static void
+_save_data_track_snapshot (BraseroBurnSession *session,
+			   const gchar *project_path)
+{
+	gchar *snapshot;
+	GSList *tracks;
+
+	snapshot = g_strconcat (project_path, BRASERO_PROJECT_SNAPSHOT_SUFFIX, NULL);
+
+	tracks = brasero_burn_session_get_tracks (session);
+	for (; tracks; tracks = tracks->next) {
+		if (!BRASERO_IS_TRACK_DATA_CFG (tracks->data))
+			continue;
+
+		if (brasero_track_data_cfg_save_snapshot (tracks->data, snapshot, project_path, NULL))
+			goto end;
+
+		break;
+	}
+
+	/* Don't leave a snapshot of a previous version around; it would be
+	 * ignored anyway but it's useless */
+	g_remove (snapshot);
+
+end:
+
+	g_free (snapshot);
+}
+
 gboolean 
 brasero_project_save_project_xml (BraseroBurnSession *session,
 				  const gchar *uri)
@@ -932,6 +1029,10 @@ brasero_project_save_project_xml (BraseroBurnSession *session,
 
 	xmlTextWriterEndDocument (project);
 	xmlFreeTextWriter (project);
+
+	/* Must be done once the project file is written */
+	_save_data_track_snapshot (session, path);
+
 	g_free (path);
 	return TRUE;
 
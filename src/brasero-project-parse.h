@@ -55,12 +55,12 @@ typedef enum {
 gboolean
 brasero_project_open_project_xml (const gchar *uri,
 				  BraseroBurnSession *session,
-				  gboolean warn_user);
+				  GError **error);
 
 gboolean
 brasero_project_open_audio_playlist_project (const gchar *uri,
 					     BraseroBurnSession *session,
-					     gboolean warn_user);
+					     GError **error);
 
 gboolean 
 brasero_project_save_project_xml (BraseroBurnSession *session,
@@ -0,0 +1,828 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Brasero
+ * Copyright (C) Philippe Rouquier 2005-2010 <bonfire-app@wanadoo.fr>
+ *
+ *  Brasero is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ * brasero is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with brasero.  If not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+
+/**
+ * Measures the throughput, CPU time and peak memory of the standard session
+ * shapes recorded to the fake drive (image files) from generated trees and
+ * audio. Run with "make bench".
+ *
+ * Each shape runs in its own process (bench-burn --run SHAPE DIRECTORY) so
+ * that its peak RSS is its own; on Linux that peak is also reset whenever a
+ * new task starts. That process logs the statistics of each
+ * task (see burn-task.c) which are collected here with the end-to-end ones
+ * and compared to a baseline stored in a key file. "make bench-baseline"
+ * (or --update) stores the current numbers as the new baseline. A shape is
+ * a regression when its throughput is below the baseline by more than
+ * BRASERO_BENCH_TOLERANCE percent (20 by default). BRASERO_BENCH_SCALE
+ * multiplies the size of the generated sources (1 by default).
+ *
+ * The scan shapes count the files of a generated tree, once with the native
+ * scanner of libbrasero-utils and once with GIO, and report files per second.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <math.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+
+#include "brasero-burn-lib.h"
+#include "brasero-track-data.h"
+#include "brasero-track-stream.h"
+#include "brasero-track-image.h"
+#include "brasero-medium-monitor.h"
+#include "burn-debug.h"
+#include "brasero-dir-scan.h"
+
+#include "brasero-test-utils.h"
+
+#define BENCH_EXIT_SKIPPED		77
+
+#define BENCH_TASK_STATISTICS		"Task statistics ["
+#define BENCH_TOTAL			"Bench total: "
+#define BENCH_SCAN			"Bench scan: "
+
+typedef BraseroBurnSession *(*BenchShapeFunc) (const gchar *directory,
+					       GSList **drives);
+
+/* Returns the number of files found below tree */
+typedef guint (*BenchScanFunc) (const gchar *tree);
+
+typedef struct _BenchShape BenchShape;
+struct _BenchShape {
+	const gchar *name;
+	BenchShapeFunc func;
+	BenchScanFunc scan;
+};
+
+static gint
+bench_get_scale (void)
+{
+	const gchar *scale;
+
+	scale = g_getenv ("BRASERO_BENCH_SCALE");
+	if (!scale)
+		return 1;
+
+	return MAX (1, atoi (scale));
+}
+
+static void
+bench_write_data (const gchar *path,
+		  gsize size)
+{
+	GError *error = NULL;
+	gchar *contents;
+	gsize i;
+
+	/* Not only zeros so that nothing can take a shortcut */
+	contents = g_malloc (size);
+	for (i = 0; i < size; i ++)
+		contents [i] = (i * 7 + size) % 253;
+
+	g_file_set_contents (path, contents, size, &error);
+	g_assert_no_error (error);
+	g_free (contents);
+}
+
+static gchar *
+bench_write_tree (const gchar *directory,
+		  guint files,
+		  gsize size)
+{
+	gchar *tree;
+	guint i;
+
+	tree = g_build_filename (directory, "tree", NULL);
+	for (i = 0; i < files; i ++) {
+		gchar *parent;
+		gchar *path;
+		gchar *name;
+
+		/* 100 files per directory */
+		name = g_strdup_printf ("dir%03i", i / 100);
+		parent = g_build_filename (tree, name, NULL);
+		g_assert_cmpint (g_mkdir_with_parents (parent, 0700), ==, 0);
+		g_free (name);
+
+		name = g_strdup_printf ("file%05i", i);
+		path = g_build_filename (parent, name, NULL);
+		bench_write_data (path, size);
+		g_free (parent);
+		g_free (path);
+		g_free (name);
+	}
+
+	return tree;
+}
+
+static void
+bench_write_wav (const gchar *path,
+		 guint seconds)
+{
+	GError *error = NULL;
+	guint32 data_size;
+	gchar *contents;
+	gint16 *samples;
+	guint32 value;
+	guint16 value16;
+	guint i;
+
+	/* 16 bits stereo 44.1 kHz PCM with a 440 Hz tone */
+	data_size = seconds * 44100 * 4;
+	contents = g_malloc (44 + data_size);
+
+	memcpy (contents, "RIFF", 4);
+	value = GUINT32_TO_LE (36 + data_size);
+	memcpy (contents + 4, &value, 4);
+	memcpy (contents + 8, "WAVEfmt ", 8);
+	value = GUINT32_TO_LE (16);
+	memcpy (contents + 16, &value, 4);
+	value16 = GUINT16_TO_LE (1);
+	memcpy (contents + 20, &value16, 2);
+	value16 = GUINT16_TO_LE (2);
+	memcpy (contents + 22, &value16, 2);
+	value = GUINT32_TO_LE (44100);
+	memcpy (contents + 24, &value, 4);
+	value = GUINT32_TO_LE (44100 * 4);
+	memcpy (contents + 28, &value, 4);
+	value16 = GUINT16_TO_LE (4);
+	memcpy (contents + 32, &value16, 2);
+	value16 = GUINT16_TO_LE (16);
+	memcpy (contents + 34, &value16, 2);
+	memcpy (contents + 36, "data", 4);
+	value = GUINT32_TO_LE (data_size);
+	memcpy (contents + 40, &value, 4);
+
+	samples = (gint16 *) (contents + 44);
+	for (i = 0; i < seconds * 44100; i ++) {
+		gint16 sample;
+
+		sample = GINT16_TO_LE ((gint16) (8000.0 * sin (2.0 * G_PI * 440.0 * i / 44100.0)));
+		samples [i * 2] = sample;
+		samples [i * 2 + 1] = sample;
+	}
+
+	g_file_set_contents (path, contents, 44 + data_size, &error);
+	g_assert_no_error (error);
+	g_free (contents);
+}
+
+static BraseroBurnSession *
+bench_data_session_new (const gchar *directory,
+			const gchar *tree)
+{
+	BraseroBurnSession *session;
+	BraseroTrackData *track;
+	BraseroGraftPt *graft;
+	gchar *output;
+
+	graft = g_new0 (BraseroGraftPt, 1);
+	graft->uri = g_filename_to_uri (tree, NULL, NULL);
+	graft->path = g_strdup ("/tree");
+
+	track = brasero_track_data_new ();
+	brasero_track_data_add_fs (track, BRASERO_IMAGE_FS_ISO|BRASERO_IMAGE_FS_JOLIET);
+	brasero_track_data_set_source (track, g_slist_prepend (NULL, graft), NULL);
+
+	session = brasero_burn_session_new ();
+	brasero_burn_session_add_track (session, BRASERO_TRACK (track), NULL);
+	g_object_unref (track);
+
+	output = g_build_filename (directory, "output.iso", NULL);
+	brasero_burn_session_set_image_output_full (session,
+						    BRASERO_IMAGE_FORMAT_BIN,
+						    output,
+						    NULL);
+	g_free (output);
+
+	return session;
+}
+
+static BraseroBurnSession *
+bench_shape_small_files (const gchar *directory,
+			 GSList **drives)
+{
+	BraseroBurnSession *session;
+	gchar *tree;
+
+	tree = bench_write_tree (directory, 2000 * bench_get_scale (), 4096);
+	session = bench_data_session_new (directory, tree);
+	g_free (tree);
+
+	return session;
+}
+
+static BraseroBurnSession *
+bench_shape_large_files (const gchar *directory,
+			 GSList **drives)
+{
+	BraseroBurnSession *session;
+	gchar *tree;
+
+	tree = bench_write_tree (directory, 4 * bench_get_scale (), (gsize) 64 * 1024 * 1024);
+	session = bench_data_session_new (directory, tree);
+	g_free (tree);
+
+	return session;
+}
+
+static BraseroBurnSession *
+bench_shape_audio (const gchar *directory,
+		   GSList **drives)
+{
+	BraseroBurnSession *session;
+	gchar *output;
+	gchar *toc;
+	guint i;
+
+	session = brasero_burn_session_new ();
+	for (i = 0; i < 3 * bench_get_scale (); i ++) {
+		BraseroTrackStream *track;
+		gchar *name;
+		gchar *path;
+		gchar *uri;
+
+		name = g_strdup_printf ("track%02i.wav", i);
+		path = g_build_filename (directory, name, NULL);
+		bench_write_wav (path, 30);
+		g_free (name);
+
+		uri = g_filename_to_uri (path, NULL, NULL);
+		g_free (path);
+
+		track = brasero_track_stream_new ();
+		brasero_track_stream_set_source (track, uri);
+		brasero_track_stream_set_format (track, BRASERO_AUDIO_FORMAT_UNDEFINED);
+		brasero_burn_session_add_track (session, BRASERO_TRACK (track), NULL);
+		g_object_unref (track);
+		g_free (uri);
+	}
+
+	output = g_build_filename (directory, "output.bin", NULL);
+	toc = g_build_filename (directory, "output.cue", NULL);
+	brasero_burn_session_set_image_output_full (session,
+						    BRASERO_IMAGE_FORMAT_CUE,
+						    output,
+						    toc);
+	g_free (output);
+	g_free (toc);
+
+	return session;
+}
+
+static BraseroBurnSession *
+bench_shape_image_copies (const gchar *directory,
+			  GSList **drives)
+{
+	BraseroMediumMonitor *monitor;
+	BraseroBurnSession *session;
+	BraseroTrackImage *track;
+	gchar *output;
+	gchar *image;
+	guint i;
+
+	image = g_build_filename (directory, "source.bin", NULL);
+	bench_write_data (image, (gsize) 256 * 1024 * 1024 * bench_get_scale ());
+
+	track = brasero_track_image_new ();
+	brasero_track_image_set_source (track, image, NULL, BRASERO_IMAGE_FORMAT_BIN);
+	g_free (image);
+
+	session = brasero_burn_session_new ();
+	brasero_burn_session_add_track (session, BRASERO_TRACK (track), NULL);
+	g_object_unref (track);
+
+	output = g_build_filename (directory, "output.bin", NULL);
+	brasero_burn_session_set_image_output_full (session,
+						    BRASERO_IMAGE_FORMAT_BIN,
+						    output,
+						    NULL);
+	g_free (output);
+
+	/* The same image recorded three times at once */
+	monitor = brasero_medium_monitor_get_default ();
+	*drives = brasero_medium_monitor_get_drives (monitor, BRASERO_DRIVE_TYPE_FAKE);
+	g_object_unref (monitor);
+
+	g_assert (*drives != NULL);
+	for (i = 1; i < 3; i ++)
+		*drives = g_slist_prepend (*drives, g_object_ref ((*drives)->data));
+
+	return session;
+}
+
+static guint
+bench_scan_native (const gchar *tree)
+{
+	BraseroDirCount count = { 0, };
+
+	brasero_dir_scan_count (tree, BRASERO_DIR_SCAN_NONE, NULL, &count);
+	return count.files_num;
+}
+
+/* What BraseroIO does for trees that are not scanned natively */
+static guint
+bench_scan_gio_directory (GFile *directory)
+{
+	GFileEnumerator *enumerator;
+	GFileInfo *info;
+	guint files = 0;
+
+	enumerator = g_file_enumerate_children (directory,
+						G_FILE_ATTRIBUTE_STANDARD_NAME ","
+						G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+						G_FILE_ATTRIBUTE_STANDARD_SIZE,
+						G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+						NULL,
+						NULL);
+	if (!enumerator)
+		return 0;
+
+	while ((info = g_file_enumerator_next_file (enumerator, NULL, NULL))) {
+		files ++;
+
+		if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY) {
+			GFile *child;
+
+			child = g_file_get_child (directory, g_file_info_get_name (info));
+			files += bench_scan_gio_directory (child);
+			g_object_unref (child);
+		}
+
+		g_object_unref (info);
+	}
+
+	g_file_enumerator_close (enumerator, NULL, NULL);
+	g_object_unref (enumerator);
+
+	return files;
+}
+
+static guint
+bench_scan_gio (const gchar *tree)
+{
+	GFile *file;
+	guint files;
+
+	file = g_file_new_for_path (tree);
+	files = bench_scan_gio_directory (file);
+	g_object_unref (file);
+
+	return files;
+}
+
+static const BenchShape shapes [] = {
+	{ "data-small-files", bench_shape_small_files, NULL },
+	{ "data-large-files", bench_shape_large_files, NULL },
+	{ "audio", bench_shape_audio, NULL },
+	{ "image-copies", bench_shape_image_copies, NULL },
+	{ "scan-native", NULL, bench_scan_native },
+	{ "scan-gio", NULL, bench_scan_gio },
+};
+
+static gdouble
+bench_timeval_to_seconds (struct timeval *tv)
+{
+	return (gdouble) tv->tv_sec + (gdouble) tv->tv_usec / 1000000.0;
+}
+
+static int
+bench_run_scan (const BenchShape *shape,
+		const gchar *directory)
+{
+	struct rusage before;
+	struct rusage after;
+	GTimer *timer;
+	guint files;
+	gchar *tree;
+
+	tree = bench_write_tree (directory, 20000 * bench_get_scale (), 0);
+
+	/* Once so that both scanners find the tree in the cache */
+	shape->scan (tree);
+
+	getrusage (RUSAGE_SELF, &before);
+	timer = g_timer_new ();
+	files = shape->scan (tree);
+	g_timer_stop (timer);
+	getrusage (RUSAGE_SELF, &after);
+
+	printf (BENCH_SCAN "%u files in %.2f s, CPU user %.2f s system %.2f s, peak RSS %li KiB\n",
+		files,
+		g_timer_elapsed (timer, NULL),
+		bench_timeval_to_seconds (&after.ru_utime) - bench_timeval_to_seconds (&before.ru_utime),
+		bench_timeval_to_seconds (&after.ru_stime) - bench_timeval_to_seconds (&before.ru_stime),
+		after.ru_maxrss);
+
+	g_timer_destroy (timer);
+	g_free (tree);
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Resets the peak RSS of the process so that the one logged at the end of a
+ * task is the peak of that task. "5" resets VmHWM (Linux 4.0 and later).
+ * NOTE: not with g_file_set_contents () which writes a temporary file.
+ */
+
+static void
+bench_reset_peak_rss (void)
+{
+	int fd;
+
+	fd = open ("/proc/self/clear_refs", O_WRONLY);
+	if (fd < 0)
+		return;
+
+	if (write (fd, "5", 1) != 1)
+		g_warning ("The peak RSS could not be reset");
+
+	close (fd);
+}
+
+static void
+bench_action_changed_cb (BraseroBurn *burn,
+			 BraseroBurnAction action,
+			 gpointer user_data)
+{
+	/* Each task reports its own action when it starts */
+	bench_reset_peak_rss ();
+}
+
+static int
+bench_run_shape (const BenchShape *shape,
+		 const gchar *directory)
+{
+	struct rusage children_usage;
+	struct rusage self_usage;
+	BraseroBurnSession *session;
+	BraseroBurnResult result;
+	GSList *drives = NULL;
+	GError *error = NULL;
+	goffset bytes = 0;
+	BraseroBurn *burn;
+	struct stat info;
+	gchar *output;
+	GTimer *timer;
+
+	if (shape->scan)
+		return bench_run_scan (shape, directory);
+
+	session = shape->func (directory, &drives);
+	if (brasero_burn_session_can_burn (session, FALSE) != BRASERO_BURN_OK) {
+		printf ("%s cannot be recorded with the plugins available\n", shape->name);
+		g_object_unref (session);
+		return BENCH_EXIT_SKIPPED;
+	}
+
+	/* The per task statistics are in the debug output */
+	brasero_burn_library_set_debug (TRUE);
+
+	burn = brasero_burn_new ();
+	g_signal_connect (burn,
+			  "action-changed",
+			  G_CALLBACK (bench_action_changed_cb),
+			  NULL);
+
+	bench_reset_peak_rss ();
+	timer = g_timer_new ();
+	if (drives)
+		result = brasero_burn_record_multi (burn, session, drives, &error);
+	else
+		result = brasero_burn_record (burn, session, &error);
+
+	if (result != BRASERO_BURN_OK) {
+		printf ("%s failed: %s\n", shape->name, error ? error->message:"unknown error");
+		return EXIT_FAILURE;
+	}
+
+	/* Each drive recorded a copy of the output */
+	brasero_burn_session_get_output (session, &output, NULL);
+	if (!g_stat (output, &info))
+		bytes = info.st_size * MAX (1, g_slist_length (drives));
+	g_free (output);
+
+	getrusage (RUSAGE_SELF, &self_usage);
+	getrusage (RUSAGE_CHILDREN, &children_usage);
+
+	/* The process only ran that shape so these are its own */
+	printf (BENCH_TOTAL "%" G_GOFFSET_FORMAT " bytes in %.2f s, CPU user %.2f s system %.2f s, peak RSS %li KiB, backends peak RSS %li KiB\n",
+		bytes,
+		g_timer_elapsed (timer, NULL),
+		bench_timeval_to_seconds (&self_usage.ru_utime) + bench_timeval_to_seconds (&children_usage.ru_utime),
+		bench_timeval_to_seconds (&self_usage.ru_stime) + bench_timeval_to_seconds (&children_usage.ru_stime),
+		self_usage.ru_maxrss,
+		children_usage.ru_maxrss);
+
+	g_timer_destroy (timer);
+	g_object_unref (burn);
+	g_object_unref (session);
+	g_slist_foreach (drives, (GFunc) g_object_unref, NULL);
+	g_slist_free (drives);
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * What the process of a shape printed
+ */
+
+static gboolean
+bench_parse_line (const gchar *line,
+		  const gchar *prefix,
+		  gdouble unit,
+		  gchar **stage,
+		  gdouble *rate,
+		  gdouble *cpu,
+		  glong *peak)
+{
+	goffset bytes = 0;
+	gdouble elapsed = 0.0;
+	gdouble user = 0.0;
+	gdouble sys = 0.0;
+	const gchar *start;
+	gchar *end;
+
+	start = strstr (line, prefix);
+	if (!start)
+		return FALSE;
+
+	start += strlen (prefix);
+	if (stage) {
+		end = strstr (start, "] result ");
+		if (!end)
+			return FALSE;
+
+		*stage = g_strndup (start, end - start);
+		start = strchr (end, ':');
+		if (!start) {
+			g_free (*stage);
+			return FALSE;
+		}
+		start ++;
+	}
+
+	bytes = g_ascii_strtoll (start, &end, 10);
+	start = strstr (end, " in ");
+	if (start)
+		elapsed = g_ascii_strtod (start + strlen (" in "), NULL);
+
+	start = strstr (end, "CPU user ");
+	if (start)
+		user = g_ascii_strtod (start + strlen ("CPU user "), NULL);
+
+	start = strstr (end, "system ");
+	if (start)
+		sys = g_ascii_strtod (start + strlen ("system "), NULL);
+
+	start = strstr (end, "peak RSS ");
+	*peak = start ? strtol (start + strlen ("peak RSS "), NULL, 10):-1;
+
+	*rate = elapsed > 0.0 ? (gdouble) bytes / unit / elapsed:0.0;
+	*cpu = user + sys;
+	return TRUE;
+}
+
+static gboolean
+bench_compare (GKeyFile *baseline,
+	       GKeyFile *results,
+	       const gchar *group,
+	       const gchar *key,
+	       const gchar *unit,
+	       gdouble rate,
+	       gdouble cpu,
+	       glong peak)
+{
+	gboolean regression = FALSE;
+	const gchar *tolerance;
+	gdouble previous;
+	gdouble limit;
+	gchar *name;
+
+	tolerance = g_getenv ("BRASERO_BENCH_TOLERANCE");
+	limit = 1.0 - (tolerance ? g_ascii_strtod (tolerance, NULL):20.0) / 100.0;
+
+	name = g_strdup_printf ("%s-rate", key);
+	g_key_file_set_double (results, group, name, rate);
+	if (baseline && g_key_file_has_key (baseline, group, name, NULL)) {
+		previous = g_key_file_get_double (baseline, group, name, NULL);
+		regression = (rate < previous * limit);
+		printf ("  %-24s %9.2f %s (baseline %9.2f)%s\n",
+			key,
+			rate,
+			unit,
+			previous,
+			regression ? "  REGRESSION":"");
+	}
+	else
+		printf ("  %-24s %9.2f %s\n", key, rate, unit);
+	g_free (name);
+
+	printf ("  %-24s %9.2f s CPU, peak RSS %li KiB\n", "", cpu, peak);
+
+	name = g_strdup_printf ("%s-cpu", key);
+	g_key_file_set_double (results, group, name, cpu);
+	g_free (name);
+
+	name = g_strdup_printf ("%s-peak-rss", key);
+	g_key_file_set_int64 (results, group, name, peak);
+	g_free (name);
+
+	return regression;
+}
+
+static int
+bench_spawn_shape (const gchar *program,
+		   const BenchShape *shape,
+		   GKeyFile *baseline,
+		   GKeyFile *results,
+		   gboolean *regression)
+{
+	gchar *argv [] = { (gchar *) program, "--run", (gchar *) shape->name, NULL, NULL };
+	gchar *standard_output = NULL;
+	GError *error = NULL;
+	gchar *directory;
+	gchar **lines;
+	gint status;
+	guint stage;
+	guint i;
+
+	directory = brasero_test_mkdtemp ();
+	argv [3] = directory;
+
+	g_spawn_sync (NULL,
+		      argv,
+		      NULL,
+		      0,
+		      NULL,
+		      NULL,
+		      &standard_output,
+		      NULL,
+		      &status,
+		      &error);
+	g_assert_no_error (error);
+
+	brasero_test_rm_rf (directory);
+	g_free (directory);
+
+	printf ("%s:\n", shape->name);
+	if (WIFEXITED (status) && WEXITSTATUS (status) == BENCH_EXIT_SKIPPED) {
+		printf ("  skipped: %s", standard_output);
+		g_free (standard_output);
+		return EXIT_SUCCESS;
+	}
+
+	if (!WIFEXITED (status) || WEXITSTATUS (status) != EXIT_SUCCESS) {
+		printf ("%s", standard_output);
+		g_free (standard_output);
+		return EXIT_FAILURE;
+	}
+
+	stage = 0;
+	lines = g_strsplit (standard_output, "\n", -1);
+	g_free (standard_output);
+
+	for (i = 0; lines [i]; i ++) {
+		gdouble rate, cpu;
+		gchar *name;
+		glong peak;
+
+		if (bench_parse_line (lines [i], BENCH_TASK_STATISTICS, 1048576.0, &name, &rate, &cpu, &peak)) {
+			gchar *key;
+
+			/* Stages are numbered as the same one can run twice */
+			key = g_strdup_printf ("%i %s", ++ stage, name);
+			*regression |= bench_compare (baseline, results, shape->name, key, "MiB/s", rate, cpu, peak);
+			g_free (key);
+			g_free (name);
+		}
+		else if (bench_parse_line (lines [i], BENCH_TOTAL, 1048576.0, NULL, &rate, &cpu, &peak))
+			*regression |= bench_compare (baseline, results, shape->name, "total", "MiB/s", rate, cpu, peak);
+		else if (bench_parse_line (lines [i], BENCH_SCAN, 1000.0, NULL, &rate, &cpu, &peak))
+			*regression |= bench_compare (baseline, results, shape->name, "files", "kfiles/s", rate, cpu, peak);
+	}
+	g_strfreev (lines);
+
+	return EXIT_SUCCESS;
+}
+
+int
+main (int argc, char **argv)
+{
+	gboolean regression = FALSE;
+	gchar *baseline_path = NULL;
+	gboolean update = FALSE;
+	GKeyFile *baseline;
+	GKeyFile *results;
+	GError *error = NULL;
+	int retval = EXIT_SUCCESS;
+	guint i;
+
+	GOptionEntry entries [] = {
+		{ "baseline", 'b', 0, G_OPTION_ARG_FILENAME, &baseline_path,
+		  "Key file with the numbers to compare to", "FILE" },
+		{ "update", 'u', 0, G_OPTION_ARG_NONE, &update,
+		  "Store the numbers as the new baseline", NULL },
+		{ NULL }
+	};
+	GOptionContext *context;
+
+	brasero_test_init (&argc, &argv, NULL, NULL);
+
+	/* Run one shape in this process */
+	if (argc == 4 && !strcmp (argv [1], "--run")) {
+		for (i = 0; i < G_N_ELEMENTS (shapes); i ++) {
+			if (!strcmp (shapes [i].name, argv [2])) {
+				retval = bench_run_shape (shapes + i, argv [3]);
+				break;
+			}
+		}
+
+		brasero_test_stop ();
+		return retval;
+	}
+
+	context = g_option_context_new (NULL);
+	g_option_context_add_main_entries (context, entries, NULL);
+	if (!g_option_context_parse (context, &argc, &argv, &error)) {
+		printf ("%s\n", error->message);
+		g_error_free (error);
+		return EXIT_FAILURE;
+	}
+	g_option_context_free (context);
+
+	if (!baseline_path)
+		baseline_path = g_strdup ("bench-baseline.ini");
+
+	baseline = g_key_file_new ();
+	if (update || !g_key_file_load_from_file (baseline, baseline_path, G_KEY_FILE_NONE, NULL)) {
+		if (!update)
+			printf ("No baseline in %s; run \"make bench-baseline\" to store one\n", baseline_path);
+
+		g_key_file_free (baseline);
+		baseline = NULL;
+	}
+
+	results = g_key_file_new ();
+	for (i = 0; i < G_N_ELEMENTS (shapes) && retval == EXIT_SUCCESS; i ++)
+		retval = bench_spawn_shape (argv [0], shapes + i, baseline, results, &regression);
+
+	if (retval == EXIT_SUCCESS && update) {
+		gchar *contents;
+
+		contents = g_key_file_to_data (results, NULL, NULL);
+		g_file_set_contents (baseline_path, contents, -1, &error);
+		g_assert_no_error (error);
+		g_free (contents);
+
+		printf ("Baseline stored in %s\n", baseline_path);
+	}
+
+	if (baseline)
+		g_key_file_free (baseline);
+
+	g_key_file_free (results);
+	g_free (baseline_path);
+	brasero_test_stop ();
+
+	if (retval == EXIT_SUCCESS && regression)
+		retval = EXIT_FAILURE;
+
+	return retval;
+}
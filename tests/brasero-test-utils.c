@@ -0,0 +1,270 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Brasero
+ * Copyright (C) Philippe Rouquier 2005-2010 <bonfire-app@wanadoo.fr>
+ * 
+ *  Brasero is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ * 
+ * brasero is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with brasero.  If not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+
+#include "brasero-burn-lib.h"
+#include "brasero-media.h"
+#include "burn-plugin-manager.h"
+#include "burn-iso9660.h"
+#include "burn-volume-source.h"
+#include "burn-volume.h"
+
+#include "brasero-test-utils.h"
+
+#define BRASERO_SCHEMA_CONFIG			"org.gnome.brasero.config"
+#define BRASERO_PROPS_PLUGINS_KEY		"plugins"
+
+gboolean
+brasero_test_init (int *argc,
+		   char ***argv,
+		   const gchar *first_plugin,
+		   ...)
+{
+	GSettings *settings;
+	GPtrArray *names;
+	const gchar *name;
+	va_list args;
+
+	g_type_init ();
+	g_test_init (argc, argv, NULL);
+
+	/* Restrict the plugins so that we know which one does the job */
+	names = g_ptr_array_new ();
+	va_start (args, first_plugin);
+	for (name = first_plugin; name; name = va_arg (args, const gchar *))
+		g_ptr_array_add (names, (gchar *) name);
+	va_end (args);
+	g_ptr_array_add (names, NULL);
+
+	settings = g_settings_new (BRASERO_SCHEMA_CONFIG);
+	g_settings_set_strv (settings,
+			     BRASERO_PROPS_PLUGINS_KEY,
+			     (const gchar * const *) names->pdata);
+	g_object_unref (settings);
+	g_ptr_array_free (names, TRUE);
+
+	return brasero_burn_library_start (argc, argv);
+}
+
+void
+brasero_test_stop (void)
+{
+	brasero_burn_library_stop ();
+}
+
+gboolean
+brasero_test_has_plugin (const gchar *name)
+{
+	BraseroPluginManager *manager;
+	gboolean found = FALSE;
+	GSList *plugins;
+	GSList *iter;
+
+	manager = brasero_plugin_manager_get_default ();
+	plugins = brasero_plugin_manager_get_plugins_list (manager);
+	for (iter = plugins; iter; iter = iter->next) {
+		BraseroPlugin *plugin;
+
+		plugin = iter->data;
+		if (!g_strcmp0 (brasero_plugin_get_name (plugin), name)
+		&&   brasero_plugin_get_active (plugin, FALSE)) {
+			found = TRUE;
+			break;
+		}
+	}
+	g_slist_foreach (plugins, (GFunc) g_object_unref, NULL);
+	g_slist_free (plugins);
+
+	if (!found)
+		g_test_message ("plugin %s is not available", name);
+
+	return found;
+}
+
+gchar *
+brasero_test_mkdtemp (void)
+{
+	gchar *path;
+
+	path = g_build_filename (g_get_tmp_dir (), "brasero-test-XXXXXX", NULL);
+	g_assert (mkdtemp (path) != NULL);
+	return path;
+}
+
+void
+brasero_test_rm_rf (const gchar *path)
+{
+	const gchar *name;
+	GDir *directory;
+
+	if (!g_file_test (path, G_FILE_TEST_IS_DIR)
+	||   g_file_test (path, G_FILE_TEST_IS_SYMLINK)) {
+		g_remove (path);
+		return;
+	}
+
+	directory = g_dir_open (path, 0, NULL);
+	while (directory && (name = g_dir_read_name (directory))) {
+		gchar *child;
+
+		child = g_build_filename (path, name, NULL);
+		brasero_test_rm_rf (child);
+		g_free (child);
+	}
+
+	if (directory)
+		g_dir_close (directory);
+
+	g_rmdir (path);
+}
+
+/* NOTE: @name can contain directories; they are created */
+gchar *
+brasero_test_write_file (const gchar *directory,
+			 const gchar *name,
+			 const gchar *contents)
+{
+	GError *error = NULL;
+	gchar *parent;
+	gchar *path;
+
+	path = g_build_filename (directory, name, NULL);
+	parent = g_path_get_dirname (path);
+	g_assert_cmpint (g_mkdir_with_parents (parent, 0700), ==, 0);
+	g_free (parent);
+
+	g_file_set_contents (path, contents, -1, &error);
+	g_assert_no_error (error);
+	return path;
+}
+
+/**
+ * Returns a URI that is not a file:// one for the local @path or NULL if
+ * there is no way to get one. The gvfs "localtest" backend is used unless
+ * BRASERO_TEST_REMOTE_PREFIX says otherwise (for example "sftp://localhost"
+ * when a ssh server runs locally and is mounted).
+ */
+
+gchar *
+brasero_test_get_remote_uri (const gchar *path)
+{
+	const gchar * const *schemes;
+	gboolean supported = FALSE;
+	const gchar *prefix;
+	gchar *scheme;
+	GFile *file;
+	gchar *uri;
+	guint i;
+
+	prefix = g_getenv ("BRASERO_TEST_REMOTE_PREFIX");
+	if (!prefix)
+		prefix = "localtest://";
+
+	scheme = g_uri_parse_scheme (prefix);
+	schemes = g_vfs_get_supported_uri_schemes (g_vfs_get_default ());
+	for (i = 0; scheme && schemes && schemes [i]; i ++) {
+		if (!strcmp (schemes [i], scheme)) {
+			supported = TRUE;
+			break;
+		}
+	}
+
+	if (!supported) {
+		g_test_message ("URI scheme %s is not supported", scheme? scheme:prefix);
+		g_free (scheme);
+		return NULL;
+	}
+	g_free (scheme);
+
+	uri = g_strconcat (prefix, path, NULL);
+	file = g_file_new_for_uri (uri);
+	if (!g_file_query_exists (file, NULL)) {
+		g_test_message ("%s cannot be reached", uri);
+		g_object_unref (file);
+		g_free (uri);
+		return NULL;
+	}
+
+	g_object_unref (file);
+	return uri;
+}
+
+BraseroVolFile *
+brasero_test_image_get_file (const gchar *image,
+			     const gchar *path)
+{
+	BraseroVolFile *file;
+	BraseroVolSrc *vol;
+
+	vol = brasero_volume_source_open_file (image, NULL);
+	g_assert (vol != NULL);
+
+	file = brasero_volume_get_file (vol, path, 0, NULL);
+	brasero_volume_source_close (vol);
+	return file;
+}
+
+gchar *
+brasero_test_image_get_contents (const gchar *image,
+				 const gchar *path)
+{
+	BraseroVolFile *file;
+	GString *contents;
+	GSList *iter;
+	FILE *stream;
+
+	file = brasero_test_image_get_file (image, path);
+	if (!file)
+		return NULL;
+
+	stream = fopen (image, "r");
+	g_assert (stream != NULL);
+
+	contents = g_string_new (NULL);
+	for (iter = file->specific.file.extents; iter; iter = iter->next) {
+		BraseroVolFileExtent *extent;
+		gchar *buffer;
+
+		extent = iter->data;
+		buffer = g_malloc (extent->size);
+		g_assert (fseeko (stream, (off_t) extent->block * ISO9660_BLOCK_SIZE, SEEK_SET) == 0);
+		g_assert (fread (buffer, 1, extent->size, stream) == extent->size);
+		g_string_append_len (contents, buffer, extent->size);
+		g_free (buffer);
+	}
+
+	fclose (stream);
+	brasero_volume_file_free (file);
+	return g_string_free (contents, FALSE);
+}
@@ -0,0 +1,81 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Brasero
+ * Copyright (C) Philippe Rouquier 2005-2010 <bonfire-app@wanadoo.fr>
+ * 
+ *  Brasero is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ * 
+ * brasero is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with brasero.  If not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef _BRASERO_TEST_UTILS_H_
+#define _BRASERO_TEST_UTILS_H_
+
+#include <glib.h>
+
+#include "brasero-enums.h"
+#include "burn-volume.h"
+
+G_BEGIN_DECLS
+
+/* g_test_skip () appeared with GLib 2.38 */
+#if !GLIB_CHECK_VERSION (2, 38, 0)
+#define g_test_skip(message)	g_test_message ("SKIP: %s", message)
+#endif
+
+/**
+ * Shared by the programs run with "make check". They run uninstalled with
+ * the plugins of the build tree, the schemas of data/ and an in-memory
+ * GSettings backend (see TESTS_ENVIRONMENT in Makefile.am).
+ */
+
+gboolean
+brasero_test_init (int *argc,
+		   char ***argv,
+		   const gchar *first_plugin,
+		   ...) G_GNUC_NULL_TERMINATED;
+
+void
+brasero_test_stop (void);
+
+gboolean
+brasero_test_has_plugin (const gchar *name);
+
+gchar *
+brasero_test_mkdtemp (void);
+
+void
+brasero_test_rm_rf (const gchar *path);
+
+gchar *
+brasero_test_write_file (const gchar *directory,
+			 const gchar *name,
+			 const gchar *contents);
+
+gchar *
+brasero_test_get_remote_uri (const gchar *path);
+
+BraseroVolFile *
+brasero_test_image_get_file (const gchar *image,
+			     const gchar *path);
+
+gchar *
+brasero_test_image_get_contents (const gchar *image,
+				 const gchar *path);
+
+G_END_DECLS
+
+#endif /* _BRASERO_TEST_UTILS_H_ */
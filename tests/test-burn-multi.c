@@ -0,0 +1,459 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Brasero
+ * Copyright (C) Philippe Rouquier 2005-2010 <bonfire-app@wanadoo.fr>
+ *
+ *  Brasero is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ * brasero is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with brasero.  If not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+
+/**
+ * Records one image to several drives at the same time and spans data over
+ * several drives. The fake drive (image files) stands for the real ones
+ * which are only used when their devices are listed in BRASERO_TEST_DRIVES
+ * (for example "/dev/sr0,/dev/sr1") with a blank disc in each.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "brasero-burn-lib.h"
+#include "brasero-track-image.h"
+#include "brasero-track-data-cfg.h"
+#include "brasero-session-span.h"
+#include "brasero-media.h"
+#include "brasero-medium-monitor.h"
+
+#include "brasero-test-utils.h"
+
+#define TEST_IMAGE_SIZE		(2048 * 512)
+
+typedef struct _TestRecorders TestRecorders;
+struct _TestRecorders {
+	guint finished;
+	guint succeeded;
+	guint progress;
+};
+
+static BraseroDrive *
+test_get_fake_drive (void)
+{
+	BraseroMediumMonitor *monitor;
+	BraseroDrive *drive;
+	GSList *drives;
+
+	monitor = brasero_medium_monitor_get_default ();
+	drives = brasero_medium_monitor_get_drives (monitor, BRASERO_DRIVE_TYPE_FAKE);
+	g_object_unref (monitor);
+
+	g_assert (drives != NULL);
+	drive = g_object_ref (drives->data);
+	g_slist_foreach (drives, (GFunc) g_object_unref, NULL);
+	g_slist_free (drives);
+
+	return drive;
+}
+
+static gchar *
+test_write_image (const gchar *directory)
+{
+	GError *error = NULL;
+	gchar *contents;
+	gchar *path;
+	guint i;
+
+	contents = g_malloc (TEST_IMAGE_SIZE);
+	for (i = 0; i < TEST_IMAGE_SIZE; i ++)
+		contents [i] = i % 251;
+
+	path = g_build_filename (directory, "source.bin", NULL);
+	g_file_set_contents (path, contents, TEST_IMAGE_SIZE, &error);
+	g_assert_no_error (error);
+	g_free (contents);
+
+	return path;
+}
+
+static void
+test_assert_same_file (const gchar *source,
+		       const gchar *copy)
+{
+	GError *error = NULL;
+	gchar *contents_source;
+	gchar *contents_copy;
+	gsize size_source;
+	gsize size_copy;
+
+	g_file_get_contents (source, &contents_source, &size_source, &error);
+	g_assert_no_error (error);
+	g_file_get_contents (copy, &contents_copy, &size_copy, &error);
+	g_assert_no_error (error);
+
+	g_assert_cmpuint (size_source, ==, size_copy);
+	g_assert (!memcmp (contents_source, contents_copy, size_source));
+
+	g_free (contents_source);
+	g_free (contents_copy);
+}
+
+static void
+test_drive_finished_cb (BraseroBurn *burn,
+			BraseroDrive *drive,
+			BraseroBurnResult result,
+			const GError *error,
+			TestRecorders *recorders)
+{
+	recorders->finished ++;
+	if (result == BRASERO_BURN_OK)
+		recorders->succeeded ++;
+}
+
+static void
+test_drive_progress_cb (BraseroBurn *burn,
+			BraseroDrive *drive,
+			gdouble progress,
+			glong remaining,
+			TestRecorders *recorders)
+{
+	g_assert_cmpfloat (progress, >=, 0.0);
+	g_assert_cmpfloat (progress, <=, 1.0);
+	recorders->progress ++;
+}
+
+static BraseroBurnSession *
+test_session_new (const gchar *source)
+{
+	BraseroBurnSession *session;
+	BraseroTrackImage *track;
+
+	track = brasero_track_image_new ();
+	brasero_track_image_set_source (track, source, NULL, BRASERO_IMAGE_FORMAT_BIN);
+
+	session = brasero_burn_session_new ();
+	brasero_burn_session_add_track (session, BRASERO_TRACK (track), NULL);
+	g_object_unref (track);
+
+	return session;
+}
+
+static void
+test_multi_fake (void)
+{
+	TestRecorders recorders = { 0, };
+	BraseroBurnSession *session;
+	BraseroBurnResult result;
+	GError *error = NULL;
+	BraseroDrive *drive;
+	GSList *drives = NULL;
+	gchar *directory;
+	gchar *source;
+	gchar *output;
+	gchar *copy;
+	BraseroBurn *burn;
+	guint i;
+
+	directory = brasero_test_mkdtemp ();
+	source = test_write_image (directory);
+	output = g_build_filename (directory, "output.bin", NULL);
+
+	session = test_session_new (source);
+	brasero_burn_session_set_image_output_full (session,
+						    BRASERO_IMAGE_FORMAT_BIN,
+						    output,
+						    NULL);
+
+	drive = test_get_fake_drive ();
+	for (i = 0; i < 3; i ++)
+		drives = g_slist_prepend (drives, drive);
+
+	burn = brasero_burn_new ();
+	g_signal_connect (burn,
+			  "drive-finished",
+			  G_CALLBACK (test_drive_finished_cb),
+			  &recorders);
+	g_signal_connect (burn,
+			  "drive-progress-changed",
+			  G_CALLBACK (test_drive_progress_cb),
+			  &recorders);
+
+	result = brasero_burn_record_multi (burn, session, drives, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (result, ==, BRASERO_BURN_OK);
+	g_assert_cmpuint (recorders.finished, ==, 3);
+	g_assert_cmpuint (recorders.succeeded, ==, 3);
+
+	/* Each drive after the first gets a numbered copy */
+	test_assert_same_file (source, output);
+	for (i = 1; i < 3; i ++) {
+		copy = g_strdup_printf ("%s.%i", output, i);
+		test_assert_same_file (source, copy);
+		g_free (copy);
+	}
+
+	g_object_unref (burn);
+	g_object_unref (session);
+	g_object_unref (drive);
+	g_slist_free (drives);
+
+	brasero_test_rm_rf (directory);
+	g_free (directory);
+	g_free (source);
+	g_free (output);
+}
+
+static void
+test_multi_fake_no_output (void)
+{
+	BraseroBurnSession *session;
+	BraseroBurnResult result;
+	GError *error = NULL;
+	BraseroDrive *drive;
+	GSList *drives = NULL;
+	gchar *directory;
+	gchar *source;
+	BraseroBurn *burn;
+
+	directory = brasero_test_mkdtemp ();
+	source = test_write_image (directory);
+
+	/* No image output was set: the fake drives have nowhere to write */
+	session = test_session_new (source);
+	drive = test_get_fake_drive ();
+	drives = g_slist_prepend (drives, drive);
+	drives = g_slist_prepend (drives, drive);
+
+	burn = brasero_burn_new ();
+	result = brasero_burn_record_multi (burn, session, drives, &error);
+	g_assert_cmpint (result, ==, BRASERO_BURN_ERR);
+	g_assert_error (error, BRASERO_BURN_ERROR, BRASERO_BURN_ERROR_OUTPUT_NONE);
+	g_error_free (error);
+
+	g_object_unref (burn);
+	g_object_unref (session);
+	g_object_unref (drive);
+	g_slist_free (drives);
+
+	brasero_test_rm_rf (directory);
+	g_free (directory);
+	g_free (source);
+}
+
+static GSList *
+test_get_real_drives (guint num)
+{
+	BraseroMediumMonitor *monitor;
+	const gchar *devices;
+	GSList *drives = NULL;
+	gchar **names;
+	guint i;
+
+	devices = g_getenv ("BRASERO_TEST_DRIVES");
+	if (!devices) {
+		g_test_message ("BRASERO_TEST_DRIVES lists no drive");
+		return NULL;
+	}
+
+	names = g_strsplit (devices, ",", -1);
+	if (g_strv_length (names) < num) {
+		g_test_message ("BRASERO_TEST_DRIVES lists less than %i drives", num);
+		g_strfreev (names);
+		return NULL;
+	}
+
+	monitor = brasero_medium_monitor_get_default ();
+	for (i = 0; names [i]; i ++) {
+		BraseroDrive *drive;
+
+		drive = brasero_medium_monitor_get_drive (monitor, names [i]);
+		g_assert (drive != NULL);
+		drives = g_slist_append (drives, drive);
+	}
+	g_object_unref (monitor);
+	g_strfreev (names);
+
+	return drives;
+}
+
+static void
+test_multi_real (void)
+{
+	TestRecorders recorders = { 0, };
+	BraseroBurnSession *session;
+	BraseroBurnResult result;
+	GError *error = NULL;
+	GSList *drives = NULL;
+	gchar *directory;
+	gchar *source;
+	BraseroBurn *burn;
+
+	drives = test_get_real_drives (2);
+	if (!drives) {
+		g_test_skip ("BRASERO_TEST_DRIVES must list two writers");
+		return;
+	}
+
+	directory = brasero_test_mkdtemp ();
+	source = test_write_image (directory);
+	session = test_session_new (source);
+	brasero_burn_session_set_burner (session, drives->data);
+	brasero_burn_session_add_flag (session, BRASERO_BURN_FLAG_DUMMY);
+
+	burn = brasero_burn_new ();
+	g_signal_connect (burn,
+			  "drive-finished",
+			  G_CALLBACK (test_drive_finished_cb),
+			  &recorders);
+	g_signal_connect (burn,
+			  "drive-progress-changed",
+			  G_CALLBACK (test_drive_progress_cb),
+			  &recorders);
+
+	result = brasero_burn_record_multi (burn, session, drives, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (result, ==, BRASERO_BURN_OK);
+	g_assert_cmpuint (recorders.finished, ==, g_slist_length (drives));
+	g_assert_cmpuint (recorders.progress, >, 0);
+
+	g_object_unref (burn);
+	g_object_unref (session);
+	g_slist_foreach (drives, (GFunc) g_object_unref, NULL);
+	g_slist_free (drives);
+
+	brasero_test_rm_rf (directory);
+	g_free (directory);
+	g_free (source);
+}
+
+static void
+test_write_sparse_file (const gchar *directory,
+			const gchar *name,
+			goffset size)
+{
+	gchar *path;
+	int fd;
+
+	path = g_build_filename (directory, name, NULL);
+	fd = g_open (path, O_WRONLY|O_CREAT|O_TRUNC, 0600);
+	g_assert (fd >= 0);
+	g_assert (ftruncate (fd, size) == 0);
+	close (fd);
+	g_free (path);
+}
+
+static void
+test_span_real (void)
+{
+	TestRecorders recorders = { 0, };
+	BraseroTrackDataCfg *track;
+	BraseroSessionSpan *session;
+	BraseroBurnResult result;
+	BraseroMedium *medium;
+	GError *error = NULL;
+	GSList *drives = NULL;
+	BraseroStatus *status;
+	gchar *directory;
+	goffset bytes = 0;
+	BraseroBurn *burn;
+	gchar *uri;
+	guint i;
+
+	drives = test_get_real_drives (2);
+	if (!drives) {
+		g_test_skip ("BRASERO_TEST_DRIVES must list two writers");
+		return;
+	}
+
+	medium = brasero_drive_get_medium (drives->data);
+	brasero_medium_get_free_space (medium, &bytes, NULL);
+	g_assert_cmpint (bytes, >, 0);
+
+	/* Three files of more than a third of a disc need two discs; sparse
+	 * files don't use any space */
+	directory = brasero_test_mkdtemp ();
+	for (i = 0; i < 3; i ++) {
+		gchar *name;
+
+		name = g_strdup_printf ("file%i", i);
+		test_write_sparse_file (directory, name, bytes * 2 / 5);
+		g_free (name);
+	}
+
+	track = brasero_track_data_cfg_new ();
+	uri = g_filename_to_uri (directory, NULL, NULL);
+	g_assert (brasero_track_data_cfg_add (track, uri, NULL));
+	g_free (uri);
+
+	status = brasero_status_new ();
+	while (brasero_track_get_status (BRASERO_TRACK (track), status) == BRASERO_BURN_NOT_READY)
+		g_main_context_iteration (NULL, TRUE);
+	g_object_unref (status);
+
+	session = brasero_session_span_new ();
+	brasero_burn_session_add_track (BRASERO_BURN_SESSION (session), BRASERO_TRACK (track), NULL);
+	brasero_burn_session_set_burner (BRASERO_BURN_SESSION (session), drives->data);
+	brasero_burn_session_add_flag (BRASERO_BURN_SESSION (session), BRASERO_BURN_FLAG_DUMMY);
+	g_object_unref (track);
+
+	burn = brasero_burn_new ();
+	g_signal_connect (burn,
+			  "drive-finished",
+			  G_CALLBACK (test_drive_finished_cb),
+			  &recorders);
+
+	/* Both volumes are recorded at the same time on both drives */
+	result = brasero_burn_record_span (burn, session, drives, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (result, ==, BRASERO_BURN_OK);
+	g_assert_cmpuint (recorders.finished, ==, 2);
+	g_assert_cmpuint (recorders.succeeded, ==, 2);
+
+	/* The burner of the session is left as it was */
+	g_assert (brasero_burn_session_get_burner (BRASERO_BURN_SESSION (session)) == drives->data);
+
+	g_object_unref (burn);
+	g_object_unref (session);
+	g_slist_foreach (drives, (GFunc) g_object_unref, NULL);
+	g_slist_free (drives);
+
+	brasero_test_rm_rf (directory);
+	g_free (directory);
+}
+
+int
+main (int argc, char **argv)
+{
+	int retval;
+
+	brasero_test_init (&argc, &argv, NULL, NULL);
+
+	g_test_add_func ("/burn/multi/fake", test_multi_fake);
+	g_test_add_func ("/burn/multi/fake-no-output", test_multi_fake_no_output);
+	g_test_add_func ("/burn/multi/real", test_multi_real);
+	g_test_add_func ("/burn/span/real", test_span_real);
+	retval = g_test_run ();
+
+	brasero_test_stop ();
+	return retval;
+}
@@ -0,0 +1,242 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Brasero
+ * Copyright (C) Philippe Rouquier 2005-2010 <bonfire-app@wanadoo.fr>
+ *
+ *  Brasero is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ * brasero is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with brasero.  If not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+
+/**
+ * Feeds a reader (standing for the recorder) with a BraseroImageFollower
+ * while a fake imager thread is still writing the image, the way
+ * brasero_burn_run_imager_following () does.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "burn-image-follower.h"
+
+#include "brasero-test-utils.h"
+
+#define TEST_CHUNK_SIZE		(32 * 1024)
+#define TEST_CHUNK_NUM		16
+#define TEST_LEAD		(2 * TEST_CHUNK_SIZE)
+
+typedef struct _TestImager TestImager;
+struct _TestImager {
+	BraseroImageFollower *follower;
+	gchar *image;
+
+	/* The imager stops once it wrote the lead until told to go on so
+	 * that the reader really starts before the image is complete */
+	GMutex *mutex;
+	GCond *cond;
+	gboolean go;
+
+	/* Number of chunks written before failing, or -1 to succeed */
+	gint fail_after;
+	gint aborted;
+};
+
+static void
+test_chunk_fill (guchar *buffer,
+		 gint index)
+{
+	gint i;
+
+	for (i = 0; i < TEST_CHUNK_SIZE; i ++)
+		buffer [i] = (guchar) (index * 7 + i);
+}
+
+static gpointer
+test_imager_thread (gpointer data)
+{
+	TestImager *imager = data;
+	guchar *buffer;
+	FILE *file;
+	gint i;
+
+	buffer = g_malloc (TEST_CHUNK_SIZE);
+	file = g_fopen (imager->image, "w");
+	g_assert (file != NULL);
+
+	for (i = 0; i < TEST_CHUNK_NUM; i ++) {
+		if (i == imager->fail_after)
+			break;
+
+		if (i * TEST_CHUNK_SIZE == TEST_LEAD) {
+			g_mutex_lock (imager->mutex);
+			while (!imager->go)
+				g_cond_wait (imager->cond, imager->mutex);
+			g_mutex_unlock (imager->mutex);
+		}
+
+		test_chunk_fill (buffer, i);
+		g_assert_cmpint (fwrite (buffer, 1, TEST_CHUNK_SIZE, file), ==, TEST_CHUNK_SIZE);
+		fflush (file);
+
+		g_usleep (G_USEC_PER_SEC / 100);
+	}
+
+	fclose (file);
+	g_free (buffer);
+
+	brasero_image_follower_source_finished (imager->follower, i == TEST_CHUNK_NUM);
+	return NULL;
+}
+
+static void
+test_imager_abort_cb (gpointer data)
+{
+	TestImager *imager = data;
+
+	g_atomic_int_set (&imager->aborted, 1);
+}
+
+static void
+test_follow (gint fail_after,
+	     GByteArray *read_data,
+	     gboolean *aborted)
+{
+	TestImager imager = { NULL, };
+	GError *error = NULL;
+	GThread *thread;
+	gchar *directory;
+	guchar buffer [4096];
+	gssize bytes;
+	int fd;
+
+	directory = brasero_test_mkdtemp ();
+
+	imager.image = g_build_filename (directory, "image.bin", NULL);
+	imager.mutex = g_mutex_new ();
+	imager.cond = g_cond_new ();
+	imager.fail_after = fail_after;
+	imager.follower = brasero_image_follower_new (TEST_LEAD,
+						      test_imager_abort_cb,
+						      &imager);
+	brasero_image_follower_set_source (imager.follower, imager.image);
+
+	/* Nothing was written yet */
+	g_assert (!brasero_image_follower_is_ready (imager.follower));
+
+	thread = g_thread_create (test_imager_thread, &imager, TRUE, &error);
+	g_assert_no_error (error);
+
+	/* Wait for the lead as BraseroBurn does before starting the recorder */
+	while (!brasero_image_follower_is_ready (imager.follower))
+		g_usleep (G_USEC_PER_SEC / 100);
+
+	fd = brasero_image_follower_open (imager.follower, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (fd, >=, 0);
+
+	g_mutex_lock (imager.mutex);
+	imager.go = TRUE;
+	g_cond_signal (imager.cond);
+	g_mutex_unlock (imager.mutex);
+
+	/* The pipe is closed once the image is complete or the imager failed */
+	while ((bytes = read (fd, buffer, sizeof (buffer))) != 0) {
+		if (bytes < 0) {
+			g_assert_cmpint (errno, ==, EINTR);
+			continue;
+		}
+
+		g_byte_array_append (read_data, buffer, bytes);
+	}
+	close (fd);
+
+	g_thread_join (thread);
+	brasero_image_follower_free (imager.follower);
+
+	*aborted = g_atomic_int_get (&imager.aborted);
+
+	g_mutex_free (imager.mutex);
+	g_cond_free (imager.cond);
+
+	brasero_test_rm_rf (directory);
+	g_free (directory);
+	g_free (imager.image);
+}
+
+static void
+test_follow_complete (void)
+{
+	GByteArray *read_data;
+	gboolean aborted;
+	guchar *chunk;
+	gint i;
+
+	read_data = g_byte_array_new ();
+	test_follow (-1, read_data, &aborted);
+
+	g_assert (!aborted);
+	g_assert_cmpuint (read_data->len, ==, TEST_CHUNK_NUM * TEST_CHUNK_SIZE);
+
+	/* The reader got the image as it was written, in order */
+	chunk = g_malloc (TEST_CHUNK_SIZE);
+	for (i = 0; i < TEST_CHUNK_NUM; i ++) {
+		test_chunk_fill (chunk, i);
+		g_assert (!memcmp (read_data->data + i * TEST_CHUNK_SIZE, chunk, TEST_CHUNK_SIZE));
+	}
+	g_free (chunk);
+
+	g_byte_array_free (read_data, TRUE);
+}
+
+static void
+test_follow_imager_failure (void)
+{
+	GByteArray *read_data;
+	gboolean aborted;
+
+	/* The imager fails after the lead while the reader follows it */
+	read_data = g_byte_array_new ();
+	test_follow (TEST_CHUNK_NUM / 2, read_data, &aborted);
+
+	g_assert (aborted);
+	g_assert_cmpuint (read_data->len, <=, (TEST_CHUNK_NUM / 2) * TEST_CHUNK_SIZE);
+
+	g_byte_array_free (read_data, TRUE);
+}
+
+int
+main (int argc, char **argv)
+{
+	int retval;
+
+	brasero_test_init (&argc, &argv, NULL, NULL);
+
+	g_test_add_func ("/image-follower/complete", test_follow_complete);
+	g_test_add_func ("/image-follower/imager-failure", test_follow_imager_failure);
+	retval = g_test_run ();
+
+	brasero_test_stop ();
+	return retval;
+}
@@ -0,0 +1,275 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Brasero
+ * Copyright (C) Philippe Rouquier 2005-2010 <bonfire-app@wanadoo.fr>
+ * 
+ *  Brasero is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ * 
+ * brasero is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with brasero.  If not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+
+/**
+ * Creates an image with libisofs from grafts that are not file:// URIs so
+ * that they go through the GIO streams of the plugin.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "brasero-burn-lib.h"
+#include "brasero-track-data.h"
+
+#include "brasero-test-utils.h"
+
+static BraseroGraftPt *
+test_graft_new (const gchar *uri,
+		const gchar *path)
+{
+	BraseroGraftPt *graft;
+
+	graft = g_new0 (BraseroGraftPt, 1);
+	graft->uri = g_strdup (uri);
+	graft->path = g_strdup (path);
+	return graft;
+}
+
+static BraseroBurnResult
+test_burn_image (GSList *grafts,
+		 GSList *excluded,
+		 const gchar *image,
+		 GError **error)
+{
+	BraseroBurnSession *session;
+	BraseroBurnResult result;
+	BraseroTrackData *track;
+	BraseroBurn *burn;
+	gchar *directory;
+	gchar *tmpdir;
+	GDir *dir;
+
+	/* Nothing may be staged: the file downloader is available but would
+	 * fail to write to a read-only temporary directory. */
+	directory = g_path_get_dirname (image);
+	tmpdir = g_build_filename (directory, "tmp", NULL);
+	g_free (directory);
+	g_assert_cmpint (g_mkdir (tmpdir, 0500), ==, 0);
+
+	track = brasero_track_data_new ();
+	brasero_track_data_add_fs (track, BRASERO_IMAGE_FS_ISO);
+	brasero_track_data_set_source (track, grafts, excluded);
+
+	session = brasero_burn_session_new ();
+	brasero_burn_session_set_tmpdir (session, tmpdir);
+	brasero_burn_session_add_track (session, BRASERO_TRACK (track), NULL);
+	g_object_unref (track);
+
+	brasero_burn_session_set_image_output_full (session,
+						    BRASERO_IMAGE_FORMAT_BIN,
+						    image,
+						    NULL);
+
+	burn = brasero_burn_new ();
+	result = brasero_burn_record (burn, session, error);
+	g_object_unref (burn);
+	g_object_unref (session);
+
+	g_chmod (tmpdir, 0700);
+	dir = g_dir_open (tmpdir, 0, NULL);
+	g_assert (dir != NULL);
+	g_assert (g_dir_read_name (dir) == NULL);
+	g_dir_close (dir);
+
+	g_rmdir (tmpdir);
+	g_free (tmpdir);
+
+	return result;
+}
+
+static void
+test_remote_graft (void)
+{
+	BraseroBurnResult result;
+	GError *error = NULL;
+	gchar *directory;
+	gchar *contents;
+	gchar *image;
+	gchar *path;
+	gchar *uri;
+
+	directory = brasero_test_mkdtemp ();
+	path = brasero_test_write_file (directory, "remote/single.txt", "single remote file");
+
+	uri = brasero_test_get_remote_uri (path);
+	g_free (path);
+
+	if (!uri) {
+		brasero_test_rm_rf (directory);
+		g_free (directory);
+		g_test_skip ("no remote GVfs backend");
+		return;
+	}
+
+	/* A graft is also excluded from its parent directory: it must still
+	 * be in the image. */
+	image = g_build_filename (directory, "image.iso", NULL);
+	result = test_burn_image (g_slist_prepend (NULL, test_graft_new (uri, "/single.txt")),
+				  g_slist_prepend (NULL, g_strdup (uri)),
+				  image,
+				  &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (result, ==, BRASERO_BURN_OK);
+
+	contents = brasero_test_image_get_contents (image, "/single.txt");
+	g_assert_cmpstr (contents, ==, "single remote file");
+	g_free (contents);
+
+	brasero_test_rm_rf (directory);
+	g_free (directory);
+	g_free (image);
+	g_free (uri);
+}
+
+static void
+test_remote_excluded_child (void)
+{
+	BraseroBurnResult result;
+	BraseroVolFile *file;
+	GError *error = NULL;
+	gchar *excluded_uri;
+	gchar *directory;
+	gchar *contents;
+	gchar *image;
+	gchar *path;
+	gchar *uri;
+
+	directory = brasero_test_mkdtemp ();
+	g_free (brasero_test_write_file (directory, "remote/tree/kept.txt", "kept"));
+	path = brasero_test_write_file (directory, "remote/tree/excluded.txt", "excluded");
+	excluded_uri = brasero_test_get_remote_uri (path);
+	g_free (path);
+
+	if (!excluded_uri) {
+		brasero_test_rm_rf (directory);
+		g_free (directory);
+		g_test_skip ("no remote GVfs backend");
+		return;
+	}
+
+	path = g_build_filename (directory, "remote", "tree", NULL);
+	uri = brasero_test_get_remote_uri (path);
+	g_free (path);
+	g_assert (uri != NULL);
+
+	image = g_build_filename (directory, "image.iso", NULL);
+	result = test_burn_image (g_slist_prepend (NULL, test_graft_new (uri, "/tree")),
+				  g_slist_prepend (NULL, excluded_uri),
+				  image,
+				  &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (result, ==, BRASERO_BURN_OK);
+
+	contents = brasero_test_image_get_contents (image, "/tree/kept.txt");
+	g_assert_cmpstr (contents, ==, "kept");
+	g_free (contents);
+
+	file = brasero_test_image_get_file (image, "/tree/excluded.txt");
+	g_assert (file == NULL);
+
+	brasero_test_rm_rf (directory);
+	g_free (directory);
+	g_free (image);
+	g_free (uri);
+}
+
+static void
+test_remote_symlink_loop (void)
+{
+	BraseroBurnResult result;
+	BraseroVolFile *file;
+	GError *error = NULL;
+	gchar *directory;
+	gchar *contents;
+	gchar *image;
+	gchar *path;
+	gchar *uri;
+
+	directory = brasero_test_mkdtemp ();
+	g_free (brasero_test_write_file (directory, "remote/tree/file.txt", "file"));
+	g_free (brasero_test_write_file (directory, "remote/tree/sub/child.txt", "child"));
+
+	path = g_build_filename (directory, "remote", "tree", "sub", "loop", NULL);
+	g_assert_cmpint (symlink ("..", path), ==, 0);
+	g_free (path);
+
+	path = g_build_filename (directory, "remote", "tree", NULL);
+	uri = brasero_test_get_remote_uri (path);
+	g_free (path);
+
+	if (!uri) {
+		brasero_test_rm_rf (directory);
+		g_free (directory);
+		g_test_skip ("no remote GVfs backend");
+		return;
+	}
+
+	image = g_build_filename (directory, "image.iso", NULL);
+	result = test_burn_image (g_slist_prepend (NULL, test_graft_new (uri, "/tree")),
+				  NULL,
+				  image,
+				  &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (result, ==, BRASERO_BURN_OK);
+
+	contents = brasero_test_image_get_contents (image, "/tree/sub/child.txt");
+	g_assert_cmpstr (contents, ==, "child");
+	g_free (contents);
+
+	/* The loop is not followed */
+	file = brasero_test_image_get_file (image, "/tree/sub/loop");
+	g_assert (file == NULL);
+
+	brasero_test_rm_rf (directory);
+	g_free (directory);
+	g_free (image);
+	g_free (uri);
+}
+
+int
+main (int argc, char **argv)
+{
+	int retval;
+
+	brasero_test_init (&argc, &argv, "libisofs", "file-downloader", NULL);
+	if (!brasero_test_has_plugin ("libisofs")) {
+		brasero_test_stop ();
+		return 77;
+	}
+
+	g_test_add_func ("/libisofs/remote-graft", test_remote_graft);
+	g_test_add_func ("/libisofs/remote-excluded-child", test_remote_excluded_child);
+	g_test_add_func ("/libisofs/remote-symlink-loop", test_remote_symlink_loop);
+	retval = g_test_run ();
+
+	brasero_test_stop ();
+	return retval;
+}
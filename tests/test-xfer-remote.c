@@ -0,0 +1,277 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * Brasero
+ * Copyright (C) Philippe Rouquier 2005-2010 <bonfire-app@wanadoo.fr>
+ * 
+ *  Brasero is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ * 
+ * brasero is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with brasero.  If not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+
+/**
+ * Downloads trees that are not file:// URIs with the transfer scheduler and
+ * with brasero_xfer_wait (), including trees with symlink loops.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <unistd.h>
+
+#include <glib.h>
+#include <gio/gio.h>
+
+#include "brasero-xfer.h"
+
+#include "brasero-test-utils.h"
+
+static void
+test_check_contents (const gchar *directory,
+		     const gchar *name,
+		     const gchar *expected)
+{
+	GError *error = NULL;
+	gchar *contents;
+	gchar *path;
+
+	path = g_build_filename (directory, name, NULL);
+	g_file_get_contents (path, &contents, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_cmpstr (contents, ==, expected);
+	g_free (contents);
+	g_free (path);
+}
+
+static gboolean
+test_exists (const gchar *directory,
+	     const gchar *name)
+{
+	gboolean exists;
+	gchar *path;
+
+	path = g_build_filename (directory, name, NULL);
+	exists = g_file_test (path, G_FILE_TEST_EXISTS);
+	g_free (path);
+
+	return exists;
+}
+
+/* Returns a remote URI for directory/remote/tree with a loop back to tree
+ * from tree/sub/loop and to itself from tree/self or NULL */
+static gchar *
+test_make_loop_tree (const gchar *directory)
+{
+	gchar *path;
+	gchar *uri;
+
+	g_free (brasero_test_write_file (directory, "remote/tree/file.txt", "file"));
+	g_free (brasero_test_write_file (directory, "remote/tree/sub/child.txt", "child"));
+
+	path = g_build_filename (directory, "remote", "tree", "sub", "loop", NULL);
+	g_assert_cmpint (symlink ("..", path), ==, 0);
+	g_free (path);
+
+	path = g_build_filename (directory, "remote", "tree", "self", NULL);
+	g_assert_cmpint (symlink (".", path), ==, 0);
+	g_free (path);
+
+	path = g_build_filename (directory, "remote", "tree", NULL);
+	uri = brasero_test_get_remote_uri (path);
+	g_free (path);
+
+	return uri;
+}
+
+static void
+test_check_loop_tree (const gchar *dest)
+{
+	test_check_contents (dest, "file.txt", "file");
+	test_check_contents (dest, "sub/child.txt", "child");
+
+	g_assert (!test_exists (dest, "sub/loop"));
+	g_assert (!test_exists (dest, "self"));
+}
+
+static void
+test_remote_tree (void)
+{
+	BraseroXferCtx *ctx;
+	GError *error = NULL;
+	goffset written = 0;
+	goffset total = 0;
+	gchar *directory;
+	gboolean result;
+	GFile *source;
+	GFile *dest;
+	gchar *path;
+	gchar *uri;
+	guint i;
+
+	directory = brasero_test_mkdtemp ();
+	for (i = 0; i < 8; i ++) {
+		gchar *contents;
+		gchar *name;
+
+		name = g_strdup_printf ("remote/tree/dir%i/file%i.txt", i % 3, i);
+		contents = g_strdup_printf ("contents of file %i", i);
+		g_free (brasero_test_write_file (directory, name, contents));
+		g_free (contents);
+		g_free (name);
+	}
+
+	path = g_build_filename (directory, "remote", "tree", NULL);
+	uri = brasero_test_get_remote_uri (path);
+	g_free (path);
+
+	if (!uri) {
+		g_test_skip ("no remote GVfs backend");
+		brasero_test_rm_rf (directory);
+		g_free (directory);
+		return;
+	}
+
+	path = g_build_filename (directory, "download", NULL);
+	source = g_file_new_for_uri (uri);
+	dest = g_file_new_for_path (path);
+
+	ctx = brasero_xfer_new ();
+	brasero_xfer_add (ctx, source, dest);
+	result = brasero_xfer_run (ctx, 4, 2, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (result);
+
+	brasero_xfer_get_progress (ctx, &written, &total);
+	g_assert_cmpint (written, ==, total);
+	brasero_xfer_free (ctx);
+
+	for (i = 0; i < 8; i ++) {
+		gchar *contents;
+		gchar *name;
+
+		name = g_strdup_printf ("dir%i/file%i.txt", i % 3, i);
+		contents = g_strdup_printf ("contents of file %i", i);
+		test_check_contents (path, name, contents);
+		g_free (contents);
+		g_free (name);
+	}
+
+	g_object_unref (source);
+	g_object_unref (dest);
+
+	brasero_test_rm_rf (directory);
+	g_free (directory);
+	g_free (path);
+	g_free (uri);
+}
+
+static void
+test_remote_symlink_loop (void)
+{
+	BraseroXferCtx *ctx;
+	GError *error = NULL;
+	gchar *directory;
+	gboolean result;
+	GFile *source;
+	GFile *dest;
+	gchar *path;
+	gchar *uri;
+
+	directory = brasero_test_mkdtemp ();
+	uri = test_make_loop_tree (directory);
+	if (!uri) {
+		g_test_skip ("no remote GVfs backend");
+		brasero_test_rm_rf (directory);
+		g_free (directory);
+		return;
+	}
+
+	path = g_build_filename (directory, "download", NULL);
+	source = g_file_new_for_uri (uri);
+	dest = g_file_new_for_path (path);
+
+	ctx = brasero_xfer_new ();
+	brasero_xfer_add (ctx, source, dest);
+	result = brasero_xfer_run (ctx, 4, 2, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (result);
+	brasero_xfer_free (ctx);
+
+	test_check_loop_tree (path);
+
+	g_object_unref (source);
+	g_object_unref (dest);
+
+	brasero_test_rm_rf (directory);
+	g_free (directory);
+	g_free (path);
+	g_free (uri);
+}
+
+static void
+test_remote_wait (void)
+{
+	GCancellable *cancel;
+	BraseroXferCtx *ctx;
+	GError *error = NULL;
+	gchar *directory;
+	gboolean result;
+	gchar *path;
+	gchar *uri;
+
+	directory = brasero_test_mkdtemp ();
+	uri = test_make_loop_tree (directory);
+	if (!uri) {
+		g_test_skip ("no remote GVfs backend");
+		brasero_test_rm_rf (directory);
+		g_free (directory);
+		return;
+	}
+
+	path = g_build_filename (directory, "download", NULL);
+	cancel = g_cancellable_new ();
+
+	ctx = brasero_xfer_new ();
+	result = brasero_xfer_wait (ctx, uri, path, cancel, &error);
+	g_assert_no_error (error);
+	g_assert (result);
+	brasero_xfer_free (ctx);
+
+	test_check_loop_tree (path);
+
+	g_object_unref (cancel);
+
+	brasero_test_rm_rf (directory);
+	g_free (directory);
+	g_free (path);
+	g_free (uri);
+}
+
+int
+main (int argc, char **argv)
+{
+	int retval;
+
+	brasero_test_init (&argc, &argv, NULL, NULL);
+
+	g_test_add_func ("/xfer/remote-tree", test_remote_tree);
+	g_test_add_func ("/xfer/remote-symlink-loop", test_remote_symlink_loop);
+	g_test_add_func ("/xfer/remote-wait", test_remote_wait);
+	retval = g_test_run ();
+
+	brasero_test_stop ();
+	return retval;
+}